@@ -0,0 +1,440 @@
+#include "batch.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "markov.h"
+#include "cache.h"
+
+/*
+   now_ms :
+   Horloge monotone en millisecondes, pour mesurer le temps par fichier.
+*/
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+/*
+   append_path :
+   Ajoute une copie du chemin au tableau dynamique (capacité doublée si besoin).
+   Retourne 0 si succès, -1 si l'allocation échoue.
+*/
+static int append_path(char ***paths, int *count, int *capacity, const char *path) {
+    if (*count == *capacity) {
+        int new_capacity = (*capacity == 0) ? 16 : *capacity * 2;
+        char **tmp = (char **)realloc(*paths, new_capacity * sizeof(char *));
+        if (tmp == NULL) {
+            perror("Realloc failed for batch paths");
+            return -1;
+        }
+        *paths = tmp;
+        *capacity = new_capacity;
+    }
+    (*paths)[*count] = strdup(path);
+    if ((*paths)[*count] == NULL) {
+        perror("strdup failed for batch path");
+        return -1;
+    }
+    (*count)++;
+    return 0;
+}
+
+static int compare_paths(const void *a, const void *b) {
+    return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+/*
+   collect_batch_dir :
+   Parcourt un dossier et retient tous les fichiers se terminant par ".txt" ou ".mtx".
+   La liste est triée par nom pour que le tableau récapitulatif soit reproductible.
+*/
+int collect_batch_dir(const char *dir_path, char ***paths) {
+    DIR *dir = opendir(dir_path);
+    int count = 0, capacity = 0;
+    char full_path[BATCH_MAX_PATH];
+    struct dirent *entry;
+
+    *paths = NULL;
+    if (dir == NULL) {
+        perror("Could not open batch directory");
+        return -1;
+    }
+
+    while ((entry = readdir(dir)) != NULL) {
+        size_t len = strlen(entry->d_name);
+        if (len < 5 || (strcmp(entry->d_name + len - 4, ".txt") != 0 && strcmp(entry->d_name + len - 4, ".mtx") != 0)) continue;
+
+        if (snprintf(full_path, BATCH_MAX_PATH, "%s/%s", dir_path, entry->d_name) >= BATCH_MAX_PATH) {
+            fprintf(stderr, "Warning: path too long, skipped: %s/%s\n", dir_path, entry->d_name);
+            continue;
+        }
+        if (append_path(paths, &count, &capacity, full_path) != 0) {
+            closedir(dir);
+            free_batch_paths(*paths, count);
+            *paths = NULL;
+            return -1;
+        }
+    }
+    closedir(dir);
+
+    if (count > 1) qsort(*paths, count, sizeof(char *), compare_paths);
+    return count;
+}
+
+/*
+   collect_batch_list :
+   Lit un fichier contenant un chemin par ligne. Les lignes vides et celles
+   commençant par '#' sont ignorées. L'ordre du fichier est conservé.
+*/
+int collect_batch_list(const char *list_path, char ***paths) {
+    FILE *file = fopen(list_path, "rt");
+    int count = 0, capacity = 0;
+    char line[BATCH_MAX_PATH];
+
+    *paths = NULL;
+    if (file == NULL) {
+        perror("Could not open batch list");
+        return -1;
+    }
+
+    while (fgets(line, sizeof(line), file) != NULL) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '\0' || line[0] == '#') continue;
+
+        if (append_path(paths, &count, &capacity, line) != 0) {
+            fclose(file);
+            free_batch_paths(*paths, count);
+            *paths = NULL;
+            return -1;
+        }
+    }
+    fclose(file);
+    return count;
+}
+
+/*
+   free_batch_paths :
+   Libère chaque chemin puis le tableau.
+*/
+void free_batch_paths(char **paths, int count) {
+    if (paths == NULL) return;
+    for (int i = 0; i < count; i++) free(paths[i]);
+    free(paths);
+}
+
+/*
+   build_output_base :
+   Construit "<output_dir>/<nom du fichier sans dossier ni extension>".
+   Exemple : data/exemple1.txt avec output_dir "out" → out/exemple1
+   Retourne 0 si succès, -1 si le chemin ne tient pas dans size caractères.
+*/
+static int build_output_base(const char *input_path, const char *output_dir, char *base, size_t size) {
+    const char *name = strrchr(input_path, '/');
+    name = (name != NULL) ? name + 1 : input_path;
+
+    char temp_name[BATCH_MAX_PATH];
+    strncpy(temp_name, name, BATCH_MAX_PATH - 1);
+    temp_name[BATCH_MAX_PATH - 1] = '\0';
+
+    char *dot = strrchr(temp_name, '.');
+    if (dot) *dot = '\0';
+
+    int length = snprintf(base, size, "%s/%s", output_dir, temp_name);
+    return (length >= 0 && (size_t)length < size) ? 0 : -1;
+}
+
+//Nom de sortie d'un fichier et sa position dans la liste, pour le tri de find_duplicate_output.
+typedef struct s_output_name {
+    char name[BATCH_MAX_PATH];
+    int index;
+} t_output_name;
+
+static int compare_output_names(const void *a, const void *b) {
+    const t_output_name *x = (const t_output_name *)a;
+    const t_output_name *y = (const t_output_name *)b;
+    int cmp = strcmp(x->name, y->name);
+    return (cmp != 0) ? cmp : x->index - y->index;
+}
+
+/*
+   find_duplicate_output :
+   Trie les noms de sortie (build_output_base avec un dossier vide) et compare les voisins.
+   Deux fichiers de même nom sans extension (x.txt et x.mtx, ou a/x.txt et b/x.txt)
+   écriraient les mêmes sorties en même temps depuis deux threads.
+*/
+int find_duplicate_output(char **paths, int count, int *first, int *second) {
+    if (count < 2) return 0;
+
+    t_output_name *names = (t_output_name *)malloc((size_t)count * sizeof(t_output_name));
+    if (names == NULL) {
+        perror("Allocation failed for batch output names");
+        return -1;
+    }
+    for (int i = 0; i < count; i++) {
+        build_output_base(paths[i], "", names[i].name, sizeof(names[i].name));
+        names[i].index = i;
+    }
+    qsort(names, count, sizeof(t_output_name), compare_output_names);
+
+    int found = 0;
+    for (int i = 1; i < count && !found; i++) {
+        if (strcmp(names[i - 1].name, names[i].name) == 0) {
+            *first = names[i - 1].index;
+            *second = names[i].index;
+            found = 1;
+        }
+    }
+    free(names);
+    return found;
+}
+
+//Écrit l'état v du fichier : son étiquette si le fichier en a, sinon son numéro.
+static void write_state(FILE *file, const t_markov_ctx *ctx, int v) {
+    const char *label = markov_state_label(ctx, v);
+    if (label != NULL) fprintf(file, "%s", label);
+    else fprintf(file, "%d", v);
+}
+
+/*
+   write_report :
+   Écrit le rapport texte d'un fichier : partition, liens de Hasse,
+   distribution limite partant du premier état du fichier et périodes.
+   Les états sont désignés comme dans le fichier (étiquette ou numéro d'origine).
+*/
+static int write_report(const char *report_path, const char *input_path, const t_markov_ctx *ctx) {
+    FILE *file = fopen(report_path, "w");
+    if (file == NULL) {
+        perror("Could not open report file for writing");
+        return -1;
+    }
+
+    fprintf(file, "Fichier : %s\n", input_path);
+    fprintf(file, "Sommets : %d\n\n", ctx->num_vertices);
+
+    fprintf(file, "Classes (%d) :\n", ctx->partition.num_classes);
+    for (int i = 0; i < ctx->partition.num_classes; i++) {
+        t_class c = ctx->partition.classes[i];
+        fprintf(file, "C%d (%s) : { ", c.id, c.is_persistent ? "Persistante" : "Transitoire");
+        for (int j = 0; j < c.num_members; j++) {
+            write_state(file, ctx, markov_original_id(ctx, c.members_ids[j]));
+            if (j < c.num_members - 1) fprintf(file, ", ");
+        }
+        fprintf(file, " }");
+        if (c.is_persistent) fprintf(file, " periode = %d", ctx->periods[i]);
+        fprintf(file, "\n");
+    }
+
+    fprintf(file, "\nLiens de Hasse :\n");
+    for (int i = 0; ctx->hasse_links != NULL && i < ctx->hasse_links->size; i++) {
+        fprintf(file, "C%d --> C%d\n", ctx->hasse_links->links[i].source_class_id,
+                ctx->hasse_links->links[i].dest_class_id);
+    }
+
+    fprintf(file, "\nDistribution stationnaire (Lim M^k, ligne de ");
+    write_state(file, ctx, 1);
+    fprintf(file, ") :\n");
+    double *limit = (double *)malloc(ctx->num_vertices * sizeof(double));
+    int failed = (limit == NULL || markov_limit_row(ctx, markov_internal_id(ctx, 1), limit) != MARKOV_OK);
+    for (int j = 1; j <= ctx->num_vertices && !failed; j++) {
+        write_state(file, ctx, j);
+        fprintf(file, " %.4f\n", limit[markov_internal_id(ctx, j) - 1]);
+    }
+    free(limit);
+    if (ctx->num_unconverged > 0) {
+        fprintf(file, "Avertissement : %d classe(s) sans convergence apres %d iterations : resultat approche.\n",
+                ctx->num_unconverged, MARKOV_STATIONARY_MAX_ITER);
+    }
+
+    fclose(file);
+    return failed ? -1 : 0;
+}
+
+//Traduit un code d'erreur de la bibliothèque en statut de batch.
+static t_batch_status batch_status_from(t_markov_status status) {
+    switch (status) {
+        case MARKOV_OK:             return BATCH_OK;
+        case MARKOV_ERR_NOT_MARKOV: return BATCH_NOT_MARKOV;
+        case MARKOV_ERR_NOMEM:      return BATCH_MEMORY_ERROR;
+        default:                    return BATCH_READ_ERROR;
+    }
+}
+
+/*
+   analyze_chain_file :
+   Pipeline complet d'un fichier avec la bibliothèque, sans affichage console
+   (plusieurs fichiers tournent en parallèle, chacun dans son propre contexte) :
+   lecture → vérification Markov → Tarjan → persistance → Hasse →
+   distribution stationnaire → période.
+   Produit <base>_graph.mmd, <base>_hasse.mmd et <base>_report.txt dans output_dir,
+   et remplit la ligne correspondante du tableau récapitulatif.
+   Avec un cache, une chaîne déjà vue ne coûte que lecture, empreinte et chargement.
+*/
+void analyze_chain_file(const char *input_path, const char *output_dir, const char *cache_dir, t_batch_result *result) {
+    double start = now_ms();
+    char base[BATCH_MAX_PATH];
+    char output_path[BATCH_MAX_PATH + 16];
+    t_markov_ctx ctx;
+
+    memset(result, 0, sizeof(*result));
+    strncpy(result->input_path, input_path, BATCH_MAX_PATH - 1);
+    markov_init(&ctx);
+
+    t_markov_status status = markov_load_file(&ctx, input_path);
+    if (status == MARKOV_OK) {
+        result->num_vertices = ctx.num_vertices;
+        result->num_edges = count_edges(ctx.graph);
+        status = markov_analyze_cached(&ctx, cache_dir, &result->cache_hit);
+    }
+    if (status != MARKOV_OK) {
+        result->status = batch_status_from(status);
+        markov_free(&ctx);
+        result->elapsed_ms = now_ms() - start;
+        return;
+    }
+
+    result->num_classes = ctx.partition.num_classes;
+    for (int i = 0; i < ctx.partition.num_classes; i++) {
+        t_class c = ctx.partition.classes[i];
+        if (!c.is_persistent) continue;
+
+        result->num_persistent++;
+        if (c.num_members == 1) result->num_absorbing++;
+        if (ctx.periods[i] > result->max_period) result->max_period = ctx.periods[i];
+    }
+
+    if (build_output_base(input_path, output_dir, base, sizeof(base)) != 0) {
+        result->status = BATCH_WRITE_ERROR;
+        markov_free(&ctx);
+        result->elapsed_ms = now_ms() - start;
+        return;
+    }
+    snprintf(output_path, sizeof(output_path), "%s_graph.mmd", base);
+    if (markov_write_mermaid(&ctx, output_path) != MARKOV_OK) result->status = BATCH_WRITE_ERROR;
+    snprintf(output_path, sizeof(output_path), "%s_hasse.mmd", base);
+    if (markov_write_hasse(&ctx, output_path) != MARKOV_OK) result->status = BATCH_WRITE_ERROR;
+    snprintf(output_path, sizeof(output_path), "%s_report.txt", base);
+    if (write_report(output_path, input_path, &ctx) != 0) result->status = BATCH_WRITE_ERROR;
+
+    markov_free(&ctx);
+    result->elapsed_ms = now_ms() - start;
+}
+
+//Données partagées par les threads du pool : chaque thread prend le prochain fichier libre.
+typedef struct s_batch_pool {
+    char **paths;
+    int count;
+    const char *output_dir;
+    const char *cache_dir;
+    t_batch_result *results;
+    atomic_int next_index;
+} t_batch_pool;
+
+/*
+   batch_worker :
+   Boucle d'un thread : réserve atomiquement l'indice du prochain fichier et l'analyse.
+   Les fichiers de tailles différentes se répartissent ainsi d'eux-mêmes entre les coeurs.
+*/
+static void *batch_worker(void *arg) {
+    t_batch_pool *pool = (t_batch_pool *)arg;
+    int index;
+
+    while ((index = atomic_fetch_add(&pool->next_index, 1)) < pool->count) {
+        analyze_chain_file(pool->paths[index], pool->output_dir, pool->cache_dir, &pool->results[index]);
+    }
+    return NULL;
+}
+
+/*
+   run_batch :
+   Lance num_jobs threads (par défaut un par coeur) qui se partagent la liste de fichiers.
+   Chaque résultat est rangé à l'indice du fichier : le tableau final suit l'ordre d'entrée.
+   Retourne le temps total écoulé en millisecondes.
+*/
+double run_batch(char **paths, int count, t_batch_options options, t_batch_result *results) {
+    t_batch_pool pool;
+    int num_jobs = options.num_jobs;
+    double start = now_ms();
+
+    if (count <= 0) return 0.0;
+    if (num_jobs <= 0) {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        num_jobs = (cores > 0) ? (int)cores : 1;
+    }
+    if (num_jobs > count) num_jobs = count;
+
+    pool.paths = paths;
+    pool.count = count;
+    pool.output_dir = (options.output_dir != NULL) ? options.output_dir : ".";
+    pool.cache_dir = options.cache_dir;
+    pool.results = results;
+    atomic_init(&pool.next_index, 0);
+
+    pthread_t *threads = (pthread_t *)malloc(num_jobs * sizeof(pthread_t));
+    if (threads == NULL) {
+        perror("Allocation failed for batch threads");
+        num_jobs = 0; // Repli : tout est fait par le thread appelant
+    }
+
+    int started = 0;
+    for (int i = 0; i < num_jobs; i++) {
+        if (pthread_create(&threads[i], NULL, batch_worker, &pool) != 0) {
+            fprintf(stderr, "Warning: could only start %d batch thread(s).\n", started);
+            break;
+        }
+        started++;
+    }
+
+    // Si aucun thread n'a pu démarrer, le thread principal fait tout le travail
+    if (started == 0) batch_worker(&pool);
+
+    for (int i = 0; i < started; i++) pthread_join(threads[i], NULL);
+    free(threads);
+
+    return now_ms() - start;
+}
+
+static const char *batch_status_label(t_batch_status status) {
+    switch (status) {
+        case BATCH_OK:          return "OK";
+        case BATCH_READ_ERROR:  return "Lecture";
+        case BATCH_NOT_MARKOV:  return "Non Markov";
+        case BATCH_WRITE_ERROR: return "Ecriture";
+        case BATCH_MEMORY_ERROR: return "Memoire";
+    }
+    return "?";
+}
+
+/*
+   display_batch_summary :
+   Affiche une ligne par fichier (dans l'ordre d'entrée), puis le total
+   et le débit en fichiers par seconde.
+*/
+int display_batch_summary(const t_batch_result *results, int count, double total_ms) {
+    int failures = 0, cache_hits = 0;
+
+    printf("%-40s | %-10s | %8s | %9s | %7s | %7s | %7s | %7s | %9s\n",
+           "Fichier", "Statut", "Sommets", "Aretes", "Classes", "Persist", "Absorb", "Periode", "Temps(ms)");
+    printf("-----------------------------------------+------------+----------+-----------+---------+---------+---------+---------+----------\n");
+
+    for (int i = 0; i < count; i++) {
+        const t_batch_result *r = &results[i];
+        if (r->status != BATCH_OK) failures++;
+        cache_hits += r->cache_hit;
+
+        printf("%-40s | %-10s | %8d | %9d | %7d | %7d | %7d | %7d | %9.2f\n",
+               r->input_path, batch_status_label(r->status), r->num_vertices, r->num_edges,
+               r->num_classes, r->num_persistent, r->num_absorbing, r->max_period, r->elapsed_ms);
+    }
+
+    printf("\n%d fichier(s) analyse(s), %d en echec, %.1f ms au total (%.1f fichiers/s).\n",
+           count, failures, total_ms, (total_ms > 0.0) ? count * 1000.0 / total_ms : 0.0);
+    if (cache_hits > 0) printf("%d fichier(s) lu(s) depuis le cache.\n", cache_hits);
+    return failures;
+}
@@ -0,0 +1,59 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#define BATCH_MAX_PATH 512
+
+//Statut d'analyse d'un fichier en mode batch.
+typedef enum e_batch_status {
+    BATCH_OK = 0,          // Pipeline complet exécuté
+    BATCH_READ_ERROR,      // Fichier illisible ou mal formé
+    BATCH_NOT_MARKOV,      // Somme des probabilités sortantes != 1 pour au moins un sommet
+    BATCH_WRITE_ERROR,     // Impossible d'écrire un des fichiers de sortie
+    BATCH_MEMORY_ERROR     // Mémoire insuffisante pour analyser le fichier
+} t_batch_status;
+
+//Résultat de l'analyse d'un fichier (une ligne du tableau récapitulatif).
+typedef struct s_batch_result {
+    char input_path[BATCH_MAX_PATH]; // Fichier analysé
+    t_batch_status status;
+    int num_vertices;      // Nombre de sommets
+    int num_edges;         // Nombre d'arêtes
+    int num_classes;       // Nombre de classes (CFCs)
+    int num_persistent;    // Nombre de classes persistantes
+    int num_absorbing;     // Nombre d'états absorbants
+    int max_period;        // Plus grande période parmi les classes persistantes
+    int cache_hit;         // 1 si les résultats viennent du cache (--cache)
+    double elapsed_ms;     // Temps d'analyse du fichier (ms)
+} t_batch_result;
+
+//Options du mode batch.
+typedef struct s_batch_options {
+    const char *output_dir; // Dossier des fichiers produits (mermaid + rapport), "." par défaut
+    int num_jobs;           // Nombre de threads, 0 = nombre de coeurs disponibles
+    const char *cache_dir;  // Dossier du cache de résultats (voir cache.h), NULL = pas de cache
+} t_batch_options;
+
+//Construit la liste des fichiers .txt et .mtx d'un dossier (triée par nom). Retourne le nombre de fichiers, -1 en cas d'erreur.
+int collect_batch_dir(const char *dir_path, char ***paths);
+
+//Lit une liste de fichiers (un chemin par ligne, lignes vides et '#' ignorées). Retourne le nombre de fichiers, -1 en cas d'erreur.
+int collect_batch_list(const char *list_path, char ***paths);
+
+//Libère une liste de chemins construite par collect_batch_dir / collect_batch_list.
+void free_batch_paths(char **paths, int count);
+
+//Cherche deux fichiers qui auraient les mêmes sorties (même nom sans dossier ni extension).
+//Retourne 1 et remplit first < second si oui, 0 sinon, -1 en cas d'erreur d'allocation.
+int find_duplicate_output(char **paths, int count, int *first, int *second);
+
+//Analyse un fichier complet (lecture, Markov, Tarjan, Hasse, distribution stationnaire, période) et écrit ses sorties.
+//Si cache_dir n'est pas NULL, les résultats sont lus dans le cache ou y sont enregistrés.
+void analyze_chain_file(const char *input_path, const char *output_dir, const char *cache_dir, t_batch_result *result);
+
+//Analyse tous les fichiers sur un pool de threads. results doit contenir count cases. Retourne le temps total (ms).
+double run_batch(char **paths, int count, t_batch_options options, t_batch_result *results);
+
+//Affiche le tableau récapitulatif du batch. Retourne le nombre de fichiers en échec.
+int display_batch_summary(const t_batch_result *results, int count, double total_ms);
+
+#endif // BATCH_H
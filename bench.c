@@ -0,0 +1,890 @@
+/*
+   bench.c : programme markov_bench.
+   Mesure le temps de chaque étape de l'analyse (lecture, vérification, Tarjan,
+   persistance, Hasse, index d'accessibilité et requêtes, conversion dense, produit en mémoire et par tuiles dans un
+   fichier projeté, distribution stationnaire, période, itérations creuses et Tarjan
+   avant et après renumérotation RCM, lots de petites chaînes, transposée et
+   itérations par tirage sur tous les coeurs, puis les mêmes calculs
+   sur la matrice par blocs de classes)
+   sur des chaînes synthétiques de taille, densité et famille variables (generator.c).
+   Chaque mesure est répétée après quelques exécutions de chauffe ; on publie la
+   médiane, les percentiles 90/99 et un débit. Les résultats peuvent être écrits
+   en JSON ou en CSV pour comparer deux versions du code.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include "graph.h"
+#include "markov_check.h"
+#include "tarjan.h"
+#include "characteristic.h"
+#include "hasse.h"
+#include "reach.h"
+#include "matrix.h"
+#include "period.h"
+#include "sparse.h"
+#include "block_matrix.h"
+#include "reorder.h"
+#include "small_chain.h"
+#include "tiled_matrix.h"
+#include "pull.h"
+#include "markov.h"
+#include "generator.h"
+
+#define BENCH_MAX_LIST 32
+#define BENCH_BLOCK_STEPS 10
+#define BENCH_REACH_QUERIES 1000000
+
+//Ensemble de travail du produit par tuiles : petit, pour que les matrices mesurées dépassent l'ensemble de travail.
+#define BENCH_TILED_WORKING_BYTES (1LL << 20)
+
+//Étapes mesurées, dans l'ordre du pipeline de main.c.
+typedef enum e_bench_phase {
+    PHASE_READ_GRAPH = 0,
+    PHASE_IS_MARKOV,
+    PHASE_TARJAN,
+    PHASE_PERSISTENCE,
+    PHASE_HASSE,
+    PHASE_REACH_BUILD,
+    PHASE_REACH_QUERY,
+    PHASE_TO_MATRIX,
+    PHASE_MULTIPLY,
+    PHASE_TILED_MULTIPLY,
+    PHASE_STATIONARY,
+    PHASE_PERIOD,
+    PHASE_SPMV,
+    PHASE_REORDER,
+    PHASE_SPMV_REORDERED,
+    PHASE_TARJAN_REORDERED,
+    PHASE_SMALL_BATCH,
+    PHASE_SMALL_GENERIC,
+    PHASE_TRANSPOSE,
+    PHASE_PULL_STEPS,
+    PHASE_BLOCK_BUILD,
+    PHASE_BLOCK_MULTIPLY,
+    PHASE_BLOCK_STEPS,
+    PHASE_BLOCK_ABSORPTION,
+    PHASE_COUNT
+} t_bench_phase;
+
+static const char *phase_names[PHASE_COUNT] = {
+    "read_graph", "is_markov_graph", "find_cfcs_tarjan", "set_persistence_flags",
+    "compute_hasse_diagram_links", "reach_build", "reach_classes", "adj_list_to_matrix", "multiply_matrices", "tiled_multiply",
+    "stationaryDistribution", "get_class_period", "k_step_distribution", "reorder_rcm",
+    "k_step_distribution_rcm", "find_cfcs_tarjan_rcm", "small_batch_solve", "markov_analyze_each",
+    "csr_transpose", "pull_k_step",
+    "csr_to_block_matrix", "block_matrix_multiply",
+    "block_k_step_distribution", "block_absorption_probabilities"
+};
+
+//Options de la ligne de commande.
+typedef struct s_bench_options {
+    int sizes[BENCH_MAX_LIST];
+    int num_sizes;
+    int densities[BENCH_MAX_LIST];
+    int num_densities;
+    int families[GEN_FAMILY_COUNT];
+    int num_families;
+    int warmup;            // Exécutions non mesurées avant les répétitions
+    int repeats;           // Exécutions mesurées
+    int dense_max;         // Étapes denses (N x N) seulement si N <= dense_max
+    long long block_max;   // Étapes par blocs seulement si la matrice par blocs stocke au plus block_max valeurs
+    int period;            // Période des chaînes "periodic", 0 = valeur par défaut du générateur
+    int shuffle;           // Numérotation aléatoire des sommets après la lecture (fichier sans localité)
+    int small_count;       // Chaînes par lot pour les étapes des petites chaînes (N <= SMALL_CHAIN_MAX_STATES)
+    uint64_t seed;
+    const char *format;    // "text", "json" ou "csv"
+    const char *output;    // Fichier de résultats, NULL = sortie standard
+} t_bench_options;
+
+//Une chaîne générée et tout ce qui sert d'entrée aux étapes mesurées.
+typedef struct s_bench_case {
+    t_gen_params params;   // Paramètres du générateur (famille, N, degré, graine)
+    int num_vertices;
+    int num_edges;
+    char path[64];         // Fichier temporaire au format data/
+    t_graph graph;
+    t_partition partition;
+    t_link_array *links;   // Liens entre classes
+    t_reach_index reach;   // Index d'accessibilité construit sur ces liens
+    int *query_from;       // BENCH_REACH_QUERIES paires de sommets (0-based) tirées au hasard
+    int *query_to;
+    t_matrix matrix;       // Matrice dense (N <= dense_max)
+    t_matrix sub_matrix;   // Sous-matrice de la plus grande classe (get_class_period)
+    t_tiled_matrix tiled;  // Matrice par tuiles dans /tmp (N <= dense_max)
+    t_csr csr;
+    t_graph reordered;     // Graphe renuméroté par Cuthill-McKee inverse
+    t_csr reordered_csr;
+    t_csr transposed;      // Arêtes entrantes (csr_transpose)
+    t_pull_team team;      // Threads des itérations par tirage, un par coeur
+    t_small_batch small;   // small_count copies de la chaîne (N <= SMALL_CHAIN_MAX_STATES)
+    int *from;             // Arêtes de la chaîne, pour markov_load_edges
+    int *to;
+    float *proba;
+    t_block_matrix blocks; // Matrice par blocs (au plus block_max valeurs)
+} t_bench_case;
+
+//Résultat d'une étape sur une chaîne (une ligne de la sortie).
+typedef struct s_bench_result {
+    t_gen_family family;
+    int num_vertices;
+    int num_edges;
+    int num_classes;
+    t_bench_phase phase;
+    double median_ms;
+    double p90_ms;
+    double p99_ms;
+    double min_ms;
+    double mean_ms;
+    double throughput;     // Unités de travail par seconde (sur la médiane)
+    const char *unit;      // "edges", "flop" ou "entries"
+} t_bench_result;
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+/*
+   silence_stdout / restore_stdout :
+   is_markov_graph et stationaryDistribution affichent des messages : on les
+   envoie vers /dev/null pendant les mesures pour ne pas chronométrer le terminal.
+*/
+static int silence_stdout(void) {
+    fflush(stdout);
+    int saved = dup(STDOUT_FILENO);
+    int devnull = open("/dev/null", O_WRONLY);
+    if (saved >= 0 && devnull >= 0) dup2(devnull, STDOUT_FILENO);
+    if (devnull >= 0) close(devnull);
+    return saved;
+}
+
+static void restore_stdout(int saved) {
+    if (saved < 0) return;
+    fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+}
+
+/*
+   write_case_file :
+   Écrit la chaîne dans un fichier temporaire au format data/ : read_graph est
+   ainsi mesuré sur un vrai fichier, comme dans le programme principal.
+*/
+static int write_case_file(t_bench_case *bc) {
+    strcpy(bc->path, "/tmp/markov_bench_XXXXXX");
+    int fd = mkstemp(bc->path);
+    if (fd < 0) {
+        perror("Could not create benchmark file");
+        return -1;
+    }
+    FILE *file = fdopen(fd, "w");
+    if (file == NULL) {
+        perror("Could not open benchmark file");
+        close(fd);
+        return -1;
+    }
+
+    long long num_edges = gen_write_chain(&bc->params, file, 1);
+    if (fclose(file) != 0 || num_edges < 0) return -1;
+    bc->num_edges = (int)num_edges;
+    return 0;
+}
+
+/*
+   shuffle_graph :
+   Remplace le graphe par une renumérotation aléatoire (Fisher-Yates, xorshift64 graine
+   seed) : simule un fichier dont les états sont numérotés sans rapport avec la structure.
+*/
+static int shuffle_graph(t_graph *graph, uint64_t seed) {
+    int N = graph->num_vertices;
+    int *order = (int *)malloc(N * sizeof(int));
+    if (order == NULL) return -1;
+
+    uint64_t state = seed * 0x9E3779B97F4A7C15ULL + 1;
+    for (int p = 0; p < N; p++) order[p] = p;
+    for (int p = N - 1; p > 0; p--) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        int q = (int)(state % (uint64_t)(p + 1));
+        int t = order[p];
+        order[p] = order[q];
+        order[q] = t;
+    }
+
+    t_graph shuffled = permute_graph(*graph, order);
+    free(order);
+    if (shuffled.adj_lists == NULL) return -1;
+    free_graph(*graph);
+    *graph = shuffled;
+    return 0;
+}
+
+/*
+   build_case :
+   Génère la chaîne (generator.c), l'écrit sur disque, la relit et prépare les entrées de
+   chaque étape (partition, liens, index d'accessibilité et paires de sommets des requêtes, matrice dense, sous-matrice et matrice par tuiles
+   si N <= dense_max, graphe et CSR renumérotés par RCM, lot de petites chaînes si N <= SMALL_CHAIN_MAX_STATES,
+   matrice par blocs si elle stocke au plus block_max valeurs). Avec --shuffle, le graphe
+   lu est d'abord renuméroté au hasard.
+*/
+static int build_case(t_bench_case *bc, t_gen_family family, int N, int degree,
+                      const t_bench_options *options) {
+    memset(bc, 0, sizeof(*bc));
+    gen_default_params(&bc->params, family, N, degree, options->seed);
+    if (options->period > 0) bc->params.period = options->period;
+    if (gen_normalize(&bc->params) != 0) return -1;
+    bc->num_vertices = bc->params.num_vertices;
+
+    if (write_case_file(bc) != 0) return -1;
+
+    bc->graph = read_graph(bc->path);
+    if (bc->graph.adj_lists == NULL) return -1;
+    if (options->shuffle && shuffle_graph(&bc->graph, options->seed) != 0) return -1;
+    bc->partition = find_cfcs_tarjan(bc->graph);
+    if (bc->partition.v_data == NULL) return -1;
+    set_persistence_flags(bc->graph, &bc->partition);
+
+    bc->links = compute_hasse_diagram_links(bc->graph, bc->partition);
+    if (bc->links == NULL || reach_build(&bc->reach, bc->partition, bc->links) != 0) return -1;
+    bc->query_from = (int *)malloc(BENCH_REACH_QUERIES * sizeof(int));
+    bc->query_to = (int *)malloc(BENCH_REACH_QUERIES * sizeof(int));
+    if (bc->query_from == NULL || bc->query_to == NULL) return -1;
+    uint64_t state = options->seed * 0x9E3779B97F4A7C15ULL + 1;
+    for (int q = 0; q < 2 * BENCH_REACH_QUERIES; q++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        int *target = (q % 2 == 0) ? bc->query_from : bc->query_to;
+        target[q / 2] = (int)(state % (uint64_t)bc->num_vertices);
+    }
+
+    if (N <= options->dense_max) {
+        bc->matrix = adj_list_to_matrix(bc->graph);
+        if (bc->matrix.data == NULL) return -1;
+
+        int largest = 0;
+        for (int i = 1; i < bc->partition.num_classes; i++) {
+            if (bc->partition.classes[i].num_members > bc->partition.classes[largest].num_members) largest = i;
+        }
+        bc->sub_matrix = subMatrix(bc->matrix, bc->partition, largest);
+        if (bc->sub_matrix.data == NULL) return -1;
+    }
+
+    bc->csr = graph_to_csr(bc->graph);
+    if (bc->csr.row_ptr == NULL) return -1;
+
+    if (N <= options->dense_max) {
+        bc->tiled = tiled_from_csr(&bc->csr, BENCH_TILED_WORKING_BYTES, "/tmp");
+        if (bc->tiled.data == NULL) return -1;
+    }
+
+    bc->transposed = csr_transpose(&bc->csr);
+    if (bc->transposed.row_ptr == NULL || pull_team_init(&bc->team, &bc->transposed, 0) != 0) return -1;
+
+    int *order = reorder_rcm(bc->graph);
+    if (order == NULL) return -1;
+    bc->reordered = permute_graph(bc->graph, order);
+    free(order);
+    if (bc->reordered.adj_lists == NULL) return -1;
+    bc->reordered_csr = graph_to_csr(bc->reordered);
+    if (bc->reordered_csr.row_ptr == NULL) return -1;
+
+    if (bc->num_vertices <= SMALL_CHAIN_MAX_STATES) {
+        if (small_batch_init(&bc->small, bc->num_vertices, options->small_count) != 0) return -1;
+        while (bc->small.count < options->small_count) small_batch_add_graph(&bc->small, bc->graph);
+
+        bc->from = (int *)malloc(bc->num_edges * sizeof(int));
+        bc->to = (int *)malloc(bc->num_edges * sizeof(int));
+        bc->proba = (float *)malloc(bc->num_edges * sizeof(float));
+        if (bc->from == NULL || bc->to == NULL || bc->proba == NULL) return -1;
+        int e = 0;
+        for (int v = 0; v < bc->num_vertices; v++) {
+            for (t_edge *edge = bc->graph.adj_lists[v].head; edge != NULL; edge = edge->next, e++) {
+                bc->from[e] = v + 1;
+                bc->to[e] = edge->destination;
+                bc->proba[e] = edge->probability;
+            }
+        }
+    }
+
+    long long entries = block_matrix_entries(&bc->csr, bc->partition);
+    if (entries < 0) return -1;
+    if (entries <= options->block_max) {
+        bc->blocks = csr_to_block_matrix(&bc->csr, bc->partition);
+        if (bc->blocks.blocks == NULL) return -1;
+    }
+    return 0;
+}
+
+static void free_case(t_bench_case *bc) {
+    free_graph(bc->graph);
+    free_partition(bc->partition);
+    free_link_array(bc->links);
+    reach_free(&bc->reach);
+    free(bc->query_from);
+    free(bc->query_to);
+    free_matrix(bc->matrix);
+    free_matrix(bc->sub_matrix);
+    tiled_free(bc->tiled);
+    free_csr(bc->csr);
+    free_graph(bc->reordered);
+    free_csr(bc->reordered_csr);
+    pull_team_free(&bc->team);
+    free_csr(bc->transposed);
+    small_batch_free(&bc->small);
+    free(bc->from);
+    free(bc->to);
+    free(bc->proba);
+    free_block_matrix(bc->blocks);
+    if (bc->path[0] != '\0') unlink(bc->path);
+}
+
+/*
+   run_phase :
+   Exécute une fois l'étape demandée et retourne sa durée en ms (-1 si échec).
+   Seul l'appel mesuré est chronométré : la libération du résultat ne l'est pas.
+*/
+static double run_phase(t_bench_phase phase, t_bench_case *bc) {
+    double start, elapsed;
+    int saved;
+
+    switch (phase) {
+        case PHASE_READ_GRAPH: {
+            start = now_ms();
+            t_graph graph = read_graph(bc->path);
+            elapsed = now_ms() - start;
+            if (graph.adj_lists == NULL) return -1.0;
+            free_graph(graph);
+            return elapsed;
+        }
+        case PHASE_IS_MARKOV:
+            saved = silence_stdout();
+            start = now_ms();
+            is_markov_graph(bc->graph);
+            elapsed = now_ms() - start;
+            restore_stdout(saved);
+            return elapsed;
+
+        case PHASE_TARJAN: {
+            start = now_ms();
+            t_partition partition = find_cfcs_tarjan(bc->graph);
+            elapsed = now_ms() - start;
+            if (partition.v_data == NULL) return -1.0;
+            free_partition(partition);
+            return elapsed;
+        }
+        case PHASE_PERSISTENCE:
+            start = now_ms();
+            set_persistence_flags(bc->graph, &bc->partition);
+            return now_ms() - start;
+
+        case PHASE_HASSE: {
+            start = now_ms();
+            t_link_array *links = compute_hasse_diagram_links(bc->graph, bc->partition);
+            elapsed = now_ms() - start;
+            if (links == NULL) return -1.0;
+            free_link_array(links);
+            return elapsed;
+        }
+        case PHASE_REACH_BUILD: {
+            t_reach_index reach;
+            start = now_ms();
+            int status = reach_build(&reach, bc->partition, bc->links);
+            elapsed = now_ms() - start;
+            if (status != 0) return -1.0;
+            reach_free(&reach);
+            return elapsed;
+        }
+        case PHASE_REACH_QUERY: {
+            // Requêtes sommet à sommet, comme markov_reachable : classe de chaque sommet, puis l'index
+            const t_tarjan_vertex *v_data = bc->partition.v_data;
+            volatile int reachable = 0;
+            start = now_ms();
+            for (int q = 0; q < BENCH_REACH_QUERIES; q++) {
+                reachable += reach_classes(&bc->reach, v_data[bc->query_from[q]].class_id, v_data[bc->query_to[q]].class_id);
+            }
+            return now_ms() - start;
+        }
+        case PHASE_TO_MATRIX: {
+            start = now_ms();
+            t_matrix M = adj_list_to_matrix(bc->graph);
+            elapsed = now_ms() - start;
+            if (M.data == NULL) return -1.0;
+            free_matrix(M);
+            return elapsed;
+        }
+        case PHASE_MULTIPLY: {
+            start = now_ms();
+            t_matrix M2 = multiply_matrices(bc->matrix, bc->matrix);
+            elapsed = now_ms() - start;
+            if (M2.data == NULL) return -1.0;
+            free_matrix(M2);
+            return elapsed;
+        }
+        case PHASE_TILED_MULTIPLY: {
+            start = now_ms();
+            t_tiled_matrix M2 = tiled_multiply(&bc->tiled, &bc->tiled, "/tmp");
+            elapsed = now_ms() - start;
+            if (M2.data == NULL) return -1.0;
+            tiled_free(M2);
+            return elapsed;
+        }
+        case PHASE_STATIONARY: {
+            saved = silence_stdout();
+            start = now_ms();
+            t_matrix limit = stationaryDistribution(bc->matrix);
+            elapsed = now_ms() - start;
+            restore_stdout(saved);
+            if (limit.data == NULL) return -1.0;
+            free_matrix(limit);
+            return elapsed;
+        }
+        case PHASE_PERIOD:
+            start = now_ms();
+            int period = get_class_period(bc->sub_matrix);
+            elapsed = now_ms() - start;
+            return (period < 0) ? -1.0 : elapsed;
+
+        case PHASE_SPMV:
+        case PHASE_SPMV_REORDERED: {
+            const t_csr *P = (phase == PHASE_SPMV) ? &bc->csr : &bc->reordered_csr;
+            double *x0 = (double *)malloc(bc->num_vertices * sizeof(double));
+            double *out = (double *)malloc(bc->num_vertices * sizeof(double));
+            if (x0 == NULL || out == NULL) {
+                free(x0);
+                free(out);
+                return -1.0;
+            }
+            for (int v = 0; v < bc->num_vertices; v++) x0[v] = 1.0 / bc->num_vertices;
+            start = now_ms();
+            int status = k_step_distribution(P, x0, BENCH_BLOCK_STEPS, out);
+            elapsed = now_ms() - start;
+            free(x0);
+            free(out);
+            return (status != 0) ? -1.0 : elapsed;
+        }
+        case PHASE_REORDER: {
+            start = now_ms();
+            int *order = reorder_rcm(bc->graph);
+            t_graph reordered = (order != NULL) ? permute_graph(bc->graph, order) : (t_graph){NULL, 0};
+            elapsed = now_ms() - start;
+            free(order);
+            if (reordered.adj_lists == NULL) return -1.0;
+            free_graph(reordered);
+            return elapsed;
+        }
+        case PHASE_TARJAN_REORDERED: {
+            start = now_ms();
+            t_partition partition = find_cfcs_tarjan(bc->reordered);
+            elapsed = now_ms() - start;
+            if (partition.v_data == NULL) return -1.0;
+            free_partition(partition);
+            return elapsed;
+        }
+        case PHASE_SMALL_BATCH:
+            start = now_ms();
+            small_batch_solve(&bc->small);
+            return now_ms() - start;
+
+        case PHASE_SMALL_GENERIC: {
+            // Même travail chaîne par chaîne avec la bibliothèque : liste d'adjacence, Tarjan, CSR, itérations
+            t_markov_ctx ctx;
+            t_markov_status status = MARKOV_OK;
+            markov_init(&ctx);
+            start = now_ms();
+            for (int c = 0; c < bc->small.count && status == MARKOV_OK; c++) {
+                status = markov_load_edges(&ctx, bc->num_vertices, bc->num_edges, bc->from, bc->to, bc->proba);
+                if (status == MARKOV_OK) status = markov_analyze(&ctx);
+                markov_free(&ctx);
+            }
+            elapsed = now_ms() - start;
+            return (status != MARKOV_OK) ? -1.0 : elapsed;
+        }
+        case PHASE_TRANSPOSE: {
+            start = now_ms();
+            t_csr transposed = csr_transpose(&bc->csr);
+            elapsed = now_ms() - start;
+            if (transposed.row_ptr == NULL) return -1.0;
+            free_csr(transposed);
+            return elapsed;
+        }
+        case PHASE_PULL_STEPS: {
+            double *x0 = (double *)malloc(bc->num_vertices * sizeof(double));
+            double *out = (double *)malloc(bc->num_vertices * sizeof(double));
+            if (x0 == NULL || out == NULL) {
+                free(x0);
+                free(out);
+                return -1.0;
+            }
+            for (int v = 0; v < bc->num_vertices; v++) x0[v] = 1.0 / bc->num_vertices;
+            start = now_ms();
+            int status = pull_k_step(&bc->team, x0, BENCH_BLOCK_STEPS, out);
+            elapsed = now_ms() - start;
+            free(x0);
+            free(out);
+            return (status != 0) ? -1.0 : elapsed;
+        }
+        case PHASE_BLOCK_BUILD: {
+            start = now_ms();
+            t_block_matrix blocks = csr_to_block_matrix(&bc->csr, bc->partition);
+            elapsed = now_ms() - start;
+            if (blocks.blocks == NULL) return -1.0;
+            free_block_matrix(blocks);
+            return elapsed;
+        }
+        case PHASE_BLOCK_MULTIPLY: {
+            start = now_ms();
+            t_block_matrix squared = block_matrix_multiply(&bc->blocks, &bc->blocks);
+            elapsed = now_ms() - start;
+            if (squared.blocks == NULL) return -1.0;
+            free_block_matrix(squared);
+            return elapsed;
+        }
+        case PHASE_BLOCK_STEPS: {
+            double *x0 = (double *)calloc(bc->num_vertices, sizeof(double));
+            double *out = (double *)malloc(bc->num_vertices * sizeof(double));
+            if (x0 == NULL || out == NULL) {
+                free(x0);
+                free(out);
+                return -1.0;
+            }
+            x0[0] = 1.0;
+            start = now_ms();
+            int status = block_k_step_distribution(&bc->blocks, x0, BENCH_BLOCK_STEPS, out);
+            elapsed = now_ms() - start;
+            free(x0);
+            free(out);
+            return (status != 0) ? -1.0 : elapsed;
+        }
+        case PHASE_BLOCK_ABSORPTION: {
+            double *absorb = NULL;
+            int *persistent_index = (int *)malloc(bc->partition.num_classes * sizeof(int));
+            if (persistent_index == NULL) return -1.0;
+            start = now_ms();
+            int K = block_absorption_probabilities(&bc->blocks, bc->partition, &absorb, persistent_index);
+            elapsed = now_ms() - start;
+            free(absorb);
+            free(persistent_index);
+            return (K < 0) ? -1.0 : elapsed;
+        }
+
+        default:
+            return -1.0;
+    }
+}
+
+//Quantité de travail d'une étape, pour le débit : arêtes, opérations flottantes ou cases de matrice.
+static double phase_work(t_bench_phase phase, const t_bench_case *bc, const char **unit) {
+    double n = bc->num_vertices;
+    switch (phase) {
+        case PHASE_MULTIPLY:
+        case PHASE_TILED_MULTIPLY:
+            *unit = "flop";
+            return 2.0 * n * n * n;
+        case PHASE_TO_MATRIX:
+        case PHASE_STATIONARY:
+            *unit = "entries";
+            return n * n;
+        case PHASE_PERIOD:
+            *unit = "entries";
+            return (double)bc->sub_matrix.rows * bc->sub_matrix.rows;
+        case PHASE_BLOCK_BUILD:
+        case PHASE_BLOCK_MULTIPLY:
+        case PHASE_BLOCK_ABSORPTION:
+            *unit = "entries";
+            return (double)bc->blocks.num_entries;
+        case PHASE_SPMV:
+        case PHASE_SPMV_REORDERED:
+        case PHASE_PULL_STEPS:
+            *unit = "edges";
+            return (double)BENCH_BLOCK_STEPS * bc->num_edges;
+        case PHASE_SMALL_BATCH:
+        case PHASE_SMALL_GENERIC:
+            *unit = "chains";
+            return bc->small.count;
+        case PHASE_REACH_BUILD:
+            *unit = "classes";
+            return bc->partition.num_classes;
+        case PHASE_REACH_QUERY:
+            *unit = "queries";
+            return BENCH_REACH_QUERIES;
+        case PHASE_BLOCK_STEPS:
+            *unit = "entries";
+            return (double)BENCH_BLOCK_STEPS * bc->blocks.num_entries;
+        default:
+            *unit = "edges";
+            return bc->num_edges;
+    }
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+//Percentile par rang le plus proche sur un tableau trié.
+static double percentile(const double *sorted, int count, double p) {
+    int rank = (int)(p / 100.0 * count + 0.999999);
+    if (rank < 1) rank = 1;
+    if (rank > count) rank = count;
+    return sorted[rank - 1];
+}
+
+/*
+   measure_phase :
+   warmup exécutions ignorées, puis repeats exécutions mesurées et résumées.
+   Retourne 0 si succès, -1 si une exécution a échoué.
+*/
+static int measure_phase(t_bench_phase phase, t_bench_case *bc, const t_bench_options *options,
+                         t_bench_result *result) {
+    double *samples = (double *)malloc(options->repeats * sizeof(double));
+    if (samples == NULL) return -1;
+
+    for (int w = 0; w < options->warmup; w++) {
+        if (run_phase(phase, bc) < 0) {
+            free(samples);
+            return -1;
+        }
+    }
+
+    double total = 0.0;
+    for (int r = 0; r < options->repeats; r++) {
+        samples[r] = run_phase(phase, bc);
+        if (samples[r] < 0) {
+            free(samples);
+            return -1;
+        }
+        total += samples[r];
+    }
+    qsort(samples, options->repeats, sizeof(double), compare_double);
+
+    result->family = bc->params.family;
+    result->num_vertices = bc->num_vertices;
+    result->num_edges = bc->num_edges;
+    result->num_classes = bc->partition.num_classes;
+    result->phase = phase;
+    result->median_ms = percentile(samples, options->repeats, 50.0);
+    result->p90_ms = percentile(samples, options->repeats, 90.0);
+    result->p99_ms = percentile(samples, options->repeats, 99.0);
+    result->min_ms = samples[0];
+    result->mean_ms = total / options->repeats;
+
+    double work = phase_work(phase, bc, &result->unit);
+    result->throughput = (result->median_ms > 0.0) ? work / (result->median_ms / 1000.0) : 0.0;
+
+    free(samples);
+    return 0;
+}
+
+static void write_text(FILE *out, const t_bench_result *results, int count) {
+    fprintf(out, "%-11s %7s %9s %7s  %-28s %11s %11s %11s %14s\n",
+            "famille", "N", "aretes", "classes", "etape", "mediane(ms)", "p90(ms)", "p99(ms)", "debit(/s)");
+    for (int i = 0; i < count; i++) {
+        const t_bench_result *r = &results[i];
+        fprintf(out, "%-11s %7d %9d %7d  %-28s %11.4f %11.4f %11.4f %10.3e %s\n",
+                gen_family_name(r->family), r->num_vertices, r->num_edges, r->num_classes,
+                phase_names[r->phase], r->median_ms, r->p90_ms, r->p99_ms, r->throughput, r->unit);
+    }
+}
+
+static void write_csv(FILE *out, const t_bench_result *results, int count) {
+    fprintf(out, "family,num_vertices,num_edges,num_classes,phase,median_ms,p90_ms,p99_ms,min_ms,mean_ms,throughput,unit\n");
+    for (int i = 0; i < count; i++) {
+        const t_bench_result *r = &results[i];
+        fprintf(out, "%s,%d,%d,%d,%s,%.6f,%.6f,%.6f,%.6f,%.6f,%.6e,%s\n",
+                gen_family_name(r->family), r->num_vertices, r->num_edges, r->num_classes,
+                phase_names[r->phase], r->median_ms, r->p90_ms, r->p99_ms, r->min_ms, r->mean_ms,
+                r->throughput, r->unit);
+    }
+}
+
+static void write_json(FILE *out, const t_bench_result *results, int count, const t_bench_options *options) {
+    fprintf(out, "{\n  \"benchmark\": \"markov_bench\",\n");
+    fprintf(out, "  \"seed\": %llu,\n  \"warmup\": %d,\n  \"repeats\": %d,\n  \"dense_max\": %d,\n  \"block_max\": %lld,\n  \"shuffle\": %d,\n  \"small_count\": %d,\n",
+            (unsigned long long)options->seed, options->warmup, options->repeats, options->dense_max, options->block_max,
+            options->shuffle, options->small_count);
+    fprintf(out, "  \"results\": [\n");
+    for (int i = 0; i < count; i++) {
+        const t_bench_result *r = &results[i];
+        fprintf(out, "    {\"family\": \"%s\", \"num_vertices\": %d, \"num_edges\": %d, \"num_classes\": %d, "
+                     "\"phase\": \"%s\", \"median_ms\": %.6f, \"p90_ms\": %.6f, \"p99_ms\": %.6f, "
+                     "\"min_ms\": %.6f, \"mean_ms\": %.6f, \"throughput\": %.6e, \"unit\": \"%s\"}%s\n",
+                gen_family_name(r->family), r->num_vertices, r->num_edges, r->num_classes,
+                phase_names[r->phase], r->median_ms, r->p90_ms, r->p99_ms, r->min_ms, r->mean_ms,
+                r->throughput, r->unit, (i < count - 1) ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+}
+
+//Lit une liste d'entiers séparés par des virgules ("100,1000"). Retourne le nombre lu, -1 si invalide.
+static int parse_int_list(const char *text, int *values) {
+    int count = 0;
+    const char *p = text;
+    while (*p != '\0' && count < BENCH_MAX_LIST) {
+        char *end;
+        long value = strtol(p, &end, 10);
+        if (end == p || value <= 0) return -1;
+        values[count++] = (int)value;
+        if (*end == ',') end++;
+        else if (*end != '\0') return -1;
+        p = end;
+    }
+    return count;
+}
+
+static int parse_families(const char *text, int *families) {
+    int count = 0;
+    char buffer[128];
+    strncpy(buffer, text, sizeof(buffer) - 1);
+    buffer[sizeof(buffer) - 1] = '\0';
+
+    for (char *name = strtok(buffer, ","); name != NULL; name = strtok(NULL, ",")) {
+        int family = gen_family_from_name(name);
+        if (family < 0 || count >= GEN_FAMILY_COUNT) return -1;
+        families[count++] = family;
+    }
+    return count;
+}
+
+static void print_usage(const char *program_name) {
+    printf("Usage : %s [options]\n", program_name);
+    printf("  --sizes N1,N2,...        Nombres de sommets (defaut 64,1000,4000)\n");
+    printf("  --densities D1,D2,...    Degres sortants (defaut 4,16)\n");
+    printf("  --families F1,F2,...     random, banded, absorbing, periodic, powerlaw (defaut : toutes)\n");
+    printf("  --warmup W               Executions de chauffe non mesurees (defaut 1)\n");
+    printf("  --repeats R              Executions mesurees (defaut 5)\n");
+    printf("  --dense-max N            Etapes denses seulement si N <= cette valeur (defaut 128)\n");
+    printf("  --block-max V            Etapes par blocs seulement si la matrice par blocs stocke au plus V valeurs (defaut 16000000)\n");
+    printf("  --period P               Periode des chaines periodic (defaut 4)\n");
+    printf("  --shuffle                Numerote les etats au hasard apres la lecture (mesure du gain de --reorder)\n");
+    printf("  --small-count C          Chaines par lot pour les tailles N <= %d (defaut 65536)\n", SMALL_CHAIN_MAX_STATES);
+    printf("  --seed S                 Graine du generateur (defaut 1)\n");
+    printf("  --format text|json|csv   Format des resultats (defaut text)\n");
+    printf("  --output FICHIER         Ecrit les resultats dans un fichier au lieu de la sortie standard\n");
+}
+
+int main(int argc, char *argv[]) {
+    t_bench_options options = {
+        .sizes = {64, 1000, 4000}, .num_sizes = 3,
+        .densities = {4, 16}, .num_densities = 2,
+        .families = {GEN_RANDOM, GEN_BANDED, GEN_ABSORBING, GEN_PERIODIC, GEN_POWERLAW},
+        .num_families = GEN_FAMILY_COUNT,
+        .warmup = 1, .repeats = 5, .dense_max = 128, .block_max = 16000000, .period = 0, .shuffle = 0,
+        .small_count = 65536,
+        .seed = 1, .format = "text", .output = NULL
+    };
+
+    for (int i = 1; i < argc; i++) {
+        int ok = 1;
+        if (strcmp(argv[i], "--sizes") == 0 && i + 1 < argc) {
+            ok = (options.num_sizes = parse_int_list(argv[++i], options.sizes)) > 0;
+        } else if (strcmp(argv[i], "--densities") == 0 && i + 1 < argc) {
+            ok = (options.num_densities = parse_int_list(argv[++i], options.densities)) > 0;
+        } else if (strcmp(argv[i], "--families") == 0 && i + 1 < argc) {
+            ok = (options.num_families = parse_families(argv[++i], options.families)) > 0;
+        } else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc) {
+            options.warmup = atoi(argv[++i]);
+            ok = options.warmup >= 0;
+        } else if (strcmp(argv[i], "--repeats") == 0 && i + 1 < argc) {
+            options.repeats = atoi(argv[++i]);
+            ok = options.repeats > 0;
+        } else if (strcmp(argv[i], "--dense-max") == 0 && i + 1 < argc) {
+            options.dense_max = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--block-max") == 0 && i + 1 < argc) {
+            options.block_max = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "--period") == 0 && i + 1 < argc) {
+            options.period = atoi(argv[++i]);
+            ok = options.period > 0;
+        } else if (strcmp(argv[i], "--shuffle") == 0) {
+            options.shuffle = 1;
+        } else if (strcmp(argv[i], "--small-count") == 0 && i + 1 < argc) {
+            options.small_count = atoi(argv[++i]);
+            ok = options.small_count > 0;
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            options.seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+            options.format = argv[++i];
+            ok = strcmp(options.format, "text") == 0 || strcmp(options.format, "json") == 0
+                 || strcmp(options.format, "csv") == 0;
+        } else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            options.output = argv[++i];
+        } else if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) {
+            print_usage(argv[0]);
+            return EXIT_SUCCESS;
+        } else {
+            ok = 0;
+        }
+        if (!ok) {
+            fprintf(stderr, "Option invalide : %s\n", argv[i]);
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    int max_results = options.num_families * options.num_sizes * options.num_densities * PHASE_COUNT;
+    t_bench_result *results = (t_bench_result *)malloc(max_results * sizeof(t_bench_result));
+    if (results == NULL) {
+        perror("Allocation failed for benchmark results");
+        return EXIT_FAILURE;
+    }
+
+    int count = 0, failures = 0;
+    for (int f = 0; f < options.num_families; f++) {
+        t_gen_family family = (t_gen_family)options.families[f];
+        for (int n = 0; n < options.num_sizes; n++) {
+            for (int d = 0; d < options.num_densities; d++) {
+                t_bench_case bc;
+                if (build_case(&bc, family, options.sizes[n], options.densities[d], &options) != 0) {
+                    fprintf(stderr, "Echec de generation : %s N=%d D=%d\n",
+                            gen_family_name(family), options.sizes[n], options.densities[d]);
+                    free_case(&bc);
+                    failures++;
+                    continue;
+                }
+                fprintf(stderr, "[bench] %s N=%d aretes=%d classes=%d\n", gen_family_name(family),
+                        bc.num_vertices, bc.num_edges, bc.partition.num_classes);
+                fprintf(stderr, "[bench] index d'accessibilite : %.1f Ko, %d classe(s) en tableau de bits, %lld intervalle(s)\n",
+                        reach_index_bytes(&bc.reach) / 1024.0, bc.reach.num_dense, bc.reach.num_intervals);
+
+                for (int p = 0; p < PHASE_COUNT; p++) {
+                    if (p >= PHASE_TO_MATRIX && p <= PHASE_PERIOD && bc.matrix.data == NULL) continue;
+                    if ((p == PHASE_SMALL_BATCH || p == PHASE_SMALL_GENERIC) && bc.small.P == NULL) continue;
+                    if (p >= PHASE_BLOCK_BUILD && bc.blocks.blocks == NULL) break;
+                    if (measure_phase((t_bench_phase)p, &bc, &options, &results[count]) == 0) {
+                        count++;
+                    } else {
+                        fprintf(stderr, "Echec de la mesure %s\n", phase_names[p]);
+                        failures++;
+                    }
+                }
+                free_case(&bc);
+            }
+        }
+    }
+
+    FILE *out = stdout;
+    if (options.output != NULL) {
+        out = fopen(options.output, "w");
+        if (out == NULL) {
+            perror("Could not open benchmark output file");
+            free(results);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (strcmp(options.format, "json") == 0) write_json(out, results, count, &options);
+    else if (strcmp(options.format, "csv") == 0) write_csv(out, results, count);
+    else write_text(out, results, count);
+
+    if (out != stdout) fclose(out);
+    free(results);
+    return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
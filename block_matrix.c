@@ -0,0 +1,765 @@
+#include "block_matrix.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "profile.h"
+
+//Nombre de sommets du bloc b.
+static int block_size(const t_block_matrix *M, int b) {
+    return M->start[b + 1] - M->start[b];
+}
+
+static int compare_int(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+void free_block_matrix(t_block_matrix M) {
+    free(M.start);
+    free(M.perm);
+    free(M.position);
+    free(M.row_ptr);
+    free(M.blocks);
+    free(M.values);
+}
+
+/*
+   alloc_layout :
+   Alloue le découpage (start, perm, position, row_ptr) d'une matrice vide.
+   Si src n'est pas NULL, start, perm et position en sont recopiés.
+   Retourne 0, ou -1 si la mémoire manque (M est alors libérable).
+*/
+static int alloc_layout(t_block_matrix *M, int N, int num_classes, const t_block_matrix *src) {
+    memset(M, 0, sizeof(*M));
+    M->num_vertices = N;
+    M->num_classes = num_classes;
+    M->start = (int *)malloc((num_classes + 1) * sizeof(int));
+    M->perm = (int *)malloc((N > 0 ? N : 1) * sizeof(int));
+    M->position = (int *)malloc((N > 0 ? N : 1) * sizeof(int));
+    M->row_ptr = (int *)malloc((num_classes + 1) * sizeof(int));
+    if (M->start == NULL || M->perm == NULL || M->position == NULL || M->row_ptr == NULL) {
+        perror("Allocation failed for block matrix layout");
+        return -1;
+    }
+    if (src != NULL) {
+        memcpy(M->start, src->start, (num_classes + 1) * sizeof(int));
+        memcpy(M->perm, src->perm, N * sizeof(int));
+        memcpy(M->position, src->position, N * sizeof(int));
+    }
+    return 0;
+}
+
+//Alloue les blocs et les valeurs (à zéro) une fois row_ptr et num_entries connus. Retourne -1 si la mémoire manque.
+static int alloc_blocks(t_block_matrix *M) {
+    M->num_blocks = M->row_ptr[M->num_classes];
+    M->blocks = (t_block *)malloc((M->num_blocks > 0 ? M->num_blocks : 1) * sizeof(t_block));
+    M->values = (float *)calloc(M->num_entries > 0 ? M->num_entries : 1, sizeof(float));
+    if (M->blocks == NULL || M->values == NULL) {
+        perror("Allocation failed for block matrix values");
+        return -1;
+    }
+    profile_count_alloc(M->num_entries * sizeof(float));
+    return 0;
+}
+
+//Matrice vide renvoyée en cas d'échec : blocks vaut NULL.
+static t_block_matrix failed_block_matrix(t_block_matrix *M) {
+    free_block_matrix(*M);
+    memset(M, 0, sizeof(*M));
+    return *M;
+}
+
+long long block_matrix_entries(const t_csr *P, t_partition partition) {
+    int C = partition.num_classes;
+    int *seen = (int *)malloc((C > 0 ? C : 1) * sizeof(int));
+    if (seen == NULL) {
+        perror("Allocation failed for block matrix count");
+        return -1;
+    }
+    for (int c = 0; c < C; c++) seen[c] = -1;
+
+    long long entries = 0;
+    for (int c = 0; c < C; c++) {
+        t_class cl = partition.classes[c];
+        long long k = cl.num_members;
+        entries += k * k;
+        seen[c] = c;
+        for (int m = 0; m < cl.num_members; m++) {
+            int u = cl.members_ids[m] - 1;
+            for (int e = P->row_ptr[u]; e < P->row_ptr[u + 1]; e++) {
+                int d = partition.v_data[P->col_idx[e]].class_id - 1;
+                if (seen[d] == c) continue;
+                seen[d] = c;
+                entries += k * partition.classes[d].num_members;
+            }
+        }
+    }
+
+    free(seen);
+    return entries;
+}
+
+/*
+   csr_to_block_matrix :
+   Premier passage : position de chaque sommet (classes par identifiant décroissant,
+   membres dans l'ordre de la partition), puis blocs-colonnes distincts atteints par
+   chaque bloc-ligne (marquage par bloc-ligne, sans tri global).
+   Second passage : blocs d'un bloc-ligne triés par colonne, puis recopie des
+   transitions de la CSR dans leur bloc. Coût O(N + E + valeurs stockées).
+*/
+t_block_matrix csr_to_block_matrix(const t_csr *P, t_partition partition) {
+    int N = P->num_vertices;
+    int C = partition.num_classes;
+    t_block_matrix M;
+
+    int *seen = (int *)malloc((C > 0 ? C : 1) * sizeof(int));
+    int *slot = (int *)malloc((C > 0 ? C : 1) * sizeof(int));
+    int *cols = (int *)malloc((C > 0 ? C : 1) * sizeof(int));
+    if (alloc_layout(&M, N, C, NULL) != 0 || seen == NULL || slot == NULL || cols == NULL) {
+        if (seen == NULL || slot == NULL || cols == NULL) perror("Allocation failed for block matrix construction");
+        free(seen);
+        free(slot);
+        free(cols);
+        return failed_block_matrix(&M);
+    }
+
+    int pos = 0;
+    for (int b = 0; b < C; b++) {
+        t_class cl = partition.classes[C - 1 - b];
+        M.start[b] = pos;
+        for (int m = 0; m < cl.num_members; m++) {
+            int v = cl.members_ids[m] - 1;
+            M.perm[pos] = v;
+            M.position[v] = pos++;
+        }
+    }
+    M.start[C] = pos;
+
+    // Blocs de chaque bloc-ligne : le diagonal, puis un par bloc-colonne atteint
+    for (int b = 0; b < C; b++) seen[b] = -1;
+    M.row_ptr[0] = 0;
+    for (int b = 0; b < C; b++) {
+        long long k = block_size(&M, b);
+        int count = 1;
+        seen[b] = b;
+        M.num_entries += k * k;
+        for (int p = M.start[b]; p < M.start[b + 1]; p++) {
+            int u = M.perm[p];
+            for (int e = P->row_ptr[u]; e < P->row_ptr[u + 1]; e++) {
+                int col = C - partition.v_data[P->col_idx[e]].class_id;
+                if (seen[col] == b) continue;
+                seen[col] = b;
+                count++;
+                M.num_entries += k * block_size(&M, col);
+            }
+        }
+        M.row_ptr[b + 1] = M.row_ptr[b] + count;
+    }
+
+    if (alloc_blocks(&M) != 0) {
+        free(seen);
+        free(slot);
+        free(cols);
+        return failed_block_matrix(&M);
+    }
+
+    long long offset = 0;
+    for (int b = 0; b < C; b++) seen[b] = -1;
+    for (int b = 0; b < C; b++) {
+        int k = block_size(&M, b);
+        int n = 0;
+        cols[n++] = b;
+        seen[b] = b;
+        for (int p = M.start[b]; p < M.start[b + 1]; p++) {
+            int u = M.perm[p];
+            for (int e = P->row_ptr[u]; e < P->row_ptr[u + 1]; e++) {
+                int col = C - partition.v_data[P->col_idx[e]].class_id;
+                if (seen[col] == b) continue;
+                seen[col] = b;
+                cols[n++] = col;
+            }
+        }
+        qsort(cols + 1, n - 1, sizeof(int), compare_int);
+
+        for (int j = 0; j < n; j++) {
+            int blk = M.row_ptr[b] + j;
+            M.blocks[blk].col = cols[j];
+            M.blocks[blk].data = M.values + offset;
+            offset += (long long)k * block_size(&M, cols[j]);
+            slot[cols[j]] = blk;
+        }
+
+        for (int p = M.start[b]; p < M.start[b + 1]; p++) {
+            int u = M.perm[p];
+            int row = p - M.start[b];
+            for (int e = P->row_ptr[u]; e < P->row_ptr[u + 1]; e++) {
+                int w = P->col_idx[e];
+                int col = C - partition.v_data[w].class_id;
+                t_block *blk = &M.blocks[slot[col]];
+                blk->data[(long long)row * block_size(&M, col) + (M.position[w] - M.start[col])] += P->values[e];
+            }
+        }
+    }
+
+    free(seen);
+    free(slot);
+    free(cols);
+    return M;
+}
+
+//Matrice identité de même découpage que M : un bloc diagonal par bloc-ligne.
+static t_block_matrix block_matrix_identity(const t_block_matrix *M) {
+    t_block_matrix I;
+    if (alloc_layout(&I, M->num_vertices, M->num_classes, M) != 0) return failed_block_matrix(&I);
+
+    I.row_ptr[0] = 0;
+    for (int b = 0; b < M->num_classes; b++) {
+        long long k = block_size(M, b);
+        I.row_ptr[b + 1] = b + 1;
+        I.num_entries += k * k;
+    }
+    if (alloc_blocks(&I) != 0) return failed_block_matrix(&I);
+
+    long long offset = 0;
+    for (int b = 0; b < M->num_classes; b++) {
+        int k = block_size(M, b);
+        I.blocks[b].col = b;
+        I.blocks[b].data = I.values + offset;
+        for (int i = 0; i < k; i++) I.blocks[b].data[(long long)i * k + i] = 1.0f;
+        offset += (long long)k * k;
+    }
+    return I;
+}
+
+//Copie complète de M (découpage, blocs et valeurs).
+static t_block_matrix clone_block_matrix(const t_block_matrix *M) {
+    t_block_matrix copy;
+    if (alloc_layout(&copy, M->num_vertices, M->num_classes, M) != 0) return failed_block_matrix(&copy);
+
+    memcpy(copy.row_ptr, M->row_ptr, (M->num_classes + 1) * sizeof(int));
+    copy.num_entries = M->num_entries;
+    if (alloc_blocks(&copy) != 0) return failed_block_matrix(&copy);
+
+    memcpy(copy.values, M->values, M->num_entries * sizeof(float));
+    for (int blk = 0; blk < M->num_blocks; blk++) {
+        copy.blocks[blk].col = M->blocks[blk].col;
+        copy.blocks[blk].data = copy.values + (M->blocks[blk].data - M->values);
+    }
+    return copy;
+}
+
+/*
+   block_matrix_multiply :
+   C(a, b) = somme sur c de A(a, c) * B(c, b), pour les seuls couples de blocs non nuls.
+   Premier passage : blocs-colonnes atteints par chaque bloc-ligne de C (taille du
+   résultat) ; second passage : produits de blocs denses accumulés dans leur bloc.
+*/
+t_block_matrix block_matrix_multiply(const t_block_matrix *A, const t_block_matrix *B) {
+    int C = A->num_classes;
+    t_block_matrix R;
+
+    if (A->num_vertices != B->num_vertices || C != B->num_classes
+        || memcmp(A->start, B->start, (C + 1) * sizeof(int)) != 0
+        || memcmp(A->perm, B->perm, A->num_vertices * sizeof(int)) != 0) {
+        fprintf(stderr, "Error: Block matrices must share the same layout for multiplication.\n");
+        memset(&R, 0, sizeof(R));
+        return R;
+    }
+
+    int *seen = (int *)malloc((C > 0 ? C : 1) * sizeof(int));
+    int *slot = (int *)malloc((C > 0 ? C : 1) * sizeof(int));
+    int *cols = (int *)malloc((C > 0 ? C : 1) * sizeof(int));
+    if (alloc_layout(&R, A->num_vertices, C, A) != 0 || seen == NULL || slot == NULL || cols == NULL) {
+        if (seen == NULL || slot == NULL || cols == NULL) perror("Allocation failed for block matrix product");
+        free(seen);
+        free(slot);
+        free(cols);
+        return failed_block_matrix(&R);
+    }
+
+    for (int b = 0; b < C; b++) seen[b] = -1;
+    R.row_ptr[0] = 0;
+    for (int a = 0; a < C; a++) {
+        long long k = block_size(A, a);
+        int count = 0;
+        for (int x = A->row_ptr[a]; x < A->row_ptr[a + 1]; x++) {
+            int c = A->blocks[x].col;
+            for (int y = B->row_ptr[c]; y < B->row_ptr[c + 1]; y++) {
+                int b = B->blocks[y].col;
+                if (seen[b] == a) continue;
+                seen[b] = a;
+                count++;
+                R.num_entries += k * block_size(A, b);
+            }
+        }
+        R.row_ptr[a + 1] = R.row_ptr[a] + count;
+    }
+
+    if (alloc_blocks(&R) != 0) {
+        free(seen);
+        free(slot);
+        free(cols);
+        return failed_block_matrix(&R);
+    }
+
+    long long offset = 0, flops = 0;
+    for (int b = 0; b < C; b++) seen[b] = -1;
+    for (int a = 0; a < C; a++) {
+        int ka = block_size(A, a);
+        int n = 0;
+        for (int x = A->row_ptr[a]; x < A->row_ptr[a + 1]; x++) {
+            int c = A->blocks[x].col;
+            for (int y = B->row_ptr[c]; y < B->row_ptr[c + 1]; y++) {
+                int b = B->blocks[y].col;
+                if (seen[b] == a) continue;
+                seen[b] = a;
+                cols[n++] = b;
+            }
+        }
+        qsort(cols, n, sizeof(int), compare_int);
+        for (int j = 0; j < n; j++) {
+            int blk = R.row_ptr[a] + j;
+            R.blocks[blk].col = cols[j];
+            R.blocks[blk].data = R.values + offset;
+            offset += (long long)ka * block_size(A, cols[j]);
+            slot[cols[j]] = blk;
+        }
+
+        for (int x = A->row_ptr[a]; x < A->row_ptr[a + 1]; x++) {
+            int c = A->blocks[x].col;
+            int kc = block_size(A, c);
+            const float *left = A->blocks[x].data;
+            for (int y = B->row_ptr[c]; y < B->row_ptr[c + 1]; y++) {
+                int b = B->blocks[y].col;
+                int kb = block_size(A, b);
+                const float *right = B->blocks[y].data;
+                float *out = R.blocks[slot[b]].data;
+                for (int i = 0; i < ka; i++) {
+                    for (int m = 0; m < kc; m++) {
+                        float value = left[(long long)i * kc + m];
+                        if (value == 0.0f) continue;
+                        const float *row = right + (long long)m * kb;
+                        float *target = out + (long long)i * kb;
+                        for (int j = 0; j < kb; j++) target[j] += value * row[j];
+                    }
+                }
+                flops += 2LL * ka * kc * kb;
+            }
+        }
+    }
+    profile_count_flops(flops);
+
+    free(seen);
+    free(slot);
+    free(cols);
+    return R;
+}
+
+/*
+   block_matrix_power :
+   Même exponentiation rapide que powerMatrix. Les puissances successives gardent
+   la forme triangulaire par blocs : seuls apparaissent les blocs (a, b) tels que
+   la classe de b est atteignable depuis celle de a.
+*/
+t_block_matrix block_matrix_power(const t_block_matrix *M, int power) {
+    t_block_matrix result = block_matrix_identity(M);
+    if (result.blocks == NULL || power <= 0) return result;
+
+    t_block_matrix current = clone_block_matrix(M);
+    if (current.blocks == NULL) return failed_block_matrix(&result);
+
+    while (power > 0) {
+        if (power % 2 == 1) {
+            t_block_matrix temp = block_matrix_multiply(&result, &current);
+            free_block_matrix(result);
+            result = temp;
+        }
+        power /= 2;
+
+        if (power > 0 && result.blocks != NULL) {
+            t_block_matrix temp2 = block_matrix_multiply(&current, &current);
+            free_block_matrix(current);
+            current = temp2;
+        }
+
+        if (result.blocks == NULL || current.blocks == NULL) {
+            free_block_matrix(current);
+            return failed_block_matrix(&result);
+        }
+    }
+
+    free_block_matrix(current);
+    return result;
+}
+
+/*
+   block_k_step_distribution :
+   Itère y = x M dans l'ordre des positions. La masse ne fait que descendre les
+   blocs-lignes : un bloc-ligne dont le segment de x est nul est sauté entièrement.
+*/
+int block_k_step_distribution(const t_block_matrix *M, const double *x0, int k, double *out) {
+    int N = M->num_vertices;
+    double *cur = (double *)malloc((N > 0 ? N : 1) * sizeof(double));
+    double *next = (double *)malloc((N > 0 ? N : 1) * sizeof(double));
+    if (cur == NULL || next == NULL) {
+        perror("Allocation failed for block k-step distribution");
+        free(cur);
+        free(next);
+        return -1;
+    }
+    for (int v = 0; v < N; v++) cur[M->position[v]] = x0[v];
+
+    long long flops = 0;
+    for (int step = 0; step < k; step++) {
+        memset(next, 0, N * sizeof(double));
+        for (int b = 0; b < M->num_classes; b++) {
+            int rows = block_size(M, b);
+            const double *x = cur + M->start[b];
+            int has_mass = 0;
+            for (int i = 0; i < rows && !has_mass; i++) has_mass = (x[i] != 0.0);
+            if (!has_mass) continue;
+
+            for (int blk = M->row_ptr[b]; blk < M->row_ptr[b + 1]; blk++) {
+                int col = M->blocks[blk].col;
+                int width = block_size(M, col);
+                const float *data = M->blocks[blk].data;
+                double *y = next + M->start[col];
+                for (int i = 0; i < rows; i++) {
+                    if (x[i] == 0.0) continue;
+                    const float *row = data + (long long)i * width;
+                    for (int j = 0; j < width; j++) y[j] += x[i] * row[j];
+                }
+                flops += 2LL * rows * width;
+            }
+        }
+        double *swap = cur;
+        cur = next;
+        next = swap;
+    }
+    profile_count_iterations(k);
+    profile_count_flops(flops);
+
+    for (int p = 0; p < N; p++) out[M->perm[p]] = cur[p];
+    free(cur);
+    free(next);
+    return 0;
+}
+
+/*
+   block_class_stationary :
+   Itération de (I + P) / 2 sur le bloc diagonal k x k de la classe, à partir de la
+   distribution uniforme, comme stationary_iterate sur la CSR : la classe est fermée,
+   ses autres blocs sont nuls.
+*/
+int block_class_stationary(const t_block_matrix *M, t_partition partition, int class_index,
+                           double *pi, double epsilon, int max_iter, int *converged) {
+    t_class c = partition.classes[class_index];
+    if (!c.is_persistent) return -1;
+    if (converged != NULL) *converged = 1;
+
+    int b = M->num_classes - 1 - class_index;
+    int k = block_size(M, b);
+    const float *D = M->blocks[M->row_ptr[b]].data;
+    if (k == 1) {
+        pi[M->perm[M->start[b]]] = 1.0; // État absorbant
+        return 0;
+    }
+
+    double *x = (double *)malloc(k * sizeof(double));
+    double *next = (double *)malloc(k * sizeof(double));
+    if (x == NULL || next == NULL) {
+        perror("Allocation failed for block stationary distribution");
+        free(x);
+        free(next);
+        return -1;
+    }
+    for (int i = 0; i < k; i++) x[i] = 1.0 / k;
+
+    int iter;
+    for (iter = 1; iter <= max_iter; iter++) {
+        for (int j = 0; j < k; j++) next[j] = 0.5 * x[j];
+        for (int i = 0; i < k; i++) {
+            double half = 0.5 * x[i];
+            const float *row = D + (long long)i * k;
+            for (int j = 0; j < k; j++) next[j] += half * row[j];
+        }
+
+        // Lignes sommant à 1 à TOLERANCE près : renormalisation, comme stationary_iterate
+        double total = 0.0;
+        for (int j = 0; j < k; j++) total += next[j];
+        if (total <= 0.0) total = 1.0;
+
+        double diff = 0.0;
+        for (int j = 0; j < k; j++) {
+            double value = next[j] / total;
+            diff += fabs(value - x[j]);
+            x[j] = value;
+        }
+        if (diff < epsilon) break;
+    }
+    if (iter > max_iter) {
+        iter = max_iter;
+        if (converged != NULL) *converged = 0;
+    }
+    profile_count_iterations(iter);
+    profile_count_flops((long long)iter * (2LL * k * k + 4LL * k));
+
+    for (int i = 0; i < k; i++) pi[M->perm[M->start[b] + i]] = x[i];
+    free(x);
+    free(next);
+    return iter;
+}
+
+/*
+   gauss_solve :
+   Résout A X = B par élimination de Gauss avec pivot partiel (A : n x n, B : n x nrhs,
+   ligne par ligne). A et B sont écrasés, B reçoit X. Retourne -1 si A est singulière.
+*/
+static int gauss_solve(double *A, double *B, int n, int nrhs) {
+    for (int col = 0; col < n; col++) {
+        int pivot = col;
+        for (int i = col + 1; i < n; i++) {
+            if (fabs(A[(long long)i * n + col]) > fabs(A[(long long)pivot * n + col])) pivot = i;
+        }
+        if (fabs(A[(long long)pivot * n + col]) < 1e-300) return -1;
+        if (pivot != col) {
+            for (int j = 0; j < n; j++) {
+                double t = A[(long long)col * n + j];
+                A[(long long)col * n + j] = A[(long long)pivot * n + j];
+                A[(long long)pivot * n + j] = t;
+            }
+            for (int j = 0; j < nrhs; j++) {
+                double t = B[(long long)col * nrhs + j];
+                B[(long long)col * nrhs + j] = B[(long long)pivot * nrhs + j];
+                B[(long long)pivot * nrhs + j] = t;
+            }
+        }
+
+        double diag = A[(long long)col * n + col];
+        for (int i = col + 1; i < n; i++) {
+            double factor = A[(long long)i * n + col] / diag;
+            if (factor == 0.0) continue;
+            for (int j = col; j < n; j++) A[(long long)i * n + j] -= factor * A[(long long)col * n + j];
+            for (int j = 0; j < nrhs; j++) B[(long long)i * nrhs + j] -= factor * B[(long long)col * nrhs + j];
+        }
+    }
+
+    for (int i = n - 1; i >= 0; i--) {
+        double diag = A[(long long)i * n + i];
+        for (int j = 0; j < nrhs; j++) {
+            double sum = B[(long long)i * nrhs + j];
+            for (int m = i + 1; m < n; m++) sum -= A[(long long)i * n + m] * B[(long long)m * nrhs + j];
+            B[(long long)i * nrhs + j] = sum / diag;
+        }
+    }
+    profile_count_flops(2LL * n * n * n / 3 + 2LL * n * n * nrhs);
+    return 0;
+}
+
+/*
+   class_stationary_direct :
+   pi (P_C - I) = 0 et somme des pi = 1, en transposant : (P_C - I)^T pi^T = 0, dont la
+   dernière équation (redondante, la classe étant fermée) est remplacée par la somme.
+   Une élimination de Gauss en 2 k^3 / 3 au lieu d'itérer, pour les classes lentes à
+   converger (choix fait par spectral_class_solver). Les arêtes sont lues dans la CSR.
+*/
+int class_stationary_direct(const t_csr *P, t_partition partition, int class_index, double *pi) {
+    t_class c = partition.classes[class_index];
+    int k = c.num_members;
+    if (!c.is_persistent) return -1;
+    if (k == 1) {
+        pi[c.members_ids[0] - 1] = 1.0; // État absorbant
+        return 0;
+    }
+
+    int N = P->num_vertices;
+    double *A = (double *)calloc((size_t)k * k, sizeof(double));
+    double *b = (double *)calloc(k, sizeof(double));
+    int *local = (int *)malloc(N * sizeof(int));
+    if (A == NULL || b == NULL || local == NULL) {
+        perror("Allocation failed for direct stationary solve");
+        free(A);
+        free(b);
+        free(local);
+        return -1;
+    }
+    for (int m = 0; m < k; m++) local[c.members_ids[m] - 1] = m;
+
+    for (int i = 0; i < k; i++) {
+        int u = c.members_ids[i] - 1;
+        A[(long long)i * k + i] -= 1.0;
+        for (int e = P->row_ptr[u]; e < P->row_ptr[u + 1]; e++) {
+            A[(long long)local[P->col_idx[e]] * k + i] += P->values[e];
+        }
+    }
+    for (int j = 0; j < k; j++) A[(long long)(k - 1) * k + j] = 1.0;
+    b[k - 1] = 1.0;
+
+    int status = gauss_solve(A, b, k, 1);
+    if (status == 0) {
+        // Les lignes ne somment à 1 qu'à TOLERANCE près : valeurs négatives minuscules ramenées à 0, puis renormalisation
+        double total = 0.0;
+        for (int m = 0; m < k; m++) {
+            if (b[m] < 0.0) b[m] = 0.0;
+            total += b[m];
+        }
+        for (int m = 0; m < k; m++) pi[c.members_ids[m] - 1] = (total > 0.0) ? b[m] / total : 1.0 / k;
+    }
+
+    free(A);
+    free(b);
+    free(local);
+    return status;
+}
+
+//Plus grand bloc transitoire (taille des tampons d'élimination).
+static int largest_transient_block(const t_block_matrix *M, t_partition partition) {
+    int largest = 0;
+    for (int b = 0; b < M->num_classes; b++) {
+        if (partition.classes[M->num_classes - 1 - b].is_persistent) continue;
+        if (block_size(M, b) > largest) largest = block_size(M, b);
+    }
+    return largest;
+}
+
+/*
+   block_absorption_from_vertex :
+   La masse partie de v descend les blocs-lignes. Pour un bloc transitoire qui a reçu
+   la masse x, le nombre moyen de passages y vérifie y (I - D) = x (D : bloc diagonal),
+   résolu en une élimination de Gauss au lieu d'itérer ; y M(b, col) rejoint ensuite
+   chaque bloc de couplage. Toute la masse entrée dans un bloc persistant y reste.
+*/
+int block_absorption_from_vertex(const t_block_matrix *M, t_partition partition, int v, double *class_mass) {
+    int C = M->num_classes;
+    for (int c = 0; c < C; c++) class_mass[c] = 0.0;
+
+    int origin = partition.v_data[v].class_id - 1;
+    if (partition.classes[origin].is_persistent) {
+        class_mass[origin] = 1.0;
+        return 0;
+    }
+
+    int largest = largest_transient_block(M, partition);
+    double *mass = (double *)calloc(M->num_vertices, sizeof(double));
+    double *A = (double *)malloc((size_t)(largest > 0 ? largest : 1) * (largest > 0 ? largest : 1) * sizeof(double));
+    if (mass == NULL || A == NULL) {
+        perror("Allocation failed for block absorption from vertex");
+        free(mass);
+        free(A);
+        return -1;
+    }
+    mass[M->position[v]] = 1.0;
+
+    int failed = 0;
+    for (int b = C - 1 - origin; b < C && !failed; b++) {
+        int c = C - 1 - b;
+        int k = block_size(M, b);
+        double *y = mass + M->start[b];
+
+        if (partition.classes[c].is_persistent) {
+            for (int i = 0; i < k; i++) class_mass[c] += y[i];
+            continue;
+        }
+        int reached = 0;
+        for (int i = 0; i < k && !reached; i++) reached = (y[i] != 0.0);
+        if (!reached) continue;
+
+        // (I - D)^T y^T = x^T : la masse reçue est remplacée par le nombre moyen de passages
+        const float *D = M->blocks[M->row_ptr[b]].data;
+        for (int i = 0; i < k; i++) {
+            for (int j = 0; j < k; j++) A[(long long)j * k + i] = (i == j ? 1.0 : 0.0) - D[(long long)i * k + j];
+        }
+        if (gauss_solve(A, y, k, 1) != 0) {
+            fprintf(stderr, "Error: Singular diagonal block for class C%d.\n", partition.classes[c].id);
+            failed = 1;
+            break;
+        }
+
+        for (int blk = M->row_ptr[b] + 1; blk < M->row_ptr[b + 1]; blk++) {
+            int col = M->blocks[blk].col;
+            int width = block_size(M, col);
+            const float *data = M->blocks[blk].data;
+            double *target = mass + M->start[col];
+            for (int i = 0; i < k; i++) {
+                if (y[i] == 0.0) continue;
+                const float *row = data + (long long)i * width;
+                for (int j = 0; j < width; j++) target[j] += y[i] * row[j];
+            }
+        }
+    }
+
+    free(mass);
+    free(A);
+    return failed ? -1 : 0;
+}
+
+/*
+   block_absorption_probabilities :
+   Les blocs-lignes sont remontés depuis les puits : pour un bloc transitoire b,
+   h_b = (I - D)^(-1) * somme sur les blocs de couplage de M(b, col) h_col, les h_col
+   étant déjà connus (blocs plus loin dans l'ordre). Une élimination de Gauss par
+   bloc, avec K seconds membres.
+*/
+int block_absorption_probabilities(const t_block_matrix *M, t_partition partition, double **absorb, int *persistent_index) {
+    int C = M->num_classes;
+    int K = 0;
+    for (int c = 0; c < C; c++) persistent_index[c] = partition.classes[c].is_persistent ? K++ : -1;
+
+    int largest = largest_transient_block(M, partition);
+    double *h = (double *)calloc((size_t)M->num_vertices * (K > 0 ? K : 1), sizeof(double));
+    double *A = (double *)malloc((size_t)(largest > 0 ? largest : 1) * (largest > 0 ? largest : 1) * sizeof(double));
+    double *R = (double *)malloc((size_t)(largest > 0 ? largest : 1) * (K > 0 ? K : 1) * sizeof(double));
+    if (h == NULL || A == NULL || R == NULL) {
+        perror("Allocation failed for block absorption probabilities");
+        free(h);
+        free(A);
+        free(R);
+        return -1;
+    }
+
+    for (int b = C - 1; b >= 0; b--) {
+        int c = C - 1 - b;
+        int k = block_size(M, b);
+
+        if (partition.classes[c].is_persistent) {
+            for (int i = 0; i < k; i++) h[(long long)M->perm[M->start[b] + i] * K + persistent_index[c]] = 1.0;
+            continue;
+        }
+
+        memset(R, 0, (size_t)k * K * sizeof(double));
+        for (int blk = M->row_ptr[b] + 1; blk < M->row_ptr[b + 1]; blk++) {
+            int col = M->blocks[blk].col;
+            int width = block_size(M, col);
+            const float *data = M->blocks[blk].data;
+            for (int i = 0; i < k; i++) {
+                for (int j = 0; j < width; j++) {
+                    double p = data[(long long)i * width + j];
+                    if (p == 0.0) continue;
+                    const double *source = h + (long long)M->perm[M->start[col] + j] * K;
+                    for (int q = 0; q < K; q++) R[(long long)i * K + q] += p * source[q];
+                }
+            }
+        }
+
+        const float *D = M->blocks[M->row_ptr[b]].data;
+        for (int i = 0; i < k; i++) {
+            for (int j = 0; j < k; j++) A[(long long)i * k + j] = (i == j ? 1.0 : 0.0) - D[(long long)i * k + j];
+        }
+        if (gauss_solve(A, R, k, K) != 0) {
+            fprintf(stderr, "Error: Singular diagonal block for class C%d.\n", partition.classes[c].id);
+            free(h);
+            free(A);
+            free(R);
+            return -1;
+        }
+        for (int i = 0; i < k; i++) {
+            memcpy(h + (long long)M->perm[M->start[b] + i] * K, R + (long long)i * K, K * sizeof(double));
+        }
+    }
+
+    free(A);
+    free(R);
+    *absorb = h;
+    return K;
+}
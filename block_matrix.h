@@ -0,0 +1,80 @@
+#ifndef BLOCK_MATRIX_H
+#define BLOCK_MATRIX_H
+
+#include "sparse.h"
+#include "tarjan.h"
+
+/*
+   Matrice de transition permutée dans l'ordre topologique des classes.
+   Les identifiants de Tarjan placent les successeurs d'une classe avant elle : en
+   rangeant les classes par identifiant décroissant (sources d'abord), toute
+   transition va d'un bloc vers un bloc de même rang ou plus loin, la matrice est
+   triangulaire supérieure par blocs. Le bloc-ligne b est la classe d'indice
+   num_classes - 1 - b. Seuls les blocs diagonaux (transitions internes à une classe)
+   et les blocs de couplage non nuls (au moins une transition d'une classe vers une
+   autre) sont stockés, chacun en dense.
+*/
+
+//Un bloc dense : transitions du bloc-ligne qui le contient vers le bloc-colonne col.
+typedef struct s_block {
+    int col;                 // Bloc-colonne (>= bloc-ligne : matrice triangulaire supérieure par blocs)
+    float *data;             // Lignes x colonnes valeurs, ligne par ligne (dans values de la matrice)
+} t_block;
+
+//Matrice triangulaire supérieure par blocs. Les vecteurs passés aux fonctions restent indexés par sommet (0-based).
+typedef struct s_block_matrix {
+    int num_vertices;        // N
+    int num_classes;         // Nombre de blocs-lignes (et de blocs-colonnes)
+    int *start;              // num_classes + 1 : position du premier sommet de chaque bloc
+    int *perm;               // N : sommet (0-based) rangé à chaque position
+    int *position;           // N : position de chaque sommet
+    int *row_ptr;            // num_classes + 1 : blocs du bloc-ligne b = blocks[row_ptr[b] .. row_ptr[b+1]-1], diagonal en premier
+    t_block *blocks;
+    int num_blocks;
+    long long num_entries;   // Valeurs stockées (somme des tailles des blocs)
+    float *values;           // Valeurs de tous les blocs, à la suite
+} t_block_matrix;
+
+//Valeurs que stockerait csr_to_block_matrix (somme des tailles des blocs), sans rien allouer d'autre
+//qu'un tableau de num_classes entiers. Retourne -1 si la mémoire manque.
+long long block_matrix_entries(const t_csr *P, t_partition partition);
+
+//Construit la matrice par blocs depuis la CSR et la partition. blocks vaut NULL si la mémoire manque.
+t_block_matrix csr_to_block_matrix(const t_csr *P, t_partition partition);
+
+//Libère la mémoire allouée pour la matrice par blocs.
+void free_block_matrix(t_block_matrix M);
+
+//Produit A * B de deux matrices de même découpage. Seuls les blocs atteints par un produit de blocs non nuls
+//sont créés. blocks vaut NULL si la mémoire manque ou si les découpages diffèrent.
+t_block_matrix block_matrix_multiply(const t_block_matrix *A, const t_block_matrix *B);
+
+//M^power par exponentiation rapide, bloc par bloc. blocks vaut NULL si la mémoire manque.
+t_block_matrix block_matrix_power(const t_block_matrix *M, int power);
+
+//Distribution après k étapes en partant de x0 : out = x0 M^k (N cases, indexées par sommet).
+//Les blocs-lignes sans masse sont sautés. Retourne 0 si succès, -1 si la mémoire manque.
+int block_k_step_distribution(const t_block_matrix *M, const double *x0, int k, double *out);
+
+//Distribution stationnaire d'une classe persistante, itérée sur son seul bloc diagonal (chaîne (I + P) / 2, voir
+//class_stationary_distribution). Seules les cases des membres de pi (N cases) sont écrites. *converged (si non NULL)
+//reçoit 0 si max_iter est atteint avant epsilon. Retourne le nombre d'itérations, -1 si la classe est transitoire ou si
+//l'allocation échoue.
+int block_class_stationary(const t_block_matrix *M, t_partition partition, int class_index,
+                           double *pi, double epsilon, int max_iter, int *converged);
+
+//Distribution stationnaire d'une classe persistante par élimination de Gauss (matrice k x k en double construite depuis la CSR),
+//sans itérer. Seules les cases des membres de pi (N cases) sont écrites. Retourne 0, -1 si la classe est transitoire,
+//si la mémoire manque ou si le système est singulier.
+int class_stationary_direct(const t_csr *P, t_partition partition, int class_index, double *pi);
+
+//Probabilités d'absorption depuis le seul sommet v (0-based), en descendant les blocs-lignes : chaque bloc transitoire
+//atteint est résolu par élimination de Gauss sur son bloc diagonal, puis sa masse passe aux blocs de couplage.
+//Même résultat que absorption_from_vertex (class_mass : num_classes cases). Retourne 0, ou -1 si l'allocation échoue.
+int block_absorption_from_vertex(const t_block_matrix *M, t_partition partition, int v, double *class_mass);
+
+//Probabilités d'absorption de tous les sommets, en remontant les blocs-lignes (même format que absorption_probabilities :
+//absorb N x K, persistent_index). Retourne K, ou -1 si l'allocation échoue.
+int block_absorption_probabilities(const t_block_matrix *M, t_partition partition, double **absorb, int *persistent_index);
+
+#endif // BLOCK_MATRIX_H
@@ -0,0 +1,551 @@
+#include "cache.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "markov_check.h"
+
+#define CACHE_MAGIC "MKVC"
+#define CACHE_FORMAT 2
+#define CACHE_VERSION_LENGTH 16
+#define CACHE_MAX_PATH 1024
+
+// ---------------------------------------------------------------------------
+// XXH64 (algorithme public de Yann Collet), version incrémentale : le graphe est
+// une liste chaînée, ses arêtes sont hachées au fil du parcours sans copie.
+// ---------------------------------------------------------------------------
+
+#define PRIME64_1 0x9E3779B185EBCA87ULL
+#define PRIME64_2 0xC2B2AE3D27D4EB4FULL
+#define PRIME64_3 0x165667B19E3779F9ULL
+#define PRIME64_4 0x85EBCA77C2B2CA63ULL
+#define PRIME64_5 0x27D4EB2F165667C5ULL
+
+typedef struct s_xxh64 {
+    uint64_t acc[4];
+    uint64_t total_length;
+    unsigned char buffer[32];
+    size_t buffered;
+    uint64_t seed;
+} t_xxh64;
+
+static uint64_t rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+static uint64_t read64(const unsigned char *p) {
+    uint64_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static uint32_t read32(const unsigned char *p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static uint64_t xxh64_round(uint64_t acc, uint64_t input) {
+    acc += input * PRIME64_2;
+    acc = rotl64(acc, 31);
+    return acc * PRIME64_1;
+}
+
+static uint64_t xxh64_merge(uint64_t hash, uint64_t acc) {
+    hash ^= xxh64_round(0, acc);
+    return hash * PRIME64_1 + PRIME64_4;
+}
+
+static void xxh64_init(t_xxh64 *state, uint64_t seed) {
+    memset(state, 0, sizeof(*state));
+    state->seed = seed;
+    state->acc[0] = seed + PRIME64_1 + PRIME64_2;
+    state->acc[1] = seed + PRIME64_2;
+    state->acc[2] = seed;
+    state->acc[3] = seed - PRIME64_1;
+}
+
+static void xxh64_update(t_xxh64 *state, const void *data, size_t length) {
+    const unsigned char *p = (const unsigned char *)data;
+    const unsigned char *end = p + length;
+    state->total_length += length;
+
+    if (state->buffered + length < 32) {
+        memcpy(state->buffer + state->buffered, p, length);
+        state->buffered += length;
+        return;
+    }
+    if (state->buffered > 0) {
+        size_t fill = 32 - state->buffered;
+        memcpy(state->buffer + state->buffered, p, fill);
+        for (int i = 0; i < 4; i++) state->acc[i] = xxh64_round(state->acc[i], read64(state->buffer + 8 * i));
+        p += fill;
+        state->buffered = 0;
+    }
+    for (; p + 32 <= end; p += 32) {
+        for (int i = 0; i < 4; i++) state->acc[i] = xxh64_round(state->acc[i], read64(p + 8 * i));
+    }
+    if (p < end) {
+        memcpy(state->buffer, p, end - p);
+        state->buffered = end - p;
+    }
+}
+
+static uint64_t xxh64_digest(const t_xxh64 *state) {
+    uint64_t hash;
+    if (state->total_length >= 32) {
+        hash = rotl64(state->acc[0], 1) + rotl64(state->acc[1], 7) + rotl64(state->acc[2], 12) + rotl64(state->acc[3], 18);
+        for (int i = 0; i < 4; i++) hash = xxh64_merge(hash, state->acc[i]);
+    } else {
+        hash = state->seed + PRIME64_5;
+    }
+    hash += state->total_length;
+
+    const unsigned char *p = state->buffer;
+    const unsigned char *end = p + state->buffered;
+    for (; p + 8 <= end; p += 8) {
+        hash ^= xxh64_round(0, read64(p));
+        hash = rotl64(hash, 27) * PRIME64_1 + PRIME64_4;
+    }
+    if (p + 4 <= end) {
+        hash ^= (uint64_t)read32(p) * PRIME64_1;
+        hash = rotl64(hash, 23) * PRIME64_2 + PRIME64_3;
+        p += 4;
+    }
+    for (; p < end; p++) {
+        hash ^= (*p) * PRIME64_5;
+        hash = rotl64(hash, 11) * PRIME64_1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= PRIME64_2;
+    hash ^= hash >> 29;
+    hash *= PRIME64_3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+uint64_t cache_hash64(const void *data, size_t length, uint64_t seed) {
+    t_xxh64 state;
+    xxh64_init(&state, seed);
+    xxh64_update(&state, data, length);
+    return xxh64_digest(&state);
+}
+
+/*
+   markov_cache_key :
+   Empreinte de la version, des réglages (tolérance de Markov, précision et
+   itérations de la distribution stationnaire), puis de chaque sommet : son degré
+   sortant et ses arêtes (arrivée, bits de la probabilité) dans l'ordre de la liste.
+   L'ordre des arêtes compte : il fixe la numérotation des classes par Tarjan.
+*/
+uint64_t markov_cache_key(const t_markov_ctx *ctx) {
+    t_xxh64 state;
+    char version[CACHE_VERSION_LENGTH] = {0};
+    double settings[3] = {TOLERANCE, MARKOV_STATIONARY_EPSILON, MARKOV_STATIONARY_MAX_ITER};
+    int32_t format = CACHE_FORMAT;
+
+    strncpy(version, MARKOV_VERSION, CACHE_VERSION_LENGTH - 1);
+    xxh64_init(&state, 0);
+    xxh64_update(&state, version, sizeof(version));
+    xxh64_update(&state, &format, sizeof(format));
+    xxh64_update(&state, settings, sizeof(settings));
+
+    int32_t num_vertices = ctx->graph.num_vertices;
+    xxh64_update(&state, &num_vertices, sizeof(num_vertices));
+    for (int i = 0; i < ctx->graph.num_vertices; i++) {
+        int32_t degree = 0;
+        for (t_edge *e = ctx->graph.adj_lists[i].head; e != NULL; e = e->next) degree++;
+        xxh64_update(&state, &degree, sizeof(degree));
+        for (t_edge *e = ctx->graph.adj_lists[i].head; e != NULL; e = e->next) {
+            int32_t edge[2];
+            edge[0] = e->destination;
+            memcpy(&edge[1], &e->probability, sizeof(float));
+            xxh64_update(&state, edge, sizeof(edge));
+        }
+    }
+    return xxh64_digest(&state);
+}
+
+// ---------------------------------------------------------------------------
+// Format du fichier (entiers 32 bits et doubles, ordre d'octets de la machine) :
+//   en-tête   "MKVC", format, version (16 octets), clé, N, E, classes, liens, K
+//   sommets   classe de chaque sommet (N entiers)
+//   classes   pour chacune : taille, persistance, membres dans l'ordre de Tarjan
+//   liens     (source, destination) de chaque lien de Hasse
+//   résultats périodes (une par classe), distribution stationnaire (N doubles),
+//             absorptions (N x K doubles)
+//   fin       XXH64 de tout ce qui précède (fichier tronqué ou corrompu = absent)
+// ---------------------------------------------------------------------------
+
+typedef struct s_cache_header {
+    char magic[4];
+    int32_t format;
+    char version[CACHE_VERSION_LENGTH];
+    uint64_t key;
+    int32_t num_vertices;
+    int32_t num_edges;
+    int32_t num_classes;
+    int32_t num_links;
+    int32_t num_persistent;
+} t_cache_header;
+
+//Écriture avec empreinte au fil de l'eau ; failed passe à 1 à la première erreur.
+typedef struct s_blob_writer {
+    FILE *file;
+    t_xxh64 state;
+    int failed;
+} t_blob_writer;
+
+static void blob_write(t_blob_writer *writer, const void *data, size_t size) {
+    if (writer->failed || size == 0) return;
+    if (fwrite(data, 1, size, writer->file) != size) writer->failed = 1;
+    xxh64_update(&writer->state, data, size);
+}
+
+//Lecture bornée dans le fichier chargé en mémoire ; retourne -1 si le fichier est trop court.
+typedef struct s_blob_reader {
+    const unsigned char *data;
+    size_t size;
+    size_t offset;
+} t_blob_reader;
+
+static int blob_read(t_blob_reader *reader, void *out, size_t size) {
+    if (size > reader->size - reader->offset) return -1;
+    memcpy(out, reader->data + reader->offset, size);
+    reader->offset += size;
+    return 0;
+}
+
+static void cache_path(const char *cache_dir, uint64_t key, char *path, size_t size) {
+    snprintf(path, size, "%s/%016llx%s", cache_dir, (unsigned long long)key, MARKOV_CACHE_EXTENSION);
+}
+
+/*
+   clear_results :
+   Libère ce que markov_analyze_classes et markov_solve ont produit, en gardant
+   le graphe : utilisé quand un fichier du cache s'avère invalide en cours de lecture.
+*/
+static void clear_results(t_markov_ctx *ctx) {
+    free_csr(ctx->P);
+    free_csr(ctx->PT);
+    free_partition(ctx->partition);
+    free_link_array(ctx->hasse_links);
+    free(ctx->persistent_index);
+    free(ctx->periods);
+    free(ctx->stationary);
+    absorption_free(&ctx->absorb);
+    ctx->P = (t_csr){0, 0, NULL, NULL, NULL};
+    ctx->PT = (t_csr){0, 0, NULL, NULL, NULL};
+    ctx->partition = (t_partition){NULL, 0, NULL};
+    ctx->hasse_links = NULL;
+    ctx->persistent_index = NULL;
+    ctx->periods = NULL;
+    ctx->stationary = NULL;
+    ctx->num_persistent = 0;
+    ctx->num_unconverged = 0;
+    ctx->stages_done &= MARKOV_STAGE_LOADED | MARKOV_STAGE_CHECKED;
+}
+
+//Lit tout le fichier. Retourne le tampon (à libérer) ou NULL si absent ou illisible.
+static unsigned char *read_whole_file(const char *path, size_t *size) {
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) return NULL;
+
+    unsigned char *data = NULL;
+    long length = -1;
+    if (fseek(file, 0, SEEK_END) == 0) length = ftell(file);
+    if (length > 0 && fseek(file, 0, SEEK_SET) == 0) {
+        data = (unsigned char *)malloc(length);
+        if (data != NULL && fread(data, 1, length, file) != (size_t)length) {
+            free(data);
+            data = NULL;
+        }
+    }
+    fclose(file);
+    *size = (size_t)length;
+    return data;
+}
+
+/*
+   parse_absorption :
+   Probabilités d'absorption en creux (voir t_absorption) : colonnes de chaque classe,
+   puis valeurs. num_values vaut -1 si elles n'étaient pas gardées. Chaque colonne doit
+   être une classe persistante, en ordre croissant dans sa classe.
+*/
+static int parse_absorption(t_absorption *A, t_blob_reader *reader, t_partition partition, int64_t num_values) {
+    int C = partition.num_classes;
+
+    *A = (t_absorption){0};
+    A->num_classes = C;
+    if (num_values < 0) return (num_values == -1) ? 0 : -1;
+
+    A->class_ptr = (long long *)malloc((C + 1) * sizeof(long long));
+    if (A->class_ptr == NULL || blob_read(reader, A->class_ptr, (C + 1) * sizeof(long long)) != 0) return -1;
+    if (A->class_ptr[0] != 0) return -1;
+    for (int c = 0; c < C; c++) {
+        long long width = A->class_ptr[c + 1] - A->class_ptr[c];
+        if (width < 0 || width > C || num_values / partition.classes[c].num_members < width) return -1;
+    }
+
+    long long num_columns = A->class_ptr[C];
+    A->columns = (int *)malloc((num_columns > 0 ? num_columns : 1) * sizeof(int));
+    if (A->columns == NULL || blob_read(reader, A->columns, num_columns * sizeof(int)) != 0) return -1;
+    for (int c = 0; c < C; c++) {
+        for (long long q = A->class_ptr[c]; q < A->class_ptr[c + 1]; q++) {
+            int column = A->columns[q];
+            if (column < 0 || column >= C || !partition.classes[column].is_persistent) return -1;
+            if (q > A->class_ptr[c] && column <= A->columns[q - 1]) return -1;
+        }
+    }
+
+    A->num_values = num_values;
+    if (absorption_index_rows(A, partition) != 0) return -1;
+    A->values = (double *)malloc((num_values > 0 ? num_values : 1) * sizeof(double));
+    return (A->values != NULL && blob_read(reader, A->values, num_values * sizeof(double)) == 0) ? 0 : -1;
+}
+
+/*
+   parse_results :
+   Reconstruit partition, liens, périodes, distribution et absorptions à partir
+   du contenu (empreinte déjà vérifiée). Chaque identifiant est contrôlé : un
+   fichier incohérent est traité comme absent. Retourne 0 si succès, -1 sinon.
+*/
+static int parse_results(t_markov_ctx *ctx, t_blob_reader *reader, const t_cache_header *header) {
+    int N = header->num_vertices;
+    int C = header->num_classes;
+    int K = header->num_persistent;
+
+    ctx->partition.v_data = (t_tarjan_vertex *)calloc(N, sizeof(t_tarjan_vertex));
+    ctx->partition.classes = (t_class *)calloc(C > 0 ? C : 1, sizeof(t_class));
+    if (ctx->partition.v_data == NULL || ctx->partition.classes == NULL) return -1;
+    ctx->partition.num_classes = C;
+
+    for (int i = 0; i < N; i++) {
+        int32_t class_id;
+        if (blob_read(reader, &class_id, sizeof(class_id)) != 0 || class_id < 1 || class_id > C) return -1;
+        ctx->partition.v_data[i] = (t_tarjan_vertex){i + 1, -1, -1, 0, class_id};
+    }
+
+    for (int c = 0; c < C; c++) {
+        int32_t fields[2];
+        if (blob_read(reader, fields, sizeof(fields)) != 0 || fields[0] < 1 || fields[0] > N) return -1;
+
+        t_class *class = &ctx->partition.classes[c];
+        class->id = c + 1;
+        class->num_members = fields[0];
+        class->is_persistent = fields[1];
+        class->members_ids = (int *)malloc(fields[0] * sizeof(int));
+        if (class->members_ids == NULL || blob_read(reader, class->members_ids, fields[0] * sizeof(int)) != 0) return -1;
+        for (int m = 0; m < class->num_members; m++) {
+            int v = class->members_ids[m];
+            if (v < 1 || v > N || ctx->partition.v_data[v - 1].class_id != class->id) return -1;
+        }
+    }
+
+    ctx->hasse_links = create_link_array(header->num_links > 0 ? header->num_links : 1);
+    if (ctx->hasse_links == NULL) return -1;
+    for (int l = 0; l < header->num_links; l++) {
+        int32_t link[2];
+        if (blob_read(reader, link, sizeof(link)) != 0 || add_link(ctx->hasse_links, link[0], link[1]) != 0) return -1;
+    }
+
+    ctx->periods = (int *)malloc((C > 0 ? C : 1) * sizeof(int));
+    ctx->persistent_index = (int *)malloc((C > 0 ? C : 1) * sizeof(int));
+    ctx->stationary = (double *)malloc(N * sizeof(double));
+    if (ctx->periods == NULL || ctx->persistent_index == NULL || ctx->stationary == NULL) return -1;
+
+    int persistent = 0;
+    for (int c = 0; c < C; c++) {
+        ctx->persistent_index[c] = ctx->partition.classes[c].is_persistent ? persistent++ : -1;
+    }
+    if (persistent != K) return -1;
+    ctx->num_persistent = K;
+
+    int64_t num_values;
+    if (blob_read(reader, ctx->periods, C * sizeof(int)) != 0
+        || blob_read(reader, ctx->stationary, N * sizeof(double)) != 0
+        || blob_read(reader, &num_values, sizeof(num_values)) != 0
+        || parse_absorption(&ctx->absorb, reader, ctx->partition, num_values) != 0) {
+        return -1;
+    }
+    ctx->absorb.num_persistent = K;
+
+    // La matrice creuse n'est pas stockée : elle se reconstruit en O(N + E) depuis le graphe déjà lu
+    ctx->P = graph_to_csr(ctx->graph);
+    if (ctx->P.row_ptr == NULL) return -1;
+    return (markov_build_in_edges(ctx) == MARKOV_OK) ? 0 : -1;
+}
+
+//Lecture du fichier de clé key. Retourne MARKOV_OK si les résultats ont été chargés.
+static t_markov_status load_with_key(t_markov_ctx *ctx, const char *cache_dir, uint64_t key) {
+    char path[CACHE_MAX_PATH];
+    size_t size = 0;
+
+    cache_path(cache_dir, key, path, sizeof(path));
+    unsigned char *data = read_whole_file(path, &size);
+    if (data == NULL) return MARKOV_ERR_IO;
+
+    t_blob_reader reader = {data, size - sizeof(uint64_t), 0};
+    t_cache_header header;
+    uint64_t checksum = 0;
+    int valid = size > sizeof(header) + sizeof(checksum);
+    if (valid) {
+        memcpy(&checksum, data + size - sizeof(checksum), sizeof(checksum));
+        valid = (cache_hash64(data, size - sizeof(checksum), 0) == checksum);
+    }
+    if (valid) {
+        blob_read(&reader, &header, sizeof(header));
+        valid = memcmp(header.magic, CACHE_MAGIC, 4) == 0 && header.format == CACHE_FORMAT
+                && strncmp(header.version, MARKOV_VERSION, CACHE_VERSION_LENGTH) == 0 && header.key == key
+                && header.num_vertices == ctx->num_vertices && header.num_edges == count_edges(ctx->graph)
+                && header.num_classes >= 0 && header.num_links >= 0
+                && header.num_persistent >= 0 && header.num_persistent <= header.num_classes;
+    }
+
+    clear_results(ctx);
+    if (valid && parse_results(ctx, &reader, &header) == 0 && reader.offset == reader.size) {
+        free(data);
+        ctx->stages_done |= MARKOV_STAGE_CLASSES | MARKOV_STAGE_SOLVED;
+        return MARKOV_OK;
+    }
+
+    clear_results(ctx);
+    free(data);
+    return MARKOV_ERR_IO;
+}
+
+t_markov_status markov_cache_load(t_markov_ctx *ctx, const char *cache_dir) {
+    if (ctx == NULL || cache_dir == NULL) return MARKOV_ERR_ARGUMENT;
+    if (!(ctx->stages_done & MARKOV_STAGE_CHECKED)) return MARKOV_ERR_STATE;
+    return load_with_key(ctx, cache_dir, markov_cache_key(ctx));
+}
+
+/*
+   store_with_key :
+   Écrit dans un fichier temporaire du même dossier puis le renomme : un lecteur
+   concurrent (plusieurs threads du mode batch, plusieurs processus) voit soit
+   l'ancien fichier, soit le nouveau complet, jamais un fichier à moitié écrit.
+*/
+static t_markov_status store_with_key(const t_markov_ctx *ctx, const char *cache_dir, uint64_t key) {
+    char path[CACHE_MAX_PATH];
+    char temp_path[CACHE_MAX_PATH];
+
+    if (mkdir(cache_dir, 0755) != 0 && errno != EEXIST) {
+        perror("Could not create cache directory");
+        return MARKOV_ERR_IO;
+    }
+    cache_path(cache_dir, key, path, sizeof(path));
+    snprintf(temp_path, sizeof(temp_path), "%s/.tmp_XXXXXX", cache_dir);
+    int fd = mkstemp(temp_path);
+    if (fd < 0) {
+        perror("Could not create cache file");
+        return MARKOV_ERR_IO;
+    }
+
+    t_blob_writer writer = {.file = fdopen(fd, "wb"), .failed = 0};
+    if (writer.file == NULL) {
+        close(fd);
+        unlink(temp_path);
+        return MARKOV_ERR_IO;
+    }
+    xxh64_init(&writer.state, 0);
+
+    int N = ctx->num_vertices;
+    int C = ctx->partition.num_classes;
+    int K = ctx->num_persistent;
+    t_cache_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CACHE_MAGIC, 4);
+    header.format = CACHE_FORMAT;
+    strncpy(header.version, MARKOV_VERSION, CACHE_VERSION_LENGTH - 1);
+    header.key = key;
+    header.num_vertices = N;
+    header.num_edges = count_edges(ctx->graph);
+    header.num_classes = C;
+    header.num_links = (ctx->hasse_links != NULL) ? ctx->hasse_links->size : 0;
+    header.num_persistent = K;
+    blob_write(&writer, &header, sizeof(header));
+
+    for (int i = 0; i < N; i++) {
+        int32_t class_id = ctx->partition.v_data[i].class_id;
+        blob_write(&writer, &class_id, sizeof(class_id));
+    }
+    for (int c = 0; c < C; c++) {
+        t_class class = ctx->partition.classes[c];
+        int32_t fields[2] = {class.num_members, class.is_persistent};
+        blob_write(&writer, fields, sizeof(fields));
+        blob_write(&writer, class.members_ids, class.num_members * sizeof(int));
+    }
+    for (int l = 0; l < header.num_links; l++) {
+        int32_t link[2] = {ctx->hasse_links->links[l].source_class_id, ctx->hasse_links->links[l].dest_class_id};
+        blob_write(&writer, link, sizeof(link));
+    }
+    blob_write(&writer, ctx->periods, C * sizeof(int));
+    blob_write(&writer, ctx->stationary, N * sizeof(double));
+    const t_absorption *A = &ctx->absorb;
+    int64_t num_values = (A->values != NULL) ? A->num_values : -1;
+    blob_write(&writer, &num_values, sizeof(num_values));
+    if (A->values != NULL) {
+        blob_write(&writer, A->class_ptr, (C + 1) * sizeof(long long));
+        blob_write(&writer, A->columns, A->class_ptr[C] * sizeof(int));
+        blob_write(&writer, A->values, A->num_values * sizeof(double));
+    }
+
+    uint64_t checksum = xxh64_digest(&writer.state);
+    if (!writer.failed && fwrite(&checksum, sizeof(checksum), 1, writer.file) != 1) writer.failed = 1;
+    if (fclose(writer.file) != 0) writer.failed = 1;
+
+    if (writer.failed || rename(temp_path, path) != 0) {
+        perror("Could not write cache file");
+        unlink(temp_path);
+        return MARKOV_ERR_IO;
+    }
+    return MARKOV_OK;
+}
+
+t_markov_status markov_cache_store(const t_markov_ctx *ctx, const char *cache_dir) {
+    if (ctx == NULL || cache_dir == NULL) return MARKOV_ERR_ARGUMENT;
+    if (!(ctx->stages_done & MARKOV_STAGE_SOLVED) || ctx->graph.adj_lists == NULL) return MARKOV_ERR_STATE;
+    return store_with_key(ctx, cache_dir, markov_cache_key(ctx));
+}
+
+/*
+   markov_analyze_cached :
+   Vérification de Markov (jamais mise en cache : elle coûte une lecture des
+   arêtes, comme l'empreinte), puis lecture du cache ou analyse complète suivie
+   de l'enregistrement. La clé n'est calculée qu'une fois.
+*/
+t_markov_status markov_analyze_cached(t_markov_ctx *ctx, const char *cache_dir, int *hit) {
+    if (hit != NULL) *hit = 0;
+    if (cache_dir == NULL) return markov_analyze(ctx);
+
+    t_markov_status status = markov_check(ctx);
+    if (status != MARKOV_OK) return status;
+
+    profile_begin(ctx->profiler, "cache_key");
+    uint64_t key = markov_cache_key(ctx);
+    profile_end(ctx->profiler);
+
+    profile_begin(ctx->profiler, "cache_load");
+    status = load_with_key(ctx, cache_dir, key);
+    profile_end(ctx->profiler);
+    if (status == MARKOV_OK) {
+        if (hit != NULL) *hit = 1;
+        return MARKOV_OK;
+    }
+
+    status = markov_analyze_classes(ctx);
+    if (status == MARKOV_OK) status = markov_solve(ctx);
+    if (status != MARKOV_OK) return status;
+    // Distribution non convergée : pas enregistrée, le prochain lancement la recalcule (et le signale à nouveau)
+    if (ctx->num_unconverged > 0) return MARKOV_OK;
+
+    profile_begin(ctx->profiler, "cache_store");
+    store_with_key(ctx, cache_dir, key);
+    profile_end(ctx->profiler);
+    return MARKOV_OK;
+}
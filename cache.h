@@ -0,0 +1,36 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stdint.h>
+#include "markov.h"
+
+/*
+   Cache disque des résultats de markov_analyze.
+   Un fichier <dossier>/<clé en hexadécimal>.mkc par chaîne : la clé est une empreinte
+   XXH64 du graphe lu (sommets, arêtes et probabilités, dans l'ordre des listes),
+   des réglages de l'analyse et de MARKOV_VERSION. Un autre graphe, d'autres
+   réglages ou une autre version donnent une autre clé : l'ancien fichier n'est
+   simplement plus lu.
+*/
+
+//Extension des fichiers du cache.
+#define MARKOV_CACHE_EXTENSION ".mkc"
+
+//Empreinte XXH64 d'un bloc mémoire (graine 0 pour l'empreinte standard).
+uint64_t cache_hash64(const void *data, size_t length, uint64_t seed);
+
+//Clé de cache d'une chaîne chargée (markov_load_*) : graphe, réglages de l'analyse et version.
+uint64_t markov_cache_key(const t_markov_ctx *ctx);
+
+//Remplit les résultats (classes, liens de Hasse, périodes, distributions, absorptions) depuis le cache.
+//La chaîne doit être chargée et vérifiée. Retourne MARKOV_OK si trouvé, MARKOV_ERR_IO si absent ou invalide.
+t_markov_status markov_cache_load(t_markov_ctx *ctx, const char *cache_dir);
+
+//Enregistre les résultats d'un contexte analysé (markov_solve exécuté). Écriture atomique (fichier temporaire puis rename).
+t_markov_status markov_cache_store(const t_markov_ctx *ctx, const char *cache_dir);
+
+//Comme markov_analyze, mais lit les résultats dans le cache s'ils y sont, et les y enregistre sinon.
+//hit (peut valoir NULL) reçoit 1 si le cache a servi. Un échec d'écriture du cache n'est pas une erreur d'analyse.
+t_markov_status markov_analyze_cached(t_markov_ctx *ctx, const char *cache_dir, int *hit);
+
+#endif // CACHE_H
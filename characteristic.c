@@ -16,7 +16,7 @@ int Transience(t_graph graph, t_class *class){
     // Une classe est transitoire si au moins un sommet a une arête vers l'extérieur.
     for(int i = 0; i < class->num_members; i++){
         int vertex = class->members_ids[i];
-        t_edge *edge = graph.adj_lists[vertex].head;
+        t_edge *edge = graph.adj_lists[vertex - 1].head; // members_ids est 1-based
         while(edge != NULL){
             int j;
             // Vérifie si l'arête mène vers l'intérieur de la classe
@@ -41,42 +41,52 @@ int Transience(t_graph graph, t_class *class){
 //La parcourir
 //Sur chaque classe vérifier la transience
 //Si récurrence vérifier l'absorbance de chaque sommet
+//Affichage dans out (tampon d'une tâche de taskgraph : l'affichage est recopié sur la console dans l'ordre des étapes),
+//sous les numéros du fichier (labels) ou les étiquettes (names)
 
-void Characterize(t_graph graph, t_partition partition){
+void Characterize(FILE *out, t_partition partition, const int *labels, const t_label_table *names){
     // Vérifie si la chaîne est irréductible
     if(partition.num_classes == 1){
-        printf("La chaine est irreductible\n");
+        fprintf(out, "La chaine est irreductible\n");
     }
     else{
-        printf("La chaine n'est pas irreductible\n");
+        fprintf(out, "La chaine n'est pas irreductible\n");
     }
     for(int i = 0; i < partition.num_classes; i++){ // Parcours des classes trouvées par Tarjan
         t_class * class = &partition.classes[i];
-        printf("\nClasse C%d : ", i);
-        // Vérifie si la classe est transitoire
-        if(Transience(graph, class) == 0){
-          printf("persistante\n"); //La classe est récurrente / persistante
+        fprintf(out, "\nClasse C%d : ", i);
+        // Persistance déjà calculée par set_persistence_flags (un passage sur les arêtes) : Transience,
+        // quadratique sur une grande classe, n'est pas rappelée ici
+        if(class->is_persistent){
+          fprintf(out, "persistante\n"); //La classe est récurrente / persistante
           if(class->num_members == 1){ //Vérifie si la classe contient un unique état
             int vertex = class->members_ids[0]; //L'unique sommet d'une classe récurrente / persistante est absorbant
-            printf("L'etat %d est persistant\n", vertex);
+            if(labels != NULL) vertex = labels[vertex - 1];
+            if(names != NULL) fprintf(out, "L'etat %s est persistant\n", label_name(names, vertex));
+            else fprintf(out, "L'etat %d est persistant\n", vertex);
           }
         }
         else{
-            printf("transitoire\n");
+            fprintf(out, "transitoire\n");
         }
     }
 }
 
 // Implémentation de la fonction pour la gestion des données
+// Même critère que Transience (une arête qui sort de la classe la rend transitoire), mais en comparant
+// les class_id de Tarjan : un seul passage sur les arêtes, au lieu de chercher chaque destination
+// parmi les membres (quadratique sur une grande classe).
 void set_persistence_flags(t_graph graph, t_partition *partition) {
     for (int i = 0; i < partition->num_classes; i++) {
-        // Appelle votre fonction de vérification
-        if (Transience(graph, &partition->classes[i]) == 0) {
-            // Si Transience retourne 0 → Persistante (Récurrente).
-            partition->classes[i].is_persistent = 1;
-        } else {
-            // Si Transience retourne 1 → Transitoire
-            partition->classes[i].is_persistent = 0;
+        partition->classes[i].is_persistent = 1;
+    }
+    for (int v = 0; v < graph.num_vertices; v++) {
+        int class_id = partition->v_data[v].class_id;
+        for (t_edge *edge = graph.adj_lists[v].head; edge != NULL; edge = edge->next) {
+            if (partition->v_data[edge->destination - 1].class_id != class_id) {
+                partition->classes[class_id - 1].is_persistent = 0; // Arête sortante → transitoire
+                break;
+            }
         }
     }
-}
\ No newline at end of file
+}
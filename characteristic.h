@@ -1,5 +1,6 @@
 #ifndef CHARACTERISTIC_H
 #define CHARACTERISTIC_H
+#include <stdio.h>
 #include "tarjan.h"
 
 // PARTIE 2 étape 3 :
@@ -7,8 +8,9 @@
 //Fonction qui vérifie la transience d'une classe
 int Transience(t_graph graph, t_class *classe);
 
-//Fonction qui parcourt la chaîne et vérifie les caractéristiques
-void Characterize(t_graph graph, t_partition partition);
+//Fonction qui parcourt la chaîne et affiche ses caractéristiques dans out. Lit is_persistent (set_persistence_flags déjà appelée).
+//L'état v est affiché sous le numéro labels[v - 1] (NULL : numéros du graphe), le numéro n sous l'étiquette n de names (NULL : numéros).
+void Characterize(FILE *out, t_partition partition, const int *labels, const t_label_table *names);
 
 //Fonction nécessaire pour modifier la structure partition et stocker l'information de persistence (is_persistent) pour le Défi Bonus.
 void set_persistence_flags(t_graph graph, t_partition *partition);
@@ -0,0 +1,309 @@
+#include "checkpoint.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "cache.h"
+
+#define CHECKPOINT_MAGIC "MKCP"
+#define CHECKPOINT_FORMAT 1
+
+// ---------------------------------------------------------------------------
+// Format du fichier (entiers 32 bits et doubles, ordre d'octets de la machine) :
+//   en-tête     "MKCP", format, clé, N, classes, tolérance, classe en cours,
+//               écarts enregistrés
+//   classes     itérations faites (-1 : pas commencée), puis méthode de chaque classe
+//   itéré       pi (N doubles)
+//   historique  CHECKPOINT_HISTORY doubles, les écarts enregistrés d'abord, du plus ancien au plus récent
+//   fin         XXH64 de tout ce qui précède (fichier tronqué ou corrompu = refusé)
+// Toutes les tailles sont fixées par N et le nombre de classes : l'image est allouée
+// une fois et recopiée en place à chaque point.
+// ---------------------------------------------------------------------------
+
+typedef struct s_checkpoint_header {
+    char magic[4];
+    int32_t format;
+    uint64_t key;
+    int32_t num_vertices;
+    int32_t num_classes;
+    double epsilon;
+    int32_t current_class;
+    int32_t history_length;
+} t_checkpoint_header;
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+static size_t image_size(int num_vertices, int num_classes) {
+    return sizeof(t_checkpoint_header) + 2 * (size_t)num_classes * sizeof(int32_t)
+         + ((size_t)num_vertices + CHECKPOINT_HISTORY) * sizeof(double) + sizeof(uint64_t);
+}
+
+/*
+   write_image :
+   Fichier temporaire du même dossier, vidé sur le disque (fsync) puis renommé : après
+   un arrêt brutal, path contient le point précédent ou le nouveau, complet.
+   Retourne 0, ou -1 en cas d'erreur.
+*/
+static int write_image(const t_checkpointer *cp) {
+    char temp_path[CHECKPOINT_MAX_PATH + 16];
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp_XXXXXX", cp->path);
+    int fd = mkstemp(temp_path);
+    if (fd < 0) {
+        perror("Could not create checkpoint file");
+        return -1;
+    }
+    FILE *file = fdopen(fd, "wb");
+    if (file == NULL) {
+        close(fd);
+        unlink(temp_path);
+        return -1;
+    }
+
+    int failed = (fwrite(cp->image, 1, cp->image_size, file) != cp->image_size);
+    if (!failed) failed = (fflush(file) != 0 || fsync(fd) != 0);
+    if (fclose(file) != 0) failed = 1;
+    if (failed || rename(temp_path, cp->path) != 0) {
+        perror("Could not write checkpoint file");
+        unlink(temp_path);
+        return -1;
+    }
+    return 0;
+}
+
+/*
+   checkpoint_writer :
+   Boucle du thread d'écriture : attend une image, l'écrit hors du verrou, puis la
+   rend au thread de calcul. À l'arrêt, l'image en attente est écrite d'abord.
+*/
+static void *checkpoint_writer(void *arg) {
+    t_checkpointer *cp = (t_checkpointer *)arg;
+
+    pthread_mutex_lock(&cp->lock);
+    while (1) {
+        while (!cp->pending && !cp->stop) pthread_cond_wait(&cp->changed, &cp->lock);
+        if (!cp->pending) break;
+        pthread_mutex_unlock(&cp->lock);
+
+        int status = write_image(cp);
+
+        pthread_mutex_lock(&cp->lock);
+        cp->pending = 0;
+        if (status == 0) cp->written++;
+        else cp->failed++;
+    }
+    pthread_mutex_unlock(&cp->lock);
+    return NULL;
+}
+
+/*
+   request_point :
+   Recopie l'état dans l'image et la confie au thread d'écriture, sauf s'il écrit
+   encore la précédente. La recopie de pi (N doubles) coûte moins qu'une itération,
+   qui parcourt au moins une fois chaque état de la classe et ses arêtes.
+*/
+static void request_point(t_checkpointer *cp, const double *pi) {
+    cp->last_ms = now_ms();
+    pthread_mutex_lock(&cp->lock);
+    if (cp->pending) {
+        cp->skipped++;
+        pthread_mutex_unlock(&cp->lock);
+        return;
+    }
+    pthread_mutex_unlock(&cp->lock);
+
+    int N = cp->num_vertices;
+    int C = cp->num_classes;
+    t_checkpoint_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CHECKPOINT_MAGIC, 4);
+    header.format = CHECKPOINT_FORMAT;
+    header.key = cp->key;
+    header.num_vertices = N;
+    header.num_classes = C;
+    header.epsilon = cp->epsilon;
+    header.current_class = cp->current_class;
+    header.history_length = cp->history_length;
+
+    unsigned char *p = cp->image;
+    memcpy(p, &header, sizeof(header));
+    p += sizeof(header);
+    memcpy(p, cp->iterations, C * sizeof(int32_t));
+    p += C * sizeof(int32_t);
+    memcpy(p, cp->methods, C * sizeof(int32_t));
+    p += C * sizeof(int32_t);
+    memcpy(p, pi, N * sizeof(double));
+    p += N * sizeof(double);
+    for (int h = 0; h < CHECKPOINT_HISTORY; h++) {
+        double value = (h < cp->history_length) ? cp->history[(cp->history_start + h) % CHECKPOINT_HISTORY] : 0.0;
+        memcpy(p, &value, sizeof(double));
+        p += sizeof(double);
+    }
+    uint64_t checksum = cache_hash64(cp->image, cp->image_size - sizeof(uint64_t), 0);
+    memcpy(p, &checksum, sizeof(checksum));
+
+    pthread_mutex_lock(&cp->lock);
+    cp->pending = 1;
+    pthread_cond_signal(&cp->changed);
+    pthread_mutex_unlock(&cp->lock);
+}
+
+/*
+   load_image :
+   Contrôle la taille, l'empreinte et l'en-tête avant de recopier l'état. Retourne
+   MARKOV_OK, MARKOV_ERR_IO si le fichier est absent, MARKOV_ERR_FORMAT s'il est
+   invalide ou s'il appartient à une autre chaîne.
+*/
+static t_markov_status load_image(t_checkpointer *cp) {
+    FILE *file = fopen(cp->path, "rb");
+    if (file == NULL) return MARKOV_ERR_IO;
+    size_t length = fread(cp->image, 1, cp->image_size, file);
+    int trailing = (fgetc(file) != EOF);
+    fclose(file);
+    if (length != cp->image_size || trailing) return MARKOV_ERR_FORMAT;
+
+    uint64_t checksum;
+    memcpy(&checksum, cp->image + cp->image_size - sizeof(checksum), sizeof(checksum));
+    if (checksum != cache_hash64(cp->image, cp->image_size - sizeof(checksum), 0)) return MARKOV_ERR_FORMAT;
+
+    t_checkpoint_header header;
+    memcpy(&header, cp->image, sizeof(header));
+    if (memcmp(header.magic, CHECKPOINT_MAGIC, 4) != 0 || header.format != CHECKPOINT_FORMAT || header.key != cp->key
+        || header.num_vertices != cp->num_vertices || header.num_classes != cp->num_classes || header.epsilon != cp->epsilon
+        || header.current_class < -1 || header.current_class >= cp->num_classes || header.history_length < 0
+        || header.history_length > CHECKPOINT_HISTORY) {
+        return MARKOV_ERR_FORMAT;
+    }
+
+    int N = cp->num_vertices;
+    int C = cp->num_classes;
+    const unsigned char *p = cp->image + sizeof(header);
+    memcpy(cp->iterations, p, C * sizeof(int32_t));
+    p += C * sizeof(int32_t);
+    memcpy(cp->methods, p, C * sizeof(int32_t));
+    p += C * sizeof(int32_t);
+    memcpy(cp->resume_pi, p, N * sizeof(double));
+    p += N * sizeof(double);
+    memcpy(cp->history, p, CHECKPOINT_HISTORY * sizeof(double));
+    cp->history_start = 0;
+    cp->history_length = header.history_length;
+    cp->current_class = header.current_class;
+    return MARKOV_OK;
+}
+
+t_markov_status checkpoint_open(t_checkpointer *cp, const char *path, double interval_s, uint64_t key, int num_vertices,
+                                int num_classes, double epsilon, int resume) {
+    memset(cp, 0, sizeof(*cp));
+    if (path == NULL || strlen(path) >= CHECKPOINT_MAX_PATH || num_vertices <= 0 || num_classes <= 0) {
+        return MARKOV_ERR_ARGUMENT;
+    }
+    strcpy(cp->path, path);
+    cp->interval_ms = interval_s * 1000.0;
+    cp->key = key;
+    cp->num_vertices = num_vertices;
+    cp->num_classes = num_classes;
+    cp->epsilon = epsilon;
+    cp->current_class = -1;
+    cp->image_size = image_size(num_vertices, num_classes);
+    cp->image = (unsigned char *)malloc(cp->image_size);
+    cp->iterations = (int *)malloc(num_classes * sizeof(int));
+    cp->methods = (int *)calloc(num_classes, sizeof(int));
+    if (resume) cp->resume_pi = (double *)malloc(num_vertices * sizeof(double));
+    if (cp->image == NULL || cp->iterations == NULL || cp->methods == NULL || (resume && cp->resume_pi == NULL)) {
+        perror("Allocation failed for checkpoint");
+        free(cp->image);
+        free(cp->iterations);
+        free(cp->methods);
+        free(cp->resume_pi);
+        memset(cp, 0, sizeof(*cp));
+        return MARKOV_ERR_NOMEM;
+    }
+    for (int i = 0; i < num_classes; i++) cp->iterations[i] = -1;
+
+    if (resume) {
+        t_markov_status status = load_image(cp);
+        if (status == MARKOV_ERR_FORMAT) {
+            free(cp->image);
+            free(cp->iterations);
+            free(cp->methods);
+            free(cp->resume_pi);
+            memset(cp, 0, sizeof(*cp));
+            return status;
+        }
+        cp->resumed = (status == MARKOV_OK);
+        if (!cp->resumed) {
+            free(cp->resume_pi);
+            cp->resume_pi = NULL;
+        }
+    }
+
+    pthread_mutex_init(&cp->lock, NULL);
+    pthread_cond_init(&cp->changed, NULL);
+    if (pthread_create(&cp->thread, NULL, checkpoint_writer, cp) != 0) {
+        // Sans thread, chaque point reste en attente : les suivants sont sautés
+        fprintf(stderr, "Warning: checkpoint writer thread could not start.\n");
+        cp->pending = 1;
+        cp->stop = -1;
+    }
+    cp->last_ms = now_ms();
+    return MARKOV_OK;
+}
+
+int checkpoint_class_done(const t_checkpointer *cp, int class_index) {
+    return cp->resumed && cp->iterations[class_index] >= 0 && class_index != cp->current_class;
+}
+
+void checkpoint_begin_class(t_checkpointer *cp, int class_index) {
+    if (cp->resumed && class_index == cp->current_class) return;
+    cp->current_class = class_index;
+    cp->iterations[class_index] = 0;
+    cp->history_start = 0;
+    cp->history_length = 0;
+}
+
+void checkpoint_observe(void *data, const double *pi, int iteration, double diff) {
+    t_checkpointer *cp = (t_checkpointer *)data;
+    cp->iterations[cp->current_class] = iteration;
+    if (cp->history_length < CHECKPOINT_HISTORY) {
+        cp->history[(cp->history_start + cp->history_length++) % CHECKPOINT_HISTORY] = diff;
+    } else {
+        cp->history[cp->history_start] = diff;
+        cp->history_start = (cp->history_start + 1) % CHECKPOINT_HISTORY;
+    }
+    if (now_ms() - cp->last_ms >= cp->interval_ms) request_point(cp, pi);
+}
+
+void checkpoint_end_class(t_checkpointer *cp, int class_index, int iterations, int method, const double *pi) {
+    cp->iterations[class_index] = iterations;
+    cp->methods[class_index] = method;
+    cp->current_class = -1;
+    cp->history_length = 0;
+    if (now_ms() - cp->last_ms >= cp->interval_ms) request_point(cp, pi);
+}
+
+void checkpoint_close(t_checkpointer *cp, int remove_file) {
+    if (cp->image == NULL) return;
+    if (cp->stop == 0) {
+        pthread_mutex_lock(&cp->lock);
+        cp->stop = 1;
+        pthread_cond_signal(&cp->changed);
+        pthread_mutex_unlock(&cp->lock);
+        pthread_join(cp->thread, NULL);
+    }
+    pthread_cond_destroy(&cp->changed);
+    pthread_mutex_destroy(&cp->lock);
+    if (remove_file) unlink(cp->path);
+    free(cp->image);
+    free(cp->iterations);
+    free(cp->methods);
+    free(cp->resume_pi);
+    cp->image = NULL;
+    cp->iterations = NULL;
+    cp->methods = NULL;
+    cp->resume_pi = NULL;
+}
@@ -0,0 +1,80 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdint.h>
+#include <pthread.h>
+#include "markov_status.h"
+
+/*
+   Points de reprise des longues itérations stationnaires (moteur sparse).
+   Le fichier garde l'état du solveur : itéré pi (N doubles), itérations faites et
+   méthode de chaque classe, classe en cours et écarts de ses dernières itérations.
+   L'itération ne s'arrête pas pour écrire : l'état est recopié dans l'image du
+   fichier, qu'un thread d'écriture enregistre dans un fichier temporaire puis
+   renomme. Un arrêt pendant l'écriture laisse le point précédent intact ; si le
+   thread écrit encore le point précédent, le nouveau est sauté.
+   Le fichier n'est relu que pour la même chaîne (clé markov_cache_key), le même
+   nombre de classes et la même tolérance : un autre fichier est refusé.
+*/
+
+//Intervalle par défaut entre deux points (secondes).
+#define CHECKPOINT_DEFAULT_SECONDS 60.0
+
+//Écarts gardés au plus pour la classe en cours.
+#define CHECKPOINT_HISTORY 256
+
+#define CHECKPOINT_MAX_PATH 1024
+
+//État du solveur et thread d'écriture des points de reprise.
+typedef struct s_checkpointer {
+    char path[CHECKPOINT_MAX_PATH];
+    double interval_ms;         // Intervalle entre deux points
+    double last_ms;             // Date du dernier point demandé
+    uint64_t key;               // Clé de la chaîne (markov_cache_key)
+    int num_vertices;
+    int num_classes;
+    double epsilon;             // Tolérance des itérations
+    int current_class;          // Classe en cours (indice), -1 entre deux classes
+    int *iterations;            // Par classe : itérations faites, -1 si la classe n'est pas commencée
+    int *methods;               // Par classe : méthode de calcul, valeur laissée à l'appelant
+    double history[CHECKPOINT_HISTORY]; // Écarts des dernières itérations de la classe en cours (tampon circulaire)
+    int history_start;
+    int history_length;
+    double *resume_pi;          // Itéré relu par checkpoint_open (reprise), NULL sinon
+    int resumed;                // 1 si l'état vient d'un fichier relu
+    unsigned char *image;       // Image du fichier, remplie par le thread de calcul, écrite par le thread d'écriture
+    size_t image_size;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    int pending;                // 1 tant que l'image n'est pas écrite
+    int stop;
+    int written;                // Points écrits, sautés (écriture en cours) et en échec
+    int skipped;
+    int failed;
+} t_checkpointer;
+
+//Prépare les points de reprise dans path (un point toutes les interval_s secondes au plus) et lance le thread d'écriture.
+//Avec resume, l'état est relu dans path s'il existe et correspond à la chaîne (resumed passe à 1). Retourne MARKOV_OK,
+//MARKOV_ERR_FORMAT si le fichier relu est invalide ou d'une autre chaîne, MARKOV_ERR_NOMEM si la mémoire manque.
+t_markov_status checkpoint_open(t_checkpointer *cp, const char *path, double interval_s, uint64_t key, int num_vertices,
+                                int num_classes, double epsilon, int resume);
+
+//1 si la classe était terminée dans le point relu (itérations et méthode dans iterations et methods), 0 sinon.
+int checkpoint_class_done(const t_checkpointer *cp, int class_index);
+
+//Classe class_index commencée (ou reprise) : l'historique des écarts repart de zéro, sauf pour la classe reprise.
+void checkpoint_begin_class(t_checkpointer *cp, int class_index);
+
+//Itération terminée sur la classe en cours (signature de t_stationary_monitor) : enregistre l'écart, et demande un point
+//si l'intervalle est écoulé.
+void checkpoint_observe(void *data, const double *pi, int iteration, double diff);
+
+//Classe terminée après iterations itérations (method : valeur de l'appelant). Demande un point si l'intervalle est écoulé.
+void checkpoint_end_class(t_checkpointer *cp, int class_index, int iterations, int method, const double *pi);
+
+//Attend la fin de l'écriture en cours, arrête le thread et libère l'état (les compteurs written, skipped et failed restent
+//lisibles). Avec remove_file, le fichier est supprimé (calcul terminé : il ne servirait plus).
+void checkpoint_close(t_checkpointer *cp, int remove_file);
+
+#endif // CHECKPOINT_H
@@ -0,0 +1,1049 @@
+#include "delta.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "markov_check.h"
+
+/*
+   Principe de markov_apply_delta :
+   1. validation complète (sommets, transitions, propriété de Markov des sommets
+      modifiés), puis modification de la liste d'adjacence ;
+   2. classes : un retrait interne peut couper une classe, recoupée par Tarjan sur
+      ses seuls membres ; un ajout entre classes peut fermer un cycle. Les
+      identifiants de classe suivent un ordre topologique (une classe n'atteint
+      que des classes d'identifiant plus petit) : un ajout qui respecte cet ordre
+      ne change rien, sinon seule la fenêtre d'identifiants entre les deux classes
+      est parcourue et réordonnée (algorithme de Pearce et Kelly), et les classes
+      d'un cycle fermé sont fusionnées ;
+   3. persistance recalculée pour les seules classes modifiées, lignes modifiées
+      de la matrice creuse reconstruites, le reste recopié ;
+   4. résultats : distribution stationnaire et période des seules classes
+      persistantes modifiées (départ à chaud depuis l'ancienne distribution),
+      probabilités d'absorption des classes transitoires modifiées ou qui
+      atteignent directement une classe recalculée (départ à chaud).
+*/
+
+void delta_init(t_delta *delta) {
+    memset(delta, 0, sizeof(*delta));
+}
+
+void free_delta(t_delta *delta) {
+    if (delta == NULL) return;
+    free(delta->ops);
+    delta_init(delta);
+}
+
+/*
+   delta_add :
+   Capacité doublée au besoin, comme le tableau des classes de Tarjan.
+*/
+t_markov_status delta_add(t_delta *delta, t_delta_kind kind, int from, int to, float probability) {
+    if (delta == NULL) return MARKOV_ERR_ARGUMENT;
+
+    if (delta->num_ops == delta->capacity) {
+        int new_capacity = (delta->capacity > 0) ? 2 * delta->capacity : 16;
+        t_delta_op *ops = (t_delta_op *)realloc(delta->ops, new_capacity * sizeof(t_delta_op));
+        if (ops == NULL) {
+            perror("Realloc failed for delta operations");
+            return MARKOV_ERR_NOMEM;
+        }
+        delta->ops = ops;
+        delta->capacity = new_capacity;
+    }
+    delta->ops[delta->num_ops++] = (t_delta_op){kind, from, to, probability};
+    return MARKOV_OK;
+}
+
+/*
+   delta_load_file :
+   Une modification par ligne : "+ départ arrivée probabilité", "- départ arrivée"
+   ou "= départ arrivée probabilité". Les bornes des sommets sont vérifiées par
+   markov_apply_delta, qui connaît N.
+*/
+t_markov_status delta_load_file(const char *path, t_delta *delta) {
+    if (path == NULL || delta == NULL) return MARKOV_ERR_ARGUMENT;
+
+    delta_init(delta);
+    FILE *file = fopen(path, "rt");
+    if (file == NULL) {
+        perror("Could not open delta file for reading");
+        return MARKOV_ERR_IO;
+    }
+
+    char line[256];
+    int line_number = 0;
+    t_markov_status status = MARKOV_OK;
+    while (status == MARKOV_OK && fgets(line, sizeof(line), file) != NULL) {
+        line_number++;
+        char *text = line;
+        while (*text == ' ' || *text == '\t') text++;
+        if (*text == '\0' || *text == '\n' || *text == '\r' || *text == '#') continue;
+
+        char op;
+        int from, to;
+        float proba = 0.0f;
+        int fields = sscanf(text, "%c %d %d %f", &op, &from, &to, &proba);
+
+        if (op == '+' && fields == 4) status = delta_add(delta, DELTA_ADD, from, to, proba);
+        else if (op == '-' && fields >= 3) status = delta_add(delta, DELTA_REMOVE, from, to, 0.0f);
+        else if (op == '=' && fields == 4) status = delta_add(delta, DELTA_REWEIGHT, from, to, proba);
+        else {
+            fprintf(stderr, "Error: Invalid delta line %d in %s.\n", line_number, path);
+            status = MARKOV_ERR_FORMAT;
+        }
+    }
+
+    fclose(file);
+    if (status != MARKOV_OK) free_delta(delta);
+    return status;
+}
+
+//Modification repérée par son couple (départ, arrivée) : le tri regroupe les modifications d'un même sommet.
+typedef struct s_delta_key {
+    long long key;   // (départ << 32) | arrivée
+    int op;          // Indice dans delta->ops
+} t_delta_key;
+
+static int compare_delta_keys(const void *a, const void *b) {
+    long long ka = ((const t_delta_key *)a)->key;
+    long long kb = ((const t_delta_key *)b)->key;
+    return (ka > kb) - (ka < kb);
+}
+
+//Première arête from → to de la liste de from (1-based), NULL si absente.
+static t_edge *find_edge(t_graph graph, int from, int to) {
+    for (t_edge *e = graph.adj_lists[from - 1].head; e != NULL; e = e->next) {
+        if (e->destination == to) return e;
+    }
+    return NULL;
+}
+
+/*
+   validate_delta :
+   Vérifie toutes les modifications avant de toucher au graphe : sommets dans
+   [1, N], probabilités dans ]0, 1], transition présente (retrait, repondération)
+   ou absente (ajout), au plus une modification par transition. Puis somme des
+   probabilités sortantes de chaque sommet modifié, calculée comme dans
+   count_non_markov_vertices. touched reçoit les sommets modifiés (0-based, croissants).
+*/
+static t_markov_status validate_delta(t_markov_ctx *ctx, const t_delta *delta, int **touched, int *num_touched) {
+    t_graph graph = ctx->graph;
+    int N = graph.num_vertices;
+    int n = delta->num_ops;
+
+    for (int i = 0; i < n; i++) {
+        t_delta_op op = delta->ops[i];
+        if (op.from < 1 || op.from > N || op.to < 1 || op.to > N) {
+            fprintf(stderr, "Error: Invalid vertex number (%d or %d) in delta.\n", op.from, op.to);
+            return MARKOV_ERR_FORMAT;
+        }
+        if (op.kind != DELTA_REMOVE && !(op.probability > 0.0f && op.probability <= 1.0f)) {
+            fprintf(stderr, "Error: Invalid probability %f for %d -> %d in delta.\n", op.probability, op.from, op.to);
+            return MARKOV_ERR_FORMAT;
+        }
+    }
+
+    t_delta_key *keys = (t_delta_key *)malloc(n * sizeof(t_delta_key));
+    *touched = (int *)malloc(n * sizeof(int));
+    if (keys == NULL || *touched == NULL) {
+        perror("Allocation failed for delta validation");
+        free(keys);
+        free(*touched);
+        *touched = NULL;
+        return MARKOV_ERR_NOMEM;
+    }
+    for (int i = 0; i < n; i++) {
+        keys[i].key = ((long long)delta->ops[i].from << 32) | (unsigned int)delta->ops[i].to;
+        keys[i].op = i;
+    }
+    qsort(keys, n, sizeof(t_delta_key), compare_delta_keys);
+
+    t_markov_status status = MARKOV_OK;
+    int count = 0, invalid = 0;
+    for (int i = 0; i < n && status == MARKOV_OK;) {
+        int from = (int)(keys[i].key >> 32);
+        float sum_proba = 0.0f;
+        for (t_edge *e = graph.adj_lists[from - 1].head; e != NULL; e = e->next) sum_proba += e->probability;
+
+        int j;
+        for (j = i; j < n && (int)(keys[j].key >> 32) == from && status == MARKOV_OK; j++) {
+            t_delta_op op = delta->ops[keys[j].op];
+            t_edge *edge = find_edge(graph, op.from, op.to);
+
+            if (j > i && keys[j].key == keys[j - 1].key) {
+                fprintf(stderr, "Error: Transition %d -> %d modified twice in delta.\n", op.from, op.to);
+                status = MARKOV_ERR_FORMAT;
+            } else if (op.kind == DELTA_ADD && edge != NULL) {
+                fprintf(stderr, "Error: Transition %d -> %d already exists (use '=' to reweight).\n", op.from, op.to);
+                status = MARKOV_ERR_FORMAT;
+            } else if (op.kind != DELTA_ADD && edge == NULL) {
+                fprintf(stderr, "Error: Transition %d -> %d not found.\n", op.from, op.to);
+                status = MARKOV_ERR_FORMAT;
+            } else if (op.kind == DELTA_ADD) {
+                sum_proba += op.probability;
+            } else if (op.kind == DELTA_REMOVE) {
+                sum_proba -= edge->probability;
+            } else {
+                sum_proba += op.probability - edge->probability;
+            }
+        }
+
+        if (fabsf(sum_proba - 1.0f) > TOLERANCE) invalid++;
+        (*touched)[count++] = from - 1;
+        i = j;
+    }
+    free(keys);
+
+    if (status == MARKOV_OK && invalid > 0) {
+        ctx->num_invalid_vertices = invalid;
+        status = MARKOV_ERR_NOT_MARKOV;
+    }
+    if (status != MARKOV_OK) {
+        free(*touched);
+        *touched = NULL;
+        return status;
+    }
+    *num_touched = count;
+    return MARKOV_OK;
+}
+
+/*
+   apply_to_graph :
+   Les arêtes ajoutées sont toutes allouées d'abord : si la mémoire manque, le
+   graphe n'a pas changé. Un ajout se place en tête de liste (add_edge_to_list).
+*/
+static t_markov_status apply_to_graph(t_graph graph, const t_delta *delta) {
+    int num_added = 0;
+    for (int i = 0; i < delta->num_ops; i++) num_added += (delta->ops[i].kind == DELTA_ADD);
+
+    t_edge **added = (t_edge **)malloc((num_added > 0 ? num_added : 1) * sizeof(t_edge *));
+    if (added == NULL) {
+        perror("Allocation failed for delta edges");
+        return MARKOV_ERR_NOMEM;
+    }
+    int a = 0;
+    for (int i = 0; i < delta->num_ops; i++) {
+        if (delta->ops[i].kind != DELTA_ADD) continue;
+        added[a] = create_edge(delta->ops[i].to, delta->ops[i].probability);
+        if (added[a] == NULL) {
+            while (a > 0) free(added[--a]);
+            free(added);
+            return MARKOV_ERR_NOMEM;
+        }
+        a++;
+    }
+
+    a = 0;
+    for (int i = 0; i < delta->num_ops; i++) {
+        t_delta_op op = delta->ops[i];
+        if (op.kind == DELTA_ADD) {
+            add_edge_to_list(&graph.adj_lists[op.from - 1], added[a++]);
+        } else if (op.kind == DELTA_REMOVE) {
+            t_edge **link = &graph.adj_lists[op.from - 1].head;
+            while ((*link)->destination != op.to) link = &(*link)->next;
+            t_edge *removed = *link;
+            *link = removed->next;
+            free(removed);
+        } else {
+            find_edge(graph, op.from, op.to)->probability = op.probability;
+        }
+    }
+
+    free(added);
+    return MARKOV_OK;
+}
+
+//Classe en cours de mise à jour, désignée par un numéro stable (handle) ; sa position dans order donne l'ordre des identifiants.
+typedef struct s_work_class {
+    int *members;          // Sommets 1-based (tableau repris de l'ancienne partition ou créé)
+    int num_members;
+    int origin;            // Indice dans l'ancienne partition, -1 si la classe vient d'une coupure ou d'une fusion
+    int changed;           // 1 si ses résultats sont à recalculer
+    int alive;             // 0 une fois coupée ou fusionnée
+    int is_persistent;
+} t_work_class;
+
+//État de la mise à jour des classes.
+typedef struct s_delta_work {
+    t_graph graph;
+    t_tarjan_vertex *v_data;  // class_id = handle + 1 pendant la mise à jour
+    t_work_class *classes;    // Par handle
+    int num_handles;
+    int capacity;             // Cases de classes, order, pos, mark et slot
+    int *order;               // Position -> handle (une classe fusionnée garde sa position, alive = 0)
+    int num_positions;
+    int *pos;                 // Handle -> position
+    int *mark;                // Handle -> estampille du dernier parcours qui l'a atteint
+    int *slot;                // Handle -> indice dans ce parcours
+    int stamp;
+    int *local;               // N cases à -1 pour find_cfcs_subset, allouées au premier besoin
+} t_delta_work;
+
+static int handle_of(const t_delta_work *work, int vertex_id) {
+    return work->v_data[vertex_id - 1].class_id - 1;
+}
+
+
+//Agrandit un tableau d'entiers indexé par handle ; les nouvelles cases valent 0. Retourne 0, ou -1 si la mémoire manque.
+static int grow_int_array(int **array, int old_capacity, int new_capacity) {
+    int *grown = (int *)realloc(*array, new_capacity * sizeof(int));
+    if (grown == NULL) return -1;
+    memset(grown + old_capacity, 0, (new_capacity - old_capacity) * sizeof(int));
+    *array = grown;
+    return 0;
+}
+
+//Garantit la place de extra nouveaux handles (capacité doublée). Retourne 0, ou -1 si la mémoire manque.
+static int reserve_handles(t_delta_work *work, int extra) {
+    if (work->num_handles + extra <= work->capacity) return 0;
+
+    int new_capacity = 2 * work->capacity;
+    if (new_capacity < work->num_handles + extra) new_capacity = work->num_handles + extra;
+
+    t_work_class *classes = (t_work_class *)realloc(work->classes, new_capacity * sizeof(t_work_class));
+    if (classes != NULL) work->classes = classes;
+    if (classes == NULL
+        || grow_int_array(&work->order, work->capacity, new_capacity) != 0
+        || grow_int_array(&work->pos, work->capacity, new_capacity) != 0
+        || grow_int_array(&work->mark, work->capacity, new_capacity) != 0
+        || grow_int_array(&work->slot, work->capacity, new_capacity) != 0) {
+        perror("Realloc failed for delta classes");
+        return -1;
+    }
+    work->capacity = new_capacity;
+    return 0;
+}
+
+/*
+   init_work :
+   La classe d'indice i de l'ancienne partition devient le handle i ; ses membres
+   passent à la mise à jour (la partition ne garde que l'enveloppe du tableau).
+*/
+static int init_work(t_delta_work *work, t_markov_ctx *ctx) {
+    int C = ctx->partition.num_classes;
+
+    memset(work, 0, sizeof(*work));
+    work->graph = ctx->graph;
+    work->v_data = ctx->partition.v_data;
+    work->capacity = C + 16;
+    work->classes = (t_work_class *)malloc(work->capacity * sizeof(t_work_class));
+    work->order = (int *)malloc(work->capacity * sizeof(int));
+    work->pos = (int *)malloc(work->capacity * sizeof(int));
+    work->mark = (int *)calloc(work->capacity, sizeof(int));
+    work->slot = (int *)calloc(work->capacity, sizeof(int));
+    if (work->classes == NULL || work->order == NULL || work->pos == NULL || work->mark == NULL || work->slot == NULL) {
+        perror("Allocation failed for delta classes");
+        return -1;
+    }
+
+    for (int i = 0; i < C; i++) {
+        t_class *c = &ctx->partition.classes[i];
+        work->classes[i] = (t_work_class){c->members_ids, c->num_members, i, 0, 1, c->is_persistent};
+        c->members_ids = NULL;
+        work->order[i] = i;
+        work->pos[i] = i;
+    }
+    work->num_handles = C;
+    work->num_positions = C;
+    return 0;
+}
+
+//Libère l'état de la mise à jour, y compris les membres des classes qui n'ont pas rejoint la nouvelle partition.
+static void free_work(t_delta_work *work) {
+    if (work->classes != NULL) {
+        for (int h = 0; h < work->num_handles; h++) {
+            if (work->classes[h].alive) free(work->classes[h].members);
+        }
+    }
+    free(work->classes);
+    free(work->order);
+    free(work->pos);
+    free(work->mark);
+    free(work->slot);
+    free(work->local);
+}
+
+//Nouveau handle (place réservée par reserve_handles), marqué modifié, avec la place de num_members sommets. -1 si la mémoire manque.
+static int new_handle(t_delta_work *work, int num_members) {
+    int h = work->num_handles++;
+    work->classes[h] = (t_work_class){NULL, 0, -1, 1, 1, 0};
+    work->classes[h].members = (int *)malloc((num_members > 0 ? num_members : 1) * sizeof(int));
+    if (work->classes[h].members == NULL) {
+        perror("Allocation failed for delta class members");
+        return -1;
+    }
+    return h;
+}
+
+/*
+   split_class :
+   Tarjan sur les seuls membres de la classe h (graphe déjà modifié). S'il y a
+   plusieurs CFC, elles remplacent h à sa position, dans l'ordre où Tarjan les
+   termine : chacune n'atteint que celles placées avant elle, et leurs arêtes vers
+   l'extérieur sont celles de l'ancienne classe, déjà compatibles avec l'ordre.
+*/
+static int split_class(t_delta_work *work, int h, t_delta_stats *stats) {
+    int k = work->classes[h].num_members;
+    int *members = work->classes[h].members;
+    if (k <= 1) return 0;
+
+    if (work->local == NULL) {
+        int N = work->graph.num_vertices;
+        work->local = (int *)malloc(N * sizeof(int));
+        if (work->local == NULL) {
+            perror("Allocation failed for delta Tarjan buffer");
+            return -1;
+        }
+        for (int v = 0; v < N; v++) work->local[v] = -1;
+    }
+
+    int *component = (int *)malloc(k * sizeof(int));
+    if (component == NULL) {
+        perror("Allocation failed for delta Tarjan components");
+        return -1;
+    }
+    int count = find_cfcs_subset(work->graph, members, k, work->local, component);
+    if (count <= 1) {
+        free(component);
+        return (count < 0) ? -1 : 0;
+    }
+
+    int *sizes = (int *)calloc(count, sizeof(int));
+    if (sizes == NULL || reserve_handles(work, count) != 0) {
+        free(sizes);
+        free(component);
+        return -1;
+    }
+    for (int m = 0; m < k; m++) sizes[component[m]]++;
+
+    int first = work->num_handles;
+    for (int p = 0; p < count; p++) {
+        if (new_handle(work, sizes[p]) < 0) {
+            free(sizes);
+            free(component);
+            return -1;
+        }
+    }
+    for (int m = 0; m < k; m++) {
+        t_work_class *piece = &work->classes[first + component[m]];
+        piece->members[piece->num_members++] = members[m];
+        work->v_data[members[m] - 1].class_id = first + component[m] + 1;
+    }
+    free(sizes);
+    free(component);
+
+    // La première CFC prend la position de h, les suivantes sont insérées juste après
+    int at = work->pos[h];
+    memmove(&work->order[at + count], &work->order[at + 1], (work->num_positions - at - 1) * sizeof(int));
+    for (int p = 0; p < count; p++) work->order[at + p] = first + p;
+    work->num_positions += count - 1;
+    for (int q = at; q < work->num_positions; q++) work->pos[work->order[q]] = q;
+
+    free(members);
+    work->classes[h].members = NULL;
+    work->classes[h].alive = 0;
+    stats->split_classes++;
+    return 0;
+}
+
+/*
+   merge_classes :
+   Réunit les count classes de list dans un nouveau handle, qui est retourné
+   (-1 si la mémoire manque).
+*/
+static int merge_classes(t_delta_work *work, const int *list, int count) {
+    int total = 0;
+    for (int i = 0; i < count; i++) total += work->classes[list[i]].num_members;
+
+    if (reserve_handles(work, 1) != 0) return -1;
+    int merged = new_handle(work, total);
+    if (merged < 0) return -1;
+
+    t_work_class *target = &work->classes[merged];
+    for (int i = 0; i < count; i++) {
+        t_work_class *source = &work->classes[list[i]];
+        for (int m = 0; m < source->num_members; m++) {
+            target->members[target->num_members++] = source->members[m];
+            work->v_data[source->members[m] - 1].class_id = merged + 1;
+        }
+        free(source->members);
+        source->members = NULL;
+        source->alive = 0;
+    }
+    return merged;
+}
+
+//Arcs entre classes relevés pendant un parcours (indices dans le parcours), capacité doublée au besoin.
+typedef struct s_arc_list {
+    int *pairs;      // source, destination, source, destination...
+    int count;
+    int capacity;
+} t_arc_list;
+
+static int push_arc(t_arc_list *arcs, int source, int destination) {
+    if (arcs->count == arcs->capacity) {
+        int new_capacity = (arcs->capacity > 0) ? 2 * arcs->capacity : 64;
+        int *pairs = (int *)realloc(arcs->pairs, 2 * (size_t)new_capacity * sizeof(int));
+        if (pairs == NULL) {
+            perror("Realloc failed for delta arcs");
+            return -1;
+        }
+        arcs->pairs = pairs;
+        arcs->capacity = new_capacity;
+    }
+    arcs->pairs[2 * arcs->count] = source;
+    arcs->pairs[2 * arcs->count + 1] = destination;
+    arcs->count++;
+    return 0;
+}
+
+/*
+   mark_reaching :
+   reaching[i] = 1 si la i-ème classe du parcours atteint la classe target :
+   parcours en largeur sur les arcs retournés (rangés par destination).
+*/
+static int mark_reaching(const t_arc_list *arcs, int count, int target, int *reaching) {
+    int *start = (int *)calloc(count + 1, sizeof(int));
+    int *sources = (int *)malloc((arcs->count > 0 ? arcs->count : 1) * sizeof(int));
+    int *queue = (int *)malloc(count * sizeof(int));
+    if (start == NULL || sources == NULL || queue == NULL) {
+        perror("Allocation failed for delta reverse search");
+        free(start);
+        free(sources);
+        free(queue);
+        return -1;
+    }
+
+    for (int i = 0; i < arcs->count; i++) start[arcs->pairs[2 * i + 1] + 1]++;
+    for (int i = 0; i < count; i++) start[i + 1] += start[i];
+    for (int i = 0; i < arcs->count; i++) {
+        int destination = arcs->pairs[2 * i + 1];
+        sources[start[destination]++] = arcs->pairs[2 * i];
+    }
+    // start[i] pointe maintenant sur la fin des sources de i : on le ramène au début
+    for (int i = count; i > 0; i--) start[i] = start[i - 1];
+    start[0] = 0;
+
+    int head = 0, tail = 0;
+    reaching[target] = 1;
+    queue[tail++] = target;
+    while (head < tail) {
+        int y = queue[head++];
+        for (int e = start[y]; e < start[y + 1]; e++) {
+            int x = sources[e];
+            if (!reaching[x]) {
+                reaching[x] = 1;
+                queue[tail++] = x;
+            }
+        }
+    }
+
+    free(start);
+    free(sources);
+    free(queue);
+    return 0;
+}
+
+/*
+   reorder_for_edge :
+   Ajout d'une arête de la classe a vers la classe b placée après elle
+   (pos[b] > pos[a]) : l'ordre des identifiants n'est plus respecté. Seule la
+   fenêtre de positions [pos[a], pos[b]] est concernée (Pearce et Kelly) :
+   - F : classes atteintes depuis b sans sortir de la fenêtre ;
+   - si a est dans F, l'arête ferme un cycle : les classes de F qui atteignent a
+     (M) sont fusionnées ;
+   - la fenêtre est réécrite : F \ M, puis la classe fusionnée, puis le reste,
+     chaque groupe dans son ordre d'origine. F est fermée vers l'avant dans la
+     fenêtre, donc aucune arête déjà dans l'ordre n'en sort.
+   Coût : taille de la fenêtre plus arêtes des sommets de F.
+*/
+static int reorder_for_edge(t_delta_work *work, int a, int b, t_delta_stats *stats) {
+    int lo = work->pos[a], hi = work->pos[b];
+    int window = hi - lo + 1;
+    int stamp = ++work->stamp;
+
+    int *forward = (int *)malloc(window * sizeof(int));
+    int *reaching = (int *)calloc(window, sizeof(int));
+    int *sequence = (int *)malloc(window * sizeof(int));
+    t_arc_list arcs = {NULL, 0, 0};
+    if (forward == NULL || reaching == NULL || sequence == NULL) {
+        perror("Allocation failed for delta reordering");
+        free(forward);
+        free(reaching);
+        free(sequence);
+        return -1;
+    }
+
+    int num_forward = 0, result = 0;
+    work->mark[b] = stamp;
+    work->slot[b] = 0;
+    forward[num_forward++] = b;
+    for (int q = 0; q < num_forward && result == 0; q++) {
+        t_work_class *c = &work->classes[forward[q]];
+        for (int m = 0; m < c->num_members && result == 0; m++) {
+            for (t_edge *e = work->graph.adj_lists[c->members[m] - 1].head; e != NULL; e = e->next) {
+                int y = handle_of(work, e->destination);
+                if (y == forward[q] || work->pos[y] < lo || work->pos[y] > hi) continue;
+                if (work->mark[y] != stamp) {
+                    work->mark[y] = stamp;
+                    work->slot[y] = num_forward;
+                    forward[num_forward++] = y;
+                }
+                if (push_arc(&arcs, q, work->slot[y]) != 0) {
+                    result = -1;
+                    break;
+                }
+            }
+        }
+    }
+
+    int cycle = (result == 0 && work->mark[a] == stamp);
+    if (cycle) result = mark_reaching(&arcs, num_forward, work->slot[a], reaching);
+
+    if (result == 0) {
+        int n = 0, num_merged = 0;
+        for (int p = lo; p <= hi; p++) {
+            int h = work->order[p];
+            if (work->mark[h] == stamp && !reaching[work->slot[h]]) sequence[n++] = h;
+        }
+        if (cycle) {
+            // forward est compacté sur M (indices croissants : la compaction sur place est sûre)
+            for (int i = 0; i < num_forward; i++) {
+                if (reaching[i]) forward[num_merged++] = forward[i];
+            }
+            int merged = merge_classes(work, forward, num_merged);
+            if (merged < 0) {
+                result = -1;
+            } else {
+                sequence[n++] = merged;
+                // Les classes fusionnées gardent une position (ignorée à la renumérotation)
+                for (int i = 1; i < num_merged; i++) sequence[n++] = forward[i];
+                stats->merged_classes++;
+            }
+        }
+        if (result == 0) {
+            for (int p = lo; p <= hi; p++) {
+                int h = work->order[p];
+                if (work->mark[h] != stamp) sequence[n++] = h;
+            }
+            for (int i = 0; i < n; i++) {
+                if (work->order[lo + i] != sequence[i] && work->classes[sequence[i]].alive) stats->reordered_classes++;
+                work->order[lo + i] = sequence[i];
+                work->pos[sequence[i]] = lo + i;
+            }
+        }
+    }
+
+    free(forward);
+    free(reaching);
+    free(sequence);
+    free(arcs.pairs);
+    return result;
+}
+
+/*
+   update_classes :
+   Retraits internes d'abord (coupures, sur le graphe final), puis ajouts entre
+   classes dans l'ordre du delta. Enfin persistance des classes modifiées :
+   persistante si aucune arête de ses membres ne la quitte.
+*/
+static int update_classes(t_delta_work *work, const t_delta *delta, t_delta_stats *stats) {
+    for (int i = 0; i < delta->num_ops; i++) {
+        t_delta_op op = delta->ops[i];
+        if (op.kind != DELTA_REMOVE) continue;
+        int h = handle_of(work, op.from);
+        // Une classe déjà recoupée (origin = -1) est faite de CFC du graphe final
+        if (h != handle_of(work, op.to) || work->classes[h].origin < 0) continue;
+        if (split_class(work, h, stats) != 0) return -1;
+    }
+
+    for (int i = 0; i < delta->num_ops; i++) {
+        t_delta_op op = delta->ops[i];
+        if (op.kind != DELTA_ADD) continue;
+        int a = handle_of(work, op.from);
+        int b = handle_of(work, op.to);
+        if (a == b || work->pos[b] < work->pos[a]) continue;
+        if (reorder_for_edge(work, a, b, stats) != 0) return -1;
+    }
+
+    for (int h = 0; h < work->num_handles; h++) {
+        t_work_class *c = &work->classes[h];
+        if (!c->alive || !c->changed) continue;
+        c->is_persistent = 1;
+        for (int m = 0; m < c->num_members && c->is_persistent; m++) {
+            for (t_edge *e = work->graph.adj_lists[c->members[m] - 1].head; e != NULL; e = e->next) {
+                if (handle_of(work, e->destination) != h) {
+                    c->is_persistent = 0;
+                    break;
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+/*
+   build_partition :
+   Renumérote les classes vivantes dans l'ordre des positions (identifiants 1..C)
+   et remplace les classes de la partition. origin et changed (C cases, alloués
+   ici) gardent, par nouvelle classe, l'indice d'origine et l'indicateur de recalcul.
+*/
+static int build_partition(t_delta_work *work, t_partition *partition, int **origin, int **changed) {
+    int num_classes = 0;
+    for (int p = 0; p < work->num_positions; p++) num_classes += work->classes[work->order[p]].alive;
+
+    t_class *classes = (t_class *)malloc(num_classes * sizeof(t_class));
+    int *new_id = (int *)malloc(work->num_handles * sizeof(int));
+    *origin = (int *)malloc(num_classes * sizeof(int));
+    *changed = (int *)malloc(num_classes * sizeof(int));
+    if (classes == NULL || new_id == NULL || *origin == NULL || *changed == NULL) {
+        perror("Allocation failed for delta partition");
+        free(classes);
+        free(new_id);
+        free(*origin);
+        free(*changed);
+        *origin = *changed = NULL;
+        return -1;
+    }
+
+    int id = 0;
+    for (int p = 0; p < work->num_positions; p++) {
+        int h = work->order[p];
+        t_work_class *c = &work->classes[h];
+        if (!c->alive) continue;
+        new_id[h] = ++id;
+        classes[id - 1] = (t_class){id, c->num_members, c->members, c->is_persistent};
+        (*origin)[id - 1] = c->origin;
+        (*changed)[id - 1] = c->changed;
+        c->alive = 0; // Les membres appartiennent maintenant à la partition
+    }
+    for (int v = 0; v < work->graph.num_vertices; v++) {
+        partition->v_data[v].class_id = new_id[partition->v_data[v].class_id - 1];
+    }
+
+    free(new_id);
+    free(partition->classes);
+    partition->classes = classes;
+    partition->num_classes = num_classes;
+    return 0;
+}
+
+/*
+   patch_csr :
+   Nouvelle matrice creuse : les lignes des sommets modifiés (touched, croissants)
+   sont relues dans la liste d'adjacence, les autres recopiées par blocs.
+   Retourne une matrice vide (row_ptr = NULL) si la mémoire manque.
+*/
+static t_csr patch_csr(const t_csr *old, t_graph graph, const int *touched, int num_touched) {
+    int N = old->num_vertices;
+    t_csr csr = {N, 0, (int *)malloc((N + 1) * sizeof(int)), NULL, NULL};
+    if (csr.row_ptr == NULL) {
+        perror("Allocation failed for CSR row_ptr");
+        return (t_csr){0, 0, NULL, NULL, NULL};
+    }
+
+    csr.row_ptr[0] = 0;
+    for (int i = 0, t = 0; i < N; i++) {
+        int degree;
+        if (t < num_touched && touched[t] == i) {
+            degree = 0;
+            for (t_edge *e = graph.adj_lists[i].head; e != NULL; e = e->next) degree++;
+            t++;
+        } else {
+            degree = old->row_ptr[i + 1] - old->row_ptr[i];
+        }
+        csr.row_ptr[i + 1] = csr.row_ptr[i] + degree;
+    }
+    csr.num_edges = csr.row_ptr[N];
+
+    csr.col_idx = (int *)malloc((csr.num_edges > 0 ? csr.num_edges : 1) * sizeof(int));
+    csr.values = (float *)malloc((csr.num_edges > 0 ? csr.num_edges : 1) * sizeof(float));
+    if (csr.col_idx == NULL || csr.values == NULL) {
+        perror("Allocation failed for CSR edges");
+        free_csr(csr);
+        return (t_csr){0, 0, NULL, NULL, NULL};
+    }
+
+    int previous = 0; // Premier sommet du bloc de lignes inchangées en cours
+    for (int t = 0; t <= num_touched; t++) {
+        int row = (t < num_touched) ? touched[t] : N;
+        int count = old->row_ptr[row] - old->row_ptr[previous];
+        memcpy(&csr.col_idx[csr.row_ptr[previous]], &old->col_idx[old->row_ptr[previous]], count * sizeof(int));
+        memcpy(&csr.values[csr.row_ptr[previous]], &old->values[old->row_ptr[previous]], count * sizeof(float));
+        if (row == N) break;
+
+        int pos = csr.row_ptr[row];
+        for (t_edge *e = graph.adj_lists[row].head; e != NULL; e = e->next) {
+            csr.col_idx[pos] = e->destination - 1;
+            csr.values[pos] = e->probability;
+            pos++;
+        }
+        previous = row + 1;
+    }
+    return csr;
+}
+
+/*
+   update_results :
+   Résultats de markov_solve pour la nouvelle partition, en reprenant ceux des
+   classes inchangées (origin, changed : voir build_partition) :
+   - classe persistante modifiée : distribution stationnaire à chaud et période ;
+   - probabilités d'absorption : nouvelle disposition (absorption_layout), les
+     colonnes d'une classe persistante inchangée reprenant ses anciennes valeurs ;
+   - classe transitoire : recalculée (à chaud) si elle a changé, si une classe
+     qu'elle atteint directement a été recalculée ou si les anciennes valeurs n'étaient
+     pas gardées, recopiée sinon. Les classes sont parcourues par identifiant
+     croissant : leurs successeurs sont déjà à jour.
+*/
+static t_markov_status update_results(t_markov_ctx *ctx, const int *origin, const int *changed, t_delta_stats *stats) {
+    t_partition partition = ctx->partition;
+    const t_absorption *old = &ctx->absorb;
+    int N = ctx->num_vertices;
+    int C = partition.num_classes;
+    int old_C = old->num_classes;
+
+    int *persistent_index = (int *)malloc(C * sizeof(int));
+    int *periods = (int *)calloc(C, sizeof(int));
+    int *recomputed = (int *)calloc(C, sizeof(int));
+    int *slot = (int *)malloc(C * sizeof(int));                          // Position de chaque colonne dans la classe en cours
+    int *renum = (int *)malloc((old_C > 0 ? old_C : 1) * sizeof(int));   // Nouvelle classe de chaque ancienne colonne, -1 si modifiée
+    double *acc = (double *)malloc((C > 0 ? C : 1) * sizeof(double));
+    double *work = (double *)malloc(N * sizeof(double));
+    if (persistent_index == NULL || periods == NULL || recomputed == NULL || slot == NULL || renum == NULL || acc == NULL
+        || work == NULL) {
+        perror("Allocation failed for delta results");
+        free(persistent_index);
+        free(periods);
+        free(recomputed);
+        free(slot);
+        free(renum);
+        free(acc);
+        free(work);
+        return MARKOV_ERR_NOMEM;
+    }
+
+    int K = 0;
+    for (int i = 0; i < old_C; i++) renum[i] = -1;
+    for (int i = 0; i < C; i++) {
+        slot[i] = -1;
+        persistent_index[i] = partition.classes[i].is_persistent ? K++ : -1;
+        if (persistent_index[i] >= 0 && !changed[i]) renum[origin[i]] = i;
+    }
+
+    // Une ancienne distribution non convergée (num_unconverged) n'est pas reprise telle quelle : toutes les classes
+    // persistantes repartent à chaud, celles qui avaient convergé s'arrêtant dès la première itération
+    t_markov_status status = MARKOV_OK;
+    int unconverged = 0;
+    profile_begin(ctx->profiler, "delta_stationary");
+    for (int i = 0; i < C && status == MARKOV_OK; i++) {
+        t_class c = partition.classes[i];
+        if (!changed[i]) {
+            periods[i] = ctx->periods[origin[i]];
+            if (!c.is_persistent || ctx->num_unconverged == 0) continue;
+        } else if (!c.is_persistent) {
+            for (int m = 0; m < c.num_members; m++) ctx->stationary[c.members_ids[m] - 1] = 0.0;
+            continue;
+        }
+        int converged = 1;
+        if (class_stationary_distribution_warm(&ctx->P, partition, i, ctx->stationary, MARKOV_STATIONARY_EPSILON,
+                                               MARKOV_STATIONARY_MAX_ITER, work, &converged) < 0) {
+            status = MARKOV_ERR_NOMEM;
+            break;
+        }
+        unconverged += !converged;
+        if (!changed[i]) continue;
+        periods[i] = class_period_sparse(&ctx->P, partition, i);
+        if (periods[i] < 0) status = MARKOV_ERR_NOMEM;
+        stats->stationary_solved++;
+    }
+    profile_end(ctx->profiler);
+    free(work);
+
+    t_absorption A = {0};
+    int layout = 1;
+    if (status == MARKOV_OK) layout = absorption_layout(&ctx->P, partition, MARKOV_ABSORPTION_MAX_VALUES, &A);
+    if (layout < 0) status = MARKOV_ERR_NOMEM;
+
+    profile_begin(ctx->profiler, "delta_absorption");
+    for (int i = 0; i < C && status == MARKOV_OK && layout == 0; i++) {
+        t_class c = partition.classes[i];
+
+        if (c.is_persistent) {
+            recomputed[i] = changed[i];
+            for (int m = 0; m < c.num_members; m++) A.values[A.row_start[c.members_ids[m] - 1]] = 1.0;
+            continue;
+        }
+
+        int dirty = changed[i] || old->values == NULL;
+        for (int m = 0; m < c.num_members && !dirty; m++) {
+            int u = c.members_ids[m] - 1;
+            for (int e = ctx->P.row_ptr[u]; e < ctx->P.row_ptr[u + 1]; e++) {
+                int target = partition.v_data[ctx->P.col_idx[e]].class_id - 1;
+                if (target != i && recomputed[target]) {
+                    dirty = 1;
+                    break;
+                }
+            }
+        }
+
+        // Point de départ : les anciennes probabilités de la classe, si elle existait déjà
+        int o = origin[i];
+        if (old->values != NULL && o >= 0) {
+            for (long long q = A.class_ptr[i]; q < A.class_ptr[i + 1]; q++) slot[A.columns[q]] = (int)(q - A.class_ptr[i]);
+            for (int m = 0; m < c.num_members; m++) {
+                int v = c.members_ids[m] - 1;
+                for (long long q = old->class_ptr[o]; q < old->class_ptr[o + 1]; q++) {
+                    int target = renum[old->columns[q]];
+                    if (target < 0 || slot[target] < 0) continue;
+                    A.values[A.row_start[v] + slot[target]] = old->values[old->row_start[v] + (q - old->class_ptr[o])];
+                }
+            }
+            for (long long q = A.class_ptr[i]; q < A.class_ptr[i + 1]; q++) slot[A.columns[q]] = -1;
+        }
+        if (dirty) {
+            class_absorption(&ctx->P, partition, i, &A, slot, acc);
+            stats->absorption_solved++;
+        }
+        recomputed[i] = dirty;
+    }
+    profile_end(ctx->profiler);
+
+    free(recomputed);
+    free(slot);
+    free(renum);
+    free(acc);
+    if (status != MARKOV_OK) {
+        absorption_free(&A);
+        free(persistent_index);
+        free(periods);
+        return status;
+    }
+
+    absorption_free(&ctx->absorb);
+    ctx->absorb = A;
+    free(ctx->persistent_index);
+    free(ctx->periods);
+    ctx->persistent_index = persistent_index;
+    ctx->periods = periods;
+    ctx->num_persistent = K;
+    ctx->num_unconverged = unconverged;
+    return MARKOV_OK;
+}
+
+/*
+   drop_results :
+   Après une erreur de mémoire en cours de mise à jour, le graphe est déjà modifié
+   mais les résultats ne lui correspondent plus : ils sont libérés et le contexte
+   revient à l'étape vérifiée.
+*/
+static void drop_results(t_markov_ctx *ctx) {
+    free_csr(ctx->P);
+    free_csr(ctx->PT);
+    free_partition(ctx->partition);
+    free_link_array(ctx->hasse_links);
+    reach_free(&ctx->reach);
+    free(ctx->persistent_index);
+    free(ctx->periods);
+    free(ctx->stationary);
+    absorption_free(&ctx->absorb);
+    ctx->P = (t_csr){0, 0, NULL, NULL, NULL};
+    ctx->PT = (t_csr){0, 0, NULL, NULL, NULL};
+    ctx->partition = (t_partition){NULL, 0, NULL};
+    ctx->hasse_links = NULL;
+    ctx->persistent_index = NULL;
+    ctx->periods = NULL;
+    ctx->stationary = NULL;
+    ctx->num_persistent = 0;
+    ctx->num_unconverged = 0;
+    ctx->stages_done = MARKOV_STAGE_LOADED | MARKOV_STAGE_CHECKED;
+}
+
+/*
+   markov_apply_delta :
+   Enchaîne validation, modification du graphe, mise à jour des classes, de la
+   matrice creuse, des liens de Hasse (recalculés seulement si la structure des
+   classes ou une arête entre classes a changé) et des résultats. L'index
+   d'accessibilité, s'il avait été construit, l'est de nouveau : les classes ont pu
+   être renumérotées.
+*/
+t_markov_status markov_apply_delta(t_markov_ctx *ctx, const t_delta *delta, t_delta_stats *stats) {
+    t_delta_stats local_stats;
+    if (stats == NULL) stats = &local_stats;
+    memset(stats, 0, sizeof(*stats));
+
+    if (ctx == NULL || delta == NULL) return MARKOV_ERR_ARGUMENT;
+    if (!(ctx->stages_done & MARKOV_STAGE_SOLVED) || ctx->graph.adj_lists == NULL) return MARKOV_ERR_STATE;
+
+    stats->num_ops = delta->num_ops;
+    stats->classes_before = stats->classes_after = ctx->partition.num_classes;
+    if (delta->num_ops == 0) return MARKOV_OK;
+
+    // 1. Validation puis modification du graphe (le contexte reste inchangé en cas d'erreur)
+    int *touched = NULL, num_touched = 0;
+    profile_begin(ctx->profiler, "delta_validate");
+    t_markov_status status = validate_delta(ctx, delta, &touched, &num_touched);
+    profile_end(ctx->profiler);
+    if (status != MARKOV_OK) return status;
+
+    int links_changed = 0;
+    for (int i = 0; i < delta->num_ops; i++) {
+        t_delta_op op = delta->ops[i];
+        if (op.kind != DELTA_REWEIGHT && ctx->partition.v_data[op.from - 1].class_id != ctx->partition.v_data[op.to - 1].class_id) {
+            links_changed = 1;
+        }
+    }
+
+    status = apply_to_graph(ctx->graph, delta);
+    if (status != MARKOV_OK) {
+        free(touched);
+        return status;
+    }
+    stats->touched_vertices = num_touched;
+
+    // 2. Classes : seules les classes des sommets modifiés et la région qu'ils relient sont revues
+    t_delta_work work;
+    int *origin = NULL, *changed = NULL;
+    profile_begin(ctx->profiler, "delta_classes");
+    int failed = init_work(&work, ctx);
+    for (int t = 0; t < num_touched && !failed; t++) work.classes[handle_of(&work, touched[t] + 1)].changed = 1;
+    if (!failed) failed = update_classes(&work, delta, stats);
+    if (!failed) failed = build_partition(&work, &ctx->partition, &origin, &changed);
+    free_work(&work);
+    profile_end(ctx->profiler);
+    if (failed) {
+        free(touched);
+        drop_results(ctx);
+        return MARKOV_ERR_NOMEM;
+    }
+    stats->classes_after = ctx->partition.num_classes;
+    for (int i = 0; i < ctx->partition.num_classes; i++) stats->changed_classes += changed[i];
+    int structure_changed = (stats->split_classes > 0 || stats->merged_classes > 0);
+
+    // 3. Matrice creuse et liens de Hasse
+    profile_begin(ctx->profiler, "delta_csr");
+    t_csr P = patch_csr(&ctx->P, ctx->graph, touched, num_touched);
+    profile_end(ctx->profiler);
+    free(touched);
+    free_csr(ctx->P);
+    ctx->P = P;
+    int built = (P.row_ptr != NULL && markov_build_in_edges(ctx) == MARKOV_OK);
+
+    if (built && (structure_changed || links_changed)) {
+        profile_begin(ctx->profiler, "compute_hasse_diagram_links");
+        free_link_array(ctx->hasse_links);
+        ctx->hasse_links = compute_hasse_diagram_links(ctx->graph, ctx->partition);
+        profile_end(ctx->profiler);
+        stats->hasse_rebuilt = 1;
+    }
+
+    // 4. Résultats des classes modifiées et de celles qui en dépendent
+    status = MARKOV_ERR_NOMEM;
+    if (built && ctx->hasse_links != NULL) status = update_results(ctx, origin, changed, stats);
+    free(origin);
+    free(changed);
+    if (status == MARKOV_OK && ctx->reach.post != NULL) status = markov_build_reach(ctx);
+    if (status != MARKOV_OK) drop_results(ctx);
+    return status;
+}
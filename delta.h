@@ -0,0 +1,72 @@
+#ifndef DELTA_H
+#define DELTA_H
+
+#include "markov.h"
+
+/*
+   Mise à jour incrémentale d'une chaîne déjà analysée (markov_analyze).
+   Un fichier delta liste des transitions ajoutées, retirées ou repondérées,
+   une par ligne (lignes vides et commentaires '#' ignorés) :
+       + départ arrivée probabilité   ajoute une transition absente
+       - départ arrivée               retire une transition
+       = départ arrivée probabilité   change la probabilité d'une transition
+   Le nombre de sommets ne change pas, et chaque sommet modifié doit toujours
+   vérifier la propriété de Markov une fois toutes les lignes appliquées.
+*/
+
+//Nature d'une modification.
+typedef enum e_delta_kind {
+    DELTA_ADD = 0,
+    DELTA_REMOVE,
+    DELTA_REWEIGHT
+} t_delta_kind;
+
+//Une modification de transition (sommets numérotés de 1 à N).
+typedef struct s_delta_op {
+    t_delta_kind kind;
+    int from;
+    int to;
+    float probability;     // Ignorée pour DELTA_REMOVE
+} t_delta_op;
+
+//Liste de modifications, appliquées ensemble.
+typedef struct s_delta {
+    t_delta_op *ops;
+    int num_ops;
+    int capacity;
+} t_delta;
+
+//Ce que markov_apply_delta a recalculé : tout le reste est repris de l'analyse précédente.
+typedef struct s_delta_stats {
+    int num_ops;
+    int touched_vertices;      // Sommets dont les transitions sortantes ont changé
+    int classes_before;
+    int classes_after;
+    int split_classes;         // Classes recoupées par Tarjan local après des retraits
+    int merged_classes;        // Classes créées par fusion (un ajout a fermé un cycle)
+    int reordered_classes;     // Classes déplacées pour garder l'ordre des identifiants (successeurs d'abord)
+    int changed_classes;       // Classes dont les résultats ont été recalculés
+    int stationary_solved;     // Distributions stationnaires recalculées (départ à chaud)
+    int absorption_solved;     // Classes transitoires dont les probabilités d'absorption ont été recalculées
+    int hasse_rebuilt;         // 1 si les liens de Hasse ont été recalculés
+} t_delta_stats;
+
+//Initialise une liste vide.
+void delta_init(t_delta *delta);
+
+//Libère la liste (qui redevient vide).
+void free_delta(t_delta *delta);
+
+//Ajoute une modification en fin de liste. Retourne MARKOV_ERR_NOMEM si la mémoire manque.
+t_markov_status delta_add(t_delta *delta, t_delta_kind kind, int from, int to, float probability);
+
+//Lit un fichier delta (format ci-dessus). Retourne MARKOV_ERR_FORMAT pour une ligne mal formée.
+t_markov_status delta_load_file(const char *path, t_delta *delta);
+
+//Applique les modifications à une chaîne analysée (markov_solve exécuté, graphe non libéré) et met ses résultats à jour
+//en ne recalculant que la région touchée. Tout est vérifié avant de modifier le graphe : en cas d'erreur de format ou
+//de propriété de Markov, le contexte est inchangé. Si la mémoire manque ensuite, les résultats sont libérés et le
+//contexte revient à l'étape vérifiée (markov_analyze_classes puis markov_solve les recalculent). stats peut valoir NULL.
+t_markov_status markov_apply_delta(t_markov_ctx *ctx, const t_delta *delta, t_delta_stats *stats);
+
+#endif // DELTA_H
@@ -0,0 +1,764 @@
+/*
+   generate.c : programme markov_gen.
+   Écrit une chaîne de Markov synthétique au format data/ (graine fixe, donc
+   reproductible), éventuellement avec sa partition attendue, et peut relire la
+   chaîne produite avec libmarkov pour vérifier que l'analyse retrouve bien les
+   classes, leur persistance et leur période. Avec --self-check, compare les
+   estimations locales (local_push.h) aux résultats de markov_analyze sur les
+   chaînes d'un dossier et sur des chaînes générées, la mise à jour incrémentale
+   (delta.h) et la relecture du cache (cache.h) à une analyse complète, ainsi que
+   le moteur des petites chaînes (small_chain.h) sur des chaînes aléatoires de 1 à
+   16 états.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include <unistd.h>
+
+#include "generator.h"
+#include "markov.h"
+#include "batch.h"
+#include "local_push.h"
+#include "sparse.h"
+#include "small_chain.h"
+#include "delta.h"
+#include "cache.h"
+
+//Seuil des poussées de --self-check, et écart toléré entre une estimation locale et markov_analyze.
+#define CHECK_PUSH_EPSILON 1e-9
+#define CHECK_TOLERANCE 1e-3
+
+//Chaînes générées par --self-check : N et degré de chaque famille.
+#define CHECK_GEN_VERTICES 40
+#define CHECK_GEN_DEGREE 3
+
+//Petites chaînes aléatoires de --self-check : nombre par taille (1..SMALL_CHAIN_MAX_STATES) et degré sortant maximal.
+#define CHECK_SMALL_PER_SIZE 64
+#define CHECK_SMALL_MAX_DEGREE 3
+
+//Sommets modifiés par le delta de --self-check sur chaque chaîne générée.
+#define CHECK_DELTA_VERTICES 4
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+static void print_usage(const char *program_name) {
+    printf("Usage : %s --family F --vertices N [options]\n", program_name);
+    printf("  --family F          random, banded, absorbing, periodic, powerlaw\n");
+    printf("  --vertices N        Nombre de sommets\n");
+    printf("  --degree D          Degre sortant (degre minimal pour powerlaw, defaut 4)\n");
+    printf("  --bandwidth B       banded : demi-largeur de bande (defaut (D-1)/2)\n");
+    printf("  --block-size S      absorbing : taille des classes transitoires (defaut 8)\n");
+    printf("  --absorbing A       absorbing : nombre de classes absorbantes (defaut N/64)\n");
+    printf("  --absorbing-size K  absorbing : taille des classes absorbantes (defaut 1)\n");
+    printf("  --period P          periodic : periode (defaut 4)\n");
+    printf("  --exponent X        powerlaw : exposant (defaut 2.5)\n");
+    printf("  --max-degree M      powerlaw : degre maximal (defaut 1000)\n");
+    printf("  --seed S            Graine (defaut 1)\n");
+    printf("  --threads T         Threads d'ecriture (defaut : un par coeur)\n");
+    printf("  --output FICHIER    Chaine generee (defaut : sortie standard)\n");
+    printf("  --expected FICHIER  Partition attendue (une ligne par sommet)\n");
+    printf("  --verify            Relit la chaine avec libmarkov et compare a la partition attendue\n");
+    printf("  --self-check [DOS]  Compare les estimations locales a markov_analyze sur les chaines du dossier DOS\n");
+    printf("                      (defaut data) et sur des chaines generees depuis --seed, verifie small_batch_solve\n");
+    printf("                      sur des chaines aleatoires de 1 a 16 etats, markov_apply_delta et le cache sur les\n");
+    printf("                      chaines generees, puis quitte\n");
+}
+
+/*
+   verify_chain :
+   Analyse le fichier produit et compare, pour chaque sommet, le plus petit
+   sommet de sa classe, la persistance et la période. Retourne le nombre de
+   sommets en désaccord (-1 si l'analyse échoue).
+*/
+static int verify_chain(const t_gen_params *params, const char *path) {
+    t_markov_ctx ctx;
+    markov_init(&ctx);
+
+    t_markov_status status = markov_load_file(&ctx, path);
+    if (status == MARKOV_OK) status = markov_analyze(&ctx);
+    if (status != MARKOV_OK) {
+        fprintf(stderr, "Verification impossible : %s\n", markov_status_string(status));
+        markov_free(&ctx);
+        return -1;
+    }
+
+    int num_classes = ctx.partition.num_classes;
+    int *representative = (int *)malloc(num_classes * sizeof(int));
+    if (representative == NULL) {
+        markov_free(&ctx);
+        return -1;
+    }
+    for (int c = 0; c < num_classes; c++) {
+        t_class class = ctx.partition.classes[c];
+        representative[c] = class.members_ids[0];
+        for (int m = 1; m < class.num_members; m++) {
+            if (class.members_ids[m] < representative[c]) representative[c] = class.members_ids[m];
+        }
+    }
+
+    int mismatches = 0;
+    for (int v = 0; v < ctx.num_vertices; v++) {
+        int c = ctx.partition.v_data[v].class_id - 1;
+        t_gen_expected expected = gen_expected_class(params, v);
+        if (representative[c] != expected.representative
+            || ctx.partition.classes[c].is_persistent != expected.is_persistent
+            || ctx.periods[c] != expected.period) {
+            if (mismatches < 10) {
+                fprintf(stderr, "Sommet %d : classe %d persistante %d periode %d, attendu %d %d %d\n",
+                        v + 1, representative[c], ctx.partition.classes[c].is_persistent, ctx.periods[c],
+                        expected.representative, expected.is_persistent, expected.period);
+            }
+            mismatches++;
+        }
+    }
+
+    fprintf(stderr, "Verification : %d classes trouvees (%d attendues), %d sommet(s) en desaccord\n",
+            num_classes, gen_expected_num_classes(params), mismatches);
+    free(representative);
+    markov_free(&ctx);
+    return mismatches;
+}
+
+/*
+   check_value :
+   Compare une estimation locale à la valeur exacte : la valeur doit être dans
+   l'encadrement et l'estimation à CHECK_TOLERANCE près. Retourne 1 en cas d'écart.
+*/
+static int check_value(const char *name, const char *what, int v, const t_push_result *result, double exact) {
+    if (exact >= result->lower - CHECK_TOLERANCE && exact <= result->upper + CHECK_TOLERANCE
+        && fabs(result->estimate - exact) <= CHECK_TOLERANCE && result->converged) {
+        return 0;
+    }
+    fprintf(stderr, "%s : %s(%d) = %.9g, poussee %.9g dans [%.9g, %.9g]%s\n", name, what, v, exact, result->estimate,
+            result->lower, result->upper, result->converged ? "" : " (budget epuise)");
+    return 1;
+}
+
+/*
+   check_backward :
+   Probabilités d'absorption par chaque classe persistante depuis tous les états à la
+   fois, par push_hitting_backward sur la transposée de ctx->P. Retourne le nombre
+   d'écarts.
+*/
+static int check_backward(const t_markov_ctx *ctx, const char *name) {
+    const t_partition *partition = &ctx->partition;
+    int N = ctx->num_vertices;
+    t_csr PT = csr_transpose(&ctx->P);
+    int *sources = (int *)malloc(N * sizeof(int));
+    t_push_result *results = (t_push_result *)malloc(N * sizeof(t_push_result));
+    if (PT.row_ptr == NULL || sources == NULL || results == NULL) {
+        free_csr(PT);
+        free(sources);
+        free(results);
+        return 1;
+    }
+    for (int v = 0; v < N; v++) sources[v] = v + 1;
+
+    int errors = 0;
+    for (int c = 0; c < partition->num_classes; c++) {
+        const t_class *class = &partition->classes[c];
+        if (!class->is_persistent) continue;
+        if (push_hitting_backward(ctx->graph, &PT, class->members_ids, class->num_members, sources, N, CHECK_PUSH_EPSILON,
+                                  PUSH_DEFAULT_MAX_PUSHES, results) != MARKOV_OK) {
+            errors++;
+            break;
+        }
+        for (int v = 1; v <= N; v++) {
+            double exact;
+            if (markov_absorption(ctx, v, c + 1, &exact) != MARKOV_OK) {
+                errors++;
+                break;
+            }
+            errors += check_value(name, "absorption (arriere)", v, &results[v - 1], exact);
+        }
+    }
+    free_csr(PT);
+    free(sources);
+    free(results);
+    return errors;
+}
+
+/*
+   check_local_push :
+   Pour chaque état : pi(v) par push_stationary, et la probabilité d'être absorbé
+   par chaque classe persistante (cible : ses membres) par push_hitting_probability,
+   comparées à markov_stationary et markov_absorption ; puis les mêmes probabilités
+   d'absorption par poussée arrière (check_backward). Retourne le nombre d'écarts.
+*/
+static int check_local_push(const t_markov_ctx *ctx, const char *name) {
+    const t_partition *partition = &ctx->partition;
+    t_push_result result;
+    int errors = check_backward(ctx, name);
+
+    for (int v = 1; v <= ctx->num_vertices; v++) {
+        double exact;
+        if (push_stationary(ctx->graph, v, CHECK_PUSH_EPSILON, PUSH_DEFAULT_MAX_PUSHES, &result) != MARKOV_OK
+            || markov_stationary(ctx, v, &exact) != MARKOV_OK) {
+            return errors + 1;
+        }
+        errors += check_value(name, "pi", v, &result, exact);
+
+        for (int c = 0; c < partition->num_classes; c++) {
+            const t_class *class = &partition->classes[c];
+            if (!class->is_persistent) continue;
+            if (push_hitting_probability(ctx->graph, v, class->members_ids, class->num_members, CHECK_PUSH_EPSILON,
+                                         PUSH_DEFAULT_MAX_PUSHES, &result) != MARKOV_OK
+                || markov_absorption(ctx, v, c + 1, &exact) != MARKOV_OK) {
+                return errors + 1;
+            }
+            errors += check_value(name, "absorption", v, &result, exact);
+        }
+    }
+    return errors;
+}
+
+/*
+   generated_edges :
+   Arêtes de la chaîne générée, sommet par sommet (sommets numérotés de 1 à N), les
+   successeurs d'un sommet étant équiprobables. Les trois tableaux, à libérer par
+   l'appelant, ont N x degré maximal + CHECK_DELTA_VERTICES cases (place pour les
+   arêtes ajoutées par random_delta). Retourne le nombre d'arêtes, -1 si la mémoire
+   manque (tableaux alors libérés).
+*/
+static int generated_edges(const t_gen_params *params, int **from, int **to, float **proba) {
+    int N = params->num_vertices;
+    int max_degree = gen_max_out_degree(params);
+    size_t capacity = (size_t)N * max_degree + CHECK_DELTA_VERTICES;
+    *from = (int *)malloc(capacity * sizeof(int));
+    *to = (int *)malloc(capacity * sizeof(int));
+    *proba = (float *)malloc(capacity * sizeof(float));
+    int *destinations = (int *)malloc(max_degree * sizeof(int));
+    if (*from == NULL || *to == NULL || *proba == NULL || destinations == NULL) {
+        free(*from);
+        free(*to);
+        free(*proba);
+        free(destinations);
+        *from = *to = NULL;
+        *proba = NULL;
+        return -1;
+    }
+
+    int E = 0;
+    for (int v = 0; v < N; v++) {
+        int degree = gen_vertex_edges(params, v, destinations);
+        for (int k = 0; k < degree; k++, E++) {
+            (*from)[E] = v + 1;
+            (*to)[E] = destinations[k] + 1;
+            (*proba)[E] = 1.0f / degree;
+        }
+    }
+    free(destinations);
+    return E;
+}
+
+/*
+   load_generated :
+   Chaîne générée chargée par markov_load_edges, sans passer par un fichier.
+*/
+static t_markov_status load_generated(t_markov_ctx *ctx, const t_gen_params *params) {
+    int *from, *to;
+    float *proba;
+    int E = generated_edges(params, &from, &to, &proba);
+    if (E < 0) return MARKOV_ERR_NOMEM;
+
+    t_markov_status status = markov_load_edges(ctx, params->num_vertices, E, from, to, proba);
+    free(from);
+    free(to);
+    free(proba);
+    return status;
+}
+
+//Tirage xorshift64 suivant (graine non nulle).
+static uint64_t next_random(uint64_t *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+/*
+   small_random_chain :
+   Petite chaîne de n états tirée par xorshift64 : chaque état a 1 à
+   CHECK_SMALL_MAX_DEGREE successeurs distincts, équiprobables. Les degrés faibles
+   donnent des cycles (classes périodiques), des états transitoires et plusieurs
+   classes fermées. Retourne le nombre d'arêtes.
+*/
+static int small_random_chain(uint64_t *state, int n, int *from, int *to, float *proba) {
+    int E = 0;
+    for (int v = 0; v < n; v++) {
+        int degree = 1 + (int)(next_random(state) % CHECK_SMALL_MAX_DEGREE);
+        if (degree > n) degree = n;
+
+        uint32_t chosen = 0;
+        for (int k = 0; k < degree; k++) {
+            int w = (int)(next_random(state) % (uint64_t)n);
+            while (chosen >> w & 1u) w = (w + 1) % n;
+            chosen |= 1u << w;
+            from[E] = v + 1;
+            to[E] = w + 1;
+            proba[E++] = 1.0f / degree;
+        }
+    }
+    return E;
+}
+
+//Plus petit état de chaque classe : identifie une classe quelle que soit sa numérotation. rep a num_classes cases.
+static void class_representatives(const t_partition *partition, int *rep) {
+    for (int k = 0; k < partition->num_classes; k++) {
+        t_class class = partition->classes[k];
+        rep[k] = class.members_ids[0];
+        for (int m = 1; m < class.num_members; m++) {
+            if (class.members_ids[m] < rep[k]) rep[k] = class.members_ids[m];
+        }
+    }
+}
+
+/*
+   check_small_chains :
+   Pour chaque taille de 1 à SMALL_CHAIN_MAX_STATES, résout un lot de
+   CHECK_SMALL_PER_SIZE chaînes aléatoires avec small_batch_solve, puis analyse
+   chacune avec markov_analyze et compare, état par état, la classe (par son plus
+   petit état, la numérotation des classes pouvant différer), la période et la
+   distribution stationnaire. Retourne le nombre d'écarts.
+*/
+static int check_small_chains(uint64_t seed) {
+    int from[SMALL_CHAIN_MAX_STATES * CHECK_SMALL_MAX_DEGREE], to[SMALL_CHAIN_MAX_STATES * CHECK_SMALL_MAX_DEGREE];
+    float proba[SMALL_CHAIN_MAX_STATES * CHECK_SMALL_MAX_DEGREE];
+    int errors = 0, checked = 0;
+    double start = now_ms();
+
+    for (int n = 1; n <= SMALL_CHAIN_MAX_STATES; n++) {
+        t_small_batch batch;
+        if (small_batch_init(&batch, n, CHECK_SMALL_PER_SIZE) != 0) {
+            fprintf(stderr, "petites chaines : allocation impossible\n");
+            return errors + 1;
+        }
+        uint64_t state = (seed + (uint64_t)n) * 0x9E3779B97F4A7C15ULL + 1;
+        for (int c = 0; c < CHECK_SMALL_PER_SIZE; c++) {
+            int E = small_random_chain(&state, n, from, to, proba);
+            small_batch_add(&batch, E, from, to, proba);
+        }
+        small_batch_solve(&batch);
+
+        // Mêmes chaînes, retirées depuis la même graine
+        state = (seed + (uint64_t)n) * 0x9E3779B97F4A7C15ULL + 1;
+        for (int c = 0; c < CHECK_SMALL_PER_SIZE; c++) {
+            int E = small_random_chain(&state, n, from, to, proba);
+            t_markov_ctx ctx;
+            markov_init(&ctx);
+            t_markov_status status = markov_load_edges(&ctx, n, E, from, to, proba);
+            if (status == MARKOV_OK) status = markov_analyze(&ctx);
+            if (status != MARKOV_OK || !batch.valid[c]) {
+                fprintf(stderr, "petite chaine %d/%d : analyse %s, lot valide %d\n", n, c, markov_status_string(status),
+                        batch.valid[c]);
+                errors++;
+                markov_free(&ctx);
+                continue;
+            }
+
+            int small_rep[SMALL_CHAIN_MAX_STATES + 1], ref_rep[SMALL_CHAIN_MAX_STATES];
+            for (int k = 0; k <= n; k++) small_rep[k] = 0;
+            for (int v = n; v >= 1; v--) small_rep[batch.class_id[(v - 1) * batch.capacity + c]] = v;
+            class_representatives(&ctx.partition, ref_rep);
+
+            int found = (batch.num_classes[c] != ctx.partition.num_classes);
+            for (int v = 0; v < n && !found; v++) {
+                size_t at = (size_t)v * batch.capacity + c;
+                int k = ctx.partition.v_data[v].class_id - 1;
+                found = small_rep[batch.class_id[at]] != ref_rep[k] || batch.period[at] != ctx.periods[k]
+                        || fabs(batch.stationary[at] - ctx.stationary[v]) > CHECK_TOLERANCE;
+                if (found) {
+                    fprintf(stderr, "petite chaine %d/%d, etat %d : classe %d periode %d pi %.6f, markov_analyze %d %d %.6f\n",
+                            n, c, v + 1, small_rep[batch.class_id[at]], batch.period[at], batch.stationary[at],
+                            ref_rep[k], ctx.periods[k], ctx.stationary[v]);
+                }
+            }
+            if (found && batch.num_classes[c] != ctx.partition.num_classes) {
+                fprintf(stderr, "petite chaine %d/%d : %d classes, markov_analyze %d\n", n, c, batch.num_classes[c],
+                        ctx.partition.num_classes);
+            }
+            errors += found;
+            checked++;
+            markov_free(&ctx);
+        }
+        small_batch_free(&batch);
+    }
+
+    fprintf(stderr, "petites chaines : %d chaines de 1 a %d etats, %d ecart(s), %.1f ms\n", checked, SMALL_CHAIN_MAX_STATES,
+            errors, now_ms() - start);
+    return errors;
+}
+
+/*
+   random_delta :
+   Tire CHECK_DELTA_VERTICES sommets distincts ; chacun perd un de ses successeurs
+   (une fois sur deux s'il en a plusieurs) ou en gagne un, ses successeurs restant
+   équiprobables. Les arêtes (from, to, proba : E arêtes rangées sommet par sommet)
+   ne sont pas modifiées : les retraits, ajouts et nouvelles probabilités vont dans
+   delta, et la chaîne modifiée est écrite dans new_from, new_to et new_proba
+   (E + CHECK_DELTA_VERTICES cases) pour être analysée à part. Retourne son nombre
+   d'arêtes, -1 si la mémoire manque.
+*/
+static int random_delta(uint64_t *state, int N, int E, const int *from, const int *to, const float *proba,
+                        t_delta *delta, int *new_from, int *new_to, float *new_proba) {
+    int *row = (int *)calloc(N + 1, sizeof(int)); // Arêtes du sommet v (1..N) : [row[v - 1], row[v])
+    char *touched = (char *)calloc(N, sizeof(char));
+    if (row == NULL || touched == NULL) {
+        perror("Allocation failed for self-check delta");
+        free(row);
+        free(touched);
+        return -1;
+    }
+    for (int e = 0; e < E; e++) row[from[e]]++;
+    for (int v = 0; v < N; v++) row[v + 1] += row[v];
+    for (int i = 0; i < CHECK_DELTA_VERTICES && i < N; i++) {
+        int v = (int)(next_random(state) % (uint64_t)N);
+        while (touched[v]) v = (v + 1) % N;
+        touched[v] = 1;
+    }
+
+    int out = 0;
+    t_markov_status status = MARKOV_OK;
+    for (int v = 1; v <= N && status == MARKOV_OK; v++) {
+        int first = row[v - 1], degree = row[v] - first;
+        int removed = -1, added = 0;
+        if (touched[v - 1] && degree > 1 && (degree == N || next_random(state) % 2 == 0)) {
+            removed = first + (int)(next_random(state) % (uint64_t)degree);
+        } else if (touched[v - 1] && degree < N) {
+            // Ajout d'un état qui n'est pas encore un successeur
+            int present;
+            added = 1 + (int)(next_random(state) % (uint64_t)N);
+            do {
+                present = 0;
+                for (int e = first; e < row[v]; e++) present |= (to[e] == added);
+                if (present) added = added % N + 1;
+            } while (present);
+        }
+
+        int changed = (removed >= 0 || added > 0);
+        float p = 1.0f / (degree - (removed >= 0) + (added > 0));
+        for (int e = first; e < row[v] && status == MARKOV_OK; e++) {
+            if (e == removed) {
+                status = delta_add(delta, DELTA_REMOVE, v, to[e], 0.0f);
+                continue;
+            }
+            if (changed) status = delta_add(delta, DELTA_REWEIGHT, v, to[e], p);
+            new_from[out] = v;
+            new_to[out] = to[e];
+            new_proba[out++] = changed ? p : proba[e];
+        }
+        if (added > 0 && status == MARKOV_OK) {
+            status = delta_add(delta, DELTA_ADD, v, added, p);
+            new_from[out] = v;
+            new_to[out] = added;
+            new_proba[out++] = p;
+        }
+    }
+    free(row);
+    free(touched);
+    return (status == MARKOV_OK) ? out : -1;
+}
+
+/*
+   compare_results :
+   Compare deux analyses de la même chaîne, dont les classes peuvent être numérotées
+   autrement : pour chaque état, sa classe (par son plus petit état), sa persistance,
+   sa période, sa distribution stationnaire et sa probabilité d'absorption par chaque
+   classe persistante, à tolerance près. reference est l'analyse complète. Retourne
+   le nombre d'états en écart.
+*/
+static int compare_results(const t_markov_ctx *ctx, const t_markov_ctx *reference, const char *name, const char *what,
+                           double tolerance) {
+    int C = ctx->partition.num_classes, ref_C = reference->partition.num_classes;
+    if (C != ref_C) {
+        fprintf(stderr, "%s (%s) : %d classes, analyse complete %d\n", name, what, C, ref_C);
+        return 1;
+    }
+    int *rep = (int *)malloc((C > 0 ? C : 1) * sizeof(int));
+    int *ref_rep = (int *)malloc((C > 0 ? C : 1) * sizeof(int));
+    if (rep == NULL || ref_rep == NULL) {
+        fprintf(stderr, "%s (%s) : allocation impossible\n", name, what);
+        free(rep);
+        free(ref_rep);
+        return 1;
+    }
+    class_representatives(&ctx->partition, rep);
+    class_representatives(&reference->partition, ref_rep);
+
+    int errors = 0;
+    for (int v = 0; v < reference->num_vertices; v++) {
+        int k = ctx->partition.v_data[v].class_id - 1;
+        int ref_k = reference->partition.v_data[v].class_id - 1;
+        int found = rep[k] != ref_rep[ref_k]
+                    || ctx->partition.classes[k].is_persistent != reference->partition.classes[ref_k].is_persistent
+                    || ctx->periods[k] != reference->periods[ref_k]
+                    || fabs(ctx->stationary[v] - reference->stationary[v]) > tolerance;
+        if (found) {
+            fprintf(stderr, "%s (%s), etat %d : classe %d periode %d pi %.6f, analyse complete %d %d %.6f\n", name, what,
+                    v + 1, rep[k], ctx->periods[k], ctx->stationary[v], ref_rep[ref_k], reference->periods[ref_k],
+                    reference->stationary[v]);
+        }
+        for (int c = 0; c < ref_C && !found; c++) {
+            if (!reference->partition.classes[c].is_persistent) continue;
+            double value = -1.0, exact = -1.0;
+            int class_id = ctx->partition.v_data[ref_rep[c] - 1].class_id;
+            found = markov_absorption(ctx, v + 1, class_id, &value) != MARKOV_OK
+                    || markov_absorption(reference, v + 1, c + 1, &exact) != MARKOV_OK
+                    || fabs(value - exact) > tolerance;
+            if (found) {
+                fprintf(stderr, "%s (%s), etat %d : absorption par la classe de %d %.6f, analyse complete %.6f\n", name,
+                        what, v + 1, ref_rep[c], value, exact);
+            }
+        }
+        errors += found;
+    }
+    free(rep);
+    free(ref_rep);
+    return errors;
+}
+
+/*
+   check_delta_and_cache :
+   Sur une chaîne de chaque famille générée depuis seed : analyse, modifications de
+   random_delta appliquées par markov_apply_delta, puis comparaison à l'analyse
+   complète de la chaîne modifiée (à CHECK_TOLERANCE près : les distributions
+   stationnaires repartent à chaud). Cette analyse complète est ensuite enregistrée
+   dans un cache temporaire et relue dans un nouveau contexte, qui doit redonner
+   exactement les mêmes résultats. Retourne le nombre d'écarts.
+*/
+static int check_delta_and_cache(uint64_t seed) {
+    char cache_dir[] = "/tmp/markov_self_check_XXXXXX";
+    if (mkdtemp(cache_dir) == NULL) {
+        perror("Could not create self-check cache directory");
+        return 1;
+    }
+    int errors = 0, checked = 0;
+    double start = now_ms();
+
+    for (int family = 0; family < GEN_FAMILY_COUNT; family++) {
+        t_gen_params params;
+        gen_default_params(&params, (t_gen_family)family, CHECK_GEN_VERTICES, CHECK_GEN_DEGREE, seed);
+        if (gen_normalize(&params) != 0) continue;
+        const char *name = gen_family_name(params.family);
+        int N = params.num_vertices;
+
+        int *from, *to;
+        float *proba;
+        int E = generated_edges(&params, &from, &to, &proba);
+        int *new_from = (int *)malloc(((E > 0 ? E : 0) + CHECK_DELTA_VERTICES) * sizeof(int));
+        int *new_to = (int *)malloc(((E > 0 ? E : 0) + CHECK_DELTA_VERTICES) * sizeof(int));
+        float *new_proba = (float *)malloc(((E > 0 ? E : 0) + CHECK_DELTA_VERTICES) * sizeof(float));
+        t_delta delta;
+        delta_init(&delta);
+        int new_E = -1;
+        if (E >= 0 && new_from != NULL && new_to != NULL && new_proba != NULL) {
+            uint64_t state = (seed + (uint64_t)family) * 0x9E3779B97F4A7C15ULL + 1;
+            new_E = random_delta(&state, N, E, from, to, proba, &delta, new_from, new_to, new_proba);
+        }
+
+        t_markov_ctx updated, fresh, cached;
+        markov_init(&updated);
+        markov_init(&fresh);
+        markov_init(&cached);
+        t_markov_status status = (new_E < 0) ? MARKOV_ERR_NOMEM : markov_load_edges(&updated, N, E, from, to, proba);
+        if (status == MARKOV_OK) status = markov_analyze(&updated);
+        if (status == MARKOV_OK) status = markov_apply_delta(&updated, &delta, NULL);
+        if (status == MARKOV_OK) status = markov_load_edges(&fresh, N, new_E, new_from, new_to, new_proba);
+        if (status == MARKOV_OK) status = markov_analyze(&fresh);
+        if (status == MARKOV_OK) status = markov_cache_store(&fresh, cache_dir);
+        if (status == MARKOV_OK) status = markov_load_edges(&cached, N, new_E, new_from, new_to, new_proba);
+        if (status == MARKOV_OK) status = markov_check(&cached);
+        if (status == MARKOV_OK) status = markov_cache_load(&cached, cache_dir);
+        if (status == MARKOV_OK) {
+            int found = compare_results(&updated, &fresh, name, "delta", CHECK_TOLERANCE)
+                      + compare_results(&cached, &fresh, name, "cache", 0.0);
+            errors += found;
+            checked++;
+        } else {
+            fprintf(stderr, "%s : delta ou cache impossible (%s)\n", name, markov_status_string(status));
+            errors++;
+        }
+
+        if (fresh.stages_done & MARKOV_STAGE_LOADED) {
+            char path[sizeof(cache_dir) + 32];
+            snprintf(path, sizeof(path), "%s/%016llx%s", cache_dir, (unsigned long long)markov_cache_key(&fresh),
+                     MARKOV_CACHE_EXTENSION);
+            unlink(path);
+        }
+        markov_free(&updated);
+        markov_free(&fresh);
+        markov_free(&cached);
+        free_delta(&delta);
+        free(from);
+        free(to);
+        free(proba);
+        free(new_from);
+        free(new_to);
+        free(new_proba);
+    }
+    rmdir(cache_dir);
+
+    fprintf(stderr, "delta et cache : %d chaine(s) generee(s), %d ecart(s), %.1f ms\n", checked, errors, now_ms() - start);
+    return errors;
+}
+
+/*
+   self_check :
+   Chaînes du dossier (celles que markov_analyze refuse sont sautées), puis une
+   chaîne de chaque famille générée depuis seed, la même modifiée par un delta et
+   relue depuis le cache (check_delta_and_cache), puis les petites chaînes
+   (check_small_chains). Retourne le nombre d'écarts, -1 si le dossier est illisible.
+*/
+static int self_check(const char *dir_path, uint64_t seed) {
+    char **paths;
+    int count = collect_batch_dir(dir_path, &paths);
+    if (count < 0) return -1;
+
+    int errors = 0, checked = 0;
+    for (int f = 0; f < count; f++) {
+        t_markov_ctx ctx;
+        markov_init(&ctx);
+        double start = now_ms();
+        if (markov_load_file(&ctx, paths[f]) == MARKOV_OK && markov_analyze(&ctx) == MARKOV_OK) {
+            int found = check_local_push(&ctx, paths[f]);
+            fprintf(stderr, "%s : %d etats, %d ecart(s), %.1f ms\n", paths[f], ctx.num_vertices, found, now_ms() - start);
+            errors += found;
+            checked++;
+        }
+        markov_free(&ctx);
+    }
+    free_batch_paths(paths, count);
+
+    for (int family = 0; family < GEN_FAMILY_COUNT; family++) {
+        t_gen_params params;
+        gen_default_params(&params, (t_gen_family)family, CHECK_GEN_VERTICES, CHECK_GEN_DEGREE, seed);
+        if (gen_normalize(&params) != 0) continue;
+
+        t_markov_ctx ctx;
+        markov_init(&ctx);
+        double start = now_ms();
+        t_markov_status status = load_generated(&ctx, &params);
+        if (status == MARKOV_OK) status = markov_analyze(&ctx);
+        if (status == MARKOV_OK) {
+            int found = check_local_push(&ctx, gen_family_name(params.family));
+            fprintf(stderr, "%s : %d etats, %d ecart(s), %.1f ms\n", gen_family_name(params.family), ctx.num_vertices, found,
+                    now_ms() - start);
+            errors += found;
+            checked++;
+        } else {
+            fprintf(stderr, "%s : analyse impossible (%s)\n", gen_family_name(params.family), markov_status_string(status));
+            errors++;
+        }
+        markov_free(&ctx);
+    }
+
+    errors += check_delta_and_cache(seed);
+    errors += check_small_chains(seed);
+    fprintf(stderr, "Auto-verification : %d chaine(s), %d ecart(s)\n", checked, errors);
+    return errors;
+}
+
+int main(int argc, char *argv[]) {
+    const char *family_name = NULL;
+    const char *output_path = NULL;
+    const char *expected_path = NULL;
+    const char *check_dir = NULL;
+    int num_vertices = 0, degree = 4, num_threads = 0, verify = 0;
+    // Paramètres propres aux familles : -1 = valeur par défaut de gen_default_params
+    int bandwidth = -1, block_size = -1, num_absorbing = -1, absorbing_size = -1, period = -1, max_degree = -1;
+    double exponent = -1.0;
+    unsigned long long seed = 1;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--family") == 0 && i + 1 < argc) family_name = argv[++i];
+        else if (strcmp(argv[i], "--vertices") == 0 && i + 1 < argc) num_vertices = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--degree") == 0 && i + 1 < argc) degree = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--bandwidth") == 0 && i + 1 < argc) bandwidth = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--block-size") == 0 && i + 1 < argc) block_size = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--absorbing") == 0 && i + 1 < argc) num_absorbing = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--absorbing-size") == 0 && i + 1 < argc) absorbing_size = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--period") == 0 && i + 1 < argc) period = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--exponent") == 0 && i + 1 < argc) exponent = atof(argv[++i]);
+        else if (strcmp(argv[i], "--max-degree") == 0 && i + 1 < argc) max_degree = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) seed = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) num_threads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) output_path = argv[++i];
+        else if (strcmp(argv[i], "--expected") == 0 && i + 1 < argc) expected_path = argv[++i];
+        else if (strcmp(argv[i], "--verify") == 0) verify = 1;
+        else if (strcmp(argv[i], "--self-check") == 0) check_dir = (i + 1 < argc && argv[i + 1][0] != '-') ? argv[++i] : "data";
+        else if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) {
+            print_usage(argv[0]);
+            return EXIT_SUCCESS;
+        } else {
+            fprintf(stderr, "Option invalide : %s\n", argv[i]);
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (check_dir != NULL) return (self_check(check_dir, seed) == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+
+    int family = (family_name != NULL) ? gen_family_from_name(family_name) : -1;
+    if (family < 0 || num_vertices <= 0) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (verify && output_path == NULL) {
+        fprintf(stderr, "--verify demande --output (la chaine doit etre relue depuis un fichier).\n");
+        return EXIT_FAILURE;
+    }
+
+    t_gen_params params;
+    gen_default_params(&params, (t_gen_family)family, num_vertices, degree, seed);
+    if (bandwidth >= 0) params.bandwidth = bandwidth;
+    if (block_size >= 0) params.block_size = block_size;
+    if (num_absorbing >= 0) params.num_absorbing = num_absorbing;
+    if (absorbing_size >= 0) params.absorbing_size = absorbing_size;
+    if (period >= 0) params.period = period;
+    if (exponent >= 0.0) params.exponent = exponent;
+    if (max_degree >= 0) params.max_degree = max_degree;
+    if (gen_normalize(&params) != 0) {
+        fprintf(stderr, "Parametres incoherents pour la famille %s.\n", family_name);
+        return EXIT_FAILURE;
+    }
+
+    FILE *out = stdout;
+    if (output_path != NULL) {
+        out = fopen(output_path, "w");
+        if (out == NULL) {
+            perror("Could not open output file");
+            return EXIT_FAILURE;
+        }
+    }
+
+    double start = now_ms();
+    long long num_edges = gen_write_chain(&params, out, num_threads);
+    double elapsed = now_ms() - start;
+    if (out != stdout && fclose(out) != 0) num_edges = -1;
+    if (num_edges < 0) {
+        fprintf(stderr, "Erreur d'ecriture de la chaine.\n");
+        return EXIT_FAILURE;
+    }
+    fprintf(stderr, "%s : %d sommets, %lld aretes, %d classe(s) attendue(s), %.1f ms (%.2f M aretes/s)\n",
+            gen_family_name(params.family), params.num_vertices, num_edges, gen_expected_num_classes(&params),
+            elapsed, elapsed > 0.0 ? num_edges / elapsed / 1000.0 : 0.0);
+
+    if (expected_path != NULL) {
+        FILE *expected = fopen(expected_path, "w");
+        if (expected == NULL || gen_write_expected(&params, expected) != 0) {
+            perror("Could not write expected partition");
+            if (expected != NULL) fclose(expected);
+            return EXIT_FAILURE;
+        }
+        fclose(expected);
+    }
+
+    if (verify && verify_chain(&params, output_path) != 0) return EXIT_FAILURE;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,387 @@
+#include "generator.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+
+// Sommets traités d'un bloc par un thread d'écriture
+#define GEN_CHUNK_VERTICES 4096
+// Longueur maximale d'une ligne "départ arrivée probabilité\n"
+#define GEN_MAX_LINE 48
+
+static const char *family_names[GEN_FAMILY_COUNT] = {"random", "banded", "absorbing", "periodic", "powerlaw"};
+
+//Générateur pseudo-aléatoire (splitmix64), un par sommet : la sortie ne dépend ni du nombre de threads ni de l'ordre de génération.
+typedef struct s_gen_rng {
+    uint64_t state;
+} t_gen_rng;
+
+static uint64_t rng_next(t_gen_rng *rng) {
+    uint64_t z = (rng->state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static int rng_below(t_gen_rng *rng, int bound) {
+    return (int)(rng_next(rng) % (uint64_t)bound);
+}
+
+//Réel uniforme dans [0, 1).
+static double rng_uniform(t_gen_rng *rng) {
+    return (rng_next(rng) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static t_gen_rng vertex_rng(const t_gen_params *params, int v) {
+    t_gen_rng rng = {params->seed ^ ((uint64_t)(v + 1) * 0xD1B54A32D192ED03ULL)};
+    rng_next(&rng);
+    return rng;
+}
+
+const char *gen_family_name(t_gen_family family) {
+    return (family >= 0 && family < GEN_FAMILY_COUNT) ? family_names[family] : "?";
+}
+
+int gen_family_from_name(const char *name) {
+    for (int f = 0; f < GEN_FAMILY_COUNT; f++) {
+        if (strcmp(name, family_names[f]) == 0) return f;
+    }
+    return -1;
+}
+
+/*
+   gen_default_params :
+   Valeurs par défaut des paramètres propres à chaque famille : bande de largeur
+   (degré - 1) / 2, classes transitoires de 8 sommets se vidant vers N/64 états
+   absorbants, période 4, exposant 2.5 plafonné à un degré de 1000.
+*/
+void gen_default_params(t_gen_params *params, t_gen_family family, int num_vertices, int degree, uint64_t seed) {
+    memset(params, 0, sizeof(*params));
+    params->family = family;
+    params->num_vertices = num_vertices;
+    params->degree = degree;
+    params->bandwidth = (degree - 1) / 2 > 0 ? (degree - 1) / 2 : 1;
+    params->block_size = 8;
+    params->num_absorbing = num_vertices / 64 > 0 ? num_vertices / 64 : 1;
+    params->absorbing_size = 1;
+    params->period = 4;
+    params->exponent = 2.5;
+    params->max_degree = 1000;
+    params->seed = seed;
+}
+
+/*
+   gen_normalize :
+   Rend les paramètres cohérents avec N : une famille ne peut pas demander plus
+   de destinations distinctes qu'il n'en existe, et N doit être un multiple de la
+   période pour que les couches aient toutes la même taille.
+*/
+int gen_normalize(t_gen_params *params) {
+    if (params->family < 0 || params->family >= GEN_FAMILY_COUNT) return -1;
+    if (params->num_vertices <= 0 || params->degree <= 0) return -1;
+    int N = params->num_vertices;
+
+    switch (params->family) {
+        case GEN_RANDOM:
+            if (params->degree > N) params->degree = N;
+            break;
+        case GEN_BANDED:
+            if (params->bandwidth < 1) params->bandwidth = 1;
+            if (params->bandwidth > N) params->bandwidth = N;
+            break;
+        case GEN_ABSORBING:
+            if (params->block_size < 1 || params->num_absorbing < 1 || params->absorbing_size < 1) return -1;
+            if ((long long)params->num_absorbing * params->absorbing_size > N) return -1;
+            if (params->degree < 2) params->degree = 2; // Une arête dans la classe, au moins une vers la sortie
+            break;
+        case GEN_PERIODIC:
+            if (params->period < 1 || params->period > N) return -1;
+            params->num_vertices = N - N % params->period;
+            if (params->degree > params->num_vertices / params->period) {
+                params->degree = params->num_vertices / params->period;
+            }
+            break;
+        case GEN_POWERLAW:
+            if (params->exponent <= 1.0) return -1;
+            if (params->max_degree > N) params->max_degree = N;
+            if (params->degree > params->max_degree) params->degree = params->max_degree;
+            break;
+        default:
+            return -1;
+    }
+    return 0;
+}
+
+int gen_max_out_degree(const t_gen_params *params) {
+    switch (params->family) {
+        case GEN_BANDED:   return 2 * params->bandwidth + 1;
+        case GEN_ABSORBING: return params->degree;
+        case GEN_POWERLAW: return params->max_degree + 1;
+        default:           return params->degree + 1;
+    }
+}
+
+//Ajoute une destination si elle n'est pas déjà présente. Retourne 1 si ajoutée.
+static int add_unique(int *destinations, int *count, int destination) {
+    for (int e = 0; e < *count; e++) {
+        if (destinations[e] == destination) return 0;
+    }
+    destinations[(*count)++] = destination;
+    return 1;
+}
+
+//Complète avec des destinations tirées dans [base, base + range) * stride + offset jusqu'à target arêtes.
+static void add_random(t_gen_rng *rng, int *destinations, int *count, int target,
+                       int base, int range, int stride, int offset) {
+    for (int tries = 0; *count < target && tries < 4 * target + 16; tries++) {
+        add_unique(destinations, count, (base + rng_below(rng, range)) * stride + offset);
+    }
+}
+
+/*
+   gen_vertex_edges :
+   Chaque famille garantit sa structure de classes par quelques arêtes fixes,
+   puis complète au hasard :
+   - random / powerlaw : anneau v → v+1 (une seule classe) et boucle sur 0 (apériodique) ;
+   - banded : toutes les destinations |v - j| <= bandwidth (boucles comprises) ;
+   - absorbing : anneau dans la classe du sommet, sorties uniquement vers les sommets
+     suivants (classes transitoires) ; les classes absorbantes, à la fin, sont des
+     anneaux fermés avec une boucle sur leur premier sommet ;
+   - periodic : arêtes de la couche v % period vers la suivante seulement, anneau,
+     et un cycle 0 → 1 → ... → period-1 → 0 qui fixe la période exactement.
+*/
+int gen_vertex_edges(const t_gen_params *params, int v, int *destinations) {
+    t_gen_rng rng = vertex_rng(params, v);
+    int N = params->num_vertices;
+    int count = 0;
+
+    switch (params->family) {
+        case GEN_RANDOM:
+            if (v == 0) add_unique(destinations, &count, 0);
+            add_unique(destinations, &count, (v + 1) % N);
+            add_random(&rng, destinations, &count, params->degree, 0, N, 1, 0);
+            break;
+
+        case GEN_BANDED: {
+            int low = v - params->bandwidth > 0 ? v - params->bandwidth : 0;
+            int high = v + params->bandwidth < N - 1 ? v + params->bandwidth : N - 1;
+            for (int j = low; j <= high; j++) destinations[count++] = j;
+            break;
+        }
+
+        case GEN_ABSORBING: {
+            int first_absorbing = N - params->num_absorbing * params->absorbing_size;
+            if (v >= first_absorbing) {
+                int start = first_absorbing + (v - first_absorbing) / params->absorbing_size * params->absorbing_size;
+                add_unique(destinations, &count, (v + 1 < start + params->absorbing_size) ? v + 1 : start);
+                if (v == start) add_unique(destinations, &count, v);
+                break;
+            }
+            int start = v - v % params->block_size;
+            int end = start + params->block_size < first_absorbing ? start + params->block_size : first_absorbing;
+            add_unique(destinations, &count, (v + 1 < end) ? v + 1 : start);
+            add_random(&rng, destinations, &count, params->degree, end, N - end, 1, 0);
+            break;
+        }
+
+        case GEN_PERIODIC: {
+            int period = params->period;
+            add_unique(destinations, &count, (v + 1) % N);
+            if (v == period - 1) add_unique(destinations, &count, 0);
+            add_random(&rng, destinations, &count, params->degree, 0, N / period, period, (v + 1) % period);
+            break;
+        }
+
+        case GEN_POWERLAW: {
+            // Tirage par inversion : P(degré >= d) ~ d^(1 - exponent)
+            double u = rng_uniform(&rng);
+            double d = params->degree * pow(1.0 - u, -1.0 / (params->exponent - 1.0));
+            int target = (d >= params->max_degree) ? params->max_degree : (int)d;
+            if (v == 0) add_unique(destinations, &count, 0);
+            add_unique(destinations, &count, (v + 1) % N);
+            add_random(&rng, destinations, &count, target, 0, N, 1, 0);
+            break;
+        }
+
+        default:
+            break;
+    }
+    return count;
+}
+
+t_gen_expected gen_expected_class(const t_gen_params *params, int v) {
+    t_gen_expected expected = {1, 1, 1};
+
+    if (params->family == GEN_PERIODIC) {
+        expected.period = params->period;
+    } else if (params->family == GEN_ABSORBING) {
+        int first_absorbing = params->num_vertices - params->num_absorbing * params->absorbing_size;
+        if (v >= first_absorbing) {
+            expected.representative = first_absorbing + (v - first_absorbing) / params->absorbing_size * params->absorbing_size + 1;
+        } else {
+            expected.representative = v - v % params->block_size + 1;
+            expected.is_persistent = 0;
+            expected.period = 0;
+        }
+    }
+    return expected;
+}
+
+int gen_expected_num_classes(const t_gen_params *params) {
+    if (params->family != GEN_ABSORBING) return 1;
+    int transient = params->num_vertices - params->num_absorbing * params->absorbing_size;
+    return (transient + params->block_size - 1) / params->block_size + params->num_absorbing;
+}
+
+//Écrit un entier positif ou nul en décimal. Retourne le nombre de caractères.
+static int format_int(char *buffer, int value) {
+    char digits[12];
+    int n = 0;
+    do {
+        digits[n++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    for (int i = 0; i < n; i++) buffer[i] = digits[n - 1 - i];
+    return n;
+}
+
+//Données partagées par les threads d'écriture : les blocs sont générés dans n'importe quel ordre mais écrits dans l'ordre.
+typedef struct s_gen_pool {
+    const t_gen_params *params;
+    FILE *out;
+    int num_chunks;
+    atomic_int next_chunk;      // Prochain bloc à générer
+    int next_write;             // Prochain bloc à écrire (protégé par lock)
+    int failed;                 // Erreur d'allocation ou d'écriture (protégé par lock)
+    atomic_llong num_edges;
+    pthread_mutex_t lock;
+    pthread_cond_t turn;
+} t_gen_pool;
+
+/*
+   gen_worker :
+   Génère le texte d'un bloc de sommets dans un tampon privé, puis attend son
+   tour pour l'écrire : la mémoire reste bornée (un tampon par thread) et le
+   fichier est identique quel que soit le nombre de threads.
+*/
+static void *gen_worker(void *arg) {
+    t_gen_pool *pool = (t_gen_pool *)arg;
+    const t_gen_params *params = pool->params;
+    int max_degree = gen_max_out_degree(params);
+    int *destinations = (int *)malloc(max_degree * sizeof(int));
+    size_t capacity = (size_t)GEN_CHUNK_VERTICES * GEN_MAX_LINE;
+    char *buffer = (char *)malloc(capacity);
+    int chunk;
+
+    while ((chunk = atomic_fetch_add(&pool->next_chunk, 1)) < pool->num_chunks) {
+        size_t length = 0;
+        long long edges = 0;
+        int ok = (destinations != NULL && buffer != NULL);
+
+        int first = chunk * GEN_CHUNK_VERTICES;
+        int last = first + GEN_CHUNK_VERTICES < params->num_vertices ? first + GEN_CHUNK_VERTICES : params->num_vertices;
+        for (int v = first; v < last && ok; v++) {
+            int count = gen_vertex_edges(params, v, destinations);
+            if (length + (size_t)count * GEN_MAX_LINE > capacity) {
+                size_t new_capacity = 2 * capacity + (size_t)count * GEN_MAX_LINE;
+                char *grown = (char *)realloc(buffer, new_capacity);
+                if (grown == NULL) {
+                    ok = 0;
+                    break;
+                }
+                buffer = grown;
+                capacity = new_capacity;
+            }
+
+            char proba[24];
+            int proba_length = snprintf(proba, sizeof(proba), " %.7g\n", 1.0 / count);
+            for (int e = 0; e < count; e++) {
+                length += format_int(buffer + length, v + 1);
+                buffer[length++] = ' ';
+                length += format_int(buffer + length, destinations[e] + 1);
+                memcpy(buffer + length, proba, proba_length);
+                length += proba_length;
+            }
+            edges += count;
+        }
+
+        pthread_mutex_lock(&pool->lock);
+        if (!ok) pool->failed = 1;
+        while (pool->next_write != chunk && !pool->failed) pthread_cond_wait(&pool->turn, &pool->lock);
+        if (!pool->failed && fwrite(buffer, 1, length, pool->out) != length) pool->failed = 1;
+        pool->next_write++;
+        pthread_cond_broadcast(&pool->turn);
+        int stop = pool->failed;
+        pthread_mutex_unlock(&pool->lock);
+
+        atomic_fetch_add(&pool->num_edges, edges);
+        if (stop) break;
+    }
+
+    free(destinations);
+    free(buffer);
+    return NULL;
+}
+
+/*
+   gen_write_chain :
+   Écrit N puis toutes les arêtes, sommet par sommet. Les paramètres doivent
+   avoir été validés par gen_normalize.
+*/
+long long gen_write_chain(const t_gen_params *params, FILE *out, int num_threads) {
+    t_gen_pool pool;
+    pool.params = params;
+    pool.out = out;
+    pool.num_chunks = (params->num_vertices + GEN_CHUNK_VERTICES - 1) / GEN_CHUNK_VERTICES;
+    pool.next_write = 0;
+    pool.failed = 0;
+    atomic_init(&pool.next_chunk, 0);
+    atomic_init(&pool.num_edges, 0);
+    pthread_mutex_init(&pool.lock, NULL);
+    pthread_cond_init(&pool.turn, NULL);
+
+    if (fprintf(out, "%d\n", params->num_vertices) < 0) return -1;
+
+    if (num_threads <= 0) {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = (cores > 0) ? (int)cores : 1;
+    }
+    if (num_threads > pool.num_chunks) num_threads = pool.num_chunks;
+
+    pthread_t *threads = (pthread_t *)malloc(num_threads * sizeof(pthread_t));
+    int started = 0;
+    for (int i = 0; threads != NULL && i < num_threads; i++) {
+        if (pthread_create(&threads[i], NULL, gen_worker, &pool) != 0) break;
+        started++;
+    }
+
+    // Si aucun thread n'a pu démarrer, le thread appelant fait tout le travail
+    if (started == 0) gen_worker(&pool);
+
+    for (int i = 0; i < started; i++) pthread_join(threads[i], NULL);
+    free(threads);
+    pthread_mutex_destroy(&pool.lock);
+    pthread_cond_destroy(&pool.turn);
+
+    if (pool.failed || fflush(out) != 0) return -1;
+    return atomic_load(&pool.num_edges);
+}
+
+/*
+   gen_write_expected :
+   Partition attendue, pour vérifier l'analyse : les classes sont désignées par
+   leur plus petit sommet, il suffit donc de comparer les représentants.
+*/
+int gen_write_expected(const t_gen_params *params, FILE *out) {
+    fprintf(out, "# famille %s, %d sommets, %d classes\n",
+            gen_family_name(params->family), params->num_vertices, gen_expected_num_classes(params));
+    fprintf(out, "# sommet classe(plus petit sommet) persistante periode\n");
+
+    for (int v = 0; v < params->num_vertices; v++) {
+        t_gen_expected expected = gen_expected_class(params, v);
+        fprintf(out, "%d %d %d %d\n", v + 1, expected.representative, expected.is_persistent, expected.period);
+    }
+    return (fflush(out) == 0 && !ferror(out)) ? 0 : -1;
+}
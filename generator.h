@@ -0,0 +1,69 @@
+#ifndef GENERATOR_H
+#define GENERATOR_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+//Familles de chaînes synthétiques.
+typedef enum e_gen_family {
+    GEN_RANDOM = 0,    // Anneau + destinations uniformes : une classe apériodique
+    GEN_BANDED,        // Bande |i - j| <= bandwidth (naissance-mort pour bandwidth = 1) : une classe apériodique
+    GEN_ABSORBING,     // Petites classes transitoires qui se vident vers des classes absorbantes
+    GEN_PERIODIC,      // Couches parcourues en cycle : une classe de période donnée
+    GEN_POWERLAW,      // Degré sortant en loi de puissance : une classe apériodique
+    GEN_FAMILY_COUNT
+} t_gen_family;
+
+//Paramètres d'une chaîne générée. Deux appels avec les mêmes paramètres produisent exactement la même chaîne.
+typedef struct s_gen_params {
+    t_gen_family family;
+    int num_vertices;     // Nombre de sommets N
+    int degree;           // Degré sortant (random, absorbing, periodic) ou degré minimal (powerlaw)
+    int bandwidth;        // Demi-largeur de bande (banded)
+    int block_size;       // Taille des classes transitoires (absorbing)
+    int num_absorbing;    // Nombre de classes absorbantes (absorbing)
+    int absorbing_size;   // Taille de chaque classe absorbante (absorbing)
+    int period;           // Période (periodic)
+    double exponent;      // Exposant de la loi de puissance, > 1 (powerlaw)
+    int max_degree;       // Degré maximal (powerlaw)
+    uint64_t seed;        // Graine
+} t_gen_params;
+
+//Classe attendue d'un sommet, identifiée par son plus petit sommet (indépendant de la numérotation de Tarjan).
+typedef struct s_gen_expected {
+    int representative;   // Plus petit sommet (1-based) de la classe
+    int is_persistent;    // 1 si la classe est persistante
+    int period;           // Période de la classe, 0 si transitoire (même convention que markov_solve)
+} t_gen_expected;
+
+//Nom d'une famille ("random", "banded", "absorbing", "periodic", "powerlaw").
+const char *gen_family_name(t_gen_family family);
+
+//Famille correspondant à un nom. Retourne -1 si le nom est inconnu.
+int gen_family_from_name(const char *name);
+
+//Remplit des paramètres par défaut pour une famille, N sommets et un degré donné.
+void gen_default_params(t_gen_params *params, t_gen_family family, int num_vertices, int degree, uint64_t seed);
+
+//Ajuste les paramètres (N multiple de la période, degrés bornés par N...). Retourne 0 si valides, -1 sinon.
+int gen_normalize(t_gen_params *params);
+
+//Nombre maximal d'arêtes sortantes d'un sommet : taille du tampon à passer à gen_vertex_edges.
+int gen_max_out_degree(const t_gen_params *params);
+
+//Destinations (0-based, distinctes) du sommet v (0-based). Chaque arête a la probabilité 1 / nombre d'arêtes. Retourne le nombre d'arêtes.
+int gen_vertex_edges(const t_gen_params *params, int v, int *destinations);
+
+//Classe attendue du sommet v (0-based).
+t_gen_expected gen_expected_class(const t_gen_params *params, int v);
+
+//Nombre de classes attendu.
+int gen_expected_num_classes(const t_gen_params *params);
+
+//Écrit la chaîne au format data/ en flux, sur num_threads threads (0 = nombre de coeurs). Retourne le nombre d'arêtes, -1 si erreur.
+long long gen_write_chain(const t_gen_params *params, FILE *out, int num_threads);
+
+//Écrit la partition attendue : une ligne "sommet représentant persistante période" par sommet. Retourne 0 si succès, -1 sinon.
+int gen_write_expected(const t_gen_params *params, FILE *out);
+
+#endif // GENERATOR_H
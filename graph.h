@@ -3,6 +3,8 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include "markov_status.h"
+#include "labels.h"
 
 //Représente une arête (ou une 'cellule' dans la liste chaînée). Chaque arête a une probabilité et mène à un sommet.
 typedef struct s_edge {
@@ -22,7 +24,7 @@ typedef struct s_graph {
     int num_vertices; // Nombre de sommets (taille du tableau)
 } t_graph;
 
-//Crée et initialise une nouvelle cellule/arête.
+//Crée et initialise une nouvelle cellule/arête. Retourne NULL si l'allocation échoue.
 t_edge *create_edge(int arrival, float proba);
 
 //Crée et initialise une liste d'arêtes vide.
@@ -31,15 +33,37 @@ t_list create_empty_list();
 //Ajoute une nouvelle arête (cellule) au début d'une liste.
 void add_edge_to_list(t_list *list, t_edge *edge);
 
-//Crée et initialise une liste d'adjacence 'vide' à partir d'une taille donnée.
+//Crée et initialise une liste d'adjacence 'vide' à partir d'une taille donnée. adj_lists vaut NULL si l'allocation échoue.
 t_graph create_empty_graph(int num_vertices);
 
 //Affiche le contenu d'une liste d'adjacence (une par une pour chaque sommet).
 void display_graph(t_graph graph);
 
-//Lit un fichier et construit la liste d'adjacence.
+//Lit un fichier et construit la liste d'adjacence. Retourne un graphe vide (num_vertices = 0) en cas d'erreur.
 t_graph read_graph(const char *filename);
 
+//Comme read_graph, mais indique la cause de l'échec (fichier, format ou mémoire). Accepte les deux formats de load_graph_labeled.
+t_markov_status load_graph(const char *filename, t_graph *graph);
+
+//Statistiques de lecture d'un fichier.
+typedef struct s_load_stats {
+    int labeled;             // 1 si les états sont désignés par des étiquettes
+    int matrix_market;       // 1 si le fichier est au format Matrix Market
+    long long num_edges;     // Arêtes lues
+    double read_ms;          // Lecture complète, internement compris
+    double intern_ms;        // Internement des étiquettes seul
+    size_t label_bytes;      // Texte des étiquettes (octets, '\0' compris)
+} t_load_stats;
+
+//Lit un fichier numéroté (N sur la première ligne, puis "départ arrivée probabilité" avec des états de 1 à N), étiqueté
+//(une arête "étiquette_départ étiquette_arrivée probabilité" par ligne, lignes vides et commentaires '#' ignorés)
+//ou Matrix Market coordonné ("%%MatrixMarket matrix coordinate ...", entrée (i, j) = probabilité de i vers j).
+//Les étiquettes sont internées dans labels (numéros dans l'ordre de première apparition) ; labels et stats peuvent valoir NULL.
+t_markov_status load_graph_labeled(const char *filename, t_graph *graph, t_label_table *labels, t_load_stats *stats);
+
+//Nombre total d'arêtes du graphe.
+int count_edges(t_graph graph);
+
 //Libère la mémoire allouée pour le graphe.
 void free_graph(t_graph graph);
 
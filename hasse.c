@@ -18,14 +18,14 @@ t_link_array *create_link_array(int initial_capacity) {
     t_link_array *arr = (t_link_array *)malloc(sizeof(t_link_array));
     if (!arr) {
         perror("Error: malloc failed for t_link_array");
-        exit(EXIT_FAILURE);
+        return NULL;
     }
 
     arr->links = (t_link *)malloc(sizeof(t_link) * initial_capacity);
     if (!arr->links) {
         perror("Error: malloc failed for links");
         free(arr);
-        exit(EXIT_FAILURE);
+        return NULL;
     }
 
     arr->size = 0;
@@ -62,19 +62,18 @@ int link_exists(t_link_array *arr, int source_id, int dest_id) {
 //Ajoute un lien au tableau si non présent, gère la réallocation.
 /* Ajoute un lien source → destination dans le tableau dynamique si il n'existe pas déjà.
    La fonction vérifie l'existence, réalloue le tableau en cas de manque d'espace, puis ajoute le lien.
-   Elle construit progressivement la structure représentant la relation entre classes. */
-
-void add_link(t_link_array *arr, int source_id, int dest_id) {
-    if (!arr) return;
-    if (link_exists(arr, source_id, dest_id)) return; // évite doublon
+   Elle construit progressivement la structure représentant la relation entre classes.
+   Retourne 0 si le lien est présent à la sortie, -1 si la réallocation a échoué. */
 
+//Ajoute le lien en fin de tableau sans chercher de doublon, en doublant la capacité au besoin.
+static int append_link(t_link_array *arr, int source_id, int dest_id) {
     if (arr->size == arr->capacity) {
         int new_capacity = arr->capacity * 2;
         if (new_capacity < 4) new_capacity = 4;
         t_link *tmp = (t_link *)realloc(arr->links, sizeof(t_link) * new_capacity);
         if (!tmp) {
             perror("add_link: realloc failed");
-            return;
+            return -1;
         }
         arr->links = tmp;
         arr->capacity = new_capacity;
@@ -83,20 +82,70 @@ void add_link(t_link_array *arr, int source_id, int dest_id) {
     arr->links[arr->size].source_class_id = source_id;
     arr->links[arr->size].dest_class_id = dest_id;
     arr->size++;
+    return 0;
+}
+
+int add_link(t_link_array *arr, int source_id, int dest_id) {
+    if (!arr) return -1;
+    if (link_exists(arr, source_id, dest_id)) return 0; // évite doublon
+    return append_link(arr, source_id, dest_id);
+}
+
+//Ensemble des liens déjà ajoutés (adressage ouvert, clé 0 = case vide : les identifiants de classe commencent à 1).
+typedef struct s_link_set {
+    unsigned long long *keys;
+    size_t mask;   // Capacité - 1 (capacité puissance de 2)
+    size_t count;
+} t_link_set;
+
+static size_t link_slot(const t_link_set *set, unsigned long long key) {
+    size_t slot = (size_t)((key * 0x9E3779B97F4A7C15ULL) >> 17) & set->mask;
+    while (set->keys[slot] != 0 && set->keys[slot] != key) slot = (slot + 1) & set->mask;
+    return slot;
+}
+
+//Insère la clé. Retourne 1 si elle est nouvelle, 0 si elle était déjà présente, -1 si la mémoire manque.
+static int link_set_insert(t_link_set *set, unsigned long long key) {
+    size_t slot = link_slot(set, key);
+    if (set->keys[slot] == key) return 0;
+
+    if (2 * (set->count + 1) > set->mask + 1) {
+        t_link_set bigger = {calloc(2 * (set->mask + 1), sizeof(unsigned long long)), 2 * set->mask + 1, set->count};
+        if (bigger.keys == NULL) return -1;
+        for (size_t i = 0; i <= set->mask; i++) {
+            if (set->keys[i] != 0) bigger.keys[link_slot(&bigger, set->keys[i])] = set->keys[i];
+        }
+        free(set->keys);
+        *set = bigger;
+        slot = link_slot(set, key);
+    }
+    set->keys[slot] = key;
+    set->count++;
+    return 1;
 }
 
 //Construit les liens entre classes (Diagramme de Hasse).
 /* Calcule les liens entre classes à partir du graphe et de la partition obtenue (CFCs).
    Pour chaque arête du graphe original, si l'arête relie deux classes différentes,
-   un lien inter-classes est ajouté. Cela construit la base du diagramme de Hasse. */
+   un lien inter-classes est ajouté. Cela construit la base du diagramme de Hasse.
+   Les doublons sont écartés par une table de hachage plutôt que par link_exists :
+   la recherche linéaire rendait l'étape quadratique dès quelques milliers de liens.
+   L'ordre des liens (première apparition) est celui de add_link. */
 
 t_link_array *compute_hasse_diagram_links(t_graph graph, t_partition partition) {
     if (partition.num_classes == 0) return NULL;
 
-    // Initialisation du tableau de liens (capacité initiale = N liens max)
-    t_link_array *links = create_link_array(partition.num_classes * partition.num_classes);
+    // Initialisation du tableau de liens (un lien par classe au départ, add_link double la capacité au besoin :
+    // num_classes² débordait et réservait des gigaoctets dès quelques dizaines de milliers de classes)
+    t_link_array *links = create_link_array(partition.num_classes);
     if (!links) return NULL;
 
+    t_link_set seen = {calloc(64, sizeof(unsigned long long)), 63, 0};
+    if (!seen.keys) {
+        free_link_array(links);
+        return NULL;
+    }
+
     for (int i = 0; i < graph.num_vertices; ++i) {
         // u_id est le sommet de départ (1-based)
         int u_id = i + 1;
@@ -113,11 +162,18 @@ t_link_array *compute_hasse_diagram_links(t_graph graph, t_partition partition)
 
             // Il y a un lien inter-classes si les IDs sont différents
             if (u_class_id != v_class_id) {
-                add_link(links, u_class_id, v_class_id);
+                unsigned long long key = ((unsigned long long)u_class_id << 32) | (unsigned int)v_class_id;
+                int inserted = link_set_insert(&seen, key);
+                if (inserted < 0 || (inserted == 1 && append_link(links, u_class_id, v_class_id) != 0)) {
+                    free(seen.keys);
+                    free_link_array(links);
+                    return NULL;
+                }
             }
             current_edge = current_edge->next;
         }
     }
+    free(seen.keys);
     return links;
 }
 
@@ -126,14 +182,15 @@ t_link_array *compute_hasse_diagram_links(t_graph graph, t_partition partition)
 /* Génère un fichier Mermaid (.md) contenant la représentation graphique du diagramme de Hasse.
    Cette fonction écrit les nœuds (classes persistantes ou transitoires)
    puis les liens entre classes sous forme d'instructions Mermaid.
-   Le but est de permettre une visualisation claire des relations entre classes. */
+   Le but est de permettre une visualisation claire des relations entre classes.
+   Comme generate_mermaid_file, n'affiche rien : l'appelant annonce le fichier généré. */
 
-void generate_hasse_mermaid_file(t_link_array *links, const char *output_filename, t_partition partition) {
+int generate_hasse_mermaid_file(t_link_array *links, const char *output_filename, t_partition partition) {
     FILE *file = fopen(output_filename, "w");
 
     if (file == NULL) {
         perror("Could not open output file for Hasse writing");
-        return;
+        return -1;
     }
 
     fprintf(file, "--- \n");
@@ -168,7 +225,7 @@ void generate_hasse_mermaid_file(t_link_array *links, const char *output_filenam
     }
 
     fclose(file);
-    printf("Fichier mermaid du diagramme de Hasse genere: %s\n", output_filename);
+    return 0;
 }
 
 // --- OPTIONNEL : Suppression des liens transitifs ---
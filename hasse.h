@@ -16,14 +16,14 @@ typedef struct {
 } t_link_array;
 
 
-//Crée et initialise un tableau dynamique de liens.
+//Crée et initialise un tableau dynamique de liens. Retourne NULL si la capacité est invalide ou si la mémoire manque.
 t_link_array *create_link_array(int initial_capacity);
 
 //Vérifie si un lien entre deux classes existe déjà.
 int link_exists(t_link_array *arr, int source_id, int dest_id);
 
-//Ajoute un lien au tableau si non présent, gère la réallocation.
-void add_link(t_link_array *arr, int source_id, int dest_id);
+//Ajoute un lien au tableau si non présent, gère la réallocation. Retourne 0 si succès, -1 si la mémoire manque.
+int add_link(t_link_array *arr, int source_id, int dest_id);
 
 //Libère la mémoire allouée pour le tableau de liens.
 
@@ -33,11 +33,11 @@ void free_link_array(t_link_array *arr);
 //Détermine la nature de chaque classe et met à jour la structure t_partition.
 void analyze_class_types(t_graph graph, t_partition *partition);
 
-//Construit les liens entre classes (Diagramme de Hasse).
+//Construit les liens entre classes (Diagramme de Hasse). Retourne NULL si la partition est vide ou si la mémoire manque.
 t_link_array *compute_hasse_diagram_links(t_graph graph, t_partition partition);
 
-//Génère le fichier Mermaid pour visualiser le Diagramme de Hasse.
-void generate_hasse_mermaid_file(t_link_array *links, const char *output_filename, t_partition partition);
+//Génère le fichier Mermaid pour visualiser le Diagramme de Hasse. Retourne 0 si succès, -1 sinon.
+int generate_hasse_mermaid_file(t_link_array *links, const char *output_filename, t_partition partition);
 
 //Supprime les liens redondants pour obtenir un Diagramme de Hasse strict.
 void remove_transitive_links(t_link_array *links);
@@ -0,0 +1,353 @@
+#include "kronecker.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+#include "markov_check.h"
+
+#define KRON_MAX_LINE 2048
+
+//Chemins des matrices de chaque composante pendant la lecture de la description, et ligne où chacun apparaît.
+typedef struct s_kron_paths {
+    char *path[KRON_MAX_COMPONENTS][KRON_MAX_EVENTS + 1];
+    int line[KRON_MAX_COMPONENTS][KRON_MAX_EVENTS + 1];
+    int count[KRON_MAX_COMPONENTS];
+} t_kron_paths;
+
+static void free_paths(t_kron_paths *paths, int num_components) {
+    for (int c = 0; c < num_components; c++) {
+        for (int k = 0; k < paths->count[c]; k++) free(paths->path[c][k]);
+    }
+}
+
+//add_path : ajoute un chemin aux matrices de la composante c. Retourne son indice, ou -1 si la mémoire manque.
+static int add_path(t_kron_paths *paths, int c, const char *path, int line) {
+    int k = paths->count[c];
+    paths->path[c][k] = strdup(path);
+    if (paths->path[c][k] == NULL) {
+        perror("Allocation failed for composition path");
+        return -1;
+    }
+    paths->line[c][k] = line;
+    paths->count[c]++;
+    return k;
+}
+
+static int find_component(const t_kron_chain *chain, const char *name) {
+    for (int c = 0; c < chain->num_components; c++) {
+        if (strcmp(chain->components[c].name, name) == 0) return c;
+    }
+    return -1;
+}
+
+/*
+   parse_event :
+   "event NOM POIDS C1 C2=FICHIER ..." (tokens suivant "event", découpés par strtok).
+   Chaque composante participe au plus une fois ; une matrice propre à l'événement
+   est ajoutée aux matrices de sa composante.
+*/
+static t_markov_status parse_event(t_kron_chain *chain, t_kron_paths *paths, int line) {
+    const char *name = strtok(NULL, " \t");
+    const char *weight = strtok(NULL, " \t");
+    char *end = NULL;
+    if (name == NULL || weight == NULL || chain->num_events == KRON_MAX_EVENTS) return MARKOV_ERR_FORMAT;
+
+    t_kron_event *event = &chain->events[chain->num_events];
+    snprintf(event->name, KRON_MAX_NAME, "%s", name);
+    event->weight = strtod(weight, &end);
+    if (end == weight || *end != '\0' || !(event->weight > 0.0)) return MARKOV_ERR_FORMAT;
+    for (int c = 0; c < KRON_MAX_COMPONENTS; c++) event->factor[c] = -1;
+
+    int participants = 0;
+    for (char *part = strtok(NULL, " \t"); part != NULL; part = strtok(NULL, " \t")) {
+        char *equal = strchr(part, '=');
+        if (equal != NULL) *equal = '\0';
+        int c = find_component(chain, part);
+        if (c < 0 || event->factor[c] >= 0) return MARKOV_ERR_FORMAT;
+        if (equal == NULL) {
+            event->factor[c] = 0;
+        } else {
+            if (equal[1] == '\0') return MARKOV_ERR_FORMAT;
+            event->factor[c] = add_path(paths, c, equal + 1, line);
+            if (event->factor[c] < 0) return MARKOV_ERR_NOMEM;
+        }
+        participants++;
+    }
+    if (participants == 0) return MARKOV_ERR_FORMAT;
+    chain->num_events++;
+    return MARKOV_OK;
+}
+
+/*
+   parse_description :
+   Lignes "component" et "event", les composantes d'un événement devant être
+   déclarées avant lui. Retourne MARKOV_ERR_FORMAT (ligne dans error_line) si une
+   ligne est invalide.
+*/
+static t_markov_status parse_description(t_kron_chain *chain, t_kron_paths *paths, const char *path, int *error_line) {
+    FILE *file = fopen(path, "rt");
+    if (file == NULL) {
+        perror("Could not open composition file");
+        return MARKOV_ERR_IO;
+    }
+
+    char line[KRON_MAX_LINE];
+    int line_number = 0;
+    t_markov_status status = MARKOV_OK;
+    while (status == MARKOV_OK && fgets(line, sizeof(line), file) != NULL) {
+        line_number++;
+        line[strcspn(line, "\r\n")] = '\0';
+        const char *keyword = strtok(line, " \t");
+        if (keyword == NULL || keyword[0] == '#') continue;
+
+        if (strcmp(keyword, "component") == 0) {
+            const char *name = strtok(NULL, " \t");
+            const char *file_path = strtok(NULL, " \t");
+            int c = chain->num_components;
+            if (name == NULL || file_path == NULL || strtok(NULL, " \t") != NULL || c == KRON_MAX_COMPONENTS
+                || chain->num_events > 0 || find_component(chain, name) >= 0) {
+                status = MARKOV_ERR_FORMAT;
+            } else {
+                snprintf(chain->components[c].name, KRON_MAX_NAME, "%s", name);
+                chain->num_components++;
+                if (add_path(paths, c, file_path, line_number) < 0) status = MARKOV_ERR_NOMEM;
+            }
+        } else if (strcmp(keyword, "event") == 0) {
+            status = parse_event(chain, paths, line_number);
+        } else {
+            status = MARKOV_ERR_FORMAT;
+        }
+        if (status != MARKOV_OK) *error_line = line_number;
+    }
+    fclose(file);
+    if (status == MARKOV_OK && chain->num_components == 0) status = MARKOV_ERR_FORMAT;
+    return status;
+}
+
+/*
+   kron_load :
+   La description est lue d'abord ; les matrices de chaque composante sont ensuite
+   chargées ensemble par sequence_load, qui vérifie qu'elles ont les mêmes états
+   (renumérotés comme le fichier de la composante s'ils sont étiquetés).
+*/
+t_markov_status kron_load(t_kron_chain *chain, const char *path, int *error_line) {
+    t_kron_paths paths;
+    memset(chain, 0, sizeof(*chain));
+    memset(&paths, 0, sizeof(paths));
+    *error_line = 0;
+
+    t_markov_status status = parse_description(chain, &paths, path, error_line);
+    if (status == MARKOV_OK && chain->num_events == 0) {
+        // Produit indépendant : un seul terme, toutes les composantes avancent
+        t_kron_event *event = &chain->events[chain->num_events++];
+        snprintf(event->name, KRON_MAX_NAME, "produit");
+        event->weight = 1.0;
+        for (int c = 0; c < KRON_MAX_COMPONENTS; c++) event->factor[c] = (c < chain->num_components) ? 0 : -1;
+    } else if (status == MARKOV_OK) {
+        chain->synchronized = 1;
+        double total = 0.0;
+        for (int e = 0; e < chain->num_events; e++) total += chain->events[e].weight;
+        if (fabs(total - 1.0) > TOLERANCE) status = MARKOV_ERR_FORMAT;
+    }
+
+    for (int c = 0; c < chain->num_components && status == MARKOV_OK; c++) {
+        int failed;
+        status = sequence_load(&chain->components[c].matrices, paths.path[c], paths.count[c], &failed);
+        if (status != MARKOV_OK) *error_line = paths.line[c][(failed >= 0) ? failed : 0];
+    }
+    free_paths(&paths, chain->num_components);
+
+    // Numérotation des états globaux : la dernière composante varie le plus vite
+    long long states = 1;
+    for (int c = chain->num_components - 1; c >= 0 && status == MARKOV_OK; c--) {
+        chain->components[c].stride = states;
+        states *= chain->components[c].matrices.num_vertices;
+        if (states > INT_MAX) status = MARKOV_ERR_NOMEM;
+    }
+    chain->num_states = states;
+
+    // Les composantes non chargées sont vides : kron_free les libère toutes
+    if (status != MARKOV_OK) kron_free(chain);
+    return status;
+}
+
+void kron_free(t_kron_chain *chain) {
+    for (int c = 0; c < chain->num_components; c++) sequence_free(&chain->components[c].matrices);
+    memset(chain, 0, sizeof(*chain));
+}
+
+double kron_product_edges(const t_kron_chain *chain) {
+    double total = 0.0;
+    for (int e = 0; e < chain->num_events; e++) {
+        double edges = 1.0;
+        for (int c = 0; c < chain->num_components; c++) {
+            const t_chain_sequence *matrices = &chain->components[c].matrices;
+            int f = chain->events[e].factor[c];
+            edges *= (f >= 0) ? (double)matrices->steps[f].num_edges : (double)matrices->num_vertices;
+        }
+        total += edges;
+    }
+    return total;
+}
+
+/*
+   kron_vector_step :
+   Pour chaque terme, x traverse les facteurs des composantes participantes, un mode
+   après l'autre, en alternant les deux moitiés de work ; les composantes qui restent
+   sur place ne coûtent rien. Le mode de la composante c a L = N / (n_c s_c) tranches
+   de R = s_c vecteurs. Avec un seul terme de poids 1 (produit indépendant), le dernier
+   facteur écrit directement dans y.
+*/
+void kron_vector_step(const t_kron_chain *chain, const double *x, double *y, double *work) {
+    size_t N = (size_t)chain->num_states;
+    double *buffers[2] = {work, work + N};
+    int single = (chain->num_events == 1 && chain->events[0].weight == 1.0);
+
+    if (!single) memset(y, 0, N * sizeof(double));
+    for (int e = 0; e < chain->num_events; e++) {
+        const t_kron_event *event = &chain->events[e];
+        int last = -1;
+        for (int c = 0; c < chain->num_components; c++) {
+            if (event->factor[c] >= 0) last = c;
+        }
+
+        const double *cur = x;
+        int which = 0;
+        for (int c = 0; c <= last; c++) {
+            if (event->factor[c] < 0) continue;
+            const t_kron_component *component = &chain->components[c];
+            double *next = (single && c == last) ? y : buffers[which];
+            long long L = chain->num_states / (component->stride * component->matrices.num_vertices);
+            csr_mode_step(&component->matrices.steps[event->factor[c]], cur, next, L, (int)component->stride);
+            cur = next;
+            which ^= 1;
+        }
+
+        if (single) {
+            if (last < 0) memcpy(y, x, N * sizeof(double));
+        } else {
+            double w = event->weight;
+            for (size_t i = 0; i < N; i++) y[i] += w * cur[i];
+        }
+    }
+}
+
+int kron_k_step(const t_kron_chain *chain, const double *x0, int k, double *out) {
+    size_t N = (size_t)chain->num_states;
+    double *buffer = (double *)malloc(3 * N * sizeof(double));
+    if (buffer == NULL) {
+        perror("Allocation failed for Kronecker k-step buffers");
+        return -1;
+    }
+
+    // Le résultat final doit atterrir dans out : le tampon de départ dépend de la parité de k
+    double *tmp = buffer;
+    double *cur = (k % 2 == 0) ? out : tmp;
+    double *next = (k % 2 == 0) ? tmp : out;
+    if (cur != x0) memcpy(cur, x0, N * sizeof(double));
+    for (int step = 0; step < k; step++) {
+        kron_vector_step(chain, cur, next, buffer + N);
+        double *swap = cur;
+        cur = next;
+        next = swap;
+    }
+
+    free(buffer);
+    return 0;
+}
+
+/*
+   kron_stationary :
+   Même itération que la distribution stationnaire d'une classe (sparse.c) :
+   pi devient (pi + pi P) / 2, ramenée à une masse de 1, ce qui converge même si la
+   chaîne produit est périodique (produit de composantes périodiques).
+*/
+int kron_stationary(const t_kron_chain *chain, double *pi, double epsilon, int max_iter, double *diff) {
+    size_t N = (size_t)chain->num_states;
+    double *buffer = (double *)malloc(3 * N * sizeof(double));
+    if (buffer == NULL) {
+        perror("Allocation failed for Kronecker stationary buffers");
+        return -1;
+    }
+    double *next = buffer;
+
+    int iter;
+    *diff = 0.0;
+    for (iter = 1; iter <= max_iter; iter++) {
+        kron_vector_step(chain, pi, next, buffer + N);
+
+        // Les lignes ne somment à 1 qu'à TOLERANCE près : on renormalise pour que la masse ne dérive pas
+        double total = 0.0;
+        for (size_t i = 0; i < N; i++) total += pi[i] + next[i];
+        double scale = (total > 0.0) ? 1.0 / total : 0.5;
+
+        *diff = 0.0;
+        for (size_t i = 0; i < N; i++) {
+            double value = (pi[i] + next[i]) * scale;
+            *diff += fabs(value - pi[i]);
+            pi[i] = value;
+        }
+        if (*diff < epsilon) break;
+    }
+
+    free(buffer);
+    return (iter > max_iter) ? max_iter : iter;
+}
+
+void kron_marginal(const t_kron_chain *chain, const double *x, int c, double *out) {
+    const t_kron_component *component = &chain->components[c];
+    int n = component->matrices.num_vertices;
+    long long R = component->stride;
+    long long L = chain->num_states / (R * n);
+
+    memset(out, 0, n * sizeof(double));
+    for (long long l = 0; l < L; l++) {
+        for (int j = 0; j < n; j++) {
+            const double *slice = x + ((size_t)l * n + j) * R;
+            double sum = 0.0;
+            for (long long r = 0; r < R; r++) sum += slice[r];
+            out[j] += sum;
+        }
+    }
+}
+
+/*
+   kron_find_state :
+   Un état par composante, séparés par ':', chacun cherché dans sa composante
+   (étiquette, ou numéro 1..n_c).
+*/
+long long kron_find_state(const t_kron_chain *chain, const char *text) {
+    char copy[KRON_MAX_LINE];
+    snprintf(copy, sizeof(copy), "%s", text);
+
+    long long index = 0;
+    int c = 0;
+    char *part = copy;
+    while (part != NULL) {
+        char *colon = strchr(part, ':');
+        if (colon != NULL) *colon = '\0';
+        if (c == chain->num_components) return -1;
+        int v = sequence_find_state(&chain->components[c].matrices, part);
+        if (v == 0) return -1;
+        index += (long long)(v - 1) * chain->components[c].stride;
+        c++;
+        part = (colon != NULL) ? colon + 1 : NULL;
+    }
+    return (c == chain->num_components) ? index : -1;
+}
+
+const char *kron_state_name(const t_kron_chain *chain, long long index, char *buffer, size_t size) {
+    size_t used = 0;
+    buffer[0] = '\0';
+    for (int c = 0; c < chain->num_components && used < size; c++) {
+        const t_chain_sequence *matrices = &chain->components[c].matrices;
+        int v = (int)((index / chain->components[c].stride) % matrices->num_vertices) + 1;
+        const char *label = (matrices->labels.count > 0) ? label_name(&matrices->labels, v) : NULL;
+        int written = (label != NULL) ? snprintf(buffer + used, size - used, "%s%s", (c > 0) ? ":" : "", label)
+                                      : snprintf(buffer + used, size - used, "%s%02d", (c > 0) ? ":" : "", v);
+        if (written < 0) break;
+        used += (size_t)written;
+    }
+    return buffer;
+}
@@ -0,0 +1,90 @@
+#ifndef KRONECKER_H
+#define KRONECKER_H
+
+#include <stddef.h>
+#include "sequence.h"
+#include "markov_status.h"
+
+/*
+   Chaînes composées : plusieurs composantes (petites chaînes) dont l'état global est le
+   n-uplet de leurs états, soit n_1 x ... x n_m états. La matrice produit n'est jamais
+   écrite : seules les matrices des composantes sont gardées, et un pas de la chaîne
+   applique x -> x P par l'algorithme de brassage (shuffle), un mode après l'autre
+   (csr_mode_step). Mémoire : les composantes, plus quatre vecteurs de l'espace produit.
+   - Produit indépendant : toutes les composantes avancent à chaque pas,
+     P = P_1 ⊗ ... ⊗ P_m.
+   - Événements synchronisés : à chaque pas, un événement e est tiré avec la probabilité
+     w_e ; les composantes qu'il fait participer avancent ensemble, chacune par sa matrice
+     pour e, les autres restent sur place : P = somme des w_e (M_e1 ⊗ ... ⊗ M_em),
+     M_ec = I si c ne participe pas. Un événement à une seule composante est local.
+   Fichier de description (lignes vides et '#' ignorées, chemins tels qu'écrits) :
+       component NOM FICHIER            une ligne par composante, dans l'ordre du n-uplet
+       event NOM POIDS C1 C2=FICHIER    composantes participantes : C1 avance par la
+                                        matrice de sa ligne component, C2 par FICHIER
+   Sans ligne event, la chaîne est le produit indépendant. Les poids des événements
+   doivent sommer à 1 (à TOLERANCE près). L'état global (i_1, ..., i_m) a le numéro
+   i_1 s_1 + ... + i_m s_m (0-based), la dernière composante variant le plus vite.
+*/
+
+//Composantes et événements au plus, longueur des noms.
+#define KRON_MAX_COMPONENTS 16
+#define KRON_MAX_EVENTS 64
+#define KRON_MAX_NAME 64
+
+//Composante : ses états et ses matrices (celle de sa ligne component, puis celles des événements qui en donnent une).
+typedef struct s_kron_component {
+    char name[KRON_MAX_NAME];
+    t_chain_sequence matrices;  // steps[0] : matrice de la composante ; étiquettes du fichier de la composante
+    long long stride;           // Pas du numéro global quand l'état de la composante augmente de 1
+} t_kron_component;
+
+//Terme de la somme : événement synchronisé, ou produit indépendant (un seul terme de poids 1).
+typedef struct s_kron_event {
+    char name[KRON_MAX_NAME];
+    double weight;
+    int factor[KRON_MAX_COMPONENTS]; // Par composante : indice de sa matrice (matrices.steps), -1 si elle reste sur place
+} t_kron_event;
+
+//Chaîne composée.
+typedef struct s_kron_chain {
+    int num_components;
+    t_kron_component components[KRON_MAX_COMPONENTS];
+    int num_events;
+    t_kron_event events[KRON_MAX_EVENTS];
+    int synchronized;           // 0 : produit indépendant (un seul terme, sans ligne event)
+    long long num_states;       // n_1 x ... x n_m
+} t_kron_chain;
+
+//Lit la description path et charge les matrices des composantes (lues et vérifiées comme par markov_load_file et
+//markov_check ; les matrices d'événement doivent avoir les états de leur composante). En cas d'erreur, error_line reçoit
+//la ligne fautive (0 si l'erreur ne tient pas à une ligne). MARKOV_ERR_FORMAT pour une description invalide,
+//MARKOV_ERR_NOMEM si l'espace produit dépasse INT_MAX états ou la mémoire.
+t_markov_status kron_load(t_kron_chain *chain, const char *path, int *error_line);
+
+//Libère la chaîne (qui redevient vide).
+void kron_free(t_kron_chain *chain);
+
+//Arêtes de la matrice produit si elle était écrite (somme, sur les termes, des produits des arêtes des facteurs).
+double kron_product_edges(const t_kron_chain *chain);
+
+//Pas de la chaîne : y = x P (num_states cases). work : tampon de 2 num_states cases. x, y et work doivent être distincts.
+void kron_vector_step(const t_kron_chain *chain, const double *x, double *y, double *work);
+
+//Distribution après k pas : out = x0 P^k (out peut être x0). Retourne 0, ou -1 si la mémoire manque.
+int kron_k_step(const t_kron_chain *chain, const double *x0, int k, double *out);
+
+//Distribution limite en partant de pi (moyenne de Cesàro), par itération de la chaîne paresseuse (I + P) / 2
+//renormalisée. diff reçoit le dernier écart sum(|pi_k - pi_(k-1)|) (convergence si diff < epsilon). Retourne le nombre
+//d'itérations, -1 si la mémoire manque.
+int kron_stationary(const t_kron_chain *chain, double *pi, double epsilon, int max_iter, double *diff);
+
+//Loi de la composante c sous la distribution x : out (n_c cases) reçoit la somme des x des états globaux de chaque état de c.
+void kron_marginal(const t_kron_chain *chain, const double *x, int c, double *out);
+
+//Numéro global de l'état "e_1:e_2:...:e_m" (étiquettes, ou numéros 1..n_c, de chaque composante), -1 s'il n'existe pas.
+long long kron_find_state(const t_kron_chain *chain, const char *text);
+
+//Nom "e_1:e_2:...:e_m" de l'état global index (étiquettes, ou numéros 1..n_c, de chaque composante).
+const char *kron_state_name(const t_kron_chain *chain, long long index, char *buffer, size_t size);
+
+#endif // KRONECKER_H
@@ -0,0 +1,146 @@
+#include "labels.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LABEL_INITIAL_SLOTS 1024
+#define LABEL_INITIAL_TEXT 8192
+
+void label_table_init(t_label_table *table) {
+    memset(table, 0, sizeof(*table));
+}
+
+void label_table_free(t_label_table *table) {
+    free(table->slots);
+    free(table->hashes);
+    free(table->offsets);
+    free(table->text);
+    label_table_init(table);
+}
+
+/*
+   hash_label :
+   Haché 64 bits lu par mots de 8 octets (multiplication puis repli), terminé par le
+   mélange final de splitmix64 : les étiquettes qui ne diffèrent que par leurs derniers
+   chiffres (identifiants consécutifs) tombent dans des cases éloignées.
+*/
+static uint64_t hash_label(const char *label, size_t length) {
+    uint64_t h = 0x9E3779B97F4A7C15ULL ^ (length * 0xC2B2AE3D27D4EB4FULL);
+    size_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+        uint64_t word;
+        memcpy(&word, label + i, 8);
+        h = (h ^ word) * 0xBF58476D1CE4E5B9ULL;
+        h ^= h >> 31;
+    }
+    uint64_t tail = 0;
+    for (size_t j = 0; i + j < length; j++) tail |= (uint64_t)(unsigned char)label[i + j] << (8 * j);
+    h = (h ^ tail) * 0x94D049BB133111EBULL;
+
+    h ^= h >> 30;
+    h *= 0xBF58476D1CE4E5B9ULL;
+    h ^= h >> 27;
+    h *= 0x94D049BB133111EBULL;
+    h ^= h >> 31;
+    return h;
+}
+
+//same_label : l'étiquette id vaut-elle label (length octets) ?
+static int same_label(const t_label_table *table, int id, const char *label, size_t length) {
+    const char *stored = table->text + table->offsets[id - 1];
+    return memcmp(stored, label, length) == 0 && stored[length] == '\0';
+}
+
+//lookup : case de l'étiquette si elle est présente, sinon première case libre de sa séquence de sondage.
+static size_t lookup(const t_label_table *table, const char *label, size_t length, uint64_t h) {
+    size_t mask = (size_t)table->capacity - 1;
+    size_t slot = (size_t)h & mask;
+    while (table->slots[slot] != 0) {
+        int id = table->slots[slot];
+        if (table->hashes[id - 1] == h && same_label(table, id, label, length)) break;
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+/*
+   grow_slots :
+   Double la table de hachage et y replace chaque étiquette à partir de son haché
+   mémorisé (aucun texte relu).
+*/
+static int grow_slots(t_label_table *table) {
+    int capacity = (table->capacity == 0) ? LABEL_INITIAL_SLOTS : 2 * table->capacity;
+    int *slots = (int *)calloc(capacity, sizeof(int));
+    if (slots == NULL) {
+        perror("Allocation failed for label slots");
+        return -1;
+    }
+
+    size_t mask = (size_t)capacity - 1;
+    for (int id = 1; id <= table->count; id++) {
+        size_t slot = (size_t)table->hashes[id - 1] & mask;
+        while (slots[slot] != 0) slot = (slot + 1) & mask;
+        slots[slot] = id;
+    }
+    free(table->slots);
+    table->slots = slots;
+    table->capacity = capacity;
+    return 0;
+}
+
+//reserve : place pour une étiquette de plus (numéro, haché, début) et length + 1 octets de texte.
+static int reserve(t_label_table *table, size_t length) {
+    if (table->count == table->ids_capacity) {
+        int ids_capacity = (table->ids_capacity == 0) ? LABEL_INITIAL_SLOTS / 2 : 2 * table->ids_capacity;
+        uint64_t *hashes = (uint64_t *)realloc(table->hashes, ids_capacity * sizeof(uint64_t));
+        if (hashes != NULL) table->hashes = hashes;
+        size_t *offsets = (hashes != NULL) ? (size_t *)realloc(table->offsets, ids_capacity * sizeof(size_t)) : NULL;
+        if (offsets == NULL) {
+            perror("Allocation failed for labels");
+            return -1;
+        }
+        table->offsets = offsets;
+        table->ids_capacity = ids_capacity;
+    }
+    if (table->text_used + length + 1 > table->text_capacity) {
+        size_t text_capacity = (table->text_capacity == 0) ? LABEL_INITIAL_TEXT : 2 * table->text_capacity;
+        while (table->text_used + length + 1 > text_capacity) text_capacity *= 2;
+        char *text = (char *)realloc(table->text, text_capacity);
+        if (text == NULL) {
+            perror("Allocation failed for label text");
+            return -1;
+        }
+        table->text = text;
+        table->text_capacity = text_capacity;
+    }
+    return 0;
+}
+
+int label_intern(t_label_table *table, const char *label, size_t length) {
+    if (2 * (table->count + 1) > table->capacity && grow_slots(table) != 0) return -1;
+
+    uint64_t h = hash_label(label, length);
+    size_t slot = lookup(table, label, length, h);
+    if (table->slots[slot] != 0) return table->slots[slot];
+
+    if (reserve(table, length) != 0) return -1;
+    int id = ++table->count;
+    table->hashes[id - 1] = h;
+    table->offsets[id - 1] = table->text_used;
+    memcpy(table->text + table->text_used, label, length);
+    table->text[table->text_used + length] = '\0';
+    table->text_used += length + 1;
+    table->slots[slot] = id;
+    return id;
+}
+
+int label_find(const t_label_table *table, const char *label) {
+    if (table->count == 0 || label == NULL) return 0;
+    size_t length = strlen(label);
+    return table->slots[lookup(table, label, length, hash_label(label, length))];
+}
+
+const char *label_name(const t_label_table *table, int id) {
+    if (id < 1 || id > table->count) return NULL;
+    return table->text + table->offsets[id - 1];
+}
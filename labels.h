@@ -0,0 +1,44 @@
+#ifndef LABELS_H
+#define LABELS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+   Table d'internement des étiquettes d'états.
+   Un fichier étiqueté nomme ses états par des mots quelconques (identifiants 64 bits
+   creux, noms) : chaque étiquette reçoit, à sa première apparition, le numéro dense
+   suivant (1, 2, ...), utilisé ensuite par toute l'analyse. Table de hachage à
+   adressage ouvert (sondage linéaire, taux de remplissage d'au plus 1/2) ; les
+   étiquettes sont rangées à la suite dans un seul tampon.
+*/
+
+//Table vide (count = 0) : les états sont désignés par leur numéro.
+typedef struct s_label_table {
+    int count;               // Étiquettes internées, numérotées de 1 à count
+    int capacity;            // Cases de la table de hachage (puissance de 2)
+    int *slots;              // capacity cases : numéro de l'étiquette, 0 si la case est libre
+    int ids_capacity;        // Cases allouées de hashes et offsets
+    uint64_t *hashes;        // Haché de chaque étiquette (comparé avant le texte, réutilisé en cas d'agrandissement)
+    size_t *offsets;         // Début de chaque étiquette dans text
+    char *text;              // Étiquettes terminées par '\0', à la suite
+    size_t text_used;
+    size_t text_capacity;
+} t_label_table;
+
+//Initialise une table vide.
+void label_table_init(t_label_table *table);
+
+//Libère la table (qui redevient vide).
+void label_table_free(t_label_table *table);
+
+//Numéro de l'étiquette (length octets, sans '\0' nécessaire), ajoutée si elle est nouvelle. Retourne -1 si la mémoire manque.
+int label_intern(t_label_table *table, const char *label, size_t length);
+
+//Numéro de l'étiquette, 0 si elle n'a pas été internée.
+int label_find(const t_label_table *table, const char *label);
+
+//Étiquette numéro id (1..count), NULL si hors bornes.
+const char *label_name(const t_label_table *table, int id);
+
+#endif // LABELS_H
@@ -0,0 +1,553 @@
+#include "local_push.h"
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#define PUSH_INITIAL_SLOTS 256
+
+//Arêtes parcourues avant la première recherche de masse piégée (find_trapped).
+#define PUSH_TRAP_FIRST_CHECK 4096
+
+//États touchés par une poussée : table de hachage sommet -> indice, masses résiduelles et file des états à pousser.
+typedef struct s_push_state {
+    int capacity;              // Cases de la table (puissance de 2)
+    int *slots;                // Indice + 1 de l'état touché, 0 si la case est libre
+    int count;                 // États touchés
+    int *vertices;             // capacity / 2 cases : sommet (1-based) de chaque état touché
+    double *residual;          // Masse résiduelle de chaque état touché
+    double *settled;           // Poussée arrière : masse déjà poussée depuis l'état (estimation p)
+    double *scale;             // Poussée arrière : 1 / somme des probabilités sortantes hors boucle, 0 tant qu'elle n'est pas calculée
+    unsigned char *queued;     // 1 si l'état est dans la file
+    unsigned char *trapped;    // 1 si l'état ne peut plus atteindre la cible (find_trapped)
+    int *queue;                // File circulaire d'indices (capacity / 2 cases)
+    int head;
+    int size;
+} t_push_state;
+
+static void push_state_free(t_push_state *state) {
+    free(state->slots);
+    free(state->vertices);
+    free(state->residual);
+    free(state->settled);
+    free(state->scale);
+    free(state->queued);
+    free(state->trapped);
+    free(state->queue);
+    memset(state, 0, sizeof(*state));
+}
+
+//slot_of : case du sommet v dans la table, ou première case libre de sa séquence de sondage.
+static size_t slot_of(const t_push_state *state, int v) {
+    size_t mask = (size_t)state->capacity - 1;
+    size_t slot = ((uint32_t)v * 0x9E3779B1u) & mask;
+    while (state->slots[slot] != 0 && state->vertices[state->slots[slot] - 1] != v) slot = (slot + 1) & mask;
+    return slot;
+}
+
+/*
+   grow_state :
+   Double la table et les tableaux des états touchés ; la file est recopiée à partir
+   de sa tête pour rester contiguë.
+*/
+static int grow_state(t_push_state *state) {
+    int capacity = (state->capacity == 0) ? PUSH_INITIAL_SLOTS : 2 * state->capacity;
+    int half = capacity / 2;
+    int *slots = (int *)calloc(capacity, sizeof(int));
+    int *vertices = (int *)malloc(half * sizeof(int));
+    double *residual = (double *)malloc(half * sizeof(double));
+    double *settled = (double *)malloc(half * sizeof(double));
+    double *scale = (double *)malloc(half * sizeof(double));
+    unsigned char *queued = (unsigned char *)malloc(half);
+    unsigned char *trapped = (unsigned char *)malloc(half);
+    int *queue = (int *)malloc(half * sizeof(int));
+    if (slots == NULL || vertices == NULL || residual == NULL || settled == NULL || scale == NULL || queued == NULL
+        || trapped == NULL || queue == NULL) {
+        perror("Allocation failed for local push");
+        free(slots);
+        free(vertices);
+        free(residual);
+        free(settled);
+        free(scale);
+        free(queued);
+        free(trapped);
+        free(queue);
+        return -1;
+    }
+
+    int old_half = state->capacity / 2;
+    if (state->count > 0) {
+        memcpy(vertices, state->vertices, state->count * sizeof(int));
+        memcpy(residual, state->residual, state->count * sizeof(double));
+        memcpy(settled, state->settled, state->count * sizeof(double));
+        memcpy(scale, state->scale, state->count * sizeof(double));
+        memcpy(queued, state->queued, state->count);
+        memcpy(trapped, state->trapped, state->count);
+    }
+    for (int k = 0; k < state->size; k++) queue[k] = state->queue[(state->head + k) % old_half];
+
+    free(state->slots);
+    free(state->vertices);
+    free(state->residual);
+    free(state->settled);
+    free(state->scale);
+    free(state->queued);
+    free(state->trapped);
+    free(state->queue);
+    state->slots = slots;
+    state->vertices = vertices;
+    state->residual = residual;
+    state->settled = settled;
+    state->scale = scale;
+    state->queued = queued;
+    state->trapped = trapped;
+    state->queue = queue;
+    state->capacity = capacity;
+    state->head = 0;
+    for (int i = 0; i < state->count; i++) state->slots[slot_of(state, vertices[i])] = i + 1;
+    return 0;
+}
+
+//touch : indice de l'état v, ajouté avec une masse nulle s'il n'a pas encore été touché. Retourne -1 si la mémoire manque.
+static int touch(t_push_state *state, int v) {
+    if (2 * (state->count + 1) > state->capacity && grow_state(state) != 0) return -1;
+    size_t slot = slot_of(state, v);
+    if (state->slots[slot] != 0) return state->slots[slot] - 1;
+
+    int i = state->count++;
+    state->vertices[i] = v;
+    state->residual[i] = 0.0;
+    state->settled[i] = 0.0;
+    state->scale[i] = 0.0;
+    state->queued[i] = 0;
+    state->trapped[i] = 0;
+    state->slots[slot] = i + 1;
+    return i;
+}
+
+static void enqueue(t_push_state *state, int i) {
+    int half = state->capacity / 2;
+    state->queue[(state->head + state->size) % half] = i;
+    state->size++;
+    state->queued[i] = 1;
+}
+
+static int dequeue(t_push_state *state) {
+    int i = state->queue[state->head];
+    state->head = (state->head + 1) % (state->capacity / 2);
+    state->size--;
+    state->queued[i] = 0;
+    return i;
+}
+
+//is_sink : v fait-il partie de la cible (tableau trié) ?
+static int is_sink(const int *sinks, int num_sinks, int v) {
+    int low = 0, high = num_sinks - 1;
+    while (low <= high) {
+        int mid = (low + high) / 2;
+        if (sinks[mid] == v) return 1;
+        if (sinks[mid] < v) low = mid + 1;
+        else high = mid - 1;
+    }
+    return 0;
+}
+
+/*
+   sort_targets :
+   Copie triée des cibles (recherche dichotomique à chaque arrivée), par insertion :
+   elles sont en général peu nombreuses. Retourne NULL si un état est hors bornes
+   (*status = MARKOV_ERR_ARGUMENT) ou si la mémoire manque.
+*/
+static int *sort_targets(const int *targets, int num_targets, int num_vertices, t_markov_status *status) {
+    int *sinks = (int *)malloc(num_targets * sizeof(int));
+    if (sinks == NULL) {
+        perror("Allocation failed for local push targets");
+        *status = MARKOV_ERR_NOMEM;
+        return NULL;
+    }
+    for (int k = 0; k < num_targets; k++) {
+        int v = targets[k];
+        if (v < 1 || v > num_vertices) {
+            free(sinks);
+            *status = MARKOV_ERR_ARGUMENT;
+            return NULL;
+        }
+        int m = k;
+        while (m > 0 && sinks[m - 1] > v) {
+            sinks[m] = sinks[m - 1];
+            m--;
+        }
+        sinks[m] = v;
+    }
+    *status = MARKOV_OK;
+    return sinks;
+}
+
+/*
+   find_trapped :
+   Un état touché qui n'a aucun chemin, dans les états touchés, vers la cible ou vers
+   un état pas encore touché (au-delà duquel la cible reste possible) n'atteindra
+   jamais la cible : avec tous ses successeurs, il est dans un ensemble fermé sans la
+   cible (classe persistante de plusieurs états, pas seulement un état absorbant). Les
+   états qui mènent à la cible sont trouvés par un parcours en arrière sur les arêtes
+   entre états touchés, depuis ceux qui ont une arête vers la cible ou hors des états
+   touchés. Les autres sont marqués piégés et leur masse résiduelle ajoutée à lost.
+   Retourne le nombre d'arêtes parcourues, -1 si la mémoire manque.
+*/
+static long long find_trapped(t_push_state *state, t_graph graph, const int *sinks, int num_sinks, double *lost) {
+    int count = state->count;
+    unsigned char *live = (unsigned char *)calloc(count, 1);
+    int *in_ptr = (int *)calloc(count + 1, sizeof(int));
+    int *stack = (int *)malloc(count * sizeof(int));
+    int *in_src = NULL;
+    if (live == NULL || in_ptr == NULL || stack == NULL) {
+        perror("Allocation failed for local push trap search");
+        free(live);
+        free(in_ptr);
+        free(stack);
+        return -1;
+    }
+
+    // Vivants : la cible, et les états qui ont une arête vers elle ou hors des états touchés
+    long long edges = 0;
+    for (int i = 0; i < count; i++) {
+        if (state->trapped[i]) continue;
+        int v = state->vertices[i];
+        if (is_sink(sinks, num_sinks, v)) live[i] = 1;
+        for (t_edge *e = graph.adj_lists[v - 1].head; e != NULL && !live[i]; e = e->next) {
+            edges++;
+            if (state->slots[slot_of(state, e->destination)] == 0 || is_sink(sinks, num_sinks, e->destination)) live[i] = 1;
+        }
+    }
+    // Arêtes issues des autres états (toutes vers des états touchés), comptées par état d'arrivée
+    for (int i = 0; i < count; i++) {
+        if (state->trapped[i] || live[i]) continue;
+        for (t_edge *e = graph.adj_lists[state->vertices[i] - 1].head; e != NULL; e = e->next) {
+            int j = state->slots[slot_of(state, e->destination)] - 1;
+            if (!state->trapped[j]) in_ptr[j + 1]++;
+        }
+    }
+    for (int i = 0; i < count; i++) in_ptr[i + 1] += in_ptr[i];
+    in_src = (int *)malloc((in_ptr[count] > 0 ? in_ptr[count] : 1) * sizeof(int));
+    if (in_src == NULL) {
+        perror("Allocation failed for local push trap search");
+        free(live);
+        free(in_ptr);
+        free(stack);
+        return -1;
+    }
+    for (int i = 0; i < count; i++) {
+        if (state->trapped[i] || live[i]) continue;
+        for (t_edge *e = graph.adj_lists[state->vertices[i] - 1].head; e != NULL; e = e->next) {
+            int j = state->slots[slot_of(state, e->destination)] - 1;
+            if (!state->trapped[j]) in_src[in_ptr[j]++] = i;
+        }
+    }
+    // in_ptr[j] pointe maintenant sur la fin des arêtes entrantes de j : début = in_ptr[j - 1]
+    int top = 0;
+    for (int i = 0; i < count; i++) {
+        if (live[i]) stack[top++] = i;
+    }
+    while (top > 0) {
+        int j = stack[--top];
+        for (int k = (j > 0) ? in_ptr[j - 1] : 0; k < in_ptr[j]; k++) {
+            int i = in_src[k];
+            if (!live[i]) {
+                live[i] = 1;
+                stack[top++] = i;
+            }
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        if (!live[i] && !state->trapped[i]) {
+            state->trapped[i] = 1;
+            *lost += state->residual[i];
+            state->residual[i] = 0.0;
+        }
+    }
+
+    edges += 2LL * in_ptr[count - 1];
+    free(live);
+    free(in_ptr);
+    free(stack);
+    free(in_src);
+    return edges;
+}
+
+/*
+   run_push :
+   Pousse la masse 1 posée sur start jusqu'à ce qu'aucun état ne garde plus de
+   epsilon, ou que le budget soit épuisé. Chaque ligne est ramenée à une somme de 1
+   (les sommes lues ne valent 1 qu'à TOLERANCE près) : la masse poussée est exactement
+   celle qui sort de u, et aucune poussée n'en crée ni n'en détruit. Une boucle u -> u
+   est sommée en série géométrique : la masse sort de u en une poussée, partagée entre
+   les autres arêtes au prorata de leurs probabilités, avec r(u) / (1 - P(u, u)) pas
+   (P(u, u) de la ligne ramenée à 1). La masse d'un état absorbant hors de la cible est
+   perdue (elle n'arrivera jamais), comme celle qui entre dans un ensemble fermé sans la
+   cible : find_trapped le cherche chaque fois que les arêtes parcourues ont augmenté du
+   double du coût de sa recherche précédente (au plus un tiers du travail total), et
+   une dernière fois à la fin s'il reste de la masse.
+   arrived, steps et lost reçoivent la masse arrivée, les pas comptés (S) et la masse
+   perdue ; avec stop_on_loss, la première masse perdue arrête la poussée. La masse
+   initiale de start est poussée même si start est dans la cible (temps de retour).
+*/
+static t_markov_status run_push(t_graph graph, int start, const int *sinks, int num_sinks, double epsilon,
+                                long long max_pushes, int stop_on_loss, double *arrived, double *steps, double *lost,
+                                t_push_result *result) {
+    t_push_state state;
+    memset(&state, 0, sizeof(state));
+    *arrived = 0.0;
+    *steps = 0.0;
+    *lost = 0.0;
+
+    int first = touch(&state, start);
+    if (first < 0) return MARKOV_ERR_NOMEM;
+    state.residual[first] = 1.0;
+    enqueue(&state, first);
+
+    double threshold = fmax(PUSH_FIRST_THRESHOLD, epsilon);
+    long long pushes = 0, edges = 0, next_check = PUSH_TRAP_FIRST_CHECK;
+    int done = 0;
+    t_markov_status status = MARKOV_OK;
+    while (status == MARKOV_OK && !done && pushes < max_pushes && !(stop_on_loss && *lost > 0.0)) {
+        if (edges >= next_check) {
+            long long cost = find_trapped(&state, graph, sinks, num_sinks, lost);
+            if (cost < 0) {
+                status = MARKOV_ERR_NOMEM;
+                break;
+            }
+            next_check = edges + ((2 * cost > PUSH_TRAP_FIRST_CHECK) ? 2 * cost : PUSH_TRAP_FIRST_CHECK);
+            continue;
+        }
+        if (state.size == 0) {
+            // File vide : seuil abaissé, jusqu'à epsilon
+            done = (threshold <= epsilon);
+            threshold = fmax(threshold / PUSH_THRESHOLD_FACTOR, epsilon);
+            for (int i = 0; i < state.count && !done; i++) {
+                if (state.residual[i] > threshold) enqueue(&state, i);
+            }
+            continue;
+        }
+
+        int i = dequeue(&state);
+        int u = state.vertices[i];
+        double mass = state.residual[i];
+        state.residual[i] = 0.0;
+        if (state.trapped[i]) {
+            *lost += mass;
+            continue;
+        }
+        pushes++;
+
+        // Masse sur la boucle u -> u (sauf pour start dans la cible, qui part toujours) et sur les autres arêtes
+        double self_loop = 0.0, out_sum = 0.0;
+        int skip_loop = !is_sink(sinks, num_sinks, u);
+        for (t_edge *e = graph.adj_lists[u - 1].head; e != NULL; e = e->next) {
+            if (skip_loop && e->destination == u) self_loop += e->probability;
+            else out_sum += e->probability;
+        }
+        if (!(out_sum > 0.0)) {
+            *lost += mass;
+            *steps += mass;
+            continue;
+        }
+        double leaving = mass / out_sum;
+        *steps += mass * (self_loop + out_sum) / out_sum;
+
+        for (t_edge *e = graph.adj_lists[u - 1].head; e != NULL; e = e->next) {
+            int w = e->destination;
+            edges++;
+            if (skip_loop && w == u) continue;
+            double share = leaving * e->probability;
+            if (is_sink(sinks, num_sinks, w)) {
+                *arrived += share;
+                continue;
+            }
+            int j = touch(&state, w);
+            if (j < 0) {
+                status = MARKOV_ERR_NOMEM;
+                break;
+            }
+            if (state.trapped[j]) {
+                *lost += share;
+                continue;
+            }
+            state.residual[j] += share;
+            if (!state.queued[j] && state.residual[j] > threshold) enqueue(&state, j);
+        }
+    }
+
+    double remaining = 0.0;
+    for (int i = 0; i < state.count; i++) remaining += state.residual[i];
+    if (status == MARKOV_OK && remaining > 0.0 && !(stop_on_loss && *lost > 0.0)) {
+        if (find_trapped(&state, graph, sinks, num_sinks, lost) < 0) status = MARKOV_ERR_NOMEM;
+        remaining = 0.0;
+        for (int i = 0; i < state.count; i++) remaining += state.residual[i];
+        if (remaining == 0.0) done = 1;
+    }
+    result->residual = remaining;
+    result->pushes = pushes;
+    result->edges = edges;
+    result->touched = state.count;
+    result->converged = done;
+    push_state_free(&state);
+    return status;
+}
+
+/*
+   push_hitting_probability :
+   Cible triée une fois (sort_targets). La masse perdue dans
+   un état absorbant ou un ensemble fermé hors de la cible compte pour 0, ce qui est
+   exact.
+*/
+t_markov_status push_hitting_probability(t_graph graph, int source, const int *targets, int num_targets, double epsilon,
+                                         long long max_pushes, t_push_result *result) {
+    if (result == NULL || targets == NULL || num_targets <= 0 || source < 1 || source > graph.num_vertices || !(epsilon > 0.0)) {
+        return MARKOV_ERR_ARGUMENT;
+    }
+    memset(result, 0, sizeof(*result));
+
+    t_markov_status status;
+    int *sinks = sort_targets(targets, num_targets, graph.num_vertices, &status);
+    if (sinks == NULL) return status;
+
+    if (is_sink(sinks, num_targets, source)) {
+        free(sinks);
+        result->estimate = result->lower = result->upper = 1.0;
+        result->converged = 1;
+        return MARKOV_OK;
+    }
+
+    double arrived, steps, lost;
+    status = run_push(graph, source, sinks, num_targets, epsilon, max_pushes, 0, &arrived, &steps, &lost, result);
+    free(sinks);
+    if (status != MARKOV_OK) return status;
+
+    result->lower = fmin(1.0, arrived);
+    result->upper = fmin(1.0, arrived + result->residual);
+    result->estimate = (result->lower + result->upper) / 2.0;
+    return MARKOV_OK;
+}
+
+/*
+   push_stationary :
+   La cible est v lui-même : la masse qui y revient s'arrête. Si de la masse est
+   perdue (état absorbant ou ensemble fermé sans v), v ne la reverra jamais : v est
+   transitoire et sa probabilité stationnaire est nulle.
+*/
+t_markov_status push_stationary(t_graph graph, int v, double epsilon, long long max_pushes, t_push_result *result) {
+    if (result == NULL || v < 1 || v > graph.num_vertices || !(epsilon > 0.0)) return MARKOV_ERR_ARGUMENT;
+    memset(result, 0, sizeof(*result));
+
+    double arrived, steps, lost;
+    t_markov_status status = run_push(graph, v, &v, 1, epsilon, max_pushes, 1, &arrived, &steps, &lost, result);
+    if (status != MARKOV_OK) return status;
+
+    if (lost > 0.0) {
+        result->estimate = result->lower = result->upper = 0.0;
+        result->converged = 1;
+        return MARKOV_OK;
+    }
+    result->upper = (steps > 0.0) ? fmin(1.0, 1.0 / steps) : 1.0;
+    result->estimate = (steps > 0.0) ? fmin(arrived / steps, result->upper) : 0.0;
+    result->lower = (result->residual == 0.0) ? result->estimate : 0.0;
+    return MARKOV_OK;
+}
+
+/*
+   push_hitting_backward :
+   h = 1 sur la cible, h(u) = somme des A(u, w) h(w) ailleurs, A étant P sans la boucle
+   u -> u, chaque ligne ramenée à une somme de 1 (comme en avant). Invariant :
+   h = p + somme des A^k r, p et r positifs. Pousser w : p(w) += r(w), puis chaque
+   prédécesseur u de w (ligne w de PT) hors de la cible reçoit A(u, w) r(w). Au départ
+   r = 1 sur la cible. Le facteur 1 / somme des probabilités sortantes de u est
+   calculé une fois, quand u est touché. p(s) minore donc h(s), et l'écart est la masse
+   résiduelle qui atteindrait encore s : au plus epsilon fois le nombre moyen de visites
+   des états touchés avant la cible. Chaque poussée ajoute plus de epsilon à un p(w)
+   <= 1 : il y en a au plus (états touchés) / epsilon.
+*/
+t_markov_status push_hitting_backward(t_graph graph, const t_csr *PT, const int *targets, int num_targets,
+                                      const int *sources, int num_sources, double epsilon, long long max_pushes,
+                                      t_push_result *results) {
+    if (PT == NULL || PT->row_ptr == NULL || PT->num_vertices != graph.num_vertices || results == NULL || targets == NULL
+        || num_targets <= 0 || sources == NULL || num_sources <= 0 || !(epsilon > 0.0)) {
+        return MARKOV_ERR_ARGUMENT;
+    }
+    for (int k = 0; k < num_sources; k++) {
+        if (sources[k] < 1 || sources[k] > graph.num_vertices) return MARKOV_ERR_ARGUMENT;
+    }
+    t_markov_status status;
+    int *sinks = sort_targets(targets, num_targets, graph.num_vertices, &status);
+    if (sinks == NULL) return status;
+
+    t_push_state state;
+    memset(&state, 0, sizeof(state));
+    for (int k = 0; k < num_targets && status == MARKOV_OK; k++) {
+        int i = touch(&state, sinks[k]);
+        if (i < 0) status = MARKOV_ERR_NOMEM;
+        else if (!state.queued[i]) {
+            state.residual[i] = 1.0;
+            enqueue(&state, i);
+        }
+    }
+
+    double threshold = fmax(PUSH_FIRST_THRESHOLD, epsilon);
+    long long pushes = 0, edges = 0;
+    int done = 0;
+    while (status == MARKOV_OK && !done && pushes < max_pushes) {
+        if (state.size == 0) {
+            done = (threshold <= epsilon);
+            threshold = fmax(threshold / PUSH_THRESHOLD_FACTOR, epsilon);
+            for (int i = 0; i < state.count && !done; i++) {
+                if (state.residual[i] > threshold) enqueue(&state, i);
+            }
+            continue;
+        }
+
+        int i = dequeue(&state);
+        int w = state.vertices[i];
+        double mass = state.residual[i];
+        state.residual[i] = 0.0;
+        state.settled[i] += mass;
+        pushes++;
+
+        for (int e = PT->row_ptr[w - 1]; e < PT->row_ptr[w]; e++) {
+            int u = PT->col_idx[e] + 1;
+            edges++;
+            if (u == w || is_sink(sinks, num_targets, u)) continue;
+            int j = touch(&state, u);
+            if (j < 0) {
+                status = MARKOV_ERR_NOMEM;
+                break;
+            }
+            if (state.scale[j] == 0.0) {
+                // Premier passage par u : somme de ses probabilités sortantes hors boucle
+                double out_sum = 0.0;
+                for (t_edge *out = graph.adj_lists[u - 1].head; out != NULL; out = out->next) {
+                    if (out->destination != u) out_sum += out->probability;
+                }
+                state.scale[j] = (out_sum > 0.0) ? 1.0 / out_sum : 0.0;
+            }
+            state.residual[j] += mass * PT->values[e] * state.scale[j];
+            if (!state.queued[j] && state.residual[j] > threshold) enqueue(&state, j);
+        }
+    }
+
+    double remaining = 0.0;
+    for (int i = 0; i < state.count; i++) remaining += state.residual[i];
+    for (int k = 0; status == MARKOV_OK && k < num_sources; k++) {
+        t_push_result *result = &results[k];
+        memset(result, 0, sizeof(*result));
+        int i = state.slots[slot_of(&state, sources[k])] - 1;
+        result->lower = (i >= 0) ? fmin(1.0, state.settled[i]) : 0.0;
+        result->estimate = result->lower;
+        result->upper = 1.0;
+        result->residual = remaining;
+        result->pushes = pushes;
+        result->edges = edges;
+        result->touched = state.count;
+        result->converged = done;
+    }
+    push_state_free(&state);
+    free(sinks);
+    return status;
+}
@@ -0,0 +1,74 @@
+#ifndef LOCAL_PUSH_H
+#define LOCAL_PUSH_H
+
+#include "graph.h"
+#include "sparse.h"
+#include "markov_status.h"
+
+/*
+   Estimations locales par poussée (push) sur la liste d'adjacence, sans analyse globale.
+   Une masse part d'un état ; pousser un état u envoie sa masse résiduelle r(u) à ses
+   successeurs, P(u, w) r(u) chacun. La masse qui atteint la cible (ensemble d'états, ou
+   retour à l'état de départ) y reste. Seuls les états où la masse passe sont touchés :
+   le coût dépend de la vitesse à laquelle la masse atteint la cible, pas de N.
+   - Atteinte : h(s) = probabilité d'atteindre la cible depuis s. Invariant :
+     h(s) = masse arrivée + somme r(u) h(u), d'où masse arrivée <= h(s) <= masse arrivée + R,
+     R étant la masse résiduelle totale.
+   - Stationnaire : pi(v) = 1 / E_v[T_v] (temps de retour, Kac). Chaque unité de masse
+     poussée compte un pas : la somme S des masses poussées minore E_v[T_v], donc
+     pi(v) <= 1 / S. L'estimation (1 - R) / S a une erreur relative de l'ordre de R si la
+     masse résiduelle revient en un temps comparable au temps de retour moyen (chaîne qui
+     mélange bien) ; un état transitoire ne voit jamais revenir toute sa masse : dès qu'une
+     part entre dans un ensemble fermé sans v, pi(v) = 0.
+   Les états dont la masse résiduelle dépasse le seuil sont poussés dans l'ordre d'une
+   file ; quand la file est vide, le seuil est divisé par PUSH_THRESHOLD_FACTOR, jusqu'à
+   epsilon : les grosses masses sont poussées d'abord, et la poussée s'arrête quand aucun
+   état ne garde plus de epsilon. Chaque poussée déplace plus de epsilon : il y en a au
+   plus S / epsilon <= 1 / (pi(v) epsilon) pour pi(v), quel que soit N.
+   Poussée arrière (une cible, beaucoup de départs) : la masse part de la cible et remonte
+   les arêtes entrantes (PT, csr_transpose) ; une seule poussée donne h(s) pour tous les
+   départs à la fois. L'estimation p(s) minore h(s) avec certitude ; l'écart est au plus
+   epsilon fois le nombre moyen de visites avant la cible, sans borne supérieure locale.
+   Chaque ligne est ramenée à une somme de 1 avant d'être poussée : la masse totale est
+   conservée et les bornes valent pour la chaîne aux lignes ainsi normalisées.
+*/
+
+//Seuil par défaut : masse résiduelle laissée au plus sur chaque état.
+#define PUSH_DEFAULT_EPSILON 1e-6
+
+//Poussées au plus par défaut (chaque poussée parcourt les arêtes sortantes d'un état).
+#define PUSH_DEFAULT_MAX_PUSHES 10000000LL
+
+//Premier seuil de poussée, puis division du seuil à chaque file vidée.
+#define PUSH_FIRST_THRESHOLD 0.25
+#define PUSH_THRESHOLD_FACTOR 8.0
+
+//Résultat d'une estimation locale.
+typedef struct s_push_result {
+    double estimate;        // Valeur estimée
+    double lower;           // Borne inférieure certaine (stationnaire : 0 sauf si toute la masse est revenue)
+    double upper;           // Borne supérieure certaine
+    double residual;        // Masse résiduelle R (pas encore arrivée)
+    long long pushes;       // Poussées effectuées
+    long long edges;        // Arêtes parcourues
+    int touched;            // États distincts touchés
+    int converged;          // 1 si aucun état ne garde plus de epsilon, 0 si le budget de poussées est épuisé
+} t_push_result;
+
+//Probabilité d'atteindre l'un des num_targets états de targets (1..N) en partant de source. Retourne MARKOV_ERR_ARGUMENT
+//si un état est hors bornes, MARKOV_ERR_NOMEM si la mémoire manque.
+t_markov_status push_hitting_probability(t_graph graph, int source, const int *targets, int num_targets, double epsilon,
+                                         long long max_pushes, t_push_result *result);
+
+//Probabilités d'atteindre l'un des num_targets états de targets depuis chacun des num_sources états de sources (1..N),
+//par une seule poussée arrière sur PT (transposée de P, csr_transpose ; graph sert à normaliser les lignes). results
+//(num_sources cases) : estimate = lower, upper = 1. Retourne MARKOV_ERR_ARGUMENT si un état est hors bornes ou si PT ne
+//correspond pas au graphe, MARKOV_ERR_NOMEM si la mémoire manque.
+t_markov_status push_hitting_backward(t_graph graph, const t_csr *PT, const int *targets, int num_targets,
+                                      const int *sources, int num_sources, double epsilon, long long max_pushes,
+                                      t_push_result *results);
+
+//Probabilité stationnaire de l'état v (1..N) dans sa classe, estimée par son temps de retour moyen.
+t_markov_status push_stationary(t_graph graph, int v, double epsilon, long long max_pushes, t_push_result *result);
+
+#endif // LOCAL_PUSH_H
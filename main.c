@@ -1,35 +1,167 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#include <math.h>
+#include <errno.h>
+#include <sys/stat.h>
 
 
-#include "graph.h"
+#include "markov.h"
 #include "markov_check.h"
-#include "mermaid_gen.h"
-#include "tarjan.h"
-#include "hasse.h"
 #include "characteristic.h"
 #include "matrix.h"
 #include "period.h"
+#include "batch.h"
+#include "server.h"
+#include "profile.h"
+#include "planner.h"
+#include "cache.h"
+#include "delta.h"
+#include "block_matrix.h"
+#include "reorder.h"
+#include "spectral.h"
+#include "tiled_matrix.h"
+#include "sensitivity.h"
+#include "local_push.h"
+#include "pull.h"
+#include "taskgraph.h"
+#include "checkpoint.h"
+#include "sequence.h"
+#include "kronecker.h"
+#include "mtx.h"
 
 #define DATA_FOLDER "../data/"
 #define DEFAULT_INPUT_FILE "exemple1.txt"
 #define MAX_PATH_LENGTH 256
 
+//Classes persistantes affichées au plus dans le tableau des estimations spectrales.
+#define SPECTRAL_DISPLAY_MAX 20
+
+//Plafonds des moteurs denses : produits successifs (celui de stationaryDistribution) et élévations au carré.
+#define DENSE_MAX_PRODUCTS 199
+#define DENSE_MAX_SQUARINGS 40
+
+//États au plus dans une liste de --local-pi ou --local-hit.
+#define LOCAL_MAX_STATES 64
+
+//Transitions affichées au plus par --gradient, pour chaque probabilité dérivée.
+#define GRADIENT_DISPLAY_MAX 10
+
+//Départs au plus d'une suite de matrices (--starts), états affichés au plus pour chaque distribution.
+#define SEQUENCE_MAX_STARTS 64
+#define SEQUENCE_DISPLAY_MAX 20
+
 //Affiche les caractéristiques d'irréductibilité et les états absorbants.
 void display_graph_characteristics(t_graph graph, t_partition partition);
 
+//Chemin de sortie "<base_name><suffix>". Retourne 0 si succès, -1 (message sur stderr) s'il ne tient pas dans size caractères.
+static int build_output_path(char *path, size_t size, const char *base_name, const char *suffix);
+
+//Nom d'un état du fichier dans les affichages : son étiquette (fichier étiqueté), sinon son numéro sur deux chiffres.
+static const char *state_name(const t_markov_ctx *ctx, int v, char *buffer, size_t size);
+
+//Largeur de la colonne des états dans les tableaux de probabilités : le plus long nom (étiquette de labels, ou numéro sur
+//deux chiffres si la table est vide), au moins 5 caractères.
+static int state_column_width(const t_label_table *labels, int num_vertices);
+
+//En-tête "<titre> | Probabilite" et tirets d'un tableau de probabilités dont la colonne des états fait width caractères.
+static void display_probability_header(FILE *out, const char *title, int width);
+
 //Affiche le vecteur de distribution stationnaire (première ligne de la matrice limite).
-static void display_stationary_distribution(t_matrix matrix_limit);
+static void display_stationary_distribution(FILE *out, const t_markov_ctx *ctx, const double *limit_row);
+
+//Affiche, pour chaque classe persistante périodique, la limite de M^(dk) sur chacune de ses sous-classes cycliques.
+static void display_cyclic_limits(FILE *out, const t_markov_ctx *ctx, const int *periods, const int *phase, const double *subclass_limit);
+
+//Partie 3 : distribution limite partant du sommet 1 avec le moteur choisi par le plan, budgets d'itérations et solveurs
+//tirés des estimations spectrales (spectral : une case par classe, NULL pour les moteurs cache et delta). checkpoint
+//(moteur sparse, NULL sans --checkpoint) suit les itérations et fournit l'état relu par --resume.
+//Retourne 0, ou -1 si la mémoire manque.
+static int run_stationary_stage(FILE *out, const t_markov_ctx *ctx, t_plan_engine engine, const t_spectral_estimate *spectral,
+                                           t_matrix *matrix_T, t_checkpointer *checkpoint, t_profiler *prof);
+
+//Classes terminées et itérations faites dans le point de reprise relu (--resume), itérations restantes estimées.
+static void display_checkpoint_resume(FILE *out, const t_markov_ctx *ctx, const t_checkpointer *cp);
+
+//Tableau des estimations spectrales des classes persistantes, avec les itérations prévues et effectuées.
+static void display_spectral_estimates(FILE *out, const t_markov_ctx *ctx, const t_spectral_estimate *spectral, const double *pi,
+                                                  const int *expected, const int *iterations, const t_spectral_solver *solvers);
+
+//Défi bonus : période de chaque classe persistante avec le moteur choisi par le plan.
+static void run_period_stage(FILE *out, const t_markov_ctx *ctx, t_plan_engine engine, t_matrix *matrix_T, t_profiler *prof);
+
+//Entrées des étapes exécutées par le graphe de tâches (fichiers mermaid, parties 2 et 3, période) : lues seulement,
+//sauf matrix_T, construite par la tâche de conversion avant les étapes denses qui la lisent.
+typedef struct s_stage_inputs {
+    const t_markov_ctx *ctx;
+    const t_plan *plan;
+    const t_spectral_estimate *spectral;
+    t_matrix *matrix_T;
+    t_checkpointer *checkpoint; // Points de reprise de la partie 3 (--checkpoint), NULL sinon
+    t_profiler *prof;
+    const char *graph_path;     // Fichier mermaid du graphe
+    const char *hasse_path;     // Fichier mermaid du diagramme de Hasse
+} t_stage_inputs;
+
+//Tâches du graphe des étapes (arg : t_stage_inputs), affichage dans out : fichier mermaid du graphe, partie 2, diagramme
+//de Hasse, matrice dense, partie 3 et période. Retournent 0, ou -1 en cas d'erreur.
+static int task_mermaid(void *arg, FILE *out);
+static int task_characterize(void *arg, FILE *out);
+static int task_hasse(void *arg, FILE *out);
+static int task_matrix(void *arg, FILE *out);
+static int task_stationary(void *arg, FILE *out);
+static int task_period(void *arg, FILE *out);
+
+//P^power en dense hors mémoire (--power), par tuiles dans un fichier temporaire de scratch_dir. Retourne 0, ou -1 en cas d'erreur.
+static int run_power_stage(const t_markov_ctx *ctx, int power, const char *scratch_dir, long long max_memory, const char *base_name,
+                           t_profiler *prof);
+
+//Export Matrix Market (--mtx) : matrice de transition, et si les classes sont connues, distributions stationnaires et
+//probabilités d'absorption, dans <base_name>_P.mtx, _stationary.mtx et _absorption.mtx. Retourne 0, ou -1 en cas d'erreur.
+static int run_export_stage(t_markov_ctx *ctx, const char *base_name, t_profiler *prof);
+
+//Exécute markov_solve si l'analyse (cache, delta) ne l'a pas déjà fait. Retourne 0, ou -1 en cas d'erreur.
+static int ensure_solved(t_markov_ctx *ctx, t_profiler *prof);
+
+//Effet de chaque modification du fichier (--whatif) par mise à jour de rang un. Retourne 0, ou -1 en cas d'erreur.
+static int run_whatif_stage(t_markov_ctx *ctx, const char *whatif_path, t_profiler *prof);
+
+//Transitions dont la modification change le plus la probabilité stationnaire de l'état (persistant) ou ses probabilités
+//d'absorption (transitoire) (--gradient). Retourne 0, ou -1 en cas d'erreur.
+static int run_gradient_stage(t_markov_ctx *ctx, const char *state, t_profiler *prof);
+
+//Estimations locales par poussée (--local-pi, --local-hit) sur la liste d'adjacence, sans analyse globale.
+//Retourne 0, ou -1 en cas d'erreur.
+static int run_local_stage(const t_markov_ctx *ctx, const char *pi_states, const char *hit_query, double epsilon, t_profiler *prof);
+
+//Applique le fichier delta (--delta) à la chaîne analysée et affiche ce qui a été recalculé. Retourne 0, ou -1 en cas d'erreur.
+static int run_delta_stage(t_markov_ctx *ctx, const char *delta_path, const char *cache_dir, t_profiler *prof);
+
+//Affiche l'aide de la ligne de commande.
+static void print_usage(const char *program_name);
+
+//Mode batch : analyse d'un dossier ou d'une liste de fichiers sur un pool de threads.
+static int run_batch_mode(const char *source, int source_is_list, t_batch_options options);
+
+//Mode serveur : charge les chaînes une fois puis répond aux requêtes (stdin ou socket Unix).
+static int run_server_mode(char **chain_paths, int num_chains, const char *socket_path, const char *cache_dir);
+
+//Mode suite de matrices (--sequence) : chaîne inhomogène P_1 ... P_T des fichiers de la liste, distributions après
+//cycles cycles et régime périodique, partant des états de starts (liste a,b,..., NULL pour l'état 1).
+static int run_sequence_mode(const char *list_path, const char *starts, int cycles);
+
+//Mode chaîne composée (--compose) : distribution après steps pas (0 : non calculée) et distribution limite partant de
+//l'état global from ("e_1:...:e_m", NULL pour le premier état de chaque composante), sans former la matrice produit.
+static int run_compose_mode(const char *description_path, const char *from, int steps);
 
 
 int main(int argc, char *argv[]) {
     // --- Déclarations des structures principales ---
-    t_graph graph;
-    t_partition partition;
-    t_link_array *hasse_links = NULL;
-    t_matrix matrix_T;
-    t_matrix matrix_limit = {0};
+    t_markov_ctx ctx;           // Contexte libmarkov : graphe, partition, liens de Hasse
+    t_markov_status status;
+    t_matrix matrix_T = {NULL, 0, 0}; // Matrice N x N, construite seulement par le moteur dense
+    t_spectral_estimate *spectral = NULL; // Estimations spectrales des classes, pour l'étape stationnaire
 
     // Chemins et noms de fichiers
     char full_input_path[MAX_PATH_LENGTH];
@@ -38,11 +170,199 @@ int main(int argc, char *argv[]) {
     char base_name[MAX_PATH_LENGTH] = {0};
     char user_input[MAX_PATH_LENGTH] = {0};
     const char *input_filename = DEFAULT_INPUT_FILE;
+    int has_input_argument = 0;
+
+    // Options du mode batch
+    const char *batch_source = NULL;
+    int batch_source_is_list = 0;
+    t_batch_options batch_options = {".", 0, NULL};
+
+    // Options du mode serveur
+    int server_mode = 0;
+    const char *socket_path = NULL;
+
+    // Mode --profile : mesure de chaque étape, rapport JSON et trace
+    int profile_mode = 0;
+    t_profiler profiler;
+    t_profiler *prof = NULL;    // NULL si le mode est désactivé (profile_begin / profile_end sans effet)
+    char output_profile_path[MAX_PATH_LENGTH];
+    char output_trace_path[MAX_PATH_LENGTH];
+
+    // Planificateur : étapes demandées (--stages), budget mémoire (--max-memory), moteur imposé (--engine)
+    int requested_stages = PLAN_ALL_STAGES;
+    long long max_memory = plan_default_memory();
+    int forced_engine = PLAN_ENGINE_AUTO;
+    t_plan plan;
+
+    // Cache des résultats (--cache DIR), partagé par tous les modes
+    const char *cache_dir = NULL;
+    int cache_hit = 0;
+
+    // Modifications à appliquer à la chaîne lue (--delta FICHIER)
+    const char *delta_path = NULL;
+
+    // Renumérotation des sommets après la lecture (--reorder bfs|rcm|class)
+    int reorder_kind = REORDER_NONE;
+
+    // Index des arêtes entrantes et noyaux parallèles par tirage (--pull N, 0 = nombre de coeurs), désactivés par défaut
+    int pull_threads = -1;
+
+    // Puissance dense P^K hors mémoire (--power K), fichiers temporaires dans --scratch DOSSIER
+    int power_steps = 0;
+    const char *scratch_dir = ".";
+
+    // Export des résultats au format Matrix Market (--mtx)
+    int export_mtx = 0;
+
+    // Analyse de sensibilité : modifications à évaluer (--whatif FICHIER), état dont on dérive les probabilités (--gradient ETAT)
+    const char *whatif_path = NULL;
+    const char *gradient_state = NULL;
+
+    // Estimations locales par poussée : états (--local-pi LISTE), atteinte (--local-hit SOURCE:CIBLES), seuil (--push-epsilon)
+    const char *local_pi = NULL;
+    const char *local_hit = NULL;
+    double push_epsilon = PUSH_DEFAULT_EPSILON;
+
+    // Points de reprise de la partie 3 : fichier (--checkpoint), intervalle (--checkpoint-every), reprise (--resume)
+    const char *checkpoint_path = NULL;
+    double checkpoint_seconds = CHECKPOINT_DEFAULT_SECONDS;
+    int resume = 0;
+
+    // Chaîne inhomogène : liste des matrices (--sequence LISTE), états de départ (--starts LISTE), cycles appliqués (--cycles K)
+    const char *sequence_list = NULL;
+    const char *sequence_starts = NULL;
+    int sequence_cycles = 1;
+
+    // Chaîne composée : description (--compose FICHIER), état de départ (--from ETAT), pas de la distribution (--kstep K)
+    const char *compose_path = NULL;
+    const char *compose_from = NULL;
+    int compose_steps = 0;
+
+    // Arguments qui ne sont pas des options (fichier(s) à analyser)
+    char **positional = (char **)malloc(argc * sizeof(char *));
+    int num_positional = 0;
+    if (positional == NULL) {
+        perror("Allocation failed for arguments");
+        return EXIT_FAILURE;
+    }
+
+    // --- 0. Lecture des options ---
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+            batch_source = argv[++i];
+            batch_source_is_list = 0;
+        } else if (strcmp(argv[i], "--batch-list") == 0 && i + 1 < argc) {
+            batch_source = argv[++i];
+            batch_source_is_list = 1;
+        } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            batch_options.output_dir = argv[++i];
+        } else if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+            batch_options.num_jobs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--serve-stdin") == 0) {
+            server_mode = 1;
+        } else if (strcmp(argv[i], "--serve") == 0 && i + 1 < argc) {
+            server_mode = 1;
+            socket_path = argv[++i];
+        } else if (strcmp(argv[i], "--profile") == 0) {
+            profile_mode = 1;
+        } else if (strcmp(argv[i], "--stages") == 0 && i + 1 < argc) {
+            requested_stages = plan_parse_stages(argv[++i]);
+        } else if (strcmp(argv[i], "--max-memory") == 0 && i + 1 < argc) {
+            max_memory = plan_parse_memory(argv[++i]);
+        } else if (strcmp(argv[i], "--cache") == 0 && i + 1 < argc) {
+            cache_dir = argv[++i];
+            batch_options.cache_dir = cache_dir;
+        } else if (strcmp(argv[i], "--delta") == 0 && i + 1 < argc) {
+            delta_path = argv[++i];
+        } else if (strcmp(argv[i], "--engine") == 0 && i + 1 < argc) {
+            forced_engine = plan_parse_engine(argv[++i]);
+        } else if (strcmp(argv[i], "--reorder") == 0 && i + 1 < argc) {
+            reorder_kind = reorder_parse_kind(argv[++i]);
+        } else if (strcmp(argv[i], "--pull") == 0 && i + 1 < argc) {
+            pull_threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--power") == 0 && i + 1 < argc) {
+            power_steps = atoi(argv[++i]);
+            if (power_steps <= 0) power_steps = -1;
+        } else if (strcmp(argv[i], "--scratch") == 0 && i + 1 < argc) {
+            scratch_dir = argv[++i];
+        } else if (strcmp(argv[i], "--mtx") == 0) {
+            export_mtx = 1;
+        } else if (strcmp(argv[i], "--whatif") == 0 && i + 1 < argc) {
+            whatif_path = argv[++i];
+        } else if (strcmp(argv[i], "--gradient") == 0 && i + 1 < argc) {
+            gradient_state = argv[++i];
+        } else if (strcmp(argv[i], "--local-pi") == 0 && i + 1 < argc) {
+            local_pi = argv[++i];
+        } else if (strcmp(argv[i], "--local-hit") == 0 && i + 1 < argc) {
+            local_hit = argv[++i];
+        } else if (strcmp(argv[i], "--push-epsilon") == 0 && i + 1 < argc) {
+            push_epsilon = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--checkpoint") == 0 && i + 1 < argc) {
+            checkpoint_path = argv[++i];
+        } else if (strcmp(argv[i], "--checkpoint-every") == 0 && i + 1 < argc) {
+            checkpoint_seconds = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--resume") == 0) {
+            resume = 1;
+        } else if (strcmp(argv[i], "--sequence") == 0 && i + 1 < argc) {
+            sequence_list = argv[++i];
+        } else if (strcmp(argv[i], "--starts") == 0 && i + 1 < argc) {
+            sequence_starts = argv[++i];
+        } else if (strcmp(argv[i], "--cycles") == 0 && i + 1 < argc) {
+            sequence_cycles = atoi(argv[++i]);
+            if (sequence_cycles <= 0) sequence_cycles = -1;
+        } else if (strcmp(argv[i], "--compose") == 0 && i + 1 < argc) {
+            compose_path = argv[++i];
+        } else if (strcmp(argv[i], "--from") == 0 && i + 1 < argc) {
+            compose_from = argv[++i];
+        } else if (strcmp(argv[i], "--kstep") == 0 && i + 1 < argc) {
+            compose_steps = atoi(argv[++i]);
+            if (compose_steps < 0) compose_steps = -1;
+        } else if (strcmp(argv[i], "--help") == 0 || argv[i][0] == '-') {
+            int help_requested = (strcmp(argv[i], "--help") == 0);
+            print_usage(argv[0]);
+            free(positional);
+            return help_requested ? EXIT_SUCCESS : EXIT_FAILURE;
+        } else {
+            positional[num_positional++] = argv[i];
+        }
+    }
+
+    if (requested_stages < 0 || max_memory < 0 || forced_engine < 0 || reorder_kind < 0 || power_steps < 0
+        || pull_threads < -1 || !(push_epsilon > 0.0) || !(checkpoint_seconds > 0.0) || (resume && checkpoint_path == NULL)
+        || sequence_cycles < 0 || compose_steps < 0) {
+        fprintf(stderr, "Erreur: Valeur invalide pour --stages, --max-memory, --engine, --reorder, --pull, --power, --push-epsilon,"
+                        " --checkpoint-every, --cycles, --kstep ou --resume (sans --checkpoint).\n");
+        print_usage(argv[0]);
+        free(positional);
+        return EXIT_FAILURE;
+    }
+
+    if (batch_source != NULL) {
+        free(positional);
+        return run_batch_mode(batch_source, batch_source_is_list, batch_options);
+    }
+    if (sequence_list != NULL) {
+        free(positional);
+        return run_sequence_mode(sequence_list, sequence_starts, sequence_cycles);
+    }
+    if (compose_path != NULL) {
+        free(positional);
+        return run_compose_mode(compose_path, compose_from, compose_steps);
+    }
+    if (server_mode) {
+        int status = run_server_mode(positional, num_positional, socket_path, cache_dir);
+        free(positional);
+        return status;
+    }
+
+    if (num_positional > 0) {
+        input_filename = positional[0];
+        has_input_argument = 1;
+    }
+    free(positional);
 
     // --- 1. Détermination du fichier d'entrée ---
-    if (argc > 1) {
-        input_filename = argv[1];
-    } else {
+    if (!has_input_argument) {
         // Demander à l'utilisateur quel fichier analyser
         printf("Entrez le nom du fichier à analyser dans le dossier data/ (par defaut : %s): ", DEFAULT_INPUT_FILE);
         if (scanf("%s", user_input) == 1 && user_input[0] != '\0') {
@@ -69,10 +389,13 @@ int main(int argc, char *argv[]) {
     }
     strncpy(base_name, temp_name, MAX_PATH_LENGTH);
 
-    // Exemple : file1.txt → file1_graph.mmd
-    snprintf(output_graph_path, MAX_PATH_LENGTH, "%s_graph.mmd", base_name);
-    // Exemple : file1.txt → file1_hasse.mmd
-    snprintf(output_hasse_path, MAX_PATH_LENGTH, "%s_hasse.mmd", base_name);
+    // Exemple : file1.txt → file1_graph.mmd, file1_hasse.mmd, et file1_profile.json et file1_trace.json (mode --profile)
+    if (build_output_path(output_graph_path, MAX_PATH_LENGTH, base_name, "_graph.mmd") != 0
+        || build_output_path(output_hasse_path, MAX_PATH_LENGTH, base_name, "_hasse.mmd") != 0
+        || build_output_path(output_profile_path, MAX_PATH_LENGTH, base_name, "_profile.json") != 0
+        || build_output_path(output_trace_path, MAX_PATH_LENGTH, base_name, "_trace.json") != 0) {
+        return EXIT_FAILURE;
+    }
 
 
     printf("==============================================\n");
@@ -86,76 +409,839 @@ int main(int argc, char *argv[]) {
     printf("\n--- PARTIE 1 : Initialisation et verification ---\n");
 
     // 1.1 Lecture du Graphe
-    graph = read_graph(full_input_path);
-    if (graph.num_vertices == 0) {
-        fprintf(stderr, "Erreur: Lecture du graphe echouee. Verifiez le chemin ou le format du fichier.\n");
+    markov_init(&ctx);
+    if (profile_mode) {
+        profile_init(&profiler);
+        prof = &profiler;
+        markov_set_profiler(&ctx, prof);
+        profile_begin(prof, "total");
+    }
+    markov_set_pull_threads(&ctx, pull_threads);
+    status = markov_load_file(&ctx, full_input_path);
+    if (status != MARKOV_OK) {
+        fprintf(stderr, "Erreur: Lecture du graphe echouee (%s). Verifiez le chemin ou le format du fichier.\n",
+                markov_status_string(status));
         return EXIT_FAILURE;
     }
-    printf("\nGraphe lu avec %d sommets.\n\n", graph.num_vertices);
+    printf("\nGraphe lu avec %d sommets.\n", ctx.num_vertices);
+    if (ctx.load_stats.labeled) {
+        printf("Etats etiquetes : %d etiquettes (%.1f Ko), %lld aretes lues en %.3f ms dont %.3f ms d'internement.\n",
+               ctx.labels.count, ctx.labels.text_used / 1024.0, ctx.load_stats.num_edges, ctx.load_stats.read_ms,
+               ctx.load_stats.intern_ms);
+    }
+    if (ctx.load_stats.matrix_market) {
+        printf("Matrix Market : %lld aretes lues en %.3f ms.\n", ctx.load_stats.num_edges, ctx.load_stats.read_ms);
+    }
+    printf("\n");
 
-    // 1.2 Vérification de la Propriété de Markov
-    if (!is_markov_graph(graph)) {
+    // 1.2 Vérification de la Propriété de Markov (affichage détaillé, puis étape de la bibliothèque)
+    profile_begin(prof, "is_markov_graph");
+    int is_markov = is_markov_graph(ctx.graph) && markov_check(&ctx) == MARKOV_OK;
+    profile_end(prof);
+    if (!is_markov) {
         printf("Verification echouee : Ce n'est pas un graphe de Markov valide (somme des probabilites != 1).\n");
-        free_graph(graph);
+        markov_free(&ctx);
         return EXIT_FAILURE;
     }
     printf("Le graphe est valide pour l'etude de Markov.\n\n");
 
-    // 1.3 Génération de la Visualisation du Graphe (Mermaid)
-    generate_mermaid_file(graph, output_graph_path);
-    printf("\n => Graphe visualise dans : %s\n", output_graph_path);
+    // 1.2 bis Renumérotation pour la localité (--reorder) : les affichages et fichiers
+    // produits gardent les numéros du fichier (markov_original_id)
+    if (reorder_kind != REORDER_NONE) {
+        int bandwidth_before = graph_bandwidth(ctx.graph);
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        status = markov_reorder(&ctx, (t_reorder_kind)reorder_kind);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        if (status != MARKOV_OK) {
+            fprintf(stderr, "Erreur: Renumerotation impossible (%s).\n", markov_status_string(status));
+            markov_free(&ctx);
+            return EXIT_FAILURE;
+        }
+        double elapsed_ms = (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1e6;
+        printf("Renumerotation %s en %.3f ms : largeur de bande %d -> %d\n\n", reorder_kind_name((t_reorder_kind)reorder_kind),
+               elapsed_ms, bandwidth_before, graph_bandwidth(ctx.graph));
+    }
 
+    // 1.3 Plan d'exécution : les classes (Tarjan, linéaire) sont calculées d'abord,
+    // leurs tailles décident du moteur des étapes stationnaire et période.
+    // Avec --cache, toute l'analyse de la bibliothèque est lue dans le cache (ou faite puis enregistrée).
+    // Avec --delta, l'analyse complète de la chaîne de base est mise à jour par les modifications du fichier.
+    plan_init(&plan, requested_stages, max_memory, ctx.graph);
+    if ((plan_runs(&plan, PLAN_STAGE_CLASSES) || delta_path != NULL) && plan.feasible) {
+        profile_begin(prof, "analyze_classes");
+        if (cache_dir != NULL || delta_path != NULL) status = markov_analyze_cached(&ctx, cache_dir, &cache_hit);
+        else status = markov_analyze_classes(&ctx);
+        profile_end(prof);
+        if (status != MARKOV_OK) {
+            fprintf(stderr, "Erreur: Analyse des classes impossible (%s).\n", markov_status_string(status));
+            markov_free(&ctx);
+            return EXIT_FAILURE;
+        }
+        if (cache_dir != NULL) {
+            printf("Cache (%s) : %s, cle %016llx\n", cache_dir, cache_hit ? "resultats lus" : "resultats calcules et enregistres",
+                   (unsigned long long)markov_cache_key(&ctx));
+        }
+        if (delta_path != NULL && run_delta_stage(&ctx, delta_path, cache_dir, prof) != 0) {
+            markov_free(&ctx);
+            return EXIT_FAILURE;
+        }
+        t_plan_engine engine = (t_plan_engine)forced_engine;
+        if (delta_path != NULL) engine = PLAN_ENGINE_DELTA;
+        else if (cache_dir != NULL) engine = PLAN_ENGINE_CACHE;
 
-    // ====================================================
-    // PARTIE 2 : ANALYSE DES CLASSES ET DIAGRAMME DE HASSE
-    // ====================================================
-    printf("\n--- PARTIE 2 : Structure du graphe ---\n");
+        // Estimations spectrales : itérations attendues de chaque classe, pour le plan et l'étape stationnaire
+        if (plan_runs(&plan, PLAN_STAGE_STATIONARY) && engine != PLAN_ENGINE_DELTA && engine != PLAN_ENGINE_CACHE) {
+            spectral = (t_spectral_estimate *)malloc((ctx.partition.num_classes > 0 ? ctx.partition.num_classes : 1)
+                                                     * sizeof(t_spectral_estimate));
+            profile_begin(prof, "spectral_estimates");
+            if (spectral != NULL && spectral_estimates(&ctx.P, ctx.partition, MARKOV_STATIONARY_EPSILON, spectral) != 0) {
+                free(spectral);
+                spectral = NULL;
+            }
+            profile_end(prof);
+        }
+        plan_choose_engines(&plan, ctx.graph, ctx.partition, engine, spectral);
+    }
+    display_plan(&plan);
+    if (!plan.feasible) {
+        fprintf(stderr, "Erreur: Le plan depasse le budget memoire (--max-memory). Retirez des etapes (--stages) ou augmentez le budget.\n");
+        free(spectral);
+        markov_free(&ctx);
+        return EXIT_FAILURE;
+    }
 
-    // 2.1 Algorithme de Tarjan : Trouver les CFCs (Classes)
-    printf("\n2.1 Recherche des classes (CFCs) via Tarjan\n\n");
-    partition = find_cfcs_tarjan(graph);
+    // 1.5 Points de reprise de la partie 3 (--checkpoint, --resume) : itérations du moteur sparse seulement
+    t_checkpointer checkpointer;
+    t_checkpointer *checkpoint = NULL;
+    if (checkpoint_path != NULL && plan_runs(&plan, PLAN_STAGE_STATIONARY)) {
+        t_plan_engine engine = plan.steps[PLAN_STAGE_STATIONARY].engine;
+        if (engine != PLAN_ENGINE_SPARSE) {
+            printf("Points de reprise ignores : moteur %s (moteur sparse seulement).\n", plan_engine_name(engine));
+        } else {
+            status = checkpoint_open(&checkpointer, checkpoint_path, checkpoint_seconds, markov_cache_key(&ctx),
+                                     ctx.num_vertices, ctx.partition.num_classes, MARKOV_STATIONARY_EPSILON, resume);
+            if (status != MARKOV_OK) {
+                fprintf(stderr, "Erreur: Point de reprise %s inutilisable (%s) : fichier invalide ou d'une autre chaine.\n",
+                        checkpoint_path, markov_status_string(status));
+                free(spectral);
+                markov_free(&ctx);
+                return EXIT_FAILURE;
+            }
+            checkpoint = &checkpointer;
+            if (resume && !checkpoint->resumed) printf("Aucun point de reprise dans %s : calcul depuis le debut.\n", checkpoint_path);
+        }
+    }
 
-    // 2.2 Détermination des types de Classes (Stockage de l'information)
-    printf("\n2.2 Stockage de la persistance pour l'analyse future\n\n");
-    // Fonction nécessaire pour mettre à jour le champ is_persistent de la structure partition.
-    set_persistence_flags(graph, &partition);
+    // 1.4 à la période : graphe de tâches. Les fichiers mermaid sont écrits par le thread
+    // d'écriture pendant les calculs ; la partie 2, la matrice dense, la partie 3 et la
+    // période sont indépendantes, sauf la lecture de la matrice par les moteurs denses.
+    // L'affichage reste dans l'ordre des parties. Le profileur (pile d'étapes) n'est pas
+    // partagé entre threads : avec --profile, les tâches s'exécutent à la suite.
+    t_stage_inputs inputs = {&ctx, &plan, spectral, &matrix_T, checkpoint, prof, output_graph_path, output_hasse_path};
+    t_task_graph tasks;
+    taskgraph_init(&tasks);
+    if (plan_runs(&plan, PLAN_STAGE_MERMAID)) taskgraph_add(&tasks, "mermaid", task_mermaid, &inputs, TASK_WRITE);
+    if (plan_runs(&plan, PLAN_STAGE_CLASSES) && !plan.steps[PLAN_STAGE_CLASSES].required) {
+        taskgraph_add(&tasks, "characterize", task_characterize, &inputs, TASK_COMPUTE);
+    }
+    if (plan_runs(&plan, PLAN_STAGE_HASSE)) taskgraph_add(&tasks, "hasse", task_hasse, &inputs, TASK_WRITE);
+    int dense_stationary = plan_runs(&plan, PLAN_STAGE_STATIONARY) && plan.steps[PLAN_STAGE_STATIONARY].engine == PLAN_ENGINE_DENSE;
+    int dense_period = plan_runs(&plan, PLAN_STAGE_PERIOD) && plan.steps[PLAN_STAGE_PERIOD].engine == PLAN_ENGINE_DENSE;
+    int matrix_task = (dense_stationary || dense_period)
+                    ? taskgraph_add(&tasks, "adj_list_to_matrix", task_matrix, &inputs, TASK_COMPUTE) : -1;
+    int stationary_task = -1;
+    if (plan_runs(&plan, PLAN_STAGE_STATIONARY)) {
+        stationary_task = taskgraph_add(&tasks, "stationary", task_stationary, &inputs, TASK_COMPUTE);
+        if (dense_stationary) taskgraph_depends(&tasks, stationary_task, matrix_task);
+    }
+    if (plan_runs(&plan, PLAN_STAGE_PERIOD)) {
+        int period_task = taskgraph_add(&tasks, "period", task_period, &inputs, TASK_COMPUTE);
+        if (dense_period) taskgraph_depends(&tasks, period_task, matrix_task);
+    }
 
-    // 2.3 Affichage des caractéristiques (Utilisation de votre fonction Characterize)
-    Characterize(graph, partition);
+    int stage_threads = (prof != NULL) ? 1 : batch_options.num_jobs;
+    taskgraph_run(&tasks, stage_threads, stdout);
+    if (tasks.num_threads > 1 || tasks.has_writer) {
+        printf("\nEtapes en parallele : %d tache(s) sur %d thread(s) de calcul%s en %.1f ms (chemin critique %.1f ms).\n",
+               tasks.num_tasks, tasks.num_threads, tasks.has_writer ? " et un thread d'ecriture" : "", tasks.wall_ms,
+               taskgraph_critical_path_ms(&tasks));
+    }
+    // Calcul terminé : le point de reprise ne servirait plus ; il est gardé si la partie 3 a échoué
+    if (checkpoint != NULL) {
+        int solved = (tasks.tasks[stationary_task].result == 0);
+        checkpoint_close(checkpoint, solved);
+        printf("\nPoints de reprise (%s) : %d ecrit(s), %d saute(s) pendant une ecriture, %d en echec%s.\n", checkpoint_path,
+               checkpoint->written, checkpoint->skipped, checkpoint->failed, solved ? ", fichier supprime" : "");
+    }
+    // La partie 3 en échec (mémoire) arrête l'analyse, comme avant ; les autres tâches affichent leur propre erreur
+    if (stationary_task >= 0 && tasks.tasks[stationary_task].result != 0) {
+        free_matrix(matrix_T);
+        free(spectral);
+        markov_free(&ctx);
+        return EXIT_FAILURE;
+    }
 
-    // 2.4 Construction du Diagramme de Hasse (Graphe des Classes)
-    printf("\n2.4 Construction du diagramme de Hasse\n\n");
-    hasse_links = compute_hasse_diagram_links(graph, partition);
+    // ====================================
+    // EXPORT MATRIX MARKET (--mtx)
+    // ====================================
+    if (export_mtx) {
+        printf("\n--- Export Matrix Market ---\n");
+        if (run_export_stage(&ctx, base_name, prof) != 0) {
+            free_matrix(matrix_T);
+            free(spectral);
+            markov_free(&ctx);
+            return EXIT_FAILURE;
+        }
+    }
 
-    // 2.5 Visualisation du Diagramme de Hasse (Mermaid)
-    if (hasse_links) {
-        generate_hasse_mermaid_file(hasse_links, output_hasse_path, partition);
-        printf("\n => Diagramme de Hasse visualise dans : %s\n", output_hasse_path);
+    // ===================================================
+    // ANALYSE DE SENSIBILITÉ (--whatif, --gradient)
+    // ===================================================
+    if (whatif_path != NULL || gradient_state != NULL) {
+        printf("\n--- Analyse de sensibilite ---\n");
+        int failed = 0;
+        if (!(ctx.stages_done & MARKOV_STAGE_CLASSES)) {
+            printf("Etape des classes non executee (--stages) : analyse de sensibilite ignoree.\n");
+        } else {
+            if (whatif_path != NULL) failed = (run_whatif_stage(&ctx, whatif_path, prof) != 0);
+            if (!failed && gradient_state != NULL) failed = (run_gradient_stage(&ctx, gradient_state, prof) != 0);
+        }
+        if (failed) {
+            free_matrix(matrix_T);
+            free(spectral);
+            markov_free(&ctx);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // ===========================================
+    // ESTIMATION LOCALE (--local-pi, --local-hit)
+    // ===========================================
+    if (local_pi != NULL || local_hit != NULL) {
+        printf("\n--- Estimation locale (push, seuil %g) ---\n", push_epsilon);
+        if (run_local_stage(&ctx, local_pi, local_hit, push_epsilon, prof) != 0) {
+            free_matrix(matrix_T);
+            free(spectral);
+            markov_free(&ctx);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // ==================================
+    // P^K DENSE HORS MÉMOIRE (--power K)
+    // ==================================
+    if (power_steps > 0) {
+        printf("\n--- P^%d dense hors memoire ---\n", power_steps);
+        if (run_power_stage(&ctx, power_steps, scratch_dir, max_memory, base_name, prof) != 0) {
+            free_matrix(matrix_T);
+            free(spectral);
+            markov_free(&ctx);
+            return EXIT_FAILURE;
+        }
+    }
+
+
+    // ================
+    // NETTOYAGE ET FIN
+    // ================
+
+    free_matrix(matrix_T);
+    free(spectral);
+    markov_free(&ctx);
+
+    if (prof != NULL) {
+        profile_end(prof); // "total"
+        profile_display(prof);
+        if (profile_write_json(prof, full_input_path, output_profile_path) == 0) {
+            printf("Rapport de profil genere: %s\n", output_profile_path);
+        }
+        if (profile_write_trace(prof, output_trace_path) == 0) {
+            printf("Trace (chrome://tracing, Perfetto, speedscope) generee: %s\n", output_trace_path);
+        }
+        profile_free(prof);
+    }
+
+    return EXIT_SUCCESS;
+}
+
+//Affiche les caractéristiques d'irréductibilité et les états absorbants.
+void display_graph_characteristics(t_graph graph, t_partition partition) {
+    printf("\n--- Caracteristiques du graphe ---\n");
+
+    // 1. Irréductibilité
+    if (partition.num_classes == 1) {
+        printf("Propriete : Le graphe est irreductible (une seule classe).\n");
+    } else {
+        printf("Propriete : Le graphe est reductible (%d classes).\n", partition.num_classes);
+    }
+
+    // 2. États Absorbants (Classe Persistante de taille 1)
+    int has_absorbing = 0;
+    for (int i = 0; i < partition.num_classes; i++) {
+        t_class c = partition.classes[i];
+
+        if (c.is_persistent && c.num_members == 1) {
+            printf("Etat absorbant trouve : sommet %d.\n", c.members_ids[0]);
+            has_absorbing = 1;
+        }
+    }
+    if (!has_absorbing) {
+        printf("Aucun etat absorbant trouve.\n");
+    }
+}
+
+
+//Affiche le vecteur de distribution stationnaire (ligne de l'état 1 de la matrice limite), par numéro du fichier.
+static void display_stationary_distribution(FILE *out, const t_markov_ctx *ctx, const double *limit_row) {
+    if (limit_row == NULL) {
+        fprintf(out, "Distribution stationnaire non calculee ou non convergee.\n");
+        return;
+    }
+
+    fprintf(out, "Vecteur de distribution stationnaire (Lim M^k):\n\n");
+    int width = state_column_width(&ctx->labels, ctx->num_vertices);
+    display_probability_header(out, "Sommet", width);
+
+    // La distribution stationnaire est la première ligne (et toutes les autres) de la matrice limite
+    char name[16];
+    for (int i = 0; i < ctx->num_vertices; i++) {
+        fprintf(out, "  %-*s |   %.4f\n", width, state_name(ctx, i + 1, name, sizeof(name)),
+                limit_row[markov_internal_id(ctx, i + 1) - 1]);
+    }
+}
+
+static const char *state_name(const t_markov_ctx *ctx, int v, char *buffer, size_t size) {
+    const char *label = markov_state_label(ctx, v);
+    if (label != NULL) return label;
+    snprintf(buffer, size, "%02d", v);
+    return buffer;
+}
+
+static int state_column_width(const t_label_table *labels, int num_vertices) {
+    int width = 5;
+    if (labels == NULL || labels->count == 0) {
+        int digits = snprintf(NULL, 0, "%02d", num_vertices);
+        return (digits > width) ? digits : width;
+    }
+    for (int v = 1; v <= num_vertices; v++) {
+        const char *label = label_name(labels, v);
+        int length = (label != NULL) ? (int)strlen(label) : 0;
+        if (length > width) width = length;
+    }
+    return width;
+}
+
+// Le titre couvre aussi les deux espaces qui précèdent chaque nom : les '|' de l'en-tête et des lignes sont alignés
+static void display_probability_header(FILE *out, const char *title, int width) {
+    fprintf(out, "%-*s | Probabilite\n", width + 2, title);
+    for (int i = 0; i < width + 16; i++) fputc('-', out);
+    fputc('\n', out);
+}
+
+static int build_output_path(char *path, size_t size, const char *base_name, const char *suffix) {
+    int length = snprintf(path, size, "%s%s", base_name, suffix);
+    if (length >= 0 && (size_t)length < size) return 0;
+    fprintf(stderr, "Erreur: Chemin de sortie trop long pour %s%s.\n", base_name, suffix);
+    return -1;
+}
+
+/*
+   display_cyclic_limits :
+   Pour une classe de période d, M^k oscille mais M^(dk) converge : partant d'un
+   membre de la sous-classe r, la limite est une distribution portée par r.
+   Les membres sont d'abord rangés par sous-classe (tri par comptage).
+*/
+static void display_cyclic_limits(FILE *out, const t_markov_ctx *ctx, const int *periods, const int *phase, const double *subclass_limit) {
+    t_partition partition = ctx->partition;
+    for (int i = 0; i < partition.num_classes; i++) {
+        t_class c = partition.classes[i];
+        int d = periods[i];
+        if (!c.is_persistent || d <= 1) continue;
+
+        int *start = (int *)calloc(d + 1, sizeof(int));
+        int *sorted = (int *)malloc(c.num_members * sizeof(int));
+        if (start == NULL || sorted == NULL) {
+            perror("Allocation failed for cyclic subclasses");
+            free(start);
+            free(sorted);
+            return;
+        }
+        for (int m = 0; m < c.num_members; m++) start[phase[c.members_ids[m] - 1] + 1]++;
+        for (int r = 0; r < d; r++) start[r + 1] += start[r];
+        for (int m = 0; m < c.num_members; m++) {
+            int v = c.members_ids[m] - 1;
+            sorted[start[phase[v]]++] = v;
+        }
+
+        fprintf(out, "\nClasse C%d periodique (periode %d) : M^k oscille, la distribution ci-dessus est la moyenne de Cesaro.\n", c.id, d);
+        fprintf(out, "Limite de M^(%dk) par sous-classe cyclique :\n", d);
+        char name[16];
+        for (int r = 0, m = 0; r < d; r++) {
+            fprintf(out, "  Sous-classe %d :", r + 1);
+            for (; m < c.num_members && phase[sorted[m]] == r; m++) {
+                fprintf(out, " %s (%.4f)", state_name(ctx, markov_original_id(ctx, sorted[m] + 1), name, sizeof(name)),
+                       subclass_limit[sorted[m]]);
+            }
+            fprintf(out, "\n");
+        }
+
+        free(start);
+        free(sorted);
+    }
+}
+
+/*
+   display_spectral_estimates :
+   Une ligne par classe persistante : |lambda_2| (~ si estimé, sans ~ si le sous-espace
+   de Krylov est invariant), trou spectral, temps de relaxation 1 / trou, borne du temps
+   de mélange à 1/4 calculée avec le plus petit pi de la classe (toutes deux de P, "-"
+   sur une classe périodique, qui ne mélange pas), puis les itérations (ou produits)
+   prévues et effectuées. Les numéros sont ceux de libmarkov.
+*/
+static void display_spectral_estimates(FILE *out, const t_markov_ctx *ctx, const t_spectral_estimate *spectral, const double *pi,
+                                                  const int *expected, const int *iterations, const t_spectral_solver *solvers) {
+    t_partition partition = ctx->partition;
+    int shown = 0, hidden = 0, no_gap = 0;
+
+    fprintf(out, "Estimation spectrale (Arnoldi, dimension <= %d) :\n\n", SPECTRAL_KRYLOV_DIM);
+    fprintf(out, "Classe  | Etats | |lambda_2| |  Trou  | Relaxation | Melange 1/4 | Prevues | Faites | Solveur\n");
+    fprintf(out, "----------------------------------------------------------------------------------------\n");
+    for (int i = 0; i < partition.num_classes; i++) {
+        t_class c = partition.classes[i];
+        if (!c.is_persistent) continue;
+        if (shown == SPECTRAL_DISPLAY_MAX) {
+            hidden++;
+            continue;
+        }
+        shown++;
+
+        const t_spectral_estimate *e = &spectral[i];
+        double pi_min = 1.0;
+        for (int m = 0; m < c.num_members; m++) {
+            if (pi[c.members_ids[m] - 1] < pi_min) pi_min = pi[c.members_ids[m] - 1];
+        }
+        double mixing = spectral_mixing_time(e, pi_min, 0.25);
+
+        fprintf(out, "  C%-5d| %5d | %c%9.6f | %6.4f | ", c.id, c.num_members, e->exact ? ' ' : '~', e->slem, e->gap);
+        if (isfinite(e->relaxation_time)) {
+            fprintf(out, "%10.1f | ", e->relaxation_time);
+        } else {
+            fprintf(out, "%10s | ", "-");
+            no_gap = 1;
+        }
+        if (isfinite(mixing)) fprintf(out, "%11.1f | ", mixing);
+        else fprintf(out, "%11s | ", "-");
+        fprintf(out, "%7d | ", expected[i]);
+        if (iterations[i] >= 0) fprintf(out, "%6d | ", iterations[i]);
+        else fprintf(out, "%6s | ", "-");
+        fprintf(out, "%s\n", spectral_solver_name(solvers[i]));
     }
+    if (hidden > 0) fprintf(out, "  ... %d autre(s) classe(s) persistante(s)\n", hidden);
+    fprintf(out, "\nRelaxation : t_rel = 1 / trou ; Melange 1/4 : t_rel ln(4 / pi_min), borne exacte pour une chaine reversible.\n");
+    if (no_gap) fprintf(out, "- : trou nul (classe periodique), la chaine ne melange pas ; sa limite est une moyenne de Cesaro.\n");
+    fprintf(out, "\n");
+}
 
+/*
+   run_stationary_stage :
+   - dense : matrice N x N et puissances successives (Lim M^k), comme avant le planificateur ;
+   - per-class : la même itération sur la matrice k x k de chaque classe persistante ;
+   - sparse : itération creuse sur chaque classe persistante ;
+   - block : itération sur le bloc diagonal de chaque classe persistante, absorption
+     par élimination de Gauss sur les blocs transitoires (block_matrix.c) ;
+   - cache, delta : résultats de libmarkov déjà dans le contexte (markov_limit).
+   Pour per-class, sparse et block, la ligne 1 de la matrice limite vaut, pour chaque sommet j,
+   la probabilité d'absorption de 1 dans la classe de j fois pi(j).
+   Les périodes sont connues avant de lancer les itérations (parcours en largeur, linéaire) :
+   sur une classe de période d > 1, M^k n'a pas de limite, les moteurs denses itèrent M^d
+   (periodicLimit) et la distribution affichée est la moyenne de Cesàro. Le moteur dense
+   utilise le PPCM des périodes ; s'il dépasse N, la moyenne coûterait plus qu'un produit
+   de matrices et le moteur per-class est utilisé à la place.
+   Les estimations spectrales fixent le budget de chaque calcul (marge comprise) et le
+   solveur : élévations au carré pour les moteurs denses quand elles font moins de
+   produits, élimination de Gauss pour une classe creuse lente à converger. Un budget
+   atteint sur une classe creuse est prolongé à chaud jusqu'au plafond habituel.
+   Avec des points de reprise (sparse), les classes terminées avant l'interruption
+   sont relues, et la classe en cours reprend à l'itéré enregistré.
+*/
+static int run_stationary_stage(FILE *out, const t_markov_ctx *ctx, t_plan_engine engine, const t_spectral_estimate *spectral,
+                                           t_matrix *matrix_T, t_checkpointer *checkpoint, t_profiler *prof) {
+    int N = ctx->num_vertices;
+    int source = markov_internal_id(ctx, 1) - 1; // État 1 du fichier (0-based dans le contexte)
+    t_partition partition = ctx->partition;
 
-    // ================================
-    // PARTIE 3 : CALCULS PROBABILISTES
-    // ================================
-    printf("\n--- PARTIE 3 : Probabilites et convergence ---\n");
+    double *limit_row = (double *)calloc(N, sizeof(double));
+    double *pi = (double *)calloc(N, sizeof(double));
+    double *class_mass = (double *)calloc(partition.num_classes, sizeof(double));
+    double *subclass_limit = (double *)calloc(N, sizeof(double));
+    int *phase = (int *)calloc(N, sizeof(int));
+    int *periods = (int *)calloc(partition.num_classes, sizeof(int));
+    int *expected = (int *)calloc(partition.num_classes, sizeof(int));
+    int *iterations = (int *)calloc(partition.num_classes, sizeof(int));
+    t_spectral_solver *solvers = (t_spectral_solver *)calloc(partition.num_classes, sizeof(t_spectral_solver));
+    if (limit_row == NULL || pi == NULL || class_mass == NULL || subclass_limit == NULL || phase == NULL || periods == NULL
+        || expected == NULL || iterations == NULL || solvers == NULL) {
+        perror("Allocation failed for stationary distribution");
+        free(limit_row);
+        free(pi);
+        free(class_mass);
+        free(subclass_limit);
+        free(phase);
+        free(periods);
+        free(expected);
+        free(iterations);
+        free(solvers);
+        return -1;
+    }
 
-    // 3.1 Conversion en Matrice de Transition (T)
-    matrix_T = adj_list_to_matrix(graph);
+    // 3.1 Périodes et sous-classes cycliques des classes persistantes
+    int failed = 0;
+    long long common_period = 1;
+    profile_begin(prof, "class_cyclic_subclasses");
+    for (int i = 0; i < partition.num_classes && !failed; i++) {
+        if (!partition.classes[i].is_persistent) continue;
+        periods[i] = class_cyclic_subclasses(&ctx->P, partition, i, phase);
+        failed = periods[i] < 0;
+        if (!failed && common_period <= N) {
+            long long a = common_period, b = periods[i];
+            while (b != 0) {
+                long long t = a % b;
+                a = b;
+                b = t;
+            }
+            common_period = common_period / a * periods[i];
+        }
+    }
+    profile_end(prof);
 
-    // 3.2 Calcul de la Distribution Stationnaire (Lim T^k)
-    printf("\n3.2 Calcul de la distribution stationnaire (tolerance 0.01)...\n\n");
-    // Utilisation du nom de fonction requis
-    matrix_limit = stationaryDistribution(matrix_T);
+    if (!failed && engine == PLAN_ENGINE_DENSE && common_period > N) {
+        fprintf(out, "\nPPCM des periodes superieur a %d : moteur per-class au lieu du moteur dense.\n", N);
+        engine = PLAN_ENGINE_PER_CLASS;
+    }
+
+    if (failed) {
+        free(limit_row);
+        limit_row = NULL;
+    } else if (engine == PLAN_ENGINE_CACHE || engine == PLAN_ENGINE_DELTA) {
+        fprintf(out, "\n3.2 Distribution stationnaire lue dans les resultats de libmarkov (tolerance 1e-10)...\n\n");
+        if (markov_limit_row(ctx, source + 1, limit_row) != MARKOV_OK) {
+            free(limit_row);
+            limit_row = NULL;
+        }
+        for (int j = 0; j < N; j++) subclass_limit[j] = periods[partition.v_data[j].class_id - 1] * ctx->stationary[j];
+    } else if (engine == PLAN_ENGINE_DENSE) {
+        // 3.1 Conversion en Matrice de Transition (T), si la tâche de conversion ne l'a pas déjà faite
+        if (matrix_T->data == NULL) {
+            profile_begin(prof, "adj_list_to_matrix");
+            *matrix_T = adj_list_to_matrix(ctx->graph);
+            profile_end(prof);
+        }
+        if (matrix_T->data == NULL) {
+            fprintf(stderr, "Erreur: Matrice de transition %dx%d impossible a allouer.\n", N, N);
+            free(limit_row);
+            free(pi);
+            free(class_mass);
+            free(subclass_limit);
+            free(phase);
+            free(periods);
+            free(expected);
+            free(iterations);
+            free(solvers);
+            return -1;
+        }
+
+        // 3.2 Calcul de la Distribution Stationnaire (Lim T^k, ou Lim T^(dk) puis moyenne de Cesàro)
+        fprintf(out, "\n3.2 Calcul de la distribution stationnaire (tolerance 0.01)...\n\n");
+        if (common_period > 1) {
+            fprintf(out, "Classes periodiques (PPCM des periodes : %lld) : limite de M^(%lldk) puis moyenne de Cesaro.\n\n",
+                   common_period, common_period);
+        }
+        // Budget : produits attendus d'après le plus lent des modes de toutes les classes (transitoires comprises)
+        int budget = DENSE_MAX_PRODUCTS, squaring = 0;
+        if (spectral != NULL) {
+            t_spectral_estimate worst = spectral_worst(spectral, partition.num_classes);
+            t_spectral_solver solver;
+            int products = spectral_dense_products(&worst, (int)common_period, N, &solver);
+            squaring = (solver == SPECTRAL_SOLVER_SQUARE);
+            budget = spectral_budget(products, squaring ? DENSE_MAX_SQUARINGS : DENSE_MAX_PRODUCTS);
+            for (int i = 0; i < partition.num_classes; i++) {
+                expected[i] = spectral_dense_products(&spectral[i], periods[i], partition.classes[i].num_members, &solvers[i]);
+                solvers[i] = solver;
+                iterations[i] = -1;
+            }
+            fprintf(out, "Estimation spectrale : |lambda_2| max %.6f", worst.slem);
+            if (common_period > 1) fprintf(out, " (%.6f sans les valeurs propres de module 1, vitesse de M^%lld)", worst.inner_slem, common_period);
+            fprintf(out, ", %d produit(s) attendu(s), solveur %s (budget %d).\n\n", products, spectral_solver_name(solver), budget);
+        }
+        profile_begin(prof, common_period > 1 ? "periodicLimit" : "stationaryDistribution");
+        t_matrix matrix_limit = (common_period > 1) ? periodicLimitBudget(*matrix_T, (int)common_period, budget, squaring)
+                                                    : stationaryDistributionBudget(*matrix_T, budget, squaring);
+        profile_end(prof);
+
+        if (matrix_limit.data == NULL) {
+            free(limit_row);
+            limit_row = NULL;
+        } else {
+            if (common_period > 1) {
+                if (cesaroRow(*matrix_T, matrix_limit, (int)common_period, source, limit_row) != 0) {
+                    free(limit_row);
+                    limit_row = NULL;
+                }
+            } else {
+                for (int j = 0; j < N; j++) limit_row[j] = matrix_limit.data[source][j];
+            }
+            // La ligne d'un sommet persistant est la limite de sa sous-classe cyclique ; un sommet
+            // transitoire (période 0, jamais calculée) a une masse stationnaire nulle
+            for (int j = 0; j < N; j++) {
+                int class_index = partition.v_data[j].class_id - 1;
+                subclass_limit[j] = matrix_limit.data[j][j];
+                pi[j] = partition.classes[class_index].is_persistent ? subclass_limit[j] / periods[class_index] : 0.0;
+            }
+            free_matrix(matrix_limit);
+        }
+    } else {
+        fprintf(out, "\n3.2 Calcul de la distribution stationnaire par classe (moteur %s, tolerance %s)...\n\n",
+               plan_engine_name(engine), engine == PLAN_ENGINE_PER_CLASS ? "0.01" : "1e-10");
+
+        // Moteur block : matrice triangulaire supérieure par blocs, construite une fois depuis la CSR
+        t_block_matrix blocks = {0};
+        if (engine == PLAN_ENGINE_BLOCK) {
+            profile_begin(prof, "csr_to_block_matrix");
+            blocks = csr_to_block_matrix(&ctx->P, partition);
+            profile_end(prof);
+            failed = (blocks.blocks == NULL);
+            if (!failed) {
+                fprintf(out, "Matrice par blocs : %d bloc(s), %lld valeur(s) stockee(s) au lieu de %lld.\n\n",
+                       blocks.num_blocks, blocks.num_entries, (long long)N * N);
+            }
+        }
+
+        // Moteur sparse avec --pull : les grandes classes sont itérées par tirage sur l'index des arêtes entrantes
+        t_pull_team team = {0};
+        if (engine == PLAN_ENGINE_SPARSE && ctx->PT.row_ptr != NULL) {
+            failed = (pull_team_init(&team, &ctx->PT, ctx->pull_threads) != 0);
+            if (!failed) {
+                fprintf(out, "Noyaux par tirage : %d thread(s) sur les classes d'au moins %d aretes entrantes.\n\n",
+                       team.num_threads, PULL_MIN_EDGES);
+            }
+        }
+
+        // Itéré suivant des itérations creuses : un seul tampon pour toutes les classes
+        double *work = NULL;
+        if (engine == PLAN_ENGINE_SPARSE && !failed) {
+            work = (double *)malloc(N * sizeof(double));
+            failed = (work == NULL);
+        }
+
+        int unconverged = 0; // Classes arrêtées au plafond d'itérations avant MARKOV_STATIONARY_EPSILON
+
+        // Reprise (--resume) : itéré enregistré, classes terminées comprises
+        if (checkpoint != NULL && checkpoint->resumed) {
+            memcpy(pi, checkpoint->resume_pi, N * sizeof(double));
+            display_checkpoint_resume(out, ctx, checkpoint);
+        }
+
+        profile_begin(prof, engine == PLAN_ENGINE_SPARSE ? "class_stationary_distribution"
+                          : engine == PLAN_ENGINE_BLOCK ? "block_class_stationary" : "stationaryDistribution");
+        for (int i = 0; i < partition.num_classes && !failed; i++) {
+            t_class c = partition.classes[i];
+            if (!c.is_persistent) continue;
+
+            if (engine == PLAN_ENGINE_SPARSE || engine == PLAN_ENGINE_BLOCK) {
+                int budget = MARKOV_STATIONARY_MAX_ITER;
+                if (spectral != NULL) {
+                    long long internal_edges = 0;
+                    for (int m = 0; m < c.num_members; m++) {
+                        int u = c.members_ids[m] - 1;
+                        internal_edges += ctx->P.row_ptr[u + 1] - ctx->P.row_ptr[u];
+                    }
+                    expected[i] = spectral_lazy_iterations(&spectral[i], MARKOV_STATIONARY_EPSILON);
+                    solvers[i] = spectral_class_solver(&spectral[i], c.num_members, internal_edges, MARKOV_STATIONARY_EPSILON);
+                    budget = spectral_budget(expected[i], MARKOV_STATIONARY_MAX_ITER);
+                    // Plus d'itérations prévues que le plafond : élimination de Gauss si la classe s'y prête, avertissement sinon
+                    if (expected[i] > MARKOV_STATIONARY_MAX_ITER && solvers[i] == SPECTRAL_SOLVER_ITERATE) {
+                        if (c.num_members > 1 && c.num_members <= SPECTRAL_DIRECT_MAX_STATES) {
+                            solvers[i] = SPECTRAL_SOLVER_DIRECT;
+                        } else {
+                            fprintf(out, "Avertissement : classe C%d, %d iterations prevues pour un plafond de %d : "
+                                         "resultat approche.\n", c.id, expected[i], MARKOV_STATIONARY_MAX_ITER);
+                        }
+                    }
+                }
+
+                // Classe terminée avant l'interruption (--resume) : pi déjà recopié, itérations et solveur relus
+                int restored = (checkpoint != NULL && checkpoint_class_done(checkpoint, i));
+                int converged = 1;
+                if (restored) {
+                    iterations[i] = checkpoint->iterations[i];
+                    solvers[i] = (t_spectral_solver)checkpoint->methods[i];
+                    converged = (solvers[i] == SPECTRAL_SOLVER_DIRECT || iterations[i] < MARKOV_STATIONARY_MAX_ITER);
+                }
+
+                // Élimination de Gauss si elle coûte moins que les itérations attendues (itération si le système est singulier)
+                if (!restored && solvers[i] == SPECTRAL_SOLVER_DIRECT && class_stationary_direct(&ctx->P, partition, i, pi) != 0) {
+                    solvers[i] = SPECTRAL_SOLVER_ITERATE;
+                }
+                if (!restored && solvers[i] == SPECTRAL_SOLVER_ITERATE) {
+                    long long in_edges = 0;
+                    for (int m = 0; team.threads != NULL && m < c.num_members; m++) {
+                        int v = c.members_ids[m] - 1;
+                        in_edges += ctx->PT.row_ptr[v + 1] - ctx->PT.row_ptr[v];
+                    }
+                    if (checkpoint != NULL && in_edges < PULL_MIN_EDGES) {
+                        // Itération suivie par les points de reprise ; la classe en cours repart de l'itéré enregistré.
+                        // Budget atteint : même prolongation, sans renormaliser l'itéré
+                        t_stationary_monitor monitor = {checkpoint_observe, checkpoint};
+                        checkpoint_begin_class(checkpoint, i);
+                        iterations[i] = class_stationary_resume(&ctx->P, partition, i, pi, MARKOV_STATIONARY_EPSILON, budget,
+                                                                checkpoint->iterations[i], &monitor, work, &converged);
+                        if (iterations[i] >= 0 && !converged && budget < MARKOV_STATIONARY_MAX_ITER) {
+                            iterations[i] = class_stationary_resume(&ctx->P, partition, i, pi, MARKOV_STATIONARY_EPSILON,
+                                                                    MARKOV_STATIONARY_MAX_ITER, iterations[i], &monitor, work,
+                                                                    &converged);
+                        }
+                        failed = iterations[i] < 0;
+                    } else {
+                        // Les itérations creuse et par blocs portent sur (I + P) / 2, apériodique : elles convergent aussi sur une classe périodique
+                        int pulled = (engine == PLAN_ENGINE_SPARSE && in_edges >= PULL_MIN_EDGES);
+                        iterations[i] = (engine == PLAN_ENGINE_BLOCK)
+                                      ? block_class_stationary(&blocks, partition, i, pi, MARKOV_STATIONARY_EPSILON, budget, &converged)
+                                      : pulled
+                                      ? pull_class_stationary(&team, partition, i, pi, MARKOV_STATIONARY_EPSILON, budget)
+                                      : class_stationary_distribution(&ctx->P, partition, i, pi, MARKOV_STATIONARY_EPSILON, budget,
+                                                                      work, &converged);
+                        failed = iterations[i] < 0;
+                        if (pulled) converged = team.converged;
+                        // Budget atteint (les valeurs de Ritz minorent |lambda_2|) : reprise à chaud jusqu'au plafond habituel
+                        if (!failed && !converged && budget < MARKOV_STATIONARY_MAX_ITER) {
+                            int more = class_stationary_distribution_warm(&ctx->P, partition, i, pi, MARKOV_STATIONARY_EPSILON,
+                                                                          MARKOV_STATIONARY_MAX_ITER - budget, work, &converged);
+                            failed = more < 0;
+                            iterations[i] += more;
+                        }
+                    }
+                }
+                if (!restored && !failed && checkpoint != NULL) checkpoint_end_class(checkpoint, i, iterations[i], solvers[i], pi);
+                if (!failed && !converged) unconverged++;
+                for (int m = 0; m < c.num_members && !failed; m++) {
+                    int v = c.members_ids[m] - 1;
+                    subclass_limit[v] = periods[i] * pi[v];
+                }
+                continue;
+            }
+            int budget = DENSE_MAX_PRODUCTS, squaring = 0;
+            iterations[i] = -1;
+            if (spectral != NULL) {
+                expected[i] = spectral_dense_products(&spectral[i], periods[i], c.num_members, &solvers[i]);
+                squaring = (solvers[i] == SPECTRAL_SOLVER_SQUARE);
+                budget = spectral_budget(expected[i], squaring ? DENSE_MAX_SQUARINGS : DENSE_MAX_PRODUCTS);
+            }
+            t_matrix sub = class_matrix_from_graph(ctx->graph, partition, i);
+            t_matrix sub_limit = (sub.data == NULL) ? sub
+                               : (periods[i] > 1) ? periodicLimitBudget(sub, periods[i], budget, squaring)
+                                                  : stationaryDistributionBudget(sub, budget, squaring);
+            failed = (sub_limit.data == NULL);
+            for (int m = 0; m < c.num_members && !failed; m++) {
+                int v = c.members_ids[m] - 1;
+                // Sur M^d, la ligne m converge vers la limite de la sous-classe de m ; pi en est la moyenne sur les d sous-classes
+                subclass_limit[v] = (periods[i] > 1) ? sub_limit.data[m][m] : sub_limit.data[0][m];
+                pi[v] = subclass_limit[v] / periods[i];
+            }
+            if (sub_limit.data != sub.data) free_matrix(sub_limit);
+            free_matrix(sub);
+        }
+        profile_end(prof);
+        if (!failed && unconverged > 0) {
+            fprintf(out, "Avertissement : %d classe(s) sans convergence apres %d iterations : resultat approche.\n\n",
+                    unconverged, MARKOV_STATIONARY_MAX_ITER);
+        }
+
+        // 3.3 Pondération par l'absorption depuis l'état 1
+        profile_begin(prof, engine == PLAN_ENGINE_BLOCK ? "block_absorption_from_vertex" : "absorption_from_vertex");
+        if (!failed) {
+            failed = ((engine == PLAN_ENGINE_BLOCK) ? block_absorption_from_vertex(&blocks, partition, source, class_mass)
+                                                    : absorption_from_vertex(&ctx->P, partition, source, class_mass)) != 0;
+        }
+        profile_end(prof);
+        free_block_matrix(blocks);
+        pull_team_free(&team);
+        free(work);
+
+        if (failed) {
+            free(limit_row);
+            limit_row = NULL;
+        } else {
+            for (int j = 0; j < N; j++) limit_row[j] = class_mass[partition.v_data[j].class_id - 1] * pi[j];
+        }
+    }
 
     // 3.3 Affichage de la Distribution Limite
-    display_stationary_distribution(matrix_limit);
+    if (limit_row != NULL && spectral != NULL) display_spectral_estimates(out, ctx, spectral, pi, expected, iterations, solvers);
+    display_stationary_distribution(out, ctx, limit_row);
+    if (limit_row != NULL && common_period > 1) display_cyclic_limits(out, ctx, periods, phase, subclass_limit);
 
-    // =================================
-    // DÉFI BONUS : CALCUL DE LA PÉRIODE
-    // =================================
-    printf("\n--- DEFI BONUS : Calcul de la periode ---\n");
+    free(limit_row);
+    free(pi);
+    free(class_mass);
+    free(subclass_limit);
+    free(phase);
+    free(periods);
+    free(expected);
+    free(iterations);
+    free(solvers);
+    return 0;
+}
+
+/*
+   display_checkpoint_resume :
+   Le taux de convergence de la classe en cours est estimé sur les écarts enregistrés
+   e_1 ... e_n : r = (e_n / e_1)^(1 / (n - 1)), et il reste environ
+   ln(epsilon / e_n) / ln(r) itérations.
+*/
+static void display_checkpoint_resume(FILE *out, const t_markov_ctx *ctx, const t_checkpointer *cp) {
+    int done = 0;
+    for (int i = 0; i < cp->num_classes; i++) done += checkpoint_class_done(cp, i);
+    fprintf(out, "Reprise du point %s : %d classe(s) terminee(s)", cp->path, done);
+    if (cp->current_class >= 0) {
+        fprintf(out, ", classe C%d reprise apres %d iteration(s)", ctx->partition.classes[cp->current_class].id,
+                cp->iterations[cp->current_class]);
+        int n = cp->history_length;
+        if (n >= 2) {
+            double first = cp->history[cp->history_start];
+            double last = cp->history[(cp->history_start + n - 1) % CHECKPOINT_HISTORY];
+            fprintf(out, " (dernier ecart %.3e", last);
+            if (first > 0.0 && last > 0.0 && last < first) {
+                double rate = pow(last / first, 1.0 / (n - 1));
+                fprintf(out, ", environ %.0f restante(s)", ceil(log(cp->epsilon / last) / log(rate)));
+            }
+            fprintf(out, ")");
+        }
+    }
+    fprintf(out, ".\n\n");
+}
+
+/*
+   run_period_stage :
+   dense : sous-matrice extraite de la matrice N x N (construite ici si la tâche de
+   conversion ne l'a pas déjà fait) ; per-class : sous-matrice lue dans la liste
+   d'adjacence ; sparse : parcours en largeur sur la CSR.
+*/
+static void run_period_stage(FILE *out, const t_markov_ctx *ctx, t_plan_engine engine, t_matrix *matrix_T, t_profiler *prof) {
+    t_partition partition = ctx->partition;
+
+    if (engine == PLAN_ENGINE_DENSE && matrix_T->data == NULL) {
+        profile_begin(prof, "adj_list_to_matrix");
+        *matrix_T = adj_list_to_matrix(ctx->graph);
+        profile_end(prof);
+        if (matrix_T->data == NULL) {
+            fprintf(stderr, "Erreur: Matrice de transition %dx%d impossible a allouer.\n", ctx->num_vertices, ctx->num_vertices);
+            return;
+        }
+    }
 
     int found_persistent_class = 0;
+    profile_begin(prof, engine == PLAN_ENGINE_SPARSE ? "class_period_sparse" : "get_class_period");
 
     if (partition.num_classes > 0) {
         for (int i = 0; i < partition.num_classes; i++) {
@@ -164,81 +1250,1079 @@ int main(int argc, char *argv[]) {
             if (current_class.is_persistent) {
                 found_persistent_class = 1;
 
-                t_matrix sub_M = subMatrix(matrix_T, partition, i);
-
-                int period = get_class_period(sub_M);
+                int period;
+                if (engine == PLAN_ENGINE_CACHE || engine == PLAN_ENGINE_DELTA) {
+                    period = ctx->periods[i];
+                } else if (engine == PLAN_ENGINE_SPARSE) {
+                    period = class_period_sparse(&ctx->P, partition, i);
+                } else {
+                    t_matrix sub_M = (engine == PLAN_ENGINE_DENSE) ? subMatrix(*matrix_T, partition, i)
+                                                                   : class_matrix_from_graph(ctx->graph, partition, i);
+                    period = (sub_M.data != NULL) ? get_class_period(sub_M) : -1;
+                    free_matrix(sub_M);
+                }
 
-                printf("Classe C%d (%s) : Periode = %d\n",
+                fprintf(out, "Classe C%d (%s) : Periode = %d\n",
                        current_class.id,
                        period == 1 ? "Aperiodique" : "Periodique",
                        period);
-
-                free_matrix(sub_M);
             }
         }
 
         if (!found_persistent_class) {
-            printf("Statut : Aucune classe persistante trouvee. Periode non calculee.\n");
+            fprintf(out, "Statut : Aucune classe persistante trouvee. Periode non calculee.\n");
         }
 
     } else {
-        printf("Statut : Aucune classe trouvee. Analyse de periode impossible.\n");
+        fprintf(out, "Statut : Aucune classe trouvee. Analyse de periode impossible.\n");
     }
+    profile_end(prof);
+}
 
+/*
+   task_mermaid, task_characterize, task_hasse :
+   Les liens de Hasse sont construits par markov_analyze_classes, avant le plan : le
+   diagramme s'écrit sans attendre la partie 2.
+*/
+static int task_mermaid(void *arg, FILE *out) {
+    t_stage_inputs *in = (t_stage_inputs *)arg;
+    profile_begin(in->prof, "generate_mermaid_file");
+    t_markov_status status = markov_write_mermaid(in->ctx, in->graph_path);
+    profile_end(in->prof);
+    if (status != MARKOV_OK) return -1;
+    fprintf(out, "Fichier mermaid genere: %s\n", in->graph_path);
+    fprintf(out, "\n => Graphe visualise dans : %s\n", in->graph_path);
+    return 0;
+}
 
-    // ================
-    // NETTOYAGE ET FIN
-    // ================
+static int task_characterize(void *arg, FILE *out) {
+    t_stage_inputs *in = (t_stage_inputs *)arg;
+    const t_markov_ctx *ctx = in->ctx;
+    fprintf(out, "\n--- PARTIE 2 : Structure du graphe ---\n");
 
-    free_matrix(matrix_T);
-    if (matrix_limit.data != NULL) free_matrix(matrix_limit);
-    free_link_array(hasse_links);
-    free_partition(partition);
-    free_graph(graph);
+    // 2.1 Algorithme de Tarjan : Trouver les CFCs (Classes)
+    // 2.2 Détermination des types de Classes (Stockage de l'information)
+    // 2.4 Construction du Diagramme de Hasse (Graphe des Classes)
+    // Les trois étapes ont été faites par markov_analyze_classes avant le plan.
+    fprintf(out, "\n2.1 Recherche des classes (CFCs) via Tarjan\n\n");
+    fprintf(out, "\n2.2 Stockage de la persistance pour l'analyse future\n\n");
 
-    return EXIT_SUCCESS;
+    // 2.3 Affichage des caractéristiques (Utilisation de votre fonction Characterize)
+    profile_begin(in->prof, "Characterize");
+    Characterize(out, ctx->partition, ctx->original_ids, (ctx->labels.count > 0) ? &ctx->labels : NULL);
+    profile_end(in->prof);
+    return 0;
 }
 
-//Affiche les caractéristiques d'irréductibilité et les états absorbants.
-void display_graph_characteristics(t_graph graph, t_partition partition) {
-    printf("\n--- Caracteristiques du graphe ---\n");
+static int task_hasse(void *arg, FILE *out) {
+    t_stage_inputs *in = (t_stage_inputs *)arg;
+    fprintf(out, "\n2.4 Construction du diagramme de Hasse\n\n");
 
-    // 1. Irréductibilité
-    if (partition.num_classes == 1) {
-        printf("Propriete : Le graphe est irreductible (une seule classe).\n");
+    // 2.5 Visualisation du Diagramme de Hasse (Mermaid)
+    profile_begin(in->prof, "generate_hasse_mermaid_file");
+    t_markov_status status = markov_write_hasse(in->ctx, in->hasse_path);
+    profile_end(in->prof);
+    if (status != MARKOV_OK) return -1;
+    fprintf(out, "Fichier mermaid du diagramme de Hasse genere: %s\n", in->hasse_path);
+    fprintf(out, "\n => Diagramme de Hasse visualise dans : %s\n", in->hasse_path);
+    return 0;
+}
+
+//task_matrix : matrice N x N des moteurs denses, construite une fois pour les parties 3 et période.
+static int task_matrix(void *arg, FILE *out) {
+    t_stage_inputs *in = (t_stage_inputs *)arg;
+    (void)out;
+    profile_begin(in->prof, "adj_list_to_matrix");
+    *in->matrix_T = adj_list_to_matrix(in->ctx->graph);
+    profile_end(in->prof);
+    if (in->matrix_T->data == NULL) {
+        fprintf(stderr, "Erreur: Matrice de transition %dx%d impossible a allouer.\n", in->ctx->num_vertices,
+                in->ctx->num_vertices);
+        return -1;
+    }
+    return 0;
+}
+
+static int task_stationary(void *arg, FILE *out) {
+    t_stage_inputs *in = (t_stage_inputs *)arg;
+    fprintf(out, "\n--- PARTIE 3 : Probabilites et convergence ---\n");
+    return run_stationary_stage(out, in->ctx, in->plan->steps[PLAN_STAGE_STATIONARY].engine, in->spectral, in->matrix_T,
+                                in->checkpoint, in->prof);
+}
+
+static int task_period(void *arg, FILE *out) {
+    t_stage_inputs *in = (t_stage_inputs *)arg;
+    fprintf(out, "\n--- DEFI BONUS : Calcul de la periode ---\n");
+    run_period_stage(out, in->ctx, in->plan->steps[PLAN_STAGE_PERIOD].engine, in->matrix_T, in->prof);
+    return 0;
+}
+
+/*
+   run_power_stage :
+   P^K complète, sans matrice N x N en mémoire : la CSR est recopiée dans une matrice
+   par tuiles projetée depuis un fichier temporaire, puis élevée à la puissance K par
+   tiled_power. L'ensemble de travail des produits est le quart du budget --max-memory,
+   le reste étant laissé au graphe et au cache de pages du noyau. P^K est écrite dans
+   <base_name>_P<K>.mtx, tuile par tuile (cases non nulles, numéros du fichier) ; seule
+   la ligne de l'état 1 est affichée.
+*/
+static int run_power_stage(const t_markov_ctx *ctx, int power, const char *scratch_dir, long long max_memory, const char *base_name,
+                           t_profiler *prof) {
+    char path[MAX_PATH_LENGTH];
+    if (snprintf(path, sizeof(path), "%s_P%d.mtx", base_name, power) >= (int)sizeof(path)) {
+        fprintf(stderr, "Erreur: Chemin de sortie trop long pour %s_P%d.mtx.\n", base_name, power);
+        return -1;
+    }
+    int N = ctx->num_vertices;
+    long long working_bytes = (max_memory > 0) ? max_memory / 4 : TILED_DEFAULT_WORKING_BYTES;
+    struct timespec start, end;
+
+    // La CSR du contexte n'existe qu'une fois les classes analysées (--stages sans classes)
+    t_csr local = {0, 0, NULL, NULL, NULL};
+    const t_csr *P = &ctx->P;
+    if (P->row_ptr == NULL) {
+        local = graph_to_csr(ctx->graph);
+        P = &local;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    profile_begin(prof, "tiled_from_csr");
+    t_tiled_matrix M = tiled_from_csr(P, working_bytes, scratch_dir);
+    profile_end(prof);
+    free_csr(local);
+    if (M.data == NULL) {
+        fprintf(stderr, "Erreur: Matrice par tuiles %dx%d impossible a creer dans %s.\n", N, N, scratch_dir);
+        return -1;
+    }
+    printf("Matrice par tuiles : %d x %d tuiles de %d x %d, %.1f Mo par matrice dans %s (%s)\n",
+           M.num_tiles, M.num_tiles, M.tile, M.tile, M.bytes / (1024.0 * 1024.0), scratch_dir,
+           M.stream ? "hors memoire" : "tient dans l'ensemble de travail");
+
+    profile_begin(prof, "tiled_power");
+    t_tiled_matrix Mk = tiled_power(&M, power, scratch_dir);
+    profile_end(prof);
+    tiled_free(M);
+    double *row = (Mk.data != NULL) ? (double *)malloc(N * sizeof(double)) : NULL;
+    if (row == NULL) {
+        fprintf(stderr, "Erreur: Calcul de P^%d impossible (memoire ou espace disque insuffisant).\n", power);
+        tiled_free(Mk);
+        return -1;
+    }
+    tiled_row(&Mk, markov_internal_id(ctx, 1) - 1, row);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double elapsed_ms = (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1e6;
+    printf("P^%d calculee en %.3f ms.\n", power, elapsed_ms);
+
+    char comment[128];
+    snprintf(comment, sizeof(comment), "P^%d : entree (i, j) = probabilite d'aller de i a j en %d pas", power, power);
+    profile_begin(prof, "write_mtx");
+    int written = mtx_write_tiled(&Mk, path, ctx->original_ids, comment);
+    profile_end(prof);
+    tiled_free(Mk);
+    if (written != 0) {
+        fprintf(stderr, "Erreur: Export de %s impossible.\n", path);
+        free(row);
+        return -1;
+    }
+    printf("P^%d ecrite : %s\n\n", power, path);
+    printf("Distribution apres %d pas depuis l'etat 1 (ligne 1 de P^%d, probabilites nulles omises):\n\n", power, power);
+    int width = state_column_width(&ctx->labels, N);
+    display_probability_header(stdout, "Sommet", width);
+    double total = 0.0;
+    char name[16];
+    for (int i = 0; i < N; i++) {
+        double p = row[markov_internal_id(ctx, i + 1) - 1];
+        total += p;
+        if (p != 0.0) printf("  %-*s |   %.4f\n", width, state_name(ctx, i + 1, name, sizeof(name)), p);
+    }
+    printf("Somme de la ligne : %.6f\n", total);
+
+    free(row);
+    return 0;
+}
+
+/*
+   run_export_stage :
+   Les vecteurs exportés sont ceux de la bibliothèque (markov_solve, itération creuse
+   par classe), exécutée ici si l'analyse (cache, delta) ne l'a pas déjà faite.
+   Sans l'étape des classes (--stages), seule la matrice de transition est écrite.
+*/
+static int run_export_stage(t_markov_ctx *ctx, const char *base_name, t_profiler *prof) {
+    char path[MAX_PATH_LENGTH];
+    if (build_output_path(path, sizeof(path), base_name, "_P.mtx") != 0) return -1;
+    profile_begin(prof, "write_mtx");
+    t_markov_status status = markov_write_matrix_mtx(ctx, path);
+    profile_end(prof);
+    if (status != MARKOV_OK) {
+        fprintf(stderr, "Erreur: Export de %s impossible (%s).\n", path, markov_status_string(status));
+        return -1;
+    }
+    printf("Matrice de transition ecrite : %s\n", path);
+    if (!(ctx->stages_done & MARKOV_STAGE_CLASSES)) return 0;
+    if (ensure_solved(ctx, prof) != 0) return -1;
+
+    if (build_output_path(path, sizeof(path), base_name, "_stationary.mtx") != 0) return -1;
+    profile_begin(prof, "write_mtx");
+    status = markov_write_stationary_mtx(ctx, path);
+    profile_end(prof);
+    if (status != MARKOV_OK) {
+        fprintf(stderr, "Erreur: Export de %s impossible (%s).\n", path, markov_status_string(status));
+        return -1;
+    }
+    printf("Distributions stationnaires ecrites : %s\n", path);
+
+    if (build_output_path(path, sizeof(path), base_name, "_absorption.mtx") != 0) return -1;
+    profile_begin(prof, "write_mtx");
+    status = markov_write_absorption_mtx(ctx, path);
+    profile_end(prof);
+    if (status != MARKOV_OK) {
+        fprintf(stderr, "Erreur: Export de %s impossible (%s).\n", path, markov_status_string(status));
+        return -1;
+    }
+    printf("Probabilites d'absorption ecrites : %s (%d classe(s) persistante(s))\n", path, ctx->num_persistent);
+    return 0;
+}
+
+static int ensure_solved(t_markov_ctx *ctx, t_profiler *prof) {
+    if (ctx->stages_done & MARKOV_STAGE_SOLVED) return 0;
+    profile_begin(prof, "markov_solve");
+    t_markov_status status = markov_solve(ctx);
+    profile_end(prof);
+    if (status != MARKOV_OK) {
+        fprintf(stderr, "Erreur: Distributions stationnaires impossibles a calculer (%s).\n", markov_status_string(status));
+        return -1;
+    }
+    if (ctx->num_unconverged > 0) {
+        printf("Avertissement : %d classe(s) sans convergence apres %d iterations : resultat approche.\n",
+               ctx->num_unconverged, MARKOV_STATIONARY_MAX_ITER);
+    }
+    return 0;
+}
+
+/*
+   run_whatif_stage :
+   Toutes les modifications sont évaluées ensemble (sensitivity_batch) : chaque ligne
+   ou colonne nécessaire n'est résolue qu'une fois, quel que soit le nombre de
+   modifications qui partent du même état.
+*/
+static int run_whatif_stage(t_markov_ctx *ctx, const char *whatif_path, t_profiler *prof) {
+    t_perturbation *perturbations;
+    int count;
+    t_markov_status status = sensitivity_load_file(whatif_path, ctx, &perturbations, &count);
+    if (status != MARKOV_OK) {
+        fprintf(stderr, "Erreur: Lecture des modifications %s echouee (%s).\n", whatif_path, markov_status_string(status));
+        return -1;
+    }
+    if (ensure_solved(ctx, prof) != 0) {
+        free(perturbations);
+        return -1;
+    }
+
+    t_sensitivity sensitivity;
+    t_whatif_effect *effects = (t_whatif_effect *)malloc((count > 0 ? count : 1) * sizeof(t_whatif_effect));
+    status = (effects != NULL) ? sensitivity_init(&sensitivity, ctx) : MARKOV_ERR_NOMEM;
+    if (status != MARKOV_OK) {
+        fprintf(stderr, "Erreur: Analyse de sensibilite impossible (%s).\n", markov_status_string(status));
+        free(effects);
+        free(perturbations);
+        return -1;
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    profile_begin(prof, "sensitivity_batch");
+    status = sensitivity_batch(&sensitivity, perturbations, count, 0, effects);
+    profile_end(prof);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double elapsed_ms = (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1e6;
+
+    if (status == MARKOV_OK) {
+        printf("Modifications (%s) : %d evaluee(s) en %.3f ms, %lld ligne(s) ou colonne(s) resolue(s) (%lld iterations)\n",
+               whatif_path, count, elapsed_ms, sensitivity.solves, sensitivity.iterations);
+        printf("  Transition           |    delta | Effet\n");
+        char from_name[16], to_name[16], state[16], transition[64];
+        for (int m = 0; m < count; m++) {
+            t_whatif_effect *effect = &effects[m];
+            snprintf(transition, sizeof(transition), "%s -> %s",
+                     state_name(ctx, markov_original_id(ctx, perturbations[m].from), from_name, sizeof(from_name)),
+                     state_name(ctx, markov_original_id(ctx, perturbations[m].to), to_name, sizeof(to_name)));
+            printf("  %-20s | %+8.4f | ", transition, perturbations[m].delta);
+            if (effect->status != MARKOV_OK) {
+                printf("refusee (classes modifiees : utiliser --delta)\n");
+            } else if (effect->target_class == effect->class_id) {
+                printf("C%d, somme |dpi| = %.6f, etat %s : %.6f -> %.6f\n", effect->class_id, effect->stationary_l1,
+                       state_name(ctx, markov_original_id(ctx, effect->most_changed), state, sizeof(state)),
+                       effect->before, effect->after);
+            } else {
+                printf("max |dh| = %.6f, etat %s absorbe par C%d : %.6f -> %.6f\n", effect->absorption_max,
+                       state_name(ctx, markov_original_id(ctx, effect->most_changed), state, sizeof(state)),
+                       effect->target_class, effect->before, effect->after);
+            }
+        }
     } else {
-        printf("Propriete : Le graphe est reductible (%d classes).\n", partition.num_classes);
+        fprintf(stderr, "Erreur: Analyse de sensibilite impossible (%s).\n", markov_status_string(status));
     }
 
-    // 2. États Absorbants (Classe Persistante de taille 1)
-    int has_absorbing = 0;
-    for (int i = 0; i < partition.num_classes; i++) {
-        t_class c = partition.classes[i];
+    sensitivity_free(&sensitivity);
+    free(effects);
+    free(perturbations);
+    return (status == MARKOV_OK) ? 0 : -1;
+}
 
-        if (c.is_persistent && c.num_members == 1) {
-            printf("Etat absorbant trouve : sommet %d.\n", c.members_ids[0]);
-            has_absorbing = 1;
+//display_top_edges : les GRADIENT_DISPLAY_MAX transitions de plus grande dérivée en valeur absolue.
+static void display_top_edges(const t_markov_ctx *ctx, const double *gradient) {
+    const t_csr *P = &ctx->P;
+    int edges[GRADIENT_DISPLAY_MAX];
+    int shown = sensitivity_top_edges(gradient, P->num_edges, GRADIENT_DISPLAY_MAX, edges);
+    for (int k = 0; k < shown; k++) {
+        int e = edges[k];
+        int from = 0;
+        while (P->row_ptr[from + 1] <= e) from++;
+        char from_name[16], to_name[16], transition[64];
+        snprintf(transition, sizeof(transition), "%s -> %s",
+                 state_name(ctx, markov_original_id(ctx, from + 1), from_name, sizeof(from_name)),
+                 state_name(ctx, markov_original_id(ctx, P->col_idx[e] + 1), to_name, sizeof(to_name)));
+        printf("    %-20s | P = %.4f | derivee %+.6f\n", transition, P->values[e], gradient[e]);
+    }
+    if (shown == 0) printf("    Aucune transition n'a d'effet.\n");
+}
+
+/*
+   run_gradient_stage :
+   Une seule résolution par probabilité dérivée : la colonne de l'inverse de groupe
+   pour un état persistant, la ligne de la matrice fondamentale (une par classe
+   d'absorption possible) pour un état transitoire.
+*/
+static int run_gradient_stage(t_markov_ctx *ctx, const char *state, t_profiler *prof) {
+    int v = markov_find_state(ctx, state);
+    if (v == 0) {
+        fprintf(stderr, "Erreur: Etat %s inconnu pour --gradient.\n", state);
+        return -1;
+    }
+    if (ensure_solved(ctx, prof) != 0) return -1;
+
+    t_sensitivity sensitivity;
+    double *gradient = (double *)malloc((ctx->P.num_edges > 0 ? ctx->P.num_edges : 1) * sizeof(double));
+    t_markov_status status = (gradient != NULL) ? sensitivity_init(&sensitivity, ctx) : MARKOV_ERR_NOMEM;
+    if (status != MARKOV_OK) {
+        fprintf(stderr, "Erreur: Analyse de sensibilite impossible (%s).\n", markov_status_string(status));
+        free(gradient);
+        return -1;
+    }
+
+    int target = markov_internal_id(ctx, v);
+    int class_id = ctx->partition.v_data[target - 1].class_id;
+    char name[16];
+    profile_begin(prof, "sensitivity_gradient");
+    if (ctx->persistent_index[class_id - 1] >= 0) {
+        status = sensitivity_stationary_gradient(&sensitivity, target, gradient);
+        if (status == MARKOV_OK) {
+            printf("Derivees de pi(%s) = %.6f (classe C%d) par rapport aux transitions :\n",
+                   state_name(ctx, v, name, sizeof(name)), ctx->stationary[target - 1], class_id);
+            display_top_edges(ctx, gradient);
+        }
+    } else {
+        double *class_mass = (double *)malloc(ctx->partition.num_classes * sizeof(double));
+        status = (class_mass != NULL) ? markov_absorption_row(ctx, target, class_mass) : MARKOV_ERR_NOMEM;
+        for (int c = 0; c < ctx->partition.num_classes && status == MARKOV_OK; c++) {
+            if (class_mass[c] <= 0.0) continue;
+            status = sensitivity_absorption_gradient(&sensitivity, target, c + 1, gradient);
+            if (status != MARKOV_OK) break;
+            printf("Derivees de l'absorption de %s par C%d (%.6f) par rapport aux transitions :\n",
+                   state_name(ctx, v, name, sizeof(name)), c + 1, class_mass[c]);
+            display_top_edges(ctx, gradient);
         }
+        free(class_mass);
     }
-    if (!has_absorbing) {
-        printf("Aucun etat absorbant trouve.\n");
+    profile_end(prof);
+    if (status != MARKOV_OK) {
+        fprintf(stderr, "Erreur: Derivees impossibles a calculer (%s).\n", markov_status_string(status));
+    } else {
+        printf("  %lld resolution(s), %lld iterations\n", sensitivity.solves, sensitivity.iterations);
+    }
+
+    sensitivity_free(&sensitivity);
+    free(gradient);
+    return (status == MARKOV_OK) ? 0 : -1;
+}
+
+/*
+   parse_state_list :
+   Convertit une liste "a,b,c" (numéros du fichier ou étiquettes) en numéros internes.
+   Retourne le nombre d'états lus, ou -1 si un état est inconnu ou si la liste est
+   vide ou trop longue.
+*/
+static int parse_state_list(const t_markov_ctx *ctx, const char *list, int *states, int max_states) {
+    char copy[1024];
+    snprintf(copy, sizeof(copy), "%s", list);
+    int count = 0;
+    for (char *token = strtok(copy, ","); token != NULL; token = strtok(NULL, ",")) {
+        int v = markov_find_state(ctx, token);
+        if (v == 0) {
+            fprintf(stderr, "Erreur: Etat %s inconnu.\n", token);
+            return -1;
+        }
+        if (count == max_states) {
+            fprintf(stderr, "Erreur: Plus de %d etats dans la liste %s.\n", max_states, list);
+            return -1;
+        }
+        states[count++] = markov_internal_id(ctx, v);
     }
+    if (count == 0) fprintf(stderr, "Erreur: Liste d'etats vide.\n");
+    return (count > 0) ? count : -1;
 }
 
+//Affiche le coût d'une estimation locale, et le budget épuisé s'il y a lieu.
+static void display_push_cost(const t_markov_ctx *ctx, const t_push_result *result, double elapsed_ms) {
+    printf("    residu %.3g, %lld poussees, %lld aretes, %d etats touches sur %d, %.3f ms%s\n", result->residual,
+           result->pushes, result->edges, result->touched, ctx->graph.num_vertices, elapsed_ms,
+           result->converged ? "" : " (budget de poussees epuise)");
+}
 
-//Affiche le vecteur de distribution stationnaire (première ligne de la matrice limite).
-static void display_stationary_distribution(t_matrix matrix_limit) {
-    if (matrix_limit.rows == 0 || matrix_limit.data == NULL) {
-        printf("Distribution stationnaire non calculee ou non convergee.\n");
+/*
+   run_backward_hitting :
+   Plusieurs départs pour une même cible : une seule poussée arrière sur les arêtes
+   entrantes. ctx->PT sert s'il existe (--pull) ; sinon la transposée est construite
+   pour la requête depuis ctx->P, ou depuis la liste d'adjacence avec --stages check.
+*/
+static int run_backward_hitting(const t_markov_ctx *ctx, const char *source_list, const char *target_list, const int *targets,
+                                int num_targets, double epsilon, t_profiler *prof) {
+    int sources[LOCAL_MAX_STATES];
+    int count = parse_state_list(ctx, source_list, sources, LOCAL_MAX_STATES);
+    if (count < 0) return -1;
+
+    t_csr P = {0, 0, NULL, NULL, NULL}, PT = {0, 0, NULL, NULL, NULL};
+    const t_csr *in_edges = &ctx->PT;
+    if (in_edges->row_ptr == NULL) {
+        if (ctx->P.row_ptr == NULL) P = graph_to_csr(ctx->graph);
+        PT = csr_transpose((ctx->P.row_ptr != NULL) ? &ctx->P : &P);
+        free_csr(P);
+        if (PT.row_ptr == NULL) {
+            fprintf(stderr, "Erreur: Estimation locale impossible (%s).\n", markov_status_string(MARKOV_ERR_NOMEM));
+            return -1;
+        }
+        in_edges = &PT;
+    }
+
+    t_push_result results[LOCAL_MAX_STATES];
+    struct timespec start, end;
+    profile_begin(prof, "local_hitting_backward");
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    t_markov_status status = push_hitting_backward(ctx->graph, in_edges, targets, num_targets, sources, count, epsilon,
+                                                   PUSH_DEFAULT_MAX_PUSHES, results);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    profile_end(prof);
+    free_csr(PT);
+    if (status != MARKOV_OK) {
+        fprintf(stderr, "Erreur: Estimation locale impossible (%s).\n", markov_status_string(status));
+        return -1;
+    }
+
+    char name[16];
+    double elapsed_ms = (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1e6;
+    for (int k = 0; k < count; k++) {
+        printf("  P(%s atteint {%s}) >= %.6g\n", state_name(ctx, markov_original_id(ctx, sources[k]), name, sizeof(name)),
+               target_list, results[k].lower);
+    }
+    printf("  (poussee arriere : ecart au plus %g fois le nombre moyen de pas avant la cible)\n", epsilon);
+    display_push_cost(ctx, &results[0], elapsed_ms);
+    return 0;
+}
+
+/*
+   run_local_stage :
+   Les poussées ne lisent que la liste d'adjacence : ni les classes ni la CSR ne sont
+   nécessaires, l'estimation marche donc aussi avec --stages check sur une chaîne trop
+   grande pour l'analyse globale.
+*/
+static int run_local_stage(const t_markov_ctx *ctx, const char *pi_states, const char *hit_query, double epsilon, t_profiler *prof) {
+    int states[LOCAL_MAX_STATES];
+    char name[16];
+    struct timespec start, end;
+    t_push_result result;
+
+    if (pi_states != NULL) {
+        int count = parse_state_list(ctx, pi_states, states, LOCAL_MAX_STATES);
+        if (count < 0) return -1;
+        profile_begin(prof, "local_stationary");
+        for (int k = 0; k < count; k++) {
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            t_markov_status status = push_stationary(ctx->graph, states[k], epsilon, PUSH_DEFAULT_MAX_PUSHES, &result);
+            clock_gettime(CLOCK_MONOTONIC, &end);
+            if (status != MARKOV_OK) {
+                profile_end(prof);
+                fprintf(stderr, "Erreur: Estimation locale impossible (%s).\n", markov_status_string(status));
+                return -1;
+            }
+            double elapsed_ms = (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1e6;
+            const char *label = state_name(ctx, markov_original_id(ctx, states[k]), name, sizeof(name));
+            if (result.upper == 0.0) {
+                printf("  pi(%s) = 0 (masse piegee dans une classe fermee : etat transitoire)\n", label);
+            } else {
+                printf("  pi(%s) ~ %.6g (<= %.6g)\n", label, result.estimate, result.upper);
+            }
+            display_push_cost(ctx, &result, elapsed_ms);
+        }
+        profile_end(prof);
+    }
+
+    if (hit_query != NULL) {
+        const char *colon = strchr(hit_query, ':');
+        if (colon == NULL || colon == hit_query) {
+            fprintf(stderr, "Erreur: --local-hit attend SOURCE:CIBLE1,CIBLE2,...\n");
+            return -1;
+        }
+        char source_token[256];
+        snprintf(source_token, sizeof(source_token), "%.*s", (int)(colon - hit_query), hit_query);
+        int count = parse_state_list(ctx, colon + 1, states, LOCAL_MAX_STATES);
+        if (count < 0) return -1;
+        if (strchr(source_token, ',') != NULL) return run_backward_hitting(ctx, source_token, colon + 1, states, count, epsilon, prof);
+        int source = markov_find_state(ctx, source_token);
+        if (source == 0) {
+            fprintf(stderr, "Erreur: Etat %s inconnu.\n", source_token);
+            return -1;
+        }
+
+        profile_begin(prof, "local_hitting");
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        t_markov_status status = push_hitting_probability(ctx->graph, markov_internal_id(ctx, source), states, count, epsilon,
+                                                          PUSH_DEFAULT_MAX_PUSHES, &result);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        profile_end(prof);
+        if (status != MARKOV_OK) {
+            fprintf(stderr, "Erreur: Estimation locale impossible (%s).\n", markov_status_string(status));
+            return -1;
+        }
+        double elapsed_ms = (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1e6;
+        printf("  P(%s atteint {%s}) ~ %.6g, dans [%.6g, %.6g]\n", state_name(ctx, source, name, sizeof(name)), colon + 1,
+               result.estimate, result.lower, result.upper);
+        display_push_cost(ctx, &result, elapsed_ms);
+    }
+    return 0;
+}
+
+//Affiche l'aide de la ligne de commande.
+static void print_usage(const char *program_name) {
+    printf("Usage :\n");
+    printf("  %s [fichier]                 Analyse data/fichier (demande le nom si absent)\n", program_name);
+    printf("  %s --batch DOSSIER [options]  Analyse tous les .txt et .mtx du dossier en parallele\n", program_name);
+    printf("  %s --batch-list LISTE [...]   Analyse les fichiers listes (un chemin par ligne)\n", program_name);
+    printf("  %s --serve-stdin F1 [F2...]   Charge les chaines puis repond aux requetes sur stdin\n", program_name);
+    printf("  %s --serve SOCKET F1 [F2...]  Idem sur une socket Unix (un thread par client)\n", program_name);
+    printf("  %s --profile [fichier]        Analyse en mesurant chaque etape (rapport JSON + trace)\n", program_name);
+    printf("  %s --sequence LISTE [options] Chaine inhomogene : applique a la suite les matrices listees (un fichier par ligne)\n", program_name);
+    printf("  %s --compose FICHIER [options] Chaine composee de composantes (produit independant ou evenements synchronises)\n", program_name);
+    printf("\nOptions de l'analyse d'un fichier :\n");
+    printf("  --stages LISTE  Etapes parmi check,mermaid,classes,hasse,stationary,period (defaut : all)\n");
+    printf("  --max-memory T  Budget memoire du plan, ex. 512M ou 8G (defaut : memoire physique)\n");
+    printf("  --engine M      Moteur impose aux etapes stationary et period : dense, per-class, sparse, block (defaut : auto ; block : stationary seulement)\n");
+    printf("  --cache DOSSIER Resultats lus dans le cache s'ils y sont, enregistres sinon (aussi en modes batch et serveur)\n");
+    printf("  --delta FICHIER Applique des transitions ajoutees (+), retirees (-) ou reponderees (=) a la chaine analysee\n");
+    printf("  --reorder O     Renumerote les etats apres la lecture : bfs, rcm ou class (defaut : none) ; l'affichage garde les numeros du fichier\n");
+    printf("  --pull N        Construit l'index des aretes entrantes et itere les grandes classes en parallele par tirage sur N threads (0 = nombre de coeurs)\n");
+    printf("  --power K       Calcule P^K en dense, par tuiles dans un fichier temporaire (N x N au-dela de la memoire), l'ecrit dans <fichier>_P<K>.mtx et affiche la ligne de l'etat 1\n");
+    printf("  --scratch DOS.  Dossier des fichiers temporaires de --power (defaut : .)\n");
+    printf("  --mtx           Exporte P, les distributions stationnaires et les probabilites d'absorption au format Matrix Market\n");
+    printf("  --whatif FICH.  Effet de chaque modification \"depart arrivee delta\" du fichier (P(depart, arrivee) += delta, reste de la ligne remis a l'echelle) sans relancer l'analyse\n");
+    printf("  --gradient ETAT Transitions dont la modification change le plus la probabilite stationnaire (ou d'absorption) de l'etat\n");
+    printf("  --local-pi LISTE Estime pi(v) de chaque etat de la liste (a,b,...) par poussee locale, sans analyse globale\n");
+    printf("  --local-hit S:CIBLES Encadre la probabilite d'atteindre l'un des etats CIBLES (a,b,...) depuis S par poussee locale\n");
+    printf("                   Avec plusieurs departs (S1,S2,...:CIBLES), une seule poussee arriere les minore tous\n");
+    printf("  --push-epsilon E Masse residuelle laissee au plus sur chaque etat par --local-pi et --local-hit (defaut : 1e-6)\n");
+    printf("  --checkpoint F  Enregistre l'etat des iterations du moteur sparse dans F (point de reprise, supprime une fois le calcul termine)\n");
+    printf("  --checkpoint-every S Secondes entre deux points de reprise (defaut : 60)\n");
+    printf("  --resume        Reprend le calcul au point de reprise de --checkpoint s'il existe\n");
+    printf("  --jobs N        Etapes independantes (fichiers mermaid, parties 2 et 3, periode) en parallele sur N threads (defaut : nombre de coeurs, 1 : a la suite)\n");
+    printf("\nOptions du mode suite de matrices :\n");
+    printf("  --starts LISTE  Etats de depart a,b,... avances ensemble (defaut : 1)\n");
+    printf("  --cycles K      Distribution apres K passages par toute la suite (defaut : 1) ; le regime periodique est toujours calcule\n");
+    printf("\nOptions du mode chaine composee :\n");
+    printf("  --from ETAT     Etat global de depart e1:e2:... (un etat par composante, defaut : le premier de chacune)\n");
+    printf("  --kstep K       Distribution apres K pas (defaut : non calculee) ; la distribution limite est toujours calculee\n");
+    printf("\nOptions du mode batch :\n");
+    printf("  --out DOSSIER   Dossier des fichiers produits (defaut : .)\n");
+    printf("  --jobs N        Nombre de threads (defaut : nombre de coeurs)\n");
+    printf("\nRequetes du mode serveur (sommets numerotes de 1 a N, ou etiquettes d'un fichier etiquete, CH = nom du fichier sans extension) :\n");
+    printf("  list | quit | info CH | class CH V | stationary CH V | limit CH I J\n");
+    printf("  absorb CH V [C] | kstep CH V K | whatif CH I J D | gradient CH V [C]\n");
+    printf("  reach CH I J | reachable CH V\n");
+}
+
+/*
+   run_delta_stage :
+   La chaîne de base est déjà analysée (markov_analyze_cached) : le delta ne fait
+   recalculer que les classes touchées. Avec --cache, les résultats de la chaîne
+   modifiée sont aussi enregistrés, sous la clé de la chaîne modifiée.
+*/
+static int run_delta_stage(t_markov_ctx *ctx, const char *delta_path, const char *cache_dir, t_profiler *prof) {
+    t_delta delta;
+    t_delta_stats stats;
+
+    t_markov_status status = delta_load_file(delta_path, &delta);
+    if (status != MARKOV_OK) {
+        fprintf(stderr, "Erreur: Lecture du delta %s echouee (%s).\n", delta_path, markov_status_string(status));
+        return -1;
+    }
+    // Le fichier delta numérote les états comme le fichier de la chaîne (--reorder)
+    for (int i = 0; i < delta.num_ops; i++) {
+        delta.ops[i].from = markov_internal_id(ctx, delta.ops[i].from);
+        delta.ops[i].to = markov_internal_id(ctx, delta.ops[i].to);
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    profile_begin(prof, "apply_delta");
+    status = markov_apply_delta(ctx, &delta, &stats);
+    profile_end(prof);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    free_delta(&delta);
+    if (status != MARKOV_OK) {
+        fprintf(stderr, "Erreur: Delta %s non applique (%s).\n", delta_path, markov_status_string(status));
+        return -1;
+    }
+
+    double elapsed_ms = (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1e6;
+    printf("Delta (%s) : %d modification(s) sur %d sommet(s), appliquee(s) en %.3f ms\n",
+           delta_path, stats.num_ops, stats.touched_vertices, elapsed_ms);
+    printf("  Classes : %d -> %d (%d coupee(s), %d creee(s) par fusion, %d renumerotee(s))\n",
+           stats.classes_before, stats.classes_after, stats.split_classes, stats.merged_classes, stats.reordered_classes);
+    printf("  Recalcule : %d classe(s) modifiee(s), %d distribution(s) stationnaire(s), %d classe(s) transitoire(s), liens de Hasse %s\n",
+           stats.changed_classes, stats.stationary_solved, stats.absorption_solved,
+           stats.hasse_rebuilt ? "recalcules" : "conserves");
+
+    if (cache_dir != NULL && markov_cache_store(ctx, cache_dir) == MARKOV_OK) {
+        printf("  Resultats de la chaine modifiee enregistres dans le cache, cle %016llx\n",
+               (unsigned long long)markov_cache_key(ctx));
+    }
+    return 0;
+}
+
+//Mode batch : analyse d'un dossier ou d'une liste de fichiers sur un pool de threads.
+static int run_batch_mode(const char *source, int source_is_list, t_batch_options options) {
+    char **paths = NULL;
+    int count = source_is_list ? collect_batch_list(source, &paths) : collect_batch_dir(source, &paths);
+
+    if (count < 0) return EXIT_FAILURE;
+    if (count == 0) {
+        fprintf(stderr, "Erreur: Aucun fichier a analyser dans %s.\n", source);
+        return EXIT_FAILURE;
+    }
+
+    // Deux fichiers de même nom écriraient les mêmes sorties en même temps : refusé avant de lancer les threads
+    int first = 0, second = 0;
+    int duplicate = find_duplicate_output(paths, count, &first, &second);
+    if (duplicate != 0) {
+        if (duplicate > 0) fprintf(stderr, "Erreur: %s et %s produiraient les memes fichiers de sortie (meme nom sans extension).\n", paths[first], paths[second]);
+        free_batch_paths(paths, count);
+        return EXIT_FAILURE;
+    }
+
+    // Dossier de sortie créé avant de lancer les threads, comme le dossier du cache (store_with_key)
+    if (mkdir(options.output_dir, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "Erreur: Impossible de creer le dossier de sortie %s (%s).\n", options.output_dir, strerror(errno));
+        free_batch_paths(paths, count);
+        return EXIT_FAILURE;
+    }
+
+    t_batch_result *results = (t_batch_result *)calloc(count, sizeof(t_batch_result));
+    if (results == NULL) {
+        perror("Allocation failed for batch results");
+        free_batch_paths(paths, count);
+        return EXIT_FAILURE;
+    }
+
+    printf("==============================================\n");
+    printf("      Analyse batch de graphes de Markov      \n");
+    printf("==============================================\n");
+    printf("%d fichier(s), sorties dans : %s\n\n", count, options.output_dir);
+
+    double total_ms = run_batch(paths, count, options, results);
+    int failures = display_batch_summary(results, count, total_ms);
+
+    free(results);
+    free_batch_paths(paths, count);
+    return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+//Mode serveur : charge les chaînes une fois puis répond aux requêtes (stdin ou socket Unix).
+static int run_server_mode(char **chain_paths, int num_chains, const char *socket_path, const char *cache_dir) {
+    t_chain_registry registry;
+
+    if (num_chains == 0) {
+        fprintf(stderr, "Erreur: Aucune chaine a charger pour le mode serveur.\n");
+        return EXIT_FAILURE;
+    }
+
+    init_registry(&registry);
+    registry.cache_dir = cache_dir;
+    for (int i = 0; i < num_chains; i++) {
+        if (registry_load_chain(&registry, chain_paths[i]) != 0) {
+            fprintf(stderr, "Erreur: Chargement de %s impossible.\n", chain_paths[i]);
+            free_registry(&registry);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (socket_path == NULL) {
+        serve_stream(&registry, stdin, stdout);
+        free_registry(&registry);
+        return EXIT_SUCCESS;
+    }
+
+    // Des threads clients détachés peuvent encore lire le registre : il est libéré par la fin du processus
+    return serve_unix_socket(&registry, socket_path);
+}
+
+//État et probabilité d'une distribution affichée par le mode suite de matrices.
+typedef struct s_state_mass {
+    int v;
+    double p;
+} t_state_mass;
+
+//Probabilités décroissantes, puis états croissants.
+static int compare_state_mass(const void *a, const void *b) {
+    const t_state_mass *x = (const t_state_mass *)a;
+    const t_state_mass *y = (const t_state_mass *)b;
+    if (x->p != y->p) return (x->p < y->p) ? 1 : -1;
+    return x->v - y->v;
+}
+
+//Nom de l'état v (1..N) d'une suite de matrices : son étiquette, sinon son numéro sur deux chiffres.
+static const char *sequence_state_name(const t_chain_sequence *seq, int v, char *buffer, size_t size) {
+    const char *label = (seq->labels.count > 0) ? label_name(&seq->labels, v) : NULL;
+    if (label != NULL) return label;
+    snprintf(buffer, size, "%02d", v);
+    return buffer;
+}
+
+/*
+   display_sequence_distribution :
+   Vecteur b du bloc X (N x B, rangé état par état) : les SEQUENCE_DISPLAY_MAX états
+   les plus probables, les autres états de probabilité non nulle étant résumés.
+*/
+static void display_sequence_distribution(const t_chain_sequence *seq, const double *X, int B, int b) {
+    int N = seq->num_vertices;
+    t_state_mass *mass = (t_state_mass *)malloc((N > 0 ? N : 1) * sizeof(t_state_mass));
+    if (mass == NULL) {
+        perror("Allocation failed for sequence display");
         return;
     }
+    int count = 0;
+    double total = 0.0;
+    for (int i = 0; i < N; i++) {
+        double p = X[(size_t)i * B + b];
+        total += p;
+        if (p != 0.0) mass[count++] = (t_state_mass){i + 1, p};
+    }
+    qsort(mass, count, sizeof(t_state_mass), compare_state_mass);
 
-    printf("Vecteur de distribution stationnaire (Lim M^k):\n\n");
-    printf("Sommet | Probabilite\n");
-    printf("-------------------\n");
+    char name[16];
+    int width = state_column_width(&seq->labels, N);
+    display_probability_header(stdout, "Etat", width);
+    int shown = (count < SEQUENCE_DISPLAY_MAX) ? count : SEQUENCE_DISPLAY_MAX;
+    double rest = 0.0;
+    for (int k = 0; k < count; k++) {
+        if (k < shown) printf("  %-*s |   %.4f\n", width, sequence_state_name(seq, mass[k].v, name, sizeof(name)), mass[k].p);
+        else rest += mass[k].p;
+    }
+    if (count > shown) printf("  (%d autre(s) etat(s) : %.4f au total)\n", count - shown, rest);
+    printf("Somme : %.6f\n", total);
+    free(mass);
+}
 
-    // La distribution stationnaire est la première ligne (et toutes les autres) de la matrice limite
-    for (int i = 0; i < matrix_limit.cols; i++) {
-        printf("  %02d    |   %.4f\n", i + 1, matrix_limit.data[0][i]);
+/*
+   run_sequence_mode :
+   Les fichiers de la liste sont lus tels qu'écrits (comme --batch-list). Un vecteur
+   par état de départ : le bloc avance d'un seul passage sur chaque matrice. Le régime
+   périodique (pi_t pour chaque phase et chaque départ) est écrit dans
+   <liste>_cycle.mtx, les distributions de début de cycle étant affichées.
+*/
+static int run_sequence_mode(const char *list_path, const char *starts, int cycles) {
+    char **paths = NULL;
+    int count = collect_batch_list(list_path, &paths);
+    if (count < 0) return EXIT_FAILURE;
+    if (count == 0) {
+        fprintf(stderr, "Erreur: Aucune matrice dans %s.\n", list_path);
+        return EXIT_FAILURE;
     }
-}
\ No newline at end of file
+
+    printf("==============================================\n");
+    printf("   Chaine inhomogene : suite de matrices      \n");
+    printf("==============================================\n");
+
+    t_chain_sequence seq;
+    int failed;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    t_markov_status status = sequence_load(&seq, paths, count, &failed);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    if (status != MARKOV_OK) {
+        fprintf(stderr, "Erreur: Matrice %d (%s) inutilisable (%s)%s.\n", failed + 1, (failed >= 0) ? paths[failed] : list_path,
+                markov_status_string(status),
+                (status == MARKOV_ERR_FORMAT) ? " : fichier mal forme ou etats differents de ceux du premier fichier" : "");
+        free_batch_paths(paths, count);
+        return EXIT_FAILURE;
+    }
+    free_batch_paths(paths, count);
+    double elapsed_ms = (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1e6;
+    int N = seq.num_vertices;
+    int T = seq.num_steps;
+    printf("Suite %s : %d matrice(s) sur %d etats, %lld aretes au total, lues et verifiees en %.3f ms.\n", list_path, T, N,
+           seq.num_edges, elapsed_ms);
+
+    // Un vecteur par état de départ (état 1 par défaut)
+    int states[SEQUENCE_MAX_STARTS];
+    int B = 0;
+    char copy[1024];
+    snprintf(copy, sizeof(copy), "%s", (starts != NULL) ? starts : "1");
+    for (char *token = strtok(copy, ","); token != NULL && B >= 0; token = strtok(NULL, ",")) {
+        int v = sequence_find_state(&seq, token);
+        if (v == 0 || B == SEQUENCE_MAX_STARTS) {
+            if (v == 0) fprintf(stderr, "Erreur: Etat %s inconnu.\n", token);
+            else fprintf(stderr, "Erreur: Plus de %d etats de depart.\n", SEQUENCE_MAX_STARTS);
+            B = -1;
+        } else {
+            states[B++] = v;
+        }
+    }
+    double *X = (B > 0) ? (double *)calloc((size_t)N * B, sizeof(double)) : NULL;
+    double *phases = (B > 0) ? (double *)malloc((size_t)N * T * B * sizeof(double)) : NULL;
+    if (X == NULL || phases == NULL) {
+        if (B > 0) perror("Allocation failed for sequence vectors");
+        else if (B == 0) fprintf(stderr, "Erreur: Liste d'etats de depart vide.\n");
+        free(X);
+        free(phases);
+        sequence_free(&seq);
+        return EXIT_FAILURE;
+    }
+    for (int b = 0; b < B; b++) X[(size_t)(states[b] - 1) * B + b] = 1.0;
+
+    // Distribution après cycles passages par la suite
+    char name[16];
+    printf("\n--- Distribution apres %d cycle(s) (%lld produits creux par bloc de %d vecteur(s)) ---\n", cycles,
+           (long long)cycles * T, B);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int result = sequence_apply(&seq, X, B, cycles);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    elapsed_ms = (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1e6;
+    for (int b = 0; result == 0 && b < B; b++) {
+        printf("\nDepart %s :\n", sequence_state_name(&seq, states[b], name, sizeof(name)));
+        display_sequence_distribution(&seq, X, B, b);
+    }
+    if (result == 0) printf("Calculee en %.3f ms.\n", elapsed_ms);
+
+    // Régime périodique, depuis les mêmes départs
+    int done = -1;
+    double diff = 0.0;
+    if (result == 0) {
+        printf("\n--- Regime periodique du cycle ---\n");
+        memset(X, 0, (size_t)N * B * sizeof(double));
+        for (int b = 0; b < B; b++) X[(size_t)(states[b] - 1) * B + b] = 1.0;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        done = sequence_periodic_state(&seq, X, B, phases, MARKOV_STATIONARY_EPSILON, SEQUENCE_MAX_CYCLES, &diff);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        elapsed_ms = (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1e6;
+    }
+    if (done >= 0) {
+        if (diff < MARKOV_STATIONARY_EPSILON) {
+            printf("Atteint en %d cycle(s) (%lld produits creux par bloc, ecart %.3e) en %.3f ms.\n", done, (long long)done * T,
+                   diff, elapsed_ms);
+        } else {
+            printf("Avertissement : ecart %.3e apres %d cycles (seuil %g) : resultat approche.\n", diff, done,
+                   MARKOV_STATIONARY_EPSILON);
+        }
+        for (int b = 0; b < B; b++) {
+            printf("\nDepart %s, debut du cycle (pi_0 = pi_0 P_1 ... P_%d) :\n", sequence_state_name(&seq, states[b], name, sizeof(name)),
+                   T);
+            display_sequence_distribution(&seq, X, B, b);
+        }
+
+        // <liste sans dossier ni extension>_cycle.mtx : colonne t B + b = pi_t du départ b
+        char output_path[MAX_PATH_LENGTH];
+        const char *slash = strrchr(list_path, '/');
+        const char *base = (slash != NULL) ? slash + 1 : list_path;
+        const char *dot = strrchr(base, '.');
+        int length = (dot != NULL) ? (int)(dot - base) : (int)strlen(base);
+        char comment[128];
+        snprintf(comment, sizeof(comment), "regime periodique : colonne t*%d+b = distribution au debut de la phase t+1, depart b", B);
+        if (snprintf(output_path, sizeof(output_path), "%.*s_cycle.mtx", length, base) >= (int)sizeof(output_path)) {
+            fprintf(stderr, "Erreur: Chemin de sortie trop long pour %.*s_cycle.mtx.\n", length, base);
+            done = -1;
+        } else if (mtx_write_array(output_path, phases, N, T * B, comment) == 0) {
+            printf("\nDistributions des %d phases (%d x %d) ecrites dans %s\n", T, N, T * B, output_path);
+        } else {
+            fprintf(stderr, "Erreur: Ecriture de %s impossible.\n", output_path);
+            done = -1;
+        }
+    }
+
+    free(X);
+    free(phases);
+    sequence_free(&seq);
+    return (result == 0 && done >= 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/*
+   display_kron_distribution :
+   Les SEQUENCE_DISPLAY_MAX états globaux les plus probables (sélection dans un
+   petit tableau trié, sans copier le vecteur), puis la loi de chaque composante.
+*/
+static void display_kron_distribution(const t_kron_chain *chain, const double *x) {
+    t_state_mass top[SEQUENCE_DISPLAY_MAX];
+    int count = 0;
+    double total = 0.0;
+    for (long long i = 0; i < chain->num_states; i++) {
+        double p = x[i];
+        total += p;
+        if (p == 0.0 || (count == SEQUENCE_DISPLAY_MAX && p <= top[count - 1].p)) continue;
+        int k = (count < SEQUENCE_DISPLAY_MAX) ? count++ : count - 1;
+        while (k > 0 && top[k - 1].p < p) {
+            top[k] = top[k - 1];
+            k--;
+        }
+        top[k] = (t_state_mass){(int)i, p};
+    }
+
+    char name[256];
+    printf("Etats les plus probables :\n");
+    for (int k = 0; k < count; k++) printf("  %-24s %.6f\n", kron_state_name(chain, top[k].v, name, sizeof(name)), top[k].p);
+    printf("Somme : %.6f\n", total);
+
+    for (int c = 0; c < chain->num_components; c++) {
+        const t_chain_sequence *matrices = &chain->components[c].matrices;
+        int n = matrices->num_vertices;
+        double *marginal = (double *)malloc(n * sizeof(double));
+        t_state_mass *mass = (t_state_mass *)malloc(n * sizeof(t_state_mass));
+        if (marginal == NULL || mass == NULL) {
+            perror("Allocation failed for component marginal");
+            free(marginal);
+            free(mass);
+            return;
+        }
+        kron_marginal(chain, x, c, marginal);
+        for (int j = 0; j < n; j++) mass[j] = (t_state_mass){j + 1, marginal[j]};
+        qsort(mass, n, sizeof(t_state_mass), compare_state_mass);
+        printf("Composante %s :", chain->components[c].name);
+        int shown = (n < SEQUENCE_DISPLAY_MAX) ? n : SEQUENCE_DISPLAY_MAX;
+        for (int k = 0; k < shown; k++) {
+            printf(" %s (%.4f)", sequence_state_name(matrices, mass[k].v, name, sizeof(name)), mass[k].p);
+        }
+        if (n > shown) printf(" ... (%d autre(s) etat(s))", n - shown);
+        printf("\n");
+        free(marginal);
+        free(mass);
+    }
+}
+
+/*
+   run_compose_mode :
+   Seules les matrices des composantes sont chargées ; un pas de la chaîne produit
+   applique leurs facteurs un mode après l'autre (kron_vector_step). La mémoire
+   affichée est celle des composantes et des vecteurs de l'espace produit, comparée
+   à la CSR qu'aurait la matrice produit.
+*/
+static int run_compose_mode(const char *description_path, const char *from, int steps) {
+    printf("==============================================\n");
+    printf("   Chaine composee (produit de Kronecker)     \n");
+    printf("==============================================\n");
+
+    t_kron_chain chain;
+    int error_line;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    t_markov_status status = kron_load(&chain, description_path, &error_line);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    if (status != MARKOV_OK) {
+        if (error_line > 0) {
+            fprintf(stderr, "Erreur: Composition %s inutilisable, ligne %d (%s).\n", description_path, error_line,
+                    markov_status_string(status));
+        } else {
+            fprintf(stderr, "Erreur: Composition %s inutilisable (%s)%s.\n", description_path, markov_status_string(status),
+                    (status == MARKOV_ERR_FORMAT) ? " : aucune composante, ou poids des evenements de somme differente de 1"
+                    : (status == MARKOV_ERR_NOMEM) ? " : espace produit de plus de 2^31 etats, ou memoire insuffisante" : "");
+        }
+        return EXIT_FAILURE;
+    }
+
+    double elapsed_ms = (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1e6;
+    double component_bytes = 0.0;
+    printf("Composition %s : %d composante(s), %lld etats globaux, ", description_path, chain.num_components, chain.num_states);
+    if (chain.synchronized) printf("%d evenement(s) synchronise(s)", chain.num_events);
+    else printf("produit independant");
+    printf(", lue et verifiee en %.3f ms.\n", elapsed_ms);
+    for (int c = 0; c < chain.num_components; c++) {
+        const t_chain_sequence *matrices = &chain.components[c].matrices;
+        printf("  Composante %s : %d etats, %d aretes%s\n", chain.components[c].name, matrices->num_vertices,
+               matrices->steps[0].num_edges, (matrices->num_steps > 1) ? ", plus des matrices propres a des evenements" : "");
+        component_bytes += (double)(matrices->num_vertices + 1) * matrices->num_steps * sizeof(int)
+                           + (double)matrices->num_edges * (sizeof(int) + sizeof(float));
+    }
+    for (int e = 0; chain.synchronized && e < chain.num_events; e++) {
+        printf("  Evenement %s (probabilite %.4f) :", chain.events[e].name, chain.events[e].weight);
+        for (int c = 0; c < chain.num_components; c++) {
+            int f = chain.events[e].factor[c];
+            if (f == 0) printf(" %s", chain.components[c].name);
+            else if (f > 0) printf(" %s (matrice %d)", chain.components[c].name, f + 1);
+        }
+        printf("\n");
+    }
+    double product_edges = kron_product_edges(&chain);
+    double vector_bytes = (double)chain.num_states * sizeof(double);
+    printf("Memoire : composantes %.1f Ko, 4 vecteurs de %.1f Mo ; la matrice produit aurait %.4g aretes (%.1f Mo en CSR).\n",
+           component_bytes / 1024.0, vector_bytes / (1024.0 * 1024.0), product_edges,
+           (product_edges * (sizeof(int) + sizeof(float)) + (chain.num_states + 1.0) * sizeof(int)) / (1024.0 * 1024.0));
+
+    long long origin = (from != NULL) ? kron_find_state(&chain, from) : 0;
+    if (origin < 0) {
+        fprintf(stderr, "Erreur: Etat global %s inconnu (un etat par composante, separes par ':').\n", from);
+        kron_free(&chain);
+        return EXIT_FAILURE;
+    }
+    double *x = (double *)calloc(chain.num_states, sizeof(double));
+    if (x == NULL) {
+        perror("Allocation failed for composed chain vector");
+        kron_free(&chain);
+        return EXIT_FAILURE;
+    }
+    char name[256];
+    kron_state_name(&chain, origin, name, sizeof(name));
+
+    int failed = 0;
+    if (steps > 0) {
+        printf("\n--- Distribution apres %d pas depuis %s ---\n", steps, name);
+        x[origin] = 1.0;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        failed = (kron_k_step(&chain, x, steps, x) != 0);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        if (!failed) {
+            elapsed_ms = (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1e6;
+            display_kron_distribution(&chain, x);
+            printf("Calculee en %.3f ms.\n", elapsed_ms);
+        }
+    }
+
+    if (!failed) {
+        printf("\n--- Distribution limite depuis %s ---\n", name);
+        memset(x, 0, chain.num_states * sizeof(double));
+        x[origin] = 1.0;
+        double diff;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        int iterations = kron_stationary(&chain, x, MARKOV_STATIONARY_EPSILON, MARKOV_STATIONARY_MAX_ITER, &diff);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        failed = (iterations < 0);
+        if (!failed) {
+            elapsed_ms = (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1e6;
+            if (diff < MARKOV_STATIONARY_EPSILON) {
+                printf("Atteinte en %d iteration(s) (ecart %.3e) en %.3f ms.\n", iterations, diff, elapsed_ms);
+            } else {
+                printf("Avertissement : ecart %.3e apres %d iterations (seuil %g) : resultat approche.\n", diff, iterations,
+                       MARKOV_STATIONARY_EPSILON);
+            }
+            display_kron_distribution(&chain, x);
+        }
+    }
+
+    free(x);
+    kron_free(&chain);
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,649 @@
+#include "markov.h"
+#include <string.h>
+#include <unistd.h>
+
+#include "markov_check.h"
+#include "characteristic.h"
+#include "mermaid_gen.h"
+#include "mtx.h"
+#include "pull.h"
+
+/*
+   markov_status_string :
+   Message associé à chaque code d'erreur, pour les affichages de l'appelant.
+*/
+const char *markov_status_string(t_markov_status status) {
+    switch (status) {
+        case MARKOV_OK:             return "succes";
+        case MARKOV_ERR_IO:         return "fichier introuvable ou illisible";
+        case MARKOV_ERR_FORMAT:     return "format de fichier invalide";
+        case MARKOV_ERR_NOT_MARKOV: return "ce n'est pas un graphe de Markov";
+        case MARKOV_ERR_NOMEM:      return "memoire insuffisante";
+        case MARKOV_ERR_ARGUMENT:   return "argument invalide";
+        case MARKOV_ERR_STATE:      return "etape precedente de l'analyse non executee";
+    }
+    return "erreur inconnue";
+}
+
+/*
+   markov_init :
+   Met tous les champs à zéro / NULL : le contexte est prêt à charger une chaîne.
+*/
+void markov_init(t_markov_ctx *ctx) {
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+/*
+   markov_free :
+   Libère le graphe, la matrice creuse, la partition et tous les résultats.
+   Le profil attaché reste attaché : il couvre tout le cycle de vie du contexte, de
+   même que le nombre de threads des noyaux par tirage.
+*/
+void markov_free(t_markov_ctx *ctx) {
+    t_profiler *profiler = ctx->profiler;
+    int pull_threads = ctx->pull_threads;
+
+    free_graph(ctx->graph);
+    free_csr(ctx->P);
+    free_csr(ctx->PT);
+    free_partition(ctx->partition);
+    free_link_array(ctx->hasse_links);
+    reach_free(&ctx->reach);
+    free(ctx->persistent_index);
+    free(ctx->periods);
+    free(ctx->stationary);
+    absorption_free(&ctx->absorb);
+    free(ctx->original_ids);
+    free(ctx->internal_ids);
+    label_table_free(&ctx->labels);
+    markov_init(ctx);
+    ctx->profiler = profiler;
+    ctx->pull_threads = pull_threads;
+}
+
+void markov_set_profiler(t_markov_ctx *ctx, t_profiler *profiler) {
+    if (ctx != NULL) ctx->profiler = profiler;
+}
+
+void markov_set_pull_threads(t_markov_ctx *ctx, int num_threads) {
+    if (ctx == NULL) return;
+    if (num_threads == 0) {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = (cores > 0) ? (int)cores : 1;
+    }
+    ctx->pull_threads = (num_threads > 0) ? num_threads : 0;
+}
+
+/*
+   markov_build_in_edges :
+   La transposée dépend de P : l'ancienne est libérée à chaque appel, même quand
+   l'index n'est plus demandé.
+*/
+t_markov_status markov_build_in_edges(t_markov_ctx *ctx) {
+    if (ctx == NULL) return MARKOV_ERR_ARGUMENT;
+    free_csr(ctx->PT);
+    ctx->PT = (t_csr){0, 0, NULL, NULL, NULL};
+    if (ctx->pull_threads <= 0 || ctx->P.row_ptr == NULL) return MARKOV_OK;
+
+    profile_begin(ctx->profiler, "csr_transpose");
+    ctx->PT = csr_transpose(&ctx->P);
+    profile_end(ctx->profiler);
+    return (ctx->PT.row_ptr != NULL) ? MARKOV_OK : MARKOV_ERR_NOMEM;
+}
+
+/*
+   markov_load_file :
+   Remplace la chaîne du contexte par celle du fichier. Les étiquettes d'un fichier
+   étiqueté restent dans le contexte pour l'affichage des résultats.
+*/
+t_markov_status markov_load_file(t_markov_ctx *ctx, const char *path) {
+    if (ctx == NULL || path == NULL) return MARKOV_ERR_ARGUMENT;
+
+    markov_free(ctx);
+    profile_begin(ctx->profiler, "read_graph");
+    t_markov_status status = load_graph_labeled(path, &ctx->graph, &ctx->labels, &ctx->load_stats);
+    profile_end(ctx->profiler);
+    if (status == MARKOV_OK) {
+        ctx->num_vertices = ctx->graph.num_vertices;
+        ctx->stages_done = MARKOV_STAGE_LOADED;
+    }
+    return status;
+}
+
+/*
+   markov_load_edges :
+   Construit la liste d'adjacence directement depuis des tableaux : un simulateur
+   peut ainsi analyser sa chaîne sans écrire ni relire de fichier.
+*/
+t_markov_status markov_load_edges(t_markov_ctx *ctx, int num_vertices, int num_edges,
+                                  const int *from, const int *to, const float *proba) {
+    if (ctx == NULL || num_vertices <= 0 || num_edges < 0) return MARKOV_ERR_ARGUMENT;
+    if (num_edges > 0 && (from == NULL || to == NULL || proba == NULL)) return MARKOV_ERR_ARGUMENT;
+
+    markov_free(ctx);
+    ctx->graph = create_empty_graph(num_vertices);
+    if (ctx->graph.adj_lists == NULL) return MARKOV_ERR_NOMEM;
+
+    for (int e = 0; e < num_edges; e++) {
+        if (from[e] < 1 || from[e] > num_vertices || to[e] < 1 || to[e] > num_vertices) {
+            markov_free(ctx);
+            return MARKOV_ERR_FORMAT;
+        }
+        t_edge *edge = create_edge(to[e], proba[e]);
+        if (edge == NULL) {
+            markov_free(ctx);
+            return MARKOV_ERR_NOMEM;
+        }
+        add_edge_to_list(&ctx->graph.adj_lists[from[e] - 1], edge);
+    }
+
+    ctx->num_vertices = num_vertices;
+    ctx->stages_done = MARKOV_STAGE_LOADED;
+    return MARKOV_OK;
+}
+
+/*
+   markov_reorder :
+   Remplace le graphe par sa version renumérotée et garde la correspondance avec
+   les numéros du fichier. Les classes n'étant pas encore calculées, aucun résultat
+   n'est à permuter ; renuméroter deux fois compose les deux permutations.
+*/
+t_markov_status markov_reorder(t_markov_ctx *ctx, t_reorder_kind kind) {
+    if (ctx == NULL || kind < REORDER_NONE || kind > REORDER_CLASS) return MARKOV_ERR_ARGUMENT;
+    if (!(ctx->stages_done & MARKOV_STAGE_LOADED) || (ctx->stages_done & MARKOV_STAGE_CLASSES)
+        || ctx->graph.adj_lists == NULL) {
+        return MARKOV_ERR_STATE;
+    }
+    if (kind == REORDER_NONE) return MARKOV_OK;
+
+    int N = ctx->num_vertices;
+    profile_begin(ctx->profiler, "compute_reordering");
+    int *order = compute_reordering(ctx->graph, kind);
+    profile_end(ctx->profiler);
+    if (order == NULL) return MARKOV_ERR_NOMEM;
+
+    profile_begin(ctx->profiler, "permute_graph");
+    t_graph permuted = permute_graph(ctx->graph, order);
+    profile_end(ctx->profiler);
+    int *original_ids = (int *)malloc(N * sizeof(int));
+    int *internal_ids = (int *)malloc(N * sizeof(int));
+    if (permuted.adj_lists == NULL || original_ids == NULL || internal_ids == NULL) {
+        free_graph(permuted);
+        free(original_ids);
+        free(internal_ids);
+        free(order);
+        return MARKOV_ERR_NOMEM;
+    }
+
+    for (int p = 0; p < N; p++) {
+        original_ids[p] = markov_original_id(ctx, order[p] + 1);
+        internal_ids[original_ids[p] - 1] = p + 1;
+    }
+    free(order);
+    free_graph(ctx->graph);
+    free(ctx->original_ids);
+    free(ctx->internal_ids);
+    ctx->graph = permuted;
+    ctx->original_ids = original_ids;
+    ctx->internal_ids = internal_ids;
+    return MARKOV_OK;
+}
+
+int markov_original_id(const t_markov_ctx *ctx, int v) {
+    return (ctx->original_ids != NULL && v >= 1 && v <= ctx->num_vertices) ? ctx->original_ids[v - 1] : v;
+}
+
+int markov_internal_id(const t_markov_ctx *ctx, int v) {
+    return (ctx->internal_ids != NULL && v >= 1 && v <= ctx->num_vertices) ? ctx->internal_ids[v - 1] : v;
+}
+
+const char *markov_state_label(const t_markov_ctx *ctx, int v) {
+    return (ctx->labels.count > 0) ? label_name(&ctx->labels, v) : NULL;
+}
+
+/*
+   markov_find_state :
+   Étiquette cherchée dans la table d'internement ; pour un fichier numéroté, le texte
+   doit être un numéro de 1 à N.
+*/
+int markov_find_state(const t_markov_ctx *ctx, const char *label) {
+    if (ctx == NULL || label == NULL) return 0;
+    if (ctx->labels.count > 0) return label_find(&ctx->labels, label);
+
+    char *end;
+    long v = strtol(label, &end, 10);
+    return (end != label && *end == '\0' && v >= 1 && v <= ctx->num_vertices) ? (int)v : 0;
+}
+
+/*
+   markov_check :
+   Compte les sommets hors tolérance (count_non_markov_vertices, sans affichage).
+*/
+t_markov_status markov_check(t_markov_ctx *ctx) {
+    if (ctx == NULL) return MARKOV_ERR_ARGUMENT;
+    if (!(ctx->stages_done & MARKOV_STAGE_LOADED)) return MARKOV_ERR_STATE;
+
+    profile_begin(ctx->profiler, "check_markov");
+    ctx->num_invalid_vertices = count_non_markov_vertices(ctx->graph);
+    profile_end(ctx->profiler);
+    if (ctx->num_invalid_vertices > 0) return MARKOV_ERR_NOT_MARKOV;
+
+    ctx->stages_done |= MARKOV_STAGE_CHECKED;
+    return MARKOV_OK;
+}
+
+/*
+   free_solution :
+   Libère les résultats de markov_solve, comme clear_results dans cache.c : un
+   nouveau calcul ne laisse pas fuir le précédent, et une erreur en cours de calcul
+   ne laisse pas de résultats à moitié remplis.
+*/
+static void free_solution(t_markov_ctx *ctx) {
+    free(ctx->persistent_index);
+    free(ctx->periods);
+    free(ctx->stationary);
+    absorption_free(&ctx->absorb);
+    ctx->persistent_index = NULL;
+    ctx->periods = NULL;
+    ctx->stationary = NULL;
+    ctx->num_persistent = 0;
+    ctx->num_unconverged = 0;
+    ctx->stages_done &= ~MARKOV_STAGE_SOLVED;
+}
+
+/*
+   free_classes :
+   Libère les résultats de markov_analyze_classes et tout ce qui en dépend (index
+   d'accessibilité, résultats de markov_solve). Le graphe est gardé.
+*/
+static void free_classes(t_markov_ctx *ctx) {
+    free_solution(ctx);
+    reach_free(&ctx->reach);
+    free_csr(ctx->P);
+    free_csr(ctx->PT);
+    free_partition(ctx->partition);
+    free_link_array(ctx->hasse_links);
+    ctx->P = (t_csr){0, 0, NULL, NULL, NULL};
+    ctx->PT = (t_csr){0, 0, NULL, NULL, NULL};
+    ctx->partition = (t_partition){NULL, 0, NULL};
+    ctx->hasse_links = NULL;
+    ctx->stages_done &= ~MARKOV_STAGE_CLASSES;
+}
+
+/*
+   markov_analyze_classes :
+   Tarjan, persistance des classes, liens de Hasse, puis conversion CSR
+   (utilisée par toutes les étapes suivantes). Les résultats d'un appel précédent
+   sont libérés d'abord, ceux de l'appel en cours en cas d'erreur.
+*/
+t_markov_status markov_analyze_classes(t_markov_ctx *ctx) {
+    if (ctx == NULL) return MARKOV_ERR_ARGUMENT;
+    if (!(ctx->stages_done & MARKOV_STAGE_LOADED)) return MARKOV_ERR_STATE;
+    free_classes(ctx);
+
+    profile_begin(ctx->profiler, "find_cfcs_tarjan");
+    ctx->partition = find_cfcs_tarjan(ctx->graph);
+    profile_end(ctx->profiler);
+    if (ctx->partition.v_data == NULL) {
+        free_classes(ctx);
+        return MARKOV_ERR_NOMEM;
+    }
+
+    profile_begin(ctx->profiler, "set_persistence_flags");
+    set_persistence_flags(ctx->graph, &ctx->partition);
+    profile_end(ctx->profiler);
+
+    profile_begin(ctx->profiler, "compute_hasse_diagram_links");
+    ctx->hasse_links = compute_hasse_diagram_links(ctx->graph, ctx->partition);
+    profile_end(ctx->profiler);
+    if (ctx->hasse_links == NULL) {
+        free_classes(ctx);
+        return MARKOV_ERR_NOMEM;
+    }
+
+    profile_begin(ctx->profiler, "graph_to_csr");
+    ctx->P = graph_to_csr(ctx->graph);
+    profile_end(ctx->profiler);
+    if (ctx->P.row_ptr == NULL || markov_build_in_edges(ctx) != MARKOV_OK) {
+        free_classes(ctx);
+        return MARKOV_ERR_NOMEM;
+    }
+
+    ctx->stages_done |= MARKOV_STAGE_CLASSES;
+    return MARKOV_OK;
+}
+
+/*
+   markov_solve :
+   Pour chaque classe persistante : distribution stationnaire et période (en creux,
+   jamais de matrice N x N), l'itéré suivant étant rangé dans un même tampon pour toutes
+   les classes ; ctx->num_unconverged compte celles arrêtées à MARKOV_STATIONARY_MAX_ITER.
+   Puis probabilités d'absorption dans les classes persistantes atteintes,
+   gardées tant qu'elles tiennent dans MARKOV_ABSORPTION_MAX_VALUES valeurs.
+   Avec l'index des arêtes entrantes, les classes d'au moins PULL_MIN_EDGES arêtes
+   sont itérées par tirage sur l'équipe de threads, lancée à la première d'entre elles.
+   Comme markov_analyze_classes, libère les résultats précédents d'abord et ceux en
+   cours en cas d'erreur.
+*/
+t_markov_status markov_solve(t_markov_ctx *ctx) {
+    if (ctx == NULL) return MARKOV_ERR_ARGUMENT;
+    if (!(ctx->stages_done & MARKOV_STAGE_CLASSES)) return MARKOV_ERR_STATE;
+    free_solution(ctx);
+
+    int N = ctx->P.num_vertices;
+    int num_classes = ctx->partition.num_classes;
+
+    ctx->persistent_index = (int *)malloc(num_classes * sizeof(int));
+    ctx->periods = (int *)calloc(num_classes, sizeof(int));
+    ctx->stationary = (double *)calloc(N, sizeof(double));
+    double *work = (double *)malloc(N * sizeof(double));
+    if (ctx->persistent_index == NULL || ctx->periods == NULL || ctx->stationary == NULL || work == NULL) {
+        free(work);
+        free_solution(ctx);
+        return MARKOV_ERR_NOMEM;
+    }
+    int K = 0;
+    for (int i = 0; i < num_classes; i++) ctx->persistent_index[i] = ctx->partition.classes[i].is_persistent ? K++ : -1;
+
+    profile_begin(ctx->profiler, "class_stationary_distribution");
+    t_markov_status status = MARKOV_OK;
+    t_pull_team team = {0};
+    ctx->num_unconverged = 0;
+    for (int i = 0; i < num_classes && status == MARKOV_OK; i++) {
+        t_class c = ctx->partition.classes[i];
+        if (!c.is_persistent) continue;
+        long long in_edges = 0;
+        for (int m = 0; ctx->PT.row_ptr != NULL && m < c.num_members; m++) {
+            int v = c.members_ids[m] - 1;
+            in_edges += ctx->PT.row_ptr[v + 1] - ctx->PT.row_ptr[v];
+        }
+        if (in_edges >= PULL_MIN_EDGES && team.threads == NULL && pull_team_init(&team, &ctx->PT, ctx->pull_threads) != 0) {
+            status = MARKOV_ERR_NOMEM;
+            break;
+        }
+        int converged = 1;
+        int iter = (in_edges >= PULL_MIN_EDGES)
+                 ? pull_class_stationary(&team, ctx->partition, i, ctx->stationary, MARKOV_STATIONARY_EPSILON,
+                                         MARKOV_STATIONARY_MAX_ITER)
+                 : class_stationary_distribution(&ctx->P, ctx->partition, i, ctx->stationary,
+                                                 MARKOV_STATIONARY_EPSILON, MARKOV_STATIONARY_MAX_ITER, work, &converged);
+        if (iter < 0) status = MARKOV_ERR_NOMEM;
+        else if (!((in_edges >= PULL_MIN_EDGES) ? team.converged : converged)) ctx->num_unconverged++;
+    }
+    pull_team_free(&team);
+    free(work);
+    profile_end(ctx->profiler);
+    if (status != MARKOV_OK) {
+        free_solution(ctx);
+        return status;
+    }
+
+    profile_begin(ctx->profiler, "class_period_sparse");
+    for (int i = 0; i < num_classes && status == MARKOV_OK; i++) {
+        if (!ctx->partition.classes[i].is_persistent) continue;
+        ctx->periods[i] = class_period_sparse(&ctx->P, ctx->partition, i);
+        if (ctx->periods[i] < 0) status = MARKOV_ERR_NOMEM;
+    }
+    profile_end(ctx->profiler);
+    if (status != MARKOV_OK) {
+        free_solution(ctx);
+        return status;
+    }
+
+    profile_begin(ctx->profiler, "absorption_probabilities");
+    ctx->num_persistent = absorption_probabilities(&ctx->P, ctx->partition, MARKOV_ABSORPTION_MAX_VALUES, &ctx->absorb);
+    profile_end(ctx->profiler);
+    if (ctx->num_persistent < 0) {
+        free_solution(ctx);
+        return MARKOV_ERR_NOMEM;
+    }
+
+    ctx->stages_done |= MARKOV_STAGE_SOLVED;
+    return MARKOV_OK;
+}
+
+/*
+   markov_analyze :
+   Pipeline complet après chargement ; s'arrête à la première erreur.
+*/
+t_markov_status markov_analyze(t_markov_ctx *ctx) {
+    t_markov_status status = markov_check(ctx);
+    if (status == MARKOV_OK) status = markov_analyze_classes(ctx);
+    if (status == MARKOV_OK) status = markov_solve(ctx);
+    return status;
+}
+
+/*
+   markov_release_graph :
+   Après markov_analyze_classes, la matrice creuse contient toute l'information utile
+   aux requêtes : la liste chaînée (une allocation par arête) peut être libérée.
+*/
+void markov_release_graph(t_markov_ctx *ctx) {
+    if (ctx == NULL || !(ctx->stages_done & MARKOV_STAGE_CLASSES)) return;
+    free_graph(ctx->graph);
+    ctx->graph = (t_graph){NULL, 0};
+}
+
+//Vérifie le pointeur résultat, que le sommet (1..N) est valide et que l'étape demandée a été exécutée.
+static t_markov_status check_query(const t_markov_ctx *ctx, int v, int stage, const void *result) {
+    if (ctx == NULL || result == NULL) return MARKOV_ERR_ARGUMENT;
+    if ((ctx->stages_done & stage) != stage) return MARKOV_ERR_STATE;
+    if (v < 1 || v > ctx->num_vertices) return MARKOV_ERR_ARGUMENT;
+    return MARKOV_OK;
+}
+
+t_markov_status markov_vertex_class(const t_markov_ctx *ctx, int v, int *class_id) {
+    t_markov_status status = check_query(ctx, v, MARKOV_STAGE_CLASSES, class_id);
+    if (status != MARKOV_OK) return status;
+
+    *class_id = ctx->partition.v_data[v - 1].class_id;
+    return MARKOV_OK;
+}
+
+t_markov_status markov_stationary(const t_markov_ctx *ctx, int v, double *value) {
+    t_markov_status status = check_query(ctx, v, MARKOV_STAGE_SOLVED, value);
+    if (status != MARKOV_OK) return status;
+
+    *value = ctx->stationary[v - 1];
+    return MARKOV_OK;
+}
+
+t_markov_status markov_absorption(const t_markov_ctx *ctx, int v, int class_id, double *value) {
+    t_markov_status status = check_query(ctx, v, MARKOV_STAGE_SOLVED, value);
+    if (status != MARKOV_OK) return status;
+    if (class_id < 1 || class_id > ctx->partition.num_classes) return MARKOV_ERR_ARGUMENT;
+
+    *value = absorption_lookup(&ctx->absorb, ctx->partition, v - 1, class_id - 1);
+    if (*value >= 0.0) return MARKOV_OK;
+
+    // Probabilités non gardées : la ligne de v est recalculée
+    double *class_mass = (double *)malloc(ctx->partition.num_classes * sizeof(double));
+    if (class_mass == NULL) return MARKOV_ERR_NOMEM;
+    status = markov_absorption_row(ctx, v, class_mass);
+    *value = class_mass[class_id - 1];
+    free(class_mass);
+    return status;
+}
+
+t_markov_status markov_absorption_row(const t_markov_ctx *ctx, int v, double *class_mass) {
+    t_markov_status status = check_query(ctx, v, MARKOV_STAGE_SOLVED, class_mass);
+    if (status != MARKOV_OK) return status;
+
+    return (absorption_row(&ctx->P, ctx->partition, &ctx->absorb, v - 1, class_mass) == 0) ? MARKOV_OK : MARKOV_ERR_NOMEM;
+}
+
+t_markov_status markov_absorption_column(const t_markov_ctx *ctx, int class_id, double *h) {
+    if (ctx == NULL || h == NULL) return MARKOV_ERR_ARGUMENT;
+    if (!(ctx->stages_done & MARKOV_STAGE_SOLVED)) return MARKOV_ERR_STATE;
+    if (class_id < 1 || class_id > ctx->partition.num_classes) return MARKOV_ERR_ARGUMENT;
+
+    return (absorption_column(&ctx->P, ctx->partition, &ctx->absorb, class_id - 1, h) == 0) ? MARKOV_OK : MARKOV_ERR_NOMEM;
+}
+
+t_markov_status markov_limit(const t_markov_ctx *ctx, int i, int j, double *value) {
+    t_markov_status status = check_query(ctx, j, MARKOV_STAGE_SOLVED, value);
+    if (status != MARKOV_OK) return status;
+
+    double absorb;
+    status = markov_absorption(ctx, i, ctx->partition.v_data[j - 1].class_id, &absorb);
+    if (status != MARKOV_OK) return status;
+
+    *value = absorb * ctx->stationary[j - 1];
+    return MARKOV_OK;
+}
+
+/*
+   markov_limit_row :
+   Une seule ligne d'absorption pour toute la ligne de la limite, au lieu d'une
+   requête markov_absorption par colonne.
+*/
+t_markov_status markov_limit_row(const t_markov_ctx *ctx, int i, double *row) {
+    t_markov_status status = check_query(ctx, i, MARKOV_STAGE_SOLVED, row);
+    if (status != MARKOV_OK) return status;
+
+    double *class_mass = (double *)malloc(ctx->partition.num_classes * sizeof(double));
+    if (class_mass == NULL) return MARKOV_ERR_NOMEM;
+    status = markov_absorption_row(ctx, i, class_mass);
+    for (int j = 0; status == MARKOV_OK && j < ctx->num_vertices; j++) {
+        row[j] = class_mass[ctx->partition.v_data[j].class_id - 1] * ctx->stationary[j];
+    }
+    free(class_mass);
+    return status;
+}
+
+/*
+   markov_build_reach :
+   L'index ne dépend que des classes et des liens : il est construit à la demande
+   (mode serveur), pas par markov_analyze_classes.
+*/
+t_markov_status markov_build_reach(t_markov_ctx *ctx) {
+    if (ctx == NULL) return MARKOV_ERR_ARGUMENT;
+    if (!(ctx->stages_done & MARKOV_STAGE_CLASSES) || ctx->hasse_links == NULL) return MARKOV_ERR_STATE;
+
+    reach_free(&ctx->reach);
+    profile_begin(ctx->profiler, "reach_build");
+    int result = reach_build(&ctx->reach, ctx->partition, ctx->hasse_links);
+    profile_end(ctx->profiler);
+    return (result == 0) ? MARKOV_OK : MARKOV_ERR_NOMEM;
+}
+
+t_markov_status markov_reachable(const t_markov_ctx *ctx, int i, int j, int *result) {
+    t_markov_status status = check_query(ctx, i, MARKOV_STAGE_CLASSES, result);
+    if (status != MARKOV_OK) return status;
+    if (j < 1 || j > ctx->num_vertices) return MARKOV_ERR_ARGUMENT;
+    if (ctx->reach.post == NULL) return MARKOV_ERR_STATE;
+
+    *result = reach_classes(&ctx->reach, ctx->partition.v_data[i - 1].class_id, ctx->partition.v_data[j - 1].class_id);
+    return MARKOV_OK;
+}
+
+t_markov_status markov_reachable_persistent(const t_markov_ctx *ctx, int v, int *classes, int *count) {
+    t_markov_status status = check_query(ctx, v, MARKOV_STAGE_CLASSES, count);
+    if (status != MARKOV_OK) return status;
+    if (classes == NULL) return MARKOV_ERR_ARGUMENT;
+    if (ctx->reach.post == NULL) return MARKOV_ERR_STATE;
+
+    *count = reach_persistent(&ctx->reach, ctx->partition.v_data[v - 1].class_id, classes);
+    return MARKOV_OK;
+}
+
+t_markov_status markov_k_step(const t_markov_ctx *ctx, const double *x0, int k, double *out) {
+    if (ctx == NULL || x0 == NULL || out == NULL || k < 0) return MARKOV_ERR_ARGUMENT;
+    if (!(ctx->stages_done & MARKOV_STAGE_CLASSES)) return MARKOV_ERR_STATE;
+
+    if (ctx->PT.row_ptr == NULL) return (k_step_distribution(&ctx->P, x0, k, out) == 0) ? MARKOV_OK : MARKOV_ERR_NOMEM;
+
+    t_pull_team team;
+    if (pull_team_init(&team, &ctx->PT, ctx->pull_threads) != 0) return MARKOV_ERR_NOMEM;
+    int result = pull_k_step(&team, x0, k, out);
+    pull_team_free(&team);
+    return (result == 0) ? MARKOV_OK : MARKOV_ERR_NOMEM;
+}
+
+t_markov_status markov_write_mermaid(const t_markov_ctx *ctx, const char *path) {
+    if (ctx == NULL || path == NULL) return MARKOV_ERR_ARGUMENT;
+    if (!(ctx->stages_done & MARKOV_STAGE_LOADED) || ctx->graph.adj_lists == NULL) return MARKOV_ERR_STATE;
+
+    const t_label_table *names = (ctx->labels.count > 0) ? &ctx->labels : NULL;
+    return (generate_mermaid_file_named(ctx->graph, path, ctx->original_ids, names) == 0) ? MARKOV_OK : MARKOV_ERR_IO;
+}
+
+t_markov_status markov_write_hasse(const t_markov_ctx *ctx, const char *path) {
+    if (ctx == NULL || path == NULL) return MARKOV_ERR_ARGUMENT;
+    if (!(ctx->stages_done & MARKOV_STAGE_CLASSES)) return MARKOV_ERR_STATE;
+
+    return (generate_hasse_mermaid_file(ctx->hasse_links, path, ctx->partition) == 0) ? MARKOV_OK : MARKOV_ERR_IO;
+}
+
+t_markov_status markov_write_matrix_mtx(const t_markov_ctx *ctx, const char *path) {
+    if (ctx == NULL || path == NULL) return MARKOV_ERR_ARGUMENT;
+    if (!(ctx->stages_done & MARKOV_STAGE_LOADED) || ctx->graph.adj_lists == NULL) return MARKOV_ERR_STATE;
+
+    return (mtx_write_graph(ctx->graph, path, ctx->original_ids) == 0) ? MARKOV_OK : MARKOV_ERR_IO;
+}
+
+t_markov_status markov_write_stationary_mtx(const t_markov_ctx *ctx, const char *path) {
+    if (ctx == NULL || path == NULL) return MARKOV_ERR_ARGUMENT;
+    if (!(ctx->stages_done & MARKOV_STAGE_SOLVED)) return MARKOV_ERR_STATE;
+
+    int N = ctx->num_vertices;
+    double *values = (double *)malloc(N * sizeof(double));
+    if (values == NULL) return MARKOV_ERR_NOMEM;
+    for (int v = 1; v <= N; v++) values[v - 1] = ctx->stationary[markov_internal_id(ctx, v) - 1];
+
+    int written = mtx_write_array(path, values, N, 1,
+                                  "Distribution stationnaire de la classe persistante de chaque etat (0 si transitoire)");
+    free(values);
+    return (written == 0) ? MARKOV_OK : MARKOV_ERR_IO;
+}
+
+//Écriture de markov_write_absorption_mtx : une colonne par classe persistante, lignes dans l'ordre du fichier.
+typedef struct s_absorption_writer {
+    const t_markov_ctx *ctx;
+    int *classes;  // K cases : classe (0-based) de chaque colonne
+    double *h;     // N cases : colonne dans la numérotation du contexte
+} t_absorption_writer;
+
+static int write_absorption_column(int column, double *values, void *data) {
+    t_absorption_writer *writer = (t_absorption_writer *)data;
+    const t_markov_ctx *ctx = writer->ctx;
+
+    if (markov_absorption_column(ctx, writer->classes[column] + 1, writer->h) != MARKOV_OK) return -1;
+    for (int v = 1; v <= ctx->num_vertices; v++) values[v - 1] = writer->h[markov_internal_id(ctx, v) - 1];
+    return 0;
+}
+
+/*
+   markov_write_absorption_mtx :
+   Format coordonné : seules les probabilités non nulles sont écrites, colonne après
+   colonne (markov_absorption_column, une seule colonne en mémoire) ; le commentaire donne la
+   classe persistante de chaque colonne.
+*/
+t_markov_status markov_write_absorption_mtx(const t_markov_ctx *ctx, const char *path) {
+    if (ctx == NULL || path == NULL) return MARKOV_ERR_ARGUMENT;
+    if (!(ctx->stages_done & MARKOV_STAGE_SOLVED)) return MARKOV_ERR_STATE;
+
+    int N = ctx->num_vertices;
+    int K = ctx->num_persistent;
+    t_absorption_writer writer = {ctx, (int *)malloc((K > 0 ? K : 1) * sizeof(int)), (double *)malloc(N * sizeof(double))};
+    size_t comment_size = 64 + (size_t)K * 12;
+    char *comment = (char *)malloc(comment_size);
+    if (writer.classes == NULL || writer.h == NULL || comment == NULL) {
+        free(writer.classes);
+        free(writer.h);
+        free(comment);
+        return MARKOV_ERR_NOMEM;
+    }
+    size_t used = (size_t)snprintf(comment, comment_size, "Probabilites d'absorption ; colonnes :");
+    for (int i = 0; i < ctx->partition.num_classes; i++) {
+        if (ctx->persistent_index[i] < 0) continue;
+        writer.classes[ctx->persistent_index[i]] = i;
+        used += (size_t)snprintf(comment + used, comment_size - used, " C%d", i + 1);
+    }
+
+    int written = mtx_write_columns(path, N, K, write_absorption_column, &writer, NULL, comment);
+    free(writer.classes);
+    free(writer.h);
+    free(comment);
+    return (written == 0) ? MARKOV_OK : MARKOV_ERR_IO;
+}
@@ -0,0 +1,169 @@
+#ifndef MARKOV_H
+#define MARKOV_H
+
+#include "markov_status.h"
+#include "graph.h"
+#include "tarjan.h"
+#include "hasse.h"
+#include "reach.h"
+#include "sparse.h"
+#include "profile.h"
+#include "reorder.h"
+
+/*
+   API de la bibliothèque libmarkov.
+   Toute l'analyse d'une chaîne vit dans un contexte t_markov_ctx : aucune variable
+   globale, aucun exit(). Deux contextes distincts peuvent être utilisés en même
+   temps depuis deux threads ; un même contexte peut être lu par plusieurs threads
+   une fois l'analyse terminée (les fonctions de requête ne le modifient pas).
+*/
+
+//Version de libmarkov (les résultats mis en cache par une autre version sont ignorés, voir cache.h).
+#define MARKOV_VERSION "1.5.0"
+
+//Réglages de l'itération creuse de markov_solve pour la distribution stationnaire de chaque classe.
+#define MARKOV_STATIONARY_EPSILON 1e-10
+#define MARKOV_STATIONARY_MAX_ITER 100000
+
+//Probabilités d'absorption gardées par markov_solve au plus (une par sommet et classe persistante atteinte, 8 octets
+//chacune) ; au-delà, chaque requête les recalcule depuis le sommet ou la classe demandés.
+#define MARKOV_ABSORPTION_MAX_VALUES (1LL << 24)
+
+//Étapes de l'analyse déjà exécutées dans un contexte (champ stages_done).
+#define MARKOV_STAGE_LOADED   0x01
+#define MARKOV_STAGE_CHECKED  0x02
+#define MARKOV_STAGE_CLASSES  0x04
+#define MARKOV_STAGE_SOLVED   0x08
+
+//Contexte d'analyse d'une chaîne. Les champs sont remplis par les fonctions markov_* et sont en lecture seule pour l'appelant.
+typedef struct s_markov_ctx {
+    int num_vertices;           // Nombre de sommets N (markov_load_*)
+    t_graph graph;              // Liste d'adjacence (markov_load_*, libérée par markov_release_graph)
+    t_csr P;                    // Matrice creuse (markov_analyze_classes)
+    t_csr PT;                   // Arêtes entrantes : transposée de P (markov_analyze_classes si pull_threads > 0, vide sinon)
+    int pull_threads;           // Threads des noyaux par tirage, 0 = pas d'index des arêtes entrantes (markov_set_pull_threads)
+    t_partition partition;      // Classes et persistance (markov_analyze_classes)
+    t_link_array *hasse_links;  // Liens entre classes (markov_analyze_classes)
+    t_reach_index reach;        // Index d'accessibilité entre classes (markov_build_reach, vide sinon)
+    int num_persistent;         // Nombre de classes persistantes K (markov_solve)
+    int *persistent_index;      // Par classe : indice parmi les persistantes, -1 si transitoire (markov_solve)
+    int *periods;               // Par classe : période, 0 si transitoire (markov_solve)
+    double *stationary;         // N cases : distribution stationnaire de la classe de chaque sommet (markov_solve)
+    int num_unconverged;        // Classes persistantes arrêtées à MARKOV_STATIONARY_MAX_ITER avant la précision voulue (markov_solve)
+    t_absorption absorb;        // Probabilités d'absorption en creux, values = NULL si non gardées (markov_solve)
+    int num_invalid_vertices;   // Sommets hors tolérance (markov_check)
+    int *original_ids;          // N cases : numéro dans le fichier (1..N) de chaque sommet, NULL si non renuméroté (markov_reorder)
+    int *internal_ids;          // N cases : numéro dans le contexte de chaque sommet du fichier, NULL si non renuméroté
+    t_label_table labels;       // Étiquettes des états d'un fichier étiqueté, numéros du fichier (vide sinon, markov_load_file)
+    t_load_stats load_stats;    // Statistiques de lecture (markov_load_file)
+    int stages_done;            // Combinaison de MARKOV_STAGE_*
+    t_profiler *profiler;       // Mesure de chaque étape (NULL = désactivée, voir markov_set_profiler)
+} t_markov_ctx;
+
+//Initialise un contexte vide.
+void markov_init(t_markov_ctx *ctx);
+
+//Libère tout ce que contient le contexte (qui redevient vide, réutilisable).
+void markov_free(t_markov_ctx *ctx);
+
+//Attache un profil au contexte : chaque étape y est mesurée (NULL pour désactiver). Conservé par markov_free.
+void markov_set_profiler(t_markov_ctx *ctx, t_profiler *profiler);
+
+//Demande l'index des arêtes entrantes, construit avec la matrice creuse, et les noyaux parallèles par tirage (pull.h) dans
+//markov_solve et markov_k_step, sur num_threads threads (0 = nombre de coeurs, < 0 pour désactiver). Conservé par markov_free.
+void markov_set_pull_threads(t_markov_ctx *ctx, int num_threads);
+
+//(Re)construit ctx->PT depuis ctx->P si l'index est demandé (markov_set_pull_threads) ; appelée à chaque reconstruction de P.
+t_markov_status markov_build_in_edges(t_markov_ctx *ctx);
+
+//Charge une chaîne depuis un fichier au format data/ (N puis "départ arrivée probabilité"), étiqueté
+//("étiquette_départ étiquette_arrivée probabilité") ou Matrix Market (voir load_graph_labeled).
+t_markov_status markov_load_file(t_markov_ctx *ctx, const char *path);
+
+//Charge une chaîne depuis des tableaux en mémoire (sommets numérotés de 1 à N), sans passer par un fichier.
+t_markov_status markov_load_edges(t_markov_ctx *ctx, int num_vertices, int num_edges,
+                                  const int *from, const int *to, const float *proba);
+
+//Renumérote les sommets pour la localité mémoire (voir reorder.h), avant markov_analyze_classes. Toutes les étapes
+//et requêtes utilisent ensuite la nouvelle numérotation ; markov_original_id et markov_internal_id font la conversion.
+t_markov_status markov_reorder(t_markov_ctx *ctx, t_reorder_kind kind);
+
+//Numéro dans le fichier du sommet v du contexte (v si la chaîne n'a pas été renumérotée).
+int markov_original_id(const t_markov_ctx *ctx, int v);
+
+//Numéro dans le contexte du sommet v du fichier (v si la chaîne n'a pas été renumérotée).
+int markov_internal_id(const t_markov_ctx *ctx, int v);
+
+//Étiquette de l'état v du fichier (1..N : ordre de première apparition pour un fichier étiqueté), NULL si le fichier numérote ses états.
+const char *markov_state_label(const t_markov_ctx *ctx, int v);
+
+//Numéro dans le fichier de l'état d'étiquette label (de numéro label si le fichier numérote ses états), 0 s'il n'existe pas.
+int markov_find_state(const t_markov_ctx *ctx, const char *label);
+
+//Vérifie la propriété de Markov (sans affichage). Retourne MARKOV_ERR_NOT_MARKOV si un sommet est hors tolérance.
+t_markov_status markov_check(t_markov_ctx *ctx);
+
+//Classes (Tarjan), persistance, liens de Hasse et matrice creuse.
+t_markov_status markov_analyze_classes(t_markov_ctx *ctx);
+
+//Distribution stationnaire et période de chaque classe persistante, probabilités d'absorption. ctx->num_unconverged vaut 0
+//si toutes les distributions stationnaires ont atteint MARKOV_STATIONARY_EPSILON.
+t_markov_status markov_solve(t_markov_ctx *ctx);
+
+//Enchaîne markov_check, markov_analyze_classes et markov_solve.
+t_markov_status markov_analyze(t_markov_ctx *ctx);
+
+//Libère la liste d'adjacence une fois les classes calculées : les requêtes n'utilisent que la matrice creuse.
+void markov_release_graph(t_markov_ctx *ctx);
+
+//Classe (identifiant 1-based) du sommet v (1..N).
+t_markov_status markov_vertex_class(const t_markov_ctx *ctx, int v, int *class_id);
+
+//Probabilité stationnaire du sommet v dans sa classe persistante (0 si transitoire).
+t_markov_status markov_stationary(const t_markov_ctx *ctx, int v, double *value);
+
+//Limite (au sens de Cesàro) de P^k(i, j) : probabilité d'absorption de i dans la classe de j fois pi(j).
+t_markov_status markov_limit(const t_markov_ctx *ctx, int i, int j, double *value);
+
+//Ligne i de la limite : row (N cases) reçoit markov_limit(i, j) pour chaque sommet j.
+t_markov_status markov_limit_row(const t_markov_ctx *ctx, int i, double *row);
+
+//Probabilité, partant de v, de finir dans la classe class_id (0 si cette classe est transitoire).
+t_markov_status markov_absorption(const t_markov_ctx *ctx, int v, int class_id, double *value);
+
+//Probabilités, partant de v, de finir dans chaque classe : class_mass (partition.num_classes cases, case id - 1).
+t_markov_status markov_absorption_row(const t_markov_ctx *ctx, int v, double *class_mass);
+
+//Probabilité, partant de chaque sommet, de finir dans la classe class_id : h (N cases). Recalculée colonne seule si les
+//probabilités ne sont pas gardées (voir MARKOV_ABSORPTION_MAX_VALUES).
+t_markov_status markov_absorption_column(const t_markov_ctx *ctx, int class_id, double *h);
+
+//Construit l'index d'accessibilité entre classes (reach.h) depuis les liens de Hasse. Reconstruit par markov_apply_delta.
+t_markov_status markov_build_reach(t_markov_ctx *ctx);
+
+//result reçoit 1 si l'état j est accessible depuis l'état i (i compris), 0 sinon. MARKOV_ERR_STATE sans markov_build_reach.
+t_markov_status markov_reachable(const t_markov_ctx *ctx, int i, int j, int *result);
+
+//Classes persistantes (identifiants croissants) accessibles depuis v : classes (ctx->reach.num_persistent cases) les
+//reçoit, count leur nombre. MARKOV_ERR_STATE sans markov_build_reach.
+t_markov_status markov_reachable_persistent(const t_markov_ctx *ctx, int v, int *classes, int *count);
+
+//Distribution après k étapes : out = x0 P^k (tableaux de N cases).
+t_markov_status markov_k_step(const t_markov_ctx *ctx, const double *x0, int k, double *out);
+
+//Écrit le graphe au format Mermaid (sommets sous leur numéro ou leur étiquette du fichier).
+t_markov_status markov_write_mermaid(const t_markov_ctx *ctx, const char *path);
+
+//Écrit le diagramme de Hasse au format Mermaid.
+t_markov_status markov_write_hasse(const t_markov_ctx *ctx, const char *path);
+
+//Écrit la matrice de transition au format Matrix Market coordonné (numéros du fichier, voir mtx.h).
+t_markov_status markov_write_matrix_mtx(const t_markov_ctx *ctx, const char *path);
+
+//Écrit la distribution stationnaire (vecteur N x 1, numéros du fichier) au format Matrix Market array.
+t_markov_status markov_write_stationary_mtx(const t_markov_ctx *ctx, const char *path);
+
+//Écrit les probabilités d'absorption (N x K, une colonne par classe persistante) au format Matrix Market coordonné.
+t_markov_status markov_write_absorption_mtx(const t_markov_ctx *ctx, const char *path);
+
+#endif // MARKOV_H
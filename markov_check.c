@@ -43,3 +43,23 @@ int is_markov_graph(t_graph graph) {
 
     return is_markov;
 }
+
+/*  
+   count_non_markov_vertices :
+   Même vérification que is_markov_graph, mais silencieuse : retourne le nombre
+   de sommets hors tolérance (0 si le graphe est Markovien). Utilisée par le mode
+   batch où plusieurs fichiers sont analysés en parallèle.
+*/
+int count_non_markov_vertices(t_graph graph) {
+    int invalid = 0;
+
+    for (int i = 0; i < graph.num_vertices; i++) {
+        float sum_proba = 0.0f;
+        for (t_edge *current = graph.adj_lists[i].head; current != NULL; current = current->next) {
+            sum_proba += current->probability;
+        }
+        if (fabsf(sum_proba - 1.0f) > TOLERANCE) invalid++;
+    }
+
+    return invalid;
+}
@@ -8,4 +8,7 @@
 //Vérifie si un graphe est un Graphe de Markov.
 int is_markov_graph(t_graph graph);
 
+//Compte, sans rien afficher, les sommets dont la somme des probabilités sortantes diffère de 1 (mode batch).
+int count_non_markov_vertices(t_graph graph);
+
 #endif // MARKOV_CHECK_H
\ No newline at end of file
@@ -0,0 +1,18 @@
+#ifndef MARKOV_STATUS_H
+#define MARKOV_STATUS_H
+
+//Codes d'erreur de la bibliothèque : aucune fonction d'analyse n'appelle exit(), l'appelant décide.
+typedef enum e_markov_status {
+    MARKOV_OK = 0,          // Succès
+    MARKOV_ERR_IO,          // Fichier introuvable, illisible ou impossible à écrire
+    MARKOV_ERR_FORMAT,      // Contenu mal formé (nombre de sommets, numéro de sommet hors bornes...)
+    MARKOV_ERR_NOT_MARKOV,  // Au moins un sommet dont la somme des probabilités sortantes != 1
+    MARKOV_ERR_NOMEM,       // Allocation mémoire impossible
+    MARKOV_ERR_ARGUMENT,    // Argument invalide (sommet ou classe hors bornes, pointeur NULL...)
+    MARKOV_ERR_STATE        // Étape précédente de l'analyse non exécutée
+} t_markov_status;
+
+//Message lisible associé à un code d'erreur.
+const char *markov_status_string(t_markov_status status);
+
+#endif // MARKOV_STATUS_H
@@ -2,11 +2,13 @@
 #include <math.h>
 #include <string.h>
 #include "tarjan.h"
+#include "profile.h"
 
 /*  
    create_empty_matrix :
    Alloue et initialise une matrice carrée N x N remplie de zéros.
    Utilise malloc/calloc pour créer les lignes et colonnes.
+   Si la mémoire manque, retourne une matrice vide (data = NULL, rows = cols = 0).
 */
 t_matrix create_empty_matrix(int N) {
     t_matrix matrix;
@@ -16,7 +18,8 @@ t_matrix create_empty_matrix(int N) {
     matrix.data = (float **)malloc(N * sizeof(float *));
     if (matrix.data == NULL) {
         perror("Allocation failed for matrix rows");
-        exit(EXIT_FAILURE);
+        matrix.rows = matrix.cols = 0;
+        return matrix;
     }
     
     for (int i = 0; i < N; i++) {
@@ -25,7 +28,9 @@ t_matrix create_empty_matrix(int N) {
             perror("Allocation failed for matrix columns");
             for (int j = 0; j < i; j++) free(matrix.data[j]);
             free(matrix.data);
-            exit(EXIT_FAILURE);
+            matrix.data = NULL;
+            matrix.rows = matrix.cols = 0;
+            return matrix;
         }
     }
     
@@ -51,6 +56,7 @@ void free_matrix(t_matrix matrix) {
    Les dimensions doivent correspondre.
 */
 void copy_matrix(t_matrix dest, t_matrix src) {
+    if (dest.data == NULL || src.data == NULL) return;
     if (dest.rows != src.rows || dest.cols != src.cols) {
         fprintf(stderr, "Error: Matrices must have the same dimensions for copy.\n");
         return;
@@ -66,10 +72,12 @@ void copy_matrix(t_matrix dest, t_matrix src) {
    adj_list_to_matrix :
    Transforme la liste d'adjacence d'un graphe en matrice de transition.
    Chaque élément M[i][j] contient la probabilité de passer de i à j.
+   Retourne une matrice vide (data = NULL) si la mémoire manque.
 */
 t_matrix adj_list_to_matrix(t_graph graph) {
     int N = graph.num_vertices;
     t_matrix M = create_empty_matrix(N);
+    if (M.data == NULL) return M;
 
     for (int i = 0; i < N; i++) {
         t_edge *current_edge = graph.adj_lists[i].head;
@@ -94,15 +102,18 @@ t_matrix adj_list_to_matrix(t_graph graph) {
    multiply_matrices :
    Multiplie deux matrices carrées A et B pour produire C = A*B.
    Utilise la formule standard C[i][j] = sum(A[i][k] * B[k][j]).
+   Retourne une matrice vide (data = NULL) si les tailles ne correspondent pas
+   ou si la mémoire manque.
 */
 t_matrix multiply_matrices(t_matrix A, t_matrix B) {
     int N = A.rows;
-    if (A.cols != N || B.rows != N || B.cols != N) {
+    if (A.data == NULL || B.data == NULL || A.cols != N || B.rows != N || B.cols != N) {
         fprintf(stderr, "Error: Matrices must be square and matching sizes for multiplication.\n");
-        exit(EXIT_FAILURE);
+        return (t_matrix){NULL, 0, 0};
     }
     
     t_matrix C = create_empty_matrix(N);
+    if (C.data == NULL) return C;
 
     for (int i = 0; i < N; i++) {
         for (int j = 0; j < N; j++) {
@@ -111,6 +122,7 @@ t_matrix multiply_matrices(t_matrix A, t_matrix B) {
             C.data[i][j] = sum;
         }
     }
+    profile_count_flops(2LL * N * N * N);
     
     return C;
 }
@@ -134,6 +146,7 @@ float diff_matrices(t_matrix A, t_matrix B) {
             total_diff += fabsf(A.data[i][j] - B.data[i][j]);
         }
     }
+    profile_count_flops(2LL * N * N);
     
     return total_diff;
 }
@@ -149,6 +162,7 @@ t_matrix subMatrix(t_matrix matrix, t_partition part, int compo_index) {
     int k = class.num_members;
 
     t_matrix sub = create_empty_matrix(k);
+    if (sub.data == NULL) return sub;
 
     for (int r = 0; r < k; r++) {
         int original_row = class.members_ids[r] - 1;
@@ -161,18 +175,51 @@ t_matrix subMatrix(t_matrix matrix, t_partition part, int compo_index) {
     return sub;
 }
 
+/*
+   class_matrix_from_graph :
+   Même résultat que subMatrix, mais lu directement dans la liste d'adjacence :
+   aucune matrice N x N n'est nécessaire. La colonne d'une arête est cherchée
+   parmi les membres de la classe (coût k par arête, négligeable devant k³).
+*/
+t_matrix class_matrix_from_graph(t_graph graph, t_partition part, int compo_index) {
+    t_class class = part.classes[compo_index];
+    int k = class.num_members;
+
+    t_matrix sub = create_empty_matrix(k);
+    if (sub.data == NULL) return sub;
+
+    for (int r = 0; r < k; r++) {
+        for (t_edge *e = graph.adj_lists[class.members_ids[r] - 1].head; e != NULL; e = e->next) {
+            if (part.v_data[e->destination - 1].class_id != class.id) continue;
+            for (int c = 0; c < k; c++) {
+                if (class.members_ids[c] == e->destination) {
+                    sub.data[r][c] = e->probability;
+                    break;
+                }
+            }
+        }
+    }
+
+    return sub;
+}
+
 /*  
    powerMatrix :
    Calcule M^power (puissance d'une matrice) par exponentiation rapide.
    Utilisé pour approcher la distribution stationnaire d'une chaîne de Markov.
+   Retourne une matrice vide (data = NULL) si la mémoire manque.
 */
 t_matrix powerMatrix(t_matrix M, int power) {
     int N = M.rows;
 
     t_matrix result = create_empty_matrix(N);
-    for (int i = 0; i < N; i++) result.data[i][i] = 1.0f;
-
     t_matrix current = create_empty_matrix(N);
+    if (result.data == NULL || current.data == NULL) {
+        free_matrix(result);
+        free_matrix(current);
+        return (t_matrix){NULL, 0, 0};
+    }
+    for (int i = 0; i < N; i++) result.data[i][i] = 1.0f;
     copy_matrix(current, M);
 
     while (power > 0) {
@@ -186,6 +233,12 @@ t_matrix powerMatrix(t_matrix M, int power) {
         free_matrix(current);
         current = temp2;
 
+        if (result.data == NULL || current.data == NULL) {
+            free_matrix(result);
+            free_matrix(current);
+            return (t_matrix){NULL, 0, 0};
+        }
+
         power /= 2;
     }
 
@@ -197,20 +250,38 @@ t_matrix powerMatrix(t_matrix M, int power) {
    stationaryDistribution :
    Approxime la distribution stationnaire d'une matrice de transition.
    Multiplie successivement la matrice jusqu'à stabilisation (diff < epsilon).
-   Retourne la matrice finale représentant la distribution stationnaire.
+   Retourne la matrice finale représentant la distribution stationnaire,
+   ou une matrice vide (data = NULL) si la mémoire manque.
 */
 t_matrix stationaryDistribution(t_matrix M) {
+    return stationaryDistributionBudget(M, 199, 0);
+}
+
+/*
+   stationaryDistributionBudget :
+   Même calcul, le plafond de 199 produits (M^200) étant remplacé par max_iter (estimé à
+   partir du spectre, voir spectral.h). Avec squaring, M est élevée au carré jusqu'à
+   ce que diff(M^(2^(s+1)), M^(2^s)) < epsilon : log2(n) produits au lieu de n quand
+   la convergence est lente, max_iter comptant alors les élévations au carré.
+*/
+t_matrix stationaryDistributionBudget(t_matrix M, int max_iter, int squaring) {
     int N = M.rows;
 
-    t_matrix Mk   = create_empty_matrix(N);
+    t_matrix Mk   = {NULL, 0, 0};
     t_matrix Mk_1 = create_empty_matrix(N);
+    if (Mk_1.data == NULL) return Mk_1;
     copy_matrix(Mk_1, M);
 
     float epsilon = 0.01f;
 
-    for (int k = 2; k <= 200; k++) {
+    for (int k = 1; k <= max_iter; k++) {
+        profile_count_iterations(1);
         free_matrix(Mk);
-        Mk = multiply_matrices(Mk_1, M);
+        Mk = multiply_matrices(Mk_1, squaring ? Mk_1 : M);
+        if (Mk.data == NULL) {
+            free_matrix(Mk_1);
+            return Mk;
+        }
 
         float diff = diff_matrices(Mk, Mk_1);
         if (diff < epsilon) {
@@ -218,12 +289,15 @@ t_matrix stationaryDistribution(t_matrix M) {
             return Mk;
         }
 
+        // Mk devient Mk_1 : échange des pointeurs au lieu d'une nouvelle allocation + copie
         free_matrix(Mk_1);
-        Mk_1 = create_empty_matrix(N);
-        copy_matrix(Mk_1, Mk);
+        Mk_1 = Mk;
+        Mk = (t_matrix){NULL, 0, 0};
     }
+    Mk = Mk_1;
 
-    printf(" Avertissement : la matrice n’a pas convergé après 200 itérations.\n");
+    if (squaring) printf(" Avertissement : la matrice n’a pas convergé après %d élévations au carré.\n", max_iter);
+    else printf(" Avertissement : la matrice n’a pas convergé après %d itérations.\n", max_iter + 1);
     return Mk;
 }
 /*matrix.c transforme le graphe en matrice de transition, où chaque ligne représente 
@@ -237,3 +311,68 @@ où se trouvera un système après 2, 5 ou 10 transitions.
 En résumé : matrix.c convertit le graphe en outil mathématique et effectue les calculs
 nécessaires pour analyser une chaîne de Markov.
 */
+
+/*
+   periodicLimit :
+   Limite de (M^d)^k, d étant un multiple de la période de chaque classe persistante.
+   M^d n'a plus de classe périodique (chaque sous-classe cyclique devient une classe
+   apériodique), donc stationaryDistribution converge au lieu d'osciller jusqu'à son plafond.
+   La ligne i de la limite est la distribution limite de la sous-classe cyclique de i
+   (ou, pour un sommet transitoire, le mélange de celles où il finit).
+   Retourne une matrice vide (data = NULL) si la mémoire manque.
+*/
+t_matrix periodicLimit(t_matrix M, int period) {
+    return periodicLimitBudget(M, period, 199, 0);
+}
+
+//periodicLimitBudget : itère M^d avec le budget de stationaryDistributionBudget.
+t_matrix periodicLimitBudget(t_matrix M, int period, int max_iter, int squaring) {
+    t_matrix Q = powerMatrix(M, period);
+    if (Q.data == NULL) return Q;
+
+    t_matrix limit = stationaryDistributionBudget(Q, max_iter, squaring);
+    free_matrix(Q);
+    return limit;
+}
+
+/*
+   cesaroRow :
+   Moyenne de Cesàro de la ligne row : out = (1/d) * somme_{j < d} L[row] M^j, où L est
+   la limite de periodicLimit(M, d). C'est la limite de (1/n) * somme_{k < n} M^k, qui
+   existe même quand M^k oscille. Coût d produits vecteur-matrice.
+   Retourne 0, ou -1 si la mémoire manque.
+*/
+int cesaroRow(t_matrix M, t_matrix limit, int period, int row, double *out) {
+    int N = M.rows;
+    double *x = (double *)malloc(N * sizeof(double));
+    double *y = (double *)malloc(N * sizeof(double));
+    if (x == NULL || y == NULL) {
+        perror("Allocation failed for Cesaro average");
+        free(x);
+        free(y);
+        return -1;
+    }
+
+    for (int j = 0; j < N; j++) {
+        x[j] = limit.data[row][j];
+        out[j] = 0.0;
+    }
+    for (int step = 0; step < period; step++) {
+        for (int j = 0; j < N; j++) out[j] += x[j];
+        if (step == period - 1) break;
+
+        for (int j = 0; j < N; j++) y[j] = 0.0;
+        for (int i = 0; i < N; i++) {
+            if (x[i] == 0.0) continue;
+            for (int j = 0; j < N; j++) y[j] += x[i] * M.data[i][j];
+        }
+        double *tmp = x;
+        x = y;
+        y = tmp;
+    }
+    for (int j = 0; j < N; j++) out[j] /= period;
+
+    free(x);
+    free(y);
+    return 0;
+}
@@ -11,7 +11,7 @@ typedef struct s_matrix {
     int cols;          // Nombre de colonnes (N)
 } t_matrix;
 
-//Crée et initialise une matrice N x N remplie de zéros.
+//Crée et initialise une matrice N x N remplie de zéros. data vaut NULL si la mémoire manque (idem pour toutes les fonctions qui retournent une t_matrix).
 t_matrix create_empty_matrix(int N);
 
 //Libère la mémoire allouée pour la matrice.
@@ -34,8 +34,19 @@ float diff_matrices(t_matrix A, t_matrix B);
 //Partie 3 etape 2 
 
 t_matrix subMatrix(t_matrix matrix, t_partition part, int compo_index);
+//Sous-matrice d'une classe construite depuis la liste d'adjacence, sans passer par la matrice N x N.
+t_matrix class_matrix_from_graph(t_graph graph, t_partition part, int compo_index);
 t_matrix powerMatrix(t_matrix M, int power);
 t_matrix stationaryDistribution(t_matrix M);
+//Comme stationaryDistribution, avec au plus max_iter produits (stationaryDistribution : 199, soit M^200) ; par élévations au carré
+//successives si squaring vaut 1 (max_iter compte alors les élévations au carré).
+t_matrix stationaryDistributionBudget(t_matrix M, int max_iter, int squaring);
+//Limite de (M^d)^k : d est un multiple de la période de chaque classe persistante, la ligne i est la limite de la sous-classe cyclique de i.
+t_matrix periodicLimit(t_matrix M, int period);
+//Comme periodicLimit, avec le budget et la méthode de stationaryDistributionBudget.
+t_matrix periodicLimitBudget(t_matrix M, int period, int max_iter, int squaring);
+//Moyenne de Cesàro de la ligne row (limite de (1/n) somme M^k) à partir de limit = periodicLimit(M, period). out a N cases. Retourne -1 si la mémoire manque.
+int cesaroRow(t_matrix M, t_matrix limit, int period, int row, double *out);
 
 
 #endif // MATRIX_H
@@ -4,10 +4,11 @@
    getID :
    Transforme un entier i en identifiant de style Mermaid pour les noeuds.
    Exemple : 1 → A, 2 → B, ..., 26 → Z, 27 → AA, etc.
-   Utilise un buffer statique et retourne la chaîne correspondante.
+   Écrit dans le buffer fourni par l'appelant (au moins 10 caractères) et le retourne :
+   deux identifiants peuvent ainsi être utilisés dans le même fprintf, et la fonction
+   reste utilisable depuis plusieurs threads.
 */
-static char *getID(int i){
-    static char buffer[10];
+static char *getID(int i, char *buffer){
     char temp[10];
     int index = 0;
 
@@ -35,13 +36,40 @@ static char *getID(int i){
    2. Crée tous les sommets avec leur ID et numéro
    3. Crée toutes les arêtes avec les probabilités affichées
    Note : utilise getID pour générer les identifiants Mermaid des noeuds.
+   N'affiche rien : c'est l'appelant qui annonce le fichier généré (la fonction
+   est aussi appelée depuis les threads du mode batch).
 */
-void generate_mermaid_file(t_graph graph, const char *output_filename) {
+int generate_mermaid_file(t_graph graph, const char *output_filename) {
+    return generate_mermaid_file_named(graph, output_filename, NULL, NULL);
+}
+
+/*
+   write_node_text :
+   Texte d'un sommet étiqueté, entre guillemets pour que Mermaid accepte tout caractère ;
+   un guillemet de l'étiquette devient l'entité #quot;.
+*/
+static void write_node_text(FILE *file, const char *label) {
+    fputc('"', file);
+    for (const char *c = label; *c != '\0'; c++) {
+        if (*c == '"') fputs("#quot;", file);
+        else fputc(*c, file);
+    }
+    fputc('"', file);
+}
+
+/*
+   generate_mermaid_file_named :
+   Même fichier, chaque sommet v étant écrit sous le numéro labels[v - 1] : un graphe
+   renuméroté (reorder.h) est dessiné avec les numéros de son fichier d'origine.
+   Les identifiants Mermaid restent tirés des numéros (A, B, ...) : seul le texte
+   affiché dans le cercle devient l'étiquette de l'état.
+*/
+int generate_mermaid_file_named(t_graph graph, const char *output_filename, const int *labels, const t_label_table *names) {
     FILE *file = fopen(output_filename, "w");
 
     if (file == NULL) {
         perror("Could not open output file for writing");
-        return;
+        return -1;
     }
 
     // 1. Écriture des directives de configuration Mermaid
@@ -53,29 +81,39 @@ void generate_mermaid_file(t_graph graph, const char *output_filename) {
     fprintf(file, "---\n");
     fprintf(file, "flowchart LR\n"); // Graphe orienté de gauche à droite
 
+    char id_buffer[10];
+    char id_dest_buffer[10];
+
     // 2. Définition des sommets
     for (int i = 0; i < graph.num_vertices; i++) {
-        int vertex_num = i + 1;
-        char *id = getID(vertex_num);
+        int vertex_num = (labels != NULL) ? labels[i] : i + 1;
+        char *id = getID(vertex_num, id_buffer);
         // Double parenthèses pour dessiner un cercle autour du numéro
-        fprintf(file, "%s((%d))\n", id, vertex_num);
+        if (names != NULL) {
+            fprintf(file, "%s((", id);
+            write_node_text(file, label_name(names, vertex_num));
+            fprintf(file, "))\n");
+        } else {
+            fprintf(file, "%s((%d))\n", id, vertex_num);
+        }
     }
 
     // 3. Définition des arêtes avec probabilités
     for (int i = 0; i < graph.num_vertices; i++) {
-        int depart_num = i + 1;
-        char *id_depart = getID(depart_num);
+        int depart_num = (labels != NULL) ? labels[i] : i + 1;
+        char *id_depart = getID(depart_num, id_buffer);
 
         t_edge *current = graph.adj_lists[i].head;
         while (current != NULL) {
             // Affiche l'arête avec le format Mermaid : ID_DEPART -->|PROBA|ID_ARRIVEE
-            fprintf(file, "%s -->|%.2f|%s\n", id_depart, current->probability, getID(current->destination));
+            int dest_num = (labels != NULL) ? labels[current->destination - 1] : current->destination;
+            fprintf(file, "%s -->|%.2f|%s\n", id_depart, current->probability, getID(dest_num, id_dest_buffer));
             current = current->next;
         }
     }
 
     fclose(file);
-    printf("Fichier mermaid genere: %s\n", output_filename);
+    return 0;
 }
 /*mermaid_gen.c génère un fichier au format Mermaid, un langage visuel permettant de représenter des graphes sous forme de schémas.
 Il attribue un identifiant lisible (A, B, C, …) à chaque sommet pour faciliter l’affichage.
@@ -3,7 +3,11 @@
 
 #include "graph.h"
 
-//Produit un fichier texte au format Mermaid pour visualiser le graphe.
-void generate_mermaid_file(t_graph graph, const char *output_filename);
+//Produit un fichier texte au format Mermaid pour visualiser le graphe. Retourne 0 si succès, -1 sinon.
+int generate_mermaid_file(t_graph graph, const char *output_filename);
+
+//Idem en écrivant chaque sommet v sous le numéro labels[v - 1] (NULL : numéros du graphe), le numéro n étant affiché sous
+//l'étiquette n de names (NULL : numéros).
+int generate_mermaid_file_named(t_graph graph, const char *output_filename, const int *labels, const t_label_table *names);
 
 #endif // MERMAID_GEN_H
\ No newline at end of file
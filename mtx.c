@@ -0,0 +1,232 @@
+#include "mtx.h"
+#include <string.h>
+
+//Tampon d'écriture des fichiers .mtx : les millions de lignes courtes sont écrites par blocs.
+#define MTX_WRITE_BUFFER (1 << 20)
+
+/*
+   open_mtx :
+   Ouvre le fichier en écriture avec un tampon de MTX_WRITE_BUFFER octets, alloué ici
+   et libéré par close_mtx, puis écrit l'en-tête.
+*/
+static FILE *open_mtx(const char *output_filename, const char *format, char **buffer) {
+    FILE *file = fopen(output_filename, "w");
+    if (file == NULL) {
+        perror("Could not open output file for writing");
+        return NULL;
+    }
+    *buffer = (char *)malloc(MTX_WRITE_BUFFER);
+    if (*buffer != NULL) setvbuf(file, *buffer, _IOFBF, MTX_WRITE_BUFFER);
+    fprintf(file, "%%%%MatrixMarket matrix %s real general\n", format);
+    return file;
+}
+
+//close_mtx : ferme le fichier (les erreurs d'écriture différées par le tampon y apparaissent). Retourne 0 si succès, -1 sinon.
+static int close_mtx(FILE *file, char *buffer, const char *output_filename) {
+    int failed = ferror(file);
+    if (fclose(file) != 0) failed = 1;
+    free(buffer);
+    if (failed) {
+        fprintf(stderr, "Error: Could not write %s.\n", output_filename);
+        return -1;
+    }
+    return 0;
+}
+
+/*
+   format_probability :
+   Écriture la plus courte qui se relit à l'identique : 0.21 plutôt que 0.209999993.
+   Neuf chiffres significatifs suffisent toujours pour un float.
+*/
+static void format_probability(float value, char *buffer, size_t size) {
+    for (int digits = 6; digits < 9; digits++) {
+        snprintf(buffer, size, "%.*g", digits, value);
+        if (strtof(buffer, NULL) == value) return;
+    }
+    snprintf(buffer, size, "%.9g", value);
+}
+
+//write_int : écrit l'entier positif value suivi de separator (plus rapide que fprintf pour des millions d'indices).
+static void write_int(FILE *file, int value, char separator) {
+    char digits[16];
+    int length = 0;
+    digits[15] = separator;
+    do {
+        digits[14 - length++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    fwrite(digits + 15 - length, 1, (size_t)length + 1, file);
+}
+
+/*
+   mtx_write_graph :
+   La ligne de taille annonce le nombre d'arêtes : le graphe est parcouru une première
+   fois pour les compter (et trouver le plus grand degré). Les lectures ajoutant chaque
+   arête en tête de liste, les arêtes d'un sommet sont écrites de la dernière à la
+   première : le fichier relu redonne le même graphe, dans le même ordre. Les
+   probabilités se répètent souvent (1/degré) : la dernière écriture est réutilisée.
+*/
+int mtx_write_graph(t_graph graph, const char *output_filename, const int *labels) {
+    char *buffer = NULL;
+    FILE *file = open_mtx(output_filename, "coordinate", &buffer);
+    if (file == NULL) return -1;
+
+    fprintf(file, "%% Matrice de transition : entree (i, j) = probabilite de passer de l'etat i a l'etat j\n");
+    int num_edges = 0, max_degree = 1;
+    for (int i = 0; i < graph.num_vertices; i++) {
+        int degree = 0;
+        for (t_edge *e = graph.adj_lists[i].head; e != NULL; e = e->next) degree++;
+        num_edges += degree;
+        if (degree > max_degree) max_degree = degree;
+    }
+    const t_edge **edges = (const t_edge **)malloc(max_degree * sizeof(t_edge *));
+    if (edges == NULL) {
+        perror("Allocation failed for mtx edges");
+        close_mtx(file, buffer, output_filename);
+        return -1;
+    }
+
+    fprintf(file, "%d %d %d\n", graph.num_vertices, graph.num_vertices, num_edges);
+    char value[32];
+    size_t value_length = 0;
+    float last = -1.0f;
+    for (int i = 0; i < graph.num_vertices; i++) {
+        int from = (labels != NULL) ? labels[i] : i + 1;
+        int degree = 0;
+        for (const t_edge *e = graph.adj_lists[i].head; e != NULL; e = e->next) edges[degree++] = e;
+        while (degree > 0) {
+            const t_edge *e = edges[--degree];
+            int to = (labels != NULL) ? labels[e->destination - 1] : e->destination;
+            if (e->probability != last || value_length == 0) {
+                last = e->probability;
+                format_probability(last, value, sizeof(value) - 1);
+                value_length = strlen(value);
+                value[value_length++] = '\n';
+            }
+            write_int(file, from, ' ');
+            write_int(file, to, ' ');
+            fwrite(value, 1, value_length, file);
+        }
+    }
+    free(edges);
+    return close_mtx(file, buffer, output_filename);
+}
+
+/*
+   mtx_write_array :
+   Format array : ligne "rows cols" puis une valeur par ligne, colonne après colonne,
+   avec 17 chiffres significatifs (relecture exacte d'un double).
+*/
+int mtx_write_array(const char *output_filename, const double *values, int rows, int cols, const char *comment) {
+    char *buffer = NULL;
+    FILE *file = open_mtx(output_filename, "array", &buffer);
+    if (file == NULL) return -1;
+
+    if (comment != NULL) fprintf(file, "%% %s\n", comment);
+    fprintf(file, "%d %d\n", rows, cols);
+    size_t count = (size_t)rows * cols;
+    for (size_t k = 0; k < count; k++) fprintf(file, "%.17g\n", values[k]);
+    return close_mtx(file, buffer, output_filename);
+}
+
+//Écriture d'une case de mtx_write_tiled : fichier, numérotation de sortie, dernière probabilité formatée.
+typedef struct s_tiled_writer {
+    FILE *file;
+    const int *labels;
+    float last;
+    char value[32];
+    size_t value_length;
+} t_tiled_writer;
+
+static void write_tiled_entry(int i, int j, float value, void *data) {
+    t_tiled_writer *writer = (t_tiled_writer *)data;
+    if (value != writer->last || writer->value_length == 0) {
+        writer->last = value;
+        format_probability(value, writer->value, sizeof(writer->value) - 1);
+        writer->value_length = strlen(writer->value);
+        writer->value[writer->value_length++] = '\n';
+    }
+    write_int(writer->file, (writer->labels != NULL) ? writer->labels[i] : i + 1, ' ');
+    write_int(writer->file, (writer->labels != NULL) ? writer->labels[j] : j + 1, ' ');
+    fwrite(writer->value, 1, writer->value_length, writer->file);
+}
+
+/*
+   mtx_write_tiled :
+   Deux passages sur les tuiles : le premier compte les cases non nulles pour la ligne
+   de taille, le second les écrit, tuile après tuile (l'ordre des entrées du format
+   coordonné est libre). Le fichier se relit comme une chaîne (load_graph).
+*/
+int mtx_write_tiled(const t_tiled_matrix *M, const char *output_filename, const int *labels, const char *comment) {
+    char *buffer = NULL;
+    FILE *file = open_mtx(output_filename, "coordinate", &buffer);
+    if (file == NULL) return -1;
+
+    if (comment != NULL) fprintf(file, "%% %s\n", comment);
+    fprintf(file, "%d %d %lld\n", M->n, M->n, tiled_for_each_nonzero(M, NULL, NULL));
+    t_tiled_writer writer;
+    memset(&writer, 0, sizeof(writer));
+    writer.file = file;
+    writer.labels = labels;
+    tiled_for_each_nonzero(M, write_tiled_entry, &writer);
+    return close_mtx(file, buffer, output_filename);
+}
+
+//Largeur de la ligne de taille de mtx_write_columns, réécrite à la fin (le nombre d'entrées n'est connu qu'après coup).
+#define MTX_SIZE_LINE 48
+
+//write_size_line : écrit "rows cols entries" complétée par des espaces à MTX_SIZE_LINE caractères.
+static void write_size_line(FILE *file, int rows, int cols, long long entries) {
+    char line[MTX_SIZE_LINE + 1];
+    int length = snprintf(line, sizeof(line), "%d %d %lld", rows, cols, entries);
+    if (length < 0 || length > MTX_SIZE_LINE) length = MTX_SIZE_LINE;
+    memset(line + length, ' ', MTX_SIZE_LINE - length);
+    fprintf(file, "%.*s\n", MTX_SIZE_LINE, line);
+}
+
+/*
+   mtx_write_columns :
+   Une seule colonne en mémoire à la fois : le nombre d'entrées n'est connu qu'à la
+   fin, la ligne de taille est donc écrite à largeur fixe puis réécrite en place
+   (les espaces qui la complètent sont ignorés à la relecture).
+*/
+int mtx_write_columns(const char *output_filename, int rows, int cols, t_mtx_column column, void *data,
+                      const int *labels, const char *comment) {
+    double *values = (double *)malloc((rows > 0 ? rows : 1) * sizeof(double));
+    if (values == NULL) {
+        perror("Allocation failed for mtx column");
+        return -1;
+    }
+    char *buffer = NULL;
+    FILE *file = open_mtx(output_filename, "coordinate", &buffer);
+    if (file == NULL) {
+        free(values);
+        return -1;
+    }
+
+    if (comment != NULL) fprintf(file, "%% %s\n", comment);
+    long size_line = ftell(file);
+    write_size_line(file, rows, cols, 0);
+
+    long long entries = 0;
+    int failed = (size_line < 0);
+    for (int c = 0; c < cols && !failed; c++) {
+        if (column(c, values, data) != 0) {
+            failed = 1;
+            break;
+        }
+        for (int i = 0; i < rows; i++) {
+            if (values[i] == 0.0) continue;
+            write_int(file, (labels != NULL) ? labels[i] : i + 1, ' ');
+            write_int(file, c + 1, ' ');
+            fprintf(file, "%.17g\n", values[i]);
+            entries++;
+        }
+    }
+    free(values);
+
+    if (!failed && fseek(file, size_line, SEEK_SET) == 0) write_size_line(file, rows, cols, entries);
+    else failed = 1;
+    if (close_mtx(file, buffer, output_filename) != 0) return -1;
+    return failed ? -1 : 0;
+}
@@ -0,0 +1,37 @@
+#ifndef MTX_H
+#define MTX_H
+
+#include "graph.h"
+#include "tiled_matrix.h"
+
+/*
+   Écriture au format Matrix Market (.mtx), échangé avec les autres outils numériques.
+   La lecture est faite par load_graph (format reconnu à son en-tête "%%MatrixMarket").
+   La matrice de transition (une entrée par arête), les puissances P^K calculées par
+   tuiles et les probabilités d'absorption (une entrée par case non nulle) sont écrites
+   au format coordonné, les vecteurs de résultats au format array (toutes les valeurs).
+*/
+
+//Écrit la matrice de transition du graphe ("ligne colonne probabilité", indices 1-based), chaque sommet v sous le
+//numéro labels[v - 1] (NULL : numéros du graphe). Retourne 0 si succès, -1 sinon.
+int mtx_write_graph(t_graph graph, const char *output_filename, const int *labels);
+
+//Écrit un tableau rows x cols de valeurs rangées colonne par colonne. comment : ligne de commentaire, ou NULL.
+//Retourne 0 si succès, -1 sinon.
+int mtx_write_array(const char *output_filename, const double *values, int rows, int cols, const char *comment);
+
+//Écrit une matrice par tuiles au format coordonné (cases non nulles), sans la charger en mémoire ; l'indice v (1-based)
+//est écrit sous le numéro labels[v - 1] (NULL : numéros de la matrice). Retourne 0 si succès, -1 sinon.
+int mtx_write_tiled(const t_tiled_matrix *M, const char *output_filename, const int *labels, const char *comment);
+
+//Calcule la colonne column (0-based) d'une matrice écrite par mtx_write_columns : values (rows cases) reçoit ses valeurs.
+//Retourne 0 si succès, -1 sinon.
+typedef int (*t_mtx_column)(int column, double *values, void *data);
+
+//Écrit une matrice rows x cols au format coordonné (cases non nulles, 17 chiffres significatifs), colonne après colonne,
+//chacune calculée par column au moment de l'écrire ; la ligne i (1-based) est écrite sous le numéro labels[i - 1]
+//(NULL : i). Retourne 0 si succès, -1 sinon.
+int mtx_write_columns(const char *output_filename, int rows, int cols, t_mtx_column column, void *data,
+                      const int *labels, const char *comment);
+
+#endif // MTX_H
@@ -1,4 +1,5 @@
 #include "period.h"
+#include "profile.h"
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -45,6 +46,10 @@ int get_class_period(t_matrix sub_matrix) {
     
     // current_power = M^cpt
     t_matrix current_power = create_empty_matrix(n); 
+    if (current_power.data == NULL) {
+        free(periods);
+        return -1;
+    }
     // Initialisation à M^1 (M)
     copy_matrix(current_power, sub_matrix); 
 
@@ -53,6 +58,7 @@ int get_class_period(t_matrix sub_matrix) {
     int max_iter = 2 * n; 
     
     for (int cpt = 1; cpt <= max_iter; cpt++) {
+        profile_count_iterations(1);
 
         // --- 1. Vérification de la diagonale ---
         // S'il existe un i tel que (M^cpt)[i][i] > 0, c'est un chemin de retour de longueur cpt
@@ -80,6 +86,10 @@ int get_class_period(t_matrix sub_matrix) {
             t_matrix next_power = multiply_matrices(current_power, sub_matrix);
             free_matrix(current_power);
             current_power = next_power;
+            if (current_power.data == NULL) {
+                free(periods);
+                return -1;
+            }
         }
     }
 
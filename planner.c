@@ -0,0 +1,437 @@
+#include "planner.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "hasse.h"
+#include "block_matrix.h"
+#include "markov.h"
+
+/*
+   Modèle de coût. Les estimations servent à comparer les moteurs entre eux et
+   au budget mémoire, pas à prédire un temps exact :
+   - une allocation coûte sa taille plus un en-tête de l'allocateur ;
+   - stationaryDistribution fait entre 8 et 90 itérations sur les exemples de
+     data/ (plafond 200) ; l'itération creuse va jusqu'à 1e-10, donc plus loin.
+     Ces constantes ne servent que sans estimation spectrale : avec, le nombre
+     d'itérations de chaque classe vient de son |lambda_2| (spectral.h).
+*/
+#define MALLOC_OVERHEAD 16.0
+#define DENSE_ITER_ESTIMATE 100.0
+#define SPARSE_ITER_ESTIMATE 1000.0
+#define ABSORB_ITER_ESTIMATE 100.0
+
+/*
+   En dessous de ce coût, le moteur dense reste choisi s'il tient dans le budget :
+   c'est le calcul de référence du programme (mêmes valeurs affichées qu'avant
+   l'introduction du planificateur) et il prend moins d'un dixième de seconde.
+*/
+#define DENSE_CHEAP_FLOPS 1e8
+
+static const char *stage_names[PLAN_STAGE_COUNT] = {
+    "check", "mermaid", "classes", "hasse", "stationary", "period"
+};
+
+const char *plan_stage_name(t_plan_stage stage) {
+    return (stage >= 0 && stage < PLAN_STAGE_COUNT) ? stage_names[stage] : "?";
+}
+
+const char *plan_engine_name(t_plan_engine engine) {
+    switch (engine) {
+        case PLAN_ENGINE_AUTO:      return "auto";
+        case PLAN_ENGINE_LINEAR:    return "lineaire";
+        case PLAN_ENGINE_DENSE:     return "dense";
+        case PLAN_ENGINE_PER_CLASS: return "per-class";
+        case PLAN_ENGINE_SPARSE:    return "sparse";
+        case PLAN_ENGINE_BLOCK:     return "block";
+        case PLAN_ENGINE_CACHE:     return "cache";
+        case PLAN_ENGINE_DELTA:     return "delta";
+    }
+    return "?";
+}
+
+/*
+   plan_parse_stages :
+   Liste séparée par des virgules ; "all" sélectionne toutes les étapes.
+*/
+int plan_parse_stages(const char *list) {
+    char buffer[256];
+    int mask = 0;
+
+    if (list == NULL || strlen(list) >= sizeof(buffer)) return -1;
+    strcpy(buffer, list);
+
+    for (char *token = strtok(buffer, ","); token != NULL; token = strtok(NULL, ",")) {
+        if (strcmp(token, "all") == 0) {
+            mask |= PLAN_ALL_STAGES;
+            continue;
+        }
+        int found = 0;
+        for (int s = 0; s < PLAN_STAGE_COUNT; s++) {
+            if (strcmp(token, stage_names[s]) == 0) {
+                mask |= 1 << s;
+                found = 1;
+            }
+        }
+        if (!found) return -1;
+    }
+    return (mask != 0) ? mask : -1;
+}
+
+int plan_parse_engine(const char *name) {
+    static const t_plan_engine choices[] = {
+        PLAN_ENGINE_AUTO, PLAN_ENGINE_DENSE, PLAN_ENGINE_PER_CLASS, PLAN_ENGINE_SPARSE, PLAN_ENGINE_BLOCK
+    };
+    for (size_t i = 0; i < sizeof(choices) / sizeof(choices[0]); i++) {
+        if (strcmp(name, plan_engine_name(choices[i])) == 0) return choices[i];
+    }
+    return -1;
+}
+
+/*
+   plan_parse_memory :
+   Entier suivi d'un suffixe optionnel (K, M, G, T, éventuellement suivi de o ou B).
+*/
+long long plan_parse_memory(const char *text) {
+    char *end;
+    double value = strtod(text, &end);
+    if (end == text || value <= 0.0) return -1;
+
+    double unit = 1.0;
+    switch (*end) {
+        case 'k': case 'K': unit = 1024.0; end++; break;
+        case 'm': case 'M': unit = 1024.0 * 1024.0; end++; break;
+        case 'g': case 'G': unit = 1024.0 * 1024.0 * 1024.0; end++; break;
+        case 't': case 'T': unit = 1024.0 * 1024.0 * 1024.0 * 1024.0; end++; break;
+        default: break;
+    }
+    if (*end == 'o' || *end == 'B') end++;
+    if (*end != '\0') return -1;
+
+    return (long long)(value * unit);
+}
+
+long long plan_default_memory(void) {
+    long pages = sysconf(_SC_PHYS_PAGES);
+    long page_size = sysconf(_SC_PAGESIZE);
+    if (pages <= 0 || page_size <= 0) return 0;
+    return (long long)pages * page_size;
+}
+
+//Mémoire d'une t_matrix n x n : tableau de lignes plus une allocation par ligne.
+static double dense_bytes(double n) {
+    return n * sizeof(float *) + n * (n * sizeof(float) + MALLOC_OVERHEAD) + MALLOC_OVERHEAD;
+}
+
+//Recalcule le pic et la faisabilité à partir des étapes retenues.
+static void update_peak(t_plan *plan) {
+    double largest = 0.0;
+    for (int s = 0; s < PLAN_STAGE_COUNT; s++) {
+        if (plan->steps[s].enabled && plan->steps[s].bytes > largest) largest = plan->steps[s].bytes;
+    }
+    plan->peak_bytes = plan->base_bytes + largest;
+    plan->feasible = (plan->max_memory <= 0.0 || plan->peak_bytes <= plan->max_memory);
+}
+
+/*
+   plan_init :
+   Les étapes hasse, stationary et period ont besoin des classes ; la vérification
+   de la propriété de Markov est toujours faite (les autres étapes la supposent).
+   La partition et la matrice creuse restent en mémoire jusqu'à la fin : elles
+   comptent dans la mémoire de base dès que les classes sont calculées.
+*/
+void plan_init(t_plan *plan, int stages, long long max_memory, t_graph graph) {
+    double N = graph.num_vertices;
+
+    memset(plan, 0, sizeof(*plan));
+    plan->num_vertices = graph.num_vertices;
+    plan->num_edges = count_edges(graph);
+    plan->max_memory = (double)max_memory;
+    double E = (double)plan->num_edges;
+
+    for (int s = 0; s < PLAN_STAGE_COUNT; s++) {
+        plan->steps[s].enabled = (stages >> s) & 1;
+        plan->steps[s].engine = PLAN_ENGINE_LINEAR;
+    }
+    if (!plan->steps[PLAN_STAGE_CHECK].enabled) {
+        plan->steps[PLAN_STAGE_CHECK].enabled = plan->steps[PLAN_STAGE_CHECK].required = 1;
+    }
+    if (!plan->steps[PLAN_STAGE_CLASSES].enabled
+        && (plan->steps[PLAN_STAGE_HASSE].enabled || plan->steps[PLAN_STAGE_STATIONARY].enabled
+            || plan->steps[PLAN_STAGE_PERIOD].enabled)) {
+        plan->steps[PLAN_STAGE_CLASSES].enabled = plan->steps[PLAN_STAGE_CLASSES].required = 1;
+    }
+    plan->steps[PLAN_STAGE_STATIONARY].engine = PLAN_ENGINE_AUTO;
+    plan->steps[PLAN_STAGE_PERIOD].engine = PLAN_ENGINE_AUTO;
+
+    // Liste d'adjacence : une allocation par arête
+    plan->base_bytes = N * sizeof(t_list) + E * (sizeof(t_edge) + MALLOC_OVERHEAD);
+
+    plan->steps[PLAN_STAGE_CHECK].flops = E;
+    plan->steps[PLAN_STAGE_MERMAID].flops = E;
+    plan->steps[PLAN_STAGE_HASSE].flops = E;
+
+    if (plan->steps[PLAN_STAGE_CLASSES].enabled) {
+        // Tarjan, persistance, liens de Hasse et conversion CSR : quelques parcours du graphe
+        plan->steps[PLAN_STAGE_CLASSES].flops = 4.0 * (N + E);
+        // Piles et curseurs de Tarjan, libérés à la fin de l'étape
+        plan->steps[PLAN_STAGE_CLASSES].bytes = N * (3 * sizeof(int) + sizeof(t_edge *));
+        // Partition (au plus N classes), liens entre classes (au plus E) et CSR
+        plan->base_bytes += N * (sizeof(t_tarjan_vertex) + sizeof(int) + sizeof(t_class) + MALLOC_OVERHEAD)
+                          + E * sizeof(t_link)
+                          + (N + 1) * sizeof(int) + E * (sizeof(int) + sizeof(float));
+    }
+    update_peak(plan);
+}
+
+//Coût et mémoire d'un moteur pour une étape.
+typedef struct s_candidate {
+    t_plan_engine engine;
+    double flops;
+    double bytes;
+} t_candidate;
+
+/*
+   pick_engine :
+   Moteur imposé s'il est donné ; sinon le dense s'il est négligeable et tient
+   dans le budget, sinon le moins coûteux de ceux qui tiennent dans le budget.
+   Sans candidat acceptable, retient le moins gourmand en mémoire (le plan est
+   alors marqué irréalisable par update_peak).
+*/
+static t_candidate pick_engine(const t_plan *plan, const t_candidate *candidates, int count, t_plan_engine forced) {
+    double budget = (plan->max_memory > 0.0) ? plan->max_memory - plan->base_bytes : -1.0;
+    int best = -1, smallest = 0;
+
+    for (int i = 0; i < count; i++) {
+        if (forced != PLAN_ENGINE_AUTO && candidates[i].engine == forced) return candidates[i];
+        if (candidates[i].bytes < candidates[smallest].bytes) smallest = i;
+    }
+    for (int i = 0; i < count; i++) {
+        int fits = (budget < 0.0 || candidates[i].bytes <= budget);
+        if (!fits) continue;
+        if (candidates[i].engine == PLAN_ENGINE_DENSE && candidates[i].flops <= DENSE_CHEAP_FLOPS) return candidates[i];
+        if (best < 0 || candidates[i].flops < candidates[best].flops) best = i;
+    }
+    return candidates[best >= 0 ? best : smallest];
+}
+
+/*
+   plan_choose_engines :
+   Un parcours des arêtes donne, pour chaque classe, ses arêtes internes, et le
+   nombre d'arêtes qui partent des sommets transitoires (coût des absorptions).
+   - dense : matrice N x N, puissances successives (stationnaire) et sous-matrices
+     extraites de cette matrice (période) ;
+   - per-class : une matrice k x k par classe persistante, puis l'absorption en
+     creux pour pondérer les classes depuis le sommet 1 ;
+   - sparse : itération sur la CSR (stationnaire) et parcours en largeur (période) ;
+   - block : blocs diagonaux et blocs de couplage de la matrice triangulaire par
+     blocs (stationnaire) ; sa taille vient d'un second parcours, classe par classe,
+     qui compte les classes distinctes atteintes par chacune.
+   La période dense réutilise la matrice N x N de l'étape stationnaire dense.
+   Avec les estimations spectrales, chaque classe compte ses itérations attendues, les
+   moteurs denses le moins coûteux de l'itération et des élévations au carré, et les
+   moteurs creux l'élimination de Gauss quand elle coûte moins que l'itération.
+*/
+void plan_choose_engines(t_plan *plan, t_graph graph, t_partition partition, t_plan_engine forced,
+                         const t_spectral_estimate *spectral) {
+    double N = graph.num_vertices;
+    int num_classes = partition.num_classes;
+
+    plan->num_classes = num_classes;
+    plan->largest_class = 0;
+
+    long long *internal_edges = (long long *)calloc(num_classes > 0 ? num_classes : 1, sizeof(long long));
+    double transient_edges = 0.0;
+    if (internal_edges == NULL) {
+        perror("Allocation failed for plan");
+        plan->feasible = 0;
+        return;
+    }
+    for (int i = 0; i < graph.num_vertices; i++) {
+        int class_id = partition.v_data[i].class_id;
+        int transient = !partition.classes[class_id - 1].is_persistent;
+        for (t_edge *e = graph.adj_lists[i].head; e != NULL; e = e->next) {
+            if (partition.v_data[e->destination - 1].class_id == class_id) internal_edges[class_id - 1]++;
+            if (transient) transient_edges += 1.0;
+        }
+    }
+
+    // Valeurs de la matrice par blocs : k^2 par classe, plus k x taille de chaque classe atteinte
+    int *seen = (int *)malloc((num_classes > 0 ? num_classes : 1) * sizeof(int));
+    double block_entries = 0.0;
+    if (seen == NULL) {
+        perror("Allocation failed for plan");
+        free(internal_edges);
+        plan->feasible = 0;
+        return;
+    }
+    for (int c = 0; c < num_classes; c++) seen[c] = -1;
+    for (int c = 0; c < num_classes; c++) {
+        t_class cl = partition.classes[c];
+        double k = cl.num_members;
+        block_entries += k * k;
+        seen[c] = c;
+        for (int m = 0; m < cl.num_members; m++) {
+            for (t_edge *e = graph.adj_lists[cl.members_ids[m] - 1].head; e != NULL; e = e->next) {
+                int d = partition.v_data[e->destination - 1].class_id - 1;
+                if (seen[d] == c) continue;
+                seen[d] = c;
+                block_entries += k * partition.classes[d].num_members;
+            }
+        }
+    }
+    free(seen);
+
+    double dense_stationary_flops = 0.0, sparse_stationary_flops = 0.0, block_stationary_flops = 0.0;
+    double dense_period_flops = 0.0, sparse_period_flops = 0.0, build_flops = 0.0;
+    double largest_persistent = 0.0, largest_transient = 0.0, largest_direct = 0.0;
+    for (int c = 0; c < num_classes; c++) {
+        double k = partition.classes[c].num_members;
+        double e_k = (double)internal_edges[c];
+        if (partition.classes[c].num_members > plan->largest_class) plan->largest_class = partition.classes[c].num_members;
+        if (!partition.classes[c].is_persistent) {
+            // Élimination de Gauss sur le bloc diagonal
+            block_stationary_flops += 2.0 * k * k * k / 3.0;
+            if (k > largest_transient) largest_transient = k;
+            continue;
+        }
+
+        if (k > largest_persistent) largest_persistent = k;
+        build_flops += k * e_k; // Recherche de la colonne de chaque arête parmi les membres
+        dense_period_flops += 2.0 * k * 2.0 * k * k * k;
+        sparse_period_flops += 2.0 * (k + e_k);
+        if (k > 1) {
+            double dense_products = DENSE_ITER_ESTIMATE, lazy_iterations = SPARSE_ITER_ESTIMATE;
+            int direct = 0;
+            if (spectral != NULL) {
+                t_spectral_solver dense_solver;
+                dense_products = spectral_dense_products(&spectral[c], 1, (int)k, &dense_solver);
+                lazy_iterations = spectral_lazy_iterations(&spectral[c], MARKOV_STATIONARY_EPSILON);
+                if (lazy_iterations > MARKOV_STATIONARY_MAX_ITER) lazy_iterations = MARKOV_STATIONARY_MAX_ITER;
+                direct = spectral_class_solver(&spectral[c], (int)k, internal_edges[c], MARKOV_STATIONARY_EPSILON) == SPECTRAL_SOLVER_DIRECT;
+            }
+            dense_stationary_flops += dense_products * (2.0 * k * k * k + 2.0 * k * k);
+            if (direct) {
+                double gauss = 2.0 * k * k * k / 3.0 + k * k + e_k;
+                sparse_stationary_flops += gauss;
+                block_stationary_flops += gauss;
+                if (k > largest_direct) largest_direct = k;
+            } else {
+                sparse_stationary_flops += lazy_iterations * (2.0 * e_k + 4.0 * k);
+                block_stationary_flops += lazy_iterations * (2.0 * k * k + 4.0 * k);
+            }
+        }
+    }
+    free(internal_edges);
+
+    // Absorption depuis le sommet 1 : trois vecteurs de N cases et une case par classe
+    double absorb_bytes = 3.0 * N * sizeof(double) + num_classes * sizeof(double);
+    if (forced == PLAN_ENGINE_CACHE || forced == PLAN_ENGINE_DELTA) {
+        // Les résultats sont déjà dans le contexte : il ne reste qu'à les afficher
+        for (int s = PLAN_STAGE_STATIONARY; s <= PLAN_STAGE_PERIOD; s++) {
+            plan->steps[s].engine = forced;
+            plan->steps[s].flops = 0.0;
+            plan->steps[s].bytes = 0.0;
+        }
+        update_peak(plan);
+        return;
+    }
+    double absorb_flops = ABSORB_ITER_ESTIMATE * 2.0 * transient_edges;
+    // Matrices de travail d'une classe : puissance courante, suivante, sous-matrice et longueurs de retour
+    double class_period_bytes = 3.0 * dense_bytes(largest_persistent) + largest_persistent * largest_persistent * sizeof(int);
+
+    t_plan_step *stationary = &plan->steps[PLAN_STAGE_STATIONARY];
+    if (stationary->enabled) {
+        double dense_products = DENSE_ITER_ESTIMATE;
+        if (spectral != NULL) {
+            t_spectral_estimate worst = spectral_worst(spectral, num_classes);
+            t_spectral_solver dense_solver;
+            dense_products = spectral_dense_products(&worst, 1, graph.num_vertices, &dense_solver);
+        }
+        // Matrice k x k en double de la plus grande classe résolue par élimination de Gauss
+        double direct_bytes = largest_direct * largest_direct * sizeof(double);
+        // Blocs (valeurs, position et bloc-ligne de chaque sommet), masse par sommet et un bloc transitoire en double
+        double block_bytes = block_entries * sizeof(float) + (N + num_classes) * (2.0 * sizeof(int) + sizeof(t_block))
+                           + N * sizeof(double) + largest_transient * largest_transient * sizeof(double);
+        t_candidate candidates[4] = {
+            {PLAN_ENGINE_DENSE, dense_products * (2.0 * N * N * N + 2.0 * N * N), 3.0 * dense_bytes(N)},
+            {PLAN_ENGINE_PER_CLASS, dense_stationary_flops + build_flops + absorb_flops,
+             3.0 * dense_bytes(largest_persistent) + N * sizeof(double) + absorb_bytes},
+            {PLAN_ENGINE_SPARSE, sparse_stationary_flops + absorb_flops, 2.0 * N * sizeof(double) + absorb_bytes + direct_bytes},
+            {PLAN_ENGINE_BLOCK, block_stationary_flops + 2.0 * block_entries, block_bytes + direct_bytes}
+        };
+        t_candidate chosen = pick_engine(plan, candidates, 4, forced);
+        stationary->engine = chosen.engine;
+        stationary->flops = chosen.flops;
+        stationary->bytes = chosen.bytes;
+    }
+
+    t_plan_step *period = &plan->steps[PLAN_STAGE_PERIOD];
+    if (period->enabled) {
+        int shares_matrix = stationary->enabled && stationary->engine == PLAN_ENGINE_DENSE;
+        t_candidate candidates[3] = {
+            {PLAN_ENGINE_DENSE, dense_period_flops + (shares_matrix ? 0.0 : N * N),
+             dense_bytes(N) + class_period_bytes},
+            {PLAN_ENGINE_PER_CLASS, dense_period_flops + build_flops, class_period_bytes},
+            {PLAN_ENGINE_SPARSE, sparse_period_flops, N * sizeof(int) + largest_persistent * sizeof(int)}
+        };
+        t_candidate chosen = pick_engine(plan, candidates, 3, forced);
+        period->engine = chosen.engine;
+        period->flops = chosen.flops;
+        period->bytes = chosen.bytes;
+    }
+
+    update_peak(plan);
+}
+
+int plan_runs(const t_plan *plan, t_plan_stage stage) {
+    return plan->steps[stage].enabled;
+}
+
+//Taille lisible : o, Ko, Mo, Go, To.
+static void format_bytes(double bytes, char *buffer, size_t size) {
+    static const char *units[] = {"o", "Ko", "Mo", "Go", "To"};
+    int u = 0;
+    while (bytes >= 1024.0 && u < 4) {
+        bytes /= 1024.0;
+        u++;
+    }
+    snprintf(buffer, size, (u == 0) ? "%.0f %s" : "%.1f %s", bytes, units[u]);
+}
+
+/*
+   display_plan :
+   Une ligne par étape. Les étapes non demandées sont affichées comme ignorées,
+   celles ajoutées pour une dépendance comme requises.
+*/
+void display_plan(const t_plan *plan) {
+    char memory[32], budget[32];
+
+    printf("\n--- Plan d'execution ---\n");
+    printf("N = %d sommets, E = %lld aretes", plan->num_vertices, plan->num_edges);
+    if (plan->num_classes > 0) printf(", %d classe(s), la plus grande de %d sommet(s)", plan->num_classes, plan->largest_class);
+    printf("\n\n%-12s %-10s %14s %12s\n", "etape", "moteur", "cout (flop)", "memoire");
+
+    for (int s = 0; s < PLAN_STAGE_COUNT; s++) {
+        const t_plan_step *step = &plan->steps[s];
+        if (!step->enabled) {
+            printf("%-12s ignoree\n", stage_names[s]);
+            continue;
+        }
+        format_bytes(step->bytes, memory, sizeof(memory));
+        printf("%-12s %-10s %14.3g %12s%s\n", stage_names[s], plan_engine_name(step->engine),
+               step->flops, memory, step->required ? "  (requise)" : "");
+    }
+
+    format_bytes(plan->base_bytes, memory, sizeof(memory));
+    printf("\nMemoire de base (graphe, partition, CSR) : %s\n", memory);
+    format_bytes(plan->peak_bytes, memory, sizeof(memory));
+    if (plan->max_memory > 0.0) {
+        format_bytes(plan->max_memory, budget, sizeof(budget));
+        printf("Pic estime : %s pour un budget de %s%s\n", memory, budget,
+               plan->feasible ? "" : " : DEPASSEMENT");
+    } else {
+        printf("Pic estime : %s (budget inconnu)\n", memory);
+    }
+}
@@ -0,0 +1,91 @@
+#ifndef PLANNER_H
+#define PLANNER_H
+
+#include <stddef.h>
+#include "graph.h"
+#include "tarjan.h"
+#include "spectral.h"
+
+//Étapes de l'analyse en ligne de commande, sélectionnables par --stages (dans l'ordre d'exécution).
+typedef enum e_plan_stage {
+    PLAN_STAGE_CHECK = 0,    // Propriété de Markov
+    PLAN_STAGE_MERMAID,      // Fichier Mermaid du graphe
+    PLAN_STAGE_CLASSES,      // Classes, persistance (Tarjan)
+    PLAN_STAGE_HASSE,        // Fichier Mermaid du diagramme de Hasse
+    PLAN_STAGE_STATIONARY,   // Distribution limite partant du sommet 1
+    PLAN_STAGE_PERIOD,       // Période des classes persistantes
+    PLAN_STAGE_COUNT
+} t_plan_stage;
+
+//Masque de toutes les étapes (valeur par défaut de --stages).
+#define PLAN_ALL_STAGES ((1 << PLAN_STAGE_COUNT) - 1)
+
+//Manière d'exécuter une étape.
+typedef enum e_plan_engine {
+    PLAN_ENGINE_AUTO = 0,    // Choix du planificateur (valeur par défaut de --engine)
+    PLAN_ENGINE_LINEAR,      // Parcours du graphe en O(N + E), sans alternative
+    PLAN_ENGINE_DENSE,       // Matrice N x N (t_matrix)
+    PLAN_ENGINE_PER_CLASS,   // Une matrice dense k x k par classe, construite depuis la liste d'adjacence
+    PLAN_ENGINE_SPARSE,      // Matrice creuse CSR
+    PLAN_ENGINE_BLOCK,       // Matrice triangulaire supérieure par blocs de classes (block_matrix.c), étape stationnaire seulement
+    PLAN_ENGINE_CACHE,       // Résultats de markov_analyze_cached, lus dans le cache ou calculés en creux (--cache)
+    PLAN_ENGINE_DELTA        // Résultats de l'analyse de base mis à jour par markov_apply_delta (--delta)
+} t_plan_engine;
+
+//Une étape du plan avec son coût estimé.
+typedef struct s_plan_step {
+    int enabled;             // 1 si l'étape sera exécutée
+    int required;            // 1 si elle est exécutée parce qu'une étape demandée en dépend
+    t_plan_engine engine;
+    double flops;            // Opérations estimées
+    double bytes;            // Mémoire de travail estimée, en plus de la mémoire de base
+} t_plan_step;
+
+//Plan d'exécution : étapes retenues, moteur de chaque étape et mémoire estimée.
+typedef struct s_plan {
+    t_plan_step steps[PLAN_STAGE_COUNT];
+    int num_vertices;
+    long long num_edges;
+    int num_classes;         // 0 tant que les classes ne sont pas connues
+    int largest_class;
+    double base_bytes;       // Graphe, partition et matrice creuse, présents pendant toutes les étapes
+    double peak_bytes;       // Base + plus grosse étape
+    double max_memory;       // Budget (--max-memory)
+    int feasible;            // 0 si une étape dépasse le budget quel que soit le moteur
+} t_plan;
+
+//Nom d'une étape tel qu'accepté par --stages.
+const char *plan_stage_name(t_plan_stage stage);
+
+//Nom d'un moteur tel qu'accepté par --engine.
+const char *plan_engine_name(t_plan_engine engine);
+
+//Masque d'étapes à partir d'une liste "classes,period" (ou "all"). Retourne -1 si un nom est inconnu.
+int plan_parse_stages(const char *list);
+
+//Moteur à partir de son nom ("auto", "dense", "per-class", "sparse", "block"). Retourne -1 si le nom est inconnu.
+int plan_parse_engine(const char *name);
+
+//Taille mémoire "512M", "4G", "100000" (octets ; suffixes K, M, G, T en puissances de 1024). Retourne -1 si invalide.
+long long plan_parse_memory(const char *text);
+
+//Mémoire physique de la machine (budget par défaut), 0 si inconnue.
+long long plan_default_memory(void);
+
+//Première phase, après lecture du graphe : étapes retenues (dépendances comprises) et coût des étapes linéaires.
+void plan_init(t_plan *plan, int stages, long long max_memory, t_graph graph);
+
+//Seconde phase, une fois les classes connues : moteur et coût des étapes stationnaire et période.
+//forced impose le moteur de ces deux étapes (PLAN_ENGINE_AUTO : le moins coûteux dans le budget ;
+//PLAN_ENGINE_CACHE, PLAN_ENGINE_DELTA : résultats déjà présents dans le contexte, coût nul).
+//spectral (num_classes cases, voir spectral_estimates) donne les itérations attendues de chaque classe ; NULL : estimations fixes.
+void plan_choose_engines(t_plan *plan, t_graph graph, t_partition partition, t_plan_engine forced,
+                         const t_spectral_estimate *spectral);
+
+//1 si l'étape fait partie du plan.
+int plan_runs(const t_plan *plan, t_plan_stage stage);
+
+//Affiche le plan : moteur, coût et mémoire estimés de chaque étape.
+void display_plan(const t_plan *plan);
+
+#endif // PLANNER_H
@@ -0,0 +1,254 @@
+#include "profile.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
+
+/*
+   Compteurs globaux au processus : comme les compteurs matériels, ils mesurent
+   tout ce qui s'exécute pendant une étape. Ce sont de simples additions atomiques,
+   toujours actives, que les fonctions de calcul appellent sans connaître le profil.
+*/
+static atomic_llong allocation_count;
+static atomic_llong allocation_bytes;
+static atomic_llong flop_count;
+static atomic_llong iteration_count;
+static atomic_int allocations_hooked;
+
+static const char *hw_names[PROFILE_HW_COUNT] = {"instructions", "cycles", "cache_misses"};
+
+void profile_count_alloc(size_t bytes) {
+    atomic_fetch_add_explicit(&allocation_count, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&allocation_bytes, (long long)bytes, memory_order_relaxed);
+    atomic_store_explicit(&allocations_hooked, 1, memory_order_relaxed);
+}
+
+void profile_count_flops(long long flops) {
+    atomic_fetch_add_explicit(&flop_count, flops, memory_order_relaxed);
+}
+
+void profile_count_iterations(long long iterations) {
+    atomic_fetch_add_explicit(&iteration_count, iterations, memory_order_relaxed);
+}
+
+int profile_tracks_allocations(void) {
+    return atomic_load(&allocations_hooked);
+}
+
+static double clock_ms(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+#ifdef __linux__
+//Ouvre un compteur matériel pour le processus courant (espace utilisateur seulement). Retourne -1 si refusé.
+static int open_hw_counter(unsigned long long config) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+#endif
+
+/*
+   profile_init :
+   Les compteurs perf_event tournent en continu depuis leur ouverture : chaque
+   étape lit leur valeur au début et à la fin. Ils restent à -1 si le noyau les
+   refuse (perf_event_paranoid, machine virtuelle, autre système que Linux).
+*/
+void profile_init(t_profiler *profiler) {
+    memset(profiler, 0, sizeof(*profiler));
+    profiler->current = -1;
+    profiler->origin_ms = clock_ms(CLOCK_MONOTONIC);
+
+    for (int h = 0; h < PROFILE_HW_COUNT; h++) profiler->hw_fds[h] = -1;
+#ifdef __linux__
+    static const unsigned long long configs[PROFILE_HW_COUNT] = {
+        PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_CACHE_MISSES
+    };
+    for (int h = 0; h < PROFILE_HW_COUNT; h++) profiler->hw_fds[h] = open_hw_counter(configs[h]);
+#endif
+}
+
+void profile_free(t_profiler *profiler) {
+    for (int h = 0; h < PROFILE_HW_COUNT; h++) {
+        if (profiler->hw_fds[h] >= 0) close(profiler->hw_fds[h]);
+        profiler->hw_fds[h] = -1;
+    }
+}
+
+int profile_has_hw_counters(const t_profiler *profiler) {
+    for (int h = 0; h < PROFILE_HW_COUNT; h++) {
+        if (profiler->hw_fds[h] >= 0) return 1;
+    }
+    return 0;
+}
+
+//Instantané de tous les compteurs.
+static t_profile_counters read_counters(const t_profiler *profiler) {
+    t_profile_counters c;
+    c.wall_ms = clock_ms(CLOCK_MONOTONIC);
+    c.cpu_ms = clock_ms(CLOCK_PROCESS_CPUTIME_ID);
+    c.allocations = atomic_load(&allocation_count);
+    c.allocated_bytes = atomic_load(&allocation_bytes);
+    c.iterations = atomic_load(&iteration_count);
+    c.flops = atomic_load(&flop_count);
+    for (int h = 0; h < PROFILE_HW_COUNT; h++) {
+        long long value = -1;
+        if (profiler->hw_fds[h] < 0 || read(profiler->hw_fds[h], &value, sizeof(value)) != sizeof(value)) value = -1;
+        c.hw[h] = value;
+    }
+    return c;
+}
+
+void profile_begin(t_profiler *profiler, const char *name) {
+    if (profiler == NULL || profiler->num_phases >= PROFILE_MAX_PHASES) return;
+
+    t_profile_phase *phase = &profiler->phases[profiler->num_phases];
+    strncpy(phase->name, name, PROFILE_MAX_NAME - 1);
+    phase->name[PROFILE_MAX_NAME - 1] = '\0';
+    phase->parent = profiler->current;
+    phase->depth = (profiler->current >= 0) ? profiler->phases[profiler->current].depth + 1 : 0;
+    profiler->current = profiler->num_phases++;
+
+    // Lecture en dernier : le coût de l'enregistrement n'est pas attribué à l'étape
+    phase->start = read_counters(profiler);
+    phase->start_ms = phase->start.wall_ms - profiler->origin_ms;
+}
+
+void profile_end(t_profiler *profiler) {
+    if (profiler == NULL || profiler->current < 0) return;
+
+    t_profile_counters now = read_counters(profiler);
+    t_profile_phase *phase = &profiler->phases[profiler->current];
+    t_profile_counters *start = &phase->start;
+
+    phase->total.wall_ms = now.wall_ms - start->wall_ms;
+    phase->total.cpu_ms = now.cpu_ms - start->cpu_ms;
+    phase->total.allocations = now.allocations - start->allocations;
+    phase->total.allocated_bytes = now.allocated_bytes - start->allocated_bytes;
+    phase->total.iterations = now.iterations - start->iterations;
+    phase->total.flops = now.flops - start->flops;
+    for (int h = 0; h < PROFILE_HW_COUNT; h++) {
+        phase->total.hw[h] = (now.hw[h] < 0 || start->hw[h] < 0) ? -1 : now.hw[h] - start->hw[h];
+    }
+    profiler->current = phase->parent;
+}
+
+void profile_display(const t_profiler *profiler) {
+    int tracked = profile_tracks_allocations();
+
+    printf("\n--- Profil par etape (valeurs incluant les sous-etapes) ---\n");
+    printf("%-34s %10s %10s %9s %12s %9s %12s %14s %12s\n",
+           "etape", "mur(ms)", "cpu(ms)", "allocs", "octets", "iter", "flops", "instructions", "cache-miss");
+    for (int i = 0; i < profiler->num_phases; i++) {
+        const t_profile_phase *phase = &profiler->phases[i];
+        char label[PROFILE_MAX_NAME + 16];
+        snprintf(label, sizeof(label), "%*s%s", 2 * phase->depth, "", phase->name);
+
+        printf("%-34s %10.3f %10.3f ", label, phase->total.wall_ms, phase->total.cpu_ms);
+        if (tracked) printf("%9lld %12lld ", phase->total.allocations, phase->total.allocated_bytes);
+        else printf("%9s %12s ", "-", "-");
+        printf("%9lld %12lld ", phase->total.iterations, phase->total.flops);
+        if (phase->total.hw[PROFILE_HW_INSTRUCTIONS] >= 0) printf("%14lld ", phase->total.hw[PROFILE_HW_INSTRUCTIONS]);
+        else printf("%14s ", "-");
+        if (phase->total.hw[PROFILE_HW_CACHE_MISSES] >= 0) printf("%12lld\n", phase->total.hw[PROFILE_HW_CACHE_MISSES]);
+        else printf("%12s\n", "-");
+    }
+    if (!tracked) printf("(allocations non comptees : executable lie sans les enveloppes malloc)\n");
+    if (!profile_has_hw_counters(profiler)) printf("(compteurs materiels indisponibles : perf_event refuse par le systeme)\n");
+}
+
+//Écrit une chaîne JSON en échappant guillemets et barres obliques inverses.
+static void write_json_string(FILE *out, const char *text) {
+    fputc('"', out);
+    for (const char *c = text; *c != '\0'; c++) {
+        if (*c == '"' || *c == '\\') fputc('\\', out);
+        fputc(*c, out);
+    }
+    fputc('"', out);
+}
+
+/*
+   profile_write_json :
+   Une entrée par étape, dans l'ordre d'ouverture. Les compteurs indisponibles
+   (allocations non suivies, perf_event refusé) valent null.
+*/
+int profile_write_json(const t_profiler *profiler, const char *input_path, const char *output_path) {
+    FILE *out = fopen(output_path, "w");
+    if (out == NULL) {
+        perror("Could not open profile report");
+        return -1;
+    }
+    int tracked = profile_tracks_allocations();
+
+    fprintf(out, "{\n  \"input\": ");
+    write_json_string(out, input_path);
+    fprintf(out, ",\n  \"allocations_tracked\": %s,\n  \"hardware_counters\": %s,\n  \"phases\": [\n",
+            tracked ? "true" : "false", profile_has_hw_counters(profiler) ? "true" : "false");
+
+    for (int i = 0; i < profiler->num_phases; i++) {
+        const t_profile_phase *phase = &profiler->phases[i];
+        fprintf(out, "    {\"name\": ");
+        write_json_string(out, phase->name);
+        fprintf(out, ", \"parent\": ");
+        if (phase->parent >= 0) write_json_string(out, profiler->phases[phase->parent].name);
+        else fprintf(out, "null");
+        fprintf(out, ", \"depth\": %d, \"start_ms\": %.6f, \"wall_ms\": %.6f, \"cpu_ms\": %.6f",
+                phase->depth, phase->start_ms, phase->total.wall_ms, phase->total.cpu_ms);
+        if (tracked) {
+            fprintf(out, ", \"allocations\": %lld, \"allocated_bytes\": %lld",
+                    phase->total.allocations, phase->total.allocated_bytes);
+        } else {
+            fprintf(out, ", \"allocations\": null, \"allocated_bytes\": null");
+        }
+        fprintf(out, ", \"iterations\": %lld, \"flops\": %lld", phase->total.iterations, phase->total.flops);
+        for (int h = 0; h < PROFILE_HW_COUNT; h++) {
+            if (phase->total.hw[h] >= 0) fprintf(out, ", \"%s\": %lld", hw_names[h], phase->total.hw[h]);
+            else fprintf(out, ", \"%s\": null", hw_names[h]);
+        }
+        fprintf(out, "}%s\n", (i < profiler->num_phases - 1) ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+
+    return (fclose(out) == 0) ? 0 : -1;
+}
+
+/*
+   profile_write_trace :
+   Événements "complets" (ph = X) en microsecondes : les étapes imbriquées
+   s'affichent en flame chart dans chrome://tracing, Perfetto ou speedscope.
+*/
+int profile_write_trace(const t_profiler *profiler, const char *output_path) {
+    FILE *out = fopen(output_path, "w");
+    if (out == NULL) {
+        perror("Could not open profile trace");
+        return -1;
+    }
+
+    fprintf(out, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+    for (int i = 0; i < profiler->num_phases; i++) {
+        const t_profile_phase *phase = &profiler->phases[i];
+        fprintf(out, "  {\"name\": ");
+        write_json_string(out, phase->name);
+        fprintf(out, ", \"cat\": \"markov\", \"ph\": \"X\", \"pid\": 1, \"tid\": 1, \"ts\": %.3f, \"dur\": %.3f, "
+                     "\"args\": {\"cpu_ms\": %.3f, \"iterations\": %lld, \"flops\": %lld}}%s\n",
+                phase->start_ms * 1000.0, phase->total.wall_ms * 1000.0, phase->total.cpu_ms,
+                phase->total.iterations, phase->total.flops, (i < profiler->num_phases - 1) ? "," : "");
+    }
+    fprintf(out, "]}\n");
+
+    return (fclose(out) == 0) ? 0 : -1;
+}
@@ -0,0 +1,79 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stddef.h>
+
+#define PROFILE_MAX_PHASES 64
+#define PROFILE_MAX_NAME 48
+
+//Compteurs matériels lus par perf_event (Linux), dans cet ordre.
+typedef enum e_profile_hw {
+    PROFILE_HW_INSTRUCTIONS = 0,
+    PROFILE_HW_CYCLES,
+    PROFILE_HW_CACHE_MISSES,
+    PROFILE_HW_COUNT
+} t_profile_hw;
+
+//Valeurs mesurées sur une étape (ou instantané des compteurs au début d'une étape).
+typedef struct s_profile_counters {
+    double wall_ms;                  // Temps écoulé
+    double cpu_ms;                   // Temps CPU du processus
+    long long allocations;           // Appels malloc / calloc / realloc
+    long long allocated_bytes;       // Octets demandés
+    long long iterations;            // Itérations des boucles de convergence
+    long long flops;                 // Opérations flottantes des étapes matricielles
+    long long hw[PROFILE_HW_COUNT];  // Compteurs matériels, -1 si indisponibles
+} t_profile_counters;
+
+//Une étape mesurée. Les étapes s'emboîtent : les valeurs d'une étape incluent celles de ses sous-étapes.
+typedef struct s_profile_phase {
+    char name[PROFILE_MAX_NAME];
+    int parent;                      // Indice de l'étape englobante, -1 pour une étape de premier niveau
+    int depth;
+    double start_ms;                 // Début, relatif au début du profil
+    t_profile_counters start;        // Compteurs au début (usage interne)
+    t_profile_counters total;        // Valeurs de l'étape, remplies par profile_end
+} t_profile_phase;
+
+//Profil d'une exécution. Passer NULL aux fonctions profile_begin / profile_end désactive la mesure.
+typedef struct s_profiler {
+    t_profile_phase phases[PROFILE_MAX_PHASES];
+    int num_phases;
+    int current;                     // Étape ouverte la plus interne, -1 si aucune
+    int hw_fds[PROFILE_HW_COUNT];    // Descripteurs perf_event, -1 si indisponibles
+    double origin_ms;
+} t_profiler;
+
+//Prépare un profil vide et ouvre les compteurs matériels quand le noyau le permet.
+void profile_init(t_profiler *profiler);
+
+//Ferme les compteurs matériels.
+void profile_free(t_profiler *profiler);
+
+//Ouvre une étape (imbriquée dans l'étape courante). Sans effet si profiler vaut NULL.
+void profile_begin(t_profiler *profiler, const char *name);
+
+//Ferme l'étape courante. Sans effet si profiler vaut NULL.
+void profile_end(t_profiler *profiler);
+
+//Compteurs globaux au processus, incrémentés par le code de calcul (atomiques, utilisables depuis tous les threads).
+void profile_count_alloc(size_t bytes);
+void profile_count_flops(long long flops);
+void profile_count_iterations(long long iterations);
+
+//1 si les allocations sont comptées (exécutable lié avec les enveloppes de profile_alloc.c), 0 sinon.
+int profile_tracks_allocations(void);
+
+//1 si les compteurs matériels sont disponibles.
+int profile_has_hw_counters(const t_profiler *profiler);
+
+//Affiche le tableau des étapes.
+void profile_display(const t_profiler *profiler);
+
+//Écrit le rapport JSON (une entrée par étape). Retourne 0 si succès, -1 sinon.
+int profile_write_json(const t_profiler *profiler, const char *input_path, const char *output_path);
+
+//Écrit une trace au format Chrome trace events (chrome://tracing, Perfetto, speedscope). Retourne 0 si succès, -1 sinon.
+int profile_write_trace(const t_profiler *profiler, const char *output_path);
+
+#endif // PROFILE_H
@@ -0,0 +1,29 @@
+/*
+   profile_alloc.c : comptage des allocations pour le mode --profile.
+   markov_analyzer est lié avec -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc :
+   tous les appels de l'exécutable et de libmarkov (liée statiquement) passent par
+   ces enveloppes, qui comptent la demande puis appellent l'allocateur de la libc.
+   Ce fichier n'est pas dans la bibliothèque : libmarkov.so reste sans dépendance
+   à l'éditeur de liens GNU.
+*/
+#include <stddef.h>
+#include "profile.h"
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *pointer, size_t size);
+
+void *__wrap_malloc(size_t size) {
+    profile_count_alloc(size);
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+    profile_count_alloc(count * size);
+    return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *pointer, size_t size) {
+    profile_count_alloc(size);
+    return __real_realloc(pointer, size);
+}
@@ -0,0 +1,298 @@
+#include "pull.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include "profile.h"
+
+/*
+   pull_worker_main :
+   Attend la fin du lancement (gate), puis exécute chaque travail de l'équipe entre
+   deux passages de la barrière, jusqu'au travail NULL.
+*/
+static void *pull_worker_main(void *arg) {
+    t_pull_worker *worker = (t_pull_worker *)arg;
+    t_pull_team *team = worker->team;
+
+    pthread_mutex_lock(&team->gate);
+    pthread_mutex_unlock(&team->gate);
+    while (1) {
+        pthread_barrier_wait(&team->barrier);
+        if (team->job == NULL) break;
+        team->job(team, worker->index);
+        pthread_barrier_wait(&team->barrier);
+    }
+    return NULL;
+}
+
+/*
+   pull_team_init :
+   La barrière ne peut compter que les threads effectivement lancés : elle est
+   initialisée après les pthread_create, pendant que gate retient les threads.
+*/
+int pull_team_init(t_pull_team *team, const t_csr *PT, int num_threads) {
+    memset(team, 0, sizeof(*team));
+    if (num_threads <= 0) {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = (cores > 0) ? (int)cores : 1;
+    }
+    team->PT = PT;
+    team->threads = (pthread_t *)malloc(num_threads * sizeof(pthread_t));
+    team->workers = (t_pull_worker *)malloc(num_threads * sizeof(t_pull_worker));
+    team->bounds = (int *)malloc((num_threads + 1) * sizeof(int));
+    team->partial = (double *)malloc(2 * num_threads * sizeof(double));
+    if (team->threads == NULL || team->workers == NULL || team->bounds == NULL || team->partial == NULL) {
+        perror("Allocation failed for pull team");
+        free(team->threads);
+        free(team->workers);
+        free(team->bounds);
+        free(team->partial);
+        memset(team, 0, sizeof(*team));
+        return -1;
+    }
+
+    pthread_mutex_init(&team->gate, NULL);
+    pthread_mutex_lock(&team->gate);
+    int started = 0;
+    for (int t = 1; t < num_threads; t++) {
+        team->workers[t].team = team;
+        team->workers[t].index = t;
+        if (pthread_create(&team->threads[t - 1], NULL, pull_worker_main, &team->workers[t]) != 0) break;
+        started++;
+    }
+    team->num_threads = started + 1;
+    pthread_barrier_init(&team->barrier, NULL, team->num_threads);
+    pthread_mutex_unlock(&team->gate);
+    return 0;
+}
+
+void pull_team_free(t_pull_team *team) {
+    if (team->threads == NULL) return;
+    team->job = NULL;
+    pthread_barrier_wait(&team->barrier);
+    for (int t = 0; t < team->num_threads - 1; t++) pthread_join(team->threads[t], NULL);
+    pthread_barrier_destroy(&team->barrier);
+    pthread_mutex_destroy(&team->gate);
+    free(team->threads);
+    free(team->workers);
+    free(team->bounds);
+    free(team->partial);
+    memset(team, 0, sizeof(*team));
+}
+
+//run_job : exécute job sur tous les threads de l'équipe, l'appelant faisant la part du thread 0.
+static void run_job(t_pull_team *team, void (*job)(t_pull_team *team, int index)) {
+    team->job = job;
+    pthread_barrier_wait(&team->barrier);
+    job(team, 0);
+    pthread_barrier_wait(&team->barrier);
+}
+
+/*
+   balance_rows :
+   Découpe les lignes en num_threads tranches de même coût, une ligne coûtant ses
+   arêtes entrantes plus un : la tranche t commence à la première ligne dont le coût
+   cumulé atteint t / num_threads du total (recherche dichotomique). Sans liste de
+   lignes, le coût cumulé des j premières lignes est directement row_ptr[j] + j.
+   Retourne -1 si la mémoire manque.
+*/
+static int balance_rows(t_pull_team *team, const int *rows, int num_rows) {
+    const t_csr *PT = team->PT;
+    int T = team->num_threads;
+
+    long long *cost = NULL;
+    if (rows != NULL) {
+        cost = (long long *)malloc((num_rows + 1) * sizeof(long long));
+        if (cost == NULL) {
+            perror("Allocation failed for pull chunks");
+            return -1;
+        }
+        cost[0] = 0;
+        for (int r = 0; r < num_rows; r++) {
+            cost[r + 1] = cost[r] + (PT->row_ptr[rows[r] + 1] - PT->row_ptr[rows[r]]) + 1;
+        }
+    }
+    long long total = (rows != NULL) ? cost[num_rows] : (long long)PT->row_ptr[num_rows] + num_rows;
+
+    team->rows = rows;
+    team->num_rows = num_rows;
+    team->bounds[0] = 0;
+    for (int t = 1; t < T; t++) {
+        long long target = total * t / T;
+        int low = team->bounds[t - 1], high = num_rows;
+        while (low < high) {
+            int mid = low + (high - low) / 2;
+            long long before = (rows != NULL) ? cost[mid] : (long long)PT->row_ptr[mid] + mid;
+            if (before < target) low = mid + 1;
+            else high = mid;
+        }
+        team->bounds[t] = low;
+    }
+    team->bounds[T] = num_rows;
+    free(cost);
+    return 0;
+}
+
+//pull_row : somme des x[i] P(i, j) sur les prédécesseurs i de j.
+static inline double pull_row(const t_csr *PT, const double *x, int j) {
+    double sum = 0.0;
+    for (int e = PT->row_ptr[j]; e < PT->row_ptr[j + 1]; e++) sum += x[PT->col_idx[e]] * PT->values[e];
+    return sum;
+}
+
+/*
+   k_step_job :
+   Une barrière par étape : l'étape suivante lit des cases écrites par les autres
+   threads, et n'écrase le vecteur lu qu'une fois que tous ont fini de le lire.
+*/
+static void k_step_job(t_pull_team *team, int index) {
+    const t_csr *PT = team->PT;
+    double *cur = team->x;
+    double *next = team->y;
+    int first = team->bounds[index], last = team->bounds[index + 1];
+
+    for (int step = 0; step < team->steps; step++) {
+        for (int j = first; j < last; j++) next[j] = pull_row(PT, cur, j);
+        pthread_barrier_wait(&team->barrier);
+        double *swap = cur;
+        cur = next;
+        next = swap;
+    }
+}
+
+/*
+   pull_k_step :
+   Même alternance de tampons que k_step_distribution : le résultat final atterrit
+   dans out.
+*/
+int pull_k_step(t_pull_team *team, const double *x0, int k, double *out) {
+    int N = team->PT->num_vertices;
+
+    double *tmp = (double *)malloc((N > 0 ? N : 1) * sizeof(double));
+    if (tmp == NULL) {
+        perror("Allocation failed for k-step buffer");
+        return -1;
+    }
+    if (balance_rows(team, NULL, N) != 0) {
+        free(tmp);
+        return -1;
+    }
+
+    team->x = (k % 2 == 0) ? out : tmp;
+    team->y = (k % 2 == 0) ? tmp : out;
+    memcpy(team->x, x0, N * sizeof(double));
+    team->steps = k;
+    run_job(team, k_step_job);
+
+    free(tmp);
+    profile_count_flops((long long)k * 2LL * team->PT->num_edges);
+    return 0;
+}
+
+/*
+   class_job :
+   Itération de stationary_iterate, tranche par tranche. Deux barrières par
+   itération : après le calcul de next (le total doit être complet avant la
+   normalisation), puis après la mise à jour de pi (l'itération suivante lit les
+   cases des autres tranches). Chaque thread somme les parties dans le même ordre et
+   prend donc la même décision d'arrêt.
+*/
+static void class_job(t_pull_team *team, int index) {
+    const t_csr *PT = team->PT;
+    const int *rows = team->rows;
+    double *pi = team->x;
+    double *next = team->y;
+    int T = team->num_threads;
+    double *totals = team->partial;
+    double *diffs = team->partial + T;
+    int first = team->bounds[index], last = team->bounds[index + 1];
+
+    int iter;
+    for (iter = 1; iter <= team->steps; iter++) {
+        double total = 0.0;
+        for (int r = first; r < last; r++) {
+            int v = rows[r];
+            next[v] = 0.5 * pi[v] + 0.5 * pull_row(PT, pi, v);
+            total += next[v];
+        }
+        totals[index] = total;
+        pthread_barrier_wait(&team->barrier);
+
+        // Les lignes ne somment à 1 qu'à TOLERANCE près : on renormalise pour que la masse ne dérive pas
+        total = 0.0;
+        for (int t = 0; t < T; t++) total += totals[t];
+        if (total <= 0.0) total = 1.0;
+        double diff = 0.0;
+        for (int r = first; r < last; r++) {
+            int v = rows[r];
+            double value = next[v] / total;
+            diff += fabs(value - pi[v]);
+            pi[v] = value;
+        }
+        diffs[index] = diff;
+        pthread_barrier_wait(&team->barrier);
+
+        diff = 0.0;
+        for (int t = 0; t < T; t++) diff += diffs[t];
+        if (diff < team->epsilon) break;
+    }
+    if (index == 0) {
+        team->iterations = (iter > team->steps) ? team->steps : iter;
+        team->converged = (iter <= team->steps);
+    }
+}
+
+/*
+   pull_class_stationary :
+   Départ uniforme sur les membres, puis class_job. Les prédécesseurs d'un membre
+   sont des membres ou des sommets transitoires (la classe est fermée, les autres
+   classes persistantes aussi) : avec pi nul sur les transitoires, tirer toutes les
+   arêtes entrantes revient à ne suivre que les arêtes internes.
+*/
+int pull_class_stationary(t_pull_team *team, t_partition partition, int class_index, double *pi, double epsilon,
+                          int max_iter) {
+    t_class c = partition.classes[class_index];
+    int k = c.num_members;
+    int N = team->PT->num_vertices;
+
+    if (!c.is_persistent) return -1;
+    team->converged = 1;
+    if (k == 1) {
+        pi[c.members_ids[0] - 1] = 1.0; // État absorbant
+        return 0;
+    }
+
+    int *rows = (int *)malloc(k * sizeof(int));
+    double *next = (double *)calloc(N, sizeof(double));
+    if (rows == NULL || next == NULL) {
+        perror("Allocation failed for class stationary buffer");
+        free(rows);
+        free(next);
+        return -1;
+    }
+    for (int m = 0; m < k; m++) {
+        rows[m] = c.members_ids[m] - 1;
+        pi[rows[m]] = 1.0 / k;
+    }
+    if (balance_rows(team, rows, k) != 0) {
+        free(rows);
+        free(next);
+        return -1;
+    }
+
+    long long in_edges = 0;
+    for (int m = 0; m < k; m++) in_edges += team->PT->row_ptr[rows[m] + 1] - team->PT->row_ptr[rows[m]];
+    team->x = pi;
+    team->y = next;
+    team->steps = max_iter;
+    team->epsilon = epsilon;
+    run_job(team, class_job);
+
+    int iter = team->iterations;
+    free(rows);
+    free(next);
+    profile_count_iterations(iter);
+    profile_count_flops((long long)iter * (2LL * in_edges + 4LL * k));
+    return iter;
+}
@@ -0,0 +1,70 @@
+#ifndef PULL_H
+#define PULL_H
+
+#include <pthread.h>
+#include "sparse.h"
+#include "tarjan.h"
+
+/*
+   Noyaux parallèles par tirage sur l'index des arêtes entrantes (csr_transpose).
+   pi_new[j] = somme des pi[i] P(i, j) se calcule ligne par ligne de la transposée :
+   chaque case du résultat est écrite par un seul thread, sans atomiques ni copie
+   privée du vecteur par thread. Les lignes sont découpées en tranches de même coût
+   (arêtes entrantes + 1 par ligne) et non de même nombre de lignes : avec des degrés
+   entrants en loi de puissance, quelques sommets concentrent une grande part des
+   arêtes. Les threads de l'équipe restent en vie d'un appel à l'autre et se
+   synchronisent par barrière à chaque itération. Les sommes partielles sont
+   combinées dans l'ordre des threads : le résultat ne dépend que de leur nombre.
+*/
+
+//Arêtes internes au-dessous desquelles une classe est itérée par un seul thread (stationary_iterate) : la barrière
+//coûterait plus que l'itération.
+#define PULL_MIN_EDGES 65536
+
+struct s_pull_team;
+
+//Thread d'une équipe (indice 1 à num_threads - 1 ; le thread appelant a l'indice 0).
+typedef struct s_pull_worker {
+    struct s_pull_team *team;
+    int index;
+} t_pull_worker;
+
+//Équipe de threads des noyaux par tirage sur une transposée PT.
+typedef struct s_pull_team {
+    const t_csr *PT;            // Transposée de P, lue seulement
+    int num_threads;            // Threads de l'équipe, appelant compris
+    pthread_t *threads;         // num_threads - 1 threads lancés par pull_team_init
+    t_pull_worker *workers;
+    pthread_mutex_t gate;       // Tenu pendant le lancement : les threads attendent que la barrière soit prête
+    pthread_barrier_t barrier;  // Compte les threads lancés, appelant compris
+    void (*job)(struct s_pull_team *team, int index); // Travail en cours, NULL pour arrêter les threads
+    const int *rows;            // Lignes traitées (0-based), NULL = toutes
+    int num_rows;
+    int *bounds;                // num_threads + 1 cases : tranche [bounds[t], bounds[t + 1]) de rows du thread t
+    double *partial;            // 2 x num_threads cases : totaux et écarts partiels
+    double *x;                  // Vecteurs du travail en cours
+    double *y;
+    int steps;                  // Étapes (pull_k_step) ou itérations au plus (pull_class_stationary)
+    double epsilon;
+    int iterations;             // Itérations effectuées (pull_class_stationary)
+    int converged;              // 1 si l'écart est passé sous epsilon avant steps itérations (pull_class_stationary)
+} t_pull_team;
+
+//Lance num_threads - 1 threads (0 = nombre de coeurs) sur la transposée PT, gardée par l'appelant jusqu'à pull_team_free.
+//Si un thread ne démarre pas, l'équipe se contente de ceux qui ont démarré. Retourne 0, ou -1 si la mémoire manque.
+int pull_team_init(t_pull_team *team, const t_csr *PT, int num_threads);
+
+//Arrête les threads et libère l'équipe.
+void pull_team_free(t_pull_team *team);
+
+//Distribution après k étapes en partant de x0 : out = x0 P^k (N cases). Retourne 0, ou -1 si la mémoire manque.
+int pull_k_step(t_pull_team *team, const double *x0, int k, double *out);
+
+//Distribution stationnaire d'une classe persistante, comme class_stationary_distribution (même itération de (I + P) / 2,
+//même critère d'arrêt). pi doit valoir 0 sur les sommets transitoires : ce sont les seuls prédécesseurs hors de la classe.
+//Retourne le nombre d'itérations (team->converged dit si epsilon est atteint), -1 si la classe est transitoire ou si la
+//mémoire manque.
+int pull_class_stationary(t_pull_team *team, t_partition partition, int class_index, double *pi, double epsilon,
+                          int max_iter);
+
+#endif // PULL_H
@@ -0,0 +1,384 @@
+#include "reach.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//Intervalle de rangs [start, end] rangé dans un mot : trier les mots trie les intervalles par début.
+#define REACH_INTERVAL(start, end) (((unsigned long long)(start) << 32) | (unsigned int)(end))
+#define REACH_START(word) ((int)((word) >> 32))
+#define REACH_END(word) ((int)((word) & 0xFFFFFFFFULL))
+
+//Tampons de la construction, agrandis au besoin.
+typedef struct s_reach_builder {
+    unsigned long long *intervals;
+    size_t intervals_capacity;
+    unsigned long long *bits;
+    size_t bits_capacity;
+    size_t pool_capacity;
+    int *children;          // Rangs des successeurs de la classe en cours
+} t_reach_builder;
+
+//Agrandit buffer (capacité doublée) pour qu'il contienne needed mots. Retourne 0, ou -1 si la mémoire manque.
+static int reserve_words(unsigned long long **buffer, size_t *capacity, size_t needed) {
+    if (needed <= *capacity) return 0;
+    size_t new_capacity = (*capacity > 0) ? *capacity : 64;
+    while (new_capacity < needed) new_capacity *= 2;
+    unsigned long long *tmp = (unsigned long long *)realloc(*buffer, new_capacity * sizeof(unsigned long long));
+    if (tmp == NULL) {
+        perror("Allocation failed for reachability index");
+        return -1;
+    }
+    *buffer = tmp;
+    *capacity = new_capacity;
+    return 0;
+}
+
+static int compare_ints(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+//Met à 1 les bits from..to (compris) du tableau.
+static void set_bit_range(unsigned long long *bits, int from, int to) {
+    int first_word = from / 64, last_word = to / 64;
+    unsigned long long first_mask = ~0ULL << (from % 64);
+    unsigned long long last_mask = ~0ULL >> (63 - to % 64);
+    if (first_word == last_word) {
+        bits[first_word] |= first_mask & last_mask;
+        return;
+    }
+    bits[first_word] |= first_mask;
+    for (int w = first_word + 1; w < last_word; w++) bits[w] = ~0ULL;
+    bits[last_word] |= last_mask;
+}
+
+//Nombre de suites de bits à 1 (un bit à 1 dont le précédent est à 0 commence une suite).
+static long long count_runs(const unsigned long long *bits, int words) {
+    long long runs = 0;
+    unsigned long long carry = 0;
+    for (int w = 0; w < words; w++) {
+        unsigned long long starts = bits[w] & ~((bits[w] << 1) | carry);
+        carry = bits[w] >> 63;
+        for (; starts != 0; starts &= starts - 1) runs++;
+    }
+    return runs;
+}
+
+//Position du bit à 1 le plus bas de x (x non nul), par multiplication de De Bruijn.
+static int lowest_bit(unsigned long long x) {
+    static const int positions[64] = {
+        0, 1, 48, 2, 57, 49, 28, 3, 61, 58, 50, 42, 38, 29, 17, 4, 62, 55, 59, 36, 53, 51, 43, 22, 45, 39, 33, 30, 24, 18,
+        12, 5, 63, 47, 56, 27, 60, 41, 37, 16, 54, 35, 52, 21, 44, 32, 23, 11, 46, 26, 40, 15, 34, 20, 31, 10, 25, 14, 19,
+        9, 13, 8, 7, 6
+    };
+    return positions[((x & (~x + 1)) * 0x03F79D71B4CB0A89ULL) >> 58];
+}
+
+/*
+   bits_to_intervals :
+   Suites de bits à 1 du tableau, en intervalles de rangs (le bit 0 a le rang base).
+   Seuls les bords des suites sont visités : les bits qui diffèrent du précédent.
+*/
+static int bits_to_intervals(const unsigned long long *bits, int words, int base, unsigned long long *out) {
+    int count = 0, start = 0;
+    unsigned long long carry = 0;
+    for (int w = 0; w < words; w++) {
+        unsigned long long x = bits[w];
+        unsigned long long edges = x ^ ((x << 1) | carry);
+        carry = x >> 63;
+        for (; edges != 0; edges &= edges - 1) {
+            int b = lowest_bit(edges);
+            int rank = base + w * 64 + b;
+            if ((x >> b) & 1) start = rank;
+            else out[count++] = REACH_INTERVAL(start, rank - 1);
+        }
+    }
+    if (carry) out[count++] = REACH_INTERVAL(start, base + words * 64 - 1);
+    return count;
+}
+
+//Fusionne deux listes triées d'intervalles dans out, en réunissant ceux qui se chevauchent ou se touchent. Retourne la
+//longueur de out.
+static int merge_intervals(const unsigned long long *a, int na, const unsigned long long *b, int nb,
+                           unsigned long long *out) {
+    int i = 0, j = 0, k = 0;
+    while (i < na || j < nb) {
+        unsigned long long next = (j >= nb || (i < na && a[i] < b[j])) ? a[i++] : b[j++];
+        if (k > 0 && REACH_START(next) <= REACH_END(out[k - 1]) + 1) {
+            if (REACH_END(next) > REACH_END(out[k - 1])) out[k - 1] = REACH_INTERVAL(REACH_START(out[k - 1]), REACH_END(next));
+        } else {
+            out[k++] = next;
+        }
+    }
+    return k;
+}
+
+//Range count mots dans le pool comme ensemble du rang p.
+static int store_label(t_reach_index *index, t_reach_builder *builder, int p, const unsigned long long *words, int count,
+                       int first) {
+    if (reserve_words(&index->pool, &builder->pool_capacity, (size_t)index->pool_size + count) != 0) return -1;
+    memcpy(index->pool + index->pool_size, words, (size_t)count * sizeof(unsigned long long));
+    index->labels[p] = (t_reach_label){index->pool_size, count, first};
+    index->pool_size += count;
+    if (first >= 0) index->num_dense++;
+    else index->num_intervals += count;
+    return 0;
+}
+
+//1 si rank appartient à la liste triée d'intervalles (dernier intervalle commençant au plus à rank).
+static int intervals_contain(const unsigned long long *words, int count, int rank) {
+    int low = 0, high = count - 1, found = -1;
+    while (low <= high) {
+        int mid = (low + high) / 2;
+        if (REACH_START(words[mid]) <= rank) {
+            found = mid;
+            low = mid + 1;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return found >= 0 && REACH_END(words[found]) >= rank;
+}
+
+/*
+   build_label :
+   Ensemble accessible depuis la classe c, de rang p : son intervalle de l'arbre
+   [low(p), p] et les ensembles de ses successeurs, déjà terminés.
+   - Les successeurs sont pris par rang décroissant : un successeur déjà atteint par
+     un précédent a son ensemble déjà inclus et est sauté (réduction transitive à la
+     volée ; l'intervalle de l'arbre n'est ajouté qu'à la fin, car ses classes n'ont
+     pas encore apporté leurs ensembles).
+   - Si aucun successeur n'a de tableau de bits et que leurs intervalles tiennent
+     dans moins de mots qu'un tableau de bits couvrant les rangs atteints, leurs
+     listes, déjà triées, sont fusionnées une à une (deux intervalles qui se touchent
+     n'en font qu'un).
+   - Sinon, les rangs sont marqués dans un tableau de bits, puis gardés sous la forme
+     la plus petite : une suite de bits à 1 par intervalle, ou le tableau lui-même.
+*/
+static int build_label(t_reach_index *index, t_reach_builder *builder, const int *out_ptr, const int *out, int c,
+                       int p) {
+    int lo = index->low[p];
+    long long total = 1;
+    int has_bits = 0, num_children = 0;
+    for (int e = out_ptr[c]; e < out_ptr[c + 1]; e++) {
+        int rank = index->post[out[e]];
+        const t_reach_label *label = &index->labels[rank];
+        int first = (label->first >= 0) ? label->first : REACH_START(index->pool[label->offset]);
+        if (first < lo) lo = first;
+        if (label->first >= 0) has_bits = 1;
+        else total += label->count;
+        builder->children[num_children++] = rank;
+    }
+    if (num_children > 1) qsort(builder->children, num_children, sizeof(int), compare_ints);
+    int words = (p - lo) / 64 + 1;
+
+    if (!has_bits && total <= words) {
+        // Deux moitiés : la liste fusionnée passe de l'une à l'autre
+        if (reserve_words(&builder->intervals, &builder->intervals_capacity, 2 * total) != 0) return -1;
+        unsigned long long *list = builder->intervals, *next = builder->intervals + total;
+        int k = 0;
+        for (int i = num_children - 1; i >= 0; i--) {
+            if (intervals_contain(list, k, builder->children[i])) continue;
+            const t_reach_label *label = &index->labels[builder->children[i]];
+            k = merge_intervals(list, k, index->pool + label->offset, label->count, next);
+            unsigned long long *swap = list;
+            list = next;
+            next = swap;
+        }
+        unsigned long long own = REACH_INTERVAL(index->low[p], p);
+        k = merge_intervals(list, k, &own, 1, next);
+        return store_label(index, builder, p, next, k, -1);
+    }
+
+    // Un mot de garde : les tableaux des successeurs décalés débordent d'au plus un mot
+    if (reserve_words(&builder->bits, &builder->bits_capacity, (size_t)words + 1) != 0) return -1;
+    unsigned long long *bits = builder->bits;
+    memset(bits, 0, ((size_t)words + 1) * sizeof(unsigned long long));
+    for (int i = num_children - 1; i >= 0; i--) {
+        int bit = builder->children[i] - lo;
+        if ((bits[bit / 64] >> (bit % 64)) & 1) continue;
+        const t_reach_label *label = &index->labels[builder->children[i]];
+        const unsigned long long *src = index->pool + label->offset;
+        if (label->first < 0) {
+            for (int j = 0; j < label->count; j++) set_bit_range(bits, REACH_START(src[j]) - lo, REACH_END(src[j]) - lo);
+            continue;
+        }
+        int word = (label->first - lo) / 64, shift = (label->first - lo) % 64;
+        for (int j = 0; j < label->count; j++) {
+            bits[word + j] |= src[j] << shift;
+            if (shift > 0) bits[word + j + 1] |= src[j] >> (64 - shift);
+        }
+    }
+    set_bit_range(bits, index->low[p] - lo, p - lo);
+
+    long long runs = count_runs(bits, words);
+    if (runs > words) return store_label(index, builder, p, bits, words, lo);
+    if (reserve_words(&builder->intervals, &builder->intervals_capacity, runs) != 0) return -1;
+    int k = bits_to_intervals(bits, words, lo, builder->intervals);
+    return store_label(index, builder, p, builder->intervals, k, -1);
+}
+
+/*
+   reach_build :
+   Les liens sont d'abord rangés par classe de départ (tri par dénombrement), puis
+   le parcours en profondeur, itératif, part des classes de plus grand identifiant
+   (Tarjan numérote les classes sources en dernier). Chaque classe reçoit son rang
+   et son ensemble quand elle se termine : ses successeurs ont tous déjà le leur.
+*/
+int reach_build(t_reach_index *index, t_partition partition, const t_link_array *links) {
+    memset(index, 0, sizeof(*index));
+    int C = partition.num_classes;
+    int L = (links != NULL) ? links->size : 0;
+    if (C <= 0) return -1;
+
+    index->num_classes = C;
+    index->post = (int *)malloc(C * sizeof(int));
+    index->low = (int *)malloc(C * sizeof(int));
+    index->order = (int *)malloc(C * sizeof(int));
+    index->labels = (t_reach_label *)malloc(C * sizeof(t_reach_label));
+    index->persistent = (int *)malloc(C * sizeof(int));
+    int *out_ptr = (int *)calloc(C + 1, sizeof(int));
+    int *out = (int *)malloc((L > 0 ? L : 1) * sizeof(int));
+    int *entry = (int *)malloc(C * sizeof(int));    // Rang suivant à l'entrée dans la classe, -1 si pas encore visitée
+    int *stack = (int *)malloc(C * sizeof(int));
+    int *next_edge = (int *)malloc(C * sizeof(int)); // Par classe : prochain lien à suivre
+    t_reach_builder builder = {NULL, 0, NULL, 0, 0, (int *)malloc(C * sizeof(int))};
+    if (index->post == NULL || index->low == NULL || index->order == NULL || index->labels == NULL
+        || index->persistent == NULL || out_ptr == NULL || out == NULL || entry == NULL || stack == NULL
+        || next_edge == NULL || builder.children == NULL) {
+        perror("Allocation failed for reachability index");
+        free(builder.children);
+        free(out_ptr);
+        free(out);
+        free(entry);
+        free(stack);
+        free(next_edge);
+        reach_free(index);
+        return -1;
+    }
+
+    for (int l = 0; l < L; l++) out_ptr[links->links[l].source_class_id]++;
+    for (int c = 0; c < C; c++) out_ptr[c + 1] += out_ptr[c];
+    for (int c = 0; c < C; c++) next_edge[c] = out_ptr[c];
+    for (int l = 0; l < L; l++) out[next_edge[links->links[l].source_class_id - 1]++] = links->links[l].dest_class_id - 1;
+    for (int c = 0; c < C; c++) {
+        entry[c] = -1;
+        next_edge[c] = out_ptr[c];
+    }
+
+    int failed = 0, rank = 0;
+    for (int root = C - 1; root >= 0 && !failed; root--) {
+        if (entry[root] >= 0) continue;
+        int top = 0;
+        stack[top++] = root;
+        entry[root] = rank;
+        while (top > 0 && !failed) {
+            int c = stack[top - 1];
+            if (next_edge[c] < out_ptr[c + 1]) {
+                int w = out[next_edge[c]++];
+                if (entry[w] < 0) {
+                    entry[w] = rank;
+                    stack[top++] = w;
+                }
+                continue;
+            }
+            top--;
+            index->post[c] = rank;
+            index->low[rank] = entry[c];
+            index->order[rank] = c;
+            failed = build_label(index, &builder, out_ptr, out, c, rank) != 0;
+            rank++;
+        }
+    }
+
+    for (int p = 0; p < C && !failed; p++) {
+        if (partition.classes[index->order[p]].is_persistent) index->persistent[index->num_persistent++] = p;
+    }
+
+    free(out_ptr);
+    free(out);
+    free(entry);
+    free(stack);
+    free(next_edge);
+    free(builder.intervals);
+    free(builder.bits);
+    free(builder.children);
+    if (failed) {
+        reach_free(index);
+        return -1;
+    }
+    return 0;
+}
+
+void reach_free(t_reach_index *index) {
+    free(index->post);
+    free(index->low);
+    free(index->order);
+    free(index->labels);
+    free(index->pool);
+    free(index->persistent);
+    memset(index, 0, sizeof(*index));
+}
+
+//1 si le rang rank appartient à l'ensemble label.
+static int label_contains(const t_reach_index *index, const t_reach_label *label, int rank) {
+    const unsigned long long *words = index->pool + label->offset;
+    if (label->first < 0) return intervals_contain(words, label->count, rank);
+    long long bit = (long long)rank - label->first;
+    return bit >= 0 && bit < 64LL * label->count && ((words[bit / 64] >> (bit % 64)) & 1);
+}
+
+int reach_classes(const t_reach_index *index, int from_class, int to_class) {
+    if (from_class == to_class) return 1;
+    int from = index->post[from_class - 1];
+    int to = index->post[to_class - 1];
+    if (to > from) return 0;
+    if (to >= index->low[from]) return 1;
+    return label_contains(index, &index->labels[from], to);
+}
+
+//Premier indice de persistent dont le rang est au moins rank.
+static int first_persistent(const t_reach_index *index, int rank) {
+    int low = 0, high = index->num_persistent;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (index->persistent[mid] < rank) low = mid + 1;
+        else high = mid;
+    }
+    return low;
+}
+
+/*
+   reach_persistent :
+   Les rangs des classes persistantes sont triés : chaque intervalle de l'ensemble en
+   délimite une tranche par dichotomie ; un tableau de bits est lu aux seuls rangs
+   persistants qu'il couvre.
+*/
+int reach_persistent(const t_reach_index *index, int class_id, int *out) {
+    const t_reach_label *label = &index->labels[index->post[class_id - 1]];
+    const unsigned long long *words = index->pool + label->offset;
+    int count = 0;
+
+    if (label->first >= 0) {
+        for (int i = first_persistent(index, label->first); i < index->num_persistent; i++) {
+            long long bit = (long long)index->persistent[i] - label->first;
+            if (bit >= 64LL * label->count) break;
+            if ((words[bit / 64] >> (bit % 64)) & 1) out[count++] = index->order[index->persistent[i]] + 1;
+        }
+    } else {
+        for (int k = 0; k < label->count; k++) {
+            for (int i = first_persistent(index, REACH_START(words[k]));
+                 i < index->num_persistent && index->persistent[i] <= REACH_END(words[k]); i++) {
+                out[count++] = index->order[index->persistent[i]] + 1;
+            }
+        }
+    }
+    if (count > 1) qsort(out, count, sizeof(int), compare_ints);
+    return count;
+}
+
+long long reach_index_bytes(const t_reach_index *index) {
+    return index->pool_size * (long long)sizeof(unsigned long long)
+         + (long long)index->num_classes * (3 * sizeof(int) + sizeof(t_reach_label))
+         + (long long)index->num_persistent * sizeof(int);
+}
@@ -0,0 +1,61 @@
+#ifndef REACH_H
+#define REACH_H
+
+#include "tarjan.h"
+#include "hasse.h"
+
+/*
+   Index d'accessibilité entre classes : "la classe a mène-t-elle à la classe b ?"
+   sans parcours du graphe à chaque question. Le graphe des classes (liens de
+   compute_hasse_diagram_links) est sans cycle.
+   - Un parcours en profondeur numérote les classes dans l'ordre où elles se
+     terminent (rang postfixe) : une classe accessible depuis a a un rang inférieur
+     à celui de a, et les descendantes de a dans l'arbre du parcours occupent les
+     rangs [low(a), rang(a)] (recouvrement par arbre).
+   - L'ensemble accessible depuis a est gardé sous forme d'intervalles de rangs
+     fusionnés : son propre intervalle et ceux de ses successeurs. Quand ils sont
+     trop morcelés (régions denses du graphe), un tableau de bits couvrant les rangs
+     du premier au dernier atteint prend moins de place et le remplace.
+   - Requête : comparaison des rangs, puis test de l'intervalle de l'arbre, puis
+     recherche dichotomique dans les intervalles ou lecture d'un bit.
+*/
+
+//Ensemble accessible depuis une classe : mots de pool à partir de offset.
+typedef struct s_reach_label {
+    long long offset;
+    int count;      // Nombre de mots : intervalles, ou mots du tableau de bits
+    int first;      // -1 : intervalles [début, fin] (début dans les 32 bits hauts) ; sinon rang du bit 0 du tableau de bits
+} t_reach_label;
+
+//Index d'accessibilité du graphe des classes.
+typedef struct s_reach_index {
+    int num_classes;
+    int *post;               // Par classe (0-based) : rang postfixe
+    int *low;                // Par rang : plus petit rang de son sous-arbre du parcours
+    int *order;              // Par rang : classe (0-based)
+    t_reach_label *labels;   // Par rang : ensemble accessible, classe comprise
+    unsigned long long *pool;
+    long long pool_size;     // Mots utilisés dans pool
+    int num_persistent;
+    int *persistent;         // Rangs des classes persistantes, croissants
+    int num_dense;           // Classes dont l'ensemble est un tableau de bits
+    long long num_intervals; // Intervalles gardés par les autres classes
+} t_reach_index;
+
+//Construit l'index depuis la partition et les liens entre classes. Retourne 0, ou -1 si la mémoire manque.
+int reach_build(t_reach_index *index, t_partition partition, const t_link_array *links);
+
+//Libère l'index (qui redevient vide).
+void reach_free(t_reach_index *index);
+
+//1 si la classe to_class (1-based) est accessible depuis from_class (toute classe l'est depuis elle-même), 0 sinon.
+int reach_classes(const t_reach_index *index, int from_class, int to_class);
+
+//Classes persistantes (identifiants croissants) accessibles depuis class_id : out (num_persistent cases) les reçoit.
+//Retourne leur nombre.
+int reach_persistent(const t_reach_index *index, int class_id, int *out);
+
+//Mémoire de l'index en octets.
+long long reach_index_bytes(const t_reach_index *index);
+
+#endif // REACH_H
@@ -0,0 +1,324 @@
+#include "reorder.h"
+#include <string.h>
+
+//Nombre maximal de parcours pour chercher un sommet pseudo-périphérique (George et Liu).
+#define RCM_MAX_SWEEPS 8
+
+const char *reorder_kind_name(t_reorder_kind kind) {
+    switch (kind) {
+        case REORDER_NONE:  return "none";
+        case REORDER_BFS:   return "bfs";
+        case REORDER_RCM:   return "rcm";
+        case REORDER_CLASS: return "class";
+    }
+    return "?";
+}
+
+int reorder_parse_kind(const char *name) {
+    static const t_reorder_kind choices[] = { REORDER_NONE, REORDER_BFS, REORDER_RCM, REORDER_CLASS };
+    for (size_t i = 0; i < sizeof(choices) / sizeof(choices[0]); i++) {
+        if (strcmp(name, reorder_kind_name(choices[i])) == 0) return choices[i];
+    }
+    return -1;
+}
+
+/*
+   reorder_bfs :
+   Parcours en largeur sur les arêtes sortantes, le tableau résultat servant de file :
+   les successeurs d'un sommet reçoivent des numéros proches du sien.
+*/
+int *reorder_bfs(t_graph graph) {
+    int N = graph.num_vertices;
+    int *order = (int *)malloc((N > 0 ? N : 1) * sizeof(int));
+    char *visited = (char *)calloc(N > 0 ? N : 1, sizeof(char));
+    if (order == NULL || visited == NULL) {
+        perror("Allocation failed for BFS ordering");
+        free(order);
+        free(visited);
+        return NULL;
+    }
+
+    int count = 0;
+    for (int root = 0; root < N; root++) {
+        if (visited[root]) continue;
+        visited[root] = 1;
+        order[count++] = root;
+        for (int head = count - 1; head < count; head++) {
+            for (t_edge *edge = graph.adj_lists[order[head]].head; edge != NULL; edge = edge->next) {
+                int w = edge->destination - 1;
+                if (!visited[w]) {
+                    visited[w] = 1;
+                    order[count++] = w;
+                }
+            }
+        }
+    }
+    free(visited);
+    return order;
+}
+
+/*
+   build_sorted_neighbors :
+   Graphe symétrisé (u voisin de v s'il existe u → v ou v → u, boucles ignorées) en CSR,
+   chaque liste de voisins triée par degré croissant : les sommets sont parcourus par
+   degré croissant (tri par comptage) et chacun est ajouté à la liste de ses voisins.
+   by_degree reçoit aussi les sommets par degré croissant. Retourne 0, -1 si la mémoire manque.
+*/
+static int build_sorted_neighbors(t_graph graph, int **ptr_out, int **adj_out, int *by_degree) {
+    int N = graph.num_vertices;
+    int *ptr = (int *)calloc(N + 1, sizeof(int));
+    int *fill = (int *)malloc((N + 1) * sizeof(int));
+    if (ptr == NULL || fill == NULL) {
+        free(ptr);
+        free(fill);
+        return -1;
+    }
+
+    for (int v = 0; v < N; v++) {
+        for (t_edge *edge = graph.adj_lists[v].head; edge != NULL; edge = edge->next) {
+            int w = edge->destination - 1;
+            if (w == v) continue;
+            ptr[v + 1]++;
+            ptr[w + 1]++;
+        }
+    }
+    int max_degree = 0;
+    for (int v = 0; v < N; v++) {
+        if (ptr[v + 1] > max_degree) max_degree = ptr[v + 1];
+        ptr[v + 1] += ptr[v];
+    }
+
+    size_t total = (size_t)ptr[N];
+    int *adj = (int *)malloc((total > 0 ? total : 1) * sizeof(int));
+    int *sorted = (int *)malloc((total > 0 ? total : 1) * sizeof(int));
+    int *bucket = (int *)calloc(max_degree + 2, sizeof(int));
+    if (adj == NULL || sorted == NULL || bucket == NULL) {
+        free(ptr);
+        free(fill);
+        free(adj);
+        free(sorted);
+        free(bucket);
+        return -1;
+    }
+
+    // 1. Listes de voisins non triées
+    memcpy(fill, ptr, (N + 1) * sizeof(int));
+    for (int v = 0; v < N; v++) {
+        for (t_edge *edge = graph.adj_lists[v].head; edge != NULL; edge = edge->next) {
+            int w = edge->destination - 1;
+            if (w == v) continue;
+            adj[fill[v]++] = w;
+            adj[fill[w]++] = v;
+        }
+    }
+
+    // 2. Sommets par degré croissant
+    for (int v = 0; v < N; v++) bucket[ptr[v + 1] - ptr[v] + 1]++;
+    for (int d = 0; d <= max_degree; d++) bucket[d + 1] += bucket[d];
+    for (int v = 0; v < N; v++) by_degree[bucket[ptr[v + 1] - ptr[v]]++] = v;
+
+    // 3. Listes triées : w est ajouté chez chacun de ses voisins, w par degré croissant
+    memcpy(fill, ptr, (N + 1) * sizeof(int));
+    for (int k = 0; k < N; k++) {
+        int w = by_degree[k];
+        for (int e = ptr[w]; e < ptr[w + 1]; e++) sorted[fill[adj[e]]++] = w;
+    }
+
+    free(adj);
+    free(fill);
+    free(bucket);
+    *ptr_out = ptr;
+    *adj_out = sorted;
+    return 0;
+}
+
+/*
+   farthest_level :
+   Parcours en largeur depuis root (mark[v] == stamp : déjà vu dans ce parcours).
+   Retourne l'excentricité de root et place dans *candidate le sommet de plus petit
+   degré du dernier niveau.
+*/
+static int farthest_level(const int *ptr, const int *adj, int root, int *queue, int *level,
+                          int *mark, int stamp, int *candidate) {
+    int count = 0;
+    mark[root] = stamp;
+    level[root] = 0;
+    queue[count++] = root;
+    for (int head = 0; head < count; head++) {
+        int u = queue[head];
+        for (int e = ptr[u]; e < ptr[u + 1]; e++) {
+            int w = adj[e];
+            if (mark[w] != stamp) {
+                mark[w] = stamp;
+                level[w] = level[u] + 1;
+                queue[count++] = w;
+            }
+        }
+    }
+
+    int eccentricity = level[queue[count - 1]];
+    *candidate = queue[count - 1];
+    for (int k = count - 1; k >= 0 && level[queue[k]] == eccentricity; k--) {
+        int v = queue[k];
+        if (ptr[v + 1] - ptr[v] < ptr[*candidate + 1] - ptr[*candidate]) *candidate = v;
+    }
+    return eccentricity;
+}
+
+/*
+   reorder_rcm :
+   Pour chaque composante du graphe symétrisé, part de son sommet de plus petit degré,
+   cherche un sommet pseudo-périphérique (dernier niveau d'un parcours en largeur, tant
+   que l'excentricité augmente), puis numérote par Cuthill-McKee : parcours en largeur,
+   voisins par degré croissant. L'ordre obtenu est enfin inversé.
+*/
+int *reorder_rcm(t_graph graph) {
+    int N = graph.num_vertices;
+    int size = (N > 0) ? N : 1;
+    int *order = (int *)malloc(size * sizeof(int));
+    int *by_degree = (int *)malloc(size * sizeof(int));
+    int *queue = (int *)malloc(size * sizeof(int));
+    int *level = (int *)malloc(size * sizeof(int));
+    int *mark = (int *)calloc(size, sizeof(int));
+    int *ptr = NULL, *adj = NULL;
+    if (order == NULL || by_degree == NULL || queue == NULL || level == NULL || mark == NULL
+        || build_sorted_neighbors(graph, &ptr, &adj, by_degree) != 0) {
+        perror("Allocation failed for RCM ordering");
+        free(order);
+        free(by_degree);
+        free(queue);
+        free(level);
+        free(mark);
+        return NULL;
+    }
+
+    // mark[v] : numéro du dernier parcours qui a vu v ; -1 une fois v numéroté
+    int count = 0, stamp = 0;
+    for (int k = 0; k < N; k++) {
+        int root = by_degree[k];
+        if (mark[root] < 0) continue;
+
+        int candidate;
+        int eccentricity = farthest_level(ptr, adj, root, queue, level, mark, ++stamp, &candidate);
+        for (int sweep = 0; sweep < RCM_MAX_SWEEPS && candidate != root; sweep++) {
+            int next;
+            int next_eccentricity = farthest_level(ptr, adj, candidate, queue, level, mark, ++stamp, &next);
+            if (next_eccentricity <= eccentricity) break;
+            root = candidate;
+            eccentricity = next_eccentricity;
+            candidate = next;
+        }
+
+        int first = count;
+        mark[root] = -1;
+        order[count++] = root;
+        for (int head = first; head < count; head++) {
+            int u = order[head];
+            for (int e = ptr[u]; e < ptr[u + 1]; e++) {
+                int w = adj[e];
+                if (mark[w] >= 0) {
+                    mark[w] = -1;
+                    order[count++] = w;
+                }
+            }
+        }
+    }
+
+    for (int i = 0, j = N - 1; i < j; i++, j--) {
+        int t = order[i];
+        order[i] = order[j];
+        order[j] = t;
+    }
+
+    free(by_degree);
+    free(queue);
+    free(level);
+    free(mark);
+    free(ptr);
+    free(adj);
+    return order;
+}
+
+/*
+   reorder_by_class :
+   Mêmes positions que la matrice par blocs : la matrice renumérotée est directement
+   triangulaire supérieure par blocs, et chaque classe occupe un intervalle de sommets.
+*/
+int *reorder_by_class(t_partition partition, int num_vertices) {
+    int *order = (int *)malloc((num_vertices > 0 ? num_vertices : 1) * sizeof(int));
+    if (order == NULL) {
+        perror("Allocation failed for class ordering");
+        return NULL;
+    }
+
+    int count = 0;
+    for (int i = partition.num_classes - 1; i >= 0; i--) {
+        t_class c = partition.classes[i];
+        for (int m = 0; m < c.num_members; m++) order[count++] = c.members_ids[m] - 1;
+    }
+    return order;
+}
+
+int *compute_reordering(t_graph graph, t_reorder_kind kind) {
+    switch (kind) {
+        case REORDER_BFS:
+            return reorder_bfs(graph);
+        case REORDER_RCM:
+            return reorder_rcm(graph);
+        case REORDER_CLASS: {
+            t_partition partition = find_cfcs_tarjan(graph);
+            if (partition.v_data == NULL) return NULL;
+            int *order = reorder_by_class(partition, graph.num_vertices);
+            free_partition(partition);
+            return order;
+        }
+        default:
+            return NULL;
+    }
+}
+
+/*
+   permute_graph :
+   Chaque liste est recopiée dans son ordre (ajout en fin de liste), les arêtes étant
+   allouées position par position : les listes du nouveau graphe sont aussi rangées
+   dans l'ordre des sommets en mémoire.
+*/
+t_graph permute_graph(t_graph graph, const int *order) {
+    int N = graph.num_vertices;
+    t_graph permuted = create_empty_graph(N);
+    int *position = (int *)malloc((N > 0 ? N : 1) * sizeof(int));
+    if (permuted.adj_lists == NULL || position == NULL) {
+        perror("Allocation failed for permuted graph");
+        free_graph(permuted);
+        free(position);
+        return (t_graph){NULL, 0};
+    }
+    for (int p = 0; p < N; p++) position[order[p]] = p;
+
+    for (int p = 0; p < N; p++) {
+        t_edge **tail = &permuted.adj_lists[p].head;
+        for (t_edge *edge = graph.adj_lists[order[p]].head; edge != NULL; edge = edge->next) {
+            t_edge *copy = create_edge(position[edge->destination - 1] + 1, edge->probability);
+            if (copy == NULL) {
+                free_graph(permuted);
+                free(position);
+                return (t_graph){NULL, 0};
+            }
+            *tail = copy;
+            tail = &copy->next;
+        }
+    }
+    free(position);
+    return permuted;
+}
+
+int graph_bandwidth(t_graph graph) {
+    int bandwidth = 0;
+    for (int v = 0; v < graph.num_vertices; v++) {
+        for (t_edge *edge = graph.adj_lists[v].head; edge != NULL; edge = edge->next) {
+            int distance = abs(edge->destination - 1 - v);
+            if (distance > bandwidth) bandwidth = distance;
+        }
+    }
+    return bandwidth;
+}
@@ -0,0 +1,48 @@
+#ifndef REORDER_H
+#define REORDER_H
+
+#include "graph.h"
+#include "tarjan.h"
+
+/*
+   Renumérotation des sommets pour la localité mémoire.
+   Un fichier peut numéroter ses états dans un ordre quelconque : les voisins d'un
+   sommet sont alors dispersés dans les tableaux indexés par sommet (v_data de Tarjan,
+   vecteurs des itérations creuses). Une permutation est un tableau order de N cases :
+   order[p] est le sommet (0-based) rangé en position p, qui devient le sommet p + 1.
+*/
+
+//Ordre de renumérotation.
+typedef enum e_reorder_kind {
+    REORDER_NONE = 0,   // Numérotation du fichier
+    REORDER_BFS,        // Ordre de découverte d'un parcours en largeur (arêtes sortantes)
+    REORDER_RCM,        // Cuthill-McKee inverse sur le graphe symétrisé : réduit la largeur de bande
+    REORDER_CLASS       // Classes contiguës, sources d'abord (ordre de la matrice par blocs)
+} t_reorder_kind;
+
+//Nom d'un ordre ("none", "bfs", "rcm", "class").
+const char *reorder_kind_name(t_reorder_kind kind);
+
+//Ordre correspondant à un nom. Retourne -1 si le nom est inconnu.
+int reorder_parse_kind(const char *name);
+
+//Parcours en largeur depuis le sommet 1, puis depuis le premier sommet non atteint, etc. Retourne NULL si la mémoire manque.
+int *reorder_bfs(t_graph graph);
+
+//Cuthill-McKee inverse : chaque composante part d'un sommet pseudo-périphérique, voisins par degré croissant. Retourne NULL si la mémoire manque.
+int *reorder_rcm(t_graph graph);
+
+//Membres de chaque classe à la suite, classes par identifiant décroissant (voir block_matrix.h). Retourne NULL si la mémoire manque.
+int *reorder_by_class(t_partition partition, int num_vertices);
+
+//Calcule la permutation demandée (REORDER_CLASS lance Tarjan). Retourne NULL si la mémoire manque ou si kind vaut REORDER_NONE.
+int *compute_reordering(t_graph graph, t_reorder_kind kind);
+
+//Graphe renuméroté : le sommet order[p] + 1 devient p + 1, l'ordre des arêtes de chaque liste est conservé.
+//adj_lists vaut NULL si la mémoire manque.
+t_graph permute_graph(t_graph graph, const int *order);
+
+//Largeur de bande du graphe : max |départ - arrivée| sur toutes les arêtes.
+int graph_bandwidth(t_graph graph);
+
+#endif // REORDER_H
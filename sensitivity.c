@@ -0,0 +1,710 @@
+#include "sensitivity.h"
+#include <math.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <unistd.h>
+
+/*
+   sensitivity_init :
+   Numérote les membres de chaque classe. Les tableaux de lignes et de colonnes sont
+   vides : chacune est résolue à sa première utilisation.
+*/
+t_markov_status sensitivity_init(t_sensitivity *s, const t_markov_ctx *ctx) {
+    memset(s, 0, sizeof(*s));
+    if (ctx == NULL) return MARKOV_ERR_ARGUMENT;
+    if (!(ctx->stages_done & MARKOV_STAGE_SOLVED)) return MARKOV_ERR_STATE;
+
+    int N = ctx->num_vertices;
+    s->ctx = ctx;
+    s->local = (int *)malloc(N * sizeof(int));
+    s->group_rows = (double **)calloc(N, sizeof(double *));
+    s->visit_columns = (double **)calloc(N, sizeof(double *));
+    if (s->local == NULL || s->group_rows == NULL || s->visit_columns == NULL) {
+        perror("Allocation failed for sensitivity analysis");
+        sensitivity_free(s);
+        return MARKOV_ERR_NOMEM;
+    }
+
+    for (int i = 0; i < ctx->partition.num_classes; i++) {
+        t_class c = ctx->partition.classes[i];
+        for (int m = 0; m < c.num_members; m++) s->local[c.members_ids[m] - 1] = m;
+    }
+    return MARKOV_OK;
+}
+
+void sensitivity_free(t_sensitivity *s) {
+    int N = (s->ctx != NULL) ? s->ctx->num_vertices : 0;
+    for (int v = 0; v < N; v++) {
+        if (s->group_rows != NULL) free(s->group_rows[v]);
+        if (s->visit_columns != NULL) free(s->visit_columns[v]);
+    }
+    free(s->local);
+    free(s->group_rows);
+    free(s->visit_columns);
+    memset(s, 0, sizeof(*s));
+}
+
+/*
+   sensitivity_load_file :
+   Les états sont lus comme des mots et retrouvés par markov_find_state : un fichier
+   de modifications s'écrit avec les mêmes noms que la chaîne.
+*/
+t_markov_status sensitivity_load_file(const char *path, const t_markov_ctx *ctx, t_perturbation **perturbations, int *count) {
+    if (path == NULL || ctx == NULL || perturbations == NULL || count == NULL) return MARKOV_ERR_ARGUMENT;
+    *perturbations = NULL;
+    *count = 0;
+
+    FILE *file = fopen(path, "rt");
+    if (file == NULL) {
+        perror("Could not open what-if file for reading");
+        return MARKOV_ERR_IO;
+    }
+
+    char line[512];
+    int line_number = 0;
+    int capacity = 0;
+    t_markov_status status = MARKOV_OK;
+    while (status == MARKOV_OK && fgets(line, sizeof(line), file) != NULL) {
+        line_number++;
+        char *text = line;
+        while (*text == ' ' || *text == '\t') text++;
+        if (*text == '\0' || *text == '\n' || *text == '\r' || *text == '#') continue;
+
+        char from[128], to[128];
+        double delta;
+        if (sscanf(text, "%127s %127s %lf", from, to, &delta) != 3) {
+            fprintf(stderr, "Error: Invalid what-if line %d in %s.\n", line_number, path);
+            status = MARKOV_ERR_FORMAT;
+            continue;
+        }
+        int v_from = markov_find_state(ctx, from);
+        int v_to = markov_find_state(ctx, to);
+        if (v_from == 0 || v_to == 0) {
+            fprintf(stderr, "Error: Unknown state on what-if line %d in %s.\n", line_number, path);
+            status = MARKOV_ERR_FORMAT;
+            continue;
+        }
+
+        if (*count == capacity) {
+            capacity = (capacity == 0) ? 64 : 2 * capacity;
+            t_perturbation *grown = (t_perturbation *)realloc(*perturbations, capacity * sizeof(t_perturbation));
+            if (grown == NULL) {
+                perror("Allocation failed for what-if perturbations");
+                status = MARKOV_ERR_NOMEM;
+                continue;
+            }
+            *perturbations = grown;
+        }
+        t_perturbation *p = &(*perturbations)[(*count)++];
+        p->from = markov_internal_id(ctx, v_from);
+        p->to = markov_internal_id(ctx, v_to);
+        p->delta = delta;
+    }
+
+    fclose(file);
+    if (status != MARKOV_OK) {
+        free(*perturbations);
+        *perturbations = NULL;
+        *count = 0;
+    }
+    return status;
+}
+
+//Classe (0-based) du sommet v (0-based).
+static int class_of(const t_sensitivity *s, int v) {
+    return s->ctx->partition.v_data[v].class_id - 1;
+}
+
+/*
+   solve_group :
+   Ligne (column = 0) ou colonne (column = 1) du sommet v dans l'inverse de groupe A#
+   de I - P_c, c étant la classe persistante de v :
+     ligne   : a (I - P_c) = e_v - pi,          a . 1 = 0
+     colonne : (I - P_c) a = e_v - pi(v) 1,     pi . a = 0
+   Le système est singulier : il est itéré sur la chaîne paresseuse (I + P) / 2, qui
+   converge même si la classe est périodique, a = b + a (I + P) / 2 avec b le second
+   membre divisé par 2, la condition de somme étant rétablie à chaque pas.
+   out reçoit k valeurs (indices locaux). Retourne le nombre d'itérations, -1 si la
+   mémoire manque.
+*/
+static int solve_group(const t_sensitivity *s, int v, int column, double *out) {
+    const t_csr *P = &s->ctx->P;
+    t_class c = s->ctx->partition.classes[class_of(s, v)];
+    int k = c.num_members;
+
+    double *pi = (double *)malloc(k * sizeof(double));
+    double *b = (double *)malloc(k * sizeof(double));
+    double *next = (double *)calloc(k, sizeof(double));
+    if (pi == NULL || b == NULL || next == NULL) {
+        perror("Allocation failed for group inverse solve");
+        free(pi);
+        free(b);
+        free(next);
+        return -1;
+    }
+
+    // Second membre de somme nulle (ligne) ou orthogonal à pi (colonne), à l'arrondi près
+    double total = 0.0;
+    for (int m = 0; m < k; m++) {
+        pi[m] = s->ctx->stationary[c.members_ids[m] - 1];
+        total += pi[m];
+    }
+    int lv = s->local[v];
+    for (int m = 0; m < k; m++) {
+        pi[m] = (total > 0.0) ? pi[m] / total : 1.0 / k;
+        b[m] = -0.5 * (column ? pi[lv] : pi[m]);
+    }
+    b[lv] += 0.5;
+    memcpy(out, b, k * sizeof(double));
+
+    int iter;
+    for (iter = 1; iter <= MARKOV_STATIONARY_MAX_ITER; iter++) {
+        for (int m = 0; m < k; m++) {
+            int u = c.members_ids[m] - 1;
+            if (column) {
+                double acc = 0.0;
+                for (int e = P->row_ptr[u]; e < P->row_ptr[u + 1]; e++) acc += P->values[e] * out[s->local[P->col_idx[e]]];
+                next[m] = b[m] + 0.5 * (out[m] + acc);
+            } else {
+                next[m] += b[m] + 0.5 * out[m];
+            }
+        }
+        if (!column) {
+            for (int m = 0; m < k; m++) {
+                int u = c.members_ids[m] - 1;
+                double half = 0.5 * out[m];
+                for (int e = P->row_ptr[u]; e < P->row_ptr[u + 1]; e++) next[s->local[P->col_idx[e]]] += half * P->values[e];
+            }
+        }
+
+        double drift = 0.0;
+        for (int m = 0; m < k; m++) drift += column ? pi[m] * next[m] : next[m];
+        double delta = 0.0, scale = 0.0;
+        for (int m = 0; m < k; m++) {
+            next[m] -= column ? drift : drift * pi[m];
+            delta = fmax(delta, fabs(next[m] - out[m]));
+            scale = fmax(scale, fabs(next[m]));
+            out[m] = next[m];
+            if (!column) next[m] = 0.0;
+        }
+        if (delta <= SENSITIVITY_EPSILON * fmax(1.0, scale)) break;
+    }
+    if (iter > MARKOV_STATIONARY_MAX_ITER) iter = MARKOV_STATIONARY_MAX_ITER;
+
+    free(pi);
+    free(b);
+    free(next);
+    return iter;
+}
+
+/*
+   solve_visit_column :
+   Colonne u de la matrice fondamentale pour le sommet transitoire i : u(v) est le
+   nombre moyen de passages par i en partant de v, u = e_i + Q u. Seules les classes
+   d'identifiant supérieur ou égal à celui de i peuvent l'atteindre (voir
+   absorption_probabilities) : elles sont résolues dans l'ordre croissant, par
+   Gauss-Seidel comme class_absorption. u (N cases) doit être nul au départ.
+   Retourne le nombre d'itérations.
+*/
+static int solve_visit_column(const t_sensitivity *s, int i, double *u) {
+    const t_csr *P = &s->ctx->P;
+    t_partition partition = s->ctx->partition;
+    int total = 0;
+
+    for (int ic = class_of(s, i); ic < partition.num_classes; ic++) {
+        t_class c = partition.classes[ic];
+        if (c.is_persistent) continue;
+
+        int iter;
+        for (iter = 1; iter <= MARKOV_STATIONARY_MAX_ITER; iter++) {
+            double delta = 0.0, scale = 0.0;
+            for (int m = 0; m < c.num_members; m++) {
+                int v = c.members_ids[m] - 1;
+                double acc = (v == i) ? 1.0 : 0.0;
+                double self_loop = 0.0;
+                for (int e = P->row_ptr[v]; e < P->row_ptr[v + 1]; e++) {
+                    int w = P->col_idx[e];
+                    if (w == v) self_loop += P->values[e];
+                    else acc += P->values[e] * u[w];
+                }
+                // Une classe transitoire a toujours une sortie : self_loop < 1
+                double value = (self_loop < 1.0) ? acc / (1.0 - self_loop) : 0.0;
+                delta = fmax(delta, fabs(value - u[v]));
+                scale = fmax(scale, fabs(value));
+                u[v] = value;
+            }
+            if (delta <= SENSITIVITY_EPSILON * fmax(1.0, scale)) break;
+        }
+        total += (iter > MARKOV_STATIONARY_MAX_ITER) ? MARKOV_STATIONARY_MAX_ITER : iter;
+    }
+    return total;
+}
+
+/*
+   solve_visit_row :
+   Ligne n de la matrice fondamentale pour le sommet transitoire v : n(i) est le
+   nombre moyen de passages par i en partant de v, n = e_v + n Q. La masse descend
+   les classes par identifiant décroissant, comme dans absorption_from_vertex.
+   n (N cases) doit être nul au départ. Retourne le nombre d'itérations, -1 si la
+   mémoire manque.
+*/
+static int solve_visit_row(const t_sensitivity *s, int v, double *n) {
+    const t_csr *P = &s->ctx->P;
+    t_partition partition = s->ctx->partition;
+    int N = P->num_vertices;
+
+    double *mass = (double *)calloc(N, sizeof(double));
+    double *next = (double *)calloc(N, sizeof(double));
+    if (mass == NULL || next == NULL) {
+        perror("Allocation failed for visit row solve");
+        free(mass);
+        free(next);
+        return -1;
+    }
+    mass[v] = 1.0;
+
+    int total = 0;
+    for (int ic = class_of(s, v); ic >= 0; ic--) {
+        t_class c = partition.classes[ic];
+        if (c.is_persistent) continue;
+
+        int reached = 0;
+        for (int m = 0; m < c.num_members && !reached; m++) reached = (mass[c.members_ids[m] - 1] != 0.0);
+        if (!reached) continue;
+
+        for (int m = 0; m < c.num_members; m++) n[c.members_ids[m] - 1] = mass[c.members_ids[m] - 1];
+        int iter;
+        for (iter = 1; iter <= MARKOV_STATIONARY_MAX_ITER; iter++) {
+            for (int m = 0; m < c.num_members; m++) next[c.members_ids[m] - 1] = mass[c.members_ids[m] - 1];
+            for (int m = 0; m < c.num_members; m++) {
+                int u = c.members_ids[m] - 1;
+                for (int e = P->row_ptr[u]; e < P->row_ptr[u + 1]; e++) {
+                    int w = P->col_idx[e];
+                    if (partition.v_data[w].class_id == c.id) next[w] += n[u] * P->values[e];
+                }
+            }
+            double delta = 0.0, scale = 0.0;
+            for (int m = 0; m < c.num_members; m++) {
+                int u = c.members_ids[m] - 1;
+                delta = fmax(delta, fabs(next[u] - n[u]));
+                scale = fmax(scale, fabs(next[u]));
+                n[u] = next[u];
+            }
+            if (delta <= SENSITIVITY_EPSILON * fmax(1.0, scale)) break;
+        }
+        total += (iter > MARKOV_STATIONARY_MAX_ITER) ? MARKOV_STATIONARY_MAX_ITER : iter;
+
+        // Les passages qui sortent de la classe rejoignent les classes transitoires atteintes
+        for (int m = 0; m < c.num_members; m++) {
+            int u = c.members_ids[m] - 1;
+            for (int e = P->row_ptr[u]; e < P->row_ptr[u + 1]; e++) {
+                int w = P->col_idx[e];
+                int target = partition.v_data[w].class_id - 1;
+                if (target != ic && !partition.classes[target].is_persistent) mass[w] += n[u] * P->values[e];
+            }
+        }
+    }
+
+    free(mass);
+    free(next);
+    return total;
+}
+
+/*
+   solve_vertex :
+   Résout et garde la ligne de A# (sommet persistant) ou la colonne de (I - Q)^-1
+   (sommet transitoire) du sommet v, si elle manque. Chaque appel n'écrit que la
+   case de v : des threads peuvent résoudre des sommets distincts en même temps.
+   Retourne le nombre d'itérations, -1 si la mémoire manque.
+*/
+static int solve_vertex(t_sensitivity *s, int v) {
+    t_class c = s->ctx->partition.classes[class_of(s, v)];
+    if (c.is_persistent) {
+        if (s->group_rows[v] != NULL) return 0;
+        double *row = (double *)malloc(c.num_members * sizeof(double));
+        int iter = (row != NULL) ? solve_group(s, v, 0, row) : -1;
+        if (iter < 0) {
+            free(row);
+            return -1;
+        }
+        s->group_rows[v] = row;
+        return iter;
+    }
+
+    if (s->visit_columns[v] != NULL) return 0;
+    double *column = (double *)calloc(s->ctx->num_vertices, sizeof(double));
+    if (column == NULL) {
+        perror("Allocation failed for visit column");
+        return -1;
+    }
+    int iter = solve_visit_column(s, v, column);
+    s->visit_columns[v] = column;
+    return iter;
+}
+
+/*
+   check_perturbation :
+   Vérifie que la modification garde les classes intactes et retourne, dans rest, la
+   somme des autres transitions de from (1 - P(from, to) pour une ligne stochastique).
+*/
+static t_markov_status check_perturbation(const t_sensitivity *s, t_perturbation p, double *current, double *rest) {
+    const t_csr *P = &s->ctx->P;
+    int N = s->ctx->num_vertices;
+    if (p.from < 1 || p.from > N || p.to < 1 || p.to > N || !isfinite(p.delta)) return MARKOV_ERR_ARGUMENT;
+
+    int i = p.from - 1, j = p.to - 1;
+    *current = 0.0;
+    *rest = 0.0;
+    for (int e = P->row_ptr[i]; e < P->row_ptr[i + 1]; e++) {
+        if (P->col_idx[e] == j) *current += P->values[e];
+        else *rest += P->values[e];
+    }
+    if (*rest <= 0.0 || *current + p.delta <= 0.0 || p.delta >= *rest) return MARKOV_ERR_ARGUMENT;
+    if (s->ctx->partition.classes[class_of(s, i)].is_persistent && class_of(s, j) != class_of(s, i)) {
+        return MARKOV_ERR_ARGUMENT;
+    }
+    return MARKOV_OK;
+}
+
+/*
+   rank_one_update :
+   Formules de Sherman-Morrison (voir sensitivity.h) à partir des lignes et colonnes
+   déjà résolues. Remplit effect ; stationary (valeurs de base déjà copiées) reçoit les
+   cases modifiées, absorb_weight et absorb_change (à zéro) les deux facteurs de la
+   correction d'absorption, s'ils ne valent pas NULL.
+*/
+static t_markov_status rank_one_update(const t_sensitivity *s, t_perturbation p, double rest, t_whatif_effect *effect,
+                                       double *stationary, double *absorb_weight, double *absorb_change) {
+    const t_markov_ctx *ctx = s->ctx;
+    int i = p.from - 1, j = p.to - 1;
+    int ci = class_of(s, i);
+    t_class c = ctx->partition.classes[ci];
+    int C = ctx->partition.num_classes;
+
+    memset(effect, 0, sizeof(*effect));
+    effect->class_id = ci + 1;
+    effect->most_changed = p.from;
+
+    if (c.is_persistent) {
+        const double *ai = s->group_rows[i];
+        const double *aj = s->group_rows[j];
+        if (ai == NULL || aj == NULL) return MARKOV_ERR_NOMEM;
+
+        int li = s->local[i];
+        double pi_i = ctx->stationary[i];
+        double yi = (aj[li] - ai[li] + 1.0 - pi_i) / rest;
+        double denominator = 1.0 - p.delta * yi;
+        if (denominator <= 0.0) return MARKOV_ERR_ARGUMENT;
+        double factor = pi_i * p.delta / (denominator * rest);
+
+        effect->target_class = ci + 1;
+        double largest = -1.0;
+        for (int m = 0; m < c.num_members; m++) {
+            int v = c.members_ids[m] - 1;
+            double before = ctx->stationary[v];
+            double change = factor * (aj[m] - ai[m] + ((m == li) ? 1.0 : 0.0) - before);
+            effect->stationary_l1 += fabs(change);
+            if (fabs(change) > largest) {
+                largest = fabs(change);
+                effect->most_changed = v + 1;
+                effect->before = before;
+                effect->after = before + change;
+            }
+            if (stationary != NULL) stationary[v] = before + change;
+        }
+        return MARKOV_OK;
+    }
+
+    const double *u = s->visit_columns[i];
+    if (u == NULL) return MARKOV_ERR_NOMEM;
+
+    // w = delta (h_j - h_i) / rest, alpha = delta (u(j) - u(i) + 1) / rest
+    double alpha = p.delta * (u[j] - u[i] + 1.0) / rest;
+    if (alpha >= 1.0) return MARKOV_ERR_ARGUMENT;
+    double scale = p.delta / (rest * (1.0 - alpha));
+
+    // Lignes d'absorption de i et de j, par classe (absorption_row : lues ou recalculées)
+    double *hi = (double *)malloc(2 * C * sizeof(double));
+    if (hi == NULL) return MARKOV_ERR_NOMEM;
+    double *hj = hi + C;
+    if (absorption_row(&ctx->P, ctx->partition, &ctx->absorb, i, hi) != 0
+        || absorption_row(&ctx->P, ctx->partition, &ctx->absorb, j, hj) != 0) {
+        free(hi);
+        return MARKOV_ERR_NOMEM;
+    }
+
+    int best_c = -1;
+    for (int q = 0; q < C; q++) {
+        if (ctx->persistent_index[q] < 0) continue;
+        if (best_c < 0 || fabs(hj[q] - hi[q]) > fabs(hj[best_c] - hi[best_c])) best_c = q;
+        if (absorb_change != NULL) absorb_change[q] = (hj[q] - hi[q]) * scale;
+    }
+    int best_v = i;
+    for (int v = 0; v < ctx->num_vertices; v++) {
+        if (fabs(u[v]) > fabs(u[best_v])) best_v = v;
+        if (absorb_weight != NULL) absorb_weight[v] = u[v];
+    }
+    double change = (best_c >= 0) ? u[best_v] * (hj[best_c] - hi[best_c]) * scale : 0.0;
+    free(hi);
+
+    effect->absorption_max = fabs(change);
+    effect->most_changed = best_v + 1;
+    if (best_c < 0) return MARKOV_OK;
+    effect->target_class = best_c + 1;
+    if (markov_absorption(ctx, best_v + 1, best_c + 1, &effect->before) != MARKOV_OK) return MARKOV_ERR_NOMEM;
+    effect->after = effect->before + change;
+    return MARKOV_OK;
+}
+
+/*
+   sensitivity_apply :
+   Résout les lignes ou la colonne qui manquent, puis copie les résultats de base et
+   y ajoute la correction de rang un.
+*/
+t_markov_status sensitivity_apply(t_sensitivity *s, t_perturbation perturbation, double *stationary,
+                                  double *absorb_weight, double *absorb_change) {
+    if (s == NULL || s->ctx == NULL) return MARKOV_ERR_ARGUMENT;
+    double current, rest;
+    t_markov_status status = check_perturbation(s, perturbation, &current, &rest);
+    if (status != MARKOV_OK) return status;
+
+    int needed[2] = {perturbation.from - 1, perturbation.to - 1};
+    int num_needed = s->ctx->partition.classes[class_of(s, needed[0])].is_persistent ? 2 : 1;
+    for (int k = 0; k < num_needed; k++) {
+        int computed = (s->group_rows[needed[k]] == NULL && s->visit_columns[needed[k]] == NULL);
+        int iter = solve_vertex(s, needed[k]);
+        if (iter < 0) return MARKOV_ERR_NOMEM;
+        s->solves += computed;
+        s->iterations += iter;
+    }
+
+    int N = s->ctx->num_vertices;
+    if (stationary != NULL) memcpy(stationary, s->ctx->stationary, N * sizeof(double));
+    if (absorb_weight != NULL) memset(absorb_weight, 0, N * sizeof(double));
+    if (absorb_change != NULL) memset(absorb_change, 0, s->ctx->partition.num_classes * sizeof(double));
+    t_whatif_effect effect;
+    return rank_one_update(s, perturbation, rest, &effect, stationary, absorb_weight, absorb_change);
+}
+
+//Travail partagé par les threads de sensitivity_batch.
+typedef struct s_sensitivity_pool {
+    t_sensitivity *s;
+    const t_perturbation *perturbations;
+    t_whatif_effect *effects;
+    int count;
+    const int *pending;        // Sommets dont la ligne ou la colonne est à résoudre
+    int num_pending;
+    atomic_int next;
+    atomic_int failed;
+    atomic_llong iterations;
+} t_sensitivity_pool;
+
+//solve_worker : résout les sommets en attente, un par un.
+static void *solve_worker(void *arg) {
+    t_sensitivity_pool *pool = (t_sensitivity_pool *)arg;
+    int k;
+    while ((k = atomic_fetch_add(&pool->next, 1)) < pool->num_pending) {
+        int iter = solve_vertex(pool->s, pool->pending[k]);
+        if (iter < 0) atomic_store(&pool->failed, 1);
+        else atomic_fetch_add(&pool->iterations, iter);
+    }
+    return NULL;
+}
+
+//effect_worker : évalue les modifications, une par une (lecture seule).
+static void *effect_worker(void *arg) {
+    t_sensitivity_pool *pool = (t_sensitivity_pool *)arg;
+    int k;
+    while ((k = atomic_fetch_add(&pool->next, 1)) < pool->count) {
+        double current, rest;
+        t_whatif_effect *effect = &pool->effects[k];
+        t_markov_status status = check_perturbation(pool->s, pool->perturbations[k], &current, &rest);
+        if (status == MARKOV_OK) status = rank_one_update(pool->s, pool->perturbations[k], rest, effect, NULL, NULL, NULL);
+        effect->status = status;
+    }
+    return NULL;
+}
+
+/*
+   run_workers :
+   Lance num_threads threads sur worker (items tâches au plus) ; si aucun ne démarre,
+   le thread appelant fait tout le travail.
+*/
+static void run_workers(t_sensitivity_pool *pool, void *(*worker)(void *), int num_threads, int items) {
+    atomic_store(&pool->next, 0);
+    if (num_threads > items) num_threads = items;
+    if (num_threads < 1) num_threads = 1;
+
+    pthread_t *threads = (pthread_t *)malloc(num_threads * sizeof(pthread_t));
+    int started = 0;
+    for (int t = 0; threads != NULL && t < num_threads; t++) {
+        if (pthread_create(&threads[t], NULL, worker, pool) != 0) break;
+        started++;
+    }
+    if (started == 0) worker(pool);
+    for (int t = 0; t < started; t++) pthread_join(threads[t], NULL);
+    free(threads);
+}
+
+/*
+   sensitivity_batch :
+   1. Liste des sommets à résoudre : départ et arrivée des modifications d'états
+      persistants, départ des modifications d'états transitoires (sans doublon, sans
+      ceux déjà gardés) ; résolution en parallèle, chaque sommet par un seul thread.
+   2. Évaluation de chaque modification, en parallèle, sans plus rien écrire dans s.
+*/
+t_markov_status sensitivity_batch(t_sensitivity *s, const t_perturbation *perturbations, int count, int num_threads,
+                                  t_whatif_effect *effects) {
+    if (s == NULL || s->ctx == NULL || (count > 0 && (perturbations == NULL || effects == NULL))) return MARKOV_ERR_ARGUMENT;
+    int N = s->ctx->num_vertices;
+    if (num_threads <= 0) {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = (cores > 0) ? (int)cores : 1;
+    }
+
+    unsigned char *marked = (unsigned char *)calloc(N, 1);
+    int *pending = (int *)malloc((2 * (size_t)count + 1) * sizeof(int));
+    if (marked == NULL || pending == NULL) {
+        perror("Allocation failed for sensitivity batch");
+        free(marked);
+        free(pending);
+        return MARKOV_ERR_NOMEM;
+    }
+    int num_pending = 0;
+    for (int k = 0; k < count; k++) {
+        double current, rest;
+        if (check_perturbation(s, perturbations[k], &current, &rest) != MARKOV_OK) continue;
+        int needed[2] = {perturbations[k].from - 1, perturbations[k].to - 1};
+        int num_needed = s->ctx->partition.classes[class_of(s, needed[0])].is_persistent ? 2 : 1;
+        for (int n = 0; n < num_needed; n++) {
+            int v = needed[n];
+            if (marked[v] || s->group_rows[v] != NULL || s->visit_columns[v] != NULL) continue;
+            marked[v] = 1;
+            pending[num_pending++] = v;
+        }
+    }
+
+    t_sensitivity_pool pool;
+    pool.s = s;
+    pool.perturbations = perturbations;
+    pool.effects = effects;
+    pool.count = count;
+    pool.pending = pending;
+    pool.num_pending = num_pending;
+    atomic_init(&pool.next, 0);
+    atomic_init(&pool.failed, 0);
+    atomic_init(&pool.iterations, 0);
+
+    if (num_pending > 0) run_workers(&pool, solve_worker, num_threads, num_pending);
+    s->solves += num_pending;
+    s->iterations += atomic_load(&pool.iterations);
+    if (count > 0) run_workers(&pool, effect_worker, num_threads, count);
+
+    free(marked);
+    free(pending);
+    return atomic_load(&pool.failed) ? MARKOV_ERR_NOMEM : MARKOV_OK;
+}
+
+/*
+   sensitivity_stationary_gradient :
+   d pi(t) / d delta = pi(i) (A#(j, t) - A#(i, t) + [i = t] - pi(t)) / rest pour la
+   transition i -> j : toutes les dérivées ne demandent que la colonne t de A#.
+*/
+t_markov_status sensitivity_stationary_gradient(t_sensitivity *s, int target, double *out) {
+    if (s == NULL || s->ctx == NULL || out == NULL) return MARKOV_ERR_ARGUMENT;
+    const t_csr *P = &s->ctx->P;
+    if (target < 1 || target > P->num_vertices) return MARKOV_ERR_ARGUMENT;
+    memset(out, 0, P->num_edges * sizeof(double));
+
+    int t = target - 1;
+    t_class c = s->ctx->partition.classes[class_of(s, t)];
+    if (!c.is_persistent) return MARKOV_OK;
+
+    double *column = (double *)malloc(c.num_members * sizeof(double));
+    int iter = (column != NULL) ? solve_group(s, t, 1, column) : -1;
+    if (iter < 0) {
+        free(column);
+        return MARKOV_ERR_NOMEM;
+    }
+    s->solves++;
+    s->iterations += iter;
+
+    double pi_t = s->ctx->stationary[t];
+    for (int m = 0; m < c.num_members; m++) {
+        int i = c.members_ids[m] - 1;
+        double row_sum = 0.0;
+        for (int e = P->row_ptr[i]; e < P->row_ptr[i + 1]; e++) row_sum += P->values[e];
+        for (int e = P->row_ptr[i]; e < P->row_ptr[i + 1]; e++) {
+            double rest = row_sum - P->values[e];
+            if (rest <= 0.0) continue;
+            double aj = column[s->local[P->col_idx[e]]];
+            out[e] = s->ctx->stationary[i] * (aj - column[m] + ((i == t) ? 1.0 : 0.0) - pi_t) / rest;
+        }
+    }
+    free(column);
+    return MARKOV_OK;
+}
+
+/*
+   sensitivity_absorption_gradient :
+   d h(t, c) / d delta = n(i) (h(j, c) - h(i, c)) / rest pour la transition i -> j
+   d'un état transitoire, n étant la ligne t de (I - Q)^-1 (passages partant de t).
+*/
+t_markov_status sensitivity_absorption_gradient(t_sensitivity *s, int target, int class_id, double *out) {
+    if (s == NULL || s->ctx == NULL || out == NULL) return MARKOV_ERR_ARGUMENT;
+    const t_markov_ctx *ctx = s->ctx;
+    const t_csr *P = &ctx->P;
+    if (target < 1 || target > P->num_vertices || class_id < 1 || class_id > ctx->partition.num_classes) {
+        return MARKOV_ERR_ARGUMENT;
+    }
+    int q = ctx->persistent_index[class_id - 1];
+    if (q < 0) return MARKOV_ERR_ARGUMENT;
+    memset(out, 0, P->num_edges * sizeof(double));
+
+    int t = target - 1;
+    if (ctx->partition.classes[class_of(s, t)].is_persistent) return MARKOV_OK;
+
+    double *visits = (double *)calloc(2 * (size_t)P->num_vertices, sizeof(double));
+    double *h = visits + P->num_vertices;   // Probabilité de finir dans la classe depuis chaque état
+    int iter = (visits != NULL) ? solve_visit_row(s, t, visits) : -1;
+    if (iter < 0 || absorption_column(P, ctx->partition, &ctx->absorb, class_id - 1, h) != 0) {
+        free(visits);
+        return MARKOV_ERR_NOMEM;
+    }
+    s->solves++;
+    s->iterations += iter;
+
+    for (int i = 0; i < P->num_vertices; i++) {
+        if (visits[i] == 0.0) continue;
+        double row_sum = 0.0;
+        for (int e = P->row_ptr[i]; e < P->row_ptr[i + 1]; e++) row_sum += P->values[e];
+        for (int e = P->row_ptr[i]; e < P->row_ptr[i + 1]; e++) {
+            double rest = row_sum - P->values[e];
+            if (rest <= 0.0) continue;
+            out[e] = visits[i] * (h[P->col_idx[e]] - h[i]) / rest;
+        }
+    }
+    free(visits);
+    return MARKOV_OK;
+}
+
+/*
+   sensitivity_top_edges :
+   Un seul passage : edges reste trié, une arête n'y entre que si elle dépasse la
+   dernière (insertion), ce qui arrive rarement une fois le tableau plein.
+*/
+int sensitivity_top_edges(const double *gradient, int num_edges, int count, int *edges) {
+    int found = 0;
+    for (int e = 0; e < num_edges; e++) {
+        double size = fabs(gradient[e]);
+        if (size == 0.0 || (found == count && size <= fabs(gradient[edges[found - 1]]))) continue;
+        int k = (found < count) ? found++ : found - 1;
+        while (k > 0 && fabs(gradient[edges[k - 1]]) < size) {
+            edges[k] = edges[k - 1];
+            k--;
+        }
+        edges[k] = e;
+    }
+    return found;
+}
@@ -0,0 +1,95 @@
+#ifndef SENSITIVITY_H
+#define SENSITIVITY_H
+
+#include "markov.h"
+
+/*
+   Analyse de sensibilité d'une chaîne résolue (markov_solve) : effet d'une modification
+   de la transition i -> j sur la distribution stationnaire et sur les probabilités
+   d'absorption, sans relancer l'analyse.
+   Modifier P(i, j) de delta en remettant les autres transitions de i à l'échelle
+   (la ligne somme toujours à 1) ajoute à P la matrice de rang un e_i d, d'où des
+   formules de Sherman-Morrison :
+   - i persistant (classe c) : pi' = pi + pi(i) delta y / (1 - delta y(i)), avec
+     y = (a_j - a_i + e_i - pi) / r, a_u étant la ligne u de l'inverse de groupe A#
+     de I - P_c et r = 1 - P(i, j) la somme des autres transitions de i ;
+   - i transitoire : h' = h + u w / (1 - alpha), avec u la colonne i de la matrice
+     fondamentale (I - Q)^-1, w = delta (h_j - h_i) / r et
+     alpha = delta (u(j) - u(i) + 1) / r.
+   Les lignes de P sont supposées stochastiques (à la tolérance de markov_check près).
+   Chaque ligne a_u et chaque colonne u est résolue une fois (itération creuse sur la
+   CSR) puis gardée : les modifications suivantes de la même ligne de P ne coûtent
+   plus que O(taille de la classe) ou O(N + nombre de classes).
+*/
+
+//Tolérance des résolutions (écart maximal entre deux itérations, relatif à la plus grande valeur).
+#define SENSITIVITY_EPSILON 1e-12
+
+//Modification d'une transition (sommets numérotés de 1 à N dans le contexte) : P(from, to) devient P(from, to) + delta,
+//les autres transitions de from (de somme r = 1 - P(from, to)) étant multipliées par (r - delta) / r.
+typedef struct s_perturbation {
+    int from;
+    int to;
+    double delta;
+} t_perturbation;
+
+//Effet d'une modification (sensitivity_batch).
+typedef struct s_whatif_effect {
+    t_markov_status status;  // MARKOV_ERR_ARGUMENT si la modification change les classes (voir sensitivity_apply)
+    int class_id;            // Classe de l'état de départ
+    double stationary_l1;    // Somme des |pi'(v) - pi(v)| (0 si le départ est transitoire)
+    double absorption_max;   // Plus grand |h'(v, c) - h(v, c)| (0 si le départ est persistant)
+    int most_changed;        // État dont la valeur change le plus : probabilité stationnaire, ou d'absorption dans target_class
+    int target_class;        // Classe persistante de cette valeur
+    double before;           // Valeur avant...
+    double after;            // ... et après la modification
+} t_whatif_effect;
+
+//Lignes et colonnes déjà résolues d'une chaîne. Un même t_sensitivity ne doit pas être utilisé par deux threads à la fois
+//(sensitivity_batch répartit elle-même le travail sur ses threads).
+typedef struct s_sensitivity {
+    const t_markov_ctx *ctx;   // Chaîne résolue, lue seulement
+    int *local;                // N cases : position de chaque sommet parmi les membres de sa classe
+    double **group_rows;       // N cases : ligne du sommet dans l'inverse de groupe de sa classe persistante (k cases), NULL si non calculée
+    double **visit_columns;    // N cases : colonne du sommet transitoire dans (I - Q)^-1 (N cases), NULL si non calculée
+    long long solves;          // Lignes et colonnes résolues
+    long long iterations;      // Itérations de ces résolutions
+} t_sensitivity;
+
+//Prépare l'analyse d'une chaîne résolue (markov_solve exécuté). Aucune résolution n'est faite ici.
+t_markov_status sensitivity_init(t_sensitivity *s, const t_markov_ctx *ctx);
+
+//Libère les lignes et colonnes gardées.
+void sensitivity_free(t_sensitivity *s);
+
+//Lit un fichier de modifications, une par ligne : "départ arrivée delta" (numéros du fichier ou étiquettes, '#' pour
+//un commentaire), converties dans la numérotation de ctx. *perturbations est à libérer par l'appelant.
+t_markov_status sensitivity_load_file(const char *path, const t_markov_ctx *ctx, t_perturbation **perturbations, int *count);
+
+//Applique une modification. stationary (N cases) reçoit la distribution de la chaîne modifiée ; la probabilité d'absorption
+//de v dans la classe c devient h(v, c) + absorb_weight[v] absorb_change[c] (N et partition.num_classes cases, nulles si
+//from est persistant). Chacun peut valoir NULL. Retourne MARKOV_ERR_ARGUMENT si un sommet est invalide, si P(from, to) + delta
+//sort de ]0, 1[, si from n'a pas d'autre transition, ou si from est persistant et to hors de sa classe : ces modifications
+//changent les classes, il faut relancer l'analyse (markov_apply_delta).
+t_markov_status sensitivity_apply(t_sensitivity *s, t_perturbation perturbation, double *stationary,
+                                  double *absorb_weight, double *absorb_change);
+
+//Évalue count modifications indépendantes (chacune appliquée seule à la chaîne de base) sur num_threads threads
+//(0 = nombre de coeurs) : les lignes et colonnes nécessaires sont d'abord résolues en parallèle, puis chaque effet.
+//Retourne MARKOV_ERR_NOMEM si la mémoire manque ; le statut de chaque modification est dans effects[m].status.
+t_markov_status sensitivity_batch(t_sensitivity *s, const t_perturbation *perturbations, int count, int num_threads,
+                                  t_whatif_effect *effects);
+
+//Dérivée de pi(target) par rapport à chaque transition, au sens de la modification ci-dessus : out[e] pour l'arête e de
+//ctx->P (E cases), 0 hors de la classe de target ou si la transition est la seule de son état. Une seule résolution.
+t_markov_status sensitivity_stationary_gradient(t_sensitivity *s, int target, double *out);
+
+//Dérivée de la probabilité d'absorption de target dans la classe persistante class_id (1-based) par rapport à chaque
+//transition (out : E cases, 0 pour les transitions des états persistants). Une seule résolution.
+t_markov_status sensitivity_absorption_gradient(t_sensitivity *s, int target, int class_id, double *out);
+
+//Range dans edges (count cases au plus) les arêtes de plus grande dérivée en valeur absolue, par ordre décroissant,
+//en ignorant les dérivées nulles. Retourne le nombre d'arêtes rangées.
+int sensitivity_top_edges(const double *gradient, int num_edges, int count, int *edges);
+
+#endif // SENSITIVITY_H
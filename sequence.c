@@ -0,0 +1,243 @@
+#include "sequence.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "markov.h"
+
+/*
+   relabel_csr :
+   Matrice P renumérotée : l'état i devient id[i] (0-based), lignes et colonnes.
+   Tri par dénombrement des lignes selon leur nouveau numéro ; chaque ligne garde
+   l'ordre de ses arêtes. row_ptr vaut NULL si la mémoire manque.
+*/
+static t_csr relabel_csr(const t_csr *P, const int *id) {
+    t_csr R = {0, 0, NULL, NULL, NULL};
+    int N = P->num_vertices;
+    int E = P->num_edges;
+
+    R.row_ptr = (int *)calloc(N + 1, sizeof(int));
+    R.col_idx = (int *)malloc((E > 0 ? E : 1) * sizeof(int));
+    R.values = (float *)malloc((E > 0 ? E : 1) * sizeof(float));
+    if (R.row_ptr == NULL || R.col_idx == NULL || R.values == NULL) {
+        perror("Allocation failed for relabeled CSR");
+        free_csr(R);
+        return (t_csr){0, 0, NULL, NULL, NULL};
+    }
+    R.num_vertices = N;
+    R.num_edges = E;
+
+    for (int i = 0; i < N; i++) R.row_ptr[id[i] + 1] = P->row_ptr[i + 1] - P->row_ptr[i];
+    for (int i = 0; i < N; i++) R.row_ptr[i + 1] += R.row_ptr[i];
+    for (int i = 0; i < N; i++) {
+        int pos = R.row_ptr[id[i]];
+        for (int e = P->row_ptr[i]; e < P->row_ptr[i + 1]; e++, pos++) {
+            R.col_idx[pos] = id[P->col_idx[e]];
+            R.values[pos] = P->values[e];
+        }
+    }
+    return R;
+}
+
+/*
+   add_step :
+   Matrice creuse du fichier lu dans ctx, rangée en k-ième position. Les étiquettes
+   d'un fichier étiqueté sont cherchées dans celles du premier fichier : les mêmes
+   nombres d'états et des étiquettes toutes trouvées font une bijection.
+*/
+static t_markov_status add_step(t_chain_sequence *seq, const t_markov_ctx *ctx, int k) {
+    t_csr P = graph_to_csr(ctx->graph);
+    if (P.row_ptr == NULL) return MARKOV_ERR_NOMEM;
+    if (ctx->labels.count == 0) {
+        seq->steps[k] = P;
+        seq->num_edges += P.num_edges;
+        return MARKOV_OK;
+    }
+
+    int N = ctx->num_vertices;
+    int *id = (int *)malloc(N * sizeof(int));
+    if (id == NULL) {
+        perror("Allocation failed for sequence relabeling");
+        free_csr(P);
+        return MARKOV_ERR_NOMEM;
+    }
+    t_markov_status status = MARKOV_OK;
+    for (int v = 1; v <= N && status == MARKOV_OK; v++) {
+        id[v - 1] = label_find(&seq->labels, label_name(&ctx->labels, v)) - 1;
+        if (id[v - 1] < 0) status = MARKOV_ERR_FORMAT;
+    }
+    if (status == MARKOV_OK) {
+        seq->steps[k] = relabel_csr(&P, id);
+        if (seq->steps[k].row_ptr == NULL) status = MARKOV_ERR_NOMEM;
+        else seq->num_edges += P.num_edges;
+    }
+    free(id);
+    free_csr(P);
+    return status;
+}
+
+/*
+   sequence_load :
+   Chaque fichier passe par un contexte libmarkov (lecture, vérification de Markov),
+   dont seule la matrice creuse est gardée. Les étiquettes du premier fichier sont
+   reprises au contexte avant qu'il ne soit réutilisé.
+*/
+t_markov_status sequence_load(t_chain_sequence *seq, char **paths, int count, int *failed) {
+    memset(seq, 0, sizeof(*seq));
+    label_table_init(&seq->labels);
+    *failed = -1;
+    if (paths == NULL || count <= 0) return MARKOV_ERR_ARGUMENT;
+
+    seq->steps = (t_csr *)calloc(count, sizeof(t_csr));
+    if (seq->steps == NULL) {
+        perror("Allocation failed for sequence steps");
+        return MARKOV_ERR_NOMEM;
+    }
+
+    t_markov_ctx ctx;
+    markov_init(&ctx);
+    t_markov_status status = MARKOV_OK;
+    for (int k = 0; k < count && status == MARKOV_OK; k++) {
+        status = markov_load_file(&ctx, paths[k]);
+        if (status == MARKOV_OK) status = markov_check(&ctx);
+        if (status == MARKOV_OK && k == 0) {
+            seq->num_vertices = ctx.num_vertices;
+            seq->labels = ctx.labels;
+            label_table_init(&ctx.labels);
+        } else if (status == MARKOV_OK
+                   && (ctx.num_vertices != seq->num_vertices || (ctx.labels.count > 0) != (seq->labels.count > 0))) {
+            status = MARKOV_ERR_FORMAT;
+        }
+        if (status == MARKOV_OK) status = add_step(seq, &ctx, k);
+        if (status == MARKOV_OK) seq->num_steps++;
+        else *failed = k;
+    }
+    markov_free(&ctx);
+
+    if (status != MARKOV_OK) sequence_free(seq);
+    return status;
+}
+
+void sequence_free(t_chain_sequence *seq) {
+    for (int k = 0; k < seq->num_steps; k++) free_csr(seq->steps[k]);
+    free(seq->steps);
+    label_table_free(&seq->labels);
+    memset(seq, 0, sizeof(*seq));
+    label_table_init(&seq->labels);
+}
+
+int sequence_find_state(const t_chain_sequence *seq, const char *label) {
+    if (label == NULL) return 0;
+    if (seq->labels.count > 0) return label_find(&seq->labels, label);
+
+    char *end;
+    long v = strtol(label, &end, 10);
+    return (end != label && *end == '\0' && v >= 1 && v <= seq->num_vertices) ? (int)v : 0;
+}
+
+/*
+   sequence_apply :
+   T produits par cycle, en alternant X et un tampon ; le résultat est recopié dans
+   X s'il a fini dans le tampon.
+*/
+int sequence_apply(const t_chain_sequence *seq, double *X, int B, int cycles) {
+    size_t size = (size_t)seq->num_vertices * B;
+    double *tmp = (double *)malloc((size > 0 ? size : 1) * sizeof(double));
+    if (tmp == NULL) {
+        perror("Allocation failed for sequence block");
+        return -1;
+    }
+
+    double *cur = X, *next = tmp;
+    for (int c = 0; c < cycles; c++) {
+        for (int t = 0; t < seq->num_steps; t++) {
+            csr_block_step(&seq->steps[t], cur, next, B);
+            double *swap = cur;
+            cur = next;
+            next = swap;
+        }
+    }
+    if (cur != X) memcpy(X, cur, size * sizeof(double));
+
+    free(tmp);
+    return 0;
+}
+
+/*
+   sequence_periodic_state :
+   À chaque cycle, Y = X P_1 ... P_T (deux tampons), puis X devient (X + Y) / 2,
+   chaque vecteur étant ramené à une masse de 1.
+   Tout le bloc avance jusqu'à ce que chacun de ses vecteurs ait convergé. Les
+   phases sont ensuite obtenues en appliquant une fois P_1 ... P_(T-1) à pi_0, et
+   recopiées colonne par colonne au fil des produits.
+*/
+int sequence_periodic_state(const t_chain_sequence *seq, double *X, int B, double *phases, double epsilon, int max_cycles,
+                            double *diff) {
+    int N = seq->num_vertices;
+    size_t size = (size_t)N * B;
+    double *buffers[2];
+    buffers[0] = (double *)malloc((size > 0 ? size : 1) * sizeof(double));
+    buffers[1] = (double *)malloc((size > 0 ? size : 1) * sizeof(double));
+    double *column_diff = (double *)malloc(2 * B * sizeof(double));
+    if (buffers[0] == NULL || buffers[1] == NULL || column_diff == NULL) {
+        perror("Allocation failed for periodic state buffers");
+        free(buffers[0]);
+        free(buffers[1]);
+        free(column_diff);
+        return -1;
+    }
+    double *column_total = column_diff + B;
+
+    int cycle;
+    *diff = 0.0;
+    for (cycle = 1; cycle <= max_cycles; cycle++) {
+        const double *cur = X;
+        for (int t = 0; t < seq->num_steps; t++) {
+            csr_block_step(&seq->steps[t], cur, buffers[t % 2], B);
+            cur = buffers[t % 2];
+        }
+
+        // Les lignes ne somment à 1 qu'à TOLERANCE près : chaque vecteur est renormalisé pour que sa masse ne dérive pas
+        memset(column_total, 0, B * sizeof(double));
+        for (int i = 0; i < N; i++) {
+            const double *xi = X + (size_t)i * B;
+            const double *yi = cur + (size_t)i * B;
+            for (int b = 0; b < B; b++) column_total[b] += xi[b] + yi[b];
+        }
+        for (int b = 0; b < B; b++) column_total[b] = (column_total[b] > 0.0) ? 1.0 / column_total[b] : 0.5;
+
+        memset(column_diff, 0, B * sizeof(double));
+        for (int i = 0; i < N; i++) {
+            double *xi = X + (size_t)i * B;
+            const double *yi = cur + (size_t)i * B;
+            for (int b = 0; b < B; b++) {
+                double value = (xi[b] + yi[b]) * column_total[b];
+                column_diff[b] += fabs(value - xi[b]);
+                xi[b] = value;
+            }
+        }
+        *diff = 0.0;
+        for (int b = 0; b < B; b++) {
+            if (column_diff[b] > *diff) *diff = column_diff[b];
+        }
+        if (*diff < epsilon) break;
+    }
+
+    if (phases != NULL) {
+        const double *cur = X;
+        for (int t = 0; t < seq->num_steps; t++) {
+            if (t > 0) {
+                csr_block_step(&seq->steps[t - 1], cur, buffers[t % 2], B);
+                cur = buffers[t % 2];
+            }
+            for (int b = 0; b < B; b++) {
+                double *column = phases + ((size_t)t * B + b) * N;
+                for (int i = 0; i < N; i++) column[i] = cur[(size_t)i * B + b];
+            }
+        }
+    }
+
+    free(buffers[0]);
+    free(buffers[1]);
+    free(column_diff);
+    return (cycle > max_cycles) ? max_cycles : cycle;
+}
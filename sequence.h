@@ -0,0 +1,57 @@
+#ifndef SEQUENCE_H
+#define SEQUENCE_H
+
+#include "sparse.h"
+#include "labels.h"
+#include "markov_status.h"
+
+/*
+   Chaînes inhomogènes dans le temps : une suite P_1, ..., P_T de matrices de transition
+   sur les mêmes états (une par heure de la journée, par exemple), appliquées l'une après
+   l'autre. Un cycle est le passage par toutes les matrices : x -> x P_1 P_2 ... P_T.
+   - Le produit P_1 ... P_T n'est jamais formé (il serait dense) : chaque cycle enchaîne
+     T produits vecteur-matrice creux, en O(T N + somme des arêtes).
+   - Plusieurs vecteurs de départ avancent ensemble : un bloc de B vecteurs est rangé
+     état par état (les B masses d'un état à la suite), et chaque arête de P_t sert aux B
+     vecteurs pendant qu'elle est en cache (csr_block_step).
+   - Régime périodique : pi_0 = pi_0 P_1 ... P_T est la distribution stationnaire du
+     cycle, et pi_t = pi_(t-1) P_t celle du début de la phase t + 1. pi_0 est obtenue
+     par itération de la chaîne paresseuse x -> (x + x P_1 ... P_T) / 2, qui a les mêmes
+     points fixes et converge même si le cycle est périodique ; partant d'un état, la
+     limite est la moyenne de Cesàro de ses distributions après k cycles.
+   Les fichiers étiquetés sont renumérotés comme le premier fichier de la suite : ils
+   doivent nommer les mêmes états.
+*/
+
+//Cycles au plus pour atteindre le régime périodique.
+#define SEQUENCE_MAX_CYCLES 100000
+
+//Suite de matrices de transition sur les mêmes états.
+typedef struct s_chain_sequence {
+    int num_steps;          // Nombre de matrices T
+    int num_vertices;       // Nombre d'états N
+    long long num_edges;    // Somme des arêtes des T matrices
+    t_csr *steps;           // P_1 ... P_T, états numérotés comme dans le premier fichier
+    t_label_table labels;   // Étiquettes du premier fichier (vide si les fichiers numérotent leurs états)
+} t_chain_sequence;
+
+//Charge les count fichiers de paths (chacun lu et vérifié comme par markov_load_file et markov_check). En cas d'erreur,
+//failed reçoit l'indice du fichier fautif ; MARKOV_ERR_FORMAT si les fichiers n'ont pas les mêmes états.
+t_markov_status sequence_load(t_chain_sequence *seq, char **paths, int count, int *failed);
+
+//Libère la suite (qui redevient vide).
+void sequence_free(t_chain_sequence *seq);
+
+//Numéro (1..N) de l'état d'étiquette label (de numéro label si les fichiers numérotent leurs états), 0 s'il n'existe pas.
+int sequence_find_state(const t_chain_sequence *seq, const char *label);
+
+//Avance un bloc de B vecteurs (X, N x B rangé état par état) de cycles cycles complets. Retourne 0, ou -1 si la mémoire manque.
+int sequence_apply(const t_chain_sequence *seq, double *X, int B, int cycles);
+
+//Régime périodique partant du bloc X (N x B) : X reçoit pi_0 pour chaque vecteur, et phases (NULL, ou tableau N x (T B)
+//rangé colonne par colonne, comme mtx_write_array) les distributions au début de chaque phase : colonne t B + b = pi_t du
+//vecteur b. diff reçoit le plus grand écart sum(|x_k - x_(k-1)|) du dernier cycle (convergence si diff < epsilon). Retourne le nombre de cycles faits, -1 si la mémoire manque.
+int sequence_periodic_state(const t_chain_sequence *seq, double *X, int B, double *phases, double epsilon, int max_cycles,
+                            double *diff);
+
+#endif // SEQUENCE_H
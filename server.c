@@ -0,0 +1,564 @@
+#include "server.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "cache.h"
+
+/*
+   init_registry :
+   Prépare un registre vide et son verrou lecteurs/écrivain.
+*/
+void init_registry(t_chain_registry *registry) {
+    registry->models = NULL;
+    registry->count = 0;
+    registry->capacity = 0;
+    registry->cache_dir = NULL;
+    pthread_rwlock_init(&registry->lock, NULL);
+}
+
+/*
+   free_chain_model :
+   Libère une chaîne chargée et tous ses résultats.
+*/
+static void free_chain_model(t_chain_model *model) {
+    if (model == NULL) return;
+    if (model->sensitivity_ready) sensitivity_free(&model->sensitivity);
+    pthread_mutex_destroy(&model->sensitivity_lock);
+    markov_free(&model->ctx);
+    free(model);
+}
+
+/*
+   free_registry :
+   Libère toutes les chaînes chargées puis détruit le verrou.
+*/
+void free_registry(t_chain_registry *registry) {
+    for (int i = 0; i < registry->count; i++) free_chain_model(registry->models[i]);
+    free(registry->models);
+    registry->models = NULL;
+    registry->count = 0;
+    registry->capacity = 0;
+    pthread_rwlock_destroy(&registry->lock);
+}
+
+/*
+   build_chain_model :
+   Lit et analyse une chaîne une seule fois avec la bibliothèque (markov_analyze,
+   ou markov_analyze_cached si le registre a un cache) :
+   classes, liens de Hasse, distributions stationnaires, périodes et absorption,
+   le tout en creux (jamais de matrice N x N) pour que les grosses chaînes tiennent
+   en mémoire, puis l'index d'accessibilité entre classes (markov_build_reach) : s'il
+   ne tient pas en mémoire, la chaîne est gardée et seules les requêtes reach et
+   reachable sont refusées. La liste d'adjacence est ensuite libérée : le CSR suffit aux requêtes.
+   Retourne NULL si le fichier est illisible ou n'est pas un graphe de Markov.
+*/
+static t_chain_model *build_chain_model(const char *path, const char *cache_dir) {
+    t_chain_model *model = (t_chain_model *)calloc(1, sizeof(t_chain_model));
+    if (model == NULL) {
+        perror("Allocation failed for chain model");
+        return NULL;
+    }
+    markov_init(&model->ctx);
+    pthread_mutex_init(&model->sensitivity_lock, NULL);
+
+    t_markov_status status = markov_load_file(&model->ctx, path);
+    if (status == MARKOV_OK) status = markov_analyze_cached(&model->ctx, cache_dir, NULL);
+    if (status != MARKOV_OK) {
+        fprintf(stderr, "Error: %s: %s.\n", path, markov_status_string(status));
+        free_chain_model(model);
+        return NULL;
+    }
+    if (markov_build_reach(&model->ctx) != MARKOV_OK) {
+        fprintf(stderr, "Warning: %s: reachability index not built.\n", path);
+    }
+    markov_release_graph(&model->ctx);
+
+    // Nom de la chaîne : fichier sans dossier ni extension
+    const char *name = strrchr(path, '/');
+    name = (name != NULL) ? name + 1 : path;
+    strncpy(model->name, name, SERVER_MAX_NAME - 1);
+    char *dot = strrchr(model->name, '.');
+    if (dot) *dot = '\0';
+
+    return model;
+}
+
+/*
+   registry_load_chain :
+   L'analyse se fait hors verrou ; seul l'ajout au registre prend le verrou en écriture,
+   les requêtes en cours sur les autres chaînes ne sont donc bloquées qu'un instant.
+*/
+int registry_load_chain(t_chain_registry *registry, const char *path) {
+    t_chain_model *model = build_chain_model(path, registry->cache_dir);
+    if (model == NULL) return -1;
+
+    pthread_rwlock_wrlock(&registry->lock);
+    if (registry->count == registry->capacity) {
+        int new_capacity = (registry->capacity == 0) ? 4 : registry->capacity * 2;
+        t_chain_model **tmp = (t_chain_model **)realloc(registry->models, new_capacity * sizeof(t_chain_model *));
+        if (tmp == NULL) {
+            pthread_rwlock_unlock(&registry->lock);
+            perror("Realloc failed for chain registry");
+            free_chain_model(model);
+            return -1;
+        }
+        registry->models = tmp;
+        registry->capacity = new_capacity;
+    }
+    registry->models[registry->count++] = model;
+    pthread_rwlock_unlock(&registry->lock);
+    return 0;
+}
+
+//Recherche une chaîne par nom (le verrou en lecture doit être pris).
+static t_chain_model *find_model(t_chain_registry *registry, const char *name) {
+    for (int i = 0; i < registry->count; i++) {
+        if (strcmp(registry->models[i]->name, name) == 0) return registry->models[i];
+    }
+    return NULL;
+}
+
+/*
+   parse_state :
+   Lit un état dans le protocole : numéro (1..N), ou étiquette pour une chaîne lue
+   dans un fichier étiqueté. Retourne 0 si l'état est absent ou inconnu.
+*/
+static int parse_state(const char *token, const t_markov_ctx *ctx) {
+    if (token == NULL) return 0;
+    int v = markov_find_state(ctx, token);
+    return (v > 0) ? markov_internal_id(ctx, v) : 0;
+}
+
+//Réponse à un état refusé par parse_state : numéros 1..N, ou étiquettes pour une chaîne étiquetée.
+static void answer_invalid_state(FILE *out, const t_markov_ctx *ctx, const char *what) {
+    if (ctx->labels.count > 0) {
+        fprintf(out, "ERR %s invalide (attendu une des %d etiquettes de la chaine, ex. %s)\n", what, ctx->labels.count,
+                markov_state_label(ctx, 1));
+    } else {
+        fprintf(out, "ERR %s invalide (attendu 1..%d)\n", what, ctx->num_vertices);
+    }
+}
+
+/*
+   answer_whatif :
+   whatif CH I J D : effet de P(I, J) += D (sensitivity_apply), calculé sous le verrou
+   de la chaîne ; les lignes et colonnes résolues restent pour les requêtes suivantes.
+*/
+static void answer_whatif(t_chain_model *model, int from, char **tokens, int num_tokens, FILE *out) {
+    const t_markov_ctx *ctx = &model->ctx;
+    int to = parse_state(num_tokens > 3 ? tokens[3] : NULL, ctx);
+    char *end = NULL;
+    double delta = (num_tokens > 4) ? strtod(tokens[4], &end) : 0.0;
+    if (to == 0 || end == NULL || end == tokens[4] || *end != '\0') {
+        fprintf(out, "ERR attendu : whatif CH I J DELTA\n");
+        return;
+    }
+
+    t_perturbation perturbation = {from, to, delta};
+    int N = ctx->num_vertices;
+    double *stationary = (double *)malloc(3 * (size_t)N * sizeof(double));
+    double *weight = stationary + N;     // Correction d'absorption : h'(v, c) = h(v, c) + weight[v] change[c]
+    double *h = stationary + 2 * (size_t)N;
+    double *change = (double *)malloc(ctx->partition.num_classes * sizeof(double));
+    t_markov_status status = (stationary != NULL && change != NULL) ? MARKOV_OK : MARKOV_ERR_NOMEM;
+    if (status == MARKOV_OK) {
+        pthread_mutex_lock(&model->sensitivity_lock);
+        if (!model->sensitivity_ready) {
+            status = sensitivity_init(&model->sensitivity, ctx);
+            model->sensitivity_ready = (status == MARKOV_OK);
+        }
+        if (status == MARKOV_OK) status = sensitivity_apply(&model->sensitivity, perturbation, stationary, weight, change);
+        pthread_mutex_unlock(&model->sensitivity_lock);
+    }
+
+    if (status == MARKOV_ERR_ARGUMENT) {
+        fprintf(out, "ERR modification refusee (classes modifiees ou probabilite hors de ]0, 1[)\n");
+    } else if (status != MARKOV_OK) {
+        fprintf(out, "ERR %s\n", markov_status_string(status));
+    } else {
+        // Valeurs modifiées seulement : pi de la classe de départ, ou absorption des états transitoires (classe par classe)
+        fprintf(out, "OK");
+        for (int j = 0; j < N; j++) {
+            if (stationary[j] == ctx->stationary[j]) continue;
+            const char *label = markov_state_label(ctx, markov_original_id(ctx, j + 1));
+            if (label != NULL) fprintf(out, " %s:%.10g", label, stationary[j]);
+            else fprintf(out, " %d:%.10g", markov_original_id(ctx, j + 1), stationary[j]);
+        }
+        for (int c = 0; c < ctx->partition.num_classes && status == MARKOV_OK; c++) {
+            if (change[c] == 0.0) continue;
+            status = markov_absorption_column(ctx, c + 1, h);
+            for (int j = 0; j < N && status == MARKOV_OK; j++) {
+                double value = h[j] + weight[j] * change[c];
+                if (value == h[j]) continue;
+                const char *label = markov_state_label(ctx, markov_original_id(ctx, j + 1));
+                if (label != NULL) fprintf(out, " %s>C%d:%.10g", label, c + 1, value);
+                else fprintf(out, " %d>C%d:%.10g", markov_original_id(ctx, j + 1), c + 1, value);
+            }
+        }
+        fprintf(out, "\n");
+    }
+    free(stationary);
+    free(change);
+}
+
+/*
+   answer_gradient :
+   gradient CH V : dérivées de pi(V) ; gradient CH V C : dérivées de l'absorption de V
+   (transitoire) dans C. Répond par les SERVER_GRADIENT_EDGES plus grandes, "I->J:dérivée".
+*/
+static void answer_gradient(t_chain_model *model, int v, char **tokens, int num_tokens, FILE *out) {
+    const t_markov_ctx *ctx = &model->ctx;
+    const t_csr *P = &ctx->P;
+    if (num_tokens <= 3 && ctx->persistent_index[ctx->partition.v_data[v - 1].class_id - 1] < 0) {
+        fprintf(out, "ERR etat transitoire : preciser la classe d'absorption (gradient CH V C)\n");
+        return;
+    }
+    double *gradient = (double *)malloc((P->num_edges + 1) * sizeof(double));
+    if (gradient == NULL) {
+        fprintf(out, "ERR memoire insuffisante\n");
+        return;
+    }
+
+    t_markov_status status = MARKOV_OK;
+    pthread_mutex_lock(&model->sensitivity_lock);
+    if (!model->sensitivity_ready) {
+        status = sensitivity_init(&model->sensitivity, ctx);
+        model->sensitivity_ready = (status == MARKOV_OK);
+    }
+    if (status == MARKOV_OK && num_tokens > 3) {
+        int target = atoi(tokens[3][0] == 'C' ? tokens[3] + 1 : tokens[3]);
+        status = sensitivity_absorption_gradient(&model->sensitivity, v, target, gradient);
+    } else if (status == MARKOV_OK) {
+        status = sensitivity_stationary_gradient(&model->sensitivity, v, gradient);
+    }
+    pthread_mutex_unlock(&model->sensitivity_lock);
+
+    if (status == MARKOV_ERR_ARGUMENT) {
+        fprintf(out, "ERR classe invalide (attendu une classe persistante parmi C1..C%d)\n", ctx->partition.num_classes);
+    } else if (status != MARKOV_OK) {
+        fprintf(out, "ERR %s\n", markov_status_string(status));
+    } else {
+        int edges[SERVER_GRADIENT_EDGES];
+        int found = sensitivity_top_edges(gradient, P->num_edges, SERVER_GRADIENT_EDGES, edges);
+        fprintf(out, "OK");
+        for (int k = 0; k < found; k++) {
+            int from = 0;
+            while (P->row_ptr[from + 1] <= edges[k]) from++;
+            int ends[2] = {markov_original_id(ctx, from + 1), markov_original_id(ctx, P->col_idx[edges[k]] + 1)};
+            for (int side = 0; side < 2; side++) {
+                const char *label = markov_state_label(ctx, ends[side]);
+                if (label != NULL) fprintf(out, "%s%s", side ? "->" : " ", label);
+                else fprintf(out, "%s%d", side ? "->" : " ", ends[side]);
+            }
+            fprintf(out, ":%.10g", gradient[edges[k]]);
+        }
+        fprintf(out, "\n");
+    }
+    free(gradient);
+}
+
+/*
+   answer_query :
+   Répond à une requête portant sur une chaîne déjà chargée. tokens[0] est la commande,
+   tokens[1] le nom de la chaîne, les suivants ses arguments.
+*/
+static void answer_query(t_chain_model *model, char **tokens, int num_tokens, FILE *out) {
+    const t_markov_ctx *ctx = &model->ctx;
+    const char *cmd = tokens[0];
+    int N = ctx->num_vertices;
+    double value;
+
+    if (strcmp(cmd, "info") == 0) {
+        fprintf(out, "OK sommets=%d aretes=%d classes=%d persistantes=%d liens=%d index_acces=%lld\n",
+                N, ctx->P.num_edges, ctx->partition.num_classes, ctx->num_persistent,
+                ctx->hasse_links ? ctx->hasse_links->size : 0, reach_index_bytes(&ctx->reach));
+        return;
+    }
+
+    int v = parse_state(num_tokens > 2 ? tokens[2] : NULL, ctx);
+    if (v == 0) {
+        answer_invalid_state(out, ctx, "sommet");
+        return;
+    }
+    int class_id;
+    markov_vertex_class(ctx, v, &class_id);
+    t_class c = ctx->partition.classes[class_id - 1];
+
+    if (strcmp(cmd, "class") == 0) {
+        fprintf(out, "OK C%d %s taille=%d periode=%d\n", c.id,
+                c.is_persistent ? "persistante" : "transitoire", c.num_members, ctx->periods[class_id - 1]);
+
+    } else if (strcmp(cmd, "stationary") == 0) {
+        markov_stationary(ctx, v, &value);
+        fprintf(out, "OK %.10g\n", value);
+
+    } else if (strcmp(cmd, "limit") == 0) {
+        int j = parse_state(num_tokens > 3 ? tokens[3] : NULL, ctx);
+        if (j == 0) {
+            answer_invalid_state(out, ctx, "sommet d'arrivee");
+            return;
+        }
+        markov_limit(ctx, v, j, &value);
+        fprintf(out, "OK %.10g\n", value);
+
+    } else if (strcmp(cmd, "absorb") == 0) {
+        if (num_tokens > 3) {
+            // absorb CHAINE V C : probabilité d'absorption dans la classe C
+            int target = atoi(tokens[3][0] == 'C' ? tokens[3] + 1 : tokens[3]);
+            if (markov_absorption(ctx, v, target, &value) != MARKOV_OK) {
+                fprintf(out, "ERR classe invalide (attendu C1..C%d)\n", ctx->partition.num_classes);
+                return;
+            }
+            fprintf(out, "OK %.10g\n", value);
+            return;
+        }
+        double *class_mass = (double *)malloc(ctx->partition.num_classes * sizeof(double));
+        if (class_mass == NULL || markov_absorption_row(ctx, v, class_mass) != MARKOV_OK) {
+            fprintf(out, "ERR memoire insuffisante\n");
+            free(class_mass);
+            return;
+        }
+        fprintf(out, "OK");
+        for (int i = 0; i < ctx->partition.num_classes; i++) {
+            if (class_mass[i] > 0.0) fprintf(out, " C%d:%.10g", i + 1, class_mass[i]);
+        }
+        fprintf(out, "\n");
+        free(class_mass);
+
+    } else if (strcmp(cmd, "kstep") == 0) {
+        int k = (num_tokens > 3) ? atoi(tokens[3]) : -1;
+        if (k < 0) {
+            fprintf(out, "ERR nombre d'etapes invalide\n");
+            return;
+        }
+        double *x0 = (double *)calloc(N, sizeof(double));
+        double *xk = (double *)malloc(N * sizeof(double));
+        if (x0 == NULL || xk == NULL) {
+            free(x0);
+            free(xk);
+            fprintf(out, "ERR memoire insuffisante\n");
+            return;
+        }
+        x0[v - 1] = 1.0;
+        t_markov_status status = markov_k_step(ctx, x0, k, xk);
+
+        if (status != MARKOV_OK) {
+            fprintf(out, "ERR %s\n", markov_status_string(status));
+        } else {
+            fprintf(out, "OK");
+            for (int j = 0; j < N; j++) {
+                if (xk[j] <= 0.0) continue;
+                const char *label = markov_state_label(ctx, markov_original_id(ctx, j + 1));
+                if (label != NULL) fprintf(out, " %s:%.10g", label, xk[j]);
+                else fprintf(out, " %d:%.10g", markov_original_id(ctx, j + 1), xk[j]);
+            }
+            fprintf(out, "\n");
+        }
+        free(x0);
+        free(xk);
+
+    } else if (strcmp(cmd, "reach") == 0) {
+        int j = parse_state(num_tokens > 3 ? tokens[3] : NULL, ctx);
+        if (j == 0) {
+            answer_invalid_state(out, ctx, "sommet d'arrivee");
+            return;
+        }
+        int reachable;
+        t_markov_status status = markov_reachable(ctx, v, j, &reachable);
+        if (status != MARKOV_OK) fprintf(out, "ERR %s\n", markov_status_string(status));
+        else fprintf(out, "OK %d\n", reachable);
+
+    } else if (strcmp(cmd, "reachable") == 0) {
+        // Classes persistantes où la chaîne partant de V peut finir
+        int *classes = (int *)malloc((ctx->reach.num_persistent + 1) * sizeof(int));
+        int count;
+        if (classes == NULL) {
+            fprintf(out, "ERR memoire insuffisante\n");
+            return;
+        }
+        t_markov_status status = markov_reachable_persistent(ctx, v, classes, &count);
+        if (status != MARKOV_OK) {
+            fprintf(out, "ERR %s\n", markov_status_string(status));
+        } else {
+            fprintf(out, "OK");
+            for (int k = 0; k < count; k++) fprintf(out, " C%d", classes[k]);
+            fprintf(out, "\n");
+        }
+        free(classes);
+
+    } else if (strcmp(cmd, "whatif") == 0) {
+        answer_whatif(model, v, tokens, num_tokens, out);
+
+    } else if (strcmp(cmd, "gradient") == 0) {
+        answer_gradient(model, v, tokens, num_tokens, out);
+
+    } else {
+        fprintf(out, "ERR commande inconnue : %s\n", cmd);
+    }
+}
+
+/*
+   server_handle_query :
+   Découpe la ligne en mots et la traite. Commandes :
+     list | quit | info CH | class CH V | stationary CH V | limit CH I J
+     absorb CH V [C] | kstep CH V K | whatif CH I J D | gradient CH V [C]
+     reach CH I J | reachable CH V
+   Les sommets sont désignés comme dans les fichiers d'entrée : numéros 1 à N,
+   ou étiquettes pour une chaîne lue dans un fichier étiqueté (parse_state).
+*/
+int server_handle_query(t_chain_registry *registry, const char *line, FILE *out) {
+    char buffer[SERVER_MAX_LINE];
+    char *tokens[8];
+    int num_tokens = 0;
+
+    strncpy(buffer, line, SERVER_MAX_LINE - 1);
+    buffer[SERVER_MAX_LINE - 1] = '\0';
+    for (char *tok = strtok(buffer, " \t\r\n"); tok != NULL && num_tokens < 8; tok = strtok(NULL, " \t\r\n")) {
+        tokens[num_tokens++] = tok;
+    }
+    if (num_tokens == 0) return 0;
+
+    if (strcmp(tokens[0], "quit") == 0) {
+        fprintf(out, "OK bye\n");
+        return 1;
+    }
+
+    pthread_rwlock_rdlock(&registry->lock);
+    if (strcmp(tokens[0], "list") == 0) {
+        fprintf(out, "OK %d", registry->count);
+        for (int i = 0; i < registry->count; i++) fprintf(out, " %s", registry->models[i]->name);
+        fprintf(out, "\n");
+    } else if (num_tokens < 2) {
+        fprintf(out, "ERR chaine manquante\n");
+    } else {
+        t_chain_model *model = find_model(registry, tokens[1]);
+        if (model == NULL) fprintf(out, "ERR chaine inconnue : %s\n", tokens[1]);
+        else answer_query(model, tokens, num_tokens, out);
+    }
+    pthread_rwlock_unlock(&registry->lock);
+    return 0;
+}
+
+/*
+   serve_stream :
+   Boucle d'une session : une requête par ligne, une réponse par ligne,
+   vidée immédiatement pour que le client puisse enchaîner les requêtes.
+*/
+void serve_stream(t_chain_registry *registry, FILE *in, FILE *out) {
+    char line[SERVER_MAX_LINE];
+
+    while (fgets(line, sizeof(line), in) != NULL) {
+        int stop = server_handle_query(registry, line, out);
+        fflush(out);
+        if (stop) break;
+    }
+}
+
+//Session d'un client connecté sur la socket.
+typedef struct s_client_session {
+    t_chain_registry *registry;
+    int fd;
+} t_client_session;
+
+/*
+   client_thread :
+   Un thread par client : les lecteurs concurrents ne se bloquent pas entre eux
+   (verrou en lecture partagé sur le registre).
+*/
+static void *client_thread(void *arg) {
+    t_client_session *session = (t_client_session *)arg;
+    int write_fd = dup(session->fd);
+    FILE *in = fdopen(session->fd, "r");
+    FILE *out = (write_fd >= 0) ? fdopen(write_fd, "w") : NULL;
+
+    if (in != NULL && out != NULL) {
+        serve_stream(session->registry, in, out);
+    }
+    if (in != NULL) fclose(in); else close(session->fd);
+    if (out != NULL) fclose(out); else if (write_fd >= 0) close(write_fd);
+    free(session);
+    return NULL;
+}
+
+static volatile sig_atomic_t server_stop_requested = 0;
+
+static void handle_stop_signal(int signum) {
+    (void)signum;
+    server_stop_requested = 1;
+}
+
+/*
+   serve_unix_socket :
+   Crée la socket, puis accepte les clients jusqu'à SIGINT/SIGTERM.
+   Le gestionnaire de signal est installé sans SA_RESTART : accept est interrompu,
+   la boucle s'arrête et le fichier de la socket est supprimé.
+*/
+int serve_unix_socket(t_chain_registry *registry, const char *socket_path) {
+    struct sockaddr_un addr;
+    struct sigaction action;
+
+    if (strlen(socket_path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Error: socket path too long: %s\n", socket_path);
+        return EXIT_FAILURE;
+    }
+
+    int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0) {
+        perror("Could not create socket");
+        return EXIT_FAILURE;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, socket_path);
+    unlink(socket_path);
+
+    if (bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(listen_fd, 64) != 0) {
+        perror("Could not bind socket");
+        close(listen_fd);
+        return EXIT_FAILURE;
+    }
+
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = handle_stop_signal;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    signal(SIGPIPE, SIG_IGN); // Un client qui se déconnecte ne doit pas tuer le serveur
+
+    printf("Serveur pret sur %s (%d chaine(s) chargee(s)).\n", socket_path, registry->count);
+    fflush(stdout);
+
+    while (!server_stop_requested) {
+        int client_fd = accept(listen_fd, NULL, NULL);
+        if (client_fd < 0) {
+            if (errno == EINTR) continue;
+            perror("accept failed");
+            break;
+        }
+
+        t_client_session *session = (t_client_session *)malloc(sizeof(t_client_session));
+        pthread_t thread;
+        if (session == NULL) {
+            close(client_fd);
+            continue;
+        }
+        session->registry = registry;
+        session->fd = client_fd;
+        if (pthread_create(&thread, NULL, client_thread, session) != 0) {
+            close(client_fd);
+            free(session);
+            continue;
+        }
+        pthread_detach(thread);
+    }
+
+    close(listen_fd);
+    unlink(socket_path);
+    printf("Serveur arrete.\n");
+    return EXIT_SUCCESS;
+}
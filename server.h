@@ -0,0 +1,50 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <stdio.h>
+#include <pthread.h>
+#include "markov.h"
+#include "sensitivity.h"
+
+#define SERVER_MAX_NAME 64
+#define SERVER_MAX_LINE 1024
+#define SERVER_GRADIENT_EDGES 10  // Transitions renvoyées par une requête gradient
+
+//Chaîne chargée une fois et gardée en mémoire par le serveur, avec tous ses résultats d'analyse.
+typedef struct s_chain_model {
+    char name[SERVER_MAX_NAME]; // Nom utilisé dans les requêtes (nom du fichier sans dossier ni extension)
+    t_markov_ctx ctx;           // Contexte entièrement analysé (markov_analyze), liste d'adjacence libérée
+    t_sensitivity sensitivity;  // Lignes et colonnes gardées par les requêtes whatif, préparé à la première
+    int sensitivity_ready;
+    pthread_mutex_t sensitivity_lock; // Une requête whatif ou gradient à la fois par chaîne
+} t_chain_model;
+
+//Ensemble des chaînes chargées. Les requêtes prennent le verrou en lecture, le chargement en écriture.
+typedef struct s_chain_registry {
+    t_chain_model **models;
+    int count;
+    int capacity;
+    const char *cache_dir;  // Cache des résultats (voir cache.h), NULL = pas de cache
+    pthread_rwlock_t lock;
+} t_chain_registry;
+
+//Initialise un registre vide.
+void init_registry(t_chain_registry *registry);
+
+//Libère toutes les chaînes et le registre.
+void free_registry(t_chain_registry *registry);
+
+//Charge et analyse une chaîne, puis l'ajoute au registre. Retourne 0 si succès, -1 sinon (message sur stderr).
+int registry_load_chain(t_chain_registry *registry, const char *path);
+
+//Traite une ligne du protocole et écrit une ligne de réponse ("OK ..." ou "ERR ...") dans out.
+//Retourne 1 si la session doit se terminer (commande quit), 0 sinon.
+int server_handle_query(t_chain_registry *registry, const char *line, FILE *out);
+
+//Sert les requêtes lues sur in jusqu'à la fin du flux ou "quit" (mode stdin).
+void serve_stream(t_chain_registry *registry, FILE *in, FILE *out);
+
+//Écoute sur une socket Unix et sert chaque client dans son propre thread. Retourne EXIT_SUCCESS/EXIT_FAILURE.
+int serve_unix_socket(t_chain_registry *registry, const char *socket_path);
+
+#endif // SERVER_H
@@ -0,0 +1,352 @@
+#include "small_chain.h"
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#include "markov_check.h"
+
+// Les noyaux génériques sont recopiés dans chaque version spécialisée : N y devient une constante
+#if defined(__GNUC__)
+#define SMALL_INLINE static inline __attribute__((always_inline))
+#else
+#define SMALL_INLINE static inline
+#endif
+
+/*
+   square_tile :
+   B = A * A pour SMALL_CHAIN_LANES chaînes : la case e de la voie l est A[e*LANES + l].
+   La boucle intérieure porte sur les voies, contiguës : une chaîne par voie SIMD.
+   Chaque ligne de B est ramenée à une somme de 1 : sans cela, l'erreur d'arrondi sur
+   la somme doublerait à chaque élévation au carré.
+*/
+SMALL_INLINE void square_tile(const double *restrict A, double *restrict B, int n) {
+    for (int i = 0; i < n; i++) {
+        double sum[SMALL_CHAIN_LANES] = {0};
+        for (int j = 0; j < n; j++) {
+            double acc[SMALL_CHAIN_LANES] = {0};
+            for (int k = 0; k < n; k++) {
+                const double *a = &A[(i * n + k) * SMALL_CHAIN_LANES];
+                const double *b = &A[(k * n + j) * SMALL_CHAIN_LANES];
+                for (int l = 0; l < SMALL_CHAIN_LANES; l++) acc[l] += a[l] * b[l];
+            }
+            for (int l = 0; l < SMALL_CHAIN_LANES; l++) sum[l] += acc[l];
+            memcpy(&B[(i * n + j) * SMALL_CHAIN_LANES], acc, sizeof(acc));
+        }
+        for (int j = 0; j < n; j++) {
+            double *b = &B[(i * n + j) * SMALL_CHAIN_LANES];
+            for (int l = 0; l < SMALL_CHAIN_LANES; l++) b[l] /= sum[l];
+        }
+    }
+}
+
+//Plus grand écart entre deux puissances, toutes voies confondues.
+SMALL_INLINE double max_diff_tile(const double *restrict A, const double *restrict B, int n) {
+    double diff[SMALL_CHAIN_LANES] = {0};
+    for (int e = 0; e < n * n; e++) {
+        for (int l = 0; l < SMALL_CHAIN_LANES; l++) {
+            double d = fabs(A[e * SMALL_CHAIN_LANES + l] - B[e * SMALL_CHAIN_LANES + l]);
+            diff[l] = (d > diff[l]) ? d : diff[l];
+        }
+    }
+    double max = 0.0;
+    for (int l = 0; l < SMALL_CHAIN_LANES; l++) max = (diff[l] > max) ? diff[l] : max;
+    return max;
+}
+
+//Un noyau par taille de chaîne : square_3, max_diff_3, etc.
+#define SMALL_CHAIN_KERNELS(N) \
+    static void square_##N(const double *A, double *B) { square_tile(A, B, N); } \
+    static double max_diff_##N(const double *A, const double *B) { return max_diff_tile(A, B, N); }
+
+SMALL_CHAIN_KERNELS(1)
+SMALL_CHAIN_KERNELS(2)
+SMALL_CHAIN_KERNELS(3)
+SMALL_CHAIN_KERNELS(4)
+SMALL_CHAIN_KERNELS(5)
+SMALL_CHAIN_KERNELS(6)
+SMALL_CHAIN_KERNELS(7)
+SMALL_CHAIN_KERNELS(8)
+SMALL_CHAIN_KERNELS(9)
+SMALL_CHAIN_KERNELS(10)
+SMALL_CHAIN_KERNELS(11)
+SMALL_CHAIN_KERNELS(12)
+SMALL_CHAIN_KERNELS(13)
+SMALL_CHAIN_KERNELS(14)
+SMALL_CHAIN_KERNELS(15)
+SMALL_CHAIN_KERNELS(16)
+
+typedef struct s_small_kernels {
+    void (*square)(const double *A, double *B);
+    double (*max_diff)(const double *A, const double *B);
+} t_small_kernels;
+
+#define SMALL_CHAIN_ENTRY(N) { square_##N, max_diff_##N }
+
+static const t_small_kernels kernels[SMALL_CHAIN_MAX_STATES + 1] = {
+    { NULL, NULL },
+    SMALL_CHAIN_ENTRY(1), SMALL_CHAIN_ENTRY(2), SMALL_CHAIN_ENTRY(3), SMALL_CHAIN_ENTRY(4),
+    SMALL_CHAIN_ENTRY(5), SMALL_CHAIN_ENTRY(6), SMALL_CHAIN_ENTRY(7), SMALL_CHAIN_ENTRY(8),
+    SMALL_CHAIN_ENTRY(9), SMALL_CHAIN_ENTRY(10), SMALL_CHAIN_ENTRY(11), SMALL_CHAIN_ENTRY(12),
+    SMALL_CHAIN_ENTRY(13), SMALL_CHAIN_ENTRY(14), SMALL_CHAIN_ENTRY(15), SMALL_CHAIN_ENTRY(16)
+};
+
+/*
+   small_batch_init :
+   Une seule série d'allocations pour tout le lot ; capacity est arrondie au
+   multiple de SMALL_CHAIN_LANES supérieur (les voies en trop restent vides).
+*/
+int small_batch_init(t_small_batch *batch, int num_states, int capacity) {
+    memset(batch, 0, sizeof(*batch));
+    if (num_states < 1 || num_states > SMALL_CHAIN_MAX_STATES || capacity < 1) return -1;
+
+    capacity = (capacity + SMALL_CHAIN_LANES - 1) / SMALL_CHAIN_LANES * SMALL_CHAIN_LANES;
+    size_t n = num_states;
+    batch->num_states = num_states;
+    batch->capacity = capacity;
+    batch->P = (double *)calloc(n * n * capacity, sizeof(double));
+    batch->valid = (unsigned char *)calloc(capacity, sizeof(unsigned char));
+    batch->num_classes = (unsigned char *)calloc(capacity, sizeof(unsigned char));
+    batch->class_id = (unsigned char *)calloc(n * capacity, sizeof(unsigned char));
+    batch->period = (unsigned char *)calloc(n * capacity, sizeof(unsigned char));
+    batch->stationary = (double *)calloc(n * capacity, sizeof(double));
+    batch->limit = (double *)calloc(n * capacity, sizeof(double));
+    batch->work = (double *)malloc(2 * n * n * SMALL_CHAIN_LANES * sizeof(double));
+    if (batch->P == NULL || batch->valid == NULL || batch->num_classes == NULL || batch->class_id == NULL
+        || batch->period == NULL || batch->stationary == NULL || batch->limit == NULL || batch->work == NULL) {
+        perror("Allocation failed for small chain batch");
+        small_batch_free(batch);
+        return -1;
+    }
+    return 0;
+}
+
+void small_batch_free(t_small_batch *batch) {
+    free(batch->P);
+    free(batch->valid);
+    free(batch->num_classes);
+    free(batch->class_id);
+    free(batch->period);
+    free(batch->stationary);
+    free(batch->limit);
+    free(batch->work);
+    memset(batch, 0, sizeof(*batch));
+}
+
+void small_batch_clear(t_small_batch *batch) {
+    size_t n = batch->num_states;
+    memset(batch->P, 0, n * n * batch->capacity * sizeof(double));
+    batch->count = 0;
+}
+
+int small_batch_add(t_small_batch *batch, int num_edges, const int *from, const int *to, const float *proba) {
+    int n = batch->num_states;
+    size_t cap = batch->capacity;
+    int c = batch->count;
+    if (c >= batch->capacity) return -1;
+
+    for (int e = 0; e < num_edges; e++) {
+        if (from[e] < 1 || from[e] > n || to[e] < 1 || to[e] > n) {
+            for (int k = 0; k < e; k++) batch->P[((size_t)(from[k] - 1) * n + to[k] - 1) * cap + c] = 0.0;
+            return -1;
+        }
+        batch->P[((size_t)(from[e] - 1) * n + to[e] - 1) * cap + c] += proba[e];
+    }
+    batch->count++;
+    return c;
+}
+
+int small_batch_add_graph(t_small_batch *batch, t_graph graph) {
+    int n = batch->num_states;
+    size_t cap = batch->capacity;
+    int c = batch->count;
+    if (graph.num_vertices != n || c >= batch->capacity) return -1;
+
+    for (int i = 0; i < n; i++) {
+        for (t_edge *edge = graph.adj_lists[i].head; edge != NULL; edge = edge->next) {
+            batch->P[((size_t)i * n + edge->destination - 1) * cap + c] += edge->probability;
+        }
+    }
+    batch->count++;
+    return c;
+}
+
+static int popcount(uint32_t mask) {
+    int count = 0;
+    for (; mask != 0; mask &= mask - 1) count++;
+    return count;
+}
+
+static int gcd(int a, int b) {
+    while (b != 0) {
+        int t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+/*
+   class_period :
+   Niveaux d'un parcours en largeur depuis root dans la classe (masque members) ;
+   la période est le PGCD de niveau(u) + 1 - niveau(v) sur les arêtes u → v internes.
+*/
+static int class_period(const uint32_t *adj, uint32_t members, int root, int n) {
+    int level[SMALL_CHAIN_MAX_STATES];
+    int queue[SMALL_CHAIN_MAX_STATES];
+    int count = 0;
+    uint32_t seen = 1u << root;
+    level[root] = 0;
+    queue[count++] = root;
+    for (int head = 0; head < count; head++) {
+        int u = queue[head];
+        for (int v = 0; v < n; v++) {
+            if ((adj[u] & members & ~seen) >> v & 1u) {
+                seen |= 1u << v;
+                level[v] = level[u] + 1;
+                queue[count++] = v;
+            }
+        }
+    }
+
+    int period = 0;
+    for (int k = 0; k < count; k++) {
+        int u = queue[k];
+        for (int v = 0; v < n; v++) {
+            if ((adj[u] & members) >> v & 1u) period = gcd(period, abs(level[u] + 1 - level[v]));
+        }
+    }
+    return period;
+}
+
+/*
+   lane_classes :
+   Classes de la chaîne c à partir de ses masques de successeurs : fermeture transitive
+   (Warshall), classe de i = états atteints par i qui atteignent i, classe persistante si
+   tout ce qu'elle atteint est en elle. Une classe qui en atteint une autre atteint
+   strictement plus d'états : numéroter par nombre d'états atteints croissant place les
+   successeurs d'abord, comme Tarjan.
+*/
+static void lane_classes(t_small_batch *batch, int c, const uint32_t *adj) {
+    int n = batch->num_states;
+    size_t cap = batch->capacity;
+    uint32_t reach[SMALL_CHAIN_MAX_STATES], members[SMALL_CHAIN_MAX_STATES];
+
+    for (int i = 0; i < n; i++) reach[i] = adj[i] | (1u << i);
+    for (int k = 0; k < n; k++) {
+        for (int i = 0; i < n; i++) {
+            if (reach[i] >> k & 1u) reach[i] |= reach[k];
+        }
+    }
+
+    int roots[SMALL_CHAIN_MAX_STATES];
+    int num_classes = 0;
+    for (int i = 0; i < n; i++) {
+        members[i] = 0;
+        for (int j = 0; j < n; j++) {
+            if ((reach[i] >> j & 1u) && (reach[j] >> i & 1u)) members[i] |= 1u << j;
+        }
+        if ((members[i] & ((1u << i) - 1)) != 0) continue; // i n'est pas le plus petit état de sa classe
+
+        // Tri par insertion sur (nombre d'états atteints, plus petit état)
+        int k = num_classes++;
+        while (k > 0 && popcount(reach[roots[k - 1]]) > popcount(reach[i])) {
+            roots[k] = roots[k - 1];
+            k--;
+        }
+        roots[k] = i;
+    }
+
+    for (int k = 0; k < num_classes; k++) {
+        int root = roots[k];
+        int period = (reach[root] == members[root]) ? class_period(adj, members[root], root, n) : 0;
+        for (int v = 0; v < n; v++) {
+            if (!(members[root] >> v & 1u)) continue;
+            batch->class_id[v * cap + c] = (unsigned char)(k + 1);
+            batch->period[v * cap + c] = (unsigned char)period;
+        }
+    }
+    batch->num_classes[c] = (unsigned char)num_classes;
+}
+
+/*
+   small_batch_solve :
+   Par groupe de SMALL_CHAIN_LANES chaînes, en lisant P case par case (les voies d'une
+   case sont contiguës) : sommes des lignes (propriété de Markov) et masques de successeurs,
+   classes de chaque chaîne, puis Q = (I + P) / 2 élevée au carré jusqu'à convergence.
+   Q a les mêmes classes, les mêmes distributions stationnaires et les mêmes probabilités
+   d'absorption que P, mais n'est jamais périodique : Q^k converge vers la limite de
+   Cesàro de P^k. La ligne d'un état persistant v est la distribution stationnaire de sa
+   classe (lue en (v, v)), la ligne 1 est la limite depuis l'état 1. Une chaîne invalide
+   (ou une voie vide) part de l'identité, qui ne retarde pas la convergence du groupe.
+*/
+void small_batch_solve(t_small_batch *batch) {
+    int n = batch->num_states;
+    size_t cap = batch->capacity;
+    const t_small_kernels *kernel = &kernels[n];
+    double *A = batch->work;
+    double *B = batch->work + (size_t)n * n * SMALL_CHAIN_LANES;
+
+    memset(batch->num_classes, 0, cap);
+    memset(batch->class_id, 0, n * cap);
+    memset(batch->period, 0, n * cap);
+
+    for (int tile = 0; tile < batch->count; tile += SMALL_CHAIN_LANES) {
+        uint32_t adj[SMALL_CHAIN_LANES][SMALL_CHAIN_MAX_STATES] = {{0}};
+        double scale[SMALL_CHAIN_MAX_STATES][SMALL_CHAIN_LANES];
+        unsigned char *valid = &batch->valid[tile];
+
+        // 1. Propriété de Markov (tolérance TOLERANCE) et successeurs
+        for (int l = 0; l < SMALL_CHAIN_LANES; l++) valid[l] = (tile + l < batch->count);
+        for (int i = 0; i < n; i++) {
+            double sum[SMALL_CHAIN_LANES] = {0};
+            for (int j = 0; j < n; j++) {
+                const double *p = &batch->P[((size_t)i * n + j) * cap + tile];
+                for (int l = 0; l < SMALL_CHAIN_LANES; l++) {
+                    sum[l] += p[l];
+                    if (p[l] > 0.0) adj[l][i] |= 1u << j;
+                }
+            }
+            for (int l = 0; l < SMALL_CHAIN_LANES; l++) {
+                if (fabs(sum[l] - 1.0) > TOLERANCE) valid[l] = 0;
+                scale[i][l] = 0.5 / sum[l];
+            }
+        }
+
+        // 2. Classes, persistance et périodes
+        for (int l = 0; l < SMALL_CHAIN_LANES; l++) {
+            if (valid[l]) lane_classes(batch, tile + l, adj[l]);
+        }
+
+        // 3. Q = (I + P) / 2, lignes de P ramenées à une somme de 1 (la tolérance du test de Markov est de 1 %)
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++) {
+                const double *p = &batch->P[((size_t)i * n + j) * cap + tile];
+                double *a = &A[(i * n + j) * SMALL_CHAIN_LANES];
+                for (int l = 0; l < SMALL_CHAIN_LANES; l++) {
+                    a[l] = valid[l] ? scale[i][l] * p[l] : 0.0;
+                    if (i == j) a[l] += valid[l] ? 0.5 : 1.0;
+                }
+            }
+        }
+
+        // 4. Q^(2^s) jusqu'à convergence de toutes les voies du groupe
+        for (int s = 0; s < SMALL_CHAIN_MAX_SQUARINGS; s++) {
+            kernel->square(A, B);
+            double diff = kernel->max_diff(A, B);
+            double *swap = A;
+            A = B;
+            B = swap;
+            if (diff < SMALL_CHAIN_EPSILON) break;
+        }
+
+        for (int v = 0; v < n; v++) {
+            const double *diagonal = &A[(v * n + v) * SMALL_CHAIN_LANES];
+            const double *first_row = &A[v * SMALL_CHAIN_LANES];
+            for (int l = 0; l < SMALL_CHAIN_LANES; l++) {
+                size_t at = v * cap + tile + l;
+                batch->stationary[at] = (valid[l] && batch->period[at] > 0) ? diagonal[l] : 0.0;
+                batch->limit[at] = valid[l] ? first_row[l] : 0.0;
+            }
+        }
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef SMALL_CHAIN_H
+#define SMALL_CHAIN_H
+
+#include "graph.h"
+
+/*
+   Moteur des petites chaînes (au plus SMALL_CHAIN_MAX_STATES états), analysées par lots.
+   Sur une chaîne de 3 à 16 états, les allocations de la liste d'adjacence, de Tarjan et
+   des matrices float** coûtent plus que les calculs. Un lot regroupe des chaînes de même
+   taille N, rangées en structure de tableaux : la case (i, j) de toutes les chaînes est
+   contiguë, et les noyaux de calcul (un par valeur de N, déroulés) traitent
+   SMALL_CHAIN_LANES chaînes à la fois, une chaîne par voie SIMD. Toute la mémoire est
+   allouée par small_batch_init, aucune par chaîne.
+*/
+
+//Taille maximale d'une chaîne du lot (les ensembles d'états sont des masques de 32 bits).
+#define SMALL_CHAIN_MAX_STATES 16
+
+//Chaînes traitées ensemble par les noyaux de calcul.
+#define SMALL_CHAIN_LANES 16
+
+//Les puissances de (I + P) / 2 sont élevées au carré jusqu'à ce qu'aucune case ne bouge de plus de SMALL_CHAIN_EPSILON.
+#define SMALL_CHAIN_EPSILON 1e-10
+#define SMALL_CHAIN_MAX_SQUARINGS 64
+
+//Lot de chaînes de même taille. Les tableaux de résultats sont indexés [état * capacity + chaîne].
+typedef struct s_small_batch {
+    int num_states;              // N (1..SMALL_CHAIN_MAX_STATES), commun à toutes les chaînes du lot
+    int count;                   // Chaînes ajoutées
+    int capacity;                // Chaînes au plus (multiple de SMALL_CHAIN_LANES)
+    double *P;                   // N*N*capacity : P(i, j) de la chaîne c dans P[(i*N + j)*capacity + c]
+    unsigned char *valid;        // capacity : 1 si la chaîne vérifie la propriété de Markov (small_batch_solve)
+    unsigned char *num_classes;  // capacity : nombre de classes
+    unsigned char *class_id;     // N*capacity : classe (1..) de chaque état, successeurs avant la classe (comme Tarjan)
+    unsigned char *period;       // N*capacity : période de la classe de chaque état, 0 si transitoire
+    double *stationary;          // N*capacity : distribution stationnaire de la classe de chaque état, 0 si transitoire
+    double *limit;               // N*capacity : limite (au sens de Cesàro) de la distribution partant de l'état 1
+    double *work;                // 2*N*N*SMALL_CHAIN_LANES : puissances de (I + P) / 2 d'un groupe de chaînes
+} t_small_batch;
+
+//Alloue un lot de capacity chaînes de num_states états. Retourne 0 si succès, -1 si la mémoire manque ou si la taille est invalide.
+int small_batch_init(t_small_batch *batch, int num_states, int capacity);
+
+//Libère la mémoire du lot.
+void small_batch_free(t_small_batch *batch);
+
+//Vide le lot (les chaînes suivantes repartent de la première case).
+void small_batch_clear(t_small_batch *batch);
+
+//Ajoute une chaîne donnée par ses arêtes (états numérotés de 1 à N). Retourne son indice dans le lot,
+//-1 si le lot est plein ou si un état est hors de 1..N.
+int small_batch_add(t_small_batch *batch, int num_edges, const int *from, const int *to, const float *proba);
+
+//Ajoute une chaîne lue par read_graph (même nombre d'états que le lot). Retourne son indice, -1 sinon.
+int small_batch_add_graph(t_small_batch *batch, t_graph graph);
+
+//Propriété de Markov, classes, persistance, périodes, distributions stationnaires et limite depuis l'état 1
+//de toutes les chaînes du lot. Une chaîne invalide n'a que valid = 0 (ses autres résultats sont à zéro).
+void small_batch_solve(t_small_batch *batch);
+
+#endif // SMALL_CHAIN_H
@@ -0,0 +1,853 @@
+#include "sparse.h"
+#include <math.h>
+#include <string.h>
+#include "profile.h"
+
+/*
+   graph_to_csr :
+   Convertit la liste d'adjacence en matrice creuse CSR.
+   Premier passage : compte les arêtes de chaque sommet pour remplir row_ptr.
+   Second passage : recopie destinations (0-based) et probabilités à la suite.
+   Les arêtes d'un sommet gardent l'ordre de sa liste chaînée.
+   Si la mémoire manque, retourne une matrice vide (row_ptr = NULL, num_vertices = 0).
+*/
+t_csr graph_to_csr(t_graph graph) {
+    t_csr csr = {0, 0, NULL, NULL, NULL};
+    int N = graph.num_vertices;
+
+    csr.row_ptr = (int *)malloc((N + 1) * sizeof(int));
+    if (csr.row_ptr == NULL) {
+        perror("Allocation failed for CSR row_ptr");
+        return csr;
+    }
+    csr.num_vertices = N;
+
+    csr.row_ptr[0] = 0;
+    for (int i = 0; i < N; i++) {
+        int degree = 0;
+        for (t_edge *e = graph.adj_lists[i].head; e != NULL; e = e->next) degree++;
+        csr.row_ptr[i + 1] = csr.row_ptr[i] + degree;
+    }
+    csr.num_edges = csr.row_ptr[N];
+
+    csr.col_idx = (int *)malloc((csr.num_edges > 0 ? csr.num_edges : 1) * sizeof(int));
+    csr.values = (float *)malloc((csr.num_edges > 0 ? csr.num_edges : 1) * sizeof(float));
+    if (csr.col_idx == NULL || csr.values == NULL) {
+        perror("Allocation failed for CSR edges");
+        free_csr(csr);
+        return (t_csr){0, 0, NULL, NULL, NULL};
+    }
+
+    for (int i = 0; i < N; i++) {
+        int pos = csr.row_ptr[i];
+        for (t_edge *e = graph.adj_lists[i].head; e != NULL; e = e->next) {
+            csr.col_idx[pos] = e->destination - 1;
+            csr.values[pos] = e->probability;
+            pos++;
+        }
+    }
+
+    return csr;
+}
+
+/*
+   free_csr :
+   Libère les trois tableaux de la matrice CSR.
+*/
+void free_csr(t_csr csr) {
+    free(csr.row_ptr);
+    free(csr.col_idx);
+    free(csr.values);
+}
+
+/*
+   csr_transpose :
+   Tri par dénombrement des arêtes selon leur arrivée : un passage compte les
+   arêtes entrantes de chaque sommet, un second les range. Les lignes de P étant
+   parcourues dans l'ordre, les prédécesseurs de chaque sommet sont triés.
+*/
+t_csr csr_transpose(const t_csr *P) {
+    t_csr PT = {0, 0, NULL, NULL, NULL};
+    int N = P->num_vertices;
+    int E = P->num_edges;
+
+    PT.row_ptr = (int *)calloc(N + 1, sizeof(int));
+    PT.col_idx = (int *)malloc((E > 0 ? E : 1) * sizeof(int));
+    PT.values = (float *)malloc((E > 0 ? E : 1) * sizeof(float));
+    int *fill = (int *)malloc((N > 0 ? N : 1) * sizeof(int));
+    if (PT.row_ptr == NULL || PT.col_idx == NULL || PT.values == NULL || fill == NULL) {
+        perror("Allocation failed for CSR transpose");
+        free_csr(PT);
+        free(fill);
+        return (t_csr){0, 0, NULL, NULL, NULL};
+    }
+    PT.num_vertices = N;
+    PT.num_edges = E;
+
+    for (int e = 0; e < E; e++) PT.row_ptr[P->col_idx[e] + 1]++;
+    for (int j = 0; j < N; j++) PT.row_ptr[j + 1] += PT.row_ptr[j];
+    memcpy(fill, PT.row_ptr, N * sizeof(int));
+
+    for (int i = 0; i < N; i++) {
+        for (int e = P->row_ptr[i]; e < P->row_ptr[i + 1]; e++) {
+            int pos = fill[P->col_idx[e]]++;
+            PT.col_idx[pos] = i;
+            PT.values[pos] = P->values[e];
+        }
+    }
+
+    free(fill);
+    return PT;
+}
+
+/*
+   csr_vector_step :
+   Calcule y = x P : chaque sommet i "pousse" sa masse x[i] vers ses successeurs.
+   Coût O(N + E), accumulation en double pour limiter les erreurs d'arrondi.
+*/
+void csr_vector_step(const t_csr *P, const double *x, double *y) {
+    int N = P->num_vertices;
+
+    memset(y, 0, N * sizeof(double));
+    for (int i = 0; i < N; i++) {
+        double xi = x[i];
+        if (xi == 0.0) continue;
+        for (int e = P->row_ptr[i]; e < P->row_ptr[i + 1]; e++) {
+            y[P->col_idx[e]] += xi * P->values[e];
+        }
+    }
+    profile_count_flops(2LL * P->num_edges);
+}
+
+/*
+   csr_pull_step :
+   Calcule y = x P ligne par ligne de la transposée : chaque sommet j "tire" la
+   masse de ses prédécesseurs. Même coût que csr_vector_step, mais les écritures
+   sont indépendantes : c'est la forme parallélisable sans atomiques (voir pull.h).
+*/
+void csr_pull_step(const t_csr *PT, const double *x, double *y) {
+    int N = PT->num_vertices;
+
+    for (int j = 0; j < N; j++) {
+        double sum = 0.0;
+        for (int e = PT->row_ptr[j]; e < PT->row_ptr[j + 1]; e++) sum += x[PT->col_idx[e]] * PT->values[e];
+        y[j] = sum;
+    }
+    profile_count_flops(2LL * PT->num_edges);
+}
+
+/*
+   csr_block_step :
+   Comme csr_vector_step, pour B vecteurs à la fois : chaque arête (indice et
+   probabilité) n'est lue qu'une fois pour les B vecteurs, et les B masses d'un état
+   étant contiguës, la boucle interne se vectorise.
+*/
+void csr_block_step(const t_csr *P, const double *X, double *Y, int B) {
+    csr_mode_step(P, X, Y, 1, B);
+}
+
+/*
+   csr_mode_step :
+   Étape de l'algorithme de brassage (shuffle) des produits de Kronecker : appliquer
+   P à un mode revient à traiter chaque tranche l comme un bloc de R vecteurs
+   rangés état par état. Coût O(L R E), sans jamais former I_L ⊗ P ⊗ I_R.
+   - Quand les R vecteurs d'une tranche dépassent le cache (premier mode d'un grand
+     produit), ils sont traités par paquets de colonnes : chaque arête relit alors
+     un morceau de x et de y encore en cache (SPARSE_MODE_TILE_BYTES en tout).
+   - Avec R = 1 (dernier mode), la boucle sur les vecteurs disparaît.
+*/
+void csr_mode_step(const t_csr *P, const double *X, double *Y, long long L, int R) {
+    int N = P->num_vertices;
+    size_t slice = (size_t)N * R;
+    long long tile = SPARSE_MODE_TILE_BYTES / (2LL * N * (long long)sizeof(double));
+    if (tile < SPARSE_MODE_MIN_TILE) tile = SPARSE_MODE_MIN_TILE;
+    if (tile > R) tile = R;
+
+    memset(Y, 0, (size_t)L * slice * sizeof(double));
+    for (long long l = 0; l < L; l++) {
+        const double *Xl = X + (size_t)l * slice;
+        double *Yl = Y + (size_t)l * slice;
+        if (R == 1) {
+            for (int i = 0; i < N; i++) {
+                double xi = Xl[i];
+                for (int e = P->row_ptr[i]; e < P->row_ptr[i + 1]; e++) Yl[P->col_idx[e]] += xi * P->values[e];
+            }
+            continue;
+        }
+        for (int r0 = 0; r0 < R; r0 += (int)tile) {
+            int width = (R - r0 < tile) ? R - r0 : (int)tile;
+            for (int i = 0; i < N; i++) {
+                const double *xi = Xl + (size_t)i * R + r0;
+                for (int e = P->row_ptr[i]; e < P->row_ptr[i + 1]; e++) {
+                    double p = P->values[e];
+                    double *yj = Yl + (size_t)P->col_idx[e] * R + r0;
+                    for (int r = 0; r < width; r++) yj[r] += p * xi[r];
+                }
+            }
+        }
+    }
+    profile_count_flops(2LL * L * P->num_edges * R);
+}
+
+/*
+   k_step_distribution :
+   Applique k fois csr_vector_step à partir de x0, en alternant deux tampons.
+   Remplace le calcul de x0 * M^k qui demanderait la matrice dense M^k.
+   Retourne 0 si succès, -1 si la mémoire manque.
+*/
+int k_step_distribution(const t_csr *P, const double *x0, int k, double *out) {
+    int N = P->num_vertices;
+
+    double *tmp = (double *)malloc(N * sizeof(double));
+    if (tmp == NULL) {
+        perror("Allocation failed for k-step buffer");
+        return -1;
+    }
+
+    // Le résultat final doit atterrir dans out : on choisit le tampon de départ selon la parité de k
+    double *cur = (k % 2 == 0) ? out : tmp;
+    double *next = (k % 2 == 0) ? tmp : out;
+    memcpy(cur, x0, N * sizeof(double));
+
+    for (int step = 0; step < k; step++) {
+        csr_vector_step(P, cur, next);
+        double *swap = cur;
+        cur = next;
+        next = swap;
+    }
+
+    free(tmp);
+    return 0;
+}
+
+/*
+   stationary_iterate :
+   Itération de la chaîne "paresseuse" (I + P) / 2 sur les membres d'une classe
+   persistante (fermée), à partir des valeurs déjà présentes dans pi : elle a la
+   même distribution stationnaire que P mais n'est jamais périodique, donc
+   l'itération converge aussi sur les classes de période > 1.
+   Arrêt quand sum(|pi_k - pi_(k-1)|) < epsilon ou après max_iter itérations, en
+   comptant les start_iter itérations déjà faites (reprise). monitor, s'il n'est pas
+   NULL, voit chaque itéré qui n'a pas encore convergé. work (N cases) reçoit
+   l'itéré suivant ; sans tampon de l'appelant, il est alloué pour cet appel.
+   *converged (si non NULL) vaut 1 si l'écart est passé sous epsilon, 0 si max_iter
+   a été atteint avant.
+*/
+static int stationary_iterate(const t_csr *P, t_class c, double *pi, double epsilon, int max_iter, int start_iter,
+                              const t_stationary_monitor *monitor, double *work, int *converged) {
+    int N = P->num_vertices;
+    int k = c.num_members;
+
+    double *next = (work != NULL) ? work : (double *)malloc(N * sizeof(double));
+    if (next == NULL) {
+        perror("Allocation failed for class stationary buffer");
+        return -1;
+    }
+
+    int iter, internal_edges = 0, done = 0;
+    for (int m = 0; m < k; m++) {
+        int u = c.members_ids[m] - 1;
+        internal_edges += P->row_ptr[u + 1] - P->row_ptr[u];
+    }
+
+    for (iter = start_iter + 1; iter <= max_iter; iter++) {
+        for (int m = 0; m < k; m++) {
+            int v = c.members_ids[m] - 1;
+            next[v] = 0.5 * pi[v];
+        }
+        // La classe est fermée : toutes les arêtes de ses membres restent dans la classe
+        for (int m = 0; m < k; m++) {
+            int u = c.members_ids[m] - 1;
+            double half = 0.5 * pi[u];
+            for (int e = P->row_ptr[u]; e < P->row_ptr[u + 1]; e++) {
+                next[P->col_idx[e]] += half * P->values[e];
+            }
+        }
+
+        // Les lignes ne somment à 1 qu'à TOLERANCE près : on renormalise pour que la masse ne dérive pas
+        double total = 0.0;
+        for (int m = 0; m < k; m++) total += next[c.members_ids[m] - 1];
+        if (total <= 0.0) total = 1.0;
+
+        double diff = 0.0;
+        for (int m = 0; m < k; m++) {
+            int v = c.members_ids[m] - 1;
+            double value = next[v] / total;
+            diff += fabs(value - pi[v]);
+            pi[v] = value;
+        }
+        if (diff < epsilon) {
+            done = 1;
+            break;
+        }
+        if (monitor != NULL) monitor->observe(monitor->data, pi, iter, diff);
+    }
+
+    if (work == NULL) free(next);
+    if (converged != NULL) *converged = done;
+    if (iter > max_iter) iter = (max_iter > start_iter) ? max_iter : start_iter;
+    profile_count_iterations(iter - start_iter);
+    profile_count_flops((long long)(iter - start_iter) * (2LL * internal_edges + 4LL * k));
+    return iter;
+}
+
+/*
+   class_stationary_distribution :
+   Distribution stationnaire d'une classe persistante, calculée uniquement sur ses
+   membres en partant de la distribution uniforme (voir stationary_iterate).
+   Seules les cases des membres sont écrites : les distributions de toutes les
+   classes persistantes peuvent être rangées dans un même vecteur de taille N.
+*/
+int class_stationary_distribution(const t_csr *P, t_partition partition, int class_index,
+                                  double *pi, double epsilon, int max_iter, double *work, int *converged) {
+    t_class c = partition.classes[class_index];
+    int k = c.num_members;
+
+    if (!c.is_persistent) return -1;
+
+    if (k == 1) {
+        pi[c.members_ids[0] - 1] = 1.0; // État absorbant
+        if (converged != NULL) *converged = 1;
+        return 0;
+    }
+
+    for (int m = 0; m < k; m++) pi[c.members_ids[m] - 1] = 1.0 / k;
+    return stationary_iterate(P, c, pi, epsilon, max_iter, 0, NULL, work, converged);
+}
+
+/*
+   class_stationary_distribution_warm :
+   Même calcul, mais en partant des valeurs déjà rangées dans pi pour les membres
+   (renormalisées), par exemple la distribution d'avant une petite modification
+   de la chaîne : il faut alors beaucoup moins d'itérations. Départ uniforme si
+   ces valeurs sont toutes nulles.
+*/
+int class_stationary_distribution_warm(const t_csr *P, t_partition partition, int class_index,
+                                       double *pi, double epsilon, int max_iter, double *work, int *converged) {
+    t_class c = partition.classes[class_index];
+    int k = c.num_members;
+
+    if (!c.is_persistent) return -1;
+
+    if (k == 1) {
+        pi[c.members_ids[0] - 1] = 1.0;
+        if (converged != NULL) *converged = 1;
+        return 0;
+    }
+
+    double total = 0.0;
+    for (int m = 0; m < k; m++) {
+        double value = pi[c.members_ids[m] - 1];
+        if (value > 0.0) total += value;
+    }
+    for (int m = 0; m < k; m++) {
+        int v = c.members_ids[m] - 1;
+        pi[v] = (total > 0.0) ? ((pi[v] > 0.0) ? pi[v] / total : 0.0) : 1.0 / k;
+    }
+    return stationary_iterate(P, c, pi, epsilon, max_iter, 0, NULL, work, converged);
+}
+
+/*
+   class_stationary_resume :
+   Départ uniforme si start_iter vaut 0, comme class_stationary_distribution. Sinon
+   l'itéré rangé dans pi est repris tel quel, sans renormalisation : la suite des
+   itérés est exactement celle d'un calcul sans interruption.
+*/
+int class_stationary_resume(const t_csr *P, t_partition partition, int class_index, double *pi, double epsilon,
+                            int max_iter, int start_iter, const t_stationary_monitor *monitor, double *work,
+                            int *converged) {
+    t_class c = partition.classes[class_index];
+    int k = c.num_members;
+
+    if (!c.is_persistent || start_iter < 0) return -1;
+
+    if (k == 1) {
+        pi[c.members_ids[0] - 1] = 1.0;
+        if (converged != NULL) *converged = 1;
+        return 0;
+    }
+
+    if (start_iter == 0) {
+        for (int m = 0; m < k; m++) pi[c.members_ids[m] - 1] = 1.0 / k;
+    }
+    return stationary_iterate(P, c, pi, epsilon, max_iter, start_iter, monitor, work, converged);
+}
+
+//PGCD de deux entiers positifs ou nuls.
+static int gcd_int(int a, int b) {
+    while (b != 0) {
+        int t = b;
+        b = a % b;
+        a = t;
+    }
+    return a;
+}
+
+/*
+   period_bfs :
+   Parcours en largeur depuis un membre en ne suivant que les arêtes internes ;
+   level (N cases) reçoit le niveau de chaque membre. La période est le PGCD de
+   (niveau(u) + 1 - niveau(v)) sur toutes les arêtes internes u → v.
+   Retourne -1 si l'allocation de la file échoue.
+*/
+static int period_bfs(const t_csr *P, t_partition partition, int class_index, int *level) {
+    t_class c = partition.classes[class_index];
+
+    int *queue = (int *)malloc(c.num_members * sizeof(int));
+    if (queue == NULL) {
+        perror("Allocation failed for period BFS");
+        return -1;
+    }
+    for (int m = 0; m < c.num_members; m++) level[c.members_ids[m] - 1] = -1;
+
+    int head = 0, tail = 0, period = 0;
+    int root = c.members_ids[0] - 1;
+    level[root] = 0;
+    queue[tail++] = root;
+
+    while (head < tail) {
+        int u = queue[head++];
+        for (int e = P->row_ptr[u]; e < P->row_ptr[u + 1]; e++) {
+            int v = P->col_idx[e];
+            if (partition.v_data[v].class_id != c.id) continue;
+
+            if (level[v] == -1) {
+                level[v] = level[u] + 1;
+                queue[tail++] = v;
+            } else {
+                period = gcd_int(period, abs(level[u] + 1 - level[v]));
+            }
+        }
+    }
+
+    free(queue);
+    return period;
+}
+
+/*
+   class_period_sparse :
+   Période d'une classe sans matrice dense, par period_bfs.
+   Coût O(taille de la classe + arêtes internes).
+   Même convention que get_class_period : 1 pour une classe réduite à un sommet.
+*/
+int class_period_sparse(const t_csr *P, t_partition partition, int class_index) {
+    t_class c = partition.classes[class_index];
+    if (c.num_members <= 1) return 1;
+
+    int *level = (int *)malloc(P->num_vertices * sizeof(int));
+    if (level == NULL) {
+        perror("Allocation failed for period BFS");
+        return -1;
+    }
+    int period = period_bfs(P, partition, class_index, level);
+    free(level);
+    return period;
+}
+
+/*
+   class_cyclic_subclasses :
+   Une classe de période d se découpe en d sous-classes cycliques : toute arête
+   interne mène de la sous-classe r à la sous-classe r + 1 (modulo d). Le niveau
+   du parcours en largeur modulo d donne la sous-classe de chaque membre.
+*/
+int class_cyclic_subclasses(const t_csr *P, t_partition partition, int class_index, int *phase) {
+    t_class c = partition.classes[class_index];
+    if (c.num_members <= 1) {
+        if (c.num_members == 1) phase[c.members_ids[0] - 1] = 0;
+        return 1;
+    }
+
+    int period = period_bfs(P, partition, class_index, phase);
+    if (period <= 0) return period;
+    for (int m = 0; m < c.num_members; m++) phase[c.members_ids[m] - 1] %= period;
+    return period;
+}
+
+/*
+   class_absorption :
+   h(v) = sum_w p(v,w) h(w) sur les membres d'une classe transitoire T, résolu par
+   Gauss-Seidel : les valeurs hors de T sont déjà connues, celles des membres
+   servent de point de départ (zéro, ou les valeurs d'avant une modification).
+   Chaque ligne ne couvre que les colonnes de T ; celles d'une classe atteinte en
+   sont un sous-ensemble, retrouvé par slot (position de chaque colonne dans T).
+*/
+int class_absorption(const t_csr *P, t_partition partition, int class_index, t_absorption *A, int *slot, double *acc) {
+    t_class c = partition.classes[class_index];
+    long long first = A->class_ptr[class_index];
+    int width = (int)(A->class_ptr[class_index + 1] - first);
+    long long flops = 0;
+    int iter;
+
+    if (width == 0) return 0;
+    for (int p = 0; p < width; p++) slot[A->columns[first + p]] = p;
+
+    for (iter = 0; iter < 100000; iter++) {
+        double delta = 0.0;
+        for (int m = 0; m < c.num_members; m++) {
+            int v = c.members_ids[m] - 1;
+            double *h = A->values + A->row_start[v];
+            double self_loop = 0.0;
+
+            for (int p = 0; p < width; p++) acc[p] = 0.0;
+            for (int e = P->row_ptr[v]; e < P->row_ptr[v + 1]; e++) {
+                int w = P->col_idx[e];
+                if (w == v) {
+                    self_loop += P->values[e];
+                    continue;
+                }
+                int t = partition.v_data[w].class_id - 1;
+                const int *columns = A->columns + A->class_ptr[t];
+                const double *hw = A->values + A->row_start[w];
+                int width_w = (int)(A->class_ptr[t + 1] - A->class_ptr[t]);
+                for (int q = 0; q < width_w; q++) acc[slot[columns[q]]] += P->values[e] * hw[q];
+                flops += 2LL * width_w;
+            }
+
+            // Une classe transitoire a toujours une sortie : self_loop < 1
+            double scale = (self_loop < 1.0) ? 1.0 / (1.0 - self_loop) : 0.0;
+            for (int p = 0; p < width; p++) {
+                double value = acc[p] * scale;
+                delta = fmax(delta, fabs(value - h[p]));
+                h[p] = value;
+            }
+        }
+        if (delta < 1e-12) break;
+    }
+
+    for (int p = 0; p < width; p++) slot[A->columns[first + p]] = -1;
+    profile_count_iterations(iter < 100000 ? iter + 1 : iter);
+    profile_count_flops(flops);
+    return iter;
+}
+
+static int compare_ints(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+void absorption_free(t_absorption *A) {
+    free(A->class_ptr);
+    free(A->columns);
+    free(A->row_start);
+    free(A->values);
+    *A = (t_absorption){0};
+}
+
+/*
+   absorption_index_rows :
+   Les membres d'une classe ont tous la largeur de leur classe ; les lignes sont
+   rangées classe par classe, dans l'ordre des membres. Échoue aussi si elles ne
+   couvrent pas exactement num_values valeurs.
+*/
+int absorption_index_rows(t_absorption *A, t_partition partition) {
+    int N = 0;
+    for (int i = 0; i < partition.num_classes; i++) N += partition.classes[i].num_members;
+
+    free(A->row_start);
+    A->row_start = (long long *)malloc((N > 0 ? N : 1) * sizeof(long long));
+    if (A->row_start == NULL) {
+        perror("Allocation failed for absorption rows");
+        return -1;
+    }
+    long long offset = 0;
+    for (int i = 0; i < partition.num_classes; i++) {
+        t_class c = partition.classes[i];
+        long long width = A->class_ptr[i + 1] - A->class_ptr[i];
+        for (int m = 0; m < c.num_members; m++) {
+            A->row_start[c.members_ids[m] - 1] = offset;
+            offset += width;
+        }
+    }
+    return (offset == A->num_values) ? 0 : -1;
+}
+
+/*
+   absorption_layout :
+   Classes dans l'ordre de leur identifiant : les classes atteintes par une classe
+   transitoire sont déjà rangées, ses colonnes sont la réunion des leurs, triée
+   (seen marque les classes voisines déjà vues, taken les colonnes déjà prises).
+   Une classe persistante n'a que sa propre colonne. Dès que les valeurs dépassent
+   max_values, tout est abandonné : les requêtes recalculent alors les
+   probabilités (absorption_row, absorption_column).
+*/
+int absorption_layout(const t_csr *P, t_partition partition, long long max_values, t_absorption *A) {
+    int num_classes = partition.num_classes;
+    int K = 0;
+
+    *A = (t_absorption){0};
+    for (int i = 0; i < num_classes; i++) K += partition.classes[i].is_persistent;
+
+    long long capacity = 1024;
+    A->class_ptr = (long long *)malloc((num_classes + 1) * sizeof(long long));
+    A->columns = (int *)malloc(capacity * sizeof(int));
+    int *seen = (int *)malloc(2 * (num_classes > 0 ? num_classes : 1) * sizeof(int));
+    int status = (A->class_ptr == NULL || A->columns == NULL || seen == NULL) ? -1 : 0;
+    int *taken = (seen != NULL) ? seen + num_classes : NULL;
+    for (int i = 0; status == 0 && i < 2 * num_classes; i++) seen[i] = -1;
+
+    long long used = 0, values = 0;
+    if (status == 0) A->class_ptr[0] = 0;
+    for (int i = 0; i < num_classes && status == 0; i++) {
+        t_class c = partition.classes[i];
+        long long first = used;
+
+        if (c.is_persistent) A->columns[used++] = i;
+        for (int m = 0; m < c.num_members && !c.is_persistent && status == 0; m++) {
+            int u = c.members_ids[m] - 1;
+            for (int e = P->row_ptr[u]; e < P->row_ptr[u + 1] && status == 0; e++) {
+                int t = partition.v_data[P->col_idx[e]].class_id - 1;
+                if (t == i || seen[t] == i) continue;
+                seen[t] = i;
+
+                long long width_t = A->class_ptr[t + 1] - A->class_ptr[t];
+                if (used + width_t > capacity) {
+                    long long grown = (2 * capacity > used + width_t) ? 2 * capacity : used + width_t;
+                    int *tmp = (int *)realloc(A->columns, grown * sizeof(int));
+                    if (tmp == NULL) {
+                        status = -1;
+                        break;
+                    }
+                    A->columns = tmp;
+                    capacity = grown;
+                }
+                for (long long q = A->class_ptr[t]; q < A->class_ptr[t + 1]; q++) {
+                    int column = A->columns[q];
+                    if (taken[column] == i) continue;
+                    taken[column] = i;
+                    A->columns[used++] = column;
+                }
+            }
+        }
+        if (used - first > 1) qsort(A->columns + first, used - first, sizeof(int), compare_ints);
+        A->class_ptr[i + 1] = used;
+        values += (used - first) * c.num_members;
+        if (values > max_values) status = 1;
+    }
+    free(seen);
+
+    if (status == 0) {
+        A->num_values = values;
+        A->values = (double *)calloc(values > 0 ? values : 1, sizeof(double));
+        if (A->values == NULL || absorption_index_rows(A, partition) != 0) status = -1;
+    }
+    if (status != 0) {
+        if (status < 0) perror("Allocation failed for absorption layout");
+        absorption_free(A);
+    }
+    A->num_classes = num_classes;
+    A->num_persistent = K;
+    return status;
+}
+
+/*
+   absorption_probabilities :
+   Tarjan termine une classe après toutes les classes qu'elle peut atteindre :
+   en parcourant les classes dans l'ordre de leur identifiant, les successeurs
+   d'une classe transitoire sont donc déjà résolus.
+   - classe persistante c : probabilité 1 pour ses membres (leur seule colonne) ;
+   - classe transitoire T : class_absorption, en partant de zéro.
+   Si la disposition dépasse max_values, rien n'est calculé ici.
+*/
+int absorption_probabilities(const t_csr *P, t_partition partition, long long max_values, t_absorption *A) {
+    int layout = absorption_layout(P, partition, max_values, A);
+    if (layout < 0) return -1;
+    if (layout > 0) return A->num_persistent;
+
+    int K = A->num_persistent;
+    int *slot = (int *)malloc((partition.num_classes > 0 ? partition.num_classes : 1) * sizeof(int));
+    double *acc = (double *)malloc((K > 0 ? K : 1) * sizeof(double));
+    if (slot == NULL || acc == NULL) {
+        perror("Allocation failed for absorption probabilities");
+        free(slot);
+        free(acc);
+        absorption_free(A);
+        return -1;
+    }
+    for (int i = 0; i < partition.num_classes; i++) slot[i] = -1;
+
+    for (int i = 0; i < partition.num_classes; i++) {
+        t_class c = partition.classes[i];
+
+        if (c.is_persistent) {
+            for (int m = 0; m < c.num_members; m++) A->values[A->row_start[c.members_ids[m] - 1]] = 1.0;
+            continue;
+        }
+        class_absorption(P, partition, i, A, slot, acc);
+    }
+
+    free(slot);
+    free(acc);
+    return K;
+}
+
+/*
+   absorption_lookup :
+   Recherche dichotomique de la colonne dans la ligne de v (colonnes croissantes).
+*/
+double absorption_lookup(const t_absorption *A, t_partition partition, int v, int class_index) {
+    if (A->values == NULL) return -1.0;
+
+    int t = partition.v_data[v].class_id - 1;
+    long long low = A->class_ptr[t], high = A->class_ptr[t + 1] - 1;
+    while (low <= high) {
+        long long middle = low + (high - low) / 2;
+        int column = A->columns[middle];
+        if (column == class_index) return A->values[A->row_start[v] + (middle - A->class_ptr[t])];
+        if (column < class_index) low = middle + 1;
+        else high = middle - 1;
+    }
+    return 0.0;
+}
+
+int absorption_row(const t_csr *P, t_partition partition, const t_absorption *A, int v, double *class_mass) {
+    if (A->values == NULL) return absorption_from_vertex(P, partition, v, class_mass);
+
+    int t = partition.v_data[v].class_id - 1;
+    const double *h = A->values + A->row_start[v];
+    memset(class_mass, 0, partition.num_classes * sizeof(double));
+    for (long long q = A->class_ptr[t]; q < A->class_ptr[t + 1]; q++) class_mass[A->columns[q]] = h[q - A->class_ptr[t]];
+    return 0;
+}
+
+/*
+   column_absorption :
+   Gauss-Seidel de class_absorption sur une seule colonne h (N cases), pour une
+   classe transitoire dont les successeurs sont déjà résolus.
+*/
+static void column_absorption(const t_csr *P, t_partition partition, int class_index, double *h) {
+    t_class c = partition.classes[class_index];
+    long long flops = 0;
+    int iter;
+
+    for (iter = 0; iter < 100000; iter++) {
+        double delta = 0.0;
+        for (int m = 0; m < c.num_members; m++) {
+            int v = c.members_ids[m] - 1;
+            double self_loop = 0.0, acc = 0.0;
+            for (int e = P->row_ptr[v]; e < P->row_ptr[v + 1]; e++) {
+                if (P->col_idx[e] == v) self_loop += P->values[e];
+                else acc += P->values[e] * h[P->col_idx[e]];
+            }
+            flops += 2LL * (P->row_ptr[v + 1] - P->row_ptr[v]);
+
+            double value = (self_loop < 1.0) ? acc / (1.0 - self_loop) : 0.0;
+            delta = fmax(delta, fabs(value - h[v]));
+            h[v] = value;
+        }
+        if (delta < 1e-12) break;
+    }
+    profile_count_iterations(iter < 100000 ? iter + 1 : iter);
+    profile_count_flops(flops);
+}
+
+/*
+   absorption_column :
+   Valeurs gardées : une recherche par sommet (absorption_lookup). Sinon les classes
+   transitoires sont résolues dans l'ordre de leur identifiant, comme
+   absorption_probabilities, mais sur la seule colonne demandée.
+*/
+int absorption_column(const t_csr *P, t_partition partition, const t_absorption *A, int class_index, double *h) {
+    int N = P->num_vertices;
+
+    if (A->values != NULL) {
+        for (int v = 0; v < N; v++) h[v] = absorption_lookup(A, partition, v, class_index);
+        return 0;
+    }
+
+    memset(h, 0, N * sizeof(double));
+    if (!partition.classes[class_index].is_persistent) return 0;
+    t_class target = partition.classes[class_index];
+    for (int m = 0; m < target.num_members; m++) h[target.members_ids[m] - 1] = 1.0;
+    for (int i = class_index + 1; i < partition.num_classes; i++) {
+        if (!partition.classes[i].is_persistent) column_absorption(P, partition, i, h);
+    }
+    return 0;
+}
+
+/*
+   absorption_from_vertex :
+   Probabilités d'absorption depuis un seul sommet, sans les valeurs de
+   absorption_probabilities. La masse part de v et traverse les classes
+   transitoires par identifiant décroissant (une classe n'atteint que des classes
+   d'identifiant plus petit, voir absorption_probabilities). Dans une classe
+   transitoire T, le nombre moyen de passages par chaque membre vérifie
+   y = x_T + y P_TT (x_T : masse entrée dans T), résolu par itération ; la masse
+   y P qui quitte T est ensuite versée dans les classes atteintes.
+*/
+int absorption_from_vertex(const t_csr *P, t_partition partition, int v, double *class_mass) {
+    int N = P->num_vertices;
+    int start = partition.v_data[v].class_id - 1;
+
+    memset(class_mass, 0, partition.num_classes * sizeof(double));
+    if (partition.classes[start].is_persistent) {
+        class_mass[start] = 1.0;
+        return 0;
+    }
+
+    double *mass = (double *)calloc(N, sizeof(double));    // Masse entrée dans chaque sommet transitoire
+    double *visits = (double *)calloc(N, sizeof(double));  // Nombre moyen de passages
+    double *next = (double *)calloc(N, sizeof(double));
+    if (mass == NULL || visits == NULL || next == NULL) {
+        perror("Allocation failed for absorption from vertex");
+        free(mass);
+        free(visits);
+        free(next);
+        return -1;
+    }
+    mass[v] = 1.0;
+
+    for (int i = start; i >= 0; i--) {
+        t_class c = partition.classes[i];
+        if (c.is_persistent) continue;
+
+        int reached = 0;
+        for (int m = 0; m < c.num_members && !reached; m++) reached = (mass[c.members_ids[m] - 1] != 0.0);
+        if (!reached) continue;
+
+        long long internal_edges = 0;
+        for (int m = 0; m < c.num_members; m++) {
+            int u = c.members_ids[m] - 1;
+            visits[u] = mass[u];
+            internal_edges += P->row_ptr[u + 1] - P->row_ptr[u];
+        }
+
+        int iter;
+        for (iter = 1; iter <= 100000; iter++) {
+            for (int m = 0; m < c.num_members; m++) next[c.members_ids[m] - 1] = mass[c.members_ids[m] - 1];
+            for (int m = 0; m < c.num_members; m++) {
+                int u = c.members_ids[m] - 1;
+                for (int e = P->row_ptr[u]; e < P->row_ptr[u + 1]; e++) {
+                    int w = P->col_idx[e];
+                    if (partition.v_data[w].class_id == c.id) next[w] += visits[u] * P->values[e];
+                }
+            }
+            double delta = 0.0;
+            for (int m = 0; m < c.num_members; m++) {
+                int u = c.members_ids[m] - 1;
+                delta = fmax(delta, fabs(next[u] - visits[u]));
+                visits[u] = next[u];
+            }
+            if (delta < 1e-12) break;
+        }
+        if (iter > 100000) iter = 100000;
+        profile_count_iterations(iter);
+        profile_count_flops(2LL * iter * internal_edges);
+
+        // La masse qui sort de la classe rejoint les classes atteintes (persistantes : définitivement)
+        for (int m = 0; m < c.num_members; m++) {
+            int u = c.members_ids[m] - 1;
+            for (int e = P->row_ptr[u]; e < P->row_ptr[u + 1]; e++) {
+                int w = P->col_idx[e];
+                int target = partition.v_data[w].class_id - 1;
+                if (target == i) continue;
+                if (partition.classes[target].is_persistent) class_mass[target] += visits[u] * P->values[e];
+                else mass[w] += visits[u] * P->values[e];
+            }
+        }
+    }
+
+    free(mass);
+    free(visits);
+    free(next);
+    return 0;
+}
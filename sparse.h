@@ -0,0 +1,132 @@
+#ifndef SPARSE_H
+#define SPARSE_H
+
+#include "graph.h"
+#include "tarjan.h"
+
+//Matrice de transition creuse au format CSR (Compressed Sparse Row), indices 0-based.
+//Les arêtes sortantes du sommet i (0-based) sont col_idx[row_ptr[i] .. row_ptr[i+1]-1].
+typedef struct s_csr {
+    int num_vertices;  // Nombre de sommets (N)
+    int num_edges;     // Nombre d'arêtes (E)
+    int *row_ptr;      // N + 1 entrées
+    int *col_idx;      // E entrées : sommet d'arrivée (0-based)
+    float *values;     // E entrées : probabilité de la transition
+} t_csr;
+
+//Convertit la liste d'adjacence en CSR. Mémoire O(N + E) au lieu de N² pour t_matrix. row_ptr vaut NULL si la mémoire manque.
+t_csr graph_to_csr(t_graph graph);
+
+//Libère la mémoire allouée pour la matrice CSR.
+void free_csr(t_csr csr);
+
+//Index des arêtes entrantes : CSR de la transposée de P. La ligne j liste les prédécesseurs i de j (col_idx, par ordre
+//croissant) et P(i, j) (values). row_ptr vaut NULL si la mémoire manque.
+t_csr csr_transpose(const t_csr *P);
+
+//Produit vecteur-matrice y = x P (une étape de la chaîne). x et y ont N cases et doivent être distincts.
+void csr_vector_step(const t_csr *P, const double *x, double *y);
+
+//Même produit par tirage sur la transposée PT (csr_transpose) : y[j] = somme des x[i] P(i, j), chaque case de y écrite
+//une seule fois, sans accumulation dispersée.
+void csr_pull_step(const t_csr *PT, const double *x, double *y);
+
+//Même produit pour un bloc de B vecteurs : Y = X P, X et Y (N x B) rangés état par état (X[i * B + b] : masse de l'état i
+//dans le vecteur b). X et Y doivent être distincts.
+void csr_block_step(const t_csr *P, const double *X, double *Y, int B);
+
+//Octets de x et de y lus par paquet de colonnes dans csr_mode_step, et colonnes au moins par paquet.
+#define SPARSE_MODE_TILE_BYTES (4LL * 1024 * 1024)
+#define SPARSE_MODE_MIN_TILE 64
+
+//Produit le long d'un mode d'un vecteur de L x N x R cases (N = états de P, dernier indice le plus rapide) :
+//Y = X (I_L ⊗ P ⊗ I_R), chacune des L tranches étant un bloc de R vecteurs (csr_block_step). X et Y doivent être distincts.
+void csr_mode_step(const t_csr *P, const double *X, double *Y, long long L, int R);
+
+//Distribution après k étapes en partant de x0 : out = x0 P^k. out doit avoir N cases. Retourne 0 si succès, -1 si la mémoire manque.
+int k_step_distribution(const t_csr *P, const double *x0, int k, double *out);
+
+//Distribution stationnaire d'une classe persistante (itération de puissance). Seules les cases des membres de pi (N cases) sont écrites.
+//work est un tampon de N cases réutilisable d'une classe à l'autre, ou NULL pour l'allouer à chaque appel. *converged (si non
+//NULL) reçoit 0 si max_iter est atteint avant epsilon. Retourne le nombre d'itérations effectuées, -1 si la classe est
+//transitoire ou si l'allocation échoue.
+int class_stationary_distribution(const t_csr *P, t_partition partition, int class_index,
+                                  double *pi, double epsilon, int max_iter, double *work, int *converged);
+
+//Comme class_stationary_distribution, mais en partant des valeurs des membres déjà présentes dans pi (départ à chaud,
+//par exemple après une petite modification de la chaîne). Départ uniforme si elles sont toutes nulles.
+int class_stationary_distribution_warm(const t_csr *P, t_partition partition, int class_index,
+                                       double *pi, double epsilon, int max_iter, double *work, int *converged);
+
+//Suivi d'une longue itération stationnaire (points de reprise) : observe est appelée après chaque itération qui n'a pas
+//encore convergé, avec l'itéré (N cases), le numéro de l'itération et son écart sum(|pi_k - pi_(k-1)|).
+typedef struct s_stationary_monitor {
+    void (*observe)(void *data, const double *pi, int iteration, double diff);
+    void *data;
+} t_stationary_monitor;
+
+//Comme class_stationary_distribution, en reprenant après start_iter itérations déjà faites : pi contient alors l'itéré
+//atteint, repris tel quel (départ uniforme si start_iter vaut 0). max_iter compte toutes les itérations ; monitor peut
+//valoir NULL. Retourne le nombre total d'itérations, -1 si la classe est transitoire ou si la mémoire manque.
+int class_stationary_resume(const t_csr *P, t_partition partition, int class_index, double *pi, double epsilon,
+                            int max_iter, int start_iter, const t_stationary_monitor *monitor, double *work,
+                            int *converged);
+
+//Période d'une classe par parcours en largeur : PGCD des (niveau(u) + 1 - niveau(v)) sur les arêtes internes.
+int class_period_sparse(const t_csr *P, t_partition partition, int class_index);
+
+//Période d'une classe et sous-classe cyclique de chaque membre : phase (N cases) reçoit, pour chaque membre, un numéro
+//de 0 à période - 1 tel que toute arête interne mène de la sous-classe r à la sous-classe r + 1 (modulo la période).
+//Retourne la période, -1 si l'allocation échoue.
+int class_cyclic_subclasses(const t_csr *P, t_partition partition, int class_index, int *phase);
+
+//Probabilités d'absorption rangées en creux. Les classes persistantes qu'un sommet peut atteindre sont celles que sa
+//classe atteint : la ligne du sommet ne couvre que ces colonnes, communes à tous les membres de la classe. Au-delà de
+//max_values valeurs (absorption_layout), rien n'est gardé (values vaut NULL) et chaque requête refait le calcul.
+typedef struct s_absorption {
+    int num_classes;           // Classes de la partition
+    int num_persistent;        // Nombre de classes persistantes K
+    long long *class_ptr;      // num_classes + 1 cases : colonnes de la classe i dans columns[class_ptr[i] .. class_ptr[i + 1] - 1]
+    int *columns;              // Classes persistantes atteintes (indices 0-based), croissantes
+    long long *row_start;      // N cases : première valeur de chaque sommet dans values
+    double *values;            // Probabilités, NULL si elles ne sont pas gardées
+    long long num_values;
+} t_absorption;
+
+//Prépare les lignes de chaque sommet (colonnes de sa classe) et alloue les valeurs, à zéro. Retourne 0, 1 si les valeurs
+//dépasseraient max_values (rien n'est gardé, A->num_persistent est rempli), ou -1 si l'allocation échoue.
+int absorption_layout(const t_csr *P, t_partition partition, long long max_values, t_absorption *A);
+
+//Recalcule row_start depuis class_ptr et la partition (après lecture des colonnes et des valeurs). Retourne 0, -1 sinon.
+int absorption_index_rows(t_absorption *A, t_partition partition);
+
+//Libère les tableaux (la structure redevient vide).
+void absorption_free(t_absorption *A);
+
+//Probabilités d'absorption dans chaque classe persistante : absorption_layout puis, classe par classe, 1 pour les
+//membres d'une classe persistante et class_absorption pour une transitoire. Retourne K, ou -1 si l'allocation échoue.
+int absorption_probabilities(const t_csr *P, t_partition partition, long long max_values, t_absorption *A);
+
+//Probabilités d'absorption des membres d'une classe transitoire, les classes qu'elle atteint étant déjà résolues. Les
+//valeurs des membres servent de point de départ. slot (num_classes cases à -1) et acc (K cases) sont des tampons.
+//Retourne le nombre d'itérations.
+int class_absorption(const t_csr *P, t_partition partition, int class_index, t_absorption *A, int *slot, double *acc);
+
+//Probabilités d'absorption du sommet v (0-based) : class_mass (num_classes cases) reçoit, pour chaque classe, la
+//probabilité d'y finir (0 pour les transitoires). Lues dans A si les valeurs sont gardées, recalculées sinon
+//(absorption_from_vertex). Retourne 0, ou -1 si l'allocation échoue.
+int absorption_row(const t_csr *P, t_partition partition, const t_absorption *A, int v, double *class_mass);
+
+//Probabilité de finir dans la classe class_index (0-based) depuis le sommet v (0-based), lue dans A. Retourne -1 si les
+//valeurs ne sont pas gardées.
+double absorption_lookup(const t_absorption *A, t_partition partition, int v, int class_index);
+
+//Probabilité de finir dans la classe class_index (0-based) depuis chaque sommet : h (N cases). Lue dans A si les valeurs
+//sont gardées, sinon résolue classe par classe sur une seule colonne (mémoire O(N)). Retourne 0, ou -1 si l'allocation échoue.
+int absorption_column(const t_csr *P, t_partition partition, const t_absorption *A, int class_index, double *h);
+
+//Probabilités d'absorption depuis le seul sommet v (0-based) : class_mass (num_classes cases) reçoit, pour chaque
+//classe persistante, la probabilité d'y finir (0 pour les transitoires). Mémoire O(N). Retourne 0, ou -1 si l'allocation échoue.
+int absorption_from_vertex(const t_csr *P, t_partition partition, int v, double *class_mass);
+
+#endif // SPARSE_H
@@ -0,0 +1,463 @@
+#include "spectral.h"
+#include <complex.h>
+#include <float.h>
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "profile.h"
+
+//Itérations QR au plus par valeur propre ; au-delà, la case diagonale sert d'approximation.
+#define HESSENBERG_MAX_ITER 100
+
+const char *spectral_solver_name(t_spectral_solver solver) {
+    switch (solver) {
+        case SPECTRAL_SOLVER_ITERATE: return "iteration";
+        case SPECTRAL_SOLVER_SQUARE:  return "carres";
+        case SPECTRAL_SOLVER_DIRECT:  return "gauss";
+    }
+    return "?";
+}
+
+/*
+   hessenberg_eigenvalues :
+   Valeurs propres d'une matrice de Hessenberg supérieure n x n (H, ligne par ligne,
+   écrasée) par l'algorithme QR avec décalage de Wilkinson, en complexes : les paires
+   conjuguées n'ont pas besoin de blocs 2 x 2. Chaque pas factorise la partie active
+   H - mu I = QR par rotations de Givens puis forme RQ + mu I ; une valeur propre se
+   détache dès qu'une case sous-diagonale devient négligeable.
+*/
+static void hessenberg_eigenvalues(double complex *H, int n, double complex *eig) {
+    double norm = 0.0;
+    for (int i = 0; i < n * n; i++) norm += cabs(H[i]);
+    if (norm == 0.0) norm = 1.0;
+
+    double complex *c = (double complex *)malloc((n > 0 ? n : 1) * sizeof(double complex));
+    double complex *s = (double complex *)malloc((n > 0 ? n : 1) * sizeof(double complex));
+    if (c == NULL || s == NULL) {
+        // Sans tampons, la diagonale tient lieu d'approximation
+        for (int i = 0; i < n; i++) eig[i] = H[i * n + i];
+        free(c);
+        free(s);
+        return;
+    }
+
+    int hi = n - 1, iter = 0;
+    while (hi >= 0) {
+        int lo = hi;
+        while (lo > 0) {
+            double scale = cabs(H[(lo - 1) * n + lo - 1]) + cabs(H[lo * n + lo]);
+            if (scale == 0.0) scale = norm;
+            if (cabs(H[lo * n + lo - 1]) <= DBL_EPSILON * scale) {
+                H[lo * n + lo - 1] = 0.0;
+                break;
+            }
+            lo--;
+        }
+        if (lo == hi || iter >= HESSENBERG_MAX_ITER) {
+            eig[hi] = H[hi * n + hi];
+            hi--;
+            iter = 0;
+            continue;
+        }
+        iter++;
+
+        // Décalage : valeur propre du bloc 2 x 2 final la plus proche de la dernière case (exceptionnel toutes les 10 itérations)
+        double complex a = H[(hi - 1) * n + hi - 1], b = H[(hi - 1) * n + hi];
+        double complex g = H[hi * n + hi - 1], d = H[hi * n + hi];
+        double complex mu;
+        if (iter % 10 == 0) {
+            mu = d + cabs(g);
+        } else {
+            double complex half = (a + d) / 2.0;
+            double complex root = csqrt(half * half - (a * d - b * g));
+            double complex mu1 = half + root, mu2 = half - root;
+            mu = (cabs(mu1 - d) < cabs(mu2 - d)) ? mu1 : mu2;
+        }
+
+        for (int k = lo; k <= hi; k++) H[k * n + k] -= mu;
+        for (int k = lo; k < hi; k++) {
+            double complex x = H[k * n + k], y = H[(k + 1) * n + k];
+            double r = sqrt(creal(x * conj(x)) + creal(y * conj(y)));
+            c[k] = (r == 0.0) ? 1.0 : x / r;
+            s[k] = (r == 0.0) ? 0.0 : y / r;
+            for (int j = k; j <= hi; j++) {
+                double complex top = H[k * n + j], bottom = H[(k + 1) * n + j];
+                H[k * n + j] = conj(c[k]) * top + conj(s[k]) * bottom;
+                H[(k + 1) * n + j] = -s[k] * top + c[k] * bottom;
+            }
+        }
+        for (int k = lo; k < hi; k++) {
+            for (int i = lo; i <= k + 1; i++) {
+                double complex left = H[i * n + k], right = H[i * n + k + 1];
+                H[i * n + k] = left * c[k] + right * s[k];
+                H[i * n + k + 1] = -left * conj(s[k]) + right * conj(c[k]);
+            }
+        }
+        for (int k = lo; k <= hi; k++) H[k * n + k] += mu;
+    }
+
+    free(c);
+    free(s);
+}
+
+/*
+   class_operator :
+   w = A x sur les membres de la classe (indices locaux, local[v] : rang du sommet v).
+   Classe persistante : A = (I - 1 1^T / k) P_C. Comme P 1 = 1, A a les valeurs propres
+   de P_C sauf 1 (remplacée par 0, hors du sous-espace des vecteurs de somme nulle où
+   reste l'itération). Classe transitoire : A = P_C, les arêtes sortantes sont ignorées.
+*/
+static void class_operator(const t_csr *P, t_partition partition, int class_index, const int *local,
+                           const double *x, double *w) {
+    t_class c = partition.classes[class_index];
+    int k = c.num_members;
+    double mean = 0.0;
+
+    for (int m = 0; m < k; m++) {
+        int u = c.members_ids[m] - 1;
+        double sum = 0.0;
+        if (c.is_persistent) {
+            // Classe fermée : toutes les arêtes restent dans la classe
+            for (int e = P->row_ptr[u]; e < P->row_ptr[u + 1]; e++) sum += P->values[e] * x[local[P->col_idx[e]]];
+        } else {
+            for (int e = P->row_ptr[u]; e < P->row_ptr[u + 1]; e++) {
+                int v = P->col_idx[e];
+                if (partition.v_data[v].class_id - 1 == class_index) sum += P->values[e] * x[local[v]];
+            }
+        }
+        w[m] = sum;
+        mean += sum;
+    }
+    if (c.is_persistent) {
+        mean /= k;
+        for (int m = 0; m < k; m++) w[m] -= mean;
+    }
+}
+
+//Tampons partagés par les estimations de toutes les classes.
+typedef struct s_arnoldi_work {
+    int max_dim;              // Dimension maximale du sous-espace de Krylov
+    int *local;               // N cases : rang de chaque sommet dans sa classe
+    double *V;                // (max_dim + 1) x (plus grande classe) : base de Krylov
+    double *H;                // (max_dim + 1) x max_dim : matrice de Hessenberg
+    double complex *hess;     // max_dim x max_dim : copie complexe de H (valeurs propres, vecteur de Ritz)
+    double complex *ritz;     // max_dim : valeurs de Ritz
+    double complex *y;        // max_dim : vecteur propre de H
+} t_arnoldi_work;
+
+/*
+   arnoldi :
+   dim pas d'Arnoldi depuis V[0] (normé, de somme nulle pour une persistante), Gram-Schmidt
+   modifié, répété une fois si nécessaire. Un vecteur nul signale un sous-espace invariant : *exact
+   passe à 1 et ses valeurs de Ritz sont des valeurs propres exactes. Retourne le nombre
+   de pas effectués.
+*/
+static int arnoldi(const t_csr *P, t_partition partition, int class_index, t_arnoldi_work *work, int dim, int *exact) {
+    int k = partition.classes[class_index].num_members;
+    double *V = work->V, *H = work->H;
+    int built = 0;
+
+    for (int i = 0; i < (dim + 1) * dim; i++) H[i] = 0.0;
+    for (int j = 0; j < dim; j++) {
+        double *w = V + (long long)(j + 1) * k;
+        class_operator(P, partition, class_index, work->local, V + (long long)j * k, w);
+        double scale = 0.0;
+        for (int m = 0; m < k; m++) scale += w[m] * w[m];
+
+        // Seconde passe seulement si la première a fait perdre plus de 30 % de la norme (critère DGKS)
+        double h = sqrt(scale);
+        for (int pass = 0; pass < 2; pass++) {
+            double before = h;
+            for (int i = 0; i <= j; i++) {
+                const double *v = V + (long long)i * k;
+                double dot = 0.0;
+                for (int m = 0; m < k; m++) dot += v[m] * w[m];
+                for (int m = 0; m < k; m++) w[m] -= dot * v[m];
+                H[i * dim + j] += dot;
+            }
+            h = 0.0;
+            for (int m = 0; m < k; m++) h += w[m] * w[m];
+            h = sqrt(h);
+            if (h > 0.7 * before) break;
+        }
+        built = j + 1;
+
+        if (h == 0.0 || h <= 1e-10 * sqrt(scale)) {
+            *exact = 1;
+            break;
+        }
+        H[(j + 1) * dim + j] = h;
+        for (int m = 0; m < k; m++) w[m] /= h;
+    }
+    profile_count_iterations(built);
+    profile_count_flops((long long)built * (2LL * built + 2LL) * k);
+    return built;
+}
+
+//Copie complexe de la partie n x n de H (dim colonnes).
+static void load_hessenberg(const t_arnoldi_work *work, int dim, int n) {
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) work->hess[i * n + j] = work->H[i * dim + j];
+    }
+}
+
+/*
+   ritz_vector :
+   Vecteur propre y de H (n x n) pour la valeur de Ritz theta, par deux pas d'itération
+   inverse : élimination de Gauss avec pivot partiel sur H - theta I (décalage légèrement
+   perturbé pour qu'elle reste inversible).
+*/
+static void ritz_vector(t_arnoldi_work *work, int dim, int n, double complex theta) {
+    double complex *A = work->hess, *y = work->y;
+    double complex shift = theta + 1e-10 * (1.0 + cabs(theta));
+
+    for (int i = 0; i < n; i++) y[i] = 1.0;
+    for (int step = 0; step < 2; step++) {
+        load_hessenberg(work, dim, n);
+        for (int i = 0; i < n; i++) A[i * n + i] -= shift;
+        for (int col = 0; col < n; col++) {
+            int pivot = col;
+            for (int i = col + 1; i < n; i++) {
+                if (cabs(A[i * n + col]) > cabs(A[pivot * n + col])) pivot = i;
+            }
+            if (pivot != col) {
+                for (int j = 0; j < n; j++) {
+                    double complex t = A[col * n + j];
+                    A[col * n + j] = A[pivot * n + j];
+                    A[pivot * n + j] = t;
+                }
+                double complex t = y[col];
+                y[col] = y[pivot];
+                y[pivot] = t;
+            }
+            if (A[col * n + col] == 0.0) A[col * n + col] = DBL_EPSILON;
+            for (int i = col + 1; i < n; i++) {
+                double complex factor = A[i * n + col] / A[col * n + col];
+                if (factor == 0.0) continue;
+                for (int j = col; j < n; j++) A[i * n + j] -= factor * A[col * n + j];
+                y[i] -= factor * y[col];
+            }
+        }
+        double norm = 0.0;
+        for (int i = n - 1; i >= 0; i--) {
+            double complex sum = y[i];
+            for (int j = i + 1; j < n; j++) sum -= A[i * n + j] * y[j];
+            y[i] = sum / A[i * n + i];
+            norm += creal(y[i] * conj(y[i]));
+        }
+        norm = sqrt(norm);
+        for (int i = 0; i < n && norm > 0.0; i++) y[i] /= norm;
+    }
+}
+
+/*
+   class_estimate :
+   Arnoldi avec redémarrages explicites : le premier cycle, court, part d'un vecteur
+   pseudo-aléatoire (xorshift, graine fixe : résultats reproductibles), les suivants de
+   la partie réelle du vecteur de Ritz du mode le plus lent de (I + P) / 2, ce qui
+   concentre la base sur ce mode. Les estimations retenues sont les plus grandes de
+   tous les cycles (les valeurs de Ritz approchent le spectre par l'intérieur).
+   L'effort suit l'enjeu : une classe dont la résolution (à epsilon près) coûterait
+   moins de SPECTRAL_COST_RATIO cycles complets garde l'estimation du premier cycle.
+*/
+static void class_estimate(const t_csr *P, t_partition partition, int class_index, t_arnoldi_work *work,
+                           double epsilon, t_spectral_estimate *out) {
+    t_class c = partition.classes[class_index];
+    int k = c.num_members;
+    int space = c.is_persistent ? k - 1 : k;
+    int full_dim = (space < work->max_dim) ? space : work->max_dim;
+    int dim = (full_dim == space || full_dim < SPECTRAL_FIRST_DIM) ? full_dim : SPECTRAL_FIRST_DIM; // Petite classe : spectre exact d'emblée
+    double *V = work->V;
+
+    double edges = 0.0;
+    for (int m = 0; m < k; m++) {
+        int u = c.members_ids[m] - 1;
+        edges += P->row_ptr[u + 1] - P->row_ptr[u];
+    }
+
+    unsigned long long state = 0x9E3779B97F4A7C15ULL ^ (unsigned long long)(class_index + 1);
+    for (int m = 0; m < k; m++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        V[m] = (double)(state >> 11) / (double)(1ULL << 53) + 0.5;
+    }
+
+    double previous = -1.0;
+    for (int cycle = 0; cycle < SPECTRAL_RESTARTS; cycle++) {
+        // Vecteur de départ : somme nulle pour une classe persistante, normé
+        double mean = 0.0, norm = 0.0;
+        for (int m = 0; m < k; m++) mean += V[m];
+        mean /= k;
+        for (int m = 0; m < k; m++) {
+            if (c.is_persistent) V[m] -= mean;
+            norm += V[m] * V[m];
+        }
+        norm = sqrt(norm);
+        if (norm == 0.0) break;
+        for (int m = 0; m < k; m++) V[m] /= norm;
+
+        out->exact = (dim >= space);
+        int built = arnoldi(P, partition, class_index, work, dim, &out->exact);
+        if (built > out->krylov_dim) out->krylov_dim = built;
+        load_hessenberg(work, dim, built);
+        hessenberg_eigenvalues(work->hess, built, work->ritz);
+
+        int slowest = 0;
+        for (int i = 0; i < built; i++) {
+            double modulus = cabs(work->ritz[i]);
+            double lazy = cabs(1.0 + work->ritz[i]) / 2.0;
+            if (modulus > out->slem) out->slem = modulus;
+            if (modulus < 1.0 - SPECTRAL_UNIT_TOLERANCE && modulus > out->inner_slem) out->inner_slem = modulus;
+            if (lazy > out->lazy_slem) out->lazy_slem = lazy;
+            if (lazy > cabs(1.0 + work->ritz[slowest]) / 2.0) slowest = i;
+        }
+        if (out->exact || out->lazy_slem - previous <= SPECTRAL_RESTART_TOLERANCE * (1.0 - out->lazy_slem)) break;
+        previous = out->lazy_slem;
+
+        // Un cycle de plus seulement si la résolution attendue coûte bien plus que lui
+        double solve = (double)spectral_lazy_iterations(out, epsilon) * (2.0 * edges + 4.0 * k);
+        double cycle_cost = full_dim * (2.0 * edges + 4.0 * full_dim * k);
+        if (solve < SPECTRAL_COST_RATIO * cycle_cost) break;
+
+        // Redémarrage : x = Re(V y), rangé dans V[0] (la base est reconstruite au cycle suivant)
+        ritz_vector(work, dim, built, work->ritz[slowest]);
+        double *x = V + (long long)built * k; // Dernier vecteur de la base, inutile au redémarrage
+        for (int m = 0; m < k; m++) x[m] = 0.0;
+        for (int i = 0; i < built; i++) {
+            double weight = creal(work->y[i]);
+            const double *v = V + (long long)i * k;
+            for (int m = 0; m < k; m++) x[m] += weight * v[m];
+        }
+        for (int m = 0; m < k; m++) V[m] = x[m];
+        dim = full_dim;
+    }
+}
+
+/*
+   spectral_estimates :
+   Une base de Krylov et une table de rangs locaux (N cases) partagées par toutes les
+   classes. La dimension est au plus SPECTRAL_KRYLOV_DIM, la dimension de l'espace
+   (k - 1 après déflation pour une persistante) et SPECTRAL_MAX_BASIS_VALUES / k.
+*/
+int spectral_estimates(const t_csr *P, t_partition partition, double epsilon, t_spectral_estimate *estimates) {
+    int N = P->num_vertices;
+    int largest = 1;
+    for (int i = 0; i < partition.num_classes; i++) {
+        if (partition.classes[i].num_members > largest) largest = partition.classes[i].num_members;
+    }
+    t_arnoldi_work work;
+    work.max_dim = SPECTRAL_KRYLOV_DIM;
+    if ((long long)(work.max_dim + 1) * largest > SPECTRAL_MAX_BASIS_VALUES) work.max_dim = SPECTRAL_MAX_BASIS_VALUES / largest - 1;
+    if (work.max_dim < 2) work.max_dim = 2;
+
+    int max_dim = work.max_dim;
+    work.local = (int *)malloc((N > 0 ? N : 1) * sizeof(int));
+    work.V = (double *)malloc((long long)(max_dim + 1) * largest * sizeof(double));
+    work.H = (double *)malloc((max_dim + 1) * max_dim * sizeof(double));
+    work.hess = (double complex *)malloc(max_dim * max_dim * sizeof(double complex));
+    work.ritz = (double complex *)malloc(max_dim * sizeof(double complex));
+    work.y = (double complex *)malloc(max_dim * sizeof(double complex));
+    int failed = (work.local == NULL || work.V == NULL || work.H == NULL || work.hess == NULL
+                  || work.ritz == NULL || work.y == NULL);
+    if (failed) perror("Allocation failed for spectral estimates");
+
+    for (int i = 0; i < partition.num_classes && !failed; i++) {
+        t_class c = partition.classes[i];
+        t_spectral_estimate *out = &estimates[i];
+        *out = (t_spectral_estimate){0, 1, 0.0, 0.0, 0.0, 1.0, 1.0};
+        int space = c.is_persistent ? c.num_members - 1 : c.num_members;
+        if (space == 0) continue; // État absorbant : pas d'autre valeur propre que 1
+
+        for (int m = 0; m < c.num_members; m++) work.local[c.members_ids[m] - 1] = m;
+        class_estimate(P, partition, i, &work, epsilon, out);
+
+        out->gap = (out->slem < 1.0) ? 1.0 - out->slem : 0.0;
+        out->relaxation_time = (out->gap > 0.0) ? 1.0 / out->gap : HUGE_VAL;
+    }
+
+    free(work.local);
+    free(work.V);
+    free(work.H);
+    free(work.hess);
+    free(work.ritz);
+    free(work.y);
+    return failed ? -1 : 0;
+}
+
+t_spectral_estimate spectral_worst(const t_spectral_estimate *estimates, int num_classes) {
+    t_spectral_estimate worst = {0, 1, 0.0, 0.0, 0.0, 1.0, 1.0};
+    for (int i = 0; i < num_classes; i++) {
+        const t_spectral_estimate *e = &estimates[i];
+        if (e->krylov_dim > worst.krylov_dim) worst.krylov_dim = e->krylov_dim;
+        worst.exact = worst.exact && e->exact;
+        if (e->slem > worst.slem) worst.slem = e->slem;
+        if (e->inner_slem > worst.inner_slem) worst.inner_slem = e->inner_slem;
+        if (e->lazy_slem > worst.lazy_slem) worst.lazy_slem = e->lazy_slem;
+    }
+    worst.gap = (worst.slem < 1.0) ? 1.0 - worst.slem : 0.0;
+    worst.relaxation_time = (worst.gap > 0.0) ? 1.0 / worst.gap : HUGE_VAL;
+    return worst;
+}
+
+int spectral_steps(double rate, double scale, double epsilon) {
+    if (rate <= 0.0 || scale <= epsilon) return 1;
+    if (rate >= 1.0) return INT_MAX;
+    double steps = ceil(log(epsilon / scale) / log(rate));
+    if (steps >= (double)INT_MAX) return INT_MAX;
+    return (steps < 1.0) ? 1 : (int)steps;
+}
+
+int spectral_budget(int estimate, int max_iter) {
+    double budget = SPECTRAL_BUDGET_MARGIN * estimate + SPECTRAL_BUDGET_SLACK;
+    return (budget >= (double)max_iter) ? max_iter : (int)budget;
+}
+
+int spectral_lazy_iterations(const t_spectral_estimate *estimate, double epsilon) {
+    // L'écart en norme 1 entre deux distributions vaut au plus 2
+    return spectral_steps(estimate->lazy_slem, 2.0, epsilon);
+}
+
+/*
+   spectral_dense_products :
+   M^(dk) - M^(d(k-1)) décroît comme inner_slem^(dk) ; la somme des écarts des size x size
+   cases part d'au plus 2 size. L'itération fait n produits ; les élévations au carré
+   atteignent M^(2^s) avec 2^s >= n, plus un produit pour constater la convergence.
+*/
+int spectral_dense_products(const t_spectral_estimate *estimate, int period, int size, t_spectral_solver *solver) {
+    double rate = pow(estimate->inner_slem, period > 0 ? period : 1);
+    int products = spectral_steps(rate, 2.0 * size, SPECTRAL_DENSE_EPSILON);
+
+    int squarings = 1;
+    while (squarings < 31 && (1LL << squarings) < (long long)products) squarings++;
+    squarings++;
+
+    if (squarings < products) {
+        *solver = SPECTRAL_SOLVER_SQUARE;
+        return squarings;
+    }
+    *solver = SPECTRAL_SOLVER_ITERATE;
+    return products;
+}
+
+/*
+   spectral_class_solver :
+   Itération : n x (2 arêtes internes + 4 k) opérations ; élimination de Gauss :
+   2 k^3 / 3, plus la construction de la matrice k x k.
+*/
+t_spectral_solver spectral_class_solver(const t_spectral_estimate *estimate, int size, long long internal_edges, double epsilon) {
+    if (size <= 1 || size > SPECTRAL_DIRECT_MAX_STATES) return SPECTRAL_SOLVER_ITERATE;
+
+    double k = size;
+    double iterate = (double)spectral_lazy_iterations(estimate, epsilon) * (2.0 * internal_edges + 4.0 * k);
+    double direct = 2.0 * k * k * k / 3.0 + k * k + (double)internal_edges;
+    return (direct < iterate) ? SPECTRAL_SOLVER_DIRECT : SPECTRAL_SOLVER_ITERATE;
+}
+
+double spectral_mixing_time(const t_spectral_estimate *estimate, double pi_min, double epsilon) {
+    if (pi_min <= 0.0 || epsilon <= 0.0 || !isfinite(estimate->relaxation_time)) return HUGE_VAL;
+    double log_term = log(1.0 / (epsilon * pi_min));
+    return estimate->relaxation_time * (log_term > 0.0 ? log_term : 0.0);
+}
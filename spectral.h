@@ -0,0 +1,96 @@
+#ifndef SPECTRAL_H
+#define SPECTRAL_H
+
+#include "sparse.h"
+#include "tarjan.h"
+
+/*
+   Estimation spectrale des classes, avant toute résolution.
+   La vitesse de convergence des itérations (puissances de M, itération de (I + P) / 2)
+   est fixée par le second plus grand module des valeurs propres (SLEM) : l'écart
+   décroît comme |lambda_2|^n. Une itération d'Arnoldi sur la CSR de la classe donne
+   une estimation de |lambda_2| en quelques dizaines de produits creux, d'où un nombre
+   d'itérations attendu, un budget d'itérations et le choix du solveur.
+   Les valeurs de Ritz approchent les valeurs propres extrêmes par l'intérieur : les
+   estimations sont des minorants, les budgets gardent une marge.
+*/
+
+//Dimension maximale du sous-espace de Krylov (estimation exacte si la classe a au plus SPECTRAL_KRYLOV_DIM + 1 états).
+#define SPECTRAL_KRYLOV_DIM 30
+
+//Dimension du premier cycle d'Arnoldi, qui suffit aux classes rapides à converger.
+#define SPECTRAL_FIRST_DIM 16
+
+//Cycles d'Arnoldi au plus par classe (redémarrage depuis le mode le plus lent) ; arrêt quand 1 - lazy_slem
+//varie de moins de SPECTRAL_RESTART_TOLERANCE en relatif.
+#define SPECTRAL_RESTARTS 8
+#define SPECTRAL_RESTART_TOLERANCE 1e-3
+
+//Un cycle complet de plus n'est lancé que si la résolution attendue coûte plus de SPECTRAL_COST_RATIO fois ce cycle.
+#define SPECTRAL_COST_RATIO 8.0
+
+//Cases au plus dans la base de Krylov (dimension réduite pour les très grandes classes, 32 Mo).
+#define SPECTRAL_MAX_BASIS_VALUES (1 << 22)
+
+//Une valeur propre de module supérieur à 1 - SPECTRAL_UNIT_TOLERANCE est sur le cercle unité (classe périodique).
+#define SPECTRAL_UNIT_TOLERANCE 1e-5
+
+//Budget d'itérations : SPECTRAL_BUDGET_MARGIN fois l'estimation, plus SPECTRAL_BUDGET_SLACK.
+#define SPECTRAL_BUDGET_MARGIN 2.0
+#define SPECTRAL_BUDGET_SLACK 20
+
+//Au-delà de cette taille, une classe n'est jamais résolue par élimination de Gauss (matrice k x k en double).
+#define SPECTRAL_DIRECT_MAX_STATES 2048
+
+//Tolérance de l'itération dense (stationaryDistribution : somme des écarts des k x k cases).
+#define SPECTRAL_DENSE_EPSILON 0.01
+
+//Estimation spectrale d'une classe.
+typedef struct s_spectral_estimate {
+    int krylov_dim;          // Dimension du sous-espace de Krylov, 0 pour une classe d'un seul état
+    int exact;               // 1 si le sous-espace est invariant : toutes les valeurs propres sont connues
+    double slem;             // Persistante : plus grand module des valeurs propres autres que 1 ; transitoire : rayon spectral du bloc
+    double inner_slem;       // Même chose sans les valeurs propres du cercle unité : vitesse de convergence de M^d (période d)
+    double lazy_slem;        // Même chose pour (I + P) / 2 : max |1 + lambda| / 2, toujours < 1 sur une classe persistante
+    double gap;              // Trou spectral 1 - slem (0 sur une classe périodique)
+    double relaxation_time;  // 1 / gap : temps de relaxation de P, en pas (infini si gap = 0 : la classe ne mélange pas)
+} t_spectral_estimate;
+
+//Solveur d'une étape stationnaire.
+typedef enum e_spectral_solver {
+    SPECTRAL_SOLVER_ITERATE = 0,  // Produits successifs (M^k ou itération de (I + P) / 2)
+    SPECTRAL_SOLVER_SQUARE,       // Élévations au carré successives de M (moteurs denses)
+    SPECTRAL_SOLVER_DIRECT        // Élimination de Gauss sur pi (P - I) = 0, somme des pi = 1
+} t_spectral_solver;
+
+//Nom d'un solveur ("iteration", "carres", "gauss").
+const char *spectral_solver_name(t_spectral_solver solver);
+
+//Estimation de chaque classe (estimates : num_classes cases) ; epsilon, la précision visée par la résolution,
+//règle l'effort consacré à chaque classe. Retourne 0, -1 si la mémoire manque.
+int spectral_estimates(const t_csr *P, t_partition partition, double epsilon, t_spectral_estimate *estimates);
+
+//Pire estimation de toutes les classes (celle de la matrice N x N) : plus grand slem, inner_slem et lazy_slem.
+t_spectral_estimate spectral_worst(const t_spectral_estimate *estimates, int num_classes);
+
+//Nombre de pas n tel que scale * rate^n < epsilon (1 si rate <= 0, INT_MAX si rate >= 1).
+int spectral_steps(double rate, double scale, double epsilon);
+
+//Budget d'itérations à partir d'une estimation (marge comprise), plafonné à max_iter.
+int spectral_budget(int estimate, int max_iter);
+
+//Itérations attendues de (I + P) / 2 sur une classe (écart en norme 1 inférieur à epsilon).
+int spectral_lazy_iterations(const t_spectral_estimate *estimate, double epsilon);
+
+//Produits de matrices k x k attendus pour la limite de M^(period k) à SPECTRAL_DENSE_EPSILON près, en itérant
+//ou par élévations au carré ; *solver reçoit le moins coûteux des deux.
+int spectral_dense_products(const t_spectral_estimate *estimate, int period, int size, t_spectral_solver *solver);
+
+//Solveur creux d'une classe persistante : élimination de Gauss si elle coûte moins que les itérations attendues.
+t_spectral_solver spectral_class_solver(const t_spectral_estimate *estimate, int size, long long internal_edges, double epsilon);
+
+//Borne du temps de mélange t_mix(epsilon) <= t_rel ln(1 / (epsilon pi_min)) (exacte pour une chaîne réversible). HUGE_VAL si
+//le trou est nul.
+double spectral_mixing_time(const t_spectral_estimate *estimate, double pi_min, double epsilon);
+
+#endif // SPECTRAL_H
@@ -3,19 +3,29 @@
 #include <stdlib.h>
 
 /*  
-   Variables globales utilisées par Tarjan pour gérer plus facilement 
-   la récursivité : un compteur de temps, une pile de sommets,
-   et des pointeurs vers la partition et le graphe en cours de traitement.
+   Contexte d'exécution de Tarjan : un compteur de temps, une pile de sommets,
+   un tampon temporaire pour les membres d'une classe, la pile d'appels du
+   parcours en profondeur (itératif) et des pointeurs vers la partition et le
+   graphe en cours de traitement. Pas de variable globale : plusieurs analyses
+   peuvent tourner en parallèle (mode batch).
 */
-static int current_time = 0;
-static t_stack vertex_stack;
-static t_partition *global_partition = NULL;
-static t_graph *global_graph = NULL;
+typedef struct s_tarjan_ctx {
+    int current_time;
+    t_stack vertex_stack;
+    int *temp_members;
+    int *call_stack;     // Chemin courant du parcours (sommets 1-based)
+    t_edge **next_edge;  // Par sommet : prochaine arête sortante à explorer
+    int failed;          // 1 si une allocation a échoué pendant le parcours
+    int class_capacity;  // Cases allouées dans partition->classes (doublées au besoin)
+    t_partition *partition;
+    const t_graph *graph;
+} t_tarjan_ctx;
 
 /*  
    create_stack :
    Initialise une pile capable de contenir un nombre donné d'éléments.
    Alloue la mémoire et prépare top = -1 pour indiquer qu’elle est vide.
+   data vaut NULL si l'allocation échoue.
 */
 t_stack create_stack(int capacity) {
     t_stack stack;
@@ -24,7 +34,7 @@ t_stack create_stack(int capacity) {
     stack.data = (int *)malloc(capacity * sizeof(int));
     if (stack.data == NULL) {
         perror("Stack allocation failed");
-        exit(EXIT_FAILURE);
+        stack.capacity = 0;
     }
     return stack;
 }
@@ -67,35 +77,41 @@ void free_stack(t_stack stack) {
    Fonction appelée quand Tarjan découvre la racine d’une CFC.
    Elle dépile tous les sommets appartenant à cette CFC, crée une nouvelle classe,
    leur assigne un identifiant de classe et les stocke dans la partition.
+   En cas d'échec d'allocation, marque le contexte en échec (ctx->failed).
 */
-static void add_new_class(int v_id) {
-    global_partition->num_classes++;
-    global_partition->classes = (t_class *)realloc(
-        global_partition->classes,
-        global_partition->num_classes * sizeof(t_class)
-    );
-    if (global_partition->classes == NULL) {
-        perror("Realloc failed for classes");
-        exit(EXIT_FAILURE);
-    }
-
-    t_class *new_class = &global_partition->classes[global_partition->num_classes - 1];
-    new_class->id = global_partition->num_classes;
+static void add_new_class(t_tarjan_ctx *ctx, int v_id) {
+    t_partition *partition = ctx->partition;
+    // Capacité doublée : une réallocation par classe recopiait tout le tableau (quadratique en nombre de classes)
+    if (partition->num_classes == ctx->class_capacity) {
+        int new_capacity = (ctx->class_capacity > 0) ? 2 * ctx->class_capacity : 16;
+        t_class *classes = (t_class *)realloc(partition->classes, new_capacity * sizeof(t_class));
+        if (classes == NULL) {
+            perror("Realloc failed for classes");
+            ctx->failed = 1;
+            return;
+        }
+        partition->classes = classes;
+        ctx->class_capacity = new_capacity;
+    }
+    partition->num_classes++;
+
+    t_class *new_class = &partition->classes[partition->num_classes - 1];
+    new_class->id = partition->num_classes;
     new_class->num_members = 0;
     new_class->members_ids = NULL;
     new_class->is_persistent = 0;
 
     int current_vertex_id;
-    int temp_members[global_partition->v_data[0].vertex_id];
+    int *temp_members = ctx->temp_members;
 
     do {
-        current_vertex_id = pop(&vertex_stack);
+        current_vertex_id = pop(&ctx->vertex_stack);
         if (current_vertex_id == -1) break;
 
         int index = current_vertex_id - 1;
 
-        global_partition->v_data[index].on_stack = 0;
-        global_partition->v_data[index].class_id = new_class->id;
+        partition->v_data[index].on_stack = 0;
+        partition->v_data[index].class_id = new_class->id;
 
         temp_members[new_class->num_members++] = current_vertex_id;
     } while (current_vertex_id != v_id);
@@ -103,7 +119,8 @@ static void add_new_class(int v_id) {
     new_class->members_ids = (int *)malloc(new_class->num_members * sizeof(int));
     if (new_class->members_ids == NULL) {
         perror("Members_ids allocation failed");
-        exit(EXIT_FAILURE);
+        ctx->failed = 1;
+        return;
     }
 
     for (int i = 0; i < new_class->num_members; i++) {
@@ -111,42 +128,67 @@ static void add_new_class(int v_id) {
     }
 }
 
+//Première visite d'un sommet : num et low reçoivent le temps courant, le sommet est empilé.
+static void tarjan_visit(t_tarjan_ctx *ctx, int u_id) {
+    t_tarjan_vertex *u = &ctx->partition->v_data[u_id - 1];
+
+    u->num = ctx->current_time;
+    u->low = ctx->current_time;
+    ctx->current_time++;
+
+    push(&ctx->vertex_stack, u_id);
+    u->on_stack = 1;
+    ctx->next_edge[u_id - 1] = ctx->graph->adj_lists[u_id - 1].head;
+}
+
 /*  
    tarjan_dfs :
-   Fonction récursive centrale de l’algorithme de Tarjan.
+   Fonction centrale de l’algorithme de Tarjan, depuis un sommet racine.
    Attribue num et low, explore les voisins, détecte les arcs de retour,
    et identifie la racine d’une CFC pour déclencher sa création.
+   Le parcours en profondeur est itératif (pile call_stack + arête courante de
+   chaque sommet) : une chaîne de plusieurs millions de sommets ne fait pas
+   déborder la pile d'appels. Les classes sont créées dans le même ordre que
+   dans la version récursive.
 */
-static void tarjan_dfs(int u_id) {
-    int u_idx = u_id - 1;
+static void tarjan_dfs(t_tarjan_ctx *ctx, int root_id) {
+    t_tarjan_vertex *v_data = ctx->partition->v_data;
+    int depth = 0;
 
-    global_partition->v_data[u_idx].num = current_time;
-    global_partition->v_data[u_idx].low = current_time;
-    current_time++;
+    tarjan_visit(ctx, root_id);
+    ctx->call_stack[depth++] = root_id;
 
-    push(&vertex_stack, u_id);
-    global_partition->v_data[u_idx].on_stack = 1;
+    while (depth > 0) {
+        int u_id = ctx->call_stack[depth - 1];
+        int u_idx = u_id - 1;
+        t_edge *current_edge = ctx->next_edge[u_idx];
 
-    t_edge *current_edge = global_graph->adj_lists[u_idx].head;
-    while (current_edge != NULL) {
-        int v_id = current_edge->destination;
-        int v_idx = v_id - 1;
+        if (current_edge != NULL) {
+            ctx->next_edge[u_idx] = current_edge->next;
+            int v_idx = current_edge->destination - 1;
 
-        if (global_partition->v_data[v_idx].num == -1) {
-            tarjan_dfs(v_id);
-            if (global_partition->v_data[v_idx].low < global_partition->v_data[u_idx].low) {
-                global_partition->v_data[u_idx].low = global_partition->v_data[v_idx].low;
-            }
-        } else if (global_partition->v_data[v_idx].on_stack) {
-            if (global_partition->v_data[v_idx].num < global_partition->v_data[u_idx].low) {
-                global_partition->v_data[u_idx].low = global_partition->v_data[v_idx].num;
+            if (v_data[v_idx].num == -1) {
+                // "Appel récursif" : v passe en haut de la pile d'appels
+                tarjan_visit(ctx, current_edge->destination);
+                ctx->call_stack[depth++] = current_edge->destination;
+            } else if (v_data[v_idx].on_stack && v_data[v_idx].num < v_data[u_idx].low) {
+                v_data[u_idx].low = v_data[v_idx].num;
             }
+            continue;
         }
-        current_edge = current_edge->next;
-    }
 
-    if (global_partition->v_data[u_idx].low == global_partition->v_data[u_idx].num) {
-        add_new_class(u_id);
+        // Toutes les arêtes de u sont explorées : "retour" vers son parent
+        depth--;
+        if (v_data[u_idx].low == v_data[u_idx].num) {
+            add_new_class(ctx, u_id);
+            if (ctx->failed) return;
+        }
+        if (depth > 0) {
+            int parent_idx = ctx->call_stack[depth - 1] - 1;
+            if (v_data[u_idx].low < v_data[parent_idx].low) {
+                v_data[parent_idx].low = v_data[u_idx].low;
+            }
+        }
     }
 }
 
@@ -155,6 +197,7 @@ static void tarjan_dfs(int u_id) {
    Point d’entrée principal. Initialise toutes les données,
    lance l’algorithme sur tous les sommets (même si le graphe est déconnecté),
    collecte toutes les CFC et retourne la partition complète.
+   Si une allocation échoue, retourne une partition vide (v_data = NULL, num_classes = 0).
 */
 t_partition find_cfcs_tarjan(t_graph graph) {
     int N = graph.num_vertices;
@@ -166,7 +209,7 @@ t_partition find_cfcs_tarjan(t_graph graph) {
 
     if (partition.v_data == NULL) {
         perror("Partition v_data allocation failed");
-        exit(EXIT_FAILURE);
+        return partition;
     }
 
     for (int i = 0; i < N; i++) {
@@ -177,24 +220,139 @@ t_partition find_cfcs_tarjan(t_graph graph) {
         partition.v_data[i].class_id = 0;
     }
 
-    current_time = 0;
-    vertex_stack = create_stack(N);
-    global_partition = &partition;
-    global_graph = &graph;
+    t_tarjan_ctx ctx;
+    ctx.current_time = 0;
+    ctx.failed = 0;
+    ctx.class_capacity = 0;
+    ctx.vertex_stack = create_stack(N);
+    ctx.partition = &partition;
+    ctx.graph = &graph;
+    // Une classe contient au plus N sommets, le chemin du parcours aussi
+    ctx.temp_members = (int *)malloc(N * sizeof(int));
+    ctx.call_stack = (int *)malloc(N * sizeof(int));
+    ctx.next_edge = (t_edge **)malloc(N * sizeof(t_edge *));
+    if (ctx.temp_members == NULL || ctx.call_stack == NULL || ctx.next_edge == NULL
+        || ctx.vertex_stack.data == NULL) {
+        perror("Tarjan work buffers allocation failed");
+        ctx.failed = 1;
+    }
 
-    for (int i = 0; i < N; i++) {
+    for (int i = 0; i < N && !ctx.failed; i++) {
         if (partition.v_data[i].num == -1) {
-            tarjan_dfs(i + 1);
+            tarjan_dfs(&ctx, i + 1);
         }
     }
 
-    free_stack(vertex_stack);
-    global_partition = NULL;
-    global_graph = NULL;
+    free(ctx.temp_members);
+    free(ctx.call_stack);
+    free(ctx.next_edge);
+    free_stack(ctx.vertex_stack);
+
+    if (ctx.failed) {
+        free_partition(partition);
+        partition.classes = NULL;
+        partition.v_data = NULL;
+        partition.num_classes = 0;
+    }
 
     return partition;
 }
 
+/*
+   find_cfcs_subset :
+   Même parcours itératif que tarjan_dfs, limité au sous-graphe induit par k
+   sommets : les arêtes qui sortent du sous-ensemble sont ignorées. Sert à
+   recouper une seule classe après le retrait d'arêtes internes (delta.c) sans
+   relancer Tarjan sur tout le graphe : tous les tableaux sont de taille k,
+   sauf local (N cases) que l'appelant garde d'un appel à l'autre.
+   Les CFC sont numérotées dans l'ordre où Tarjan les termine : une CFC
+   n'atteint que des CFC de numéro plus petit.
+*/
+int find_cfcs_subset(t_graph graph, const int *members, int k, int *local, int *component) {
+    int *num = (int *)malloc(k * sizeof(int));
+    int *low = (int *)malloc(k * sizeof(int));
+    int *on_stack = (int *)malloc(k * sizeof(int));
+    int *vertex_stack = (int *)malloc(k * sizeof(int));
+    int *call_stack = (int *)malloc(k * sizeof(int));
+    t_edge **next_edge = (t_edge **)malloc(k * sizeof(t_edge *));
+
+    if (num == NULL || low == NULL || on_stack == NULL || vertex_stack == NULL
+        || call_stack == NULL || next_edge == NULL) {
+        perror("Tarjan subset buffers allocation failed");
+        free(num);
+        free(low);
+        free(on_stack);
+        free(vertex_stack);
+        free(call_stack);
+        free(next_edge);
+        return -1;
+    }
+
+    for (int m = 0; m < k; m++) {
+        local[members[m] - 1] = m;
+        num[m] = -1;
+        on_stack[m] = 0;
+    }
+
+    int current_time = 0, top = 0, count = 0;
+    for (int root = 0; root < k; root++) {
+        if (num[root] != -1) continue;
+
+        int depth = 0;
+        num[root] = low[root] = current_time++;
+        vertex_stack[top++] = root;
+        on_stack[root] = 1;
+        next_edge[root] = graph.adj_lists[members[root] - 1].head;
+        call_stack[depth++] = root;
+
+        while (depth > 0) {
+            int u = call_stack[depth - 1];
+            t_edge *current_edge = next_edge[u];
+
+            if (current_edge != NULL) {
+                next_edge[u] = current_edge->next;
+                int v = local[current_edge->destination - 1];
+                if (v < 0) continue; // Arête qui quitte le sous-ensemble
+
+                if (num[v] == -1) {
+                    num[v] = low[v] = current_time++;
+                    vertex_stack[top++] = v;
+                    on_stack[v] = 1;
+                    next_edge[v] = graph.adj_lists[members[v] - 1].head;
+                    call_stack[depth++] = v;
+                } else if (on_stack[v] && num[v] < low[u]) {
+                    low[u] = num[v];
+                }
+                continue;
+            }
+
+            depth--;
+            if (low[u] == num[u]) {
+                int w;
+                do {
+                    w = vertex_stack[--top];
+                    on_stack[w] = 0;
+                    component[w] = count;
+                } while (w != u);
+                count++;
+            }
+            if (depth > 0 && low[u] < low[call_stack[depth - 1]]) {
+                low[call_stack[depth - 1]] = low[u];
+            }
+        }
+    }
+
+    for (int m = 0; m < k; m++) local[members[m] - 1] = -1;
+
+    free(num);
+    free(low);
+    free(on_stack);
+    free(vertex_stack);
+    free(call_stack);
+    free(next_edge);
+    return count;
+}
+
 /*  
    display_partition :
    Affiche toutes les classes trouvées par Tarjan,
@@ -248,7 +406,7 @@ Quand un sommet est visité :
 On lui donne un index et un lowlink.
 On le met dans la pile.
 On explore ses voisins :
-S’ils ne sont pas visités →  parcour en profondeur sur eux
+S’ils ne sont pas visités →  parcour en profondeur sur eux (pile explicite, pas de récursion)
 Sinon, s’ils sont encore dans la pile → on met à jour le lowlink
 Quand le lowlink == index, cela signifie :
 → On a trouvé la racine d’une composante fortement connexe
@@ -41,9 +41,14 @@ void push(t_stack *stack, int vertex_id);
 int pop(t_stack *stack);
 void free_stack(t_stack stack);
 
-//Implémente l'algorithme de Tarjan pour trouver toutes les CFCs.
+//Implémente l'algorithme de Tarjan pour trouver toutes les CFCs. Retourne une partition vide (v_data = NULL) si la mémoire manque.
 t_partition find_cfcs_tarjan(t_graph graph);
 
+//CFC du sous-graphe induit par k sommets (members, 1-based), dans l'ordre de find_cfcs_tarjan (successeurs d'abord).
+//component[m] reçoit le numéro (0..) de la CFC de members[m]. local (N cases à -1) est un tampon de l'appelant, rendu à -1.
+//Retourne le nombre de CFC, -1 si la mémoire manque.
+int find_cfcs_subset(t_graph graph, const int *members, int k, int *local, int *component);
+
 //Affiche la partition complète (toutes les classes trouvées).
 void display_partition(t_partition partition);
 
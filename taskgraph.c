@@ -0,0 +1,276 @@
+#include "taskgraph.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+//Thread de l'exécution : prend les tâches de la file de son type.
+typedef struct s_task_worker {
+    t_task_graph *graph;
+    t_task_kind kind;
+} t_task_worker;
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+void taskgraph_init(t_task_graph *graph) {
+    memset(graph, 0, sizeof(*graph));
+}
+
+int taskgraph_add(t_task_graph *graph, const char *name, t_task_fn run, void *arg, t_task_kind kind) {
+    if (graph->num_tasks == TASKGRAPH_MAX_TASKS || run == NULL) return -1;
+    t_task *task = &graph->tasks[graph->num_tasks];
+    memset(task, 0, sizeof(*task));
+    task->name = name;
+    task->run = run;
+    task->arg = arg;
+    task->kind = kind;
+    return graph->num_tasks++;
+}
+
+/*
+   taskgraph_depends :
+   Une dépendance vers une tâche ajoutée avant garantit l'absence de cycle : l'ordre
+   d'ajout est un ordre topologique, celui de l'exécution sur un seul thread.
+*/
+int taskgraph_depends(t_task_graph *graph, int task, int on) {
+    if (task < 0 || task >= graph->num_tasks || on < 0 || on >= task) return -1;
+    t_task *t = &graph->tasks[task];
+    for (int d = 0; d < t->num_deps; d++) {
+        if (t->deps[d] == on) return 0;
+    }
+    if (t->num_deps == TASKGRAPH_MAX_DEPS) return -1;
+    t->deps[t->num_deps++] = on;
+    return 0;
+}
+
+//depends_on : la tâche t attend-elle la tâche on ?
+static int depends_on(const t_task *t, int on) {
+    for (int d = 0; d < t->num_deps; d++) {
+        if (t->deps[d] == on) return 1;
+    }
+    return 0;
+}
+
+//run_task : exécute la tâche, sauf si elle est sautée, et mesure sa durée.
+static void run_task(t_task *task, FILE *out) {
+    if (task->skipped) {
+        task->result = -1;
+        return;
+    }
+    double start = now_ms();
+    task->result = task->run(task->arg, out);
+    task->elapsed_ms = now_ms() - start;
+}
+
+//run_sequential : exécution dans l'ordre d'ajout, sur le thread appelant.
+static int run_sequential(t_task_graph *graph) {
+    int failed = 0;
+    for (int i = 0; i < graph->num_tasks; i++) {
+        t_task *task = &graph->tasks[i];
+        for (int d = 0; d < task->num_deps; d++) {
+            if (graph->tasks[task->deps[d]].result != 0) task->skipped = 1;
+        }
+        run_task(task, graph->console);
+        task->done = 1;
+        failed |= (task->result != 0);
+    }
+    graph->finished = graph->printed = graph->num_tasks;
+    fflush(graph->console);
+    return failed ? -1 : 0;
+}
+
+//push_ready : range une tâche prête dans la file de son thread (verrou tenu).
+static void push_ready(t_task_graph *graph, int i) {
+    if (graph->tasks[i].kind == TASK_WRITE && graph->has_writer) graph->write_queue[graph->write_tail++] = i;
+    else graph->compute_queue[graph->compute_tail++] = i;
+}
+
+//flush_console : recopie sur la console les tampons des premières tâches, tant qu'elles sont terminées (verrou tenu).
+static void flush_console(t_task_graph *graph) {
+    while (graph->printed < graph->num_tasks && graph->tasks[graph->printed].done) {
+        t_task *task = &graph->tasks[graph->printed++];
+        if (task->text != NULL) {
+            fwrite(task->text, 1, task->text_size, graph->console);
+            free(task->text);
+            task->text = NULL;
+        }
+    }
+    fflush(graph->console);
+}
+
+//finish_task : marque la tâche i terminée et rend prêtes celles qui n'attendaient plus qu'elle (verrou tenu).
+static void finish_task(t_task_graph *graph, int i) {
+    t_task *task = &graph->tasks[i];
+    task->done = 1;
+    graph->finished++;
+    for (int j = i + 1; j < graph->num_tasks; j++) {
+        t_task *next = &graph->tasks[j];
+        if (!depends_on(next, i)) continue;
+        if (task->result != 0) next->skipped = 1;
+        if (--next->waiting == 0) push_ready(graph, j);
+    }
+    flush_console(graph);
+    pthread_cond_broadcast(&graph->changed);
+}
+
+/*
+   task_worker :
+   Boucle d'un thread : prend la prochaine tâche de sa file, l'exécute hors du verrou
+   dans son tampon, puis la déclare terminée. S'arrête quand toutes les tâches le sont.
+   Le tampon est fermé avant la reprise du verrou : text et text_size sont alors
+   définitifs pour le thread qui les recopiera.
+*/
+static void *task_worker(void *arg) {
+    t_task_worker *worker = (t_task_worker *)arg;
+    t_task_graph *graph = worker->graph;
+    int *queue = (worker->kind == TASK_WRITE) ? graph->write_queue : graph->compute_queue;
+    int *head = (worker->kind == TASK_WRITE) ? &graph->write_head : &graph->compute_head;
+    int *tail = (worker->kind == TASK_WRITE) ? &graph->write_tail : &graph->compute_tail;
+
+    pthread_mutex_lock(&graph->lock);
+    while (1) {
+        while (*head == *tail && graph->finished < graph->num_tasks) pthread_cond_wait(&graph->changed, &graph->lock);
+        if (*head == *tail) break; // Toutes les tâches sont terminées
+        int i = queue[(*head)++];
+        pthread_mutex_unlock(&graph->lock);
+
+        t_task *task = &graph->tasks[i];
+        run_task(task, task->out);
+        fclose(task->out);
+        task->out = NULL;
+
+        pthread_mutex_lock(&graph->lock);
+        finish_task(graph, i);
+    }
+    pthread_mutex_unlock(&graph->lock);
+    return NULL;
+}
+
+/*
+   open_buffers :
+   Un tampon en mémoire par tâche (open_memstream). Retourne 0, ou -1 si un tampon
+   n'a pas pu être ouvert (ceux déjà ouverts sont fermés).
+*/
+static int open_buffers(t_task_graph *graph) {
+    for (int i = 0; i < graph->num_tasks; i++) {
+        t_task *task = &graph->tasks[i];
+        task->out = open_memstream(&task->text, &task->text_size);
+        if (task->out == NULL) {
+            perror("Allocation failed for task output");
+            for (int k = 0; k < i; k++) {
+                fclose(graph->tasks[k].out);
+                free(graph->tasks[k].text);
+                graph->tasks[k].out = NULL;
+                graph->tasks[k].text = NULL;
+            }
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/*
+   taskgraph_run :
+   num_threads = 1 demande l'exécution séquentielle. Sinon, le thread appelant est
+   l'un des num_threads threads de calcul. Le verrou est tenu pendant le lancement :
+   les threads ne prennent une tâche qu'une fois les files remplies, et has_writer ne
+   change plus. Si le thread d'écriture ne démarre pas, ses tâches vont aux threads de
+   calcul ; si aucun autre thread ne démarre, l'appelant exécute tout.
+*/
+int taskgraph_run(t_task_graph *graph, int num_threads, FILE *console) {
+    double start = now_ms();
+
+    graph->console = console;
+    graph->compute_head = graph->compute_tail = 0;
+    graph->write_head = graph->write_tail = 0;
+    graph->has_writer = 0;
+    graph->finished = graph->printed = 0;
+    int num_writes = 0;
+    for (int i = 0; i < graph->num_tasks; i++) {
+        t_task *task = &graph->tasks[i];
+        task->waiting = task->num_deps;
+        task->skipped = task->done = task->result = 0;
+        task->elapsed_ms = 0.0;
+        num_writes += (task->kind == TASK_WRITE);
+    }
+
+    int sequential = (num_threads == 1);
+    if (num_threads <= 0) {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = (cores > 0) ? (int)cores : 1;
+    }
+    if (num_threads > graph->num_tasks - num_writes) num_threads = graph->num_tasks - num_writes;
+    if (num_threads < 1) num_threads = 1;
+    graph->num_threads = num_threads;
+
+    // Un seul coeur : le thread d'écriture reste utile, les écritures attendant surtout le disque
+    if (sequential || (num_threads == 1 && num_writes == 0) || graph->num_tasks <= 1 || open_buffers(graph) != 0) {
+        graph->num_threads = 1;
+        int status = run_sequential(graph);
+        graph->wall_ms = now_ms() - start;
+        return status;
+    }
+
+    pthread_t *threads = (pthread_t *)malloc(num_threads * sizeof(pthread_t));
+    if (threads == NULL) {
+        perror("Allocation failed for task threads");
+        num_threads = 1; // Repli : le thread appelant fait les calculs
+    }
+    t_task_worker compute = {graph, TASK_COMPUTE};
+    t_task_worker writer = {graph, TASK_WRITE};
+    pthread_t writer_thread;
+
+    pthread_mutex_init(&graph->lock, NULL);
+    pthread_cond_init(&graph->changed, NULL);
+    pthread_mutex_lock(&graph->lock);
+    if (num_writes > 0) graph->has_writer = (pthread_create(&writer_thread, NULL, task_worker, &writer) == 0);
+    int started = 0;
+    for (int t = 0; t < num_threads - 1; t++) {
+        if (pthread_create(&threads[t], NULL, task_worker, &compute) != 0) {
+            fprintf(stderr, "Warning: could only start %d task thread(s).\n", started + 1);
+            break;
+        }
+        started++;
+    }
+    graph->num_threads = started + 1;
+    for (int i = 0; i < graph->num_tasks; i++) {
+        if (graph->tasks[i].waiting == 0) push_ready(graph, i);
+    }
+    pthread_mutex_unlock(&graph->lock);
+
+    task_worker(&compute);
+    for (int t = 0; t < started; t++) pthread_join(threads[t], NULL);
+    if (graph->has_writer) pthread_join(writer_thread, NULL);
+    free(threads);
+    pthread_cond_destroy(&graph->changed);
+    pthread_mutex_destroy(&graph->lock);
+
+    int failed = 0;
+    for (int i = 0; i < graph->num_tasks; i++) failed |= (graph->tasks[i].result != 0);
+    graph->wall_ms = now_ms() - start;
+    return failed ? -1 : 0;
+}
+
+/*
+   taskgraph_critical_path_ms :
+   Dans l'ordre d'ajout (topologique), une tâche finit au plus tôt après la plus
+   tardive de ses dépendances, plus sa propre durée.
+*/
+double taskgraph_critical_path_ms(const t_task_graph *graph) {
+    double finish[TASKGRAPH_MAX_TASKS];
+    double longest = 0.0;
+    for (int i = 0; i < graph->num_tasks; i++) {
+        const t_task *task = &graph->tasks[i];
+        double ready = 0.0;
+        for (int d = 0; d < task->num_deps; d++) {
+            if (finish[task->deps[d]] > ready) ready = finish[task->deps[d]];
+        }
+        finish[i] = ready + task->elapsed_ms;
+        if (finish[i] > longest) longest = finish[i];
+    }
+    return longest;
+}
@@ -0,0 +1,90 @@
+#ifndef TASKGRAPH_H
+#define TASKGRAPH_H
+
+#include <stdio.h>
+#include <pthread.h>
+
+/*
+   Petit ordonnanceur d'étapes : les étapes du pipeline sont des tâches reliées par
+   leurs dépendances (graphe orienté sans cycle, une dépendance désignant toujours une
+   tâche ajoutée avant). Une tâche dont toutes les dépendances sont terminées est
+   prise par un thread libre : les étapes indépendantes s'exécutent en même temps, et
+   la durée totale tend vers celle du chemin critique.
+   - Les tâches de calcul vont aux threads de calcul, les tâches d'écriture (fichiers
+     produits) à un thread d'écriture à part : une écriture lente ne retient pas un
+     thread de calcul.
+   - Chaque tâche écrit son affichage dans un tampon à elle ; les tampons sont recopiés
+     sur la console dans l'ordre d'ajout des tâches, dès que toutes les tâches
+     précédentes sont terminées. La console est la même quel que soit l'ordre
+     d'exécution réel.
+   - Une tâche en échec fait sauter les tâches qui en dépendent.
+   Avec un seul thread demandé, les tâches s'exécutent dans l'ordre d'ajout sur le
+   thread appelant, en écrivant directement sur la console.
+*/
+
+//Tâches au plus dans un graphe, dépendances au plus par tâche.
+#define TASKGRAPH_MAX_TASKS 32
+#define TASKGRAPH_MAX_DEPS 8
+
+//Corps d'une tâche : écrit son affichage dans out. Retourne 0, ou -1 en cas d'échec.
+typedef int (*t_task_fn)(void *arg, FILE *out);
+
+//Thread qui exécute une tâche.
+typedef enum e_task_kind {
+    TASK_COMPUTE = 0,   // Threads de calcul
+    TASK_WRITE          // Thread d'écriture des fichiers
+} t_task_kind;
+
+//Tâche du graphe.
+typedef struct s_task {
+    const char *name;
+    t_task_fn run;
+    void *arg;
+    t_task_kind kind;
+    int deps[TASKGRAPH_MAX_DEPS]; // Tâches à terminer avant celle-ci
+    int num_deps;
+    int waiting;                  // Dépendances pas encore terminées (usage interne)
+    int skipped;                  // 1 si une dépendance a échoué : la tâche n'est pas exécutée
+    int done;                     // 1 une fois terminée (ou sautée)
+    int result;                   // Retour de run, -1 si la tâche a été sautée
+    char *text;                   // Tampon de l'affichage (usage interne)
+    size_t text_size;
+    FILE *out;
+    double elapsed_ms;            // Durée d'exécution de run
+} t_task;
+
+//Graphe de tâches et état de son exécution.
+typedef struct s_task_graph {
+    t_task tasks[TASKGRAPH_MAX_TASKS];
+    int num_tasks;
+    pthread_mutex_t lock;         // Protège tout ce qui suit, et la console pendant la recopie des tampons
+    pthread_cond_t changed;       // Signalé à chaque tâche prête ou terminée
+    int compute_queue[TASKGRAPH_MAX_TASKS]; // Tâches prêtes, par thread
+    int compute_head, compute_tail;
+    int write_queue[TASKGRAPH_MAX_TASKS];
+    int write_head, write_tail;
+    int has_writer;               // 0 : les tâches d'écriture vont aux threads de calcul
+    int finished;                 // Tâches terminées
+    int printed;                  // Tâches dont l'affichage est recopié
+    FILE *console;
+    int num_threads;              // Threads de calcul de la dernière exécution (1 : exécution séquentielle, sauf has_writer)
+    double wall_ms;               // Durée de la dernière exécution
+} t_task_graph;
+
+//Initialise un graphe vide.
+void taskgraph_init(t_task_graph *graph);
+
+//Ajoute une tâche. Retourne son numéro, ou -1 si le graphe est plein.
+int taskgraph_add(t_task_graph *graph, const char *name, t_task_fn run, void *arg, t_task_kind kind);
+
+//La tâche task attend la fin de la tâche on (ajoutée avant elle). Retourne 0, ou -1 si la dépendance est invalide.
+int taskgraph_depends(t_task_graph *graph, int task, int on);
+
+//Exécute le graphe sur num_threads threads de calcul (0 = nombre de coeurs) plus le thread d'écriture, les affichages
+//allant dans console ; avec num_threads = 1, exécution séquentielle dans l'ordre d'ajout. Retourne 0, ou -1 si une tâche a échoué ou a été sautée.
+int taskgraph_run(t_task_graph *graph, int num_threads, FILE *console);
+
+//Durée du chemin critique de la dernière exécution : plus longue somme des durées le long des dépendances (ms).
+double taskgraph_critical_path_ms(const t_task_graph *graph);
+
+#endif // TASKGRAPH_H
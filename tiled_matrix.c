@@ -0,0 +1,346 @@
+#include "tiled_matrix.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "profile.h"
+
+#define TILED_MAX_PATH 1024
+
+static const t_tiled_matrix empty_tiled = {0, 0, 0, 0, NULL, 0, NULL};
+
+/*
+   tiled_tile_size :
+   L'ensemble de travail d'un produit est de TILED_WORKING_TILES tuiles de tile² flottants :
+   le côté est la plus grande valeur qui tient dans working_bytes, arrondie à un multiple
+   de TILED_MIN_TILE, sans dépasser N (arrondi au multiple supérieur).
+*/
+int tiled_tile_size(int N, long long working_bytes) {
+    if (working_bytes <= 0) working_bytes = TILED_DEFAULT_WORKING_BYTES;
+
+    int tile = (int)sqrt((double)working_bytes / (TILED_WORKING_TILES * sizeof(float)));
+    if (tile > TILED_MAX_TILE) tile = TILED_MAX_TILE;
+    tile -= tile % TILED_MIN_TILE;
+    if (tile < TILED_MIN_TILE) tile = TILED_MIN_TILE;
+
+    int whole = ((N + TILED_MIN_TILE - 1) / TILED_MIN_TILE) * TILED_MIN_TILE;
+    if (N > 0 && tile > whole) tile = whole;
+    return tile;
+}
+
+//tile_at : première valeur de la tuile (I, J).
+static float *tile_at(const t_tiled_matrix *M, int I, int J) {
+    return M->data + ((size_t)I * M->num_tiles + J) * ((size_t)M->tile * M->tile);
+}
+
+//tile_bytes : taille d'une tuile (un nombre entier de pages de 4 Ko).
+static size_t tile_bytes(const t_tiled_matrix *M) {
+    return (size_t)M->tile * M->tile * sizeof(float);
+}
+
+/*
+   prefetch_tile, release_tile :
+   Conseils au noyau, seulement si la matrice ne tient pas dans l'ensemble de travail.
+   MADV_WILLNEED lance la lecture de la tuile en arrière-plan pendant le calcul en cours ;
+   MADV_DONTNEED la retire des pages du processus (la projection est partagée : les
+   valeurs restent dans le fichier). Un échec (pages plus grandes que 4 Ko) est sans effet
+   sur les résultats.
+*/
+static void prefetch_tile(const t_tiled_matrix *M, int I, int J) {
+    if (M->stream && M->nonzero[(size_t)I * M->num_tiles + J]) madvise(tile_at(M, I, J), tile_bytes(M), MADV_WILLNEED);
+}
+
+static void release_tile(const t_tiled_matrix *M, int I, int J) {
+    if (M->stream) madvise(tile_at(M, I, J), tile_bytes(M), MADV_DONTNEED);
+}
+
+/*
+   create_with_tile :
+   Fichier temporaire de num_tiles² tuiles, agrandi par ftruncate (fichier creux : les
+   tuiles jamais écrites ne prennent pas de place sur le disque et se lisent nulles),
+   supprimé aussitôt projeté pour qu'il disparaisse même si le programme s'arrête.
+*/
+static t_tiled_matrix create_with_tile(int N, int tile, int stream, const char *scratch_dir) {
+    t_tiled_matrix M = empty_tiled;
+    char path[TILED_MAX_PATH];
+
+    if (N <= 0 || tile <= 0) return M;
+    M.n = N;
+    M.tile = tile;
+    M.num_tiles = (N + tile - 1) / tile;
+    M.stream = stream;
+    M.bytes = (size_t)M.num_tiles * M.num_tiles * tile * tile * sizeof(float);
+
+    M.nonzero = (unsigned char *)calloc((size_t)M.num_tiles * M.num_tiles, sizeof(unsigned char));
+    if (M.nonzero == NULL) {
+        perror("Allocation failed for tiled matrix flags");
+        return empty_tiled;
+    }
+
+    snprintf(path, sizeof(path), "%s/markov_tiled_XXXXXX", scratch_dir != NULL ? scratch_dir : ".");
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        perror("Could not create tiled matrix file");
+        free(M.nonzero);
+        return empty_tiled;
+    }
+    unlink(path);
+
+    void *data = MAP_FAILED;
+    if (ftruncate(fd, (off_t)M.bytes) == 0) {
+        data = mmap(NULL, M.bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (data == MAP_FAILED) {
+        perror("Could not map tiled matrix file");
+        free(M.nonzero);
+        return empty_tiled;
+    }
+    M.data = (float *)data;
+    return M;
+}
+
+t_tiled_matrix tiled_create(int N, long long working_bytes, const char *scratch_dir) {
+    if (working_bytes <= 0) working_bytes = TILED_DEFAULT_WORKING_BYTES;
+    int tile = tiled_tile_size(N, working_bytes);
+    int num_tiles = (N + tile - 1) / tile;
+    double bytes = (double)num_tiles * num_tiles * tile * tile * sizeof(float);
+    return create_with_tile(N, tile, bytes > (double)working_bytes, scratch_dir);
+}
+
+void tiled_free(t_tiled_matrix M) {
+    if (M.data != NULL) munmap(M.data, M.bytes);
+    free(M.nonzero);
+}
+
+float tiled_get(const t_tiled_matrix *M, int i, int j) {
+    int t = M->tile;
+    if (!M->nonzero[(size_t)(i / t) * M->num_tiles + j / t]) return 0.0f;
+    return tile_at(M, i / t, j / t)[(size_t)(i % t) * t + j % t];
+}
+
+/*
+   tiled_from_csr :
+   Les lignes sont écrites dans l'ordre : une bande de tuiles (tile lignes) est
+   terminée avant la suivante et peut être rendue au noyau.
+*/
+t_tiled_matrix tiled_from_csr(const t_csr *P, long long working_bytes, const char *scratch_dir) {
+    if (P->row_ptr == NULL) return empty_tiled;
+    t_tiled_matrix M = tiled_create(P->num_vertices, working_bytes, scratch_dir);
+    if (M.data == NULL) return M;
+
+    int t = M.tile;
+    for (int i = 0; i < P->num_vertices; i++) {
+        int I = i / t;
+        for (int e = P->row_ptr[i]; e < P->row_ptr[i + 1]; e++) {
+            int j = P->col_idx[e];
+            if (P->values[e] == 0.0f) continue;
+            tile_at(&M, I, j / t)[(size_t)(i % t) * t + j % t] = P->values[e];
+            M.nonzero[(size_t)I * M.num_tiles + j / t] = 1;
+        }
+        if (i % t == t - 1 || i == P->num_vertices - 1) {
+            for (int J = 0; J < M.num_tiles; J++) release_tile(&M, I, J);
+        }
+    }
+    return M;
+}
+
+t_tiled_matrix tiled_from_matrix(t_matrix A, long long working_bytes, const char *scratch_dir) {
+    if (A.data == NULL) return empty_tiled;
+    t_tiled_matrix M = tiled_create(A.rows, working_bytes, scratch_dir);
+    if (M.data == NULL) return M;
+
+    int t = M.tile;
+    for (int i = 0; i < A.rows; i++) {
+        for (int j = 0; j < A.cols; j++) {
+            if (A.data[i][j] == 0.0f) continue;
+            tile_at(&M, i / t, j / t)[(size_t)(i % t) * t + j % t] = A.data[i][j];
+            M.nonzero[(size_t)(i / t) * M.num_tiles + j / t] = 1;
+        }
+    }
+    return M;
+}
+
+void tiled_row(const t_tiled_matrix *M, int i, double *out) {
+    int t = M->tile;
+    int I = i / t;
+    for (int J = 0; J < M->num_tiles; J++) {
+        int width = (J == M->num_tiles - 1) ? M->n - J * t : t;
+        if (!M->nonzero[(size_t)I * M->num_tiles + J]) {
+            for (int c = 0; c < width; c++) out[J * t + c] = 0.0;
+            continue;
+        }
+        const float *row = tile_at(M, I, J) + (size_t)(i % t) * t;
+        for (int c = 0; c < width; c++) out[J * t + c] = row[c];
+        release_tile(M, I, J);
+    }
+}
+
+//next_pair : premier K >= from tel que A(I, K) et B(K, J) sont non nulles, num_tiles s'il n'y en a pas.
+static int next_pair(const t_tiled_matrix *A, const t_tiled_matrix *B, int I, int J, int from) {
+    int T = A->num_tiles;
+    for (int K = from; K < T; K++) {
+        if (A->nonzero[(size_t)I * T + K] && B->nonzero[(size_t)K * T + J]) return K;
+    }
+    return T;
+}
+
+/*
+   tiled_multiply :
+   C(I, J) = somme sur K de A(I, K) B(K, J), accumulée en double dans une tuile en
+   mémoire puis écrite une seule fois dans le fichier de C. Pendant le produit de la
+   paire K, la paire suivante est préchargée ; les paires dont une tuile est nulle ne
+   sont ni lues ni calculées (matrices par blocs de classes, identité de tiled_power).
+*/
+t_tiled_matrix tiled_multiply(const t_tiled_matrix *A, const t_tiled_matrix *B, const char *scratch_dir) {
+    if (A->data == NULL || B->data == NULL || A->n != B->n || A->tile != B->tile) {
+        fprintf(stderr, "Error: Tiled matrices must have the same size and tiles for multiplication.\n");
+        return empty_tiled;
+    }
+
+    t_tiled_matrix C = create_with_tile(A->n, A->tile, A->stream || B->stream, scratch_dir);
+    if (C.data == NULL) return C;
+
+    int t = C.tile;
+    int T = C.num_tiles;
+    size_t values = (size_t)t * t;
+    double *acc = (double *)malloc(values * sizeof(double));
+    if (acc == NULL) {
+        perror("Allocation failed for tile accumulator");
+        tiled_free(C);
+        return empty_tiled;
+    }
+
+    long long pairs = 0;
+    for (int I = 0; I < T; I++) {
+        for (int J = 0; J < T; J++) {
+            int K = next_pair(A, B, I, J, 0);
+            if (K == T) continue;
+
+            memset(acc, 0, values * sizeof(double));
+            prefetch_tile(A, I, K);
+            prefetch_tile(B, K, J);
+            while (K < T) {
+                int next = next_pair(A, B, I, J, K + 1);
+                if (next < T) {
+                    prefetch_tile(A, I, next);
+                    prefetch_tile(B, next, J);
+                }
+
+                const float *a = tile_at(A, I, K);
+                const float *b = tile_at(B, K, J);
+                for (int i = 0; i < t; i++) {
+                    double *c = acc + (size_t)i * t;
+                    for (int k = 0; k < t; k++) {
+                        double aik = a[(size_t)i * t + k];
+                        if (aik == 0.0) continue;
+                        const float *b_row = b + (size_t)k * t;
+                        for (int j = 0; j < t; j++) c[j] += aik * b_row[j];
+                    }
+                }
+                release_tile(A, I, K);
+                release_tile(B, K, J);
+                pairs++;
+                K = next;
+            }
+
+            float *out = tile_at(&C, I, J);
+            int any = 0;
+            for (size_t v = 0; v < values; v++) {
+                out[v] = (float)acc[v];
+                if (out[v] != 0.0f) any = 1;
+            }
+            C.nonzero[(size_t)I * T + J] = (unsigned char)any;
+            release_tile(&C, I, J);
+        }
+    }
+    profile_count_flops(2LL * pairs * t * t * t);
+
+    free(acc);
+    return C;
+}
+
+//identity : matrice identité, seules les tuiles diagonales sont non nulles.
+static t_tiled_matrix identity(const t_tiled_matrix *M, const char *scratch_dir) {
+    t_tiled_matrix Id = create_with_tile(M->n, M->tile, M->stream, scratch_dir);
+    if (Id.data == NULL) return Id;
+
+    int t = Id.tile;
+    for (int i = 0; i < Id.n; i++) tile_at(&Id, i / t, i / t)[(size_t)(i % t) * t + i % t] = 1.0f;
+    for (int I = 0; I < Id.num_tiles; I++) {
+        Id.nonzero[(size_t)I * Id.num_tiles + I] = 1;
+        release_tile(&Id, I, I);
+    }
+    return Id;
+}
+
+/*
+   tiled_power :
+   Même exponentiation rapide que powerMatrix. M n'est pas copiée : la première
+   élévation au carré la lit directement, et la dernière (inutile) est évitée.
+   Au plus trois matrices dans le dossier temporaire à la fois.
+*/
+t_tiled_matrix tiled_power(const t_tiled_matrix *M, int power, const char *scratch_dir) {
+    if (M->data == NULL) return empty_tiled;
+
+    t_tiled_matrix result = identity(M, scratch_dir);
+    t_tiled_matrix current = empty_tiled;
+    const t_tiled_matrix *base = M;
+    if (result.data == NULL) return result;
+
+    while (power > 0) {
+        if (power % 2 == 1) {
+            t_tiled_matrix temp = tiled_multiply(&result, base, scratch_dir);
+            tiled_free(result);
+            result = temp;
+            if (result.data == NULL) break;
+        }
+        power /= 2;
+        if (power == 0) break;
+
+        t_tiled_matrix temp2 = tiled_multiply(base, base, scratch_dir);
+        tiled_free(current);
+        current = temp2;
+        base = &current;
+        if (current.data == NULL) {
+            tiled_free(result);
+            result = empty_tiled;
+            break;
+        }
+    }
+
+    tiled_free(current);
+    return result;
+}
+
+/*
+   tiled_for_each_nonzero :
+   Tuiles non nulles dans l'ordre du fichier, chacune rendue au noyau après lecture :
+   la mémoire reste celle d'une tuile, quelle que soit N.
+*/
+long long tiled_for_each_nonzero(const t_tiled_matrix *M, void (*visit)(int i, int j, float value, void *data), void *data) {
+    int T = M->num_tiles;
+    int t = M->tile;
+    long long count = 0;
+    for (int I = 0; I < T; I++) {
+        int height = (I == T - 1) ? M->n - I * t : t;
+        for (int J = 0; J < T; J++) {
+            if (!M->nonzero[(size_t)I * T + J]) continue;
+            int width = (J == T - 1) ? M->n - J * t : t;
+            const float *tile = tile_at(M, I, J);
+            for (int r = 0; r < height; r++) {
+                for (int c = 0; c < width; c++) {
+                    float value = tile[(size_t)r * t + c];
+                    if (value == 0.0f) continue;
+                    if (visit != NULL) visit(I * t + r, J * t + c, value, data);
+                    count++;
+                }
+            }
+            release_tile(M, I, J);
+        }
+    }
+    return count;
+}
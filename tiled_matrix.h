@@ -0,0 +1,72 @@
+#ifndef TILED_MATRIX_H
+#define TILED_MATRIX_H
+
+#include <stddef.h>
+#include "matrix.h"
+#include "sparse.h"
+
+/*
+   Matrice N x N dense hors mémoire, pour les puissances P^k quand N² flottants ne
+   tiennent pas en RAM (N = 100 000 : 40 Go par matrice). Les valeurs sont rangées
+   par tuiles carrées de tile x tile flottants, contiguës, dans un fichier temporaire
+   projeté en mémoire (mmap). Les produits parcourent les tuiles une à une : seules
+   la tuile résultat (en double) et les deux tuiles lues, plus les deux suivantes
+   annoncées au noyau (madvise), forment l'ensemble de travail, dont la taille est
+   fixée à la création. Les tuiles entièrement nulles sont repérées et sautées.
+*/
+
+//Tuiles de TILED_MIN_TILE à TILED_MAX_TILE de côté, multiples de TILED_MIN_TILE (une tuile occupe alors des pages entières).
+#define TILED_MIN_TILE 32
+#define TILED_MAX_TILE 2048
+
+//Ensemble de travail d'un produit, en tuiles de flottants : la tuile résultat en double (2), les tuiles de A et B lues (2)
+//et les deux suivantes en cours de préchargement (2).
+#define TILED_WORKING_TILES 6
+
+//Ensemble de travail par défaut (budget mémoire inconnu).
+#define TILED_DEFAULT_WORKING_BYTES (256LL << 20)
+
+//Matrice par tuiles. La tuile (I, J) couvre les lignes I*tile .. et les colonnes J*tile .. ; les cases au-delà de N sont nulles.
+typedef struct s_tiled_matrix {
+    int n;                   // N
+    int tile;                // Côté d'une tuile
+    int num_tiles;           // Tuiles par ligne (et par colonne) : ceil(N / tile)
+    int stream;              // 1 si la matrice dépasse l'ensemble de travail : les tuiles sont rendues au noyau après usage
+    float *data;             // Projection du fichier : tuile (I, J) à partir de data + (I * num_tiles + J) * tile * tile
+    size_t bytes;            // Taille du fichier
+    unsigned char *nonzero;  // num_tiles² : 1 si la tuile peut contenir une valeur non nulle
+} t_tiled_matrix;
+
+//Côté de tuile pour une matrice N x N et un ensemble de travail de working_bytes octets.
+int tiled_tile_size(int N, long long working_bytes);
+
+//Crée une matrice N x N nulle dans un fichier temporaire du dossier scratch_dir (supprimé dès sa projection).
+//data vaut NULL si le fichier ne peut pas être créé ou projeté (idem pour toutes les fonctions qui retournent une t_tiled_matrix).
+t_tiled_matrix tiled_create(int N, long long working_bytes, const char *scratch_dir);
+
+//Libère la projection et le fichier.
+void tiled_free(t_tiled_matrix M);
+
+//Valeur (i, j), indices 0-based.
+float tiled_get(const t_tiled_matrix *M, int i, int j);
+
+//Matrice de transition depuis la CSR.
+t_tiled_matrix tiled_from_csr(const t_csr *P, long long working_bytes, const char *scratch_dir);
+
+//Copie d'une matrice dense en mémoire (comparaisons avec multiply_matrices).
+t_tiled_matrix tiled_from_matrix(t_matrix M, long long working_bytes, const char *scratch_dir);
+
+//Ligne i (0-based) : out a N cases.
+void tiled_row(const t_tiled_matrix *M, int i, double *out);
+
+//C = A * B tuile par tuile. Retourne une matrice vide si les tailles ne correspondent pas ou si la mémoire manque.
+t_tiled_matrix tiled_multiply(const t_tiled_matrix *A, const t_tiled_matrix *B, const char *scratch_dir);
+
+//M^power par exponentiation rapide (comme powerMatrix).
+t_tiled_matrix tiled_power(const t_tiled_matrix *M, int power, const char *scratch_dir);
+
+//Appelle visit(i, j, valeur, data) pour chaque case non nulle (indices 0-based), tuile par tuile (visit peut valoir NULL).
+//Retourne le nombre de cases non nulles.
+long long tiled_for_each_nonzero(const t_tiled_matrix *M, void (*visit)(int i, int j, float value, void *data), void *data);
+
+#endif // TILED_MATRIX_H